@@ -26,6 +26,7 @@
       'sources': [
         'capture_context_mac.h',
         'capture_context_mac.S',
+        'concurrent_simple_string_dictionary.h',
         'simple_string_dictionary.cc',
         'simple_string_dictionary.h',
       ],
@@ -44,6 +45,7 @@
       ],
       'sources': [
         'capture_context_mac_test.cc',
+        'concurrent_simple_string_dictionary_test.cc',
         'simple_string_dictionary_test.cc',
       ],
     },
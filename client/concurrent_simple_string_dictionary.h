@@ -0,0 +1,445 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_CLIENT_CONCURRENT_SIMPLE_STRING_DICTIONARY_H_
+#define CRASHPAD_CLIENT_CONCURRENT_SIMPLE_STRING_DICTIONARY_H_
+
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "client/simple_string_dictionary.h"
+
+namespace crashpad {
+
+// Opaque type for the serialized representation of a
+// TConcurrentSimpleStringDictionary. One is created in
+// TConcurrentSimpleStringDictionary::Serialize and can be deserialized using
+// one of the constructors.
+struct SerializedConcurrentSimpleStringDictionary;
+
+//! \brief A fixed-storage map/dictionary collection like
+//!     TSimpleStringDictionary, which may be modified by many threads at once
+//!     without external locking.
+//!
+//! The template parameters have the same meaning as they do for
+//! TSimpleStringDictionary.
+//!
+//! Entries are located by open addressing directly within the fixed entry
+//! array. Once an entry has been claimed for a key, it remains associated with
+//! that key for the lifetime of the map, even after RemoveKey(): it is merely
+//! marked inactive, and is reused if the key is set again. This is what allows
+//! writers to locate entries without locking, but it means that \a NumEntries
+//! limits the number of distinct keys ever set, rather than the number present
+//! at any one time. This suits annotations, which are drawn from a small,
+//! fixed set of keys.
+//!
+//! Each entry’s value is protected by its own sequence lock. Writers setting
+//! or removing different keys never wait for one another. Writers of the same
+//! key are serialized by that entry’s sequence lock, which is held only for the
+//! duration of a short copy. Readers never block writers. A reader that
+//! observes a write in progress retries, and never returns a torn value.
+//!
+//! Readers may run in a signal handler. Because a signal handler may have
+//! interrupted a writer on its own thread, a reader gives up on an entry that
+//! remains locked after a bounded number of attempts, and treats it as
+//! inactive. Writers must not be called from signal handlers.
+template <size_t KeySize = 256, size_t ValueSize = 256, size_t NumEntries = 64>
+class TConcurrentSimpleStringDictionary {
+ public:
+  //! \brief Constant and publicly accessible versions of the template
+  //!     parameters.
+  //! \{
+  static const size_t key_size = KeySize;
+  static const size_t value_size = ValueSize;
+  static const size_t num_entries = NumEntries;
+  //! \}
+
+  //! \brief The single-threaded dictionary type that Snapshot() produces, and
+  //!     whose Entry type Iterator returns.
+  typedef TSimpleStringDictionary<KeySize, ValueSize, NumEntries>
+      SimpleStringDictionaryType;
+
+  //! \brief A single entry in the map.
+  //!
+  //! This structure is POD, so that the map’s storage can be read from another
+  //! process. Such a reader must only consider an entry whose #sequence is even
+  //! and unchanged from before to after the read, and whose #key_hash is
+  //! nonzero.
+  struct Entry {
+    //! \brief The entry’s sequence lock, which is odd while the entry is being
+    //!     modified.
+    uint32_t sequence;
+
+    //! \brief The hash of #key, or `0` if the entry has not been claimed for
+    //!     any key. Once this is nonzero, #key will not change.
+    uint32_t key_hash;
+
+    //! \brief Nonzero if the key is present in the map, with #value as its
+    //!     value.
+    uint32_t active;
+
+    //! \brief The entry’s key.
+    char key[KeySize];
+
+    //! \brief The entry’s value.
+    char value[ValueSize];
+  };
+
+  //! \brief An iterator to traverse all of the active entries in a
+  //!     TConcurrentSimpleStringDictionary.
+  //!
+  //! Each entry returned is a consistent copy of the entry as it existed at
+  //! some moment during the call to Next(). Entries modified during traversal
+  //! may or may not reflect those modifications.
+  class Iterator {
+   public:
+    explicit Iterator(const TConcurrentSimpleStringDictionary& map)
+        : map_(map),
+          current_(0),
+          entry_() {
+    }
+
+    //! \brief Returns the next entry in the map, or `NULL` if at the end of the
+    //!     collection.
+    //!
+    //! The returned entry is owned by the iterator, and is valid until the next
+    //! call to this method.
+    const typename SimpleStringDictionaryType::Entry* Next() {
+      while (current_ < map_.num_entries) {
+        const Entry* entry = &map_.entries_[current_++];
+        if (ReadEntry(entry, entry_.key, entry_.value)) {
+          return &entry_;
+        }
+      }
+      return NULL;
+    }
+
+   private:
+    const TConcurrentSimpleStringDictionary& map_;
+    size_t current_;
+    typename SimpleStringDictionaryType::Entry entry_;
+
+    DISALLOW_COPY_AND_ASSIGN(Iterator);
+  };
+
+  TConcurrentSimpleStringDictionary()
+      : entries_() {
+  }
+
+  //! \brief Constructs a map from its serialized form. \a map should be the out
+  //!     parameter from Serialize(), and \a size should be its return value.
+  //!
+  //! The serialized form is expected to have been copied while no writers
+  //! were running, such as from a process that has crashed. Any entry that was
+  //! being modified at the time is discarded.
+  TConcurrentSimpleStringDictionary(
+      const SerializedConcurrentSimpleStringDictionary* map, size_t size)
+      : entries_() {
+    DCHECK_EQ(size, sizeof(entries_));
+    if (size == sizeof(entries_)) {
+      memcpy(entries_, map, size);
+      for (size_t i = 0; i < num_entries; ++i) {
+        if (entries_[i].sequence & 1) {
+          entries_[i].sequence = 0;
+          entries_[i].active = 0;
+          entries_[i].value[0] = '\0';
+        }
+      }
+    }
+  }
+
+  //! \brief Returns the number of active key/value pairs. The upper limit for
+  //!     this is \a NumEntries.
+  size_t GetCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < num_entries; ++i) {
+      if (__atomic_load_n(&entries_[i].active, __ATOMIC_RELAXED)) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  //! \brief Given \a key, copies its corresponding value to \a value.
+  //!
+  //! \param[in] key The key to look up. This must not be `NULL`.
+  //! \param[out] value A buffer of at least \a ValueSize bytes to receive the
+  //!     `NUL`-terminated value.
+  //!
+  //! \return `true` if \a key was found, `false` otherwise.
+  bool GetValueForKey(const char* key, char* value) const {
+    DCHECK(key);
+    if (!key) {
+      return false;
+    }
+
+    const Entry* entry = FindEntry(key, Hash(key));
+    if (!entry) {
+      return false;
+    }
+
+    char unused_key[KeySize];
+    return ReadEntry(entry, unused_key, value);
+  }
+
+  //! \brief Stores \a value into \a key, replacing the existing value if \a key
+  //!     is already present.
+  //!
+  //! If \a key has never been set and every entry has already been claimed
+  //! for another key, this operation silently fails.
+  //!
+  //! \param[in] key The key to store. This must not be `NULL`.
+  //! \param[in] value The value to store. If `NULL`, \a key is removed from the
+  //!     map.
+  void SetKeyValue(const char* key, const char* value) {
+    if (!value) {
+      RemoveKey(key);
+      return;
+    }
+
+    DCHECK(key);
+    if (!key) {
+      return;
+    }
+
+    // |key| must not be an empty string.
+    DCHECK_NE(key[0], '\0');
+    if (key[0] == '\0') {
+      return;
+    }
+
+    // Locate the entry by the key as it will be stored, which may be
+    // truncated.
+    char stored_key[KeySize];
+    strncpy(stored_key, key, key_size);
+    stored_key[key_size - 1] = '\0';
+
+    Entry* entry = FindOrClaimEntry(stored_key);
+    if (!entry) {
+      return;
+    }
+
+    uint32_t sequence = LockEntry(entry);
+    strncpy(entry->value, value, value_size);
+    entry->value[value_size - 1] = '\0';
+    __atomic_store_n(&entry->active, 1, __ATOMIC_RELAXED);
+    UnlockEntry(entry, sequence);
+  }
+
+  //! \brief Removes \a key from the map.
+  //!
+  //! If the key is not found, this is a no-op.
+  //!
+  //! \param[in] key The key of the entry to remove. This must not be `NULL`.
+  void RemoveKey(const char* key) {
+    DCHECK(key);
+    if (!key) {
+      return;
+    }
+
+    Entry* entry = const_cast<Entry*>(FindEntry(key, Hash(key)));
+    if (!entry) {
+      return;
+    }
+
+    uint32_t sequence = LockEntry(entry);
+    __atomic_store_n(&entry->active, 0, __ATOMIC_RELAXED);
+    entry->value[0] = '\0';
+    UnlockEntry(entry, sequence);
+  }
+
+  //! \brief Copies a consistent view of each active entry into \a snapshot,
+  //!     which should be empty.
+  //!
+  //! Each entry is copied as it existed at some moment during the call. The
+  //! resulting single-threaded dictionary can be serialized with
+  //! TSimpleStringDictionary::Serialize().
+  void Snapshot(SimpleStringDictionaryType* snapshot) const {
+    Iterator iterator(*this);
+    while (const typename SimpleStringDictionaryType::Entry* entry =
+               iterator.Next()) {
+      snapshot->SetKeyValue(entry->key, entry->value);
+    }
+  }
+
+  //! \brief Returns a serialized form of the map.
+  //!
+  //! Places a serialized version of the map into \a map and returns the size in
+  //! bytes. Both \a map and the size should be passed to the deserializing
+  //! constructor. Note that the serialized \a map is scoped to the lifetime of
+  //! the non-serialized instance of this class, and that it is the map’s live
+  //! storage: if it may be concurrently modified, copy it with the protocol
+  //! described for Entry, or use Snapshot() instead.
+  size_t Serialize(const SerializedConcurrentSimpleStringDictionary** map)
+      const {
+    *map = reinterpret_cast<const SerializedConcurrentSimpleStringDictionary*>(
+        entries_);
+    return sizeof(entries_);
+  }
+
+ private:
+  //! \brief The number of times that a reader will attempt to read an entry
+  //!     before considering it to be inactive.
+  static const int kMaximumReadAttempts = 1 << 16;
+
+  //! \brief Hashes \a key, returning a nonzero value suitable for
+  //!     Entry::key_hash.
+  static uint32_t Hash(const char* key) {
+    uint32_t hash = internal::HashSimpleStringDictionaryKey(key, key_size);
+    return hash ? hash : 1;
+  }
+
+  //! \brief Finds the entry claimed for \a key, whose hash is \a hash.
+  //!
+  //! \return The entry, or `NULL` if no entry has been claimed for \a key.
+  const Entry* FindEntry(const char* key, uint32_t hash) const {
+    for (size_t probe = 0; probe < num_entries; ++probe) {
+      const Entry* entry = &entries_[(hash + probe) % num_entries];
+      uint32_t key_hash =
+          __atomic_load_n(&entry->key_hash, __ATOMIC_ACQUIRE);
+      if (!key_hash) {
+        // Keys are claimed at the first unclaimed entry in their probe
+        // sequence, and are never released, so |key| can’t be further along.
+        return NULL;
+      }
+
+      // Once key_hash has been observed, key will not change.
+      if (key_hash == hash && strncmp(key, entry->key, key_size) == 0) {
+        return entry;
+      }
+    }
+    return NULL;
+  }
+
+  //! \brief Finds the entry claimed for \a key, claiming one if necessary.
+  //!
+  //! \a key must be no longer than `KeySize - 1` bytes.
+  //!
+  //! \return The entry, or `NULL` if \a key has not been claimed and no
+  //!     unclaimed entries remain.
+  Entry* FindOrClaimEntry(const char* key) {
+    uint32_t hash = Hash(key);
+    for (size_t probe = 0; probe < num_entries; ++probe) {
+      Entry* entry = &entries_[(hash + probe) % num_entries];
+      uint32_t key_hash =
+          __atomic_load_n(&entry->key_hash, __ATOMIC_ACQUIRE);
+      if (!key_hash) {
+        // Claim the entry under its lock. Another writer may have claimed it
+        // in the meantime, possibly for this same key.
+        uint32_t sequence = LockEntry(entry);
+        key_hash = entry->key_hash;
+        if (!key_hash) {
+          strncpy(entry->key, key, key_size);
+          key_hash = hash;
+          __atomic_store_n(&entry->key_hash, key_hash, __ATOMIC_RELEASE);
+        }
+        UnlockEntry(entry, sequence);
+      }
+
+      if (key_hash == hash && strncmp(key, entry->key, key_size) == 0) {
+        return entry;
+      }
+    }
+    return NULL;
+  }
+
+  //! \brief Acquires \a entry’s sequence lock, waiting for any other writer to
+  //!     release it.
+  //!
+  //! \return The entry’s sequence number after locking, to be passed to
+  //!     UnlockEntry().
+  static uint32_t LockEntry(Entry* entry) {
+    while (true) {
+      uint32_t sequence =
+          __atomic_load_n(&entry->sequence, __ATOMIC_RELAXED);
+      if (!(sequence & 1) &&
+          __atomic_compare_exchange_n(&entry->sequence,
+                                      &sequence,
+                                      sequence + 1,
+                                      false,
+                                      __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED)) {
+        // Readers must not observe any of the modifications that follow
+        // without also observing the odd sequence number.
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        return sequence + 1;
+      }
+      sched_yield();
+    }
+  }
+
+  //! \brief Releases \a entry’s sequence lock, acquired by LockEntry().
+  static void UnlockEntry(Entry* entry, uint32_t sequence) {
+    DCHECK(sequence & 1);
+    __atomic_store_n(&entry->sequence, sequence + 1, __ATOMIC_RELEASE);
+  }
+
+  //! \brief Reads a consistent copy of \a entry.
+  //!
+  //! \param[in] entry The entry to read.
+  //! \param[out] key A buffer of \a KeySize bytes to receive the entry’s key.
+  //! \param[out] value A buffer of \a ValueSize bytes to receive the entry’s
+  //!     value.
+  //!
+  //! \return `true` if the entry is active and was read. `false` if it is
+  //!     inactive, or could not be read consistently.
+  static bool ReadEntry(const Entry* entry, char* key, char* value) {
+    if (!__atomic_load_n(&entry->key_hash, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+
+    // Once claimed, the key does not change.
+    memcpy(key, entry->key, key_size);
+
+    for (int attempt = 0; attempt < kMaximumReadAttempts; ++attempt) {
+      uint32_t sequence =
+          __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+      if (sequence & 1) {
+        continue;
+      }
+
+      uint32_t active = __atomic_load_n(&entry->active, __ATOMIC_RELAXED);
+      if (active) {
+        memcpy(value, entry->value, value_size);
+      }
+
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&entry->sequence, __ATOMIC_RELAXED) == sequence) {
+        if (active) {
+          // The value was written with a terminator, but be certain.
+          value[value_size - 1] = '\0';
+        }
+        return active != 0;
+      }
+    }
+
+    return false;
+  }
+
+  Entry entries_[NumEntries];
+
+  DISALLOW_COPY_AND_ASSIGN(TConcurrentSimpleStringDictionary);
+};
+
+//! \brief A TConcurrentSimpleStringDictionary with default template
+//!     parameters, matching those of SimpleStringDictionary.
+typedef TConcurrentSimpleStringDictionary<256, 256, 64>
+    ConcurrentSimpleStringDictionary;
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_CLIENT_CONCURRENT_SIMPLE_STRING_DICTIONARY_H_
@@ -0,0 +1,157 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "client/concurrent_simple_string_dictionary.h"
+#include "client/simple_string_dictionary.h"
+#include "util/test/benchmark.h"
+#include "util/thread/worker_pool.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const size_t kKeysPerThread = 4;
+const size_t kOperationsPerThread = 20000;
+
+// A TSimpleStringDictionary guarded by a mutex, which is how annotations had
+// to be shared among threads before TConcurrentSimpleStringDictionary.
+class MutexSimpleStringDictionary {
+ public:
+  MutexSimpleStringDictionary() : dictionary_() {
+    int rv = pthread_mutex_init(&mutex_, NULL);
+    DCHECK_EQ(rv, 0);
+  }
+
+  ~MutexSimpleStringDictionary() {
+    int rv = pthread_mutex_destroy(&mutex_);
+    DCHECK_EQ(rv, 0);
+  }
+
+  void SetKeyValue(const char* key, const char* value) {
+    pthread_mutex_lock(&mutex_);
+    dictionary_.SetKeyValue(key, value);
+    pthread_mutex_unlock(&mutex_);
+  }
+
+  bool GetValueForKey(const char* key, char* value) {
+    pthread_mutex_lock(&mutex_);
+    const char* found = dictionary_.GetValueForKey(key);
+    if (found) {
+      strncpy(value, found, SimpleStringDictionary::value_size);
+    }
+    pthread_mutex_unlock(&mutex_);
+    return found != NULL;
+  }
+
+ private:
+  SimpleStringDictionary dictionary_;
+  pthread_mutex_t mutex_;
+
+  DISALLOW_COPY_AND_ASSIGN(MutexSimpleStringDictionary);
+};
+
+// Each work item is one thread’s share of the operations: it repeatedly sets
+// and then reads back its own keys, in the pattern of a request handler
+// updating annotations that a crash handler might read at any time.
+template <typename Dictionary>
+class DictionaryDelegate final : public WorkerPool::Delegate {
+ public:
+  DictionaryDelegate(Dictionary* dictionary, size_t thread_count)
+      : dictionary_(dictionary), keys_() {
+    for (size_t thread = 0; thread < thread_count; ++thread) {
+      for (size_t index = 0; index < kKeysPerThread; ++index) {
+        char key[32];
+        snprintf(key, sizeof(key), "thread_%zu_key_%zu", thread, index);
+        keys_.push_back(key);
+      }
+    }
+  }
+
+  ~DictionaryDelegate() {}
+
+  // WorkerPool::Delegate:
+  virtual bool DoWork(size_t index) override {
+    const std::string* keys = &keys_[index * kKeysPerThread];
+    char value[SimpleStringDictionary::value_size];
+    for (size_t operation = 0; operation < kOperationsPerThread;
+         ++operation) {
+      const char* key = keys[operation % kKeysPerThread].c_str();
+      if (operation % 2 == 0) {
+        dictionary_->SetKeyValue(key, "value");
+      } else {
+        DoNotOptimize(dictionary_->GetValueForKey(key, value));
+      }
+    }
+    return true;
+  }
+
+ private:
+  Dictionary* dictionary_;  // weak
+  std::vector<std::string> keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(DictionaryDelegate);
+};
+
+template <typename Dictionary>
+void RunDictionaryBenchmark(BenchmarkState* state) {
+  const size_t thread_count = state->range(0);
+
+  Dictionary dictionary;
+  DictionaryDelegate<Dictionary> delegate(&dictionary, thread_count);
+  WorkerPool worker_pool(thread_count);
+  while (state->KeepRunning()) {
+    if (!worker_pool.Run(&delegate, thread_count)) {
+      state->SkipWithError("Run failed");
+      return;
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * thread_count *
+                           kOperationsPerThread);
+}
+
+// Sets and gets annotations from range(0) threads at once through a
+// TConcurrentSimpleStringDictionary.
+void BM_ConcurrentSimpleStringDictionaryThreads(BenchmarkState* state) {
+  RunDictionaryBenchmark<ConcurrentSimpleStringDictionary>(state);
+}
+CRASHPAD_BENCHMARK(BM_ConcurrentSimpleStringDictionaryThreads)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+
+// The same operations as BM_ConcurrentSimpleStringDictionaryThreads, through
+// a mutex-guarded TSimpleStringDictionary.
+void BM_MutexSimpleStringDictionaryThreads(BenchmarkState* state) {
+  RunDictionaryBenchmark<MutexSimpleStringDictionary>(state);
+}
+CRASHPAD_BENCHMARK(BM_MutexSimpleStringDictionaryThreads)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
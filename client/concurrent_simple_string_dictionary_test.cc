@@ -0,0 +1,288 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/concurrent_simple_string_dictionary.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(ConcurrentSimpleStringDictionary, SetGetRemove) {
+  typedef TConcurrentSimpleStringDictionary<5, 7, 4> TestMap;
+  TestMap map;
+  char value[TestMap::value_size];
+
+  EXPECT_EQ(0u, map.GetCount());
+  EXPECT_FALSE(map.GetValueForKey("rob", value));
+
+  map.SetKeyValue("rob", "ert");
+  map.SetKeyValue("mike", "pink");
+  map.SetKeyValue("mark", "allayss");
+  EXPECT_EQ(3u, map.GetCount());
+  ASSERT_TRUE(map.GetValueForKey("rob", value));
+  EXPECT_STREQ("ert", value);
+  ASSERT_TRUE(map.GetValueForKey("mike", value));
+  EXPECT_STREQ("pink", value);
+
+  // Values are truncated to fit.
+  ASSERT_TRUE(map.GetValueForKey("mark", value));
+  EXPECT_STREQ("allays", value);
+
+  map.RemoveKey("mike");
+  EXPECT_EQ(2u, map.GetCount());
+  EXPECT_FALSE(map.GetValueForKey("mike", value));
+  map.RemoveKey("mike");
+  map.RemoveKey("absent");
+  EXPECT_EQ(2u, map.GetCount());
+
+  map.SetKeyValue("mark", NULL);
+  EXPECT_EQ(1u, map.GetCount());
+  EXPECT_FALSE(map.GetValueForKey("mark", value));
+
+  // Keys that have been removed keep their entries, so they can be set again
+  // even when the map is otherwise full.
+  map.SetKeyValue("ann", "1");
+  EXPECT_EQ(2u, map.GetCount());
+  map.SetKeyValue("bob", "2");
+  EXPECT_FALSE(map.GetValueForKey("bob", value));
+  map.SetKeyValue("mike", "again");
+  ASSERT_TRUE(map.GetValueForKey("mike", value));
+  EXPECT_STREQ("again", value);
+  EXPECT_EQ(3u, map.GetCount());
+}
+
+TEST(ConcurrentSimpleStringDictionary, LongKey) {
+  TConcurrentSimpleStringDictionary<4, 4, 4> map;
+  char value[4];
+
+  map.SetKeyValue("abcdef", "1");
+  map.SetKeyValue("abcxyz", "2");
+  EXPECT_EQ(1u, map.GetCount());
+  ASSERT_TRUE(map.GetValueForKey("abc", value));
+  EXPECT_STREQ("2", value);
+}
+
+TEST(ConcurrentSimpleStringDictionary, IteratorAndSnapshot) {
+  typedef TConcurrentSimpleStringDictionary<8, 8, 16> TestMap;
+  TestMap map;
+  map.SetKeyValue("one", "1");
+  map.SetKeyValue("two", "2");
+  map.SetKeyValue("three", "3");
+  map.RemoveKey("two");
+
+  TestMap::Iterator iterator(map);
+  size_t count = 0;
+  while (const TestMap::SimpleStringDictionaryType::Entry* entry =
+             iterator.Next()) {
+    ++count;
+    EXPECT_TRUE((strcmp(entry->key, "one") == 0 &&
+                 strcmp(entry->value, "1") == 0) ||
+                (strcmp(entry->key, "three") == 0 &&
+                 strcmp(entry->value, "3") == 0))
+        << entry->key;
+  }
+  EXPECT_EQ(2u, count);
+
+  TestMap::SimpleStringDictionaryType snapshot;
+  map.Snapshot(&snapshot);
+  EXPECT_EQ(2u, snapshot.GetCount());
+  EXPECT_STREQ("1", snapshot.GetValueForKey("one"));
+  EXPECT_STREQ("3", snapshot.GetValueForKey("three"));
+  EXPECT_FALSE(snapshot.GetValueForKey("two"));
+}
+
+TEST(ConcurrentSimpleStringDictionary, Serialize) {
+  typedef TConcurrentSimpleStringDictionary<4, 5, 7> TestMap;
+  TestMap map;
+  map.SetKeyValue("one", "abc");
+  map.SetKeyValue("two", "def");
+  map.SetKeyValue("tre", "hig");
+
+  const SerializedConcurrentSimpleStringDictionary* serialized;
+  size_t size = map.Serialize(&serialized);
+  ASSERT_EQ(sizeof(TestMap::Entry) * TestMap::num_entries, size);
+
+  std::string serialized_copy(reinterpret_cast<const char*>(serialized), size);
+
+  // Simulate a crash while “two” was being written. Its entry must be
+  // discarded.
+  TestMap::Entry* entries = reinterpret_cast<TestMap::Entry*>(
+      &serialized_copy[0]);
+  for (size_t i = 0; i < TestMap::num_entries; ++i) {
+    if (strcmp(entries[i].key, "two") == 0) {
+      ++entries[i].sequence;
+    }
+  }
+
+  TestMap deserialized(
+      reinterpret_cast<const SerializedConcurrentSimpleStringDictionary*>(
+          serialized_copy.data()),
+      size);
+  EXPECT_EQ(2u, deserialized.GetCount());
+  char value[TestMap::value_size];
+  ASSERT_TRUE(deserialized.GetValueForKey("one", value));
+  EXPECT_STREQ("abc", value);
+  ASSERT_TRUE(deserialized.GetValueForKey("tre", value));
+  EXPECT_STREQ("hig", value);
+  EXPECT_FALSE(deserialized.GetValueForKey("two", value));
+
+  // The discarded key can be set again.
+  deserialized.SetKeyValue("two", "xyz");
+  ASSERT_TRUE(deserialized.GetValueForKey("two", value));
+  EXPECT_STREQ("xyz", value);
+}
+
+typedef TConcurrentSimpleStringDictionary<16, 64, 32> StressMap;
+
+const int kStressWriterThreads = 8;
+const int kStressIterations = 20000;
+
+// Values written during the stress test consist of a single character repeated
+// a number of times determined by the character, so that torn values can be
+// detected.
+void MakeStressValue(int iteration, char* value) {
+  char c = 'a' + iteration % 26;
+  size_t length = 1 + (c - 'a') * 2;
+  memset(value, c, length);
+  value[length] = '\0';
+}
+
+bool IsStressValue(const char* value) {
+  char c = value[0];
+  if (c < 'a' || c > 'z') {
+    return false;
+  }
+  size_t length = 1 + (c - 'a') * 2;
+  for (size_t i = 0; i < length; ++i) {
+    if (value[i] != c) {
+      return false;
+    }
+  }
+  return value[length] == '\0';
+}
+
+struct StressContext {
+  StressMap* map;
+  int thread_index;
+  int torn_reads;
+  int reads;
+  bool done;
+};
+
+void* StressWriterMain(void* argument) {
+  StressContext* context = static_cast<StressContext*>(argument);
+  char own_key[StressMap::key_size];
+  snprintf(own_key, sizeof(own_key), "thread%d", context->thread_index);
+
+  char value[StressMap::value_size];
+  for (int iteration = 0; iteration < kStressIterations; ++iteration) {
+    MakeStressValue(iteration + context->thread_index, value);
+
+    // Every thread writes its own key, and all threads contend on a shared
+    // key.
+    if (iteration % 7 == 0) {
+      context->map->RemoveKey(own_key);
+    }
+    context->map->SetKeyValue(own_key, value);
+    context->map->SetKeyValue("shared", value);
+  }
+
+  return NULL;
+}
+
+void* StressReaderMain(void* argument) {
+  StressContext* context = static_cast<StressContext*>(argument);
+  do {
+    StressMap::Iterator iterator(*context->map);
+    while (const StressMap::SimpleStringDictionaryType::Entry* entry =
+               iterator.Next()) {
+      ++context->reads;
+      if (!IsStressValue(entry->value)) {
+        ++context->torn_reads;
+      }
+    }
+
+    char value[StressMap::value_size];
+    if (context->map->GetValueForKey("shared", value)) {
+      ++context->reads;
+      if (!IsStressValue(value)) {
+        ++context->torn_reads;
+      }
+    }
+  } while (!__atomic_load_n(&context->done, __ATOMIC_ACQUIRE));
+
+  return NULL;
+}
+
+TEST(ConcurrentSimpleStringDictionary, Stress) {
+  scoped_ptr<StressMap> map(new StressMap());
+
+  StressContext reader_context = {};
+  reader_context.map = map.get();
+  pthread_t reader_thread;
+  ASSERT_EQ(0, pthread_create(
+                   &reader_thread, NULL, StressReaderMain, &reader_context));
+
+  StressContext writer_contexts[kStressWriterThreads] = {};
+  pthread_t writer_threads[kStressWriterThreads];
+  for (int index = 0; index < kStressWriterThreads; ++index) {
+    writer_contexts[index].map = map.get();
+    writer_contexts[index].thread_index = index;
+    ASSERT_EQ(0,
+              pthread_create(&writer_threads[index],
+                             NULL,
+                             StressWriterMain,
+                             &writer_contexts[index]));
+  }
+
+  for (int index = 0; index < kStressWriterThreads; ++index) {
+    ASSERT_EQ(0, pthread_join(writer_threads[index], NULL));
+  }
+
+  __atomic_store_n(&reader_context.done, true, __ATOMIC_RELEASE);
+  ASSERT_EQ(0, pthread_join(reader_thread, NULL));
+
+  EXPECT_EQ(0, reader_context.torn_reads);
+  EXPECT_GT(reader_context.reads, 0);
+
+  // Each thread’s last write of its own key survives, and no key was claimed
+  // more than once.
+  EXPECT_EQ(static_cast<size_t>(kStressWriterThreads + 1), map->GetCount());
+  for (int index = 0; index < kStressWriterThreads; ++index) {
+    char key[StressMap::key_size];
+    snprintf(key, sizeof(key), "thread%d", index);
+    char value[StressMap::value_size];
+    ASSERT_TRUE(map->GetValueForKey(key, value)) << key;
+    char expected[StressMap::value_size];
+    MakeStressValue(kStressIterations - 1 + index, expected);
+    EXPECT_STREQ(expected, value);
+  }
+
+  StressMap::SimpleStringDictionaryType snapshot;
+  map->Snapshot(&snapshot);
+  EXPECT_EQ(static_cast<size_t>(kStressWriterThreads + 1),
+            snapshot.GetCount());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
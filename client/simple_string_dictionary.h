@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_CLIENT_SIMPLE_STRING_DICTIONARY_H_
 #define CRASHPAD_CLIENT_SIMPLE_STRING_DICTIONARY_H_
 
+#include <stdint.h>
 #include <string.h>
 
 #include "base/basictypes.h"
@@ -27,6 +28,35 @@ namespace crashpad {
 // using one of the constructors.
 struct SerializedSimpleStringDictionary;
 
+namespace internal {
+
+//! \brief Computes the smallest power of two that is greater than or equal to
+//!     \a N, as #value.
+template <size_t N, size_t P = 1, bool Done = (P >= N)>
+struct RoundUpToPowerOf2 {
+  static const size_t value = RoundUpToPowerOf2<N, P * 2>::value;
+};
+
+template <size_t N, size_t P>
+struct RoundUpToPowerOf2<N, P, true> {
+  static const size_t value = P;
+};
+
+//! \brief Hashes a dictionary key, considering no more than \a key_size bytes,
+//!     the number that key comparisons consider.
+inline uint32_t HashSimpleStringDictionaryKey(const char* key,
+                                              size_t key_size) {
+  // 32-bit FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < key_size && key[i] != '\0'; ++i) {
+    hash ^= static_cast<uint8_t>(key[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace internal
+
 //! \brief A map/dictionary collection implementation using a fixed amount of
 //!     storage, so that it does not perform any dynamic allocations for its
 //!     operations.
@@ -39,6 +69,14 @@ struct SerializedSimpleStringDictionary;
 //! glyphs, and include space for a trailing `NUL` byte. This gives space for
 //! `KeySize - 1` and `ValueSize - 1` characters in an entry. \a NumEntries is
 //! the total number of entries that will fit in the map.
+//!
+//! Keys are located through an open-addressing hash index kept alongside the
+//! entries, so that lookups, insertions, and removals do not need to compare
+//! \a key against every entry. The index is also fixed-size, and lookups do
+//! not modify the map, so GetValueForKey() remains safe to call from a signal
+//! handler. Only the entries are serialized by Serialize(): the index is
+//! derived from them, and is rebuilt when a map is constructed from its
+//! serialized form.
 template <size_t KeySize = 256, size_t ValueSize = 256, size_t NumEntries = 64>
 class TSimpleStringDictionary {
  public:
@@ -98,7 +136,9 @@ class TSimpleStringDictionary {
   };
 
   TSimpleStringDictionary()
-      : entries_() {
+      : entries_(),
+        index_(),
+        free_entry_hint_(0) {
   }
 
   TSimpleStringDictionary(const TSimpleStringDictionary& other) {
@@ -107,16 +147,22 @@ class TSimpleStringDictionary {
 
   TSimpleStringDictionary& operator=(const TSimpleStringDictionary& other) {
     memcpy(entries_, other.entries_, sizeof(entries_));
+    memcpy(index_, other.index_, sizeof(index_));
+    free_entry_hint_ = other.free_entry_hint_;
     return *this;
   }
 
   //! \brief Constructs a map from its serialized form. \a map should be the out
   //!     parameter from Serialize(), and \a size should be its return value.
   TSimpleStringDictionary(
-      const SerializedSimpleStringDictionary* map, size_t size) {
+      const SerializedSimpleStringDictionary* map, size_t size)
+      : entries_(),
+        index_(),
+        free_entry_hint_(0) {
     DCHECK_EQ(size, sizeof(entries_));
     if (size == sizeof(entries_)) {
       memcpy(entries_, map, size);
+      RebuildIndex();
     }
   }
 
@@ -178,16 +224,24 @@ class TSimpleStringDictionary {
       return;
     }
 
-    Entry* entry = GetEntryForKey(key);
+    // Locate the entry by the key as it will be stored, which may be
+    // truncated.
+    char stored_key[KeySize];
+    strncpy(stored_key, key, key_size);
+    stored_key[key_size - 1] = '\0';
+
+    Entry* entry = GetEntryForKey(stored_key);
 
-    // If it does not yet exist, attempt to insert it.
+    // If it does not yet exist, attempt to insert it. Entries below
+    // free_entry_hint_ are known to be active.
     if (!entry) {
-      for (size_t i = 0; i < num_entries; ++i) {
+      for (size_t i = free_entry_hint_; i < num_entries; ++i) {
         if (!entries_[i].is_active()) {
           entry = &entries_[i];
+          free_entry_hint_ = i + 1;
 
-          strncpy(entry->key, key, key_size);
-          entry->key[key_size - 1] = '\0';
+          memcpy(entry->key, stored_key, key_size);
+          InsertIntoIndex(i);
 
           break;
         }
@@ -196,20 +250,10 @@ class TSimpleStringDictionary {
 
     // If the map is out of space, entry will be NULL.
     if (!entry) {
+      free_entry_hint_ = num_entries;
       return;
     }
 
-#ifndef NDEBUG
-    // Sanity check that the key only appears once.
-    int count = 0;
-    for (size_t i = 0; i < num_entries; ++i) {
-      if (strncmp(entries_[i].key, key, key_size) == 0) {
-        ++count;
-      }
-    }
-    DCHECK_EQ(count, 1);
-#endif
-
     strncpy(entry->value, value, value_size);
     entry->value[value_size - 1] = '\0';
   }
@@ -225,10 +269,18 @@ class TSimpleStringDictionary {
       return;
     }
 
-    Entry* entry = GetEntryForKey(key);
-    if (entry) {
+    size_t slot = FindSlot(key, Hash(key));
+    if (index_[slot].entry) {
+      size_t entry_index = index_[slot].entry - 1;
+      Entry* entry = &entries_[entry_index];
       entry->key[0] = '\0';
       entry->value[0] = '\0';
+
+      RemoveFromIndex(slot);
+
+      if (entry_index < free_entry_hint_) {
+        free_entry_hint_ = entry_index;
+      }
     }
 
     DCHECK_EQ(GetEntryForKey(key), static_cast<void*>(NULL));
@@ -247,13 +299,118 @@ class TSimpleStringDictionary {
   }
 
  private:
-  const Entry* GetConstEntryForKey(const char* key) const {
+  //! \brief A slot in the hash index.
+  struct IndexSlot {
+    //! \brief One more than the index into #entries_ of the entry that this
+    //!     slot refers to, or `0` if the slot is empty.
+    uint32_t entry;
+
+    //! \brief The hash of the key of the entry that this slot refers to.
+    uint32_t hash;
+  };
+
+  //! \brief The number of slots in the hash index.
+  //!
+  //! This is a power of two, so that hashes can be reduced to slot numbers by
+  //! masking, and is at least twice \a NumEntries, so that the index is never
+  //! more than half full and probe sequences remain short.
+  static const size_t kIndexSize =
+      internal::RoundUpToPowerOf2<NumEntries * 2>::value;
+
+  //! \brief Hashes \a key, considering no more than the \a KeySize bytes that
+  //!     lookups compare.
+  static uint32_t Hash(const char* key) {
+    return internal::HashSimpleStringDictionaryKey(key, key_size);
+  }
+
+  //! \brief Finds the index slot for \a key, whose hash is \a hash.
+  //!
+  //! \return The slot referring to the entry for \a key if it is present.
+  //!     Otherwise, the empty slot at which the probe sequence for \a key
+  //!     ended.
+  size_t FindSlot(const char* key, uint32_t hash) const {
+    size_t slot = hash & (kIndexSize - 1);
+    while (index_[slot].entry) {
+      if (index_[slot].hash == hash &&
+          strncmp(key, entries_[index_[slot].entry - 1].key, key_size) == 0) {
+        break;
+      }
+      slot = (slot + 1) & (kIndexSize - 1);
+    }
+    return slot;
+  }
+
+  //! \brief Adds the entry at \a entry_index, which must be active and not
+  //!     already indexed, to the index.
+  void InsertIntoIndex(size_t entry_index) {
+    const char* key = entries_[entry_index].key;
+    uint32_t hash = Hash(key);
+    size_t slot = FindSlot(key, hash);
+    DCHECK_EQ(index_[slot].entry, 0u);
+    index_[slot].entry = static_cast<uint32_t>(entry_index + 1);
+    index_[slot].hash = hash;
+  }
+
+  //! \brief Empties the index slot \a slot, moving later slots in its probe
+  //!     sequence back so that no lookup will stop short at the emptied slot.
+  void RemoveFromIndex(size_t slot) {
+    index_[slot].entry = 0;
+
+    size_t next_slot = slot;
+    while (true) {
+      next_slot = (next_slot + 1) & (kIndexSize - 1);
+      if (!index_[next_slot].entry) {
+        break;
+      }
+
+      // The entry at next_slot may move to the emptied slot only if that
+      // wouldn’t place it before its home slot in its probe sequence.
+      size_t home_slot = index_[next_slot].hash & (kIndexSize - 1);
+      size_t distance_to_next = (next_slot - home_slot) & (kIndexSize - 1);
+      size_t distance_to_empty = (slot - home_slot) & (kIndexSize - 1);
+      if (distance_to_empty < distance_to_next) {
+        index_[slot] = index_[next_slot];
+        index_[next_slot].entry = 0;
+        slot = next_slot;
+      }
+    }
+  }
+
+  //! \brief Rebuilds the index from #entries_, after they have been replaced
+  //!     wholesale.
+  void RebuildIndex() {
+    memset(index_, 0, sizeof(index_));
+    free_entry_hint_ = 0;
+    bool seen_free_entry = false;
     for (size_t i = 0; i < num_entries; ++i) {
-      if (strncmp(key, entries_[i].key, key_size) == 0) {
-        return &entries_[i];
+      if (!entries_[i].is_active()) {
+        if (!seen_free_entry) {
+          free_entry_hint_ = i;
+          seen_free_entry = true;
+        }
+        continue;
+      }
+
+      // Serialized data comes from elsewhere. If it names a key more than
+      // once, only the first entry for that key will be found.
+      if (index_[FindSlot(entries_[i].key, Hash(entries_[i].key))].entry) {
+        continue;
       }
+
+      InsertIntoIndex(i);
+    }
+
+    if (!seen_free_entry) {
+      free_entry_hint_ = num_entries;
     }
-    return NULL;
+  }
+
+  const Entry* GetConstEntryForKey(const char* key) const {
+    size_t slot = FindSlot(key, Hash(key));
+    if (!index_[slot].entry) {
+      return NULL;
+    }
+    return &entries_[index_[slot].entry - 1];
   }
 
   Entry* GetEntryForKey(const char* key) {
@@ -261,6 +418,11 @@ class TSimpleStringDictionary {
   }
 
   Entry entries_[NumEntries];
+  IndexSlot index_[kIndexSize];
+
+  //! \brief The index into #entries_ at which to begin searching for an
+  //!     inactive entry. All entries before it are active.
+  size_t free_entry_hint_;
 };
 
 //! \brief A TSimpleStringDictionary with default template parameters.
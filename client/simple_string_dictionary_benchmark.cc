@@ -0,0 +1,112 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "client/simple_string_dictionary.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Returns keys for filling three quarters of a dictionary of |num_entries|
+// entries, which is a typical load for an annotation table.
+std::vector<std::string> KeysForEntries(size_t num_entries) {
+  std::vector<std::string> keys;
+  for (size_t index = 0; index < num_entries * 3 / 4; ++index) {
+    char key[32];
+    snprintf(key, sizeof(key), "annotation_key_%zu", index);
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+// Sets and then removes every key in a dictionary of NumEntries entries.
+template <size_t NumEntries>
+void BM_SimpleStringDictionarySetAndRemove(BenchmarkState* state) {
+  typedef TSimpleStringDictionary<256, 256, NumEntries> Dictionary;
+  scoped_ptr<Dictionary> dictionary(new Dictionary());
+  std::vector<std::string> keys = KeysForEntries(NumEntries);
+
+  while (state->KeepRunning()) {
+    for (const std::string& key : keys) {
+      dictionary->SetKeyValue(key.c_str(), "value");
+    }
+    for (const std::string& key : keys) {
+      dictionary->RemoveKey(key.c_str());
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * keys.size() * 2);
+}
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionarySetAndRemove<64>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionarySetAndRemove<256>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionarySetAndRemove<1024>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionarySetAndRemove<4096>);
+
+// Replaces the value of every key in a populated dictionary of NumEntries
+// entries.
+template <size_t NumEntries>
+void BM_SimpleStringDictionaryReplace(BenchmarkState* state) {
+  typedef TSimpleStringDictionary<256, 256, NumEntries> Dictionary;
+  scoped_ptr<Dictionary> dictionary(new Dictionary());
+  std::vector<std::string> keys = KeysForEntries(NumEntries);
+  for (const std::string& key : keys) {
+    dictionary->SetKeyValue(key.c_str(), "value");
+  }
+
+  while (state->KeepRunning()) {
+    for (const std::string& key : keys) {
+      dictionary->SetKeyValue(key.c_str(), "replacement");
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * keys.size());
+}
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryReplace<64>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryReplace<256>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryReplace<1024>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryReplace<4096>);
+
+// Looks up every key in a populated dictionary of NumEntries entries.
+template <size_t NumEntries>
+void BM_SimpleStringDictionaryGetValueForKey(BenchmarkState* state) {
+  typedef TSimpleStringDictionary<256, 256, NumEntries> Dictionary;
+  scoped_ptr<Dictionary> dictionary(new Dictionary());
+  std::vector<std::string> keys = KeysForEntries(NumEntries);
+  for (const std::string& key : keys) {
+    dictionary->SetKeyValue(key.c_str(), "value");
+  }
+
+  while (state->KeepRunning()) {
+    for (const std::string& key : keys) {
+      DoNotOptimize(dictionary->GetValueForKey(key.c_str()));
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * keys.size());
+}
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryGetValueForKey<64>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryGetValueForKey<256>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryGetValueForKey<1024>);
+CRASHPAD_BENCHMARK(BM_SimpleStringDictionaryGetValueForKey<4096>);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
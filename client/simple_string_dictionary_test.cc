@@ -14,7 +14,13 @@
 
 #include "client/simple_string_dictionary.h"
 
+#include <stdio.h>
+
+#include <map>
+#include <string>
+
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
 #include "gtest/gtest.h"
 
 namespace crashpad {
@@ -265,6 +271,74 @@ TEST(SimpleStringDictionary, Serialize) {
   EXPECT_STREQ("hig", deserialized.GetValueForKey("tre"));
 }
 
+TEST(SimpleStringDictionary, ManyEntries) {
+  // Exercise the hash index with enough entries to produce collisions and long
+  // probe sequences, checking against std::map.
+  typedef TSimpleStringDictionary<8, 8, 512> TestMap;
+  scoped_ptr<TestMap> map(new TestMap());
+  std::map<std::string, std::string> expected;
+
+  for (int iteration = 0; iteration < 4; ++iteration) {
+    for (size_t i = 0; i < TestMap::num_entries; ++i) {
+      // Remove every third key on alternate iterations, so that removals leave
+      // holes in probe sequences and in the entry array.
+      char key[TestMap::key_size];
+      snprintf(key, sizeof(key), "k%zu", (i * 7919) % 1000);
+      if (iteration % 2 == 1 && i % 3 == 0) {
+        map->RemoveKey(key);
+        expected.erase(key);
+        continue;
+      }
+
+      char value[TestMap::value_size];
+      snprintf(value, sizeof(value), "v%d.%zu", iteration, i);
+      map->SetKeyValue(key, value);
+      if (expected.size() < TestMap::num_entries ||
+          expected.find(key) != expected.end()) {
+        expected[key] = value;
+      }
+    }
+
+    SCOPED_TRACE(iteration);
+    ASSERT_EQ(expected.size(), map->GetCount());
+    for (const auto& it : expected) {
+      EXPECT_STREQ(it.second.c_str(), map->GetValueForKey(it.first.c_str()));
+    }
+
+    // The index is rebuilt for a map constructed from its serialized form.
+    const SerializedSimpleStringDictionary* serialized;
+    size_t size = map->Serialize(&serialized);
+    scoped_ptr<TestMap> deserialized(new TestMap(serialized, size));
+    for (const auto& it : expected) {
+      EXPECT_STREQ(it.second.c_str(),
+                   deserialized->GetValueForKey(it.first.c_str()));
+    }
+    EXPECT_FALSE(deserialized->GetValueForKey("absent"));
+  }
+}
+
+TEST(SimpleStringDictionary, LongKey) {
+  TSimpleStringDictionary<4, 4, 4> map;
+
+  // Keys are truncated when stored, and are only found by their stored form.
+  map.SetKeyValue("abcdef", "1");
+  EXPECT_EQ(1u, map.GetCount());
+  EXPECT_STREQ("1", map.GetValueForKey("abc"));
+  EXPECT_FALSE(map.GetValueForKey("abcdef"));
+
+  map.SetKeyValue("abc", "2");
+  EXPECT_EQ(1u, map.GetCount());
+  EXPECT_STREQ("2", map.GetValueForKey("abc"));
+
+  // Setting an over-long key again replaces the entry for its stored form.
+  map.SetKeyValue("abcxyz", "3");
+  EXPECT_EQ(1u, map.GetCount());
+  EXPECT_STREQ("3", map.GetValueForKey("abc"));
+
+  map.RemoveKey("abc");
+  EXPECT_EQ(0u, map.GetCount());
+}
+
 // Running out of space shouldn't crash.
 TEST(SimpleStringDictionary, OutOfSpace) {
   TSimpleStringDictionary<3, 2, 2> map;
@@ -24,6 +24,8 @@
         'mac/mach-o/getsect.h',
         'mac/mach-o/loader.h',
         'non_mac/mach/mach.h',
+        'non_mac/mach-o/loader.h',
+        'non_mac/mach-o/nlist.h',
         'non_win/dbghelp.h',
         'non_win/minwinbase.h',
         'non_win/timezoneapi.h',
@@ -43,6 +45,15 @@
               'mac',
             ],
           },
+        }, {  # else: OS!="mac"
+          'include_dirs': [
+            'non_mac',
+          ],
+          'direct_dependent_settings': {
+            'include_dirs': [
+              'non_mac',
+            ],
+          },
         }],
         ['OS!="win"', {
           'include_dirs': [
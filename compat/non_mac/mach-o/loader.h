@@ -0,0 +1,113 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_COMPAT_NON_MAC_MACH_O_LOADER_H_
+#define CRASHPAD_COMPAT_NON_MAC_MACH_O_LOADER_H_
+
+//! \file
+
+//! \anchor MH_MAGIC_x
+//! \name MH_MAGIC*
+//!
+//! \brief Mach-O header magic numbers, in the byte order of the image.
+//! \{
+#define MH_MAGIC 0xfeedface
+#define MH_CIGAM 0xcefaedfe
+#define MH_MAGIC_64 0xfeedfacf
+#define MH_CIGAM_64 0xcffaedfe
+//! \}
+
+//! \anchor MH_x
+//! \name MH_*
+//!
+//! \brief Mach-O file types.
+//! \{
+#define MH_OBJECT 0x1
+#define MH_EXECUTE 0x2
+#define MH_FVMLIB 0x3
+#define MH_CORE 0x4
+#define MH_PRELOAD 0x5
+#define MH_DYLIB 0x6
+#define MH_DYLINKER 0x7
+#define MH_BUNDLE 0x8
+#define MH_DYLIB_STUB 0x9
+#define MH_DSYM 0xa
+#define MH_KEXT_BUNDLE 0xb
+//! \}
+
+//! \brief Set in load commands that dyld must understand in order to load an
+//!     image.
+#define LC_REQ_DYLD 0x80000000
+
+//! \anchor LC_x
+//! \name LC_*
+//!
+//! \brief Mach-O load command types.
+//! \{
+#define LC_SEGMENT 0x1
+#define LC_SYMTAB 0x2
+#define LC_DYSYMTAB 0xb
+#define LC_LOAD_DYLIB 0xc
+#define LC_ID_DYLIB 0xd
+#define LC_LOAD_DYLINKER 0xe
+#define LC_ID_DYLINKER 0xf
+#define LC_SEGMENT_64 0x19
+#define LC_UUID 0x1b
+#define LC_DYLD_INFO 0x22
+#define LC_DYLD_INFO_ONLY (0x22 | LC_REQ_DYLD)
+#define LC_SOURCE_VERSION 0x2a
+//! \}
+
+//! \anchor SEG_x
+//! \name SEG_* and SECT_*
+//!
+//! \brief Conventional Mach-O segment and section names.
+//! \{
+#define SEG_PAGEZERO "__PAGEZERO"
+#define SEG_TEXT "__TEXT"
+#define SECT_TEXT "__text"
+#define SECT_FVMLIB_INIT0 "__fvmlib_init0"
+#define SECT_FVMLIB_INIT1 "__fvmlib_init1"
+#define SEG_DATA "__DATA"
+#define SECT_DATA "__data"
+#define SECT_BSS "__bss"
+#define SECT_COMMON "__common"
+#define SEG_OBJC "__OBJC"
+#define SECT_OBJC_SYMBOLS "__symbol_table"
+#define SECT_OBJC_MODULES "__module_info"
+#define SECT_OBJC_STRINGS "__selector_strs"
+#define SECT_OBJC_REFS "__selector_refs"
+#define SEG_ICON "__ICON"
+#define SECT_ICON_HEADER "__header"
+#define SECT_ICON_TIFF "__tiff"
+#define SEG_LINKEDIT "__LINKEDIT"
+#define SEG_UNIXSTACK "__UNIXSTACK"
+#define SEG_IMPORT "__IMPORT"
+//! \}
+
+//! \brief The mask that selects the section type from a section’s flags.
+#define SECTION_TYPE 0x000000ff
+
+//! \anchor S_x
+//! \name S_*
+//!
+//! \brief Mach-O section types.
+//! \{
+#define S_REGULAR 0x0
+#define S_ZEROFILL 0x1
+#define S_GB_ZEROFILL 0xc
+#define S_THREAD_LOCAL_ZEROFILL 0x12
+//! \}
+
+#endif  // CRASHPAD_COMPAT_NON_MAC_MACH_O_LOADER_H_
@@ -0,0 +1,43 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_COMPAT_NON_MAC_MACH_O_NLIST_H_
+#define CRASHPAD_COMPAT_NON_MAC_MACH_O_NLIST_H_
+
+//! \file
+
+//! \anchor N_x
+//! \name N_*
+//!
+//! \brief Masks and values for the `n_type` field of `nlist` and `nlist_64`.
+//! \{
+#define N_STAB 0xe0
+#define N_PEXT 0x10
+#define N_TYPE 0x0e
+#define N_EXT 0x01
+
+#define N_UNDF 0x0
+#define N_ABS 0x2
+#define N_SECT 0xe
+#define N_PBUD 0xc
+#define N_INDR 0xa
+//! \}
+
+//! \brief The `n_sect` value of a symbol that is not in any section.
+#define NO_SECT 0
+
+//! \brief The largest `n_sect` value.
+#define MAX_SECT 255
+
+#endif  // CRASHPAD_COMPAT_NON_MAC_MACH_O_NLIST_H_
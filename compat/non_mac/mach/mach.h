@@ -17,6 +17,8 @@
 
 //! \file
 
+#include <stdint.h>
+
 // <mach/exception_types.h>
 
 //! \anchor EXC_x
@@ -38,4 +40,30 @@
 #define EXC_GUARD 12
 //! \}
 
+// <mach/i386/vm_types.h>
+
+//! \brief An address in a Mach task’s address space.
+typedef uint64_t mach_vm_address_t;
+
+//! \brief A size in a Mach task’s address space.
+typedef uint64_t mach_vm_size_t;
+
+// <mach/vm_prot.h>
+
+//! \brief Virtual memory protection.
+typedef int vm_prot_t;
+
+//! \anchor VM_PROT_x
+//! \name VM_PROT_*
+//!
+//! \brief Virtual memory protection values.
+//! \{
+#define VM_PROT_NONE 0x00
+#define VM_PROT_READ 0x01
+#define VM_PROT_WRITE 0x02
+#define VM_PROT_EXECUTE 0x04
+#define VM_PROT_DEFAULT (VM_PROT_READ | VM_PROT_WRITE)
+#define VM_PROT_ALL (VM_PROT_READ | VM_PROT_WRITE | VM_PROT_EXECUTE)
+//! \}
+
 #endif  // CRASHPAD_COMPAT_NON_MAC_MACH_MACH_H_
@@ -19,6 +19,7 @@
       'type': 'none',
       'suppress_wildcard': 1,
       'dependencies': [
+        'crashpad_benchmarks',
         'client/client.gyp:*',
         'compat/compat.gyp:*',
         'minidump/minidump.gyp:*',
@@ -31,5 +32,53 @@
         'package.h',
       ],
     },
+    {
+      'target_name': 'crashpad_benchmarks',
+      'type': 'executable',
+      'dependencies': [
+        'client/client.gyp:client',
+        'compat/compat.gyp:compat',
+        'minidump/minidump.gyp:minidump',
+        'snapshot/snapshot.gyp:snapshot_test_lib',
+        'third_party/mini_chromium/mini_chromium/base/base.gyp:base',
+        'util/util.gyp:util',
+        'util/util.gyp:util_test_lib',
+      ],
+      'include_dirs': [
+        '.',
+      ],
+      'sources': [
+        'client/concurrent_simple_string_dictionary_benchmark.cc',
+        'client/simple_string_dictionary_benchmark.cc',
+        'minidump/minidump_benchmark_util.cc',
+        'minidump/minidump_benchmark_util.h',
+        'minidump/minidump_file_reader_benchmark.cc',
+        'minidump/minidump_file_writer_benchmark.cc',
+        'minidump/minidump_writable_benchmark.cc',
+        'minidump/minidump_writer_util_benchmark.cc',
+        'util/file/chunked_file_writer_benchmark.cc',
+        'util/file/file_writer_benchmark.cc',
+        'util/file/string_file_writer_benchmark.cc',
+        'util/mac/mach_o_image_reader_benchmark.cc',
+        'util/misc/buffer_remote_memory_benchmark.cc',
+        'util/misc/cached_remote_memory_benchmark.cc',
+        'util/misc/log_context_benchmark.cc',
+        'util/misc/uuid_benchmark.cc',
+        'util/numeric/checked_range_benchmark.cc',
+        'util/stdlib/flat_address_map_benchmark.cc',
+        'util/stdlib/flat_string_map_benchmark.cc',
+        'util/stdlib/utf8_to_utf16_benchmark.cc',
+        'util/test/benchmark.cc',
+        'util/test/benchmark.h',
+        'util/test/benchmark_main.cc',
+      ],
+      'target_conditions': [
+        ['OS!="mac"', {
+          'sources/': [
+            ['include', '^util/mac/mach_o_image_reader_benchmark\\.cc$'],
+          ],
+        }],
+      ],
+    },
   ],
 }
@@ -19,6 +19,7 @@
       'type': 'static_library',
       'dependencies': [
         '../compat/compat.gyp:compat',
+        '../snapshot/snapshot.gyp:snapshot',
         '../third_party/mini_chromium/mini_chromium/base/base.gyp:base',
         '../util/util.gyp:util',
       ],
@@ -32,8 +33,12 @@
         'minidump_context.h',
         'minidump_context_writer.cc',
         'minidump_context_writer.h',
+        'minidump_exception_writer.cc',
+        'minidump_exception_writer.h',
         'minidump_extensions.cc',
         'minidump_extensions.h',
+        'minidump_file_reader.cc',
+        'minidump_file_reader.h',
         'minidump_file_writer.cc',
         'minidump_file_writer.h',
         'minidump_memory_writer.cc',
@@ -42,12 +47,18 @@
         'minidump_misc_info_writer.h',
         'minidump_module_writer.cc',
         'minidump_module_writer.h',
+        'minidump_stream_views.cc',
+        'minidump_stream_views.h',
         'minidump_stream_writer.cc',
         'minidump_stream_writer.h',
         'minidump_string_writer.cc',
         'minidump_string_writer.h',
         'minidump_system_info_writer.cc',
         'minidump_system_info_writer.h',
+        'minidump_thread_id_map.cc',
+        'minidump_thread_id_map.h',
+        'minidump_thread_writer.cc',
+        'minidump_thread_writer.h',
         'minidump_writable.cc',
         'minidump_writable.h',
         'minidump_writer_util.cc',
@@ -59,9 +70,11 @@
       'type': 'executable',
       'dependencies': [
         'minidump',
+        '../snapshot/snapshot.gyp:snapshot_test_lib',
         '../third_party/gtest/gtest.gyp:gtest',
         '../third_party/gtest/gtest.gyp:gtest_main',
         '../third_party/mini_chromium/mini_chromium/base/base.gyp:base',
+        '../util/util.gyp:util_test_lib',
       ],
       'include_dirs': [
         '..',
@@ -70,16 +83,20 @@
         'minidump_context_test_util.cc',
         'minidump_context_test_util.h',
         'minidump_context_writer_test.cc',
+        'minidump_exception_writer_test.cc',
+        'minidump_file_reader_test.cc',
         'minidump_file_writer_test.cc',
         'minidump_memory_writer_test.cc',
         'minidump_memory_writer_test_util.cc',
         'minidump_memory_writer_test_util.h',
         'minidump_misc_info_writer_test.cc',
         'minidump_module_writer_test.cc',
+        'minidump_stream_views_test.cc',
         'minidump_string_writer_test.cc',
         'minidump_system_info_writer_test.cc',
         'minidump_test_util.cc',
         'minidump_test_util.h',
+        'minidump_thread_writer_test.cc',
         'minidump_writable_test.cc',
       ],
     },
@@ -0,0 +1,116 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_benchmark_util.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const char kZeroes[BenchmarkMemoryWriter::kMaximumSize] = {};
+
+}  // namespace
+
+const size_t BenchmarkMemoryWriter::kMaximumSize;
+
+BenchmarkMemoryWriter::BenchmarkMemoryWriter()
+    : MinidumpMemoryWriter(), base_address_(0), size_(0) {
+}
+
+BenchmarkMemoryWriter::~BenchmarkMemoryWriter() {
+}
+
+void BenchmarkMemoryWriter::SetRange(uint64_t base_address, size_t size) {
+  DCHECK_LE(size, kMaximumSize);
+
+  base_address_ = base_address;
+  size_ = size;
+}
+
+uint64_t BenchmarkMemoryWriter::MemoryRangeBaseAddress() const {
+  return base_address_;
+}
+
+size_t BenchmarkMemoryWriter::MemoryRangeSize() const {
+  return size_;
+}
+
+bool BenchmarkMemoryWriter::WriteMemory(FileWriterInterface* file_writer) {
+  return size_ == 0 || file_writer->Write(kZeroes, size_);
+}
+
+DiscardingFileWriter::DiscardingFileWriter() : offset_(0), size_(0) {
+}
+
+DiscardingFileWriter::~DiscardingFileWriter() {
+}
+
+void DiscardingFileWriter::Reset() {
+  offset_ = 0;
+  size_ = 0;
+}
+
+bool DiscardingFileWriter::Write(const void* data, size_t size) {
+  offset_ += size;
+  size_ = std::max(size_, offset_);
+  return true;
+}
+
+bool DiscardingFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  for (const WritableIoVec& iov : *iovecs) {
+    Write(iov.iov_base, iov.iov_len);
+  }
+  return true;
+}
+
+off_t DiscardingFileWriter::Seek(off_t offset, int whence) {
+  off_t base_offset;
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+    case SEEK_CUR:
+      base_offset = offset_;
+      break;
+    case SEEK_END:
+      base_offset = size_;
+      break;
+    default:
+      LOG(ERROR) << "Seek(): invalid whence " << whence;
+      return -1;
+  }
+
+  if (base_offset + offset < 0) {
+    LOG(ERROR) << "Seek(): new offset " << base_offset + offset
+               << " is negative";
+    return -1;
+  }
+
+  offset_ = base_offset + offset;
+  return offset_;
+}
+
+}  // namespace test
+}  // namespace crashpad
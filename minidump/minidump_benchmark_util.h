@@ -0,0 +1,90 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_BENCHMARK_UTIL_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_BENCHMARK_UTIL_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "minidump/minidump_memory_writer.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief A MinidumpMemoryWriter whose contents are all zero, for building
+//!     large minidump trees cheaply in benchmarks.
+//!
+//! Objects of this class are default-constructible so that they may be
+//! created by Arena::New().
+class BenchmarkMemoryWriter final : public MinidumpMemoryWriter {
+ public:
+  //! \brief The largest size that may be passed to SetRange().
+  static const size_t kMaximumSize = 1024 * 1024;
+
+  BenchmarkMemoryWriter();
+  ~BenchmarkMemoryWriter();
+
+  //! \brief Sets the memory region that this object writes.
+  void SetRange(uint64_t base_address, size_t size);
+
+ protected:
+  // MinidumpMemoryWriter:
+  virtual uint64_t MemoryRangeBaseAddress() const override;
+  virtual size_t MemoryRangeSize() const override;
+  virtual bool WriteMemory(FileWriterInterface* file_writer) override;
+
+ private:
+  uint64_t base_address_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkMemoryWriter);
+};
+
+//! \brief A FileWriterInterface that discards everything written to it.
+//!
+//! Only the file position and size of the virtual file are tracked, so that
+//! benchmarks can measure the cost of producing output without also measuring
+//! the cost of storing it.
+class DiscardingFileWriter final : public FileWriterInterface {
+ public:
+  DiscardingFileWriter();
+  ~DiscardingFileWriter();
+
+  //! \brief Returns the size of the virtual file.
+  off_t size() const { return size_; }
+
+  //! \brief Resets the virtual file to be empty, and its position to `0`.
+  void Reset();
+
+  // FileWriterInterface:
+  virtual bool Write(const void* data, size_t size) override;
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+  virtual off_t Seek(off_t offset, int whence) override;
+
+ private:
+  off_t offset_;
+  off_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(DiscardingFileWriter);
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_BENCHMARK_UTIL_H_
@@ -14,13 +14,135 @@
 
 #include "minidump/minidump_context_writer.h"
 
+#include <string.h>
+
 #include "base/logging.h"
+#include "snapshot/cpu_context.h"
+
+namespace {
+
+// Converts an abridged x87 FPU tag word, as stored in an fxsave area, to a full
+// tag word, as stored in an fsave area. The abridged form has one bit per
+// physical register, set for registers that are not empty. The full form has
+// two bits per physical register, distinguishing valid, zero, special, and
+// empty registers, which must be determined by examining the registers’
+// contents. st_mm is in stack order, ST(0) through ST(7).
+uint16_t FxsaveToFsaveTagWord(
+    uint16_t fsw,
+    uint8_t fxsave_tag,
+    const crashpad::CPUContextX86::X87OrMMXRegister st_mm[8]) {
+  enum {
+    kX87TagValid = 0,
+    kX87TagZero,
+    kX87TagSpecial,
+    kX87TagEmpty,
+  };
+
+  // The top-of-stack physical register number.
+  int stack_top = (fsw >> 11) & 0x7;
+
+  uint16_t fsave_tag = 0;
+  for (int physical_index = 0; physical_index < 8; ++physical_index) {
+    uint16_t tag;
+    if (!(fxsave_tag & (1 << physical_index))) {
+      tag = kX87TagEmpty;
+    } else {
+      const uint8_t* st = st_mm[(physical_index - stack_top) & 0x7].st;
+
+      // The 80-bit register holds a 64-bit significand, including an explicit
+      // integer bit, followed by a 15-bit exponent and a sign bit.
+      uint16_t exponent = ((st[9] & 0x7f) << 8) | st[8];
+      bool integer_bit = (st[7] & 0x80) != 0;
+      bool significand_zero = true;
+      for (size_t index = 0; index < 8; ++index) {
+        if (st[index]) {
+          significand_zero = false;
+          break;
+        }
+      }
+
+      if (exponent == 0x7fff) {
+        // Infinity, NaN, or an invalid encoding.
+        tag = kX87TagSpecial;
+      } else if (exponent == 0) {
+        // Zero, or a denormal.
+        tag = significand_zero ? kX87TagZero : kX87TagSpecial;
+      } else {
+        // A normal value, or an unnormal if the integer bit is clear.
+        tag = integer_bit ? kX87TagValid : kX87TagSpecial;
+      }
+    }
+
+    fsave_tag |= tag << (physical_index * 2);
+  }
+
+  return fsave_tag;
+}
+
+}  // namespace
 
 namespace crashpad {
 
 MinidumpContextWriter::~MinidumpContextWriter() {
 }
 
+// static
+scoped_ptr<MinidumpContextWriter> MinidumpContextWriter::CreateFromSnapshot(
+    const CPUContext* context_snapshot) {
+  scoped_ptr<MinidumpContextWriter> context;
+  CreateFromSnapshotImpl(context_snapshot, NULL, &context);
+  return context.Pass();
+}
+
+// static
+MinidumpContextWriter* MinidumpContextWriter::CreateFromSnapshotInArena(
+    const CPUContext* context_snapshot,
+    Arena* arena) {
+  return CreateFromSnapshotImpl(context_snapshot, arena, NULL);
+}
+
+// static
+template <typename T>
+T* MinidumpContextWriter::NewContextWriter(
+    Arena* arena,
+    scoped_ptr<MinidumpContextWriter>* owner) {
+  if (arena) {
+    return NewInArena<T>(arena);
+  }
+
+  T* context = new T();
+  owner->reset(context);
+  return context;
+}
+
+// static
+MinidumpContextWriter* MinidumpContextWriter::CreateFromSnapshotImpl(
+    const CPUContext* context_snapshot,
+    Arena* arena,
+    scoped_ptr<MinidumpContextWriter>* owner) {
+  switch (context_snapshot->architecture) {
+    case kCPUArchitectureX86: {
+      MinidumpContextX86Writer* context_x86 =
+          NewContextWriter<MinidumpContextX86Writer>(arena, owner);
+      context_x86->InitializeFromSnapshot(context_snapshot->x86);
+      return context_x86;
+    }
+
+    case kCPUArchitectureX86_64: {
+      MinidumpContextAMD64Writer* context_amd64 =
+          NewContextWriter<MinidumpContextAMD64Writer>(arena, owner);
+      context_amd64->InitializeFromSnapshot(context_snapshot->x86_64);
+      return context_amd64;
+    }
+
+    default: {
+      LOG(ERROR) << "unknown context architecture "
+                 << context_snapshot->architecture;
+      return NULL;
+    }
+  }
+}
+
 size_t MinidumpContextWriter::SizeOfObject() {
   DCHECK_GE(state(), kStateFrozen);
 
@@ -35,6 +157,63 @@ MinidumpContextX86Writer::MinidumpContextX86Writer()
 MinidumpContextX86Writer::~MinidumpContextX86Writer() {
 }
 
+void MinidumpContextX86Writer::InitializeFromSnapshot(
+    const CPUContextX86* context_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK_EQ(context_.context_flags, kMinidumpContextX86);
+
+  context_.context_flags = kMinidumpContextX86All;
+
+  context_.dr0 = context_snapshot->dr0;
+  context_.dr1 = context_snapshot->dr1;
+  context_.dr2 = context_snapshot->dr2;
+  context_.dr3 = context_snapshot->dr3;
+  context_.dr6 = context_snapshot->dr6;
+  context_.dr7 = context_snapshot->dr7;
+
+  const CPUContextX86::Fxsave& fxsave = context_snapshot->fxsave;
+  context_.float_save.control_word = fxsave.fcw;
+  context_.float_save.status_word = fxsave.fsw;
+  context_.float_save.tag_word =
+      FxsaveToFsaveTagWord(fxsave.fsw, fxsave.ftw, fxsave.st_mm);
+  context_.float_save.error_offset = fxsave.fpu_ip;
+  context_.float_save.error_selector = fxsave.fpu_cs;
+  context_.float_save.data_offset = fxsave.fpu_dp;
+  context_.float_save.data_selector = fxsave.fpu_ds;
+
+  static_assert(arraysize(context_.float_save.register_area) ==
+                    arraysize(fxsave.st_mm) * sizeof(fxsave.st_mm[0].st),
+                "register_area size");
+  for (size_t index = 0; index < arraysize(fxsave.st_mm); ++index) {
+    memcpy(&context_.float_save.register_area[index *
+                                              sizeof(fxsave.st_mm[0].st)],
+           fxsave.st_mm[index].st,
+           sizeof(fxsave.st_mm[index].st));
+  }
+
+  context_.gs = context_snapshot->gs;
+  context_.fs = context_snapshot->fs;
+  context_.es = context_snapshot->es;
+  context_.ds = context_snapshot->ds;
+  context_.edi = context_snapshot->edi;
+  context_.esi = context_snapshot->esi;
+  context_.ebx = context_snapshot->ebx;
+  context_.edx = context_snapshot->edx;
+  context_.ecx = context_snapshot->ecx;
+  context_.eax = context_snapshot->eax;
+  context_.ebp = context_snapshot->ebp;
+  context_.eip = context_snapshot->eip;
+  context_.cs = context_snapshot->cs;
+  context_.eflags = context_snapshot->eflags;
+  context_.esp = context_snapshot->esp;
+  context_.ss = context_snapshot->ss;
+
+  // The extended registers are stored in fxsave format.
+  static_assert(sizeof(context_.extended_registers) == sizeof(fxsave),
+                "extended_registers size");
+  memcpy(context_.extended_registers, &fxsave, sizeof(fxsave));
+}
+
 bool MinidumpContextX86Writer::WriteObject(FileWriterInterface* file_writer) {
   DCHECK_EQ(state(), kStateWritable);
 
@@ -55,6 +234,51 @@ MinidumpContextAMD64Writer::MinidumpContextAMD64Writer()
 MinidumpContextAMD64Writer::~MinidumpContextAMD64Writer() {
 }
 
+void MinidumpContextAMD64Writer::InitializeFromSnapshot(
+    const CPUContextX86_64* context_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK_EQ(context_.context_flags, kMinidumpContextAMD64);
+
+  context_.context_flags = kMinidumpContextAMD64All;
+
+  context_.mx_csr = context_snapshot->fxsave.mxcsr;
+  context_.cs = context_snapshot->cs;
+  context_.fs = context_snapshot->fs;
+  context_.gs = context_snapshot->gs;
+  // The top 32 bits of rflags are reserved and always zero.
+  context_.eflags = static_cast<uint32_t>(context_snapshot->rflags);
+  context_.dr0 = context_snapshot->dr0;
+  context_.dr1 = context_snapshot->dr1;
+  context_.dr2 = context_snapshot->dr2;
+  context_.dr3 = context_snapshot->dr3;
+  context_.dr6 = context_snapshot->dr6;
+  context_.dr7 = context_snapshot->dr7;
+  context_.rax = context_snapshot->rax;
+  context_.rcx = context_snapshot->rcx;
+  context_.rdx = context_snapshot->rdx;
+  context_.rbx = context_snapshot->rbx;
+  context_.rsp = context_snapshot->rsp;
+  context_.rbp = context_snapshot->rbp;
+  context_.rsi = context_snapshot->rsi;
+  context_.rdi = context_snapshot->rdi;
+  context_.r8 = context_snapshot->r8;
+  context_.r9 = context_snapshot->r9;
+  context_.r10 = context_snapshot->r10;
+  context_.r11 = context_snapshot->r11;
+  context_.r12 = context_snapshot->r12;
+  context_.r13 = context_snapshot->r13;
+  context_.r14 = context_snapshot->r14;
+  context_.r15 = context_snapshot->r15;
+  context_.rip = context_snapshot->rip;
+
+  // The floating-point area is stored in fxsave format.
+  static_assert(sizeof(context_.float_save) == sizeof(context_snapshot->fxsave),
+                "float_save size");
+  memcpy(&context_.float_save,
+         &context_snapshot->fxsave,
+         sizeof(context_snapshot->fxsave));
+}
+
 size_t MinidumpContextAMD64Writer::Alignment() {
   DCHECK_GE(state(), kStateFrozen);
 
@@ -18,18 +18,46 @@
 #include <sys/types.h>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "minidump/minidump_context.h"
 #include "minidump/minidump_writable.h"
 #include "util/file/file_writer.h"
 
 namespace crashpad {
 
+struct CPUContext;
+struct CPUContextX86;
+struct CPUContextX86_64;
+
 //! \brief The base class for writers of CPU context structures in minidump
 //!     files.
 class MinidumpContextWriter : public internal::MinidumpWritable {
  public:
   virtual ~MinidumpContextWriter();
 
+  //! \brief Creates a context writer suitable for a given CPU context
+  //!     snapshot.
+  //!
+  //! \param[in] context_snapshot The CPU context snapshot to use as source
+  //!     data.
+  //!
+  //! \return A new MinidumpContextWriter subclass, such as
+  //!     MinidumpContextX86Writer or MinidumpContextAMD64Writer, initialized
+  //!     from \a context_snapshot. The caller takes ownership of the object.
+  //!     On failure, for example, if \a context_snapshot identifies an
+  //!     unsupported CPU architecture, `NULL`, with a message logged.
+  static scoped_ptr<MinidumpContextWriter> CreateFromSnapshot(
+      const CPUContext* context_snapshot);
+
+  //! \brief Creates a context writer suitable for a given CPU context
+  //!     snapshot in \a arena.
+  //!
+  //! This is the same as CreateFromSnapshot(), except that the new object is
+  //! created by NewInArena(), and is owned by \a arena.
+  static MinidumpContextWriter* CreateFromSnapshotInArena(
+      const CPUContext* context_snapshot,
+      Arena* arena);
+
  protected:
   MinidumpContextWriter() : MinidumpWritable() {}
 
@@ -44,6 +72,19 @@ class MinidumpContextWriter : public internal::MinidumpWritable {
   virtual size_t SizeOfObject() override final;
 
  private:
+  //! \brief Creates an object of type \a T in \a arena if it isn’t `NULL`,
+  //!     and otherwise on the heap, owned by \a owner.
+  template <typename T>
+  static T* NewContextWriter(Arena* arena,
+                             scoped_ptr<MinidumpContextWriter>* owner);
+
+  //! \brief The implementation of CreateFromSnapshot() and
+  //!     CreateFromSnapshotInArena().
+  static MinidumpContextWriter* CreateFromSnapshotImpl(
+      const CPUContext* context_snapshot,
+      Arena* arena,
+      scoped_ptr<MinidumpContextWriter>* owner);
+
   DISALLOW_COPY_AND_ASSIGN(MinidumpContextWriter);
 };
 
@@ -53,6 +94,15 @@ class MinidumpContextX86Writer final : public MinidumpContextWriter {
   MinidumpContextX86Writer();
   virtual ~MinidumpContextX86Writer();
 
+  //! \brief Initializes the MinidumpContextX86 based on \a context_snapshot.
+  //!
+  //! \param[in] context_snapshot The context snapshot to use as source data.
+  //!
+  //! \note Valid in #kStateMutable. No mutation of context() may be done
+  //!     before calling this method, and it is not normally necessary to
+  //!     alter context() after calling this method.
+  void InitializeFromSnapshot(const CPUContextX86* context_snapshot);
+
   //! \brief Returns a pointer to the context structure that this object will
   //!     write.
   //!
@@ -84,6 +134,15 @@ class MinidumpContextAMD64Writer final : public MinidumpContextWriter {
   MinidumpContextAMD64Writer();
   virtual ~MinidumpContextAMD64Writer();
 
+  //! \brief Initializes the MinidumpContextAMD64 based on \a context_snapshot.
+  //!
+  //! \param[in] context_snapshot The context snapshot to use as source data.
+  //!
+  //! \note Valid in #kStateMutable. No mutation of context() may be done
+  //!     before calling this method, and it is not normally necessary to
+  //!     alter context() after calling this method.
+  void InitializeFromSnapshot(const CPUContextX86_64* context_snapshot);
+
   //! \brief Returns a pointer to the context structure that this object will
   //!     write.
   //!
@@ -15,10 +15,14 @@
 #include "minidump/minidump_context_writer.h"
 
 #include <stdint.h>
+#include <string.h>
 
+#include "base/basictypes.h"
 #include "gtest/gtest.h"
 #include "minidump/minidump_context.h"
 #include "minidump/minidump_context_test_util.h"
+#include "snapshot/cpu_context.h"
+#include "snapshot/test/test_cpu_context.h"
 #include "util/file/string_file_writer.h"
 
 namespace crashpad {
@@ -97,6 +101,156 @@ TEST(MinidumpContextWriter, MinidumpContextAMD64Writer) {
   }
 }
 
+TEST(MinidumpContextWriter, X86FromSnapshot) {
+  CPUContextX86 context_x86;
+  InitializeCPUContextX86(&context_x86, 1);
+
+  // Set up the x87 stack so that each kind of tag is represented. The top of
+  // the stack is physical register 5, so ST(i) is physical register
+  // (5 + i) % 8.
+  context_x86.fxsave.fsw = 5 << 11;
+  context_x86.fxsave.ftw = 0xfe;  // Physical register 0 is empty.
+  memset(context_x86.fxsave.st_mm, 0, sizeof(context_x86.fxsave.st_mm));
+
+  // ST(0), physical 5: valid, 1.0.
+  context_x86.fxsave.st_mm[0].st[7] = 0x80;
+  context_x86.fxsave.st_mm[0].st[8] = 0xff;
+  context_x86.fxsave.st_mm[0].st[9] = 0x3f;
+
+  // ST(1), physical 6: zero.
+
+  // ST(2), physical 7: special, infinity.
+  context_x86.fxsave.st_mm[2].st[7] = 0x80;
+  context_x86.fxsave.st_mm[2].st[8] = 0xff;
+  context_x86.fxsave.st_mm[2].st[9] = 0x7f;
+
+  // ST(3), physical 0: empty, regardless of its content.
+  context_x86.fxsave.st_mm[3].st[0] = 1;
+
+  // ST(4) through ST(7), physical 1 through 4: special, denormal.
+  for (size_t index = 4; index < 8; ++index) {
+    context_x86.fxsave.st_mm[index].st[0] = 1;
+  }
+
+  CPUContext context_snapshot;
+  context_snapshot.architecture = kCPUArchitectureX86;
+  context_snapshot.x86 = &context_x86;
+
+  scoped_ptr<MinidumpContextWriter> context_writer =
+      MinidumpContextWriter::CreateFromSnapshot(&context_snapshot);
+  ASSERT_TRUE(context_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(context_writer->WriteEverything(&file_writer));
+  ASSERT_EQ(sizeof(MinidumpContextX86), file_writer.string().size());
+
+  const MinidumpContextX86* observed =
+      reinterpret_cast<const MinidumpContextX86*>(&file_writer.string()[0]);
+  EXPECT_EQ(kMinidumpContextX86All, observed->context_flags);
+  EXPECT_EQ(context_x86.eax, observed->eax);
+  EXPECT_EQ(context_x86.ebx, observed->ebx);
+  EXPECT_EQ(context_x86.ecx, observed->ecx);
+  EXPECT_EQ(context_x86.edx, observed->edx);
+  EXPECT_EQ(context_x86.edi, observed->edi);
+  EXPECT_EQ(context_x86.esi, observed->esi);
+  EXPECT_EQ(context_x86.ebp, observed->ebp);
+  EXPECT_EQ(context_x86.esp, observed->esp);
+  EXPECT_EQ(context_x86.eip, observed->eip);
+  EXPECT_EQ(context_x86.eflags, observed->eflags);
+  EXPECT_EQ(context_x86.cs, observed->cs);
+  EXPECT_EQ(context_x86.ds, observed->ds);
+  EXPECT_EQ(context_x86.es, observed->es);
+  EXPECT_EQ(context_x86.fs, observed->fs);
+  EXPECT_EQ(context_x86.gs, observed->gs);
+  EXPECT_EQ(context_x86.ss, observed->ss);
+  EXPECT_EQ(context_x86.dr0, observed->dr0);
+  EXPECT_EQ(context_x86.dr1, observed->dr1);
+  EXPECT_EQ(context_x86.dr2, observed->dr2);
+  EXPECT_EQ(context_x86.dr3, observed->dr3);
+  EXPECT_EQ(context_x86.dr6, observed->dr6);
+  EXPECT_EQ(context_x86.dr7, observed->dr7);
+
+  EXPECT_EQ(context_x86.fxsave.fcw, observed->float_save.control_word);
+  EXPECT_EQ(context_x86.fxsave.fsw, observed->float_save.status_word);
+  EXPECT_EQ(0x92ab, observed->float_save.tag_word);
+  EXPECT_EQ(context_x86.fxsave.fpu_ip, observed->float_save.error_offset);
+  EXPECT_EQ(context_x86.fxsave.fpu_cs, observed->float_save.error_selector);
+  EXPECT_EQ(context_x86.fxsave.fpu_dp, observed->float_save.data_offset);
+  EXPECT_EQ(context_x86.fxsave.fpu_ds, observed->float_save.data_selector);
+  for (size_t index = 0; index < arraysize(context_x86.fxsave.st_mm);
+       ++index) {
+    EXPECT_EQ(0,
+              memcmp(&observed->float_save.register_area[index * 10],
+                     context_x86.fxsave.st_mm[index].st,
+                     10)) << "index " << index;
+  }
+
+  EXPECT_EQ(0,
+            memcmp(observed->extended_registers,
+                   &context_x86.fxsave,
+                   sizeof(context_x86.fxsave)));
+}
+
+TEST(MinidumpContextWriter, AMD64FromSnapshot) {
+  CPUContextX86_64 context_x86_64;
+  InitializeCPUContextX86_64(&context_x86_64, 1);
+
+  CPUContext context_snapshot;
+  context_snapshot.architecture = kCPUArchitectureX86_64;
+  context_snapshot.x86_64 = &context_x86_64;
+
+  scoped_ptr<MinidumpContextWriter> context_writer =
+      MinidumpContextWriter::CreateFromSnapshot(&context_snapshot);
+  ASSERT_TRUE(context_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(context_writer->WriteEverything(&file_writer));
+  ASSERT_EQ(sizeof(MinidumpContextAMD64), file_writer.string().size());
+
+  const MinidumpContextAMD64* observed =
+      reinterpret_cast<const MinidumpContextAMD64*>(&file_writer.string()[0]);
+  EXPECT_EQ(kMinidumpContextAMD64All, observed->context_flags);
+  EXPECT_EQ(context_x86_64.rax, observed->rax);
+  EXPECT_EQ(context_x86_64.rbx, observed->rbx);
+  EXPECT_EQ(context_x86_64.rcx, observed->rcx);
+  EXPECT_EQ(context_x86_64.rdx, observed->rdx);
+  EXPECT_EQ(context_x86_64.rdi, observed->rdi);
+  EXPECT_EQ(context_x86_64.rsi, observed->rsi);
+  EXPECT_EQ(context_x86_64.rbp, observed->rbp);
+  EXPECT_EQ(context_x86_64.rsp, observed->rsp);
+  EXPECT_EQ(context_x86_64.r8, observed->r8);
+  EXPECT_EQ(context_x86_64.r9, observed->r9);
+  EXPECT_EQ(context_x86_64.r10, observed->r10);
+  EXPECT_EQ(context_x86_64.r11, observed->r11);
+  EXPECT_EQ(context_x86_64.r12, observed->r12);
+  EXPECT_EQ(context_x86_64.r13, observed->r13);
+  EXPECT_EQ(context_x86_64.r14, observed->r14);
+  EXPECT_EQ(context_x86_64.r15, observed->r15);
+  EXPECT_EQ(context_x86_64.rip, observed->rip);
+  EXPECT_EQ(static_cast<uint32_t>(context_x86_64.rflags), observed->eflags);
+  EXPECT_EQ(context_x86_64.cs, observed->cs);
+  EXPECT_EQ(context_x86_64.fs, observed->fs);
+  EXPECT_EQ(context_x86_64.gs, observed->gs);
+  EXPECT_EQ(context_x86_64.dr0, observed->dr0);
+  EXPECT_EQ(context_x86_64.dr1, observed->dr1);
+  EXPECT_EQ(context_x86_64.dr2, observed->dr2);
+  EXPECT_EQ(context_x86_64.dr3, observed->dr3);
+  EXPECT_EQ(context_x86_64.dr6, observed->dr6);
+  EXPECT_EQ(context_x86_64.dr7, observed->dr7);
+  EXPECT_EQ(context_x86_64.fxsave.mxcsr, observed->mx_csr);
+  EXPECT_EQ(0,
+            memcmp(&observed->float_save,
+                   &context_x86_64.fxsave,
+                   sizeof(context_x86_64.fxsave)));
+}
+
+TEST(MinidumpContextWriter, UnknownArchitectureFromSnapshot) {
+  CPUContext context_snapshot = {};
+  context_snapshot.architecture = kCPUArchitectureUnknown;
+
+  EXPECT_FALSE(MinidumpContextWriter::CreateFromSnapshot(&context_snapshot));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -0,0 +1,197 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_exception_writer.h"
+
+#include <dbghelp.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "minidump/minidump_context_test_util.h"
+#include "minidump/minidump_context_writer.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_test_util.h"
+#include "minidump/minidump_thread_id_map.h"
+#include "snapshot/test/test_cpu_context.h"
+#include "snapshot/test/test_exception_snapshot.h"
+#include "util/file/string_file_writer.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// This returns the MINIDUMP_EXCEPTION_STREAM stream in |exception_stream|.
+void GetExceptionStream(const std::string& file_contents,
+                        const MINIDUMP_EXCEPTION_STREAM** exception_stream) {
+  const size_t kDirectoryOffset = sizeof(MINIDUMP_HEADER);
+  const size_t kExceptionStreamOffset =
+      kDirectoryOffset + sizeof(MINIDUMP_DIRECTORY);
+  const size_t kContextOffset =
+      (kExceptionStreamOffset + sizeof(MINIDUMP_EXCEPTION_STREAM) + 15) & ~15;
+  const size_t kFileSize = kContextOffset + sizeof(MinidumpContextAMD64);
+  ASSERT_EQ(kFileSize, file_contents.size());
+
+  const MINIDUMP_HEADER* header =
+      reinterpret_cast<const MINIDUMP_HEADER*>(&file_contents[0]);
+
+  VerifyMinidumpHeader(header, 1, 0);
+  if (testing::Test::HasFatalFailure()) {
+    return;
+  }
+
+  const MINIDUMP_DIRECTORY* directory =
+      reinterpret_cast<const MINIDUMP_DIRECTORY*>(
+          &file_contents[kDirectoryOffset]);
+
+  ASSERT_EQ(kMinidumpStreamTypeException, directory[0].StreamType);
+  ASSERT_EQ(sizeof(MINIDUMP_EXCEPTION_STREAM), directory[0].Location.DataSize);
+  ASSERT_EQ(kExceptionStreamOffset, directory[0].Location.Rva);
+
+  *exception_stream = reinterpret_cast<const MINIDUMP_EXCEPTION_STREAM*>(
+      &file_contents[kExceptionStreamOffset]);
+
+  ASSERT_EQ(sizeof(MinidumpContextAMD64),
+            (*exception_stream)->ThreadContext.DataSize);
+  ASSERT_EQ(kContextOffset, (*exception_stream)->ThreadContext.Rva);
+}
+
+TEST(MinidumpExceptionWriter, Standard) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpExceptionWriter exception_writer;
+
+  const uint32_t kSeed = 200;
+  const uint32_t kThreadID = 1;
+  const uint32_t kExceptionCode = 2;
+  const uint32_t kExceptionFlags = 3;
+  const uint32_t kExceptionRecord = 4;
+  const uint32_t kExceptionAddress = 5;
+  const uint64_t kExceptionInformation0 = 6;
+  const uint64_t kExceptionInformation1 = 7;
+  const uint64_t kExceptionInformation2 = 8;
+
+  MinidumpContextAMD64Writer context_amd64_writer;
+  InitializeMinidumpContextAMD64(context_amd64_writer.context(), kSeed);
+  exception_writer.SetContext(&context_amd64_writer);
+
+  exception_writer.SetThreadID(kThreadID);
+  exception_writer.SetExceptionCode(kExceptionCode);
+  exception_writer.SetExceptionFlags(kExceptionFlags);
+  exception_writer.SetExceptionRecord(kExceptionRecord);
+  exception_writer.SetExceptionAddress(kExceptionAddress);
+
+  std::vector<uint64_t> exception_information;
+  exception_information.push_back(kExceptionInformation0);
+  exception_information.push_back(kExceptionInformation1);
+  exception_information.push_back(kExceptionInformation2);
+  exception_writer.SetExceptionInformation(exception_information);
+
+  minidump_file_writer.AddStream(&exception_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_EXCEPTION_STREAM* observed_exception_stream;
+  GetExceptionStream(file_writer.string(), &observed_exception_stream);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  EXPECT_EQ(kThreadID, observed_exception_stream->ThreadId);
+  const MINIDUMP_EXCEPTION* observed_exception =
+      &observed_exception_stream->ExceptionRecord;
+  EXPECT_EQ(kExceptionCode, observed_exception->ExceptionCode);
+  EXPECT_EQ(kExceptionFlags, observed_exception->ExceptionFlags);
+  EXPECT_EQ(kExceptionRecord, observed_exception->ExceptionRecord);
+  EXPECT_EQ(kExceptionAddress, observed_exception->ExceptionAddress);
+  ASSERT_EQ(exception_information.size(),
+            observed_exception->NumberParameters);
+  for (size_t index = 0; index < EXCEPTION_MAXIMUM_PARAMETERS; ++index) {
+    SCOPED_TRACE(testing::Message() << "index " << index);
+    EXPECT_EQ(index < exception_information.size()
+                  ? exception_information[index]
+                  : 0,
+              observed_exception->ExceptionInformation[index]);
+  }
+
+  ExpectMinidumpContextAMD64(
+      kSeed,
+      reinterpret_cast<const MinidumpContextAMD64*>(
+          &file_writer.string()[observed_exception_stream->ThreadContext.Rva]));
+}
+
+TEST(MinidumpExceptionWriter, InitializeFromSnapshot) {
+  const uint64_t kThreadID = 0xaaaaaaaaaaaaaaaa;
+  const uint32_t kMinidumpThreadID = 0x20;
+
+  TestExceptionSnapshot exception_snapshot;
+  InitializeCPUContextX86_64(exception_snapshot.MutableContext()->x86_64, 1);
+  exception_snapshot.SetThreadID(kThreadID);
+  exception_snapshot.SetException(0x4);
+  exception_snapshot.SetExceptionInfo(0x1);
+  exception_snapshot.SetExceptionAddress(0xfedcba9876543210);
+
+  // More codes than a MINIDUMP_EXCEPTION can hold. The excess is discarded.
+  std::vector<uint64_t> codes;
+  for (size_t index = 0; index < EXCEPTION_MAXIMUM_PARAMETERS + 2; ++index) {
+    codes.push_back(0x100 + index);
+  }
+  exception_snapshot.SetCodes(codes);
+
+  MinidumpThreadIDMap thread_id_map;
+  thread_id_map[kThreadID] = kMinidumpThreadID;
+
+  MinidumpExceptionWriter exception_writer;
+  ASSERT_TRUE(
+      exception_writer.InitializeFromSnapshot(&exception_snapshot,
+                                              &thread_id_map));
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.AddStream(&exception_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_EXCEPTION_STREAM* observed_exception_stream;
+  GetExceptionStream(file_writer.string(), &observed_exception_stream);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  EXPECT_EQ(kMinidumpThreadID, observed_exception_stream->ThreadId);
+  const MINIDUMP_EXCEPTION* observed_exception =
+      &observed_exception_stream->ExceptionRecord;
+  EXPECT_EQ(0x4u, observed_exception->ExceptionCode);
+  EXPECT_EQ(0x1u, observed_exception->ExceptionFlags);
+  EXPECT_EQ(0u, observed_exception->ExceptionRecord);
+  EXPECT_EQ(0xfedcba9876543210, observed_exception->ExceptionAddress);
+  ASSERT_EQ(static_cast<uint32_t>(EXCEPTION_MAXIMUM_PARAMETERS),
+            observed_exception->NumberParameters);
+  for (size_t index = 0; index < EXCEPTION_MAXIMUM_PARAMETERS; ++index) {
+    SCOPED_TRACE(testing::Message() << "index " << index);
+    EXPECT_EQ(codes[index], observed_exception->ExceptionInformation[index]);
+  }
+
+  const MinidumpContextAMD64* observed_context =
+      reinterpret_cast<const MinidumpContextAMD64*>(
+          &file_writer.string()[observed_exception_stream->ThreadContext.Rva]);
+  EXPECT_EQ(exception_snapshot.Context()->x86_64->rip, observed_context->rip);
+  EXPECT_EQ(exception_snapshot.Context()->x86_64->rax, observed_context->rax);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
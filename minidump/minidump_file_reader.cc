@@ -0,0 +1,251 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_file_reader.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "base/files/scoped_file.h"
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+#include "base/posix/eintr_wrapper.h"
+#include "util/numeric/checked_range.h"
+
+namespace crashpad {
+
+MinidumpFileReader::MinidumpFileReader()
+    : data_(NULL),
+      size_(0),
+      header_(NULL),
+      directory_(NULL),
+      mapped_(false),
+      initialized_() {
+}
+
+MinidumpFileReader::~MinidumpFileReader() {
+  if (mapped_) {
+    if (munmap(const_cast<uint8_t*>(data_), size_) != 0) {
+      PLOG(ERROR) << "munmap";
+    }
+  }
+}
+
+bool MinidumpFileReader::Open(const base::FilePath& path) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  base::ScopedFD fd(HANDLE_EINTR(open(path.value().c_str(), O_RDONLY)));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << "open " << path.value();
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    PLOG(ERROR) << "fstat " << path.value();
+    return false;
+  }
+
+  // Check the size before mapping, because mmap() can’t map an empty file.
+  if (st.st_size < static_cast<off_t>(sizeof(MINIDUMP_HEADER))) {
+    LOG(ERROR) << "file " << path.value() << " too small";
+    return false;
+  }
+
+  if (!base::IsValueInRangeForNumericType<size_t>(st.st_size)) {
+    LOG(ERROR) << "file " << path.value() << " too large";
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    PLOG(ERROR) << "mmap " << path.value();
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = size;
+  mapped_ = true;
+
+  if (!ValidateHeaderAndDirectory()) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool MinidumpFileReader::InitializeFromBuffer(const void* data, size_t size) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = size;
+
+  if (!ValidateHeaderAndDirectory()) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+const MINIDUMP_HEADER* MinidumpFileReader::Header() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return header_;
+}
+
+size_t MinidumpFileReader::StreamCount() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return header_->NumberOfStreams;
+}
+
+const MINIDUMP_DIRECTORY* MinidumpFileReader::StreamAt(size_t index) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK_LT(index, StreamCount());
+  return &directory_[index];
+}
+
+const MINIDUMP_DIRECTORY* MinidumpFileReader::FindStream(
+    MinidumpStreamType stream_type) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  size_t stream_count = StreamCount();
+  for (size_t index = 0; index < stream_count; ++index) {
+    if (directory_[index].StreamType == stream_type) {
+      return &directory_[index];
+    }
+  }
+
+  return NULL;
+}
+
+const void* MinidumpFileReader::DataAt(RVA rva, size_t size) const {
+  return DataAtOffset(rva, size);
+}
+
+const void* MinidumpFileReader::DataAtLocation(
+    const MINIDUMP_LOCATION_DESCRIPTOR& location,
+    size_t minimum_size) const {
+  if (location.DataSize < minimum_size) {
+    LOG(ERROR) << "location size " << location.DataSize << " < "
+               << minimum_size;
+    return NULL;
+  }
+
+  return DataAt(location.Rva, location.DataSize);
+}
+
+const void* MinidumpFileReader::ArrayAt(RVA rva,
+                                        size_t count,
+                                        size_t element_size) const {
+  base::CheckedNumeric<size_t> size = count;
+  size *= element_size;
+  if (!size.IsValid()) {
+    LOG(ERROR) << "array count " << count << " too large";
+    return NULL;
+  }
+
+  return DataAt(rva, size.ValueOrDie());
+}
+
+bool MinidumpFileReader::UTF8StringAt(RVA rva,
+                                      base::StringPiece* string) const {
+  const MinidumpUTF8String* string_base = ObjectAt<MinidumpUTF8String>(rva);
+  if (!string_base) {
+    return false;
+  }
+
+  const void* buffer =
+      DataAtOffset(rva + sizeof(*string_base), string_base->Length);
+  if (!buffer) {
+    return false;
+  }
+
+  *string = base::StringPiece(static_cast<const char*>(buffer),
+                              string_base->Length);
+  return true;
+}
+
+bool MinidumpFileReader::UTF16StringAt(RVA rva, base::string16* string) const {
+  const MINIDUMP_STRING* string_base = ObjectAt<MINIDUMP_STRING>(rva);
+  if (!string_base) {
+    return false;
+  }
+
+  if (string_base->Length % sizeof(string_base->Buffer[0]) != 0) {
+    LOG(ERROR) << "string length " << string_base->Length << " invalid";
+    return false;
+  }
+
+  const void* buffer =
+      DataAtOffset(rva + sizeof(*string_base), string_base->Length);
+  if (!buffer) {
+    return false;
+  }
+
+  // The buffer may not be suitably aligned for base::char16, so copy it
+  // bytewise rather than by assigning from a base::char16 pointer.
+  string->resize(string_base->Length / sizeof(string_base->Buffer[0]));
+  if (!string->empty()) {
+    memcpy(&(*string)[0], buffer, string_base->Length);
+  }
+  return true;
+}
+
+const void* MinidumpFileReader::DataAtOffset(size_t offset,
+                                             size_t size) const {
+  CheckedRange<size_t> file_range(0, size_);
+  CheckedRange<size_t> data_range(offset, size);
+  if (!data_range.IsValid() || !file_range.ContainsRange(data_range)) {
+    LOG(ERROR) << "offset " << offset << " size " << size << " out of range";
+    return NULL;
+  }
+
+  return data_ + offset;
+}
+
+bool MinidumpFileReader::ValidateHeaderAndDirectory() {
+  header_ = ObjectAt<MINIDUMP_HEADER>(0);
+  if (!header_) {
+    return false;
+  }
+
+  if (header_->Signature != MINIDUMP_SIGNATURE) {
+    LOG(ERROR) << "minidump signature mismatch";
+    return false;
+  }
+
+  // Only the low 16 bits are the format version. The high 16 bits are
+  // implementation-specific.
+  if ((header_->Version & 0xffff) != MINIDUMP_VERSION) {
+    LOG(ERROR) << "minidump version mismatch";
+    return false;
+  }
+
+  directory_ = static_cast<const MINIDUMP_DIRECTORY*>(
+      ArrayAt(header_->StreamDirectoryRva,
+              header_->NumberOfStreams,
+              sizeof(MINIDUMP_DIRECTORY)));
+  if (!directory_) {
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,167 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_FILE_READER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_FILE_READER_H_
+
+#include <dbghelp.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/strings/string16.h"
+#include "base/strings/string_piece.h"
+#include "minidump/minidump_extensions.h"
+#include "util/misc/initialization_state_dcheck.h"
+
+namespace crashpad {
+
+//! \brief Provides read-only access to the contents of a minidump file.
+//!
+//! The file is accessed in place, without being copied: it is either mapped
+//! into memory by Open(), or provided by the caller as a buffer to
+//! InitializeFromBuffer(). Only the header and stream directory are validated
+//! during initialization. Everything else is validated only when it is
+//! accessed, typically by one of the stream views in
+//! minidump/minidump_stream_views.h, so that consumers interested in a single
+//! stream pay only for that stream.
+//!
+//! Every ::RVA and MINIDUMP_LOCATION_DESCRIPTOR in a minidump file is untrusted
+//! data. Methods that follow them, such as DataAt(), check that the data they
+//! refer to lies entirely within the file before returning a pointer to it.
+//! Pointers returned by this class point into the file’s contents, and remain
+//! valid for the lifetime of this object.
+class MinidumpFileReader {
+ public:
+  MinidumpFileReader();
+  ~MinidumpFileReader();
+
+  //! \brief Maps the minidump file at \a path into memory, and validates its
+  //!     header and stream directory.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  bool Open(const base::FilePath& path);
+
+  //! \brief Uses a minidump file that is already in memory, and validates its
+  //!     header and stream directory.
+  //!
+  //! \param[in] data The minidump file’s contents. This object does not take
+  //!     ownership of \a data, which must remain valid and unchanged for the
+  //!     lifetime of this object.
+  //! \param[in] size The size of \a data.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  bool InitializeFromBuffer(const void* data, size_t size);
+
+  //! \brief Returns the minidump file’s header.
+  const MINIDUMP_HEADER* Header() const;
+
+  //! \brief Returns the number of entries in the minidump file’s stream
+  //!     directory.
+  size_t StreamCount() const;
+
+  //! \brief Returns the stream directory entry at \a index, which must be less
+  //!     than StreamCount().
+  const MINIDUMP_DIRECTORY* StreamAt(size_t index) const;
+
+  //! \brief Returns the first stream directory entry identifying a stream of
+  //!     type \a stream_type, or `NULL` if there is no such stream.
+  const MINIDUMP_DIRECTORY* FindStream(MinidumpStreamType stream_type) const;
+
+  //! \brief Returns a pointer to \a size bytes of data at \a rva.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if the data would
+  //!     extend beyond the end of the file, with a message logged.
+  const void* DataAt(RVA rva, size_t size) const;
+
+  //! \brief Returns a pointer to an object of type \a T at \a rva.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if the object would
+  //!     extend beyond the end of the file, with a message logged.
+  template <typename T>
+  const T* ObjectAt(RVA rva) const {
+    return static_cast<const T*>(DataAt(rva, sizeof(T)));
+  }
+
+  //! \brief Returns a pointer to the data referenced by \a location.
+  //!
+  //! \param[in] location The location of the data.
+  //! \param[in] minimum_size The minimum acceptable value of \a location’s
+  //!     `DataSize` field.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if \a location is
+  //!     smaller than \a minimum_size or would extend beyond the end of the
+  //!     file, with a message logged.
+  const void* DataAtLocation(const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                             size_t minimum_size) const;
+
+  //! \brief Returns a pointer to an array of \a count elements, each \a
+  //!     element_size bytes in size, at \a rva.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if the size of the
+  //!     array cannot be represented or the array would extend beyond the end
+  //!     of the file, with a message logged.
+  const void* ArrayAt(RVA rva, size_t count, size_t element_size) const;
+
+  //! \brief Returns the MinidumpUTF8String at \a rva without copying it.
+  //!
+  //! \param[in] rva The location of the MinidumpUTF8String structure.
+  //! \param[out] string The string’s contents, not including any `NUL`
+  //!     terminator. This points into the file’s contents.
+  //!
+  //! \return `true` on success. `false` if the string would extend beyond the
+  //!     end of the file, with a message logged.
+  bool UTF8StringAt(RVA rva, base::StringPiece* string) const;
+
+  //! \brief Reads the MINIDUMP_STRING at \a rva.
+  //!
+  //! \param[in] rva The location of the MINIDUMP_STRING structure.
+  //! \param[out] string The string’s contents, not including any `NUL`
+  //!     terminator.
+  //!
+  //! \return `true` on success. `false` if the string is malformed or would
+  //!     extend beyond the end of the file, with a message logged.
+  bool UTF16StringAt(RVA rva, base::string16* string) const;
+
+  //! \brief The minidump file’s contents.
+  const uint8_t* data() const { return data_; }
+
+  //! \brief The size of the minidump file.
+  size_t size() const { return size_; }
+
+ private:
+  //! \brief Returns a pointer to \a size bytes of data at \a offset, which
+  //!     unlike an ::RVA may exceed 32 bits.
+  const void* DataAtOffset(size_t offset, size_t size) const;
+
+  //! \brief Validates the header and stream directory of the file whose
+  //!     contents have been placed in #data_ and #size_.
+  bool ValidateHeaderAndDirectory();
+
+  const uint8_t* data_;  // weak unless mapped_
+  size_t size_;
+  const MINIDUMP_HEADER* header_;  // weak
+  const MINIDUMP_DIRECTORY* directory_;  // weak
+  bool mapped_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpFileReader);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_FILE_READER_H_
@@ -0,0 +1,89 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "base/strings/string16.h"
+#include "minidump/minidump_file_reader.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_stream_views.h"
+#include "snapshot/test/synthesized_process.h"
+#include "util/file/string_file_writer.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Reads a minidump file describing a process with range(0) modules and
+// range(0) threads: the header and directory are validated, every module name
+// is read, and every thread stack is located in the memory list.
+void BM_MinidumpFileReaderReadAll(BenchmarkState* state) {
+  SynthesizedProcessOptions options;
+  options.thread_count = state->range(0);
+  options.stack_size = 256;
+  options.module_count = state->range(0);
+  SynthesizedProcess process(options);
+
+  StringFileWriter file_writer;
+  MinidumpFileWriter minidump_file_writer;
+  if (!minidump_file_writer.InitializeFromSnapshot(
+          process.process_snapshot()) ||
+      !minidump_file_writer.WriteEverything(&file_writer)) {
+    state->SkipWithError("WriteEverything failed");
+    return;
+  }
+  const std::string& contents = file_writer.string();
+
+  base::string16 name;
+  while (state->KeepRunning()) {
+    MinidumpFileReader reader;
+    if (!reader.InitializeFromBuffer(contents.data(), contents.size())) {
+      state->SkipWithError("InitializeFromBuffer failed");
+      return;
+    }
+
+    MinidumpModuleListView module_list;
+    if (!module_list.Initialize(&reader)) {
+      state->SkipWithError("module list Initialize failed");
+      return;
+    }
+    for (size_t index = 0; index < module_list.ModuleCount(); ++index) {
+      if (!module_list.ModuleNameAt(index, &name)) {
+        state->SkipWithError("ModuleNameAt failed");
+        return;
+      }
+    }
+
+    MinidumpMemoryListView memory_list;
+    if (!memory_list.Initialize(&reader)) {
+      state->SkipWithError("memory list Initialize failed");
+      return;
+    }
+    for (size_t index = 0; index < memory_list.MemoryRangeCount(); ++index) {
+      const MINIDUMP_MEMORY_DESCRIPTOR* descriptor =
+          memory_list.DescriptorAt(index);
+      DoNotOptimize(memory_list.FindMemory(descriptor->StartOfMemoryRange,
+                                           descriptor->Memory.DataSize));
+    }
+  }
+
+  state->SetBytesProcessed(state->iterations() * contents.size());
+  state->SetCounter("dump_bytes", contents.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpFileReaderReadAll)->Range(10, 10000);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,197 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_file_reader.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/minidump_memory_writer_test_util.h"
+#include "util/file/fd_io.h"
+#include "util/file/string_file_writer.h"
+#include "util/test/errors.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(MinidumpFileReader, Empty) {
+  MinidumpFileWriter minidump_file;
+  const time_t kTimestamp = 0x155d2fb8;
+  minidump_file.SetTimestamp(kTimestamp);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(file_writer.string().data(),
+                                          file_writer.string().size()));
+  EXPECT_EQ(static_cast<uint32_t>(MINIDUMP_SIGNATURE),
+            reader.Header()->Signature);
+  EXPECT_EQ(static_cast<uint32_t>(kTimestamp), reader.Header()->TimeDateStamp);
+  EXPECT_EQ(0u, reader.StreamCount());
+  EXPECT_FALSE(reader.FindStream(kMinidumpStreamTypeMemoryList));
+  EXPECT_EQ(file_writer.string().size(), reader.size());
+}
+
+TEST(MinidumpFileReader, MemoryListStream) {
+  MinidumpFileWriter minidump_file;
+  MinidumpMemoryListWriter memory_list_writer;
+  TestMinidumpMemoryWriter memory_writer(0x1000, 0x10, 'm');
+  memory_list_writer.AddMemory(&memory_writer);
+  minidump_file.AddStream(&memory_list_writer);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(file_writer.string().data(),
+                                          file_writer.string().size()));
+  ASSERT_EQ(1u, reader.StreamCount());
+  EXPECT_EQ(kMinidumpStreamTypeMemoryList, reader.StreamAt(0)->StreamType);
+
+  const MINIDUMP_DIRECTORY* directory =
+      reader.FindStream(kMinidumpStreamTypeMemoryList);
+  ASSERT_EQ(reader.StreamAt(0), directory);
+  EXPECT_FALSE(reader.FindStream(kMinidumpStreamTypeModuleList));
+
+  const MINIDUMP_MEMORY_LIST* memory_list =
+      static_cast<const MINIDUMP_MEMORY_LIST*>(reader.DataAtLocation(
+          directory->Location, sizeof(MINIDUMP_MEMORY_LIST)));
+  ASSERT_TRUE(memory_list);
+  EXPECT_EQ(1u, memory_list->NumberOfMemoryRanges);
+  EXPECT_EQ(file_writer.string().data() + directory->Location.Rva,
+            reinterpret_cast<const char*>(memory_list));
+
+  // A location that claims to be too small is rejected.
+  EXPECT_FALSE(
+      reader.DataAtLocation(directory->Location,
+                            directory->Location.DataSize + 1));
+}
+
+TEST(MinidumpFileReader, Bounds) {
+  MinidumpFileWriter minidump_file;
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+  const size_t kSize = file_writer.string().size();
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(
+      reader.InitializeFromBuffer(file_writer.string().data(), kSize));
+
+  EXPECT_EQ(reader.data(), reader.DataAt(0, kSize));
+  EXPECT_EQ(reader.data() + kSize, reader.DataAt(kSize, 0));
+  EXPECT_FALSE(reader.DataAt(0, kSize + 1));
+  EXPECT_FALSE(reader.DataAt(1, kSize));
+  EXPECT_FALSE(reader.DataAt(kSize + 1, 0));
+  EXPECT_FALSE(reader.DataAt(0xffffffff, 2));
+  EXPECT_FALSE(reader.DataAt(1, static_cast<size_t>(-1)));
+
+  EXPECT_EQ(reader.data(), reader.ArrayAt(0, 2, kSize / 2));
+  EXPECT_FALSE(reader.ArrayAt(0, 2, kSize));
+  EXPECT_FALSE(reader.ArrayAt(0, static_cast<size_t>(-1), 2));
+
+  EXPECT_EQ(reinterpret_cast<const void*>(reader.Header()),
+            reader.ObjectAt<MINIDUMP_HEADER>(0));
+  EXPECT_FALSE(reader.ObjectAt<MINIDUMP_HEADER>(1));
+}
+
+TEST(MinidumpFileReader, Invalid) {
+  MinidumpFileWriter minidump_file;
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+  const std::string& valid = file_writer.string();
+
+  {
+    MinidumpFileReader reader;
+    EXPECT_FALSE(reader.InitializeFromBuffer(valid.data(), valid.size() - 1));
+  }
+
+  {
+    std::string invalid(valid);
+    MINIDUMP_HEADER* header = reinterpret_cast<MINIDUMP_HEADER*>(&invalid[0]);
+    header->Signature = 0;
+    MinidumpFileReader reader;
+    EXPECT_FALSE(reader.InitializeFromBuffer(invalid.data(), invalid.size()));
+  }
+
+  {
+    std::string invalid(valid);
+    MINIDUMP_HEADER* header = reinterpret_cast<MINIDUMP_HEADER*>(&invalid[0]);
+    header->Version = MINIDUMP_VERSION + 1;
+    MinidumpFileReader reader;
+    EXPECT_FALSE(reader.InitializeFromBuffer(invalid.data(), invalid.size()));
+  }
+
+  {
+    // The stream directory must be contained within the file.
+    std::string invalid(valid);
+    MINIDUMP_HEADER* header = reinterpret_cast<MINIDUMP_HEADER*>(&invalid[0]);
+    header->NumberOfStreams = 1;
+    header->StreamDirectoryRva =
+        invalid.size() - sizeof(MINIDUMP_DIRECTORY) + 1;
+    MinidumpFileReader reader;
+    EXPECT_FALSE(reader.InitializeFromBuffer(invalid.data(), invalid.size()));
+  }
+}
+
+TEST(MinidumpFileReader, Open) {
+  MinidumpFileWriter minidump_file;
+  MinidumpMemoryListWriter memory_list_writer;
+  TestMinidumpMemoryWriter memory_writer(0x2000, 0x20, 'o');
+  memory_list_writer.AddMemory(&memory_writer);
+  minidump_file.AddStream(&memory_list_writer);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  char path[] = "/tmp/minidump_file_reader_test.XXXXXX";
+  base::ScopedFD fd(mkstemp(path));
+  ASSERT_TRUE(fd.is_valid()) << ErrnoMessage("mkstemp");
+  CheckedWriteFD(
+      fd.get(), file_writer.string().data(), file_writer.string().size());
+  fd.reset();
+
+  {
+    MinidumpFileReader reader;
+    ASSERT_TRUE(reader.Open(base::FilePath(path)));
+    ASSERT_EQ(file_writer.string().size(), reader.size());
+    EXPECT_EQ(0,
+              memcmp(file_writer.string().data(), reader.data(), reader.size()));
+    EXPECT_TRUE(reader.FindStream(kMinidumpStreamTypeMemoryList));
+  }
+
+  // An empty file can’t be mapped, and isn’t a valid minidump file anyway.
+  ASSERT_EQ(0, truncate(path, 0)) << ErrnoMessage("truncate");
+  {
+    MinidumpFileReader reader;
+    EXPECT_FALSE(reader.Open(base::FilePath(path)));
+  }
+
+  EXPECT_EQ(0, unlink(path)) << ErrnoMessage("unlink");
+
+  {
+    MinidumpFileReader reader;
+    EXPECT_FALSE(reader.Open(base::FilePath(path)));
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
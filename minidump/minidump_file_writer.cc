@@ -14,14 +14,28 @@
 
 #include "minidump/minidump_file_writer.h"
 
+#include <sys/time.h>
+
 #include "base/logging.h"
+#include "minidump/minidump_exception_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/minidump_misc_info_writer.h"
+#include "minidump/minidump_module_writer.h"
+#include "minidump/minidump_system_info_writer.h"
+#include "minidump/minidump_thread_id_map.h"
+#include "minidump/minidump_thread_writer.h"
 #include "minidump/minidump_writer_util.h"
+#include "snapshot/process_snapshot.h"
 #include "util/numeric/safe_assignment.h"
 
 namespace crashpad {
 
 MinidumpFileWriter::MinidumpFileWriter()
-    : MinidumpWritable(), header_(), streams_(), stream_types_() {
+    : MinidumpWritable(),
+      header_(),
+      streams_(),
+      owned_streams_(),
+      stream_types_() {
   // Don’t set the signature field right away. Leave it set to 0, so that a
   // partially-written minidump file isn’t confused for a complete and valid
   // one. The header will be rewritten in WriteToFile().
@@ -35,6 +49,71 @@ MinidumpFileWriter::MinidumpFileWriter()
 MinidumpFileWriter::~MinidumpFileWriter() {
 }
 
+bool MinidumpFileWriter::InitializeFromSnapshot(
+    const ProcessSnapshot* process_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK_EQ(header_.Signature, 0u);
+  DCHECK_EQ(header_.TimeDateStamp, 0u);
+  DCHECK(streams_.empty());
+
+  // This time is truncated to an integer number of seconds, not rounded, for
+  // compatibility with the truncation of process_snapshot->ProcessStartTime()
+  // done by MinidumpMiscInfoWriter::InitializeFromSnapshot(). Handling both
+  // timestamps in the same way allows the highest-fidelity computation of
+  // process uptime as the difference between the two values.
+  timeval snapshot_time;
+  process_snapshot->SnapshotTime(&snapshot_time);
+  SetTimestamp(snapshot_time.tv_sec);
+
+  MinidumpSystemInfoWriter* system_info =
+      NewOwned<MinidumpSystemInfoWriter>(&owned_streams_);
+  system_info->InitializeFromSnapshot(process_snapshot->System());
+  AddStream(system_info);
+
+  MinidumpMiscInfoWriter* misc_info =
+      NewOwned<MinidumpMiscInfoWriter>(&owned_streams_);
+  misc_info->InitializeFromSnapshot(process_snapshot);
+  AddStream(misc_info);
+
+  MinidumpModuleListWriter* module_list =
+      NewOwned<MinidumpModuleListWriter>(&owned_streams_);
+  if (!module_list->InitializeFromSnapshot(process_snapshot->Modules())) {
+    return false;
+  }
+  AddStream(module_list);
+
+  // The memory list is populated with thread stacks as the thread list is
+  // built, so it must be created first, but it is added to the file last so
+  // that the memory it lists is gathered from the streams that precede it.
+  MinidumpMemoryListWriter* memory_list =
+      NewOwned<MinidumpMemoryListWriter>(&owned_streams_);
+
+  MinidumpThreadListWriter* thread_list =
+      NewOwned<MinidumpThreadListWriter>(&owned_streams_);
+  thread_list->SetMemoryListWriter(memory_list);
+  MinidumpThreadIDMap thread_id_map;
+  if (!thread_list->InitializeFromSnapshot(process_snapshot->Threads(),
+                                           &thread_id_map)) {
+    return false;
+  }
+  AddStream(thread_list);
+
+  const ExceptionSnapshot* exception_snapshot = process_snapshot->Exception();
+  if (exception_snapshot) {
+    MinidumpExceptionWriter* exception =
+        NewOwned<MinidumpExceptionWriter>(&owned_streams_);
+    if (!exception->InitializeFromSnapshot(exception_snapshot,
+                                           &thread_id_map)) {
+      return false;
+    }
+    AddStream(exception);
+  }
+
+  AddStream(memory_list);
+
+  return true;
+}
+
 void MinidumpFileWriter::SetTimestamp(time_t timestamp) {
   DCHECK_EQ(state(), kStateMutable);
 
@@ -49,6 +128,7 @@ void MinidumpFileWriter::AddStream(internal::MinidumpStreamWriter* stream) {
   auto rv = stream_types_.insert(stream_type);
   CHECK(rv.second) << "stream_type " << stream_type << " already present";
 
+  UseArena(&streams_);
   streams_.push_back(stream);
 
   DCHECK_EQ(streams_.size(), stream_types_.size());
@@ -76,7 +156,7 @@ bool MinidumpFileWriter::WriteEverything(FileWriterInterface* file_writer) {
   // it as a valid minidump file.
   header_.Signature = MINIDUMP_SIGNATURE;
 
-  if (file_writer->Seek(start_offset, SEEK_SET) != 0) {
+  if (file_writer->Seek(start_offset, SEEK_SET) != start_offset) {
     return false;
   }
 
@@ -86,7 +166,25 @@ bool MinidumpFileWriter::WriteEverything(FileWriterInterface* file_writer) {
 
   // Seek back to the end of the file, in case some non-minidump content will be
   // written to the file after the minidump content.
-  return file_writer->Seek(end_offset, SEEK_SET);
+  return file_writer->Seek(end_offset, SEEK_SET) == end_offset;
+}
+
+bool MinidumpFileWriter::WriteEverythingParallel(
+    PositionalFileWriterInterface* file_writer,
+    off_t start_offset,
+    size_t thread_count) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  if (!MinidumpWritable::WriteEverythingParallel(
+          file_writer, start_offset, thread_count)) {
+    return false;
+  }
+
+  // As in WriteEverything(), the header is rewritten with the correct signature
+  // only once everything else has been written.
+  header_.Signature = MINIDUMP_SIGNATURE;
+
+  return file_writer->WriteAt(start_offset, &header_, sizeof(header_));
 }
 
 bool MinidumpFileWriter::Freeze() {
@@ -114,16 +212,17 @@ size_t MinidumpFileWriter::SizeOfObject() {
   return sizeof(header_) + streams_.size() * sizeof(MINIDUMP_DIRECTORY);
 }
 
-std::vector<internal::MinidumpWritable*> MinidumpFileWriter::Children() {
+size_t MinidumpFileWriter::ChildCount() {
   DCHECK_GE(state(), kStateFrozen);
   DCHECK_EQ(streams_.size(), stream_types_.size());
 
-  std::vector<MinidumpWritable*> children;
-  for (internal::MinidumpStreamWriter* stream : streams_) {
-    children.push_back(stream);
-  }
+  return streams_.size();
+}
+
+internal::MinidumpWritable* MinidumpFileWriter::ChildAt(size_t index) {
+  DCHECK_GE(state(), kStateFrozen);
 
-  return children;
+  return streams_[index];
 }
 
 bool MinidumpFileWriter::WillWriteAtOffsetImpl(off_t offset) {
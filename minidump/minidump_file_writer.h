@@ -25,9 +25,12 @@
 #include "minidump/minidump_stream_writer.h"
 #include "minidump/minidump_writable.h"
 #include "util/file/file_writer.h"
+#include "util/stdlib/pointer_container.h"
 
 namespace crashpad {
 
+class ProcessSnapshot;
+
 //! \brief The root-level object in a minidump file.
 //!
 //! This object writes a MINIDUMP_HEADER and list of MINIDUMP_DIRECTORY entries
@@ -37,6 +40,35 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
   MinidumpFileWriter();
   ~MinidumpFileWriter();
 
+  //! \brief Initializes the MinidumpFileWriter and populates it with
+  //!     appropriate child streams based on \a process_snapshot.
+  //!
+  //! This method will add additional streams to the minidump file as children
+  //! of the MinidumpFileWriter object and as pointees of the top-level
+  //! MINIDUMP_DIRECTORY. To do so, it will obtain other snapshot information
+  //! from \a process_snapshot, such as a SystemSnapshot, lists of
+  //! ThreadSnapshot and ModuleSnapshot objects, and an ExceptionSnapshot, if
+  //! available. The stream writers created by this method are owned by this
+  //! object.
+  //!
+  //! No memory is read from the snapshot process by this method. Thread stacks
+  //! are read through MemorySnapshot::Read() as they are written, so that
+  //! calling WriteEverything() after this method streams \a process_snapshot
+  //! to a file without holding any memory snapshot’s contents in memory at
+  //! once.
+  //!
+  //! \param[in] process_snapshot The process snapshot to use as source data.
+  //!     This object does not take ownership of \a process_snapshot, which
+  //!     must outlive this object.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  //!
+  //! \note Valid in #kStateMutable. No mutator methods may be called before
+  //!     this method, and it is not normally necessary to call any mutator
+  //!     methods after this method.
+  bool InitializeFromSnapshot(const ProcessSnapshot* process_snapshot);
+
   //! \brief Sets MINIDUMP_HEADER::Timestamp.
   //!
   //! \note Valid in #kStateMutable.
@@ -64,17 +96,28 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
   //! mistaken for valid ones.
   virtual bool WriteEverything(FileWriterInterface* file_writer) override;
 
+  //! \copydoc internal::MinidumpWritable::WriteEverythingParallel()
+  //!
+  //! As with WriteEverything(), the final value for MINIDUMP_HEADER::Signature
+  //! is only written once all other content has been written.
+  virtual bool WriteEverythingParallel(
+      PositionalFileWriterInterface* file_writer,
+      off_t start_offset,
+      size_t thread_count) override;
+
  protected:
   // MinidumpWritable:
   virtual bool Freeze() override;
   virtual size_t SizeOfObject() override;
-  virtual std::vector<MinidumpWritable*> Children() override;
+  virtual size_t ChildCount() override;
+  virtual MinidumpWritable* ChildAt(size_t index) override;
   virtual bool WillWriteAtOffsetImpl(off_t offset) override;
   virtual bool WriteObject(FileWriterInterface* file_writer) override;
 
  private:
   MINIDUMP_HEADER header_;
-  std::vector<internal::MinidumpStreamWriter*> streams_;  // weak
+  ArenaVector<internal::MinidumpStreamWriter*> streams_;  // weak
+  PointerVector<internal::MinidumpStreamWriter> owned_streams_;
 
   // Protects against multiple streams with the same ID being added.
   std::set<MinidumpStreamType> stream_types_;
@@ -0,0 +1,248 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "minidump/minidump_benchmark_util.h"
+#include "minidump/minidump_file_writer.h"
+#include "snapshot/test/synthesized_process.h"
+#include "util/file/buffered_file_writer.h"
+#include "util/file/file_writer.h"
+#include "util/file/string_file_writer.h"
+#include "util/file/zlib_file_writer.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Produces minidump files from a synthesized process with range(0) threads,
+// each with a stack of range(1) bytes. Each iteration builds the writer tree
+// from the snapshot and writes it, reading memory from the snapshot as it
+// goes. Output is discarded, so peak_rss_bytes reflects the writer itself.
+void BM_MinidumpFileWriterFromSnapshot(BenchmarkState* state) {
+  SynthesizedProcessOptions options;
+  options.thread_count = state->range(0);
+  options.stack_size = state->range(1);
+  options.module_count = 200;
+  options.annotations_per_module = 8;
+  options.annotation_value_size = 32;
+  options.exception = true;
+  SynthesizedProcess process(options);
+
+  DiscardingFileWriter file_writer;
+  while (state->KeepRunning()) {
+    MinidumpFileWriter minidump_file_writer;
+    if (!minidump_file_writer.InitializeFromSnapshot(
+            process.process_snapshot())) {
+      state->SkipWithError("InitializeFromSnapshot failed");
+      return;
+    }
+
+    file_writer.Reset();
+    if (!minidump_file_writer.WriteEverything(&file_writer)) {
+      state->SkipWithError("WriteEverything failed");
+      return;
+    }
+  }
+
+  state->SetBytesProcessed(state->iterations() * file_writer.size());
+  state->SetCounter("dump_bytes", file_writer.size());
+  state->SetCounter("snapshot_memory_bytes", process.MemoryBytes());
+  state->SetCounter("peak_rss_bytes", PeakResidentSetBytes());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpFileWriterFromSnapshot)
+    ->Args(16, 16 * 1024)
+    ->Args(256, 64 * 1024)
+    ->Args(2048, 64 * 1024)
+    ->Args(64, 1024 * 1024);
+
+// Writes a minidump file from a synthesized process through a ZlibFileWriter
+// in the format given by range(0), measuring uncompressed throughput and the
+// compression ratio achieved.
+void BM_MinidumpFileWriterZlib(BenchmarkState* state) {
+  const ZlibFileWriter::Format format =
+      static_cast<ZlibFileWriter::Format>(state->range(0));
+
+  SynthesizedProcessOptions options;
+  options.thread_count = 128;
+  options.stack_size = 64 * 1024;
+  options.module_count = 200;
+  options.exception = true;
+  SynthesizedProcess process(options);
+
+  // The gzip format can’t seek backwards, so write the dump to memory first
+  // in that case.
+  StringFileWriter dump;
+  if (format == ZlibFileWriter::kFormatGzip) {
+    MinidumpFileWriter minidump_file_writer;
+    if (!minidump_file_writer.InitializeFromSnapshot(
+            process.process_snapshot()) ||
+        !minidump_file_writer.WriteEverything(&dump)) {
+      state->SkipWithError("WriteEverything failed");
+      return;
+    }
+  }
+
+  DiscardingFileWriter file_writer;
+  off_t uncompressed_size = 0;
+  while (state->KeepRunning()) {
+    file_writer.Reset();
+    ZlibFileWriter zlib_file_writer;
+    if (!zlib_file_writer.Open(&file_writer, format)) {
+      state->SkipWithError("Open failed");
+      return;
+    }
+
+    bool rv;
+    if (format == ZlibFileWriter::kFormatGzip) {
+      rv = zlib_file_writer.Write(dump.string().data(), dump.string().size());
+      uncompressed_size = dump.string().size();
+    } else {
+      MinidumpFileWriter minidump_file_writer;
+      rv = minidump_file_writer.InitializeFromSnapshot(
+               process.process_snapshot()) &&
+           minidump_file_writer.WriteEverything(&zlib_file_writer);
+      uncompressed_size = zlib_file_writer.Seek(0, SEEK_CUR);
+    }
+
+    if (!rv || !zlib_file_writer.Close()) {
+      state->SkipWithError("write failed");
+      return;
+    }
+  }
+
+  state->SetBytesProcessed(state->iterations() * uncompressed_size);
+  state->SetCounter("compressed_bytes", file_writer.size());
+  state->SetCounter(
+      "compression_ratio",
+      static_cast<double>(uncompressed_size) / file_writer.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpFileWriterZlib)
+    ->Arg(ZlibFileWriter::kFormatGzip)
+    ->Arg(ZlibFileWriter::kFormatFramed);
+
+// Counts the operations passed to another file writer. When that is a
+// FileWriter, each operation is a system call.
+class CountingFileWriter final : public FileWriterInterface {
+ public:
+  explicit CountingFileWriter(FileWriterInterface* file_writer)
+      : file_writer_(file_writer), count_(0) {}
+  ~CountingFileWriter() {}
+
+  uint64_t count() const { return count_; }
+
+  // FileWriterInterface:
+  virtual bool Write(const void* data, size_t size) override {
+    ++count_;
+    return file_writer_->Write(data, size);
+  }
+
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override {
+    ++count_;
+    return file_writer_->WriteIoVec(iovecs);
+  }
+
+  virtual off_t Seek(off_t offset, int whence) override {
+    ++count_;
+    return file_writer_->Seek(offset, whence);
+  }
+
+ private:
+  FileWriterInterface* file_writer_;  // weak
+  uint64_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingFileWriter);
+};
+
+// Writes a typical minidump file from a synthesized process to a real file,
+// directly through a FileWriter (range(0) is 0) or through a
+// BufferedFileWriter (range(0) is 1). The syscalls counter is the number of
+// operations that reach the FileWriter for each dump.
+void BM_MinidumpFileWriterBuffered(BenchmarkState* state) {
+  const bool buffered = state->range(0) != 0;
+
+  SynthesizedProcessOptions options;
+  options.thread_count = 64;
+  options.stack_size = 16 * 1024;
+  options.module_count = 200;
+  options.annotations_per_module = 8;
+  options.annotation_value_size = 32;
+  options.exception = true;
+  SynthesizedProcess process(options);
+
+  char path[] = "/tmp/crashpad_benchmark.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    state->SkipWithError("mkstemp failed");
+    return;
+  }
+  close(fd);
+
+  FileWriter file_writer;
+  if (!file_writer.Open(base::FilePath(path), O_WRONLY | O_TRUNC, 0600)) {
+    unlink(path);
+    state->SkipWithError("open failed");
+    return;
+  }
+
+  uint64_t syscalls = 0;
+  off_t dump_size = 0;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    MinidumpFileWriter minidump_file_writer;
+    bool rv = minidump_file_writer.InitializeFromSnapshot(
+        process.process_snapshot());
+    file_writer.Seek(0, SEEK_SET);
+    state->ResumeTiming();
+
+    CountingFileWriter counting_file_writer(&file_writer);
+    if (buffered) {
+      BufferedFileWriter buffered_file_writer(&counting_file_writer);
+      rv = rv && minidump_file_writer.WriteEverything(&buffered_file_writer) &&
+           buffered_file_writer.Flush();
+    } else {
+      rv = rv && minidump_file_writer.WriteEverything(&counting_file_writer);
+    }
+
+    if (!rv) {
+      state->SkipWithError("write failed");
+      break;
+    }
+
+    syscalls = counting_file_writer.count();
+    dump_size = file_writer.Seek(0, SEEK_CUR);
+  }
+
+  file_writer.Close();
+  unlink(path);
+
+  state->SetBytesProcessed(state->iterations() * dump_size);
+  state->SetCounter("dump_bytes", dump_size);
+  state->SetCounter("syscalls", syscalls);
+  state->SetLabel(buffered ? "buffered" : "unbuffered");
+}
+CRASHPAD_BENCHMARK(BM_MinidumpFileWriterBuffered)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -15,16 +15,34 @@
 #include "minidump/minidump_file_writer.h"
 
 #include <dbghelp.h>
+#include <pthread.h>
+#include <string.h>
 
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/utf_string_conversions.h"
 #include "gtest/gtest.h"
+#include "minidump/minidump_file_reader.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/minidump_memory_writer_test_util.h"
+#include "minidump/minidump_stream_views.h"
 #include "minidump/minidump_stream_writer.h"
 #include "minidump/minidump_test_util.h"
 #include "minidump/minidump_writable.h"
+#include "snapshot/test/synthesized_process.h"
+#include "snapshot/test/test_cpu_context.h"
+#include "snapshot/test/test_exception_snapshot.h"
+#include "snapshot/test/test_memory_snapshot.h"
+#include "snapshot/test/test_module_snapshot.h"
+#include "snapshot/test/test_process_snapshot.h"
+#include "snapshot/test/test_system_snapshot.h"
+#include "snapshot/test/test_thread_snapshot.h"
+#include "util/file/buffered_file_writer.h"
 #include "util/file/file_writer.h"
 #include "util/file/string_file_writer.h"
+#include "util/misc/arena.h"
 
 namespace crashpad {
 namespace test {
@@ -243,6 +261,422 @@ TEST(MinidumpFileWriter, ZeroLengthStream) {
   EXPECT_EQ(kStreamOffset, directory->Location.Rva);
 }
 
+// A PositionalFileWriterInterface backed by a string, which may be written to
+// from several threads.
+class TestPositionalFileWriter final : public PositionalFileWriterInterface {
+ public:
+  explicit TestPositionalFileWriter(size_t size)
+      : string_(size, '\xa5'), will_write_end_(0) {
+    int rv = pthread_mutex_init(&mutex_, NULL);
+    EXPECT_EQ(0, rv);
+  }
+
+  ~TestPositionalFileWriter() {
+    int rv = pthread_mutex_destroy(&mutex_);
+    EXPECT_EQ(0, rv);
+  }
+
+  const std::string& string() const { return string_; }
+
+  // Returns the end of the region most recently announced by WillWriteAt().
+  size_t will_write_end() const { return will_write_end_; }
+
+  // PositionalFileWriterInterface:
+  virtual bool WriteAt(off_t offset, const void* data, size_t size) override {
+    pthread_mutex_lock(&mutex_);
+    EXPECT_GE(offset, 0);
+    size_t end = offset + size;
+    if (string_.size() < end) {
+      string_.resize(end);
+    }
+    string_.replace(offset, size, static_cast<const char*>(data), size);
+    pthread_mutex_unlock(&mutex_);
+    return true;
+  }
+
+  virtual bool WillWriteAt(off_t offset, size_t size) override {
+    EXPECT_GE(offset, 0);
+    will_write_end_ = offset + size;
+    return true;
+  }
+
+ private:
+  pthread_mutex_t mutex_;
+  std::string string_;
+  size_t will_write_end_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestPositionalFileWriter);
+};
+
+// A StringFileWriter that records the region announced by WillWrite().
+class WillWriteRecordingFileWriter final : public StringFileWriter {
+ public:
+  WillWriteRecordingFileWriter() : StringFileWriter(), will_write_end_(0) {}
+  ~WillWriteRecordingFileWriter() {}
+
+  // Returns the end of the region most recently announced by WillWrite().
+  size_t will_write_end() const { return will_write_end_; }
+
+  // StringFileWriter:
+  virtual bool WillWrite(size_t size) override {
+    off_t offset = Seek(0, SEEK_CUR);
+    EXPECT_GE(offset, 0);
+    will_write_end_ = offset + size;
+    return StringFileWriter::WillWrite(size);
+  }
+
+ private:
+  size_t will_write_end_;
+
+  DISALLOW_COPY_AND_ASSIGN(WillWriteRecordingFileWriter);
+};
+
+// A minidump file with several streams and memory regions, some of which will
+// be coalesced. Each instance can be written only once.
+class TestMinidumpFile {
+ public:
+  TestMinidumpFile()
+      : minidump_file_(),
+        streams_(),
+        memory_list_writer_(),
+        memory_writers_() {
+    minidump_file_.SetTimestamp(0x155d2fb8);
+
+    for (size_t index = 0; index < arraysize(streams_); ++index) {
+      streams_[index].reset(
+          new TestStream(static_cast<MinidumpStreamType>(0x40 + index),
+                         3 + index * 7,
+                         static_cast<uint8_t>(index + 1)));
+      minidump_file_.AddStream(streams_[index].get());
+    }
+
+    const struct {
+      uint64_t base_address;
+      size_t size;
+      uint8_t value;
+    } kMemory[] = {
+        {0x1000, 0x1000, 0x11},
+        {0x1800, 0x1000, 0x22},
+        {0x2800, 0x100, 0x33},
+        {0x10000, 0x3000, 0x44},
+        {0x10800, 0x100, 0x55},
+        {0x20000, 0x33, 0x66},
+        {0x30000, 0x8000, 0x77},
+    };
+    for (size_t index = 0; index < arraysize(kMemory); ++index) {
+      memory_writers_[index].reset(
+          new TestMinidumpMemoryWriter(kMemory[index].base_address,
+                                       kMemory[index].size,
+                                       kMemory[index].value));
+      memory_list_writer_.AddMemory(memory_writers_[index].get());
+    }
+    memory_list_writer_.EnableCoalescing(16 * 1024 * 1024);
+    minidump_file_.AddStream(&memory_list_writer_);
+  }
+
+  ~TestMinidumpFile() {}
+
+  MinidumpFileWriter* minidump_file() { return &minidump_file_; }
+
+ private:
+  MinidumpFileWriter minidump_file_;
+  scoped_ptr<TestStream> streams_[5];
+  MinidumpMemoryListWriter memory_list_writer_;
+  scoped_ptr<TestMinidumpMemoryWriter> memory_writers_[7];
+
+  DISALLOW_COPY_AND_ASSIGN(TestMinidumpFile);
+};
+
+TEST(MinidumpFileWriter, WriteEverythingParallel) {
+  TestMinidumpFile serial_minidump_file;
+  WillWriteRecordingFileWriter serial_file_writer;
+  ASSERT_TRUE(serial_minidump_file.minidump_file()->WriteEverything(
+      &serial_file_writer));
+
+  // The size announced ahead of writing must be exactly what was written.
+  EXPECT_EQ(serial_file_writer.string().size(),
+            serial_file_writer.will_write_end());
+
+  const MINIDUMP_HEADER* header = reinterpret_cast<const MINIDUMP_HEADER*>(
+      &serial_file_writer.string()[0]);
+  VerifyMinidumpHeader(header, 6, 0x155d2fb8);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  const size_t kThreadCounts[] = {1, 2, 4, 16};
+  for (size_t thread_count : kThreadCounts) {
+    SCOPED_TRACE(thread_count);
+
+    TestMinidumpFile parallel_minidump_file;
+    TestPositionalFileWriter parallel_file_writer(0);
+    ASSERT_TRUE(parallel_minidump_file.minidump_file()->WriteEverythingParallel(
+        &parallel_file_writer, 0, thread_count));
+
+    EXPECT_EQ(serial_file_writer.string(), parallel_file_writer.string());
+    EXPECT_EQ(parallel_file_writer.string().size(),
+              parallel_file_writer.will_write_end());
+  }
+}
+
+TEST(MinidumpFileWriter, WriteEverythingParallelAtOffset) {
+  const size_t kStartOffset = 0x43;
+  const size_t kStreamSize = 5;
+  const MinidumpStreamType kStreamType = static_cast<MinidumpStreamType>(0x4d);
+  const uint8_t kStreamValue = 0x5a;
+
+  WillWriteRecordingFileWriter serial_file_writer;
+  ASSERT_EQ(static_cast<off_t>(kStartOffset),
+            serial_file_writer.Seek(kStartOffset, SEEK_SET));
+  {
+    MinidumpFileWriter minidump_file;
+    TestStream stream(kStreamType, kStreamSize, kStreamValue);
+    minidump_file.AddStream(&stream);
+    ASSERT_TRUE(minidump_file.WriteEverything(&serial_file_writer));
+  }
+
+  // Content preceding the minidump must be left alone.
+  TestPositionalFileWriter parallel_file_writer(kStartOffset);
+  {
+    MinidumpFileWriter minidump_file;
+    TestStream stream(kStreamType, kStreamSize, kStreamValue);
+    minidump_file.AddStream(&stream);
+    ASSERT_TRUE(minidump_file.WriteEverythingParallel(
+        &parallel_file_writer, kStartOffset, 2));
+  }
+
+  ASSERT_EQ(serial_file_writer.string().size(),
+            parallel_file_writer.string().size());
+  EXPECT_EQ(serial_file_writer.string().size(),
+            serial_file_writer.will_write_end());
+  EXPECT_EQ(parallel_file_writer.string().size(),
+            parallel_file_writer.will_write_end());
+  EXPECT_EQ(std::string(kStartOffset, '\xa5'),
+            parallel_file_writer.string().substr(0, kStartOffset));
+  EXPECT_EQ(serial_file_writer.string().substr(kStartOffset),
+            parallel_file_writer.string().substr(kStartOffset));
+
+  const MINIDUMP_HEADER* header = reinterpret_cast<const MINIDUMP_HEADER*>(
+      &parallel_file_writer.string()[kStartOffset]);
+  VerifyMinidumpHeader(header, 1, 0);
+}
+
+TEST(MinidumpFileWriter, WriteEverythingBuffered) {
+  TestMinidumpFile unbuffered_minidump_file;
+  StringFileWriter unbuffered_file_writer;
+  ASSERT_TRUE(unbuffered_minidump_file.minidump_file()->WriteEverything(
+      &unbuffered_file_writer));
+
+  TestMinidumpFile buffered_minidump_file;
+  StringFileWriter buffered_file_writer;
+  {
+    BufferedFileWriter file_writer(&buffered_file_writer);
+    ASSERT_TRUE(buffered_minidump_file.minidump_file()->WriteEverything(
+        &file_writer));
+
+    // WriteEverything() finishes by seeking, which flushes everything.
+    EXPECT_EQ(unbuffered_file_writer.string(), buffered_file_writer.string());
+  }
+
+  EXPECT_EQ(unbuffered_file_writer.string(), buffered_file_writer.string());
+}
+
+TEST(MinidumpFileWriter, InitializeFromSnapshot) {
+  const timeval kSnapshotTime = {0x4976043c, 0};
+  const uint64_t kThreadIDs[] = {0x10, 0x20};
+  const uint64_t kStackAddresses[] = {0x7fff5000, 0x7ffe4000};
+  const size_t kStackSizes[] = {0x1000, 0x200};
+  const char kStackValues[] = {'s', 't'};
+
+  TestSystemSnapshot system_snapshot;
+  system_snapshot.SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot.SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+  system_snapshot.SetOSVersion(10, 9, 5, "13F34");
+
+  TestModuleSnapshot module_snapshots[2];
+  module_snapshots[0].SetName("/usr/bin/crashy");
+  module_snapshots[0].SetAddressAndSize(0x100000000, 0x1000);
+  module_snapshots[0].SetModuleType(ModuleSnapshot::kModuleTypeExecutable);
+  module_snapshots[1].SetName("/usr/lib/libc.dylib");
+  module_snapshots[1].SetAddressAndSize(0x7fff80000000, 0x20000);
+  module_snapshots[1].SetModuleType(ModuleSnapshot::kModuleTypeSharedLibrary);
+
+  TestThreadSnapshot thread_snapshots[arraysize(kThreadIDs)];
+  TestMemorySnapshot stack_snapshots[arraysize(kThreadIDs)];
+
+  TestProcessSnapshot process_snapshot;
+  process_snapshot.SetProcessID(1234);
+  process_snapshot.SetSnapshotTime(kSnapshotTime);
+  process_snapshot.SetSystem(&system_snapshot);
+  for (TestModuleSnapshot& module_snapshot : module_snapshots) {
+    process_snapshot.AddModule(&module_snapshot);
+  }
+  for (size_t index = 0; index < arraysize(kThreadIDs); ++index) {
+    stack_snapshots[index].SetAddress(kStackAddresses[index]);
+    stack_snapshots[index].SetSize(kStackSizes[index]);
+    stack_snapshots[index].SetValue(kStackValues[index]);
+
+    thread_snapshots[index].SetThreadID(kThreadIDs[index]);
+    thread_snapshots[index].SetStack(&stack_snapshots[index]);
+    InitializeCPUContextX86_64(thread_snapshots[index].MutableContext()->x86_64,
+                               static_cast<uint32_t>(index + 1));
+    process_snapshot.AddThread(&thread_snapshots[index]);
+  }
+
+  TestExceptionSnapshot exception_snapshot;
+  exception_snapshot.SetThreadID(kThreadIDs[1]);
+  exception_snapshot.SetException(1);
+  InitializeCPUContextX86_64(exception_snapshot.MutableContext()->x86_64, 3);
+  process_snapshot.SetException(&exception_snapshot);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.InitializeFromSnapshot(&process_snapshot));
+
+  // Memory is only read from the snapshot when the minidump is written.
+  for (const TestMemorySnapshot& stack_snapshot : stack_snapshots) {
+    EXPECT_EQ(0, stack_snapshot.read_count());
+  }
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  for (const TestMemorySnapshot& stack_snapshot : stack_snapshots) {
+    EXPECT_EQ(1, stack_snapshot.read_count());
+  }
+
+  const MINIDUMP_HEADER* header =
+      reinterpret_cast<const MINIDUMP_HEADER*>(&file_writer.string()[0]);
+  VerifyMinidumpHeader(header, 6, kSnapshotTime.tv_sec);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(&file_writer.string()[0],
+                                          file_writer.string().size()));
+
+  const MinidumpStreamType kExpectedStreamTypes[] = {
+      kMinidumpStreamTypeSystemInfo,
+      kMinidumpStreamTypeMiscInfo,
+      kMinidumpStreamTypeModuleList,
+      kMinidumpStreamTypeThreadList,
+      kMinidumpStreamTypeException,
+      kMinidumpStreamTypeMemoryList,
+  };
+  ASSERT_EQ(arraysize(kExpectedStreamTypes), reader.StreamCount());
+  for (size_t index = 0; index < arraysize(kExpectedStreamTypes); ++index) {
+    EXPECT_EQ(kExpectedStreamTypes[index], reader.StreamAt(index)->StreamType)
+        << "index " << index;
+  }
+
+  MinidumpModuleListView module_list;
+  ASSERT_TRUE(module_list.Initialize(&reader));
+  ASSERT_EQ(arraysize(module_snapshots), module_list.ModuleCount());
+  for (size_t index = 0; index < arraysize(module_snapshots); ++index) {
+    base::string16 name;
+    ASSERT_TRUE(module_list.ModuleNameAt(index, &name));
+    EXPECT_EQ(module_snapshots[index].Name(), base::UTF16ToUTF8(name));
+    EXPECT_EQ(module_snapshots[index].Address(),
+              module_list.ModuleAt(index)->BaseOfImage);
+  }
+
+  // Both stacks are present in the memory list, with their contents.
+  MinidumpMemoryListView memory_list;
+  ASSERT_TRUE(memory_list.Initialize(&reader));
+  ASSERT_EQ(arraysize(kStackAddresses), memory_list.MemoryRangeCount());
+  for (size_t index = 0; index < arraysize(kStackAddresses); ++index) {
+    const char* stack = reinterpret_cast<const char*>(
+        memory_list.FindMemory(kStackAddresses[index], kStackSizes[index]));
+    ASSERT_TRUE(stack) << "index " << index;
+    EXPECT_EQ(std::string(kStackSizes[index], kStackValues[index]),
+              std::string(stack, kStackSizes[index]));
+  }
+
+  const MINIDUMP_DIRECTORY* exception_directory =
+      reader.FindStream(kMinidumpStreamTypeException);
+  ASSERT_TRUE(exception_directory);
+  const MINIDUMP_EXCEPTION_STREAM* exception =
+      reader.ObjectAt<MINIDUMP_EXCEPTION_STREAM>(
+          exception_directory->Location.Rva);
+  ASSERT_TRUE(exception);
+  EXPECT_EQ(static_cast<uint32_t>(kThreadIDs[1]), exception->ThreadId);
+  EXPECT_EQ(1u, exception->ExceptionRecord.ExceptionCode);
+}
+
+TEST(MinidumpFileWriter, InitializeFromSynthesizedProcess) {
+  SynthesizedProcessOptions options;
+  options.thread_count = 40;
+  options.stack_size = 0x3000;
+  options.module_count = 25;
+  options.annotations_per_module = 4;
+  options.annotation_value_size = 16;
+  options.exception = true;
+  SynthesizedProcess process(options);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.InitializeFromSnapshot(
+      process.process_snapshot()));
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+  EXPECT_GT(file_writer.string().size(), process.MemoryBytes());
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(&file_writer.string()[0],
+                                          file_writer.string().size()));
+  EXPECT_EQ(6u, reader.StreamCount());
+
+  MinidumpModuleListView module_list;
+  ASSERT_TRUE(module_list.Initialize(&reader));
+  EXPECT_EQ(options.module_count, module_list.ModuleCount());
+
+  // Each stack is separated from its neighbors, so none are coalesced.
+  MinidumpMemoryListView memory_list;
+  ASSERT_TRUE(memory_list.Initialize(&reader));
+  EXPECT_EQ(options.thread_count, memory_list.MemoryRangeCount());
+
+  const MINIDUMP_DIRECTORY* thread_list_directory =
+      reader.FindStream(kMinidumpStreamTypeThreadList);
+  ASSERT_TRUE(thread_list_directory);
+  const MINIDUMP_THREAD_LIST* thread_list =
+      reader.ObjectAt<MINIDUMP_THREAD_LIST>(
+          thread_list_directory->Location.Rva);
+  ASSERT_TRUE(thread_list);
+  EXPECT_EQ(options.thread_count, thread_list->NumberOfThreads);
+}
+
+TEST(MinidumpFileWriter, InitializeFromSnapshotInArena) {
+  SynthesizedProcessOptions options;
+  options.thread_count = 40;
+  options.stack_size = 0x3000;
+  options.module_count = 25;
+  options.annotations_per_module = 4;
+  options.annotation_value_size = 16;
+  options.exception = true;
+  SynthesizedProcess process(options);
+
+  MinidumpFileWriter heap_minidump_file_writer;
+  ASSERT_TRUE(heap_minidump_file_writer.InitializeFromSnapshot(
+      process.process_snapshot()));
+  StringFileWriter heap_file_writer;
+  ASSERT_TRUE(heap_minidump_file_writer.WriteEverything(&heap_file_writer));
+
+  // Every writer created by InitializeFromSnapshot(), and every list of
+  // children, comes from the arena.
+  Arena arena;
+  arena.Reserve(1024 * 1024);
+  MinidumpFileWriter* arena_minidump_file_writer =
+      internal::MinidumpWritable::NewInArena<MinidumpFileWriter>(&arena);
+  ASSERT_TRUE(arena_minidump_file_writer->InitializeFromSnapshot(
+      process.process_snapshot()));
+  EXPECT_GT(arena.bytes_used(), options.thread_count * sizeof(MINIDUMP_THREAD));
+  StringFileWriter arena_file_writer;
+  ASSERT_TRUE(arena_minidump_file_writer->WriteEverything(&arena_file_writer));
+
+  EXPECT_EQ(1u, arena.block_count());
+  EXPECT_EQ(heap_file_writer.string(), arena_file_writer.string());
+}
+
 TEST(MinidumpFileWriterDeathTest, SameStreamType) {
   MinidumpFileWriter minidump_file;
 
@@ -14,14 +14,187 @@
 
 #include "minidump/minidump_memory_writer.h"
 
+#include <stdio.h>
+
+#include <algorithm>
+
 #include "base/logging.h"
+#include "snapshot/memory_snapshot.h"
 #include "util/numeric/safe_assignment.h"
 
 namespace crashpad {
+namespace {
+
+// A FileWriterInterface that discards a number of leading bytes written to it,
+// and passes everything after them through to another FileWriterInterface.
+// This is used to write only the portion of a coalesced memory range that
+// extends beyond what has already been written.
+class LeadingBytesDiscardingFileWriter final : public FileWriterInterface {
+ public:
+  LeadingBytesDiscardingFileWriter(FileWriterInterface* file_writer,
+                                   uint64_t discard_size)
+      : file_writer_(file_writer), discard_remaining_(discard_size) {}
+
+  ~LeadingBytesDiscardingFileWriter() {}
+
+  // FileWriterInterface:
+
+  virtual bool Write(const void* data, size_t size) override {
+    size_t discard = std::min(static_cast<uint64_t>(size), discard_remaining_);
+    discard_remaining_ -= discard;
+    if (discard == size) {
+      return true;
+    }
+
+    return file_writer_->Write(static_cast<const char*>(data) + discard,
+                               size - discard);
+  }
+
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override {
+    auto iovec = iovecs->begin();
+    while (discard_remaining_ > 0 && iovec != iovecs->end()) {
+      if (iovec->iov_len <= discard_remaining_) {
+        discard_remaining_ -= iovec->iov_len;
+        ++iovec;
+      } else {
+        iovec->iov_base =
+            static_cast<const char*>(iovec->iov_base) + discard_remaining_;
+        iovec->iov_len -= discard_remaining_;
+        discard_remaining_ = 0;
+      }
+    }
+
+    iovecs->erase(iovecs->begin(), iovec);
+    if (iovecs->empty()) {
+      return true;
+    }
+
+    return file_writer_->WriteIoVec(iovecs);
+  }
+
+  // Only queries of the current position are supported. The position reported
+  // is the one that the next byte written would occupy if nothing were
+  // discarded.
+  virtual off_t Seek(off_t offset, int whence) override {
+    if (offset != 0 || whence != SEEK_CUR) {
+      LOG(ERROR) << "seek not supported";
+      return -1;
+    }
+
+    off_t position = file_writer_->Seek(0, SEEK_CUR);
+    if (position < 0) {
+      return position;
+    }
+
+    return position - discard_remaining_;
+  }
+
+  // Only the portion that will not be discarded is passed on.
+  virtual bool WillWrite(size_t size) override {
+    if (size <= discard_remaining_) {
+      return true;
+    }
+
+    return file_writer_->WillWrite(size - discard_remaining_);
+  }
+
+ private:
+  FileWriterInterface* file_writer_;  // weak
+  uint64_t discard_remaining_;
+
+  DISALLOW_COPY_AND_ASSIGN(LeadingBytesDiscardingFileWriter);
+};
+
+// A MinidumpMemoryWriter whose contents are obtained from a MemorySnapshot.
+// The snapshot’s data is only read when it is written, and is passed directly
+// to the file writer without being copied or retained.
+class SnapshotMinidumpMemoryWriter final : public MinidumpMemoryWriter,
+                                           public MemorySnapshot::Delegate {
+ public:
+  SnapshotMinidumpMemoryWriter()
+      : MinidumpMemoryWriter(),
+        MemorySnapshot::Delegate(),
+        memory_snapshot_(NULL),
+        file_writer_(NULL) {}
+
+  ~SnapshotMinidumpMemoryWriter() {}
+
+  void SetMemorySnapshot(const MemorySnapshot* memory_snapshot) {
+    DCHECK_EQ(state(), kStateMutable);
+    memory_snapshot_ = memory_snapshot;
+  }
+
+  // MemorySnapshot::Delegate:
+
+  virtual bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    DCHECK(file_writer_);
+
+    if (size != memory_snapshot_->Size()) {
+      LOG(ERROR) << "snapshot size mismatch: " << size << " != "
+                 << memory_snapshot_->Size();
+      return false;
+    }
+
+    return size == 0 || file_writer_->Write(data, size);
+  }
+
+ protected:
+  // MinidumpMemoryWriter:
+
+  virtual uint64_t MemoryRangeBaseAddress() const override {
+    DCHECK_EQ(state(), kStateFrozen);
+    return memory_snapshot_->Address();
+  }
+
+  virtual size_t MemoryRangeSize() const override {
+    DCHECK_GE(state(), kStateFrozen);
+    return memory_snapshot_->Size();
+  }
+
+  virtual bool WriteMemory(FileWriterInterface* file_writer) override {
+    DCHECK_GE(state(), kStateWritable);
+    DCHECK(!file_writer_);
+
+    file_writer_ = file_writer;
+    bool rv = memory_snapshot_->Read(this);
+    file_writer_ = NULL;
+    return rv;
+  }
+
+ private:
+  const MemorySnapshot* memory_snapshot_;  // weak
+
+  // Valid only while WriteMemory() is running.
+  FileWriterInterface* file_writer_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(SnapshotMinidumpMemoryWriter);
+};
+
+}  // namespace
+
+// static
+scoped_ptr<MinidumpMemoryWriter> MinidumpMemoryWriter::CreateFromSnapshot(
+    const MemorySnapshot* memory_snapshot) {
+  SnapshotMinidumpMemoryWriter* snapshot_memory_writer =
+      new SnapshotMinidumpMemoryWriter();
+  scoped_ptr<MinidumpMemoryWriter> memory_writer(snapshot_memory_writer);
+  snapshot_memory_writer->SetMemorySnapshot(memory_snapshot);
+  return memory_writer.Pass();
+}
+
+// static
+MinidumpMemoryWriter* MinidumpMemoryWriter::CreateFromSnapshotInArena(
+    const MemorySnapshot* memory_snapshot,
+    Arena* arena) {
+  SnapshotMinidumpMemoryWriter* memory_writer =
+      NewInArena<SnapshotMinidumpMemoryWriter>(arena);
+  memory_writer->SetMemorySnapshot(memory_snapshot);
+  return memory_writer;
+}
 
 const MINIDUMP_MEMORY_DESCRIPTOR*
 MinidumpMemoryWriter::MinidumpMemoryDescriptor() const {
-  DCHECK_EQ(state(), kStateWritable);
+  DCHECK_GE(state(), kStateWritable);
 
   return &memory_descriptor_;
 }
@@ -30,14 +203,24 @@ void MinidumpMemoryWriter::RegisterMemoryDescriptor(
     MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor) {
   DCHECK_LE(state(), kStateFrozen);
 
+  // The location within the minidump file is populated by
+  // UpdateRegisteredMemoryDescriptors() rather than by
+  // RegisterLocationDescriptor(), because if this object’s range is coalesced
+  // into another’s, its data will be located within the other object’s data.
+  UseArena(&registered_memory_descriptors_);
   registered_memory_descriptors_.push_back(memory_descriptor);
-  RegisterLocationDescriptor(&memory_descriptor->Memory);
 }
 
 MinidumpMemoryWriter::MinidumpMemoryWriter()
     : MinidumpWritable(),
       memory_descriptor_(),
-      registered_memory_descriptors_() {
+      registered_memory_descriptors_(),
+      coalesced_memory_writers_(),
+      coalesced_into_(NULL),
+      coalesced_offset_(0) {
+}
+
+MinidumpMemoryWriter::~MinidumpMemoryWriter() {
 }
 
 bool MinidumpMemoryWriter::Freeze() {
@@ -61,45 +244,171 @@ size_t MinidumpMemoryWriter::Alignment() {
 size_t MinidumpMemoryWriter::SizeOfObject() {
   DCHECK_GE(state(), kStateFrozen);
 
-  return MemoryRangeSize();
+  // An object whose range has been coalesced into another’s is written as part
+  // of the other object, and occupies no space of its own.
+  if (coalesced_into_) {
+    return 0;
+  }
+
+  return CoalescedRangeSize();
 }
 
 bool MinidumpMemoryWriter::WillWriteAtOffsetImpl(off_t offset) {
   DCHECK_EQ(state(), kStateFrozen);
 
+  // The descriptors of an object whose range has been coalesced into another’s
+  // are updated by the other object, which knows where they will be located.
+  if (!coalesced_into_) {
+    uint64_t base_address = MemoryRangeBaseAddress();
+    if (!UpdateRegisteredMemoryDescriptors(base_address, offset)) {
+      return false;
+    }
+
+    for (MinidumpMemoryWriter* memory_writer : coalesced_memory_writers_) {
+      if (!memory_writer->UpdateRegisteredMemoryDescriptors(
+              base_address + memory_writer->coalesced_offset_,
+              offset + memory_writer->coalesced_offset_)) {
+        return false;
+      }
+    }
+
+    // The descriptor that appears in the memory list spans the entire
+    // coalesced region.
+    if (!coalesced_memory_writers_.empty()) {
+      size_t coalesced_range_size = CoalescedRangeSize();
+      if (!AssignIfInRange(&memory_descriptor_.Memory.DataSize,
+                           coalesced_range_size)) {
+        LOG(ERROR) << "coalesced_range_size " << coalesced_range_size
+                   << " out of range";
+        return false;
+      }
+    }
+  }
+
+  return MinidumpWritable::WillWriteAtOffsetImpl(offset);
+}
+
+internal::MinidumpWritable::Phase MinidumpMemoryWriter::WritePhase() {
+  // Memory dumps are large and are unlikely to be consumed in their entirety.
+  // Data accesses are expected to be sparse and sporadic, and are expected to
+  // occur after all of the other structural and informational data from the
+  // minidump file has been read. Put memory dumps at the end of the minidump
+  // file to improve spatial locality.
+  return kPhaseLate;
+}
+
+bool MinidumpMemoryWriter::WriteObject(FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  if (coalesced_into_) {
+    return true;
+  }
+
+  if (!WriteMemory(file_writer)) {
+    return false;
+  }
+
+  // Write the portions of coalesced ranges that extend beyond what’s already
+  // been written. Coalesced ranges are in order of increasing base address,
+  // and each begins within or immediately after the region covered by the
+  // ranges preceding it.
+  uint64_t written = MemoryRangeSize();
+  for (MinidumpMemoryWriter* memory_writer : coalesced_memory_writers_) {
+    DCHECK_LE(memory_writer->coalesced_offset_, written);
+    uint64_t end = memory_writer->coalesced_offset_ +
+                   memory_writer->MemoryRangeSize();
+    if (end <= written) {
+      continue;
+    }
+
+    LeadingBytesDiscardingFileWriter discarding_file_writer(
+        file_writer, written - memory_writer->coalesced_offset_);
+    if (!memory_writer->WriteMemory(&discarding_file_writer)) {
+      return false;
+    }
+
+    written = end;
+  }
+
+  return true;
+}
+
+internal::MinidumpWritable* MinidumpMemoryWriter::ParallelWriteLeader() {
+  DCHECK_EQ(state(), kStateWritable);
+
+  return coalesced_into_;
+}
+
+void MinidumpMemoryWriter::Coalesce(MinidumpMemoryWriter* memory_writer,
+                                    uint64_t offset) {
+  DCHECK_EQ(state(), kStateFrozen);
+  DCHECK_EQ(memory_writer->state(), kStateFrozen);
+  DCHECK_NE(memory_writer, this);
+  DCHECK(!coalesced_into_);
+  DCHECK(!memory_writer->coalesced_into_);
+  DCHECK(memory_writer->coalesced_memory_writers_.empty());
+  DCHECK_LE(offset, CoalescedRangeSize());
+
+  memory_writer->coalesced_into_ = this;
+  memory_writer->coalesced_offset_ = offset;
+  UseArena(&coalesced_memory_writers_);
+  coalesced_memory_writers_.push_back(memory_writer);
+}
+
+size_t MinidumpMemoryWriter::CoalescedRangeSize() const {
+  uint64_t size = MemoryRangeSize();
+  for (const MinidumpMemoryWriter* memory_writer : coalesced_memory_writers_) {
+    size = std::max(size,
+                    memory_writer->coalesced_offset_ +
+                        memory_writer->MemoryRangeSize());
+  }
+
+  return size;
+}
+
+bool MinidumpMemoryWriter::UpdateRegisteredMemoryDescriptors(
+    uint64_t base_address,
+    uint64_t offset) {
   // There will always be at least one registered descriptor, the one for this
   // object’s own memory_descriptor_ field.
   DCHECK_GE(registered_memory_descriptors_.size(), 1u);
 
-  uint64_t base_address = MemoryRangeBaseAddress();
   typeof(registered_memory_descriptors_[0]->StartOfMemoryRange) local_address;
   if (!AssignIfInRange(&local_address, base_address)) {
     LOG(ERROR) << "base_address " << base_address << " out of range";
     return false;
   }
 
+  RVA local_rva;
+  if (!AssignIfInRange(&local_rva, offset)) {
+    LOG(ERROR) << "offset " << offset << " out of range";
+    return false;
+  }
+
+  size_t size = MemoryRangeSize();
+  typeof(registered_memory_descriptors_[0]->Memory.DataSize) local_size;
+  if (!AssignIfInRange(&local_size, size)) {
+    LOG(ERROR) << "size " << size << " out of range";
+    return false;
+  }
+
   for (MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor :
            registered_memory_descriptors_) {
     memory_descriptor->StartOfMemoryRange = local_address;
+    memory_descriptor->Memory.Rva = local_rva;
+    memory_descriptor->Memory.DataSize = local_size;
   }
 
-  return MinidumpWritable::WillWriteAtOffsetImpl(offset);
-}
-
-internal::MinidumpWritable::Phase MinidumpMemoryWriter::WritePhase() {
-  // Memory dumps are large and are unlikely to be consumed in their entirety.
-  // Data accesses are expected to be sparse and sporadic, and are expected to
-  // occur after all of the other structural and informational data from the
-  // minidump file has been read. Put memory dumps at the end of the minidump
-  // file to improve spatial locality.
-  return kPhaseLate;
+  return true;
 }
 
 MinidumpMemoryListWriter::MinidumpMemoryListWriter()
     : MinidumpStreamWriter(),
       memory_list_base_(),
       memory_writers_(),
-      children_() {
+      children_(),
+      coalescing_limit_(0),
+      coalescing_enabled_(false) {
 }
 
 MinidumpMemoryListWriter::~MinidumpMemoryListWriter() {
@@ -108,6 +417,7 @@ MinidumpMemoryListWriter::~MinidumpMemoryListWriter() {
 void MinidumpMemoryListWriter::AddMemory(MinidumpMemoryWriter* memory_writer) {
   DCHECK_EQ(state(), kStateMutable);
 
+  UseArena(&children_);
   children_.push_back(memory_writer);
   AddExtraMemory(memory_writer);
 }
@@ -116,9 +426,17 @@ void MinidumpMemoryListWriter::AddExtraMemory(
     MinidumpMemoryWriter* memory_writer) {
   DCHECK_EQ(state(), kStateMutable);
 
+  UseArena(&memory_writers_);
   memory_writers_.push_back(memory_writer);
 }
 
+void MinidumpMemoryListWriter::EnableCoalescing(size_t coalescing_limit) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  coalescing_limit_ = coalescing_limit;
+  coalescing_enabled_ = true;
+}
+
 bool MinidumpMemoryListWriter::Freeze() {
   DCHECK_EQ(state(), kStateMutable);
 
@@ -126,8 +444,11 @@ bool MinidumpMemoryListWriter::Freeze() {
     return false;
   }
 
+  if (coalescing_enabled_) {
+    CoalesceMemoryWriters();
+  }
+
   size_t memory_region_count = memory_writers_.size();
-  CHECK_LE(children_.size(), memory_region_count);
 
   if (!AssignIfInRange(&memory_list_base_.NumberOfMemoryRanges,
                        memory_region_count)) {
@@ -141,17 +462,21 @@ bool MinidumpMemoryListWriter::Freeze() {
 
 size_t MinidumpMemoryListWriter::SizeOfObject() {
   DCHECK_GE(state(), kStateFrozen);
-  DCHECK_LE(children_.size(), memory_writers_.size());
 
   return sizeof(memory_list_base_) +
          memory_writers_.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
 }
 
-std::vector<internal::MinidumpWritable*> MinidumpMemoryListWriter::Children() {
+size_t MinidumpMemoryListWriter::ChildCount() {
   DCHECK_GE(state(), kStateFrozen);
-  DCHECK_LE(children_.size(), memory_writers_.size());
 
-  return children_;
+  return children_.size();
+}
+
+internal::MinidumpWritable* MinidumpMemoryListWriter::ChildAt(size_t index) {
+  DCHECK_GE(state(), kStateFrozen);
+
+  return children_[index];
 }
 
 bool MinidumpMemoryListWriter::WriteObject(FileWriterInterface* file_writer) {
@@ -175,4 +500,87 @@ MinidumpStreamType MinidumpMemoryListWriter::StreamType() const {
   return kMinidumpStreamTypeMemoryList;
 }
 
+void MinidumpMemoryListWriter::CoalesceMemoryWriters() {
+  DCHECK_EQ(state(), kStateFrozen);
+
+  struct MemoryRange {
+    MinidumpMemoryWriter* memory_writer;
+    uint64_t base_address;
+    uint64_t end_address;
+  };
+
+  // Only frozen memory writers can report their ranges. Writers that are
+  // children of objects that haven’t been frozen yet are listed as-is.
+  std::vector<MemoryRange> memory_ranges;
+  std::vector<MinidumpMemoryWriter*> uncoalesced_memory_writers;
+  for (MinidumpMemoryWriter* memory_writer : memory_writers_) {
+    if (memory_writer->state() == kStateFrozen) {
+      MemoryRange memory_range;
+      memory_range.memory_writer = memory_writer;
+      memory_range.base_address = memory_writer->MemoryRangeBaseAddress();
+      memory_range.end_address =
+          memory_range.base_address + memory_writer->MemoryRangeSize();
+      if (memory_range.end_address >= memory_range.base_address) {
+        memory_ranges.push_back(memory_range);
+        continue;
+      }
+    }
+
+    uncoalesced_memory_writers.push_back(memory_writer);
+  }
+
+  // Sort by base address. Where base addresses are equal, put larger ranges
+  // first so that smaller ones are recognized as contained within them. The
+  // final tie-breaker places any memory writer that was added more than once
+  // next to itself.
+  std::sort(memory_ranges.begin(),
+            memory_ranges.end(),
+            [](const MemoryRange& lhs, const MemoryRange& rhs) {
+              if (lhs.base_address != rhs.base_address) {
+                return lhs.base_address < rhs.base_address;
+              }
+              if (lhs.end_address != rhs.end_address) {
+                return lhs.end_address > rhs.end_address;
+              }
+              return lhs.memory_writer < rhs.memory_writer;
+            });
+
+  std::vector<MinidumpMemoryWriter*> memory_writers;
+  const MemoryRange* coalesced_range = NULL;
+  uint64_t coalesced_end_address = 0;
+  for (size_t index = 0; index < memory_ranges.size(); ++index) {
+    const MemoryRange& memory_range = memory_ranges[index];
+    if (index > 0 &&
+        memory_range.memory_writer == memory_ranges[index - 1].memory_writer) {
+      continue;
+    }
+
+    if (coalesced_range &&
+        memory_range.base_address <= coalesced_end_address &&
+        (memory_range.end_address <= coalesced_end_address ||
+         memory_range.end_address - coalesced_range->base_address <=
+             coalescing_limit_)) {
+      coalesced_range->memory_writer->Coalesce(
+          memory_range.memory_writer,
+          memory_range.base_address - coalesced_range->base_address);
+      coalesced_end_address =
+          std::max(coalesced_end_address, memory_range.end_address);
+      continue;
+    }
+
+    coalesced_range = &memory_range;
+    coalesced_end_address = memory_range.end_address;
+    memory_writers.push_back(memory_range.memory_writer);
+  }
+
+  // The list can only have shrunk, so rebuilding it in place doesn’t allocate.
+  memory_writers_.clear();
+  for (MinidumpMemoryWriter* memory_writer : memory_writers) {
+    memory_writers_.push_back(memory_writer);
+  }
+  for (MinidumpMemoryWriter* memory_writer : uncoalesced_memory_writers) {
+    memory_writers_.push_back(memory_writer);
+  }
+}
+
 }  // namespace crashpad
@@ -21,29 +21,73 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "minidump/minidump_stream_writer.h"
 #include "minidump/minidump_writable.h"
 #include "util/file/file_writer.h"
 
 namespace crashpad {
 
+class MemorySnapshot;
+
 //! \brief The base class for writers of memory ranges pointed to by
 //!     MINIDUMP_MEMORY_DESCRIPTOR objects in a minidump file.
 //!
 //! This is an abstract base class because users are expected to provide their
 //! own implementations that, when possible, obtain the memory contents
-//! on-demand in their WriteObject() methods. Memory ranges may be large, and
+//! on-demand in their WriteMemory() methods. Memory ranges may be large, and
 //! the alternative construction would require the contents of multiple ranges
 //! to be held in memory simultaneously while a minidump file is being written.
+//!
+//! A MinidumpMemoryListWriter may coalesce memory ranges that overlap or are
+//! adjacent to one another. All of the ranges in a coalesced group are written
+//! as a single contiguous region by the writer with the lowest base address,
+//! which calls the other writers’ WriteMemory() methods as needed to supply
+//! the portions of the region that it does not cover itself. Each memory
+//! descriptor registered with RegisterMemoryDescriptor() continues to describe
+//! the range of the writer it was registered with, located within the
+//! coalesced region.
 class MinidumpMemoryWriter : public internal::MinidumpWritable {
  public:
+  virtual ~MinidumpMemoryWriter();
+
+  //! \brief Creates a MinidumpMemoryWriter whose contents are obtained from a
+  //!     memory snapshot.
+  //!
+  //! The returned object reads \a memory_snapshot through
+  //! MemorySnapshot::Read() only when it is written, and passes the data
+  //! directly to its file writer, so that the contents of any number of memory
+  //! snapshots need not be held in memory at once.
+  //!
+  //! \param[in] memory_snapshot The memory snapshot to use as source data. This
+  //!     object does not take ownership of \a memory_snapshot, which must
+  //!     outlive the returned object.
+  //!
+  //! \return A new MinidumpMemoryWriter, owned by the caller.
+  static scoped_ptr<MinidumpMemoryWriter> CreateFromSnapshot(
+      const MemorySnapshot* memory_snapshot);
+
+  //! \brief Constructs a new MinidumpMemoryWriter based on \a memory_snapshot
+  //!     in \a arena.
+  //!
+  //! This is the same as CreateFromSnapshot(), except that the new object is
+  //! created by NewInArena().
+  //!
+  //! \return A new MinidumpMemoryWriter, owned by \a arena.
+  static MinidumpMemoryWriter* CreateFromSnapshotInArena(
+      const MemorySnapshot* memory_snapshot,
+      Arena* arena);
+
   //! \brief Returns a MINIDUMP_MEMORY_DESCRIPTOR referencing the data that this
   //!     object writes.
   //!
   //! This method is expected to be called by a MinidumpMemoryListWriter in
   //! order to obtain a MINIDUMP_MEMORY_DESCRIPTOR to include in its list.
   //!
-  //! \note Valid in #kStateWritable.
+  //! If other memory ranges have been coalesced into this object’s range, the
+  //! descriptor spans the entire coalesced region.
+  //!
+  //! \note Valid in #kStateWritable or any subsequent state.
   const MINIDUMP_MEMORY_DESCRIPTOR* MinidumpMemoryDescriptor() const;
 
   //! \brief Registers a memory descriptor as one that should point to the
@@ -60,7 +104,6 @@ class MinidumpMemoryWriter : public internal::MinidumpWritable {
 
  protected:
   MinidumpMemoryWriter();
-  ~MinidumpMemoryWriter() {}
 
   //! \brief Returns the base address of the memory region in the address space
   //!     of the process that the snapshot describes.
@@ -74,6 +117,25 @@ class MinidumpMemoryWriter : public internal::MinidumpWritable {
   //!     state.
   virtual size_t MemoryRangeSize() const = 0;
 
+  //! \brief Writes the contents of the memory region.
+  //!
+  //! Implementations must write exactly MemoryRangeSize() bytes to \a
+  //! file_writer, and must not seek it.
+  //!
+  //! If this object’s range has been coalesced with another range, this method
+  //! may be called while another MinidumpMemoryWriter is being written, after
+  //! this object has reached #kStateWritten. In that case, \a file_writer will
+  //! discard any leading portion of this object’s range that was already
+  //! written as part of another range.
+  //!
+  //! \param[in] file_writer The file writer to receive the memory contents.
+  //!
+  //! \return `true` on success. `false` on error, indicating that the content
+  //!     could not be written to the minidump file.
+  //!
+  //! \note Valid in #kStateWritable or any subsequent state.
+  virtual bool WriteMemory(FileWriterInterface* file_writer) = 0;
+
   // MinidumpWritable:
   virtual bool Freeze() override;
   virtual size_t SizeOfObject() override final;
@@ -102,11 +164,53 @@ class MinidumpMemoryWriter : public internal::MinidumpWritable {
   //! \note Valid in any state.
   virtual Phase WritePhase() override final;
 
+  virtual bool WriteObject(FileWriterInterface* file_writer) override final;
+
+  //! \brief Returns the object that this object’s range has been coalesced
+  //!     into, if any.
+  //!
+  //! That object’s WriteObject() writes this object’s memory, so the two must
+  //! not be written concurrently.
+  virtual MinidumpWritable* ParallelWriteLeader() override final;
+
  private:
+  friend class MinidumpMemoryListWriter;
+
+  //! \brief Coalesces another memory range into this object’s range.
+  //!
+  //! This is expected to be called by a MinidumpMemoryListWriter, which must
+  //! ensure that \a memory_writer’s range begins within or immediately after
+  //! the range already covered by this object, and that \a memory_writer has
+  //! not already been coalesced.
+  //!
+  //! \param[in] memory_writer The memory writer to coalesce into this object.
+  //! \param[in] offset The offset of \a memory_writer’s range from the start
+  //!     of this object’s range.
+  //!
+  //! \note Valid in #kStateFrozen.
+  void Coalesce(MinidumpMemoryWriter* memory_writer, uint64_t offset);
+
+  //! \brief Returns the size of the region covered by this object and any
+  //!     memory ranges coalesced into it.
+  size_t CoalescedRangeSize() const;
+
+  //! \brief Sets the location fields in each registered memory descriptor.
+  bool UpdateRegisteredMemoryDescriptors(uint64_t base_address,
+                                         uint64_t offset);
+
   MINIDUMP_MEMORY_DESCRIPTOR memory_descriptor_;
 
   // weak
-  std::vector<MINIDUMP_MEMORY_DESCRIPTOR*> registered_memory_descriptors_;
+  ArenaVector<MINIDUMP_MEMORY_DESCRIPTOR*> registered_memory_descriptors_;
+
+  // Memory writers whose ranges have been coalesced into this one, in order of
+  // increasing base address.
+  ArenaVector<MinidumpMemoryWriter*> coalesced_memory_writers_;  // weak
+
+  // The memory writer that this object’s range has been coalesced into, and
+  // this object’s offset within that writer’s range.
+  MinidumpMemoryWriter* coalesced_into_;  // weak
+  uint64_t coalesced_offset_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpMemoryWriter);
 };
@@ -142,20 +246,48 @@ class MinidumpMemoryListWriter final : public internal::MinidumpStreamWriter {
   //! \note Valid in #kStateMutable.
   void AddExtraMemory(MinidumpMemoryWriter* memory_writer);
 
+  //! \brief Enables coalescing of memory ranges.
+  //!
+  //! By default, memory ranges are listed in the order that they were added,
+  //! and each is written in its entirety.
+  //!
+  //! Once this method has been called, the memory ranges that this object lists
+  //! are instead sorted by base address when it is frozen. Duplicate ranges,
+  //! and ranges that lie entirely within another range, are dropped from the
+  //! list and are located within the range that contains them. Ranges that
+  //! overlap or are adjacent to one another are coalesced into a single range,
+  //! as long as the resulting range would be no larger than \a
+  //! coalescing_limit bytes. A value of `0` prevents ranges from being
+  //! coalesced, although contained ranges will still be dropped.
+  //!
+  //! Memory ranges of writers that are not yet frozen when this object is
+  //! frozen, because they are children of objects later in the tree, are
+  //! listed as-is, following the other ranges.
+  //!
+  //! \note Valid in #kStateMutable.
+  void EnableCoalescing(size_t coalescing_limit);
+
  protected:
   // MinidumpWritable:
   virtual bool Freeze() override;
   virtual size_t SizeOfObject() override;
-  virtual std::vector<MinidumpWritable*> Children() override;
+  virtual size_t ChildCount() override;
+  virtual MinidumpWritable* ChildAt(size_t index) override;
   virtual bool WriteObject(FileWriterInterface* file_writer) override;
 
   // MinidumpStreamWriter:
   virtual MinidumpStreamType StreamType() const override;
 
  private:
+  //! \brief Sorts and coalesces memory_writers_ as described for
+  //!     EnableCoalescing().
+  void CoalesceMemoryWriters();
+
   MINIDUMP_MEMORY_LIST memory_list_base_;
-  std::vector<MinidumpMemoryWriter*> memory_writers_;  // weak
-  std::vector<MinidumpWritable*> children_;  // weak
+  ArenaVector<MinidumpMemoryWriter*> memory_writers_;  // weak
+  ArenaVector<MinidumpWritable*> children_;  // weak
+  size_t coalescing_limit_;
+  bool coalescing_enabled_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpMemoryListWriter);
 };
@@ -33,6 +33,10 @@ namespace {
 const MinidumpStreamType kBogusStreamType =
     static_cast<MinidumpStreamType>(1234);
 
+// A limit large enough that it doesn’t prevent any of the ranges in these tests
+// from being coalesced.
+const size_t kCoalescingLimit = 16 * 1024 * 1024;
+
 // expected_streams is the expected number of streams in the file. The memory
 // list must be the last stream. If there is another stream, it must come first,
 // have stream type kBogusStreamType, and have zero-length data.
@@ -220,10 +224,15 @@ class TestMemoryStream final : public internal::MinidumpStreamWriter {
     return 0;
   }
 
-  virtual std::vector<MinidumpWritable*> Children() override {
+  virtual size_t ChildCount() override {
+    EXPECT_GE(state(), kStateFrozen);
+    return 1;
+  }
+
+  virtual MinidumpWritable* ChildAt(size_t index) override {
     EXPECT_GE(state(), kStateFrozen);
-    std::vector<MinidumpWritable*> children(1, memory());
-    return children;
+    EXPECT_EQ(0u, index);
+    return memory();
   }
 
   virtual bool WriteObject(FileWriterInterface* file_writer) override {
@@ -306,6 +315,300 @@ TEST(MinidumpMemoryWriter, ExtraMemory) {
   }
 }
 
+TEST(MinidumpMemoryWriter, NoCoalescingByDefault) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpMemoryListWriter memory_list_writer;
+
+  // These regions overlap, but are listed and written separately, in the order
+  // that they were added, unless coalescing is enabled.
+  const uint64_t kBaseAddress1 = 0x2080;
+  const size_t kSize1 = 0x100;
+  const uint8_t kValue1 = 'x';
+  const uint64_t kBaseAddress2 = 0x2000;
+  const size_t kSize2 = 0x100;
+  const uint8_t kValue2 = 'y';
+
+  TestMinidumpMemoryWriter memory_writer_1(kBaseAddress1, kSize1, kValue1);
+  memory_list_writer.AddMemory(&memory_writer_1);
+  TestMinidumpMemoryWriter memory_writer_2(kBaseAddress2, kSize2, kValue2);
+  memory_list_writer.AddMemory(&memory_writer_2);
+
+  minidump_file_writer.AddStream(&memory_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_MEMORY_LIST* memory_list;
+  GetMemoryListStream(file_writer.string(), &memory_list, 1);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(2u, memory_list->NumberOfMemoryRanges);
+
+  MINIDUMP_MEMORY_DESCRIPTOR expected;
+
+  {
+    SCOPED_TRACE("region 0");
+
+    expected.StartOfMemoryRange = kBaseAddress1;
+    expected.Memory.DataSize = kSize1;
+    expected.Memory.Rva =
+        sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+        sizeof(MINIDUMP_MEMORY_LIST) +
+        memory_list->NumberOfMemoryRanges * sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[0],
+                                              file_writer.string(),
+                                              kValue1,
+                                              false);
+  }
+
+  {
+    SCOPED_TRACE("region 1");
+
+    expected.StartOfMemoryRange = kBaseAddress2;
+    expected.Memory.DataSize = kSize2;
+    expected.Memory.Rva = memory_list->MemoryRanges[0].Memory.Rva +
+                          memory_list->MemoryRanges[0].Memory.DataSize;
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[1],
+                                              file_writer.string(),
+                                              kValue2,
+                                              true);
+  }
+}
+
+TEST(MinidumpMemoryWriter, CoalesceOverlappingAndAdjacent) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpMemoryListWriter memory_list_writer;
+
+  // Regions 1 and 2 overlap, and region 3 is adjacent to region 2. They should
+  // be coalesced into a single region. Region 4 stands alone. The regions are
+  // added out of order to verify that they are sorted.
+  const uint64_t kBaseAddress1 = 0x1000;
+  const size_t kSize1 = 0x100;
+  const uint8_t kValue1 = '1';
+  const uint64_t kBaseAddress2 = 0x1080;
+  const size_t kSize2 = 0x180;
+  const uint8_t kValue2 = '2';
+  const uint64_t kBaseAddress3 = 0x1200;
+  const size_t kSize3 = 0x100;
+  const uint8_t kValue3 = '3';
+  const uint64_t kBaseAddress4 = 0x5000;
+  const size_t kSize4 = 0x40;
+  const uint8_t kValue4 = '4';
+
+  memory_list_writer.EnableCoalescing(kCoalescingLimit);
+
+  TestMinidumpMemoryWriter memory_writer_4(kBaseAddress4, kSize4, kValue4);
+  memory_list_writer.AddMemory(&memory_writer_4);
+  TestMinidumpMemoryWriter memory_writer_2(kBaseAddress2, kSize2, kValue2);
+  memory_list_writer.AddMemory(&memory_writer_2);
+  TestMinidumpMemoryWriter memory_writer_3(kBaseAddress3, kSize3, kValue3);
+  memory_list_writer.AddMemory(&memory_writer_3);
+  TestMinidumpMemoryWriter memory_writer_1(kBaseAddress1, kSize1, kValue1);
+  memory_list_writer.AddMemory(&memory_writer_1);
+
+  minidump_file_writer.AddStream(&memory_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_MEMORY_LIST* memory_list;
+  GetMemoryListStream(file_writer.string(), &memory_list, 1);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(2u, memory_list->NumberOfMemoryRanges);
+
+  const MINIDUMP_MEMORY_DESCRIPTOR& coalesced = memory_list->MemoryRanges[0];
+  EXPECT_EQ(kBaseAddress1, coalesced.StartOfMemoryRange);
+  ASSERT_EQ(kBaseAddress3 + kSize3 - kBaseAddress1,
+            coalesced.Memory.DataSize);
+  EXPECT_EQ(0u, coalesced.Memory.Rva % 16);
+
+  // Each byte comes from the first region, in order of base address, to
+  // cover it.
+  std::string expected_data = std::string(kSize1, kValue1) +
+                              std::string(kBaseAddress3 - kBaseAddress1 -
+                                              kSize1,
+                                          kValue2) +
+                              std::string(kSize3, kValue3);
+  EXPECT_EQ(expected_data,
+            file_writer.string().substr(coalesced.Memory.Rva,
+                                        coalesced.Memory.DataSize));
+
+  // Each memory writer’s own descriptor locates its range within the coalesced
+  // region.
+  const MINIDUMP_MEMORY_DESCRIPTOR* descriptor_2 =
+      memory_writer_2.MinidumpMemoryDescriptor();
+  EXPECT_EQ(kBaseAddress2, descriptor_2->StartOfMemoryRange);
+  EXPECT_EQ(kSize2, descriptor_2->Memory.DataSize);
+  EXPECT_EQ(coalesced.Memory.Rva + kBaseAddress2 - kBaseAddress1,
+            descriptor_2->Memory.Rva);
+
+  const MINIDUMP_MEMORY_DESCRIPTOR* descriptor_3 =
+      memory_writer_3.MinidumpMemoryDescriptor();
+  EXPECT_EQ(kBaseAddress3, descriptor_3->StartOfMemoryRange);
+  EXPECT_EQ(kSize3, descriptor_3->Memory.DataSize);
+  EXPECT_EQ(coalesced.Memory.Rva + kBaseAddress3 - kBaseAddress1,
+            descriptor_3->Memory.Rva);
+
+  {
+    SCOPED_TRACE("region 1");
+
+    MINIDUMP_MEMORY_DESCRIPTOR expected;
+    // Data is written in the order that the memory writers were added, so
+    // this region’s data comes first.
+    expected.StartOfMemoryRange = kBaseAddress4;
+    expected.Memory.DataSize = kSize4;
+    expected.Memory.Rva =
+        sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+        sizeof(MINIDUMP_MEMORY_LIST) +
+        memory_list->NumberOfMemoryRanges * sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[1],
+                                              file_writer.string(),
+                                              kValue4,
+                                              false);
+  }
+}
+
+TEST(MinidumpMemoryWriter, CoalesceContainedAndDuplicate) {
+  MinidumpFileWriter minidump_file_writer;
+
+  // The extra memory region contains the other regions. One of those is an
+  // exact duplicate of it, and it’s also added to the list a second time.
+  const uint64_t kBaseAddress1 = 0x7000;
+  const size_t kSize1 = 0x800;
+  const uint8_t kValue1 = 's';
+  TestMemoryStream test_memory_stream(kBaseAddress1, kSize1, kValue1);
+
+  MinidumpMemoryListWriter memory_list_writer;
+  memory_list_writer.EnableCoalescing(kCoalescingLimit);
+  memory_list_writer.AddExtraMemory(test_memory_stream.memory());
+  memory_list_writer.AddExtraMemory(test_memory_stream.memory());
+
+  minidump_file_writer.AddStream(&test_memory_stream);
+
+  const uint64_t kBaseAddress2 = 0x7100;
+  const size_t kSize2 = 0x20;
+  TestMinidumpMemoryWriter memory_writer_2(kBaseAddress2, kSize2, kValue1);
+  memory_list_writer.AddMemory(&memory_writer_2);
+
+  TestMinidumpMemoryWriter memory_writer_3(kBaseAddress1, kSize1, kValue1);
+  memory_list_writer.AddMemory(&memory_writer_3);
+
+  minidump_file_writer.AddStream(&memory_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_MEMORY_LIST* memory_list;
+  GetMemoryListStream(file_writer.string(), &memory_list, 2);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(1u, memory_list->NumberOfMemoryRanges);
+
+  MINIDUMP_MEMORY_DESCRIPTOR expected;
+  expected.StartOfMemoryRange = kBaseAddress1;
+  expected.Memory.DataSize = kSize1;
+  expected.Memory.Rva = sizeof(MINIDUMP_HEADER) +
+                        2 * sizeof(MINIDUMP_DIRECTORY) +
+                        sizeof(MINIDUMP_MEMORY_LIST) +
+                        sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+  ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                            &memory_list->MemoryRanges[0],
+                                            file_writer.string(),
+                                            kValue1,
+                                            true);
+
+  // Nothing was written for the contained regions, but their descriptors
+  // locate them within the containing region.
+  const MINIDUMP_MEMORY_DESCRIPTOR* descriptor_2 =
+      memory_writer_2.MinidumpMemoryDescriptor();
+  EXPECT_EQ(kBaseAddress2, descriptor_2->StartOfMemoryRange);
+  EXPECT_EQ(kSize2, descriptor_2->Memory.DataSize);
+  EXPECT_EQ(memory_list->MemoryRanges[0].Memory.Rva + kBaseAddress2 -
+                kBaseAddress1,
+            descriptor_2->Memory.Rva);
+
+  const MINIDUMP_MEMORY_DESCRIPTOR* descriptor_3 =
+      memory_writer_3.MinidumpMemoryDescriptor();
+  EXPECT_EQ(kBaseAddress1, descriptor_3->StartOfMemoryRange);
+  EXPECT_EQ(kSize1, descriptor_3->Memory.DataSize);
+  EXPECT_EQ(memory_list->MemoryRanges[0].Memory.Rva, descriptor_3->Memory.Rva);
+}
+
+TEST(MinidumpMemoryWriter, CoalescingLimit) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpMemoryListWriter memory_list_writer;
+
+  // These regions are adjacent, but coalescing them would exceed the limit.
+  const uint64_t kBaseAddress1 = 0x1000;
+  const size_t kSize1 = 0x100;
+  const uint8_t kValue1 = 'a';
+  const uint64_t kBaseAddress2 = 0x1100;
+  const size_t kSize2 = 0x100;
+  const uint8_t kValue2 = 'b';
+
+  memory_list_writer.EnableCoalescing(kSize1 + kSize2 - 1);
+
+  TestMinidumpMemoryWriter memory_writer_1(kBaseAddress1, kSize1, kValue1);
+  memory_list_writer.AddMemory(&memory_writer_1);
+  TestMinidumpMemoryWriter memory_writer_2(kBaseAddress2, kSize2, kValue2);
+  memory_list_writer.AddMemory(&memory_writer_2);
+
+  minidump_file_writer.AddStream(&memory_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_MEMORY_LIST* memory_list;
+  GetMemoryListStream(file_writer.string(), &memory_list, 1);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(2u, memory_list->NumberOfMemoryRanges);
+
+  MINIDUMP_MEMORY_DESCRIPTOR expected;
+
+  {
+    SCOPED_TRACE("region 0");
+
+    expected.StartOfMemoryRange = kBaseAddress1;
+    expected.Memory.DataSize = kSize1;
+    expected.Memory.Rva =
+        sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+        sizeof(MINIDUMP_MEMORY_LIST) +
+        memory_list->NumberOfMemoryRanges * sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[0],
+                                              file_writer.string(),
+                                              kValue1,
+                                              false);
+  }
+
+  {
+    SCOPED_TRACE("region 1");
+
+    expected.StartOfMemoryRange = kBaseAddress2;
+    expected.Memory.DataSize = kSize2;
+    expected.Memory.Rva = memory_list->MemoryRanges[0].Memory.Rva +
+                          memory_list->MemoryRanges[0].Memory.DataSize;
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[1],
+                                              file_writer.string(),
+                                              kValue2,
+                                              true);
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
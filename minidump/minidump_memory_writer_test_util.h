@@ -41,14 +41,13 @@ class TestMinidumpMemoryWriter final : public MinidumpMemoryWriter {
   // MinidumpMemoryWriter:
   virtual uint64_t MemoryRangeBaseAddress() const override;
   virtual size_t MemoryRangeSize() const override;
+  virtual bool WriteMemory(FileWriterInterface* file_writer) override;
 
   // MinidumpWritable:
   virtual bool WillWriteAtOffsetImpl(off_t offset) override;
-  virtual bool WriteObject(FileWriterInterface* file_writer) override;
 
  private:
   uint64_t base_address_;
-  off_t expected_offset_;
   size_t size_;
   uint8_t value_;
 
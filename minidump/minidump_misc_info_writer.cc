@@ -14,18 +14,108 @@
 
 #include "minidump/minidump_misc_info_writer.h"
 
+#include <sys/time.h>
+
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "minidump/minidump_writer_util.h"
+#include "snapshot/process_snapshot.h"
+#include "snapshot/system_snapshot.h"
 #include "util/numeric/safe_assignment.h"
 
 namespace crashpad {
+namespace {
+
+// The values of MINIDUMP_MISC_INFO_3::TimeZoneId, as returned by Windows’
+// GetTimeZoneInformation().
+const uint32_t kTimeZoneIDUnknown = 0;
+const uint32_t kTimeZoneIDStandard = 1;
+const uint32_t kTimeZoneIDDaylight = 2;
+
+// Converts a timeval to whole seconds, clamped to the range of uint32_t.
+uint32_t TimevalToRoundedSeconds(const timeval& tv) {
+  uint64_t seconds = tv.tv_sec + (tv.tv_usec >= 500000 ? 1 : 0);
+  return base::saturated_cast<uint32_t>(seconds);
+}
+
+}  // namespace
 
 MinidumpMiscInfoWriter::MinidumpMiscInfoWriter()
     : MinidumpStreamWriter(), misc_info_() {
 }
 
+void MinidumpMiscInfoWriter::InitializeFromSnapshot(
+    const ProcessSnapshot* process_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK_EQ(misc_info_.Flags1, 0u);
+
+  SetProcessId(process_snapshot->ProcessID());
+
+  timeval start_time;
+  process_snapshot->ProcessStartTime(&start_time);
+
+  timeval user_time;
+  timeval system_time;
+  process_snapshot->ProcessCPUTimes(&user_time, &system_time);
+
+  SetProcessTimes(start_time.tv_sec,
+                  TimevalToRoundedSeconds(user_time),
+                  TimevalToRoundedSeconds(system_time));
+
+  const SystemSnapshot* system_snapshot = process_snapshot->System();
+
+  uint64_t current_hz;
+  uint64_t max_hz;
+  system_snapshot->CPUFrequency(&current_hz, &max_hz);
+  const uint64_t kHzPerMHz = 1000000;
+  uint32_t max_mhz = base::saturated_cast<uint32_t>(max_hz / kHzPerMHz);
+  SetProcessorPowerInfo(max_mhz,
+                        base::saturated_cast<uint32_t>(current_hz / kHzPerMHz),
+                        max_mhz,
+                        0,
+                        0);
+
+  SystemSnapshot::DaylightSavingTimeStatus dst_status;
+  int standard_offset_seconds;
+  int daylight_offset_seconds;
+  std::string standard_name;
+  std::string daylight_name;
+  system_snapshot->TimeZone(&dst_status,
+                            &standard_offset_seconds,
+                            &daylight_offset_seconds,
+                            &standard_name,
+                            &daylight_name);
+
+  uint32_t time_zone_id;
+  switch (dst_status) {
+    case SystemSnapshot::kObservingStandardTime:
+      time_zone_id = kTimeZoneIDStandard;
+      break;
+    case SystemSnapshot::kObservingDaylightSavingTime:
+      time_zone_id = kTimeZoneIDDaylight;
+      break;
+    default:
+      time_zone_id = kTimeZoneIDUnknown;
+      break;
+  }
+
+  // Biases are expressed in minutes west of UTC, and the daylight bias is
+  // relative to the standard bias. Transition dates are not known.
+  SYSTEMTIME no_date = {};
+  int32_t bias = -standard_offset_seconds / 60;
+  SetTimeZone(time_zone_id,
+              bias,
+              standard_name,
+              no_date,
+              0,
+              daylight_name,
+              no_date,
+              (standard_offset_seconds - daylight_offset_seconds) / 60);
+
+  SetBuildString(system_snapshot->OSVersionFull(), std::string());
+}
+
 void MinidumpMiscInfoWriter::SetProcessId(uint32_t process_id) {
   DCHECK_EQ(state(), kStateMutable);
 
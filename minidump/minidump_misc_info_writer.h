@@ -29,6 +29,8 @@
 
 namespace crashpad {
 
+class ProcessSnapshot;
+
 //! \brief The writer for a stream in the MINIDUMP_MISC_INFO family in a
 //!     minidump file.
 //!
@@ -42,6 +44,17 @@ class MinidumpMiscInfoWriter final : public internal::MinidumpStreamWriter {
   MinidumpMiscInfoWriter();
   ~MinidumpMiscInfoWriter() {}
 
+  //! \brief Initializes MINIDUMP_MISC_INFO_N based on \a process_snapshot.
+  //!
+  //! \param[in] process_snapshot The process snapshot to use as source data.
+  //!     Information about the system is taken from the SystemSnapshot that it
+  //!     provides.
+  //!
+  //! \note Valid in #kStateMutable. No mutator methods may be called before
+  //!     this method, and it is not normally necessary to call any mutator
+  //!     methods after this method.
+  void InitializeFromSnapshot(const ProcessSnapshot* process_snapshot);
+
   //! \brief Sets the field referenced by #MINIDUMP_MISC1_PROCESS_ID.
   void SetProcessId(uint32_t process_id);
 
@@ -17,6 +17,8 @@
 #include "base/logging.h"
 #include "minidump/minidump_string_writer.h"
 #include "minidump/minidump_writer_util.h"
+#include "snapshot/module_snapshot.h"
+#include "util/misc/uuid.h"
 #include "util/numeric/safe_assignment.h"
 
 namespace crashpad {
@@ -170,9 +172,11 @@ bool MinidumpModuleMiscDebugRecordWriter::WriteObject(
 MinidumpModuleWriter::MinidumpModuleWriter()
     : MinidumpWritable(),
       module_(),
-      name_(),
+      name_(NULL),
+      owned_name_(),
       codeview_record_(NULL),
-      misc_debug_record_(NULL) {
+      misc_debug_record_(NULL),
+      owned_codeview_record_() {
   module_.VersionInfo.dwSignature = VS_FFI_SIGNATURE;
   module_.VersionInfo.dwStrucVersion = VS_FFI_STRUCVERSION;
 }
@@ -180,6 +184,66 @@ MinidumpModuleWriter::MinidumpModuleWriter()
 MinidumpModuleWriter::~MinidumpModuleWriter() {
 }
 
+bool MinidumpModuleWriter::InitializeFromSnapshot(
+    const ModuleSnapshot* module_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(!name_);
+  DCHECK(!codeview_record_);
+  DCHECK(!misc_debug_record_);
+
+  std::string name = module_snapshot->Name();
+  SetName(name);
+
+  SetImageBaseAddress(module_snapshot->Address());
+
+  uint64_t image_size = module_snapshot->Size();
+  if (!AssignIfInRange(&module_.SizeOfImage, image_size)) {
+    LOG(ERROR) << "image_size " << image_size << " out of range";
+    return false;
+  }
+
+  SetTimestamp(module_snapshot->Timestamp());
+
+  uint16_t version[4];
+  module_snapshot->FileVersion(
+      &version[0], &version[1], &version[2], &version[3]);
+  SetFileVersion(version[0], version[1], version[2], version[3]);
+
+  module_snapshot->SourceVersion(
+      &version[0], &version[1], &version[2], &version[3]);
+  SetProductVersion(version[0], version[1], version[2], version[3]);
+
+  uint32_t file_type;
+  switch (module_snapshot->GetModuleType()) {
+    case ModuleSnapshot::kModuleTypeExecutable:
+      file_type = VFT_APP;
+      break;
+    case ModuleSnapshot::kModuleTypeSharedLibrary:
+    case ModuleSnapshot::kModuleTypeLoadableModule:
+      file_type = VFT_DLL;
+      break;
+    default:
+      file_type = VFT_UNKNOWN;
+      break;
+  }
+  SetFileTypeAndSubtype(file_type, VFT2_UNKNOWN);
+
+  // The PDB name is the module’s base name. There is no age associated with a
+  // module’s UUID.
+  MinidumpModuleCodeViewRecordPDB70Writer* codeview_record =
+      NewOwned<MinidumpModuleCodeViewRecordPDB70Writer>(
+          &owned_codeview_record_);
+  size_t last_slash = name.find_last_of('/');
+  codeview_record->SetPDBName(
+      last_slash == std::string::npos ? name : name.substr(last_slash + 1));
+  UUID uuid;
+  module_snapshot->UUID(&uuid);
+  codeview_record->SetUUIDAndAge(uuid, 0);
+  SetCodeViewRecord(codeview_record);
+
+  return true;
+}
+
 const MINIDUMP_MODULE* MinidumpModuleWriter::MinidumpModule() const {
   DCHECK_EQ(state(), kStateWritable);
 
@@ -190,7 +254,7 @@ void MinidumpModuleWriter::SetName(const std::string& name) {
   DCHECK_EQ(state(), kStateMutable);
 
   if (!name_) {
-    name_.reset(new internal::MinidumpUTF16StringWriter());
+    name_ = NewOwned<internal::MinidumpUTF16StringWriter>(&owned_name_);
   }
   name_->SetUTF8(name);
 }
@@ -278,20 +342,28 @@ size_t MinidumpModuleWriter::SizeOfObject() {
   return 0;
 }
 
-std::vector<internal::MinidumpWritable*> MinidumpModuleWriter::Children() {
+size_t MinidumpModuleWriter::ChildCount() {
   DCHECK_GE(state(), kStateFrozen);
   DCHECK(name_);
 
-  std::vector<MinidumpWritable*> children;
-  children.push_back(name_.get());
-  if (codeview_record_) {
-    children.push_back(codeview_record_);
-  }
-  if (misc_debug_record_) {
-    children.push_back(misc_debug_record_);
+  return 1 + (codeview_record_ ? 1 : 0) + (misc_debug_record_ ? 1 : 0);
+}
+
+internal::MinidumpWritable* MinidumpModuleWriter::ChildAt(size_t index) {
+  DCHECK_GE(state(), kStateFrozen);
+  DCHECK(name_);
+
+  // The optional records are skipped when they are absent.
+  MinidumpWritable* const children[] =
+      {name_, codeview_record_, misc_debug_record_};
+  for (MinidumpWritable* child : children) {
+    if (child && index-- == 0) {
+      return child;
+    }
   }
 
-  return children;
+  NOTREACHED();
+  return NULL;
 }
 
 bool MinidumpModuleWriter::WriteObject(FileWriterInterface* file_writer) {
@@ -304,15 +376,42 @@ bool MinidumpModuleWriter::WriteObject(FileWriterInterface* file_writer) {
 }
 
 MinidumpModuleListWriter::MinidumpModuleListWriter()
-    : MinidumpStreamWriter(), module_list_base_(), modules_() {
+    : MinidumpStreamWriter(),
+      module_list_base_(),
+      modules_(),
+      owned_modules_() {
 }
 
 MinidumpModuleListWriter::~MinidumpModuleListWriter() {
 }
 
+bool MinidumpModuleListWriter::InitializeFromSnapshot(
+    const std::vector<const ModuleSnapshot*>& module_snapshots) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(modules_.empty());
+
+  if (!arena()) {
+    owned_modules_.reserve(module_snapshots.size());
+  }
+  UseArena(&modules_);
+  modules_.reserve(module_snapshots.size());
+  for (const ModuleSnapshot* module_snapshot : module_snapshots) {
+    MinidumpModuleWriter* module =
+        NewOwned<MinidumpModuleWriter>(&owned_modules_);
+    if (!module->InitializeFromSnapshot(module_snapshot)) {
+      return false;
+    }
+
+    AddModule(module);
+  }
+
+  return true;
+}
+
 void MinidumpModuleListWriter::AddModule(MinidumpModuleWriter* module) {
   DCHECK_EQ(state(), kStateMutable);
 
+  UseArena(&modules_);
   modules_.push_back(module);
 }
 
@@ -338,15 +437,16 @@ size_t MinidumpModuleListWriter::SizeOfObject() {
   return sizeof(module_list_base_) + modules_.size() * sizeof(MINIDUMP_MODULE);
 }
 
-std::vector<internal::MinidumpWritable*> MinidumpModuleListWriter::Children() {
+size_t MinidumpModuleListWriter::ChildCount() {
   DCHECK_GE(state(), kStateFrozen);
 
-  std::vector<MinidumpWritable*> children;
-  for (MinidumpModuleWriter* module : modules_) {
-    children.push_back(module);
-  }
+  return modules_.size();
+}
+
+internal::MinidumpWritable* MinidumpModuleListWriter::ChildAt(size_t index) {
+  DCHECK_GE(state(), kStateFrozen);
 
-  return children;
+  return modules_[index];
 }
 
 bool MinidumpModuleListWriter::WriteObject(FileWriterInterface* file_writer) {
@@ -30,9 +30,12 @@
 #include "minidump/minidump_stream_writer.h"
 #include "minidump/minidump_writable.h"
 #include "util/file/file_writer.h"
+#include "util/stdlib/pointer_container.h"
 
 namespace crashpad {
 
+class ModuleSnapshot;
+
 namespace internal {
 class MinidumpUTF16StringWriter;
 }  // namespace internal
@@ -177,6 +180,21 @@ class MinidumpModuleWriter final : public internal::MinidumpWritable {
   MinidumpModuleWriter();
   ~MinidumpModuleWriter();
 
+  //! \brief Initializes the MINIDUMP_MODULE based on \a module_snapshot.
+  //!
+  //! A CodeView record identifying the module by its UUID is created and owned
+  //! by this object.
+  //!
+  //! \param[in] module_snapshot The module snapshot to use as source data.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  //!
+  //! \note Valid in #kStateMutable. No mutator methods may be called before
+  //!     this method, and it is not normally necessary to call any mutator
+  //!     methods after this method.
+  bool InitializeFromSnapshot(const ModuleSnapshot* module_snapshot);
+
   //! \brief Returns a MINIDUMP_MODULE referencing this object’s data.
   //!
   //! This method is expected to be called by a MinidumpModuleListWriter in
@@ -275,14 +293,21 @@ class MinidumpModuleWriter final : public internal::MinidumpWritable {
   // MinidumpWritable:
   virtual bool Freeze() override;
   virtual size_t SizeOfObject() override;
-  virtual std::vector<MinidumpWritable*> Children() override;
+  virtual size_t ChildCount() override;
+  virtual MinidumpWritable* ChildAt(size_t index) override;
   virtual bool WriteObject(FileWriterInterface* file_writer) override;
 
  private:
   MINIDUMP_MODULE module_;
-  scoped_ptr<internal::MinidumpUTF16StringWriter> name_;
+
+  // Owned by arena() if it was set when the name was set, otherwise by
+  // owned_name_. The same goes for a codeview_record_ created by
+  // InitializeFromSnapshot() and owned_codeview_record_.
+  internal::MinidumpUTF16StringWriter* name_;
+  scoped_ptr<internal::MinidumpUTF16StringWriter> owned_name_;
   MinidumpModuleCodeViewRecordWriter* codeview_record_;  // weak
   MinidumpModuleMiscDebugRecordWriter* misc_debug_record_;  // weak
+  scoped_ptr<MinidumpModuleCodeViewRecordWriter> owned_codeview_record_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpModuleWriter);
 };
@@ -294,6 +319,21 @@ class MinidumpModuleListWriter final : public internal::MinidumpStreamWriter {
   MinidumpModuleListWriter();
   ~MinidumpModuleListWriter();
 
+  //! \brief Adds an initialized MINIDUMP_MODULE for each module in \a
+  //!     module_snapshots to the MINIDUMP_MODULE_LIST.
+  //!
+  //! The MinidumpModuleWriter objects created by this method are owned by this
+  //! object.
+  //!
+  //! \param[in] module_snapshots The module snapshots to use as source data.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  //!
+  //! \note Valid in #kStateMutable.
+  bool InitializeFromSnapshot(
+      const std::vector<const ModuleSnapshot*>& module_snapshots);
+
   //! \brief Adds a MinidumpModuleWriter to the MINIDUMP_MODULE_LIST.
   //!
   //! \a module will become a child of this object in the overall tree of
@@ -306,7 +346,8 @@ class MinidumpModuleListWriter final : public internal::MinidumpStreamWriter {
   // MinidumpWritable:
   virtual bool Freeze() override;
   virtual size_t SizeOfObject() override;
-  virtual std::vector<MinidumpWritable*> Children() override;
+  virtual size_t ChildCount() override;
+  virtual MinidumpWritable* ChildAt(size_t index) override;
   virtual bool WriteObject(FileWriterInterface* file_writer) override;
 
   // MinidumpStreamWriter:
@@ -314,7 +355,8 @@ class MinidumpModuleListWriter final : public internal::MinidumpStreamWriter {
 
  private:
   MINIDUMP_MODULE_LIST module_list_base_;
-  std::vector<MinidumpModuleWriter*> modules_;  // weak
+  ArenaVector<MinidumpModuleWriter*> modules_;  // weak
+  PointerVector<MinidumpModuleWriter> owned_modules_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpModuleListWriter);
 };
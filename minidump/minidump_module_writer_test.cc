@@ -18,12 +18,18 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <string>
+#include <vector>
+
+#include "base/stl_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "gtest/gtest.h"
 #include "minidump/minidump_extensions.h"
 #include "minidump/minidump_file_writer.h"
 #include "minidump/minidump_test_util.h"
 #include "util/file/string_file_writer.h"
+#include "util/misc/arena.h"
 #include "util/misc/uuid.h"
 
 namespace crashpad {
@@ -659,6 +665,70 @@ TEST(MinidumpModuleWriter, ThreeModules) {
   }
 }
 
+// Builds a module list of |module_count| modules, each with a CodeView record,
+// allocating every object from |arena| if it is not NULL, and writes it.
+void WriteModuleList(Arena* arena, size_t module_count, std::string* contents) {
+  std::vector<MinidumpModuleWriter*> heap_modules;
+  std::vector<MinidumpModuleCodeViewRecordPDB70Writer*> heap_codeview_records;
+
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpModuleListWriter module_list_writer;
+  for (size_t index = 0; index < module_count; ++index) {
+    MinidumpModuleWriter* module_writer;
+    MinidumpModuleCodeViewRecordPDB70Writer* codeview_record_writer;
+    if (arena) {
+      module_writer =
+          internal::MinidumpWritable::NewInArena<MinidumpModuleWriter>(arena);
+      codeview_record_writer = internal::MinidumpWritable::NewInArena<
+          MinidumpModuleCodeViewRecordPDB70Writer>(arena);
+    } else {
+      module_writer = new MinidumpModuleWriter();
+      heap_modules.push_back(module_writer);
+      codeview_record_writer = new MinidumpModuleCodeViewRecordPDB70Writer();
+      heap_codeview_records.push_back(codeview_record_writer);
+    }
+
+    std::string name = base::StringPrintf("module_%zu", index);
+    module_writer->SetName(name);
+    module_writer->SetImageBaseAddress(0x10000000 + index * 0x10000);
+    module_writer->SetImageSize(0x8000);
+    codeview_record_writer->SetPDBName(name + ".pdb");
+    module_writer->SetCodeViewRecord(codeview_record_writer);
+    module_list_writer.AddModule(module_writer);
+  }
+  minidump_file_writer.AddStream(&module_list_writer);
+
+  StringFileWriter file_writer;
+  EXPECT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+  contents->assign(file_writer.string());
+
+  STLDeleteElements(&heap_modules);
+  STLDeleteElements(&heap_codeview_records);
+}
+
+TEST(MinidumpModuleWriter, Arena) {
+  const size_t kModuleCount = 1000;
+
+  std::string heap_contents;
+  WriteModuleList(NULL, kModuleCount, &heap_contents);
+
+  Arena arena;
+  arena.Reserve(kModuleCount * 1024);
+  std::string arena_contents;
+  WriteModuleList(&arena, kModuleCount, &arena_contents);
+
+  EXPECT_EQ(1u, arena.block_count());
+  EXPECT_EQ(heap_contents, arena_contents);
+
+  const MINIDUMP_MODULE_LIST* module_list;
+  GetModuleListStream(arena_contents, &module_list);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  EXPECT_EQ(kModuleCount, module_list->NumberOfModules);
+}
+
 TEST(MinidumpSystemInfoWriterDeathTest, NoModuleName) {
   MinidumpFileWriter minidump_file_writer;
   MinidumpModuleListWriter module_list_writer;
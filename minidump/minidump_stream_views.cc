@@ -0,0 +1,329 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_stream_views.h"
+
+#include <stddef.h>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+#include "minidump/minidump_file_reader.h"
+#include "util/numeric/checked_range.h"
+
+namespace crashpad {
+
+namespace {
+
+// Verifies that a stream or other structure at |location|, which begins with a
+// header of |header_size| bytes, is large enough to contain the |count|
+// elements of |element_size| bytes each that follow the header.
+bool LocationContainsArray(const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                           size_t header_size,
+                           size_t count,
+                           size_t element_size) {
+  base::CheckedNumeric<size_t> size = count;
+  size *= element_size;
+  size += header_size;
+  if (!size.IsValid() || size.ValueOrDie() > location.DataSize) {
+    LOG(ERROR) << "count " << count << " too large for size "
+               << location.DataSize;
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace
+
+MinidumpModuleListView::MinidumpModuleListView()
+    : reader_(NULL), module_list_(NULL), initialized_() {
+}
+
+MinidumpModuleListView::~MinidumpModuleListView() {
+}
+
+bool MinidumpModuleListView::Initialize(const MinidumpFileReader* reader) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const MINIDUMP_DIRECTORY* directory =
+      reader->FindStream(kMinidumpStreamTypeModuleList);
+  if (!directory) {
+    return false;
+  }
+
+  const MINIDUMP_MODULE_LIST* module_list =
+      static_cast<const MINIDUMP_MODULE_LIST*>(reader->DataAtLocation(
+          directory->Location, sizeof(MINIDUMP_MODULE_LIST)));
+  if (!module_list ||
+      !LocationContainsArray(directory->Location,
+                             sizeof(*module_list),
+                             module_list->NumberOfModules,
+                             sizeof(module_list->Modules[0]))) {
+    return false;
+  }
+
+  reader_ = reader;
+  module_list_ = module_list;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+size_t MinidumpModuleListView::ModuleCount() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return module_list_->NumberOfModules;
+}
+
+const MINIDUMP_MODULE* MinidumpModuleListView::ModuleAt(size_t index) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK_LT(index, ModuleCount());
+  return &module_list_->Modules[index];
+}
+
+bool MinidumpModuleListView::ModuleNameAt(size_t index,
+                                          base::string16* name) const {
+  return reader_->UTF16StringAt(ModuleAt(index)->ModuleNameRva, name);
+}
+
+const void* MinidumpModuleListView::CodeViewRecordAt(size_t index,
+                                                     size_t* size) const {
+  const MINIDUMP_LOCATION_DESCRIPTOR& location = ModuleAt(index)->CvRecord;
+  if (location.DataSize == 0) {
+    return NULL;
+  }
+
+  // Every CodeView record format begins with a 32-bit signature.
+  const void* codeview_record =
+      reader_->DataAtLocation(location, sizeof(uint32_t));
+  if (!codeview_record) {
+    return NULL;
+  }
+
+  *size = location.DataSize;
+  return codeview_record;
+}
+
+MinidumpMemoryListView::MinidumpMemoryListView()
+    : reader_(NULL), memory_list_(NULL), initialized_() {
+}
+
+MinidumpMemoryListView::~MinidumpMemoryListView() {
+}
+
+bool MinidumpMemoryListView::Initialize(const MinidumpFileReader* reader) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const MINIDUMP_DIRECTORY* directory =
+      reader->FindStream(kMinidumpStreamTypeMemoryList);
+  if (!directory) {
+    return false;
+  }
+
+  const MINIDUMP_MEMORY_LIST* memory_list =
+      static_cast<const MINIDUMP_MEMORY_LIST*>(reader->DataAtLocation(
+          directory->Location, sizeof(MINIDUMP_MEMORY_LIST)));
+  if (!memory_list ||
+      !LocationContainsArray(directory->Location,
+                             sizeof(*memory_list),
+                             memory_list->NumberOfMemoryRanges,
+                             sizeof(memory_list->MemoryRanges[0]))) {
+    return false;
+  }
+
+  reader_ = reader;
+  memory_list_ = memory_list;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+size_t MinidumpMemoryListView::MemoryRangeCount() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return memory_list_->NumberOfMemoryRanges;
+}
+
+const MINIDUMP_MEMORY_DESCRIPTOR* MinidumpMemoryListView::DescriptorAt(
+    size_t index) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK_LT(index, MemoryRangeCount());
+  return &memory_list_->MemoryRanges[index];
+}
+
+const void* MinidumpMemoryListView::MemoryAt(size_t index) const {
+  return reader_->DataAtLocation(DescriptorAt(index)->Memory, 0);
+}
+
+const void* MinidumpMemoryListView::FindMemory(uint64_t address,
+                                               size_t size) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  CheckedRange<uint64_t, size_t> requested_range(address, size);
+  if (!requested_range.IsValid()) {
+    LOG(ERROR) << "address " << address << " size " << size << " invalid";
+    return NULL;
+  }
+
+  // Memory ranges are not required to be sorted or disjoint, so they must all
+  // be considered.
+  size_t memory_range_count = MemoryRangeCount();
+  for (size_t index = 0; index < memory_range_count; ++index) {
+    const MINIDUMP_MEMORY_DESCRIPTOR* descriptor = DescriptorAt(index);
+    CheckedRange<uint64_t, size_t> memory_range(
+        descriptor->StartOfMemoryRange, descriptor->Memory.DataSize);
+    if (!memory_range.IsValid() ||
+        !memory_range.ContainsRange(requested_range)) {
+      continue;
+    }
+
+    const uint8_t* memory = static_cast<const uint8_t*>(MemoryAt(index));
+    if (!memory) {
+      continue;
+    }
+
+    return memory + (address - descriptor->StartOfMemoryRange);
+  }
+
+  return NULL;
+}
+
+MinidumpSimpleStringDictionaryView::MinidumpSimpleStringDictionaryView()
+    : reader_(NULL), dictionary_(NULL), initialized_() {
+}
+
+MinidumpSimpleStringDictionaryView::~MinidumpSimpleStringDictionaryView() {
+}
+
+bool MinidumpSimpleStringDictionaryView::Initialize(
+    const MinidumpFileReader* reader,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const MinidumpSimpleStringDictionary* dictionary =
+      static_cast<const MinidumpSimpleStringDictionary*>(
+          reader->DataAtLocation(location,
+                                 sizeof(MinidumpSimpleStringDictionary)));
+  if (!dictionary ||
+      !LocationContainsArray(location,
+                             sizeof(*dictionary),
+                             dictionary->count,
+                             sizeof(dictionary->entries[0]))) {
+    return false;
+  }
+
+  reader_ = reader;
+  dictionary_ = dictionary;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+size_t MinidumpSimpleStringDictionaryView::EntryCount() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return dictionary_->count;
+}
+
+bool MinidumpSimpleStringDictionaryView::EntryAt(
+    size_t index,
+    base::StringPiece* key,
+    base::StringPiece* value) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK_LT(index, EntryCount());
+
+  const MinidumpSimpleStringDictionaryEntry& entry =
+      dictionary_->entries[index];
+  return reader_->UTF8StringAt(entry.key, key) &&
+         reader_->UTF8StringAt(entry.value, value);
+}
+
+bool MinidumpSimpleStringDictionaryView::ToMap(
+    std::map<std::string, std::string>* map) const {
+  size_t entry_count = EntryCount();
+  for (size_t index = 0; index < entry_count; ++index) {
+    base::StringPiece key;
+    base::StringPiece value;
+    if (!EntryAt(index, &key, &value)) {
+      return false;
+    }
+
+    (*map)[key.as_string()] = value.as_string();
+  }
+
+  return true;
+}
+
+MinidumpCrashpadInfoView::MinidumpCrashpadInfoView()
+    : reader_(NULL),
+      crashpad_info_(NULL),
+      crashpad_info_size_(0),
+      initialized_() {
+}
+
+MinidumpCrashpadInfoView::~MinidumpCrashpadInfoView() {
+}
+
+bool MinidumpCrashpadInfoView::Initialize(const MinidumpFileReader* reader) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const MINIDUMP_DIRECTORY* directory =
+      reader->FindStream(kMinidumpStreamTypeCrashpadInfo);
+  if (!directory) {
+    return false;
+  }
+
+  // Only the size and version fields are required to be present. Other fields
+  // are consulted only if both the version and size indicate their presence.
+  const size_t kMinimumSize =
+      offsetof(MinidumpCrashpadInfo, simple_annotations);
+  const MinidumpCrashpadInfo* crashpad_info =
+      static_cast<const MinidumpCrashpadInfo*>(
+          reader->DataAtLocation(directory->Location, kMinimumSize));
+  if (!crashpad_info) {
+    return false;
+  }
+
+  if (crashpad_info->size > directory->Location.DataSize) {
+    LOG(ERROR) << "crashpad_info size " << crashpad_info->size
+               << " exceeds stream size " << directory->Location.DataSize;
+    return false;
+  }
+
+  reader_ = reader;
+  crashpad_info_ = crashpad_info;
+  crashpad_info_size_ = crashpad_info->size;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+uint32_t MinidumpCrashpadInfoView::Version() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return crashpad_info_->version;
+}
+
+bool MinidumpCrashpadInfoView::SimpleAnnotations(
+    MinidumpSimpleStringDictionaryView* simple_annotations) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (Version() < 1 ||
+      crashpad_info_size_ < offsetof(MinidumpCrashpadInfo, simple_annotations) +
+                                sizeof(crashpad_info_->simple_annotations) ||
+      crashpad_info_->simple_annotations.DataSize == 0) {
+    return false;
+  }
+
+  return simple_annotations->Initialize(reader_,
+                                        crashpad_info_->simple_annotations);
+}
+
+}  // namespace crashpad
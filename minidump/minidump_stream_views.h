@@ -0,0 +1,221 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_STREAM_VIEWS_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_STREAM_VIEWS_H_
+
+#include <dbghelp.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/string16.h"
+#include "base/strings/string_piece.h"
+#include "minidump/minidump_extensions.h"
+#include "util/misc/initialization_state_dcheck.h"
+
+namespace crashpad {
+
+class MinidumpFileReader;
+
+//! \brief A view of a minidump file’s MINIDUMP_MODULE_LIST stream.
+//!
+//! Initialize() validates only the stream’s location and the bounds of its
+//! array of MINIDUMP_MODULE structures. Data that modules refer to, such as
+//! their names, is located and validated only when requested.
+class MinidumpModuleListView {
+ public:
+  MinidumpModuleListView();
+  ~MinidumpModuleListView();
+
+  //! \brief Locates and validates the module list stream in \a reader.
+  //!
+  //! \param[in] reader The minidump file to read from. This object does not
+  //!     take ownership of \a reader, which must outlive it.
+  //!
+  //! \return `true` on success. `false` if the stream is not present, or if it
+  //!     is malformed, in which case a message will be logged.
+  bool Initialize(const MinidumpFileReader* reader);
+
+  //! \brief Returns the number of modules in the module list.
+  size_t ModuleCount() const;
+
+  //! \brief Returns the module at \a index, which must be less than
+  //!     ModuleCount().
+  const MINIDUMP_MODULE* ModuleAt(size_t index) const;
+
+  //! \brief Reads the name of the module at \a index, which must be less than
+  //!     ModuleCount().
+  //!
+  //! \return `true` on success. `false` if the name is malformed, with a
+  //!     message logged.
+  bool ModuleNameAt(size_t index, base::string16* name) const;
+
+  //! \brief Returns the CodeView record of the module at \a index, which must
+  //!     be less than ModuleCount().
+  //!
+  //! \param[in] index The module whose CodeView record to return.
+  //! \param[out] size The size of the CodeView record.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if the module has no
+  //!     CodeView record, or if it is malformed, in which case a message will
+  //!     be logged.
+  const void* CodeViewRecordAt(size_t index, size_t* size) const;
+
+ private:
+  const MinidumpFileReader* reader_;  // weak
+  const MINIDUMP_MODULE_LIST* module_list_;  // weak
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpModuleListView);
+};
+
+//! \brief A view of a minidump file’s MINIDUMP_MEMORY_LIST stream.
+//!
+//! Initialize() validates only the stream’s location and the bounds of its
+//! array of MINIDUMP_MEMORY_DESCRIPTOR structures. Memory contents are located
+//! and validated only when requested.
+class MinidumpMemoryListView {
+ public:
+  MinidumpMemoryListView();
+  ~MinidumpMemoryListView();
+
+  //! \brief Locates and validates the memory list stream in \a reader.
+  //!
+  //! \param[in] reader The minidump file to read from. This object does not
+  //!     take ownership of \a reader, which must outlive it.
+  //!
+  //! \return `true` on success. `false` if the stream is not present, or if it
+  //!     is malformed, in which case a message will be logged.
+  bool Initialize(const MinidumpFileReader* reader);
+
+  //! \brief Returns the number of memory ranges in the memory list.
+  size_t MemoryRangeCount() const;
+
+  //! \brief Returns the memory descriptor at \a index, which must be less than
+  //!     MemoryRangeCount().
+  const MINIDUMP_MEMORY_DESCRIPTOR* DescriptorAt(size_t index) const;
+
+  //! \brief Returns the contents of the memory range at \a index, which must
+  //!     be less than MemoryRangeCount().
+  //!
+  //! The size of the returned data is the `Memory.DataSize` field of the
+  //! corresponding descriptor.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if the memory range
+  //!     is malformed, with a message logged.
+  const void* MemoryAt(size_t index) const;
+
+  //! \brief Finds the contents of process memory at \a address.
+  //!
+  //! \param[in] address The address of the process memory to find.
+  //! \param[in] size The size of the process memory to find.
+  //!
+  //! \return A pointer into the file’s contents. `NULL` if no single memory
+  //!     range contains all of the requested process memory.
+  const void* FindMemory(uint64_t address, size_t size) const;
+
+ private:
+  const MinidumpFileReader* reader_;  // weak
+  const MINIDUMP_MEMORY_LIST* memory_list_;  // weak
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpMemoryListView);
+};
+
+//! \brief A view of a MinidumpSimpleStringDictionary in a minidump file.
+class MinidumpSimpleStringDictionaryView {
+ public:
+  MinidumpSimpleStringDictionaryView();
+  ~MinidumpSimpleStringDictionaryView();
+
+  //! \brief Locates and validates the dictionary at \a location in \a reader.
+  //!
+  //! \param[in] reader The minidump file to read from. This object does not
+  //!     take ownership of \a reader, which must outlive it.
+  //! \param[in] location The location of the dictionary.
+  //!
+  //! \return `true` on success. `false` if the dictionary is malformed, with a
+  //!     message logged.
+  bool Initialize(const MinidumpFileReader* reader,
+                  const MINIDUMP_LOCATION_DESCRIPTOR& location);
+
+  //! \brief Returns the number of entries in the dictionary.
+  size_t EntryCount() const;
+
+  //! \brief Returns the key and value of the entry at \a index, which must be
+  //!     less than EntryCount(), without copying them.
+  //!
+  //! \return `true` on success. `false` if the entry is malformed, with a
+  //!     message logged.
+  bool EntryAt(size_t index,
+               base::StringPiece* key,
+               base::StringPiece* value) const;
+
+  //! \brief Copies every entry of the dictionary into \a map.
+  //!
+  //! \return `true` on success. `false` if any entry is malformed, with a
+  //!     message logged.
+  bool ToMap(std::map<std::string, std::string>* map) const;
+
+ private:
+  const MinidumpFileReader* reader_;  // weak
+  const MinidumpSimpleStringDictionary* dictionary_;  // weak
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpSimpleStringDictionaryView);
+};
+
+//! \brief A view of a minidump file’s MinidumpCrashpadInfo stream.
+class MinidumpCrashpadInfoView {
+ public:
+  MinidumpCrashpadInfoView();
+  ~MinidumpCrashpadInfoView();
+
+  //! \brief Locates and validates the Crashpad information stream in \a
+  //!     reader.
+  //!
+  //! \param[in] reader The minidump file to read from. This object does not
+  //!     take ownership of \a reader, which must outlive it.
+  //!
+  //! \return `true` on success. `false` if the stream is not present, or if it
+  //!     is malformed, in which case a message will be logged.
+  bool Initialize(const MinidumpFileReader* reader);
+
+  //! \brief Returns the structure’s MinidumpCrashpadInfo::version field.
+  uint32_t Version() const;
+
+  //! \brief Initializes \a simple_annotations to view the simple annotations
+  //!     dictionary.
+  //!
+  //! \return `true` on success. `false` if the stream does not contain a
+  //!     simple annotations dictionary, or if it is malformed, in which case a
+  //!     message will be logged.
+  bool SimpleAnnotations(
+      MinidumpSimpleStringDictionaryView* simple_annotations) const;
+
+ private:
+  const MinidumpFileReader* reader_;  // weak
+  const MinidumpCrashpadInfo* crashpad_info_;  // weak
+  size_t crashpad_info_size_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpCrashpadInfoView);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_STREAM_VIEWS_H_
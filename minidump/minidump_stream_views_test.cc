@@ -0,0 +1,342 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_stream_views.h"
+
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/utf_string_conversions.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_file_reader.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/minidump_memory_writer_test_util.h"
+#include "minidump/minidump_module_writer.h"
+#include "minidump/minidump_stream_writer.h"
+#include "util/file/string_file_writer.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(MinidumpStreamViews, AbsentStreams) {
+  MinidumpFileWriter minidump_file;
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(file_writer.string().data(),
+                                          file_writer.string().size()));
+
+  MinidumpModuleListView module_list;
+  EXPECT_FALSE(module_list.Initialize(&reader));
+  MinidumpMemoryListView memory_list;
+  EXPECT_FALSE(memory_list.Initialize(&reader));
+  MinidumpCrashpadInfoView crashpad_info;
+  EXPECT_FALSE(crashpad_info.Initialize(&reader));
+}
+
+TEST(MinidumpModuleListView, RoundTrip) {
+  MinidumpFileWriter minidump_file;
+  MinidumpModuleListWriter module_list_writer;
+
+  const char kModuleName0[] = "/usr/lib/dyld";
+  const uint64_t kModuleBase0 = 0x7fff5fc00000;
+  MinidumpModuleWriter module_writer_0;
+  module_writer_0.SetName(kModuleName0);
+  module_writer_0.SetImageBaseAddress(kModuleBase0);
+  module_list_writer.AddModule(&module_writer_0);
+
+  const char kModuleName1[] = "/usr/lib/libSystem.B.dylib";
+  const uint64_t kModuleBase1 = 0x7fff8a000000;
+  const uint8_t kPDBUUIDBytes[16] = {0xfa, 0xce, 0xb0, 0x0c, 0x15, 0xab,
+                                     0xad, 0xd0, 0x0d, 0x1e, 0x5e, 0xb0,
+                                     0xbe, 0xda, 0xba, 0x11};
+  UUID pdb_uuid(kPDBUUIDBytes);
+  MinidumpModuleWriter module_writer_1;
+  module_writer_1.SetName(kModuleName1);
+  module_writer_1.SetImageBaseAddress(kModuleBase1);
+  MinidumpModuleCodeViewRecordPDB70Writer codeview_pdb70_writer;
+  codeview_pdb70_writer.SetPDBName("libSystem.B.pdb");
+  codeview_pdb70_writer.SetUUIDAndAge(pdb_uuid, 3);
+  module_writer_1.SetCodeViewRecord(&codeview_pdb70_writer);
+  module_list_writer.AddModule(&module_writer_1);
+
+  minidump_file.AddStream(&module_list_writer);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(file_writer.string().data(),
+                                          file_writer.string().size()));
+  MinidumpModuleListView module_list;
+  ASSERT_TRUE(module_list.Initialize(&reader));
+  ASSERT_EQ(2u, module_list.ModuleCount());
+
+  EXPECT_EQ(kModuleBase0, module_list.ModuleAt(0)->BaseOfImage);
+  base::string16 name;
+  ASSERT_TRUE(module_list.ModuleNameAt(0, &name));
+  EXPECT_EQ(base::UTF8ToUTF16(kModuleName0), name);
+  size_t codeview_record_size;
+  EXPECT_FALSE(module_list.CodeViewRecordAt(0, &codeview_record_size));
+
+  EXPECT_EQ(kModuleBase1, module_list.ModuleAt(1)->BaseOfImage);
+  ASSERT_TRUE(module_list.ModuleNameAt(1, &name));
+  EXPECT_EQ(base::UTF8ToUTF16(kModuleName1), name);
+  const MinidumpModuleCodeViewRecordPDB70* codeview_pdb70 =
+      static_cast<const MinidumpModuleCodeViewRecordPDB70*>(
+          module_list.CodeViewRecordAt(1, &codeview_record_size));
+  ASSERT_TRUE(codeview_pdb70);
+  EXPECT_EQ(module_list.ModuleAt(1)->CvRecord.DataSize, codeview_record_size);
+  EXPECT_EQ(MinidumpModuleCodeViewRecordPDB70::kSignature,
+            codeview_pdb70->signature);
+  EXPECT_EQ(pdb_uuid, codeview_pdb70->uuid);
+  EXPECT_EQ(3u, codeview_pdb70->age);
+}
+
+TEST(MinidumpModuleListView, Malformed) {
+  MinidumpFileWriter minidump_file;
+  MinidumpModuleListWriter module_list_writer;
+  MinidumpModuleWriter module_writer;
+  module_writer.SetName("module");
+  module_list_writer.AddModule(&module_writer);
+  minidump_file.AddStream(&module_list_writer);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  std::string contents(file_writer.string());
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(contents.data(), contents.size()));
+  const MINIDUMP_DIRECTORY* directory =
+      reader.FindStream(kMinidumpStreamTypeModuleList);
+  ASSERT_TRUE(directory);
+
+  // Claim more modules than the stream has room for.
+  MINIDUMP_MODULE_LIST* module_list_raw =
+      reinterpret_cast<MINIDUMP_MODULE_LIST*>(
+          &contents[directory->Location.Rva]);
+  module_list_raw->NumberOfModules = 2;
+  MinidumpModuleListView module_list;
+  EXPECT_FALSE(module_list.Initialize(&reader));
+
+  // Point a module’s name outside of the file.
+  module_list_raw->NumberOfModules = 1;
+  module_list_raw->Modules[0].ModuleNameRva = contents.size();
+  MinidumpModuleListView module_list_2;
+  ASSERT_TRUE(module_list_2.Initialize(&reader));
+  base::string16 name;
+  EXPECT_FALSE(module_list_2.ModuleNameAt(0, &name));
+}
+
+TEST(MinidumpMemoryListView, RoundTrip) {
+  MinidumpFileWriter minidump_file;
+  MinidumpMemoryListWriter memory_list_writer;
+  TestMinidumpMemoryWriter memory_writer_0(0x1000, 0x100, 'a');
+  memory_list_writer.AddMemory(&memory_writer_0);
+  TestMinidumpMemoryWriter memory_writer_1(0x8000, 0x20, 'b');
+  memory_list_writer.AddMemory(&memory_writer_1);
+  minidump_file.AddStream(&memory_list_writer);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(file_writer.string().data(),
+                                          file_writer.string().size()));
+  MinidumpMemoryListView memory_list;
+  ASSERT_TRUE(memory_list.Initialize(&reader));
+  ASSERT_EQ(2u, memory_list.MemoryRangeCount());
+
+  EXPECT_EQ(0x1000u, memory_list.DescriptorAt(0)->StartOfMemoryRange);
+  EXPECT_EQ(0x100u, memory_list.DescriptorAt(0)->Memory.DataSize);
+  const char* memory = static_cast<const char*>(memory_list.MemoryAt(0));
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(std::string(0x100, 'a'), std::string(memory, 0x100));
+
+  EXPECT_EQ(0x8000u, memory_list.DescriptorAt(1)->StartOfMemoryRange);
+  memory = static_cast<const char*>(memory_list.MemoryAt(1));
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(std::string(0x20, 'b'), std::string(memory, 0x20));
+
+  memory = static_cast<const char*>(memory_list.FindMemory(0x1010, 0x10));
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(static_cast<const char*>(memory_list.MemoryAt(0)) + 0x10, memory);
+  EXPECT_EQ(memory_list.MemoryAt(1), memory_list.FindMemory(0x8000, 0x20));
+  EXPECT_FALSE(memory_list.FindMemory(0x8000, 0x21));
+  EXPECT_FALSE(memory_list.FindMemory(0xfff, 2));
+  EXPECT_FALSE(memory_list.FindMemory(0x2000, 1));
+  EXPECT_FALSE(memory_list.FindMemory(0xffffffffffffffff, 2));
+}
+
+// A stream that writes a MinidumpCrashpadInfo structure along with its simple
+// annotations dictionary and the dictionary’s strings.
+class TestCrashpadInfoStream final : public internal::MinidumpStreamWriter {
+ public:
+  explicit TestCrashpadInfoStream(
+      const std::map<std::string, std::string>& simple_annotations)
+      : simple_annotations_(simple_annotations), data_() {}
+
+  ~TestCrashpadInfoStream() {}
+
+  // MinidumpStreamWriter:
+  virtual MinidumpStreamType StreamType() const override {
+    return kMinidumpStreamTypeCrashpadInfo;
+  }
+
+ protected:
+  // MinidumpWritable:
+  virtual size_t SizeOfObject() override { return BuildData(0).size(); }
+
+  virtual bool WillWriteAtOffsetImpl(off_t offset) override {
+    data_ = BuildData(offset);
+    return MinidumpStreamWriter::WillWriteAtOffsetImpl(offset);
+  }
+
+  virtual bool WriteObject(FileWriterInterface* file_writer) override {
+    return file_writer->Write(&data_[0], data_.size());
+  }
+
+ private:
+  std::string BuildData(off_t offset) {
+    MinidumpCrashpadInfo crashpad_info = {};
+    crashpad_info.size = sizeof(crashpad_info);
+    crashpad_info.version = 1;
+
+    uint32_t count = simple_annotations_.size();
+    std::string dictionary(reinterpret_cast<const char*>(&count),
+                           sizeof(count));
+    std::string strings;
+    RVA strings_rva = offset + sizeof(crashpad_info) + sizeof(count) +
+                      count * sizeof(MinidumpSimpleStringDictionaryEntry);
+    for (const auto& it : simple_annotations_) {
+      MinidumpSimpleStringDictionaryEntry entry;
+      entry.key = strings_rva + strings.size();
+      AppendUTF8String(it.first, &strings);
+      entry.value = strings_rva + strings.size();
+      AppendUTF8String(it.second, &strings);
+      dictionary.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+
+    crashpad_info.simple_annotations.DataSize = dictionary.size();
+    crashpad_info.simple_annotations.Rva = offset + sizeof(crashpad_info);
+
+    return std::string(reinterpret_cast<const char*>(&crashpad_info),
+                       sizeof(crashpad_info)) +
+           dictionary + strings;
+  }
+
+  static void AppendUTF8String(const std::string& string, std::string* data) {
+    uint32_t length = string.size();
+    data->append(reinterpret_cast<const char*>(&length), sizeof(length));
+    data->append(string);
+    data->append(1, '\0');
+    data->resize((data->size() + 3) & ~3);
+  }
+
+  std::map<std::string, std::string> simple_annotations_;
+  std::string data_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestCrashpadInfoStream);
+};
+
+TEST(MinidumpCrashpadInfoView, RoundTrip) {
+  std::map<std::string, std::string> simple_annotations;
+  simple_annotations["prod"] = "crashpad";
+  simple_annotations["ver"] = "1.0";
+  simple_annotations["empty"] = "";
+
+  MinidumpFileWriter minidump_file;
+  TestCrashpadInfoStream crashpad_info_stream(simple_annotations);
+  minidump_file.AddStream(&crashpad_info_stream);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(file_writer.string().data(),
+                                          file_writer.string().size()));
+  MinidumpCrashpadInfoView crashpad_info;
+  ASSERT_TRUE(crashpad_info.Initialize(&reader));
+  EXPECT_EQ(1u, crashpad_info.Version());
+
+  MinidumpSimpleStringDictionaryView dictionary;
+  ASSERT_TRUE(crashpad_info.SimpleAnnotations(&dictionary));
+  ASSERT_EQ(3u, dictionary.EntryCount());
+
+  // Entries are available without copying.
+  base::StringPiece key;
+  base::StringPiece value;
+  ASSERT_TRUE(dictionary.EntryAt(0, &key, &value));
+  EXPECT_EQ("empty", key.as_string());
+  EXPECT_EQ("", value.as_string());
+  EXPECT_GE(key.data(), file_writer.string().data());
+  EXPECT_LT(key.data(),
+            file_writer.string().data() + file_writer.string().size());
+
+  std::map<std::string, std::string> read_simple_annotations;
+  ASSERT_TRUE(dictionary.ToMap(&read_simple_annotations));
+  EXPECT_EQ(simple_annotations, read_simple_annotations);
+}
+
+TEST(MinidumpCrashpadInfoView, NoSimpleAnnotations) {
+  MinidumpFileWriter minidump_file;
+  TestCrashpadInfoStream crashpad_info_stream(
+      (std::map<std::string, std::string>()));
+  minidump_file.AddStream(&crashpad_info_stream);
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file.WriteEverything(&file_writer));
+
+  std::string contents(file_writer.string());
+  MinidumpFileReader reader;
+  ASSERT_TRUE(reader.InitializeFromBuffer(contents.data(), contents.size()));
+  const MINIDUMP_DIRECTORY* directory =
+      reader.FindStream(kMinidumpStreamTypeCrashpadInfo);
+  ASSERT_TRUE(directory);
+  MinidumpCrashpadInfo* crashpad_info_raw =
+      reinterpret_cast<MinidumpCrashpadInfo*>(
+          &contents[directory->Location.Rva]);
+
+  // An empty dictionary is present.
+  {
+    MinidumpCrashpadInfoView crashpad_info;
+    ASSERT_TRUE(crashpad_info.Initialize(&reader));
+    MinidumpSimpleStringDictionaryView dictionary;
+    ASSERT_TRUE(crashpad_info.SimpleAnnotations(&dictionary));
+    EXPECT_EQ(0u, dictionary.EntryCount());
+  }
+
+  // Version 0 structures don’t have a simple_annotations field.
+  crashpad_info_raw->version = 0;
+  {
+    MinidumpCrashpadInfoView crashpad_info;
+    ASSERT_TRUE(crashpad_info.Initialize(&reader));
+    MinidumpSimpleStringDictionaryView dictionary;
+    EXPECT_FALSE(crashpad_info.SimpleAnnotations(&dictionary));
+  }
+
+  // The structure can’t be larger than its stream.
+  crashpad_info_raw->version = 1;
+  crashpad_info_raw->size = directory->Location.DataSize + 1;
+  {
+    MinidumpCrashpadInfoView crashpad_info;
+    EXPECT_FALSE(crashpad_info.Initialize(&reader));
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -23,6 +23,9 @@ MinidumpStreamWriter::MinidumpStreamWriter()
     : MinidumpWritable(), directory_list_entry_() {
 }
 
+MinidumpStreamWriter::~MinidumpStreamWriter() {
+}
+
 bool MinidumpStreamWriter::Freeze() {
   DCHECK_EQ(state(), kStateMutable);
 
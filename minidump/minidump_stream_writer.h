@@ -32,6 +32,8 @@ namespace internal {
 //! MinidumpFileWriter object.
 class MinidumpStreamWriter : public MinidumpWritable {
  public:
+  virtual ~MinidumpStreamWriter();
+
   //! \brief Returns an object’s stream type.
   //!
   //! \note Valid in any state.
@@ -48,7 +50,6 @@ class MinidumpStreamWriter : public MinidumpWritable {
 
  protected:
   MinidumpStreamWriter();
-  ~MinidumpStreamWriter() {}
 
   // MinidumpWritable:
   virtual bool Freeze() override;
@@ -18,22 +18,115 @@
 
 #include "base/logging.h"
 #include "minidump/minidump_string_writer.h"
+#include "snapshot/system_snapshot.h"
 
 namespace crashpad {
 
 MinidumpSystemInfoWriter::MinidumpSystemInfoWriter()
-    : MinidumpStreamWriter(), system_info_(), csd_version_() {
+    : MinidumpStreamWriter(),
+      system_info_(),
+      csd_version_(NULL),
+      owned_csd_version_() {
   system_info_.ProcessorArchitecture = kMinidumpCPUArchitectureUnknown;
 }
 
 MinidumpSystemInfoWriter::~MinidumpSystemInfoWriter() {
 }
 
+void MinidumpSystemInfoWriter::InitializeFromSnapshot(
+    const SystemSnapshot* system_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(!csd_version_);
+
+  MinidumpCPUArchitecture cpu_architecture;
+  switch (system_snapshot->GetCPUArchitecture()) {
+    case kCPUArchitectureX86:
+      cpu_architecture = kMinidumpCPUArchitectureX86;
+      break;
+    case kCPUArchitectureX86_64:
+      cpu_architecture = kMinidumpCPUArchitectureAMD64;
+      break;
+    default:
+      NOTREACHED();
+      cpu_architecture = kMinidumpCPUArchitectureUnknown;
+      break;
+  }
+  SetCPUArchitecture(cpu_architecture);
+
+  uint32_t cpu_revision = system_snapshot->CPURevision();
+  uint16_t processor_revision = 0;
+  if (cpu_architecture == kMinidumpCPUArchitectureX86 ||
+      cpu_architecture == kMinidumpCPUArchitectureAMD64) {
+    // For x86-family CPUs, ProcessorLevel is the CPU family, and
+    // ProcessorRevision carries the model in the high byte and the stepping in
+    // the low byte. The extended model ID is only meaningful for families 6
+    // and 15.
+    uint32_t signature = system_snapshot->CPUX86Signature();
+    uint16_t model = (signature >> 4) & 0xf;
+    if (cpu_revision == 6 || cpu_revision == 15) {
+      model |= ((signature >> 16) & 0xf) << 4;
+    }
+    uint16_t stepping = signature & 0xf;
+    processor_revision = (model << 8) | stepping;
+  }
+  SetCPULevelAndRevision(cpu_revision, processor_revision);
+  SetCPUCount(system_snapshot->CPUCount());
+
+  switch (cpu_architecture) {
+    case kMinidumpCPUArchitectureX86: {
+      std::string cpu_vendor = system_snapshot->CPUVendor();
+      SetCPUX86VendorString(cpu_vendor);
+
+      // The minidump file format only has room for the bottom 32 bits of CPU
+      // features and extended CPU features.
+      SetCPUX86VersionAndFeatures(
+          system_snapshot->CPUX86Signature(),
+          system_snapshot->CPUX86Features() & 0xffffffff);
+
+      if (cpu_vendor == "AuthenticAMD") {
+        SetCPUX86AMDExtendedFeatures(
+            system_snapshot->CPUX86ExtendedFeatures() & 0xffffffff);
+      }
+      break;
+    }
+
+    case kMinidumpCPUArchitectureAMD64:
+      SetCPUOtherFeatures(system_snapshot->CPUX86Features(),
+                          system_snapshot->CPUX86ExtendedFeatures());
+      break;
+
+    default:
+      break;
+  }
+
+  switch (system_snapshot->GetOperatingSystem()) {
+    case SystemSnapshot::kOperatingSystemMacOSX:
+      SetOS(kMinidumpOSMacOSX);
+      break;
+    default:
+      NOTREACHED();
+      SetOS(kMinidumpOSUnknown);
+      break;
+  }
+
+  SetOSType(system_snapshot->OSServer() ? kMinidumpOSTypeServer
+                                        : kMinidumpOSTypeWorkstation);
+
+  int major;
+  int minor;
+  int bugfix;
+  std::string build;
+  system_snapshot->OSVersion(&major, &minor, &bugfix, &build);
+  SetOSVersion(major, minor, bugfix);
+  SetCSDVersion(build);
+}
+
 void MinidumpSystemInfoWriter::SetCSDVersion(const std::string& csd_version) {
   DCHECK_EQ(state(), kStateMutable);
 
   if (!csd_version_) {
-    csd_version_.reset(new internal::MinidumpUTF16StringWriter());
+    csd_version_ =
+        NewOwned<internal::MinidumpUTF16StringWriter>(&owned_csd_version_);
   }
 
   csd_version_->SetUTF8(csd_version);
@@ -131,12 +224,18 @@ size_t MinidumpSystemInfoWriter::SizeOfObject() {
   return sizeof(system_info_);
 }
 
-std::vector<internal::MinidumpWritable*> MinidumpSystemInfoWriter::Children() {
+size_t MinidumpSystemInfoWriter::ChildCount() {
   DCHECK_GE(state(), kStateFrozen);
   DCHECK(csd_version_);
 
-  std::vector<MinidumpWritable*> children(1, csd_version_.get());
-  return children;
+  return 1;
+}
+
+internal::MinidumpWritable* MinidumpSystemInfoWriter::ChildAt(size_t index) {
+  DCHECK_GE(state(), kStateFrozen);
+  DCHECK_EQ(index, 0u);
+
+  return csd_version_;
 }
 
 bool MinidumpSystemInfoWriter::WriteObject(FileWriterInterface* file_writer) {
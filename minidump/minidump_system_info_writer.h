@@ -31,6 +31,8 @@
 
 namespace crashpad {
 
+class SystemSnapshot;
+
 namespace internal {
 class MinidumpUTF16StringWriter;
 }  // namespace internal
@@ -41,6 +43,15 @@ class MinidumpSystemInfoWriter final : public internal::MinidumpStreamWriter {
   MinidumpSystemInfoWriter();
   ~MinidumpSystemInfoWriter();
 
+  //! \brief Initializes MINIDUMP_SYSTEM_INFO based on \a system_snapshot.
+  //!
+  //! \param[in] system_snapshot The system snapshot to use as source data.
+  //!
+  //! \note Valid in #kStateMutable. No mutator methods may be called before
+  //!     this method, and it is not normally necessary to call any mutator
+  //!     methods after this method.
+  void InitializeFromSnapshot(const SystemSnapshot* system_snapshot);
+
   //! \brief Sets MINIDUMP_SYSTEM_INFO::ProcessorArchitecture.
   void SetCPUArchitecture(MinidumpCPUArchitecture processor_architecture) {
     system_info_.ProcessorArchitecture = processor_architecture;
@@ -168,7 +179,8 @@ class MinidumpSystemInfoWriter final : public internal::MinidumpStreamWriter {
   // MinidumpWritable:
   virtual bool Freeze() override;
   virtual size_t SizeOfObject() override;
-  virtual std::vector<MinidumpWritable*> Children() override;
+  virtual size_t ChildCount() override;
+  virtual MinidumpWritable* ChildAt(size_t index) override;
   virtual bool WriteObject(FileWriterInterface* file_writer) override;
 
   // MinidumpStreamWriter:
@@ -176,7 +188,11 @@ class MinidumpSystemInfoWriter final : public internal::MinidumpStreamWriter {
 
  private:
   MINIDUMP_SYSTEM_INFO system_info_;
-  scoped_ptr<internal::MinidumpUTF16StringWriter> csd_version_;
+
+  // Owned by arena() if it was set when the CSD version was set, otherwise by
+  // owned_csd_version_.
+  internal::MinidumpUTF16StringWriter* csd_version_;
+  scoped_ptr<internal::MinidumpUTF16StringWriter> owned_csd_version_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpSystemInfoWriter);
 };
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "minidump/minidump_file_writer.h"
 #include "minidump/minidump_test_util.h"
+#include "snapshot/test/test_system_snapshot.h"
 #include "util/file/string_file_writer.h"
 
 namespace crashpad {
@@ -283,6 +284,146 @@ TEST(MinidumpSystemInfoWriter, X86_CPUVendorFromRegisters) {
   EXPECT_EQ(0u, system_info->Cpu.X86CpuInfo.VersionInformation);
 }
 
+TEST(MinidumpSystemInfoWriter, InitializeFromSnapshot_X86) {
+  MINIDUMP_SYSTEM_INFO expect_system_info = {};
+
+  const char kCPUVendor[] = "AuthenticAMD";
+  const char kOSVersionBuild[] = "13F34";
+
+  TestSystemSnapshot system_snapshot;
+  system_snapshot.SetCPUArchitecture(kCPUArchitectureX86);
+
+  // Family 15 (0xf + extended family 0), extended model 0x2, model 0x8,
+  // stepping 0x2.
+  expect_system_info.ProcessorLevel = 0xf;
+  expect_system_info.ProcessorRevision = 0x2802;
+  system_snapshot.SetCPURevision(expect_system_info.ProcessorLevel);
+  expect_system_info.Cpu.X86CpuInfo.VersionInformation = 0x00020f82;
+  system_snapshot.SetCPUX86Signature(
+      expect_system_info.Cpu.X86CpuInfo.VersionInformation);
+
+  expect_system_info.NumberOfProcessors = 3;
+  system_snapshot.SetCPUCount(expect_system_info.NumberOfProcessors);
+
+  memcpy(expect_system_info.Cpu.X86CpuInfo.VendorId,
+         kCPUVendor,
+         sizeof(expect_system_info.Cpu.X86CpuInfo.VendorId));
+  system_snapshot.SetCPUVendor(kCPUVendor);
+
+  expect_system_info.Cpu.X86CpuInfo.FeatureInformation = 0xfedcba98;
+  system_snapshot.SetCPUX86Features(0x0123456700000000 |
+      expect_system_info.Cpu.X86CpuInfo.FeatureInformation);
+  expect_system_info.Cpu.X86CpuInfo.AMDExtendedCpuFeatures = 0x76543210;
+  system_snapshot.SetCPUX86ExtendedFeatures(0x89abcdef00000000 |
+      expect_system_info.Cpu.X86CpuInfo.AMDExtendedCpuFeatures);
+
+  expect_system_info.PlatformId = kMinidumpOSMacOSX;
+  system_snapshot.SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+
+  expect_system_info.ProductType = kMinidumpOSTypeServer;
+  system_snapshot.SetOSServer(true);
+
+  expect_system_info.MajorVersion = 10;
+  expect_system_info.MinorVersion = 9;
+  expect_system_info.BuildNumber = 5;
+  system_snapshot.SetOSVersion(expect_system_info.MajorVersion,
+                               expect_system_info.MinorVersion,
+                               expect_system_info.BuildNumber,
+                               kOSVersionBuild);
+
+  MinidumpSystemInfoWriter system_info_writer;
+  system_info_writer.InitializeFromSnapshot(&system_snapshot);
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.AddStream(&system_info_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_SYSTEM_INFO* system_info;
+  const MINIDUMP_STRING* csd_version;
+  GetSystemInfoStream(file_writer.string(),
+                      strlen(kOSVersionBuild),
+                      &system_info,
+                      &csd_version);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  EXPECT_EQ(kMinidumpCPUArchitectureX86, system_info->ProcessorArchitecture);
+  EXPECT_EQ(expect_system_info.ProcessorLevel, system_info->ProcessorLevel);
+  EXPECT_EQ(expect_system_info.ProcessorRevision,
+            system_info->ProcessorRevision);
+  EXPECT_EQ(expect_system_info.NumberOfProcessors,
+            system_info->NumberOfProcessors);
+  EXPECT_EQ(expect_system_info.ProductType, system_info->ProductType);
+  EXPECT_EQ(expect_system_info.MajorVersion, system_info->MajorVersion);
+  EXPECT_EQ(expect_system_info.MinorVersion, system_info->MinorVersion);
+  EXPECT_EQ(expect_system_info.BuildNumber, system_info->BuildNumber);
+  EXPECT_EQ(expect_system_info.PlatformId, system_info->PlatformId);
+  EXPECT_EQ(expect_system_info.Cpu.X86CpuInfo.VendorId[0],
+            system_info->Cpu.X86CpuInfo.VendorId[0]);
+  EXPECT_EQ(expect_system_info.Cpu.X86CpuInfo.VendorId[1],
+            system_info->Cpu.X86CpuInfo.VendorId[1]);
+  EXPECT_EQ(expect_system_info.Cpu.X86CpuInfo.VendorId[2],
+            system_info->Cpu.X86CpuInfo.VendorId[2]);
+  EXPECT_EQ(expect_system_info.Cpu.X86CpuInfo.VersionInformation,
+            system_info->Cpu.X86CpuInfo.VersionInformation);
+  EXPECT_EQ(expect_system_info.Cpu.X86CpuInfo.FeatureInformation,
+            system_info->Cpu.X86CpuInfo.FeatureInformation);
+  EXPECT_EQ(expect_system_info.Cpu.X86CpuInfo.AMDExtendedCpuFeatures,
+            system_info->Cpu.X86CpuInfo.AMDExtendedCpuFeatures);
+
+  for (size_t index = 0; index < strlen(kOSVersionBuild); ++index) {
+    EXPECT_EQ(kOSVersionBuild[index], csd_version->Buffer[index]) << index;
+  }
+}
+
+TEST(MinidumpSystemInfoWriter, InitializeFromSnapshot_AMD64) {
+  const uint64_t kCPUFeatures[2] = {0xbfebfbff0fffb3ff, 0x2c10080000000001};
+
+  TestSystemSnapshot system_snapshot;
+  system_snapshot.SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot.SetCPURevision(6);
+  system_snapshot.SetCPUX86Signature(0x000306a9);
+  system_snapshot.SetCPUCount(8);
+  system_snapshot.SetCPUVendor("GenuineIntel");
+  system_snapshot.SetCPUX86Features(kCPUFeatures[0]);
+  system_snapshot.SetCPUX86ExtendedFeatures(kCPUFeatures[1]);
+  system_snapshot.SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+  system_snapshot.SetOSVersion(10, 9, 4, std::string());
+
+  MinidumpSystemInfoWriter system_info_writer;
+  system_info_writer.InitializeFromSnapshot(&system_snapshot);
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.AddStream(&system_info_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_SYSTEM_INFO* system_info;
+  const MINIDUMP_STRING* csd_version;
+  GetSystemInfoStream(file_writer.string(), 0, &system_info, &csd_version);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  EXPECT_EQ(kMinidumpCPUArchitectureAMD64, system_info->ProcessorArchitecture);
+  EXPECT_EQ(6u, system_info->ProcessorLevel);
+  EXPECT_EQ(0x3a09u, system_info->ProcessorRevision);
+  EXPECT_EQ(8u, system_info->NumberOfProcessors);
+  EXPECT_EQ(kMinidumpOSTypeWorkstation, system_info->ProductType);
+  EXPECT_EQ(10u, system_info->MajorVersion);
+  EXPECT_EQ(9u, system_info->MinorVersion);
+  EXPECT_EQ(4u, system_info->BuildNumber);
+  EXPECT_EQ(kMinidumpOSMacOSX, system_info->PlatformId);
+  EXPECT_EQ(kCPUFeatures[0],
+            system_info->Cpu.OtherCpuInfo.ProcessorFeatures[0]);
+  EXPECT_EQ(kCPUFeatures[1],
+            system_info->Cpu.OtherCpuInfo.ProcessorFeatures[1]);
+}
+
 TEST(MinidumpSystemInfoWriterDeathTest, NoCSDVersion) {
   MinidumpFileWriter minidump_file_writer;
   MinidumpSystemInfoWriter system_info_writer;
@@ -0,0 +1,60 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_thread_id_map.h"
+
+#include <set>
+
+#include "base/logging.h"
+#include "snapshot/thread_snapshot.h"
+
+namespace crashpad {
+
+void BuildMinidumpThreadIDMap(
+    const std::vector<const ThreadSnapshot*>& thread_snapshots,
+    MinidumpThreadIDMap* thread_id_map) {
+  DCHECK(thread_id_map->empty());
+
+  // First, try truncating each 64-bit thread ID to 32 bits. If that’s possible
+  // for each unique 64-bit thread ID, then this will be used as the mapping.
+  // This preserves as much of the original thread ID as possible, for
+  // consistency with other systems.
+  std::set<uint32_t> thread_ids_32;
+  for (const ThreadSnapshot* thread_snapshot : thread_snapshots) {
+    uint64_t thread_id_64 = thread_snapshot->ThreadID();
+    if (thread_id_map->find(thread_id_64) == thread_id_map->end()) {
+      uint32_t thread_id_32 = static_cast<uint32_t>(thread_id_64);
+      if (!thread_ids_32.insert(thread_id_32).second) {
+        // The truncated 32-bit thread ID collides with another. Fall back to
+        // assigning thread IDs sequentially.
+        thread_id_map->clear();
+        break;
+      }
+      thread_id_map->insert(std::make_pair(thread_id_64, thread_id_32));
+    }
+  }
+
+  if (thread_id_map->empty() && !thread_snapshots.empty()) {
+    uint32_t next_thread_id_32 = 0;
+    for (const ThreadSnapshot* thread_snapshot : thread_snapshots) {
+      uint64_t thread_id_64 = thread_snapshot->ThreadID();
+      if (thread_id_map->find(thread_id_64) == thread_id_map->end()) {
+        thread_id_map->insert(
+            std::make_pair(thread_id_64, next_thread_id_32++));
+      }
+    }
+  }
+}
+
+}  // namespace crashpad
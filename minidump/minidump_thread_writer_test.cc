@@ -0,0 +1,484 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_thread_writer.h"
+
+#include <dbghelp.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_context_test_util.h"
+#include "minidump/minidump_context_writer.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/minidump_memory_writer_test_util.h"
+#include "minidump/minidump_test_util.h"
+#include "minidump/minidump_thread_id_map.h"
+#include "snapshot/test/test_cpu_context.h"
+#include "snapshot/test/test_memory_snapshot.h"
+#include "snapshot/test/test_thread_snapshot.h"
+#include "util/file/string_file_writer.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// This returns the MINIDUMP_THREAD_LIST stream in |thread_list|. If
+// |memory_list| is non-NULL, a MINIDUMP_MEMORY_LIST stream is also expected in
+// |file_contents|, and that stream will be returned in |memory_list|.
+void GetThreadListStream(const std::string& file_contents,
+                         const MINIDUMP_THREAD_LIST** thread_list,
+                         const MINIDUMP_MEMORY_LIST** memory_list) {
+  const size_t kDirectoryOffset = sizeof(MINIDUMP_HEADER);
+  const uint32_t kExpectedStreams = memory_list ? 2 : 1;
+  const size_t kThreadListStreamOffset =
+      kDirectoryOffset + kExpectedStreams * sizeof(MINIDUMP_DIRECTORY);
+  const size_t kThreadsOffset =
+      kThreadListStreamOffset + sizeof(MINIDUMP_THREAD_LIST);
+
+  ASSERT_GE(file_contents.size(), kThreadsOffset);
+
+  const MINIDUMP_HEADER* header =
+      reinterpret_cast<const MINIDUMP_HEADER*>(&file_contents[0]);
+
+  VerifyMinidumpHeader(header, kExpectedStreams, 0);
+  if (testing::Test::HasFatalFailure()) {
+    return;
+  }
+
+  const MINIDUMP_DIRECTORY* directory =
+      reinterpret_cast<const MINIDUMP_DIRECTORY*>(
+          &file_contents[kDirectoryOffset]);
+
+  ASSERT_EQ(kMinidumpStreamTypeThreadList, directory[0].StreamType);
+  ASSERT_GE(directory[0].Location.DataSize, sizeof(MINIDUMP_THREAD_LIST));
+  ASSERT_EQ(kThreadListStreamOffset, directory[0].Location.Rva);
+
+  *thread_list = reinterpret_cast<const MINIDUMP_THREAD_LIST*>(
+      &file_contents[kThreadListStreamOffset]);
+
+  ASSERT_EQ(sizeof(MINIDUMP_THREAD_LIST) +
+                (*thread_list)->NumberOfThreads * sizeof(MINIDUMP_THREAD),
+            directory[0].Location.DataSize);
+
+  if (memory_list) {
+    ASSERT_EQ(kMinidumpStreamTypeMemoryList, directory[1].StreamType);
+    ASSERT_GE(directory[1].Location.DataSize, sizeof(MINIDUMP_MEMORY_LIST));
+    ASSERT_LE(directory[1].Location.Rva + directory[1].Location.DataSize,
+              file_contents.size());
+
+    *memory_list = reinterpret_cast<const MINIDUMP_MEMORY_LIST*>(
+        &file_contents[directory[1].Location.Rva]);
+
+    ASSERT_EQ(sizeof(MINIDUMP_MEMORY_LIST) +
+                  (*memory_list)->NumberOfMemoryRanges *
+                      sizeof(MINIDUMP_MEMORY_DESCRIPTOR),
+              directory[1].Location.DataSize);
+  }
+}
+
+// Returns the AMD64 context that |thread| points to.
+const MinidumpContextAMD64* GetAMD64Context(const std::string& file_contents,
+                                            const MINIDUMP_THREAD* thread) {
+  EXPECT_EQ(sizeof(MinidumpContextAMD64), thread->ThreadContext.DataSize);
+  EXPECT_EQ(0u, thread->ThreadContext.Rva % 16);
+  if (thread->ThreadContext.Rva + sizeof(MinidumpContextAMD64) >
+      file_contents.size()) {
+    ADD_FAILURE() << "context out of range";
+    return NULL;
+  }
+
+  return reinterpret_cast<const MinidumpContextAMD64*>(
+      &file_contents[thread->ThreadContext.Rva]);
+}
+
+TEST(MinidumpThreadWriter, EmptyThreadList) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpThreadListWriter thread_list_writer;
+
+  minidump_file_writer.AddStream(&thread_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  ASSERT_EQ(sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+                sizeof(MINIDUMP_THREAD_LIST),
+            file_writer.string().size());
+
+  const MINIDUMP_THREAD_LIST* thread_list;
+  GetThreadListStream(file_writer.string(), &thread_list, NULL);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  EXPECT_EQ(0u, thread_list->NumberOfThreads);
+}
+
+TEST(MinidumpThreadWriter, OneThread_AMD64_NoStack) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpThreadListWriter thread_list_writer;
+
+  const uint32_t kThreadID = 0x11111111;
+  const uint32_t kSuspendCount = 1;
+  const uint32_t kPriorityClass = 0x20;
+  const uint32_t kPriority = 10;
+  const uint64_t kTEB = 0x55555555;
+  const uint32_t kSeed = 123;
+
+  MinidumpThreadWriter thread_writer;
+  thread_writer.SetThreadID(kThreadID);
+  thread_writer.SetSuspendCount(kSuspendCount);
+  thread_writer.SetPriorityClass(kPriorityClass);
+  thread_writer.SetPriority(kPriority);
+  thread_writer.SetTEB(kTEB);
+
+  MinidumpContextAMD64Writer context_amd64_writer;
+  InitializeMinidumpContextAMD64(context_amd64_writer.context(), kSeed);
+  thread_writer.SetContext(&context_amd64_writer);
+
+  thread_list_writer.AddThread(&thread_writer);
+  minidump_file_writer.AddStream(&thread_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  ASSERT_EQ(sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+                sizeof(MINIDUMP_THREAD_LIST) + 1 * sizeof(MINIDUMP_THREAD) +
+                1 * sizeof(MinidumpContextAMD64),
+            file_writer.string().size());
+
+  const MINIDUMP_THREAD_LIST* thread_list;
+  GetThreadListStream(file_writer.string(), &thread_list, NULL);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(1u, thread_list->NumberOfThreads);
+
+  const MINIDUMP_THREAD* thread = &thread_list->Threads[0];
+  EXPECT_EQ(kThreadID, thread->ThreadId);
+  EXPECT_EQ(kSuspendCount, thread->SuspendCount);
+  EXPECT_EQ(kPriorityClass, thread->PriorityClass);
+  EXPECT_EQ(kPriority, thread->Priority);
+  EXPECT_EQ(kTEB, thread->Teb);
+  EXPECT_EQ(0u, thread->Stack.StartOfMemoryRange);
+  EXPECT_EQ(0u, thread->Stack.Memory.DataSize);
+  EXPECT_EQ(0u, thread->Stack.Memory.Rva);
+
+  const MinidumpContextAMD64* observed_context =
+      GetAMD64Context(file_writer.string(), thread);
+  ASSERT_TRUE(observed_context);
+  ExpectMinidumpContextAMD64(kSeed, observed_context);
+}
+
+TEST(MinidumpThreadWriter, ThreeThreads_AMD64_MemoryList) {
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpThreadListWriter thread_list_writer;
+  MinidumpMemoryListWriter memory_list_writer;
+  thread_list_writer.SetMemoryListWriter(&memory_list_writer);
+
+  const uint32_t kThreadID0 = 1111111;
+  const uint64_t kMemoryBase0 = 0x1000;
+  const size_t kMemorySize0 = 0x100;
+  const uint8_t kMemoryValue0 = '0';
+  const uint32_t kContextSeed0 = 1;
+
+  const uint32_t kThreadID1 = 2222222;
+  const uint32_t kContextSeed1 = 2;
+
+  const uint32_t kThreadID2 = 3333333;
+  const uint64_t kMemoryBase2 = 0x30000;
+  const size_t kMemorySize2 = 0x300;
+  const uint8_t kMemoryValue2 = '2';
+  const uint32_t kContextSeed2 = 3;
+
+  MinidumpThreadWriter thread_writer_0;
+  thread_writer_0.SetThreadID(kThreadID0);
+  TestMinidumpMemoryWriter memory_writer_0(
+      kMemoryBase0, kMemorySize0, kMemoryValue0);
+  thread_writer_0.SetStack(&memory_writer_0);
+  MinidumpContextAMD64Writer context_amd64_writer_0;
+  InitializeMinidumpContextAMD64(context_amd64_writer_0.context(),
+                                 kContextSeed0);
+  thread_writer_0.SetContext(&context_amd64_writer_0);
+  thread_list_writer.AddThread(&thread_writer_0);
+
+  // This thread has no stack.
+  MinidumpThreadWriter thread_writer_1;
+  thread_writer_1.SetThreadID(kThreadID1);
+  MinidumpContextAMD64Writer context_amd64_writer_1;
+  InitializeMinidumpContextAMD64(context_amd64_writer_1.context(),
+                                 kContextSeed1);
+  thread_writer_1.SetContext(&context_amd64_writer_1);
+  thread_list_writer.AddThread(&thread_writer_1);
+
+  MinidumpThreadWriter thread_writer_2;
+  thread_writer_2.SetThreadID(kThreadID2);
+  TestMinidumpMemoryWriter memory_writer_2(
+      kMemoryBase2, kMemorySize2, kMemoryValue2);
+  thread_writer_2.SetStack(&memory_writer_2);
+  MinidumpContextAMD64Writer context_amd64_writer_2;
+  InitializeMinidumpContextAMD64(context_amd64_writer_2.context(),
+                                 kContextSeed2);
+  thread_writer_2.SetContext(&context_amd64_writer_2);
+  thread_list_writer.AddThread(&thread_writer_2);
+
+  minidump_file_writer.AddStream(&thread_list_writer);
+  minidump_file_writer.AddStream(&memory_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  const MINIDUMP_THREAD_LIST* thread_list;
+  const MINIDUMP_MEMORY_LIST* memory_list;
+  GetThreadListStream(file_writer.string(), &thread_list, &memory_list);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(3u, thread_list->NumberOfThreads);
+  ASSERT_EQ(2u, memory_list->NumberOfMemoryRanges);
+
+  {
+    SCOPED_TRACE("thread 0");
+
+    const MINIDUMP_THREAD* thread = &thread_list->Threads[0];
+    EXPECT_EQ(kThreadID0, thread->ThreadId);
+
+    MINIDUMP_MEMORY_DESCRIPTOR expected;
+    expected.StartOfMemoryRange = kMemoryBase0;
+    expected.Memory.DataSize = kMemorySize0;
+    expected.Memory.Rva = thread->Stack.Memory.Rva;
+    ExpectMinidumpMemoryDescriptorAndContents(
+        &expected, &thread->Stack, file_writer.string(), kMemoryValue0, false);
+
+    // The memory list refers to the same copy of the stack.
+    EXPECT_EQ(thread->Stack.StartOfMemoryRange,
+              memory_list->MemoryRanges[0].StartOfMemoryRange);
+    EXPECT_EQ(thread->Stack.Memory.DataSize,
+              memory_list->MemoryRanges[0].Memory.DataSize);
+    EXPECT_EQ(thread->Stack.Memory.Rva,
+              memory_list->MemoryRanges[0].Memory.Rva);
+
+    const MinidumpContextAMD64* observed_context =
+        GetAMD64Context(file_writer.string(), thread);
+    ASSERT_TRUE(observed_context);
+    ExpectMinidumpContextAMD64(kContextSeed0, observed_context);
+  }
+
+  {
+    SCOPED_TRACE("thread 1");
+
+    const MINIDUMP_THREAD* thread = &thread_list->Threads[1];
+    EXPECT_EQ(kThreadID1, thread->ThreadId);
+    EXPECT_EQ(0u, thread->Stack.StartOfMemoryRange);
+    EXPECT_EQ(0u, thread->Stack.Memory.DataSize);
+    EXPECT_EQ(0u, thread->Stack.Memory.Rva);
+
+    const MinidumpContextAMD64* observed_context =
+        GetAMD64Context(file_writer.string(), thread);
+    ASSERT_TRUE(observed_context);
+    ExpectMinidumpContextAMD64(kContextSeed1, observed_context);
+  }
+
+  {
+    SCOPED_TRACE("thread 2");
+
+    const MINIDUMP_THREAD* thread = &thread_list->Threads[2];
+    EXPECT_EQ(kThreadID2, thread->ThreadId);
+
+    MINIDUMP_MEMORY_DESCRIPTOR expected;
+    expected.StartOfMemoryRange = kMemoryBase2;
+    expected.Memory.DataSize = kMemorySize2;
+    expected.Memory.Rva = thread->Stack.Memory.Rva;
+    ExpectMinidumpMemoryDescriptorAndContents(
+        &expected, &thread->Stack, file_writer.string(), kMemoryValue2, false);
+
+    EXPECT_EQ(thread->Stack.StartOfMemoryRange,
+              memory_list->MemoryRanges[1].StartOfMemoryRange);
+    EXPECT_EQ(thread->Stack.Memory.DataSize,
+              memory_list->MemoryRanges[1].Memory.DataSize);
+    EXPECT_EQ(thread->Stack.Memory.Rva,
+              memory_list->MemoryRanges[1].Memory.Rva);
+
+    const MinidumpContextAMD64* observed_context =
+        GetAMD64Context(file_writer.string(), thread);
+    ASSERT_TRUE(observed_context);
+    ExpectMinidumpContextAMD64(kContextSeed2, observed_context);
+  }
+}
+
+TEST(MinidumpThreadWriter, InitializeFromSnapshot) {
+  const size_t kThreads = 3;
+  const uint64_t kThreadIDs[kThreads] = {
+      0x0000000100000001, 0x0000000100000002, 0x0000000100000003};
+  const uint64_t kStackBases[kThreads] = {0x7ffe0000, 0, 0x7fff0000};
+  const size_t kStackSizes[kThreads] = {0x200, 0, 0x100};
+  const char kStackValues[kThreads] = {'a', 0, 'c'};
+
+  TestThreadSnapshot thread_snapshots[kThreads];
+  TestMemorySnapshot stack_snapshots[kThreads];
+  std::vector<const ThreadSnapshot*> thread_snapshot_pointers;
+  for (size_t index = 0; index < kThreads; ++index) {
+    TestThreadSnapshot* thread_snapshot = &thread_snapshots[index];
+    thread_snapshot->SetThreadID(kThreadIDs[index]);
+    thread_snapshot->SetSuspendCount(static_cast<int>(index));
+    thread_snapshot->SetPriority(static_cast<int>(index + 30));
+    thread_snapshot->SetThreadSpecificDataAddress(0x1000 * (index + 1));
+    InitializeCPUContextX86_64(thread_snapshot->MutableContext()->x86_64,
+                               static_cast<uint32_t>(index + 1));
+
+    if (kStackSizes[index]) {
+      TestMemorySnapshot* stack_snapshot = &stack_snapshots[index];
+      stack_snapshot->SetAddress(kStackBases[index]);
+      stack_snapshot->SetSize(kStackSizes[index]);
+      stack_snapshot->SetValue(kStackValues[index]);
+      thread_snapshot->SetStack(stack_snapshot);
+    }
+
+    thread_snapshot_pointers.push_back(thread_snapshot);
+  }
+
+  MinidumpFileWriter minidump_file_writer;
+  MinidumpThreadListWriter thread_list_writer;
+  MinidumpMemoryListWriter memory_list_writer;
+  thread_list_writer.SetMemoryListWriter(&memory_list_writer);
+
+  MinidumpThreadIDMap thread_id_map;
+  ASSERT_TRUE(thread_list_writer.InitializeFromSnapshot(
+      thread_snapshot_pointers, &thread_id_map));
+
+  // No stack memory is read until the minidump file is written.
+  for (size_t index = 0; index < kThreads; ++index) {
+    EXPECT_EQ(0, stack_snapshots[index].read_count());
+  }
+
+  minidump_file_writer.AddStream(&thread_list_writer);
+  minidump_file_writer.AddStream(&memory_list_writer);
+
+  StringFileWriter file_writer;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&file_writer));
+
+  // Each stack is read exactly once, although it appears in both the thread
+  // list and the memory list.
+  EXPECT_EQ(1, stack_snapshots[0].read_count());
+  EXPECT_EQ(0, stack_snapshots[1].read_count());
+  EXPECT_EQ(1, stack_snapshots[2].read_count());
+
+  const MINIDUMP_THREAD_LIST* thread_list;
+  const MINIDUMP_MEMORY_LIST* memory_list;
+  GetThreadListStream(file_writer.string(), &thread_list, &memory_list);
+  if (Test::HasFatalFailure()) {
+    return;
+  }
+
+  ASSERT_EQ(kThreads, thread_list->NumberOfThreads);
+  ASSERT_EQ(2u, memory_list->NumberOfMemoryRanges);
+
+  size_t memory_index = 0;
+  for (size_t index = 0; index < kThreads; ++index) {
+    SCOPED_TRACE(testing::Message() << "index " << index);
+
+    const MINIDUMP_THREAD* thread = &thread_list->Threads[index];
+
+    // The 64-bit thread IDs are unique when truncated to 32 bits.
+    EXPECT_EQ(static_cast<uint32_t>(kThreadIDs[index]), thread->ThreadId);
+    EXPECT_EQ(thread_id_map[kThreadIDs[index]], thread->ThreadId);
+    EXPECT_EQ(index, thread->SuspendCount);
+    EXPECT_EQ(index + 30, thread->Priority);
+    EXPECT_EQ(0x1000 * (index + 1), thread->Teb);
+
+    if (kStackSizes[index]) {
+      MINIDUMP_MEMORY_DESCRIPTOR expected;
+      expected.StartOfMemoryRange = kStackBases[index];
+      expected.Memory.DataSize = kStackSizes[index];
+      expected.Memory.Rva = thread->Stack.Memory.Rva;
+      ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                                &thread->Stack,
+                                                file_writer.string(),
+                                                kStackValues[index],
+                                                false);
+
+      const MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor =
+          &memory_list->MemoryRanges[memory_index++];
+      EXPECT_EQ(thread->Stack.StartOfMemoryRange,
+                memory_descriptor->StartOfMemoryRange);
+      EXPECT_EQ(thread->Stack.Memory.DataSize,
+                memory_descriptor->Memory.DataSize);
+      EXPECT_EQ(thread->Stack.Memory.Rva, memory_descriptor->Memory.Rva);
+    } else {
+      EXPECT_EQ(0u, thread->Stack.StartOfMemoryRange);
+      EXPECT_EQ(0u, thread->Stack.Memory.DataSize);
+      EXPECT_EQ(0u, thread->Stack.Memory.Rva);
+    }
+
+    const MinidumpContextAMD64* observed_context =
+        GetAMD64Context(file_writer.string(), thread);
+    ASSERT_TRUE(observed_context);
+    EXPECT_EQ(thread_snapshots[index].Context()->x86_64->rip,
+              observed_context->rip);
+    EXPECT_EQ(thread_snapshots[index].Context()->x86_64->rsp,
+              observed_context->rsp);
+  }
+}
+
+TEST(MinidumpThreadIDMap, Truncated) {
+  TestThreadSnapshot thread_snapshots[3];
+  thread_snapshots[0].SetThreadID(0xaaaaaaaa00000001);
+  thread_snapshots[1].SetThreadID(0xbbbbbbbb00000002);
+  thread_snapshots[2].SetThreadID(0xcccccccc00000003);
+
+  std::vector<const ThreadSnapshot*> thread_snapshot_pointers;
+  for (const TestThreadSnapshot& thread_snapshot : thread_snapshots) {
+    thread_snapshot_pointers.push_back(&thread_snapshot);
+  }
+
+  MinidumpThreadIDMap thread_id_map;
+  BuildMinidumpThreadIDMap(thread_snapshot_pointers, &thread_id_map);
+
+  ASSERT_EQ(3u, thread_id_map.size());
+  EXPECT_EQ(1u, thread_id_map[0xaaaaaaaa00000001]);
+  EXPECT_EQ(2u, thread_id_map[0xbbbbbbbb00000002]);
+  EXPECT_EQ(3u, thread_id_map[0xcccccccc00000003]);
+}
+
+TEST(MinidumpThreadIDMap, Collision) {
+  TestThreadSnapshot thread_snapshots[3];
+  thread_snapshots[0].SetThreadID(0x0000000100000005);
+  thread_snapshots[1].SetThreadID(0x0000000200000005);
+  thread_snapshots[2].SetThreadID(0x0000000300000007);
+
+  std::vector<const ThreadSnapshot*> thread_snapshot_pointers;
+  for (const TestThreadSnapshot& thread_snapshot : thread_snapshots) {
+    thread_snapshot_pointers.push_back(&thread_snapshot);
+  }
+
+  MinidumpThreadIDMap thread_id_map;
+  BuildMinidumpThreadIDMap(thread_snapshot_pointers, &thread_id_map);
+
+  // Truncation would make the first two thread IDs collide, so IDs are
+  // assigned sequentially instead.
+  ASSERT_EQ(3u, thread_id_map.size());
+  EXPECT_EQ(0u, thread_id_map[0x0000000100000005]);
+  EXPECT_EQ(1u, thread_id_map[0x0000000200000005]);
+  EXPECT_EQ(2u, thread_id_map[0x0000000300000007]);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,47 +14,181 @@
 
 #include "minidump/minidump_writable.h"
 
+#include <limits.h>
+
+#include <algorithm>
+
 #include "base/logging.h"
+#include "util/file/offset_file_writer.h"
 #include "util/numeric/safe_assignment.h"
+#include "util/thread/worker_pool.h"
 
 namespace {
 
 const size_t kMaximumAlignment = 16;
 
+// The number of elements in kZeroes must be at least one less than the maximum
+// Alignment() ever encountered.
+const uint8_t kZeroes[kMaximumAlignment - 1] = {};
+
+// Writes |iovecs| in a single WriteIoVec() call, if there’s anything to write,
+// and clears it.
+bool FlushGathered(crashpad::FileWriterInterface* file_writer,
+                   std::vector<crashpad::WritableIoVec>* iovecs) {
+  if (iovecs->empty()) {
+    return true;
+  }
+
+  bool rv = file_writer->WriteIoVec(iovecs);
+  iovecs->clear();
+  return rv;
+}
+
 }  // namespace
 
 namespace crashpad {
 namespace internal {
 
+// Performs the tasks collected by WriteEverythingParallel(), each at the file
+// offset that its portion of the tree was laid out at. The first task_count
+// tasks are performed independently. The remaining tasks are for objects that
+// must be written on the same thread as their leader, and are sorted by it.
+class MinidumpWritable::ParallelWriter final : public WorkerPool::Delegate {
+ public:
+  ParallelWriter(const std::vector<ParallelWriteTask>* tasks,
+                 size_t task_count,
+                 PositionalFileWriterInterface* file_writer,
+                 off_t start_offset)
+      : tasks_(tasks),
+        task_count_(task_count),
+        file_writer_(file_writer),
+        start_offset_(start_offset) {}
+
+  ~ParallelWriter() {}
+
+  static bool LeaderLess(const ParallelWriteTask& lhs,
+                         const ParallelWriteTask& rhs) {
+    return lhs.leader < rhs.leader;
+  }
+
+  // WorkerPool::Delegate:
+  virtual bool DoWork(size_t index) override {
+    const ParallelWriteTask& task = (*tasks_)[index];
+    if (!Perform(task)) {
+      return false;
+    }
+
+    if (task.include_children) {
+      return true;
+    }
+
+    ParallelWriteTask key;
+    key.leader = task.writable;
+    auto followers = std::equal_range(
+        tasks_->begin() + task_count_, tasks_->end(), key, LeaderLess);
+    for (auto follower = followers.first; follower != followers.second;
+         ++follower) {
+      if (!Perform(*follower)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  bool Perform(const ParallelWriteTask& task) {
+    MinidumpWritable* writable = task.writable;
+
+    OffsetFileWriter file_writer(
+        file_writer_, start_offset_ + writable->phase_offsets_[task.phase]);
+
+    if (task.include_children) {
+      std::vector<WritableIoVec> gathered;
+      return writable->WriteTree(task.phase, &file_writer, &gathered) &&
+             FlushGathered(&file_writer, &gathered);
+    }
+
+    DCHECK_EQ(task.phase, writable->WritePhase());
+    return writable->WritePaddingAndObject(&file_writer);
+  }
+
+  const std::vector<ParallelWriteTask>* tasks_;  // weak
+  size_t task_count_;
+  PositionalFileWriterInterface* file_writer_;  // weak
+  off_t start_offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelWriter);
+};
+
 bool MinidumpWritable::WriteEverything(FileWriterInterface* file_writer) {
   DCHECK_EQ(state_, kStateMutable);
 
-  if (!Freeze()) {
+  size_t file_size;
+  if (!FreezeAndLayOut(&file_size) || !file_writer->WillWrite(file_size)) {
     return false;
   }
 
-  DCHECK_EQ(state_, kStateFrozen);
-
-  off_t offset = 0;
-  std::vector<MinidumpWritable*> write_sequence;
-  size_t size = WillWriteAtOffset(kPhaseEarly, &offset, &write_sequence);
-  if (size == kInvalidSize) {
+  // Every object’s file offset is now known, and all RVAs and location
+  // descriptors have been populated. Objects written early may point to objects
+  // written late, so nothing could be written until both phases were laid out.
+  // Walk the tree again in the same order to write it, rather than collecting
+  // every object in the tree into a list during layout.
+  std::vector<WritableIoVec> gathered;
+  if (!WriteTree(kPhaseEarly, file_writer, &gathered) ||
+      !WriteTree(kPhaseLate, file_writer, &gathered) ||
+      !FlushGathered(file_writer, &gathered)) {
     return false;
   }
 
-  offset += size;
-  if (WillWriteAtOffset(kPhaseLate, &offset, &write_sequence) == kInvalidSize) {
+  DCHECK_EQ(state_, kStateWritten);
+
+  return true;
+}
+
+bool MinidumpWritable::WriteEverythingParallel(
+    PositionalFileWriterInterface* file_writer,
+    off_t start_offset,
+    size_t thread_count) {
+  DCHECK_EQ(state_, kStateMutable);
+
+  size_t file_size;
+  if (!FreezeAndLayOut(&file_size) ||
+      !file_writer->WillWriteAt(start_offset, file_size)) {
     return false;
   }
 
-  DCHECK_EQ(state_, kStateWritable);
-  DCHECK_EQ(write_sequence.front(), this);
+  // Objects written late, such as memory snapshots, tend to be the largest, so
+  // they are written individually, and are handed out to threads first. Early
+  // objects tend to be small and numerous, so only the root object is split
+  // from its children, whose subtrees (typically, individual streams) are each
+  // written as a unit.
+  std::vector<ParallelWriteTask> tasks;
+  CollectParallelWriteTasks(
+      kPhaseLate, std::numeric_limits<size_t>::max(), &tasks);
+  CollectParallelWriteTasks(kPhaseEarly, 1, &tasks);
+
+  // Objects that must be written along with a leader are moved to the end,
+  // where each leader’s task finds them, instead of being tasks of their own.
+  auto followers = std::stable_partition(
+      tasks.begin(), tasks.end(), [](const ParallelWriteTask& task) {
+        return !task.leader;
+      });
+  std::sort(followers, tasks.end(), ParallelWriter::LeaderLess);
+  const size_t task_count = followers - tasks.begin();
+
+  ParallelWriter parallel_writer(&tasks, task_count, file_writer, start_offset);
+  WorkerPool worker_pool(thread_count);
+  if (!worker_pool.Run(&parallel_writer, task_count)) {
+    return false;
+  }
 
-  for (MinidumpWritable* writable : write_sequence) {
-    if (!writable->WritePaddingAndObject(file_writer)) {
-      return false;
-    }
+#ifndef NDEBUG
+  // Each leader must have had a task of its own to write its followers in.
+  for (auto follower = followers; follower != tasks.end(); ++follower) {
+    DCHECK_EQ(follower->writable->state_, kStateWritten);
   }
+#endif
 
   DCHECK_EQ(state_, kStateWritten);
 
@@ -74,12 +208,24 @@ void MinidumpWritable::RegisterLocationDescriptor(
   registered_location_descriptors_.push_back(location_descriptor);
 }
 
+void MinidumpWritable::SetArena(Arena* arena) {
+  DCHECK_EQ(state_, kStateMutable);
+  DCHECK(registered_rvas_.empty());
+  DCHECK(registered_location_descriptors_.empty());
+
+  registered_rvas_.set_arena(arena);
+  registered_location_descriptors_.set_arena(arena);
+  arena_ = arena;
+}
+
 const size_t MinidumpWritable::kInvalidSize =
     std::numeric_limits<size_t>::max();
 
 MinidumpWritable::MinidumpWritable()
     : registered_rvas_(),
       registered_location_descriptors_(),
+      arena_(NULL),
+      phase_offsets_(),
       leading_pad_bytes_(0),
       state_(kStateMutable) {
 }
@@ -91,8 +237,8 @@ bool MinidumpWritable::Freeze() {
   DCHECK_EQ(state_, kStateMutable);
   state_ = kStateFrozen;
 
-  std::vector<MinidumpWritable*> children = Children();
-  for (MinidumpWritable* child : children) {
+  for (size_t index = 0, count = ChildCount(); index < count; ++index) {
+    MinidumpWritable* child = ChildAt(index);
     if (!child->Freeze()) {
       return false;
     }
@@ -107,32 +253,34 @@ size_t MinidumpWritable::Alignment() {
   return 4;
 }
 
-std::vector<MinidumpWritable*> MinidumpWritable::Children() {
+size_t MinidumpWritable::ChildCount() {
+  DCHECK_GE(state_, kStateFrozen);
+
+  return 0;
+}
+
+MinidumpWritable* MinidumpWritable::ChildAt(size_t index) {
   DCHECK_GE(state_, kStateFrozen);
 
-  return std::vector<MinidumpWritable*>();
+  NOTREACHED();
+  return NULL;
 }
 
 MinidumpWritable::Phase MinidumpWritable::WritePhase() {
   return kPhaseEarly;
 }
 
-size_t MinidumpWritable::WillWriteAtOffset(
-    Phase phase,
-    off_t* offset,
-    std::vector<MinidumpWritable*>* write_sequence) {
+size_t MinidumpWritable::WillWriteAtOffset(Phase phase, off_t* offset) {
   off_t local_offset = *offset;
   CHECK_GE(local_offset, 0);
 
+  phase_offsets_[phase] = local_offset;
+
   size_t leading_pad_bytes_this_phase;
   size_t size;
   if (phase == WritePhase()) {
     DCHECK_EQ(state_, kStateFrozen);
 
-    // Add this object to the sequence of MinidumpWritable objects to be
-    // written.
-    write_sequence->push_back(this);
-
     size = SizeOfObject();
 
     if (size > 0) {
@@ -210,8 +358,8 @@ size_t MinidumpWritable::WillWriteAtOffset(
   // Loop over children regardless of whether this object itself will write
   // during this phase. An object’s children are not required to be written
   // during the same phase as their parent.
-  std::vector<MinidumpWritable*> children = Children();
-  for (MinidumpWritable* child : children) {
+  for (size_t index = 0, count = ChildCount(); index < count; ++index) {
+    MinidumpWritable* child = ChildAt(index);
     // Use “auto” here because it’s impossible to know whether size_t (size) or
     // off_t (local_offset) is the wider type, and thus what type the result of
     // adding these two variables will have.
@@ -222,8 +370,7 @@ size_t MinidumpWritable::WillWriteAtOffset(
       return kInvalidSize;
     }
 
-    size_t child_size =
-        child->WillWriteAtOffset(phase, &child_offset, write_sequence);
+    size_t child_size = child->WillWriteAtOffset(phase, &child_offset);
     if (child_size == kInvalidSize) {
       return kInvalidSize;
     }
@@ -238,12 +385,72 @@ bool MinidumpWritable::WillWriteAtOffsetImpl(off_t offset) {
   return true;
 }
 
+bool MinidumpWritable::WriteTree(Phase phase,
+                                 FileWriterInterface* file_writer,
+                                 std::vector<WritableIoVec>* gathered) {
+  DCHECK_GE(state_, kStateWritable);
+
+  if (phase == WritePhase()) {
+    DCHECK_EQ(state_, kStateWritable);
+    DCHECK_LE(leading_pad_bytes_, arraysize(kZeroes));
+
+    size_t gathered_count = gathered->size();
+    if (leading_pad_bytes_) {
+      WritableIoVec iov;
+      iov.iov_base = kZeroes;
+      iov.iov_len = leading_pad_bytes_;
+      gathered->push_back(iov);
+    }
+
+    if (GatherObject(gathered)) {
+#ifndef NDEBUG
+      size_t gathered_size = 0;
+      for (size_t index = gathered_count; index < gathered->size(); ++index) {
+        gathered_size += (*gathered)[index].iov_len;
+      }
+      DCHECK_EQ(gathered_size, leading_pad_bytes_ + SizeOfObject());
+#endif
+
+      state_ = kStateWritten;
+
+      // Keep each batch within what a single writev() can take. If this
+      // object’s buffers don’t fit, write what was gathered before them, and
+      // start a new batch with them.
+      if (gathered->size() > static_cast<size_t>(IOV_MAX) && gathered_count) {
+        std::vector<WritableIoVec> object_iovecs(
+            gathered->begin() + gathered_count, gathered->end());
+        gathered->resize(gathered_count);
+        if (!FlushGathered(file_writer, gathered)) {
+          return false;
+        }
+        gathered->swap(object_iovecs);
+      }
+    } else {
+      // This object needs to write itself. Anything gathered so far precedes
+      // it in the file and must be written first.
+      gathered->resize(gathered_count);
+      if (!FlushGathered(file_writer, gathered) ||
+          !WritePaddingAndObject(file_writer)) {
+        return false;
+      }
+    }
+  }
+
+  // As in WillWriteAtOffset(), visit children regardless of whether this object
+  // wrote anything during this phase, so that objects are written in exactly
+  // the sequence that their file offsets were assigned in.
+  for (size_t index = 0, count = ChildCount(); index < count; ++index) {
+    MinidumpWritable* child = ChildAt(index);
+    if (!child->WriteTree(phase, file_writer, gathered)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool MinidumpWritable::WritePaddingAndObject(FileWriterInterface* file_writer) {
   DCHECK_EQ(state_, kStateWritable);
-
-  // The number of elements in kZeroes must be at least one less than the
-  // maximum Alignment() ever encountered.
-  const uint8_t kZeroes[kMaximumAlignment - 1] = {};
   DCHECK_LE(leading_pad_bytes_, arraysize(kZeroes));
 
   if (leading_pad_bytes_) {
@@ -260,5 +467,73 @@ bool MinidumpWritable::WritePaddingAndObject(FileWriterInterface* file_writer) {
   return true;
 }
 
+bool MinidumpWritable::GatherObject(std::vector<WritableIoVec>* iovecs) {
+  DCHECK_EQ(state_, kStateWritable);
+
+  return false;
+}
+
+MinidumpWritable* MinidumpWritable::ParallelWriteLeader() {
+  DCHECK_EQ(state_, kStateWritable);
+
+  return NULL;
+}
+
+bool MinidumpWritable::FreezeAndLayOut(size_t* file_size) {
+  DCHECK_EQ(state_, kStateMutable);
+
+  if (!Freeze()) {
+    return false;
+  }
+
+  DCHECK_EQ(state_, kStateFrozen);
+
+  off_t offset = 0;
+  size_t early_size = WillWriteAtOffset(kPhaseEarly, &offset);
+  if (early_size == kInvalidSize) {
+    return false;
+  }
+
+  offset += early_size;
+  size_t late_size = WillWriteAtOffset(kPhaseLate, &offset);
+  if (late_size == kInvalidSize) {
+    return false;
+  }
+
+  DCHECK_EQ(state_, kStateWritable);
+
+  // Both sizes include any padding, so together they cover the entire file.
+  *file_size = early_size + late_size;
+
+  return true;
+}
+
+void MinidumpWritable::CollectParallelWriteTasks(
+    Phase phase,
+    size_t split_depth,
+    std::vector<ParallelWriteTask>* tasks) {
+  ParallelWriteTask task;
+  task.writable = this;
+  task.phase = phase;
+  task.leader = NULL;
+
+  if (split_depth == 0) {
+    task.include_children = true;
+    tasks->push_back(task);
+    return;
+  }
+
+  if (phase == WritePhase()) {
+    task.include_children = false;
+    task.leader = ParallelWriteLeader();
+    tasks->push_back(task);
+  }
+
+  for (size_t index = 0, count = ChildCount(); index < count; ++index) {
+    MinidumpWritable* child = ChildAt(index);
+    child->CollectParallelWriteTasks(phase, split_depth - 1, tasks);
+  }
+}
+
 }  // namespace internal
 }  // namespace crashpad
@@ -23,7 +23,10 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "util/file/file_writer.h"
+#include "util/misc/arena.h"
+#include "util/stdlib/pointer_container.h"
 
 namespace crashpad {
 namespace internal {
@@ -37,6 +40,10 @@ class MinidumpWritable {
   //! Use this on the root object of a tree of MinidumpWritable objects,
   //! typically on a MinidumpFileWriter object.
   //!
+  //! Once the tree has been laid out, the size of the file is passed to
+  //! FileWriterInterface::WillWrite() before anything is written, allowing
+  //! \a file_writer to allocate storage for the entire file at once.
+  //!
   //! \param[in] file_writer The file writer to receive the minidump file’s
   //!     content.
   //!
@@ -49,6 +56,41 @@ class MinidumpWritable {
   //! \note This method should rarely be overridden.
   virtual bool WriteEverything(FileWriterInterface* file_writer);
 
+  //! \brief Writes an object and all of its children to a minidump file, using
+  //!     several threads.
+  //!
+  //! This produces exactly the same file content as WriteEverything(). Once
+  //! the tree has been laid out and every object’s file offset is known, the
+  //! tree is divided into independent portions that are written concurrently
+  //! at their known offsets: the root object itself, each of its children’s
+  //! subtrees written in #kPhaseEarly, and each object written in
+  //! #kPhaseLate.
+  //!
+  //! As with WriteEverything(), the size of the file is passed to
+  //! PositionalFileWriterInterface::WillWriteAt() before anything is written.
+  //!
+  //! Because WriteObject() and GatherObject() may be called for different
+  //! objects at the same time on different threads, this method must only be
+  //! used with trees whose objects do not share state that is modified while
+  //! writing, other than objects tied together by ParallelWriteLeader().
+  //!
+  //! \param[in] file_writer The file writer to receive the minidump file’s
+  //!     content.
+  //! \param[in] start_offset The offset within \a file_writer at which the
+  //!     minidump file begins.
+  //! \param[in] thread_count The maximum number of threads to write with,
+  //!     including the calling thread.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  //!
+  //! \note Valid in #kStateMutable, and transitions the object and the entire
+  //!     tree beneath it through all states to #kStateWritten.
+  virtual bool WriteEverythingParallel(
+      PositionalFileWriterInterface* file_writer,
+      off_t start_offset,
+      size_t thread_count);
+
   //! \brief Registers a file offset pointer as one that should point to the
   //!     object on which this method is called.
   //!
@@ -82,6 +124,33 @@ class MinidumpWritable {
   void RegisterLocationDescriptor(
       MINIDUMP_LOCATION_DESCRIPTOR* location_descriptor);
 
+  //! \brief Causes the object to allocate its internal storage from \a arena.
+  //!
+  //! This covers the lists maintained by RegisterRVA() and
+  //! RegisterLocationDescriptor(), as well as any storage and objects that
+  //! subclasses allocate on behalf of the object, such as a module writer’s
+  //! name, a list writer’s list of children, and the objects created by
+  //! `InitializeFromSnapshot()` methods. \a arena must outlive the object.
+  //!
+  //! \note Valid in #kStateMutable, before any RVAs or location descriptors
+  //!     have been registered.
+  void SetArena(Arena* arena);
+
+  //! \brief Creates an object of type \a T in \a arena, and calls SetArena()
+  //!     on it.
+  //!
+  //! Building an entire tree of objects this way, after calling
+  //! Arena::Reserve() with a suitable size, allows the tree to be built and
+  //! written with very few calls to the system allocator.
+  //!
+  //! \return The new object, which is owned by \a arena.
+  template <typename T>
+  static T* NewInArena(Arena* arena) {
+    T* object = arena->New<T>();
+    object->SetArena(arena);
+    return object;
+  }
+
  protected:
   //! \brief Identifies the state of an object.
   //!
@@ -138,6 +207,41 @@ class MinidumpWritable {
   //! \brief The state of the object.
   State state() const { return state_; }
 
+  //! \brief The Arena that the object allocates from, or `NULL` if it
+  //!     allocates from the heap.
+  Arena* arena() const { return arena_; }
+
+  //! \brief Creates an object of type \a T on behalf of this object.
+  //!
+  //! If SetArena() has been called, the new object is created by NewInArena()
+  //! and is owned by arena(). Otherwise, it is created on the heap, and
+  //! ownership is passed to \a owner, which may be a `scoped_ptr<>` or a
+  //! PointerVector<>.
+  //!
+  //! \return The new object.
+  template <typename T, typename Owner>
+  T* NewOwned(Owner* owner) {
+    if (arena_) {
+      return NewInArena<T>(arena_);
+    }
+
+    T* object = new T();
+    AdoptOwned(owner, object);
+    return object;
+  }
+
+  //! \brief Causes \a vector to allocate its storage from arena(), if
+  //!     SetArena() has been called and \a vector has not yet allocated any
+  //!     storage.
+  //!
+  //! Subclasses call this before adding to their ArenaVector<> members.
+  template <typename T>
+  void UseArena(ArenaVector<T>* vector) {
+    if (arena_ && !vector->capacity()) {
+      vector->set_arena(arena_);
+    }
+  }
+
   //! \brief Transitions the object from #kStateMutable to #kStateFrozen.
   //!
   //! The default implementation marks the object as frozen and recursively
@@ -168,10 +272,27 @@ class MinidumpWritable {
   //! \note Valid in #kStateFrozen or any subsequent state.
   virtual size_t Alignment();
 
-  //! \brief Returns the object’s children.
+  //! \brief Returns the number of children that the object has.
+  //!
+  //! Children are enumerated by calling ChildAt() with each index from `0` up
+  //! to, but not including, this value. Because the tree is walked several
+  //! times while it is laid out and written, enumerating children must not
+  //! allocate: implementations typically index into storage that the object
+  //! already maintains.
+  //!
+  //! The default implementation returns `0`. Subclasses that have children
+  //! must override both this method and ChildAt().
+  //!
+  //! \note Valid in #kStateFrozen or any subsequent state.
+  virtual size_t ChildCount();
+
+  //! \brief Returns one of the object’s children.
+  //!
+  //! \param[in] index The index of the child to return, which must be less
+  //!     than ChildCount().
   //!
   //! \note Valid in #kStateFrozen or any subsequent state.
-  virtual std::vector<MinidumpWritable*> Children();
+  virtual MinidumpWritable* ChildAt(size_t index);
 
   //! \brief Returns the object’s desired write phase.
   //!
@@ -197,10 +318,6 @@ class MinidumpWritable {
   //!     the case where parents and children do not write in the same phase.
   //! \param[in] offset The file offset at which the object will be written. The
   //!     offset may need to be adjusted for alignment.
-  //! \param[out] write_sequence This object will append itself to this list,
-  //!     such that on return from a recursive tree of WillWriteAtOffset()
-  //!     calls, elements of the vector will be organized in the sequence that
-  //!     the objects will be written to the minidump file.
   //!
   //! \return The file size consumed by this object and all children, including
   //!     any padding inserted to meet alignment requirements. On failure,
@@ -209,9 +326,7 @@ class MinidumpWritable {
   //! \note This method cannot be overridden. Subclasses that need to perform
   //!     processing when an object transitions to #kStateWritable should
   //!     implement WillWriteAtOffsetImpl(), which is called by this method.
-  size_t WillWriteAtOffset(Phase phase,
-                           off_t* offset,
-                           std::vector<MinidumpWritable*>* write_sequence);
+  size_t WillWriteAtOffset(Phase phase, off_t* offset);
 
   //! \brief Called once an object’s writable file offset is determined, as it
   //!     transitions into #kStateWritable.
@@ -247,6 +362,37 @@ class MinidumpWritable {
   //!     WriteObject().
   bool WritePaddingAndObject(FileWriterInterface* file_writer);
 
+  //! \brief Writes the object and all of its children that are to be written
+  //!     during \a phase.
+  //!
+  //! This walks the tree in the same order as WillWriteAtOffset(), calling
+  //! WritePaddingAndObject() on each object whose WritePhase() matches \a
+  //! phase. Because the tree itself establishes the write order, no separate
+  //! list of objects to write needs to be built or retained: the space required
+  //! is proportional to the depth of the tree rather than to its size.
+  //!
+  //! Objects able to provide their content through GatherObject() are not
+  //! written immediately. Their content, along with any leading padding, is
+  //! appended to \a gathered, and is written by a single
+  //! FileWriterInterface::WriteIoVec() call when an object that must be written
+  //! by WriteObject() is encountered, before \a gathered exceeds `IOV_MAX`
+  //! buffers, or when the caller flushes \a gathered at the end of the phase.
+  //!
+  //! \param[in] phase The phase being written. Objects that write in another
+  //!     phase are skipped, but their children are still visited.
+  //! \param[in] file_writer The file writer to receive the objects’ content.
+  //! \param[in,out] gathered Buffers that have been gathered but not yet
+  //!     written.
+  //!
+  //! \return `true` on success. `false` on error with an appropriate message
+  //!     logged.
+  //!
+  //! \note Valid in #kStateWritable, once WillWriteAtOffset() has been called
+  //!     for every phase on the entire tree.
+  bool WriteTree(Phase phase,
+                 FileWriterInterface* file_writer,
+                 std::vector<WritableIoVec>* gathered);
+
   //! \brief Writes the object’s content.
   //!
   //! \param[in] file_writer The file writer to receive the object’s content.
@@ -258,11 +404,109 @@ class MinidumpWritable {
   //!     #kStateWritten after this method returns.
   virtual bool WriteObject(FileWriterInterface* file_writer) = 0;
 
+  //! \brief Provides the object’s content as a list of buffers, as an
+  //!     alternative to WriteObject().
+  //!
+  //! Objects whose content is already resident in memory can override this
+  //! method to allow their content to be written without being copied, and
+  //! together with the content of neighboring objects in a single
+  //! FileWriterInterface::WriteIoVec() call, instead of by WriteObject(). This
+  //! is most useful for trees of many small objects.
+  //!
+  //! The buffers referenced by \a iovecs must remain valid and unchanged until
+  //! WriteEverything() returns. Their total size must be the value returned by
+  //! SizeOfObject().
+  //!
+  //! The default implementation returns `false` without modifying \a iovecs.
+  //!
+  //! \param[out] iovecs A list to append the object’s buffers to.
+  //!
+  //! \return `true` if the object’s content was appended to \a iovecs.
+  //!     `false` if the object must be written by WriteObject() instead.
+  //!
+  //! \note Valid in #kStateWritable. If this method returns `true`, the object
+  //!     will transition to #kStateWritten, and WriteObject() will not be
+  //!     called.
+  virtual bool GatherObject(std::vector<WritableIoVec>* iovecs);
+
+  //! \brief Returns the object that must be written on the same thread as
+  //!     this one by WriteEverythingParallel(), if any.
+  //!
+  //! An object whose WriteObject() uses another object’s state, as a memory
+  //! region does when writing a region that has been coalesced into it, can
+  //! be named by that other object from this method. WriteEverythingParallel()
+  //! then writes the object returned, followed by this object, on a single
+  //! thread, rather than writing each of them independently.
+  //!
+  //! This is only consulted for objects that are written individually, which
+  //! includes every object written in #kPhaseLate.
+  //!
+  //! The default implementation returns `NULL`.
+  //!
+  //! \note Valid in #kStateWritable.
+  virtual MinidumpWritable* ParallelWriteLeader();
+
  private:
-  std::vector<RVA*> registered_rvas_;  // weak
+  class ParallelWriter;
+
+  template <typename Base, typename T>
+  static void AdoptOwned(scoped_ptr<Base>* owner, T* object) {
+    owner->reset(object);
+  }
+
+  template <typename Base, typename T>
+  static void AdoptOwned(PointerVector<Base>* owner, T* object) {
+    owner->push_back(object);
+  }
+
+  //! \brief A portion of the tree written by WriteEverythingParallel().
+  struct ParallelWriteTask {
+    //! \brief The object to write.
+    MinidumpWritable* writable;
+
+    //! \brief The phase being written.
+    Phase phase;
+
+    //! \brief Whether the task consists of #writable’s entire subtree (`true`),
+    //!     or only of #writable itself (`false`).
+    bool include_children;
+
+    //! \brief The object whose task also writes #writable, as returned by
+    //!     ParallelWriteLeader(), or `NULL` if #writable has a task of its own.
+    MinidumpWritable* leader;
+  };
+
+  //! \brief Freezes the object and lays out the entire tree beneath it,
+  //!     transitioning everything from #kStateMutable to #kStateWritable.
+  //!
+  //! \param[out] file_size The size of the file that the tree will produce.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  bool FreezeAndLayOut(size_t* file_size);
+
+  //! \brief Divides the object and its children into tasks for
+  //!     WriteEverythingParallel().
+  //!
+  //! \param[in] phase The phase to produce tasks for.
+  //! \param[in] split_depth The number of levels of the tree to divide into
+  //!     individual objects. At this depth, each object’s entire subtree
+  //!     becomes a single task.
+  //! \param[out] tasks A list to append tasks to.
+  void CollectParallelWriteTasks(Phase phase,
+                                 size_t split_depth,
+                                 std::vector<ParallelWriteTask>* tasks);
+
+  ArenaVector<RVA*> registered_rvas_;  // weak
 
   // weak
-  std::vector<MINIDUMP_LOCATION_DESCRIPTOR*> registered_location_descriptors_;
+  ArenaVector<MINIDUMP_LOCATION_DESCRIPTOR*> registered_location_descriptors_;
+
+  Arena* arena_;  // weak
+
+  // The file offsets that this object and its subtree were laid out at, before
+  // any alignment padding, indexed by Phase.
+  off_t phase_offsets_[kPhaseLate + 1];
 
   size_t leading_pad_bytes_;
   State state_;
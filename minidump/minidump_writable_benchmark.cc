@@ -0,0 +1,562 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "minidump/minidump_benchmark_util.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/minidump_module_writer.h"
+#include "minidump/minidump_writable.h"
+#include "util/file/file_writer.h"
+#include "util/file/mapped_file_writer.h"
+#include "util/misc/arena.h"
+#include "util/stdlib/pointer_container.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// The data written by each BenchmarkTreeWritable. This is 21 bytes long, so
+// that most objects are followed by padding.
+const char kTreePayload[] = "benchmark tree object";
+const size_t kTreePayloadSize = sizeof(kTreePayload) - 1;
+
+// A node in an arbitrarily-shaped tree of writables. Each node writes a small
+// fixed payload, and offers it through GatherObject() so that the vectored
+// write path is used.
+//
+// Nodes given a write sequence append themselves to it as they are laid out, so
+// that the tree can also be written by WriteEverythingWithWriteSequence().
+// Nodes created with |allocate_children| set copy their children into a newly
+// allocated vector each time they are enumerated, as the Children() method that
+// ChildCount() and ChildAt() replaced did.
+class BenchmarkTreeWritable final : public internal::MinidumpWritable {
+ public:
+  BenchmarkTreeWritable(std::vector<BenchmarkTreeWritable*>* write_sequence,
+                        bool allocate_children)
+      : MinidumpWritable(),
+        children_(),
+        enumerated_children_(),
+        write_sequence_(write_sequence),
+        allocate_children_(allocate_children) {}
+  ~BenchmarkTreeWritable() {}
+
+  void AddChild(BenchmarkTreeWritable* child) { children_.push_back(child); }
+
+  // A reference implementation of the write path that WriteEverything() used
+  // before it walked the tree to write it: every object is appended to a write
+  // sequence as it is laid out, and the sequence is then written one object at
+  // a time with WriteObject(). This must be called on the root of a tree built
+  // with a write sequence.
+  bool WriteEverythingWithWriteSequence(FileWriterInterface* file_writer) {
+    DCHECK(write_sequence_);
+    DCHECK(write_sequence_->empty());
+
+    if (!Freeze()) {
+      return false;
+    }
+
+    off_t offset = 0;
+    size_t size = WillWriteAtOffset(kPhaseEarly, &offset);
+    if (size == kInvalidSize) {
+      return false;
+    }
+
+    offset += size;
+    if (WillWriteAtOffset(kPhaseLate, &offset) == kInvalidSize) {
+      return false;
+    }
+
+    DCHECK_EQ(write_sequence_->front(), this);
+
+    for (BenchmarkTreeWritable* writable : *write_sequence_) {
+      if (!writable->WritePaddingAndObject(file_writer)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ protected:
+  // MinidumpWritable:
+
+  virtual size_t SizeOfObject() override { return kTreePayloadSize; }
+
+  virtual size_t ChildCount() override {
+    if (allocate_children_) {
+      enumerated_children_ = std::vector<BenchmarkTreeWritable*>(children_);
+      return enumerated_children_.size();
+    }
+    return children_.size();
+  }
+
+  virtual MinidumpWritable* ChildAt(size_t index) override {
+    return allocate_children_ ? enumerated_children_[index] : children_[index];
+  }
+
+  virtual bool WillWriteAtOffsetImpl(off_t offset) override {
+    // This is called once for each object, in the order that the objects are
+    // to be written.
+    if (write_sequence_) {
+      write_sequence_->push_back(this);
+    }
+    return MinidumpWritable::WillWriteAtOffsetImpl(offset);
+  }
+
+  virtual bool WriteObject(FileWriterInterface* file_writer) override {
+    return file_writer->Write(kTreePayload, kTreePayloadSize);
+  }
+
+  virtual bool GatherObject(std::vector<WritableIoVec>* iovecs) override {
+    WritableIoVec iov;
+    iov.iov_base = kTreePayload;
+    iov.iov_len = kTreePayloadSize;
+    iovecs->push_back(iov);
+    return true;
+  }
+
+ private:
+  std::vector<BenchmarkTreeWritable*> children_;  // weak
+  std::vector<BenchmarkTreeWritable*> enumerated_children_;  // weak
+  std::vector<BenchmarkTreeWritable*>* write_sequence_;  // weak
+  bool allocate_children_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkTreeWritable);
+};
+
+// Builds a tree of |node_count| nodes in breadth-first order, in which each
+// node has up to |fanout| children. The root is the first element of |nodes|.
+// If |write_sequence| is not NULL, the nodes append themselves to it as they
+// are laid out. |allocate_children| is passed to each node’s constructor.
+void BuildTree(size_t node_count,
+               size_t fanout,
+               std::vector<BenchmarkTreeWritable*>* write_sequence,
+               bool allocate_children,
+               PointerVector<BenchmarkTreeWritable>* nodes) {
+  nodes->reserve(node_count);
+  for (size_t index = 0; index < node_count; ++index) {
+    BenchmarkTreeWritable* node =
+        new BenchmarkTreeWritable(write_sequence, allocate_children);
+    nodes->push_back(node);
+    if (index > 0) {
+      (*nodes)[(index - 1) / fanout]->AddChild(node);
+    }
+  }
+}
+
+// Lays out and writes trees of range(0) nodes, each with up to range(1)
+// children. A fanout equal to the node count produces a single wide level.
+void BM_MinidumpWritableWriteEverything(BenchmarkState* state) {
+  const size_t node_count = state->range(0);
+  const size_t fanout = state->range(1);
+
+  DiscardingFileWriter file_writer;
+  scoped_ptr<PointerVector<BenchmarkTreeWritable> > nodes;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    nodes.reset(new PointerVector<BenchmarkTreeWritable>());
+    BuildTree(node_count, fanout, NULL, false, nodes.get());
+    file_writer.Reset();
+    state->ResumeTiming();
+
+    if (!(*nodes)[0]->WriteEverything(&file_writer)) {
+      state->SkipWithError("WriteEverything failed");
+      return;
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * node_count);
+  state->SetBytesProcessed(state->iterations() * file_writer.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWritableWriteEverything)
+    ->Args(1000, 4)
+    ->Args(10000, 4)
+    ->Args(100000, 4)
+    ->Args(1000000, 4)
+    ->Args(1000, 1000)
+    ->Args(10000, 10000)
+    ->Args(100000, 100000)
+    ->Args(1000000, 1000000);
+
+// The same as BM_MinidumpWritableWriteEverything, but writes the trees with
+// BenchmarkTreeWritable::WriteEverythingWithWriteSequence(), for comparison.
+void BM_MinidumpWritableWriteSequence(BenchmarkState* state) {
+  const size_t node_count = state->range(0);
+  const size_t fanout = state->range(1);
+
+  DiscardingFileWriter file_writer;
+  scoped_ptr<PointerVector<BenchmarkTreeWritable> > nodes;
+  scoped_ptr<std::vector<BenchmarkTreeWritable*> > write_sequence;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    nodes.reset(new PointerVector<BenchmarkTreeWritable>());
+    write_sequence.reset(new std::vector<BenchmarkTreeWritable*>());
+    BuildTree(node_count, fanout, write_sequence.get(), false, nodes.get());
+    file_writer.Reset();
+    state->ResumeTiming();
+
+    if (!(*nodes)[0]->WriteEverythingWithWriteSequence(&file_writer)) {
+      state->SkipWithError("WriteEverythingWithWriteSequence failed");
+      return;
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * node_count);
+  state->SetBytesProcessed(state->iterations() * file_writer.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWritableWriteSequence)
+    ->Args(1000, 4)
+    ->Args(10000, 4)
+    ->Args(100000, 4)
+    ->Args(1000000, 4)
+    ->Args(1000, 1000)
+    ->Args(10000, 10000)
+    ->Args(100000, 100000)
+    ->Args(1000000, 1000000);
+
+// The same as BM_MinidumpWritableWriteEverything, but with nodes that allocate
+// each time their children are enumerated, for comparison.
+void BM_MinidumpWritableAllocatingChildren(BenchmarkState* state) {
+  const size_t node_count = state->range(0);
+  const size_t fanout = state->range(1);
+
+  DiscardingFileWriter file_writer;
+  scoped_ptr<PointerVector<BenchmarkTreeWritable> > nodes;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    nodes.reset(new PointerVector<BenchmarkTreeWritable>());
+    BuildTree(node_count, fanout, NULL, true, nodes.get());
+    file_writer.Reset();
+    state->ResumeTiming();
+
+    if (!(*nodes)[0]->WriteEverything(&file_writer)) {
+      state->SkipWithError("WriteEverything failed");
+      return;
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * node_count);
+  state->SetBytesProcessed(state->iterations() * file_writer.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWritableAllocatingChildren)
+    ->Args(1000, 4)
+    ->Args(10000, 4)
+    ->Args(100000, 4)
+    ->Args(1000000, 4)
+    ->Args(1000, 1000)
+    ->Args(10000, 10000)
+    ->Args(100000, 100000)
+    ->Args(1000000, 1000000);
+
+// Holds a minidump file containing a memory list made of BenchmarkMemoryWriter
+// objects, allocated from the heap or from an arena.
+class MemoryListMinidump {
+ public:
+  MemoryListMinidump(Arena* arena, size_t region_count, size_t region_size)
+      : owned_file_writer_(),
+        owned_memory_list_writer_(),
+        owned_memory_writers_(),
+        file_writer_(NULL) {
+    MinidumpMemoryListWriter* memory_list_writer;
+    if (arena) {
+      file_writer_ =
+          internal::MinidumpWritable::NewInArena<MinidumpFileWriter>(arena);
+      memory_list_writer = internal::MinidumpWritable::NewInArena<
+          MinidumpMemoryListWriter>(arena);
+    } else {
+      owned_file_writer_.reset(new MinidumpFileWriter());
+      file_writer_ = owned_file_writer_.get();
+      owned_memory_list_writer_.reset(new MinidumpMemoryListWriter());
+      memory_list_writer = owned_memory_list_writer_.get();
+    }
+
+    // Leave a gap after each region so that none are coalesced.
+    const uint64_t stride = region_size + 4096;
+    for (size_t index = 0; index < region_count; ++index) {
+      BenchmarkMemoryWriter* memory_writer;
+      if (arena) {
+        memory_writer = internal::MinidumpWritable::NewInArena<
+            BenchmarkMemoryWriter>(arena);
+      } else {
+        memory_writer = new BenchmarkMemoryWriter();
+        owned_memory_writers_.push_back(memory_writer);
+      }
+      memory_writer->SetRange(0x10000000 + index * stride, region_size);
+      memory_list_writer->AddMemory(memory_writer);
+    }
+
+    file_writer_->AddStream(memory_list_writer);
+  }
+
+  ~MemoryListMinidump() {}
+
+  MinidumpFileWriter* minidump_file() const { return file_writer_; }
+
+ private:
+  scoped_ptr<MinidumpFileWriter> owned_file_writer_;
+  scoped_ptr<MinidumpMemoryListWriter> owned_memory_list_writer_;
+  PointerVector<BenchmarkMemoryWriter> owned_memory_writers_;
+  MinidumpFileWriter* file_writer_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryListMinidump);
+};
+
+// Writes a minidump file with a memory list of range(0) regions, each range(1)
+// bytes long.
+void BM_MinidumpMemoryListWriteEverything(BenchmarkState* state) {
+  const size_t region_count = state->range(0);
+  const size_t region_size = state->range(1);
+
+  DiscardingFileWriter file_writer;
+  scoped_ptr<MemoryListMinidump> minidump;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    minidump.reset(new MemoryListMinidump(NULL, region_count, region_size));
+    file_writer.Reset();
+    state->ResumeTiming();
+
+    if (!minidump->minidump_file()->WriteEverything(&file_writer)) {
+      state->SkipWithError("WriteEverything failed");
+      return;
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * region_count);
+  state->SetBytesProcessed(state->iterations() * file_writer.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpMemoryListWriteEverything)
+    ->Args(1000, 64)
+    ->Args(10000, 64)
+    ->Args(100000, 64)
+    ->Args(1000, 4096)
+    ->Args(1000, 65536);
+
+// Writes a minidump file with a large memory list to a real file, either
+// serially (range(0) is 0) or with WriteEverythingParallel() using range(0)
+// threads.
+void BM_MinidumpFileWriterWriteEverythingParallel(BenchmarkState* state) {
+  const size_t thread_count = state->range(0);
+  const size_t kRegionCount = 1024;
+  const size_t kRegionSize = 64 * 1024;
+
+  char path[] = "/tmp/crashpad_benchmark.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    state->SkipWithError("mkstemp failed");
+    return;
+  }
+  close(fd);
+
+  FileWriter file_writer;
+  if (!file_writer.Open(base::FilePath(path), O_WRONLY | O_TRUNC, 0600)) {
+    unlink(path);
+    state->SkipWithError("open failed");
+    return;
+  }
+
+  scoped_ptr<MemoryListMinidump> minidump;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    minidump.reset(new MemoryListMinidump(NULL, kRegionCount, kRegionSize));
+    file_writer.Seek(0, SEEK_SET);
+    state->ResumeTiming();
+
+    bool rv = thread_count == 0
+                  ? minidump->minidump_file()->WriteEverything(&file_writer)
+                  : minidump->minidump_file()->WriteEverythingParallel(
+                        &file_writer, 0, thread_count);
+    if (!rv) {
+      state->SkipWithError("write failed");
+      break;
+    }
+  }
+
+  file_writer.Close();
+  unlink(path);
+
+  state->SetBytesProcessed(state->iterations() * kRegionCount * kRegionSize);
+}
+CRASHPAD_BENCHMARK(BM_MinidumpFileWriterWriteEverythingParallel)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+
+// Writes a minidump file containing range(0) MB of memory to a real file. With
+// range(1) set to 0, the file is written with FileWriter. Otherwise, it’s
+// written with MappedFileWriter, using the map options in range(1) - 1, so 2
+// selects MappedFileWriter::kMapOptionsPopulate. Each iteration opens and
+// closes the file, so that a MappedFileWriter’s mapping, sized by
+// MinidumpFileWriter::WriteEverything() calling WillWrite(), is established
+// and torn down each time.
+void BM_MinidumpFileWriterMapped(BenchmarkState* state) {
+  const size_t region_count = state->range(0);
+  const size_t kRegionSize = 1024 * 1024;
+  const bool mapped = state->range(1) != 0;
+  const uint32_t map_options = mapped ? state->range(1) - 1 : 0;
+
+  char path[] = "/tmp/crashpad_benchmark.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    state->SkipWithError("mkstemp failed");
+    return;
+  }
+  close(fd);
+
+  scoped_ptr<MemoryListMinidump> minidump;
+  off_t dump_size = 0;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    minidump.reset(new MemoryListMinidump(NULL, region_count, kRegionSize));
+    state->ResumeTiming();
+
+    bool rv;
+    if (mapped) {
+      MappedFileWriter file_writer(map_options);
+      rv = file_writer.Open(base::FilePath(path), O_RDWR | O_TRUNC, 0600) &&
+           minidump->minidump_file()->WriteEverything(&file_writer);
+      dump_size = rv ? file_writer.Seek(0, SEEK_END) : 0;
+      rv = file_writer.Close() && rv;
+    } else {
+      FileWriter file_writer;
+      rv = file_writer.Open(base::FilePath(path), O_WRONLY | O_TRUNC, 0600) &&
+           minidump->minidump_file()->WriteEverything(&file_writer);
+      dump_size = rv ? file_writer.Seek(0, SEEK_END) : 0;
+      file_writer.Close();
+    }
+
+    if (!rv) {
+      state->SkipWithError("write failed");
+      break;
+    }
+  }
+
+  unlink(path);
+
+  state->SetBytesProcessed(state->iterations() * dump_size);
+  state->SetCounter("dump_bytes", dump_size);
+  state->SetLabel(!mapped ? "FileWriter"
+                          : map_options & MappedFileWriter::kMapOptionsPopulate
+                                ? "MappedFileWriter, populate"
+                                : "MappedFileWriter");
+}
+CRASHPAD_BENCHMARK(BM_MinidumpFileWriterMapped)
+    ->Args(1, 0)
+    ->Args(1, 1)
+    ->Args(1, 2)
+    ->Args(16, 0)
+    ->Args(16, 1)
+    ->Args(16, 2)
+    ->Args(256, 0)
+    ->Args(256, 1)
+    ->Args(256, 2)
+    ->Args(512, 0)
+    ->Args(512, 1)
+    ->Args(512, 2);
+
+// Builds and writes a minidump file with 5,000 modules and 50,000 memory
+// regions, allocating the tree from the heap (range(0) is 0) or from a
+// pre-reserved arena (range(0) is 1). Building the tree is part of what is
+// measured, so that allocations_per_iteration covers all of the writer
+// objects’ storage.
+void BM_MinidumpWritableArena(BenchmarkState* state) {
+  const bool use_arena = state->range(0) != 0;
+  const size_t kModuleCount = 5000;
+  const size_t kRegionCount = 50000;
+
+  DiscardingFileWriter file_writer;
+  size_t arena_blocks = 0;
+  size_t arena_bytes = 0;
+  while (state->KeepRunning()) {
+    scoped_ptr<Arena> arena;
+    if (use_arena) {
+      arena.reset(new Arena());
+      arena->Reserve(kModuleCount * 1024 + kRegionCount * 256);
+    }
+
+    MemoryListMinidump minidump(arena.get(), kRegionCount, 16);
+
+    MinidumpModuleListWriter* module_list_writer;
+    scoped_ptr<MinidumpModuleListWriter> owned_module_list_writer;
+    PointerVector<MinidumpModuleWriter> owned_module_writers;
+    PointerVector<MinidumpModuleCodeViewRecordPDB70Writer>
+        owned_codeview_records;
+    if (use_arena) {
+      module_list_writer = internal::MinidumpWritable::NewInArena<
+          MinidumpModuleListWriter>(arena.get());
+    } else {
+      owned_module_list_writer.reset(new MinidumpModuleListWriter());
+      module_list_writer = owned_module_list_writer.get();
+    }
+
+    for (size_t index = 0; index < kModuleCount; ++index) {
+      MinidumpModuleWriter* module_writer;
+      MinidumpModuleCodeViewRecordPDB70Writer* codeview_record_writer;
+      if (use_arena) {
+        module_writer = internal::MinidumpWritable::NewInArena<
+            MinidumpModuleWriter>(arena.get());
+        codeview_record_writer = internal::MinidumpWritable::NewInArena<
+            MinidumpModuleCodeViewRecordPDB70Writer>(arena.get());
+      } else {
+        module_writer = new MinidumpModuleWriter();
+        owned_module_writers.push_back(module_writer);
+        codeview_record_writer = new MinidumpModuleCodeViewRecordPDB70Writer();
+        owned_codeview_records.push_back(codeview_record_writer);
+      }
+
+      std::string name = base::StringPrintf("module_%zu", index);
+      module_writer->SetName(name);
+      module_writer->SetImageBaseAddress(0x100000000 + index * 0x10000);
+      module_writer->SetImageSize(0x8000);
+      codeview_record_writer->SetPDBName(name);
+      module_writer->SetCodeViewRecord(codeview_record_writer);
+      module_list_writer->AddModule(module_writer);
+    }
+    minidump.minidump_file()->AddStream(module_list_writer);
+
+    file_writer.Reset();
+    if (!minidump.minidump_file()->WriteEverything(&file_writer)) {
+      state->SkipWithError("WriteEverything failed");
+      return;
+    }
+
+    if (arena) {
+      arena_blocks = arena->block_count();
+      arena_bytes = arena->bytes_used();
+    }
+  }
+
+  state->SetCounter("arena_blocks", arena_blocks);
+  state->SetCounter("arena_bytes", arena_bytes);
+  state->SetBytesProcessed(state->iterations() * file_writer.size());
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWritableArena)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,10 +14,14 @@
 
 #include "minidump/minidump_writable.h"
 
+#include <limits.h>
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "gtest/gtest.h"
 #include "util/file/string_file_writer.h"
 
@@ -73,16 +77,15 @@ class BaseTestMinidumpWritable : public crashpad::internal::MinidumpWritable {
     return has_alignment_ ? alignment_ : MinidumpWritable::Alignment();
   }
 
-  virtual std::vector<MinidumpWritable*> Children() override {
+  virtual size_t ChildCount() override {
     EXPECT_GE(state(), kStateFrozen);
-    if (!children_.empty()) {
-      std::vector<MinidumpWritable*> children;
-      for (BaseTestMinidumpWritable* child : children_) {
-        children.push_back(child);
-      }
-      return children;
-    }
-    return MinidumpWritable::Children();
+    return children_.size();
+  }
+
+  virtual MinidumpWritable* ChildAt(size_t index) override {
+    EXPECT_GE(state(), kStateFrozen);
+    EXPECT_LT(index, children_.size());
+    return children_[index];
   }
 
   virtual Phase WritePhase() override {
@@ -119,12 +122,15 @@ class BaseTestMinidumpWritable : public crashpad::internal::MinidumpWritable {
 
 class TestStringMinidumpWritable final : public BaseTestMinidumpWritable {
  public:
-  TestStringMinidumpWritable() : BaseTestMinidumpWritable(), data_() {}
+  TestStringMinidumpWritable()
+      : BaseTestMinidumpWritable(), data_(), gather_(false) {}
 
   ~TestStringMinidumpWritable() {}
 
   void SetData(const std::string& string) { data_ = string; }
 
+  void SetGather() { gather_ = true; }
+
  protected:
   virtual size_t SizeOfObject() override {
     EXPECT_GE(state(), kStateFrozen);
@@ -133,13 +139,30 @@ class TestStringMinidumpWritable final : public BaseTestMinidumpWritable {
 
   virtual bool WriteObject(FileWriterInterface* file_writer) override {
     BaseTestMinidumpWritable::WriteObject(file_writer);
+    EXPECT_FALSE(gather_);
     bool rv = file_writer->Write(&data_[0], data_.size());
     EXPECT_TRUE(rv);
     return rv;
   }
 
+  virtual bool GatherObject(std::vector<WritableIoVec>* iovecs) override {
+    EXPECT_EQ(state(), kStateWritable);
+    if (!gather_) {
+      return false;
+    }
+
+    if (!data_.empty()) {
+      WritableIoVec iov;
+      iov.iov_base = &data_[0];
+      iov.iov_len = data_.size();
+      iovecs->push_back(iov);
+    }
+    return true;
+  }
+
  private:
   std::string data_;
+  bool gather_;
 
   DISALLOW_COPY_AND_ASSIGN(TestStringMinidumpWritable);
 };
@@ -482,6 +505,141 @@ TEST(MinidumpWritable, MinidumpWritable) {
   }
 }
 
+TEST(MinidumpWritable, GatherObject) {
+  StringFileWriter writer;
+
+  {
+    SCOPED_TRACE("gathered childless");
+    writer.Reset();
+    TestStringMinidumpWritable string_writable;
+    string_writable.SetData("a");
+    string_writable.SetGather();
+    EXPECT_TRUE(string_writable.WriteEverything(&writer));
+    EXPECT_EQ("a", writer.string());
+    string_writable.Verify();
+  }
+
+  {
+    SCOPED_TRACE("gathered family tree");
+    writer.Reset();
+    TestStringMinidumpWritable parent;
+    parent.SetData("P..");
+    TestStringMinidumpWritable child_0;
+    child_0.SetData("C0.");
+    child_0.SetGather();
+    parent.AddChild(&child_0);
+    TestStringMinidumpWritable child_1;
+    child_1.SetData("C1.");
+    parent.AddChild(&child_1);
+    TestStringMinidumpWritable grandchild_00;
+    grandchild_00.SetData("G00");
+    grandchild_00.SetGather();
+    child_0.AddChild(&grandchild_00);
+    TestStringMinidumpWritable grandchild_01;
+    grandchild_01.SetData("G01");
+    child_0.AddChild(&grandchild_01);
+    TestStringMinidumpWritable grandchild_10;
+    grandchild_10.SetData("G10");
+    grandchild_10.SetGather();
+    child_1.AddChild(&grandchild_10);
+    TestStringMinidumpWritable grandchild_11;
+    grandchild_11.SetData("G11");
+    grandchild_11.SetGather();
+    child_1.AddChild(&grandchild_11);
+    EXPECT_TRUE(parent.WriteEverything(&writer));
+    EXPECT_EQ(27u, writer.string().size());
+    EXPECT_EQ(std::string("P..\0C0.\0G00\0G01\0C1.\0G10\0G11", 27),
+              writer.string());
+    parent.Verify();
+  }
+
+  {
+    SCOPED_TRACE("gathered late phase");
+    writer.Reset();
+    TestStringMinidumpWritable parent;
+    parent.SetData("P..");
+    TestStringMinidumpWritable child_0;
+    child_0.SetData("C0.");
+    parent.AddChild(&child_0);
+    TestStringMinidumpWritable child_1;
+    child_1.SetData("C1.");
+    parent.AddChild(&child_1);
+    TestStringMinidumpWritable grandchild_00;
+    grandchild_00.SetData("G00");
+    grandchild_00.SetPhaseLate();
+    grandchild_00.SetGather();
+    child_0.AddChild(&grandchild_00);
+    TestStringMinidumpWritable grandchild_01;
+    grandchild_01.SetData("G01");
+    grandchild_01.SetPhaseLate();
+    grandchild_01.SetGather();
+    grandchild_01.SetAlignment(16);
+    child_0.AddChild(&grandchild_01);
+    TestStringMinidumpWritable grandchild_10;
+    grandchild_10.SetData("G10");
+    child_1.AddChild(&grandchild_10);
+    TestStringMinidumpWritable grandchild_11;
+    grandchild_11.SetData("G11");
+    grandchild_11.SetGather();
+    child_1.AddChild(&grandchild_11);
+    EXPECT_TRUE(parent.WriteEverything(&writer));
+    EXPECT_EQ(35u, writer.string().size());
+    EXPECT_EQ(std::string("P..\0C0.\0C1.\0G10\0G11\0G00\0\0\0\0\0\0\0\0\0G01",
+                          35),
+              writer.string());
+    parent.Verify();
+  }
+}
+
+// Records the largest number of buffers passed to a single WriteIoVec() call.
+class IoVecCountingFileWriter final : public StringFileWriter {
+ public:
+  IoVecCountingFileWriter()
+      : StringFileWriter(), write_io_vec_count_(0), max_iovec_count_(0) {}
+  ~IoVecCountingFileWriter() {}
+
+  size_t write_io_vec_count() const { return write_io_vec_count_; }
+  size_t max_iovec_count() const { return max_iovec_count_; }
+
+  // FileWriterInterface:
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override {
+    ++write_io_vec_count_;
+    max_iovec_count_ = std::max(max_iovec_count_, iovecs->size());
+    return StringFileWriter::WriteIoVec(iovecs);
+  }
+
+ private:
+  size_t write_io_vec_count_;
+  size_t max_iovec_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(IoVecCountingFileWriter);
+};
+
+TEST(MinidumpWritable, GatherObjectBatches) {
+  // Each child and its leading padding account for two buffers, so they don’t
+  // all fit in a single writev().
+  const size_t kChildCount = IOV_MAX;
+  TestStringMinidumpWritable parent;
+  parent.SetData("p");
+  scoped_ptr<TestStringMinidumpWritable[]> children(
+      new TestStringMinidumpWritable[kChildCount]);
+  std::string expected("p\0\0\0", 4);
+  for (size_t index = 0; index < kChildCount; ++index) {
+    children[index].SetData("abc");
+    children[index].SetGather();
+    parent.AddChild(&children[index]);
+    expected.append(index == kChildCount - 1 ? std::string("abc")
+                                             : std::string("abc\0", 4));
+  }
+
+  IoVecCountingFileWriter writer;
+  EXPECT_TRUE(parent.WriteEverything(&writer));
+  EXPECT_EQ(expected, writer.string());
+  EXPECT_EQ(2u, writer.write_io_vec_count());
+  EXPECT_LE(writer.max_iovec_count(), static_cast<size_t>(IOV_MAX));
+  parent.Verify();
+}
+
 class TestRVAMinidumpWritable final : public BaseTestMinidumpWritable {
  public:
   TestRVAMinidumpWritable() : BaseTestMinidumpWritable(), rva_() {}
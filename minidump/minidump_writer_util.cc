@@ -14,10 +14,12 @@
 
 #include "minidump/minidump_writer_util.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
-#include "base/strings/utf_string_conversions.h"
 #include "util/stdlib/strlcpy.h"
+#include "util/stdlib/utf8_to_utf16.h"
 
 namespace crashpad {
 namespace internal {
@@ -34,7 +36,7 @@ void MinidumpWriterUtil::AssignTimeT(uint32_t* destination, time_t source) {
 // static
 string16 MinidumpWriterUtil::ConvertUTF8ToUTF16(const std::string& utf8) {
   string16 utf16;
-  if (!base::UTF8ToUTF16(utf8.data(), utf8.length(), &utf16)) {
+  if (!UTF8ToUTF16(utf8.data(), utf8.length(), &utf16)) {
     LOG(WARNING) << "string " << utf8
                  << " cannot be converted to UTF-16 losslessly";
   }
@@ -45,6 +47,19 @@ string16 MinidumpWriterUtil::ConvertUTF8ToUTF16(const std::string& utf8) {
 void MinidumpWriterUtil::AssignUTF8ToUTF16(char16* destination,
                                            size_t destination_size,
                                            const std::string& source) {
+  if (source.size() < destination_size) {
+    // UTF-16 never requires more code units than UTF-8 requires bytes, so the
+    // converted string is certain to fit, and can be converted in place
+    // without an intermediate string16.
+    size_t length;
+    if (!UTF8ToUTF16(source.data(), source.size(), destination, &length)) {
+      LOG(WARNING) << "string " << source
+                   << " cannot be converted to UTF-16 losslessly";
+    }
+    std::fill(destination + length, destination + destination_size, 0);
+    return;
+  }
+
   string16 source_utf16 = ConvertUTF8ToUTF16(source);
   if (source_utf16.size() > destination_size - 1) {
     LOG(WARNING) << "string " << source << " UTF-16 length "
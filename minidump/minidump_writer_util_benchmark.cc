@@ -0,0 +1,121 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/string16.h"
+#include "minidump/minidump_writer_util.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Builds a string of at least |size| bytes by repeating |unit|.
+std::string RepeatToSize(const std::string& unit, size_t size) {
+  std::string string;
+  while (string.size() < size) {
+    string.append(unit);
+  }
+  return string;
+}
+
+void ConvertUTF8ToUTF16(BenchmarkState* state, const std::string& utf8) {
+  while (state->KeepRunning()) {
+    string16 utf16 = internal::MinidumpWriterUtil::ConvertUTF8ToUTF16(utf8);
+    DoNotOptimize(utf16);
+  }
+  state->SetBytesProcessed(state->iterations() * utf8.size());
+}
+
+// Converts range(0) bytes of ASCII text, typical of module paths.
+void BM_MinidumpWriterUtilConvertUTF8ToUTF16ASCII(BenchmarkState* state) {
+  ConvertUTF8ToUTF16(
+      state, RepeatToSize("/System/Library/Frameworks/", state->range(0)));
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWriterUtilConvertUTF8ToUTF16ASCII)
+    ->Range(8, 4096);
+
+// Converts range(0) bytes of text mixing one-, two-, three-, and four-byte
+// UTF-8 sequences.
+void BM_MinidumpWriterUtilConvertUTF8ToUTF16Mixed(BenchmarkState* state) {
+  ConvertUTF8ToUTF16(
+      state,
+      RepeatToSize("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", state->range(0)));
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWriterUtilConvertUTF8ToUTF16Mixed)
+    ->Range(8, 4096);
+
+// Paths of modules loaded into a typical Mac OS X application process.
+const char* const kModulePaths[] = {
+    "/Applications/Example.app/Contents/MacOS/Example",
+    "/Applications/Example.app/Contents/Frameworks/Example Framework.framework/"
+        "Versions/A/Example Framework",
+    "/System/Library/Frameworks/AppKit.framework/Versions/C/AppKit",
+    "/System/Library/Frameworks/ApplicationServices.framework/Versions/A/"
+        "Frameworks/HIServices.framework/Versions/A/HIServices",
+    "/System/Library/Frameworks/CoreFoundation.framework/Versions/A/"
+        "CoreFoundation",
+    "/System/Library/Frameworks/CoreServices.framework/Versions/A/Frameworks/"
+        "LaunchServices.framework/Versions/A/LaunchServices",
+    "/System/Library/Frameworks/Foundation.framework/Versions/C/Foundation",
+    "/System/Library/Frameworks/IOKit.framework/Versions/A/IOKit",
+    "/System/Library/Frameworks/Security.framework/Versions/A/Security",
+    "/System/Library/PrivateFrameworks/SkyLight.framework/Versions/A/SkyLight",
+    "/usr/lib/libSystem.B.dylib",
+    "/usr/lib/libc++.1.dylib",
+    "/usr/lib/libobjc.A.dylib",
+    "/usr/lib/system/libdyld.dylib",
+    "/usr/lib/system/libsystem_c.dylib",
+    "/usr/lib/system/libsystem_kernel.dylib",
+    "/usr/lib/system/libsystem_malloc.dylib",
+    "/usr/lib/system/libsystem_pthread.dylib",
+    "/Users/Ren\xc3\xa9" "e/Library/Application Support/Example/Plug-ins/"
+        "Beispiel-Erweiterung \xe2\x80\x93 \xc3\x9c" "bersicht.bundle/"
+        "Contents/MacOS/Beispiel",
+    "/Library/Input Methods/\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e.app/"
+        "Contents/MacOS/InputMethod",
+};
+
+// Converts the paths of range(0) modules, as MinidumpModuleWriter does when
+// writing a module list. A process’ module paths are drawn from
+// kModulePaths, which includes a few that aren’t ASCII.
+void BM_MinidumpWriterUtilConvertModulePaths(BenchmarkState* state) {
+  const size_t module_count = state->range(0);
+  std::vector<std::string> paths;
+  size_t total_size = 0;
+  for (size_t index = 0; index < module_count; ++index) {
+    paths.push_back(kModulePaths[index % arraysize(kModulePaths)]);
+    total_size += paths.back().size();
+  }
+
+  while (state->KeepRunning()) {
+    for (const std::string& path : paths) {
+      string16 utf16 = internal::MinidumpWriterUtil::ConvertUTF8ToUTF16(path);
+      DoNotOptimize(utf16);
+    }
+  }
+
+  state->SetItemsProcessed(state->iterations() * module_count);
+  state->SetBytesProcessed(state->iterations() * total_size);
+}
+CRASHPAD_BENCHMARK(BM_MinidumpWriterUtilConvertModulePaths)
+    ->Arg(200)
+    ->Arg(2000);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -43,6 +43,37 @@
         'thread_snapshot.h',
       ],
     },
+    {
+      'target_name': 'snapshot_test_lib',
+      'type': 'static_library',
+      'dependencies': [
+        'snapshot',
+        '../compat/compat.gyp:compat',
+        '../third_party/mini_chromium/mini_chromium/base/base.gyp:base',
+        '../util/util.gyp:util',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'test/synthesized_process.cc',
+        'test/synthesized_process.h',
+        'test/test_cpu_context.cc',
+        'test/test_cpu_context.h',
+        'test/test_exception_snapshot.cc',
+        'test/test_exception_snapshot.h',
+        'test/test_memory_snapshot.cc',
+        'test/test_memory_snapshot.h',
+        'test/test_module_snapshot.cc',
+        'test/test_module_snapshot.h',
+        'test/test_process_snapshot.cc',
+        'test/test_process_snapshot.h',
+        'test/test_system_snapshot.cc',
+        'test/test_system_snapshot.h',
+        'test/test_thread_snapshot.cc',
+        'test/test_thread_snapshot.h',
+      ],
+    },
     {
       'target_name': 'snapshot_test',
       'type': 'executable',
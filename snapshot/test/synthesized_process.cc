@@ -0,0 +1,151 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/test/synthesized_process.h"
+
+#include <sys/time.h>
+
+#include <map>
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "snapshot/test/test_cpu_context.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Stacks grow downward from here, each one separated from its neighbor by a
+// guard page.
+const uint64_t kStackTop = 0x7fff00000000;
+
+// Modules are laid out upward from here, each in its own fixed-size slot.
+const uint64_t kModuleBase = 0x100000000;
+const uint64_t kModuleSize = 0x100000;
+
+const size_t kPageSize = 4096;
+
+size_t RoundUpToPage(size_t size) {
+  return (size + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+}  // namespace
+
+SynthesizedProcessOptions::SynthesizedProcessOptions()
+    : thread_count(1),
+      stack_size(kPageSize),
+      module_count(1),
+      annotations_per_module(0),
+      annotation_value_size(0),
+      exception(false) {
+}
+
+SynthesizedProcess::SynthesizedProcess(
+    const SynthesizedProcessOptions& options)
+    : process_(),
+      system_(),
+      threads_(),
+      stacks_(),
+      modules_(),
+      exception_() {
+  system_.SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_.SetCPURevision(6);
+  system_.SetCPUCount(8);
+  system_.SetCPUVendor("GenuineIntel");
+  system_.SetCPUFrequency(2600000000u, 2600000000u);
+  system_.SetCPUX86Signature(0x000306a9);
+  system_.SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+  system_.SetOSVersion(10, 9, 5, "13F34");
+  system_.SetOSVersionFull("Mac OS X 10.9.5 (13F34)");
+  system_.SetTimeZone(SystemSnapshot::kObservingStandardTime,
+                      -5 * 60 * 60,
+                      -4 * 60 * 60,
+                      "EST",
+                      "EDT");
+
+  process_.SetProcessID(12345);
+  process_.SetParentProcessID(1);
+  timeval snapshot_time = {1412000000, 0};
+  process_.SetSnapshotTime(snapshot_time);
+  timeval start_time = {1411990000, 500000};
+  process_.SetProcessStartTime(start_time);
+  process_.SetSystem(&system_);
+
+  const size_t stack_stride = RoundUpToPage(options.stack_size) + kPageSize;
+  for (size_t index = 0; index < options.thread_count; ++index) {
+    TestThreadSnapshot* thread = new TestThreadSnapshot();
+    threads_.push_back(thread);
+    thread->SetThreadID(0x1000 + index);
+    thread->SetPriority(31);
+    InitializeCPUContextX86_64(thread->MutableContext()->x86_64, index + 1);
+
+    if (options.stack_size) {
+      TestMemorySnapshot* stack = new TestMemorySnapshot();
+      stacks_.push_back(stack);
+      stack->SetAddress(kStackTop - (index + 1) * stack_stride);
+      stack->SetSize(options.stack_size);
+      stack->SetValue(static_cast<char>('a' + index % 26));
+      thread->SetStack(stack);
+    }
+
+    process_.AddThread(thread);
+  }
+
+  for (size_t index = 0; index < options.module_count; ++index) {
+    TestModuleSnapshot* module = new TestModuleSnapshot();
+    modules_.push_back(module);
+    module->SetName(base::StringPrintf(
+        "/usr/lib/libsynthesized_%zu.dylib", index));
+    module->SetAddressAndSize(kModuleBase + index * kModuleSize,
+                              kModuleSize / 2);
+    module->SetModuleType(index == 0
+                              ? ModuleSnapshot::kModuleTypeExecutable
+                              : ModuleSnapshot::kModuleTypeSharedLibrary);
+
+    std::map<std::string, std::string> annotations;
+    for (size_t annotation_index = 0;
+         annotation_index < options.annotations_per_module;
+         ++annotation_index) {
+      annotations[base::StringPrintf("key_%zu", annotation_index)] =
+          std::string(options.annotation_value_size, 'v');
+    }
+    module->SetSimpleAnnotations(annotations);
+
+    process_.AddModule(module);
+  }
+
+  if (options.exception && !threads_.empty()) {
+    exception_.reset(new TestExceptionSnapshot());
+    exception_->SetThreadID(threads_[0]->ThreadID());
+    exception_->SetException(1);  // EXC_BAD_ACCESS
+    exception_->SetExceptionInfo(1);  // KERN_INVALID_ADDRESS
+    exception_->SetExceptionAddress(0xdeadbeef);
+    InitializeCPUContextX86_64(exception_->MutableContext()->x86_64, 1);
+    process_.SetException(exception_.get());
+  }
+}
+
+SynthesizedProcess::~SynthesizedProcess() {
+}
+
+size_t SynthesizedProcess::MemoryBytes() const {
+  size_t memory_bytes = 0;
+  for (size_t index = 0; index < stacks_.size(); ++index) {
+    memory_bytes += stacks_[index]->Size();
+  }
+  return memory_bytes;
+}
+
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,101 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_TEST_SYNTHESIZED_PROCESS_H_
+#define CRASHPAD_SNAPSHOT_TEST_SYNTHESIZED_PROCESS_H_
+
+#include <stddef.h>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "snapshot/process_snapshot.h"
+#include "snapshot/test/test_exception_snapshot.h"
+#include "snapshot/test/test_memory_snapshot.h"
+#include "snapshot/test/test_module_snapshot.h"
+#include "snapshot/test/test_process_snapshot.h"
+#include "snapshot/test/test_system_snapshot.h"
+#include "snapshot/test/test_thread_snapshot.h"
+#include "util/stdlib/pointer_container.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief Describes the shape of a process to be produced by
+//!     SynthesizedProcess.
+struct SynthesizedProcessOptions {
+  SynthesizedProcessOptions();
+
+  //! \brief The number of threads in the process.
+  size_t thread_count;
+
+  //! \brief The size of each thread’s stack, in bytes.
+  //!
+  //! Each thread’s stack is a distinct memory region. Stacks are placed so that
+  //! they do not abut one another, so they are written as separate regions.
+  //! A value of `0` produces threads without stacks.
+  size_t stack_size;
+
+  //! \brief The number of modules loaded in the process.
+  size_t module_count;
+
+  //! \brief The number of simple annotations carried by each module.
+  size_t annotations_per_module;
+
+  //! \brief The length of each annotation’s value, in bytes.
+  size_t annotation_value_size;
+
+  //! \brief Whether the process has an exception. If `true`, the exception
+  //!     occurs on the first thread.
+  bool exception;
+};
+
+//! \brief An in-memory process that provides a complete ProcessSnapshot
+//!     without reference to any real process.
+//!
+//! All of the snapshot objects that make up the process are owned by this
+//! object, and remain valid for its lifetime. The process is x86_64 running on
+//! Mac OS X. Memory contents are produced only when MemorySnapshot::Read() is
+//! called, so processes with large amounts of memory may be synthesized
+//! cheaply.
+//!
+//! This is intended for testing and measuring consumers of ProcessSnapshot,
+//! such as MinidumpFileWriter, on hosts where no native snapshot
+//! implementation is available.
+class SynthesizedProcess {
+ public:
+  explicit SynthesizedProcess(const SynthesizedProcessOptions& options);
+  ~SynthesizedProcess();
+
+  //! \brief Returns the ProcessSnapshot for the synthesized process.
+  const ProcessSnapshot* process_snapshot() const { return &process_; }
+
+  //! \brief Returns the total number of memory bytes that will be produced by
+  //!     reading all of the thread stacks.
+  size_t MemoryBytes() const;
+
+ private:
+  TestProcessSnapshot process_;
+  TestSystemSnapshot system_;
+  PointerVector<TestThreadSnapshot> threads_;
+  PointerVector<TestMemorySnapshot> stacks_;
+  PointerVector<TestModuleSnapshot> modules_;
+  scoped_ptr<TestExceptionSnapshot> exception_;
+
+  DISALLOW_COPY_AND_ASSIGN(SynthesizedProcess);
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_TEST_SYNTHESIZED_PROCESS_H_
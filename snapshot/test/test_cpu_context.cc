@@ -0,0 +1,114 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/test/test_cpu_context.h"
+
+#include <string.h>
+
+#include "base/basictypes.h"
+
+namespace crashpad {
+namespace test {
+
+namespace {
+
+// Fills |size| bytes at |data| with successive values of |*value|, skipping
+// zero so that every byte is nonzero.
+void FillBytes(void* data, size_t size, uint32_t* value) {
+  uint8_t* bytes = static_cast<uint8_t*>(data);
+  for (size_t index = 0; index < size; ++index) {
+    uint8_t byte = static_cast<uint8_t>((*value)++);
+    bytes[index] = byte ? byte : static_cast<uint8_t>((*value)++);
+  }
+}
+
+}  // namespace
+
+void InitializeCPUContextX86(CPUContextX86* context, uint32_t seed) {
+  if (seed == 0) {
+    memset(context, 0, sizeof(*context));
+    return;
+  }
+
+  uint32_t value = seed;
+
+  context->eax = value++;
+  context->ebx = value++;
+  context->ecx = value++;
+  context->edx = value++;
+  context->edi = value++;
+  context->esi = value++;
+  context->ebp = value++;
+  context->esp = value++;
+  context->eip = value++;
+  context->eflags = value++;
+  context->cs = value++;
+  context->ds = value++;
+  context->es = value++;
+  context->fs = value++;
+  context->gs = value++;
+  context->ss = value++;
+  FillBytes(&context->fxsave, sizeof(context->fxsave), &value);
+  context->dr0 = value++;
+  context->dr1 = value++;
+  context->dr2 = value++;
+  context->dr3 = value++;
+  context->dr4 = value++;
+  context->dr5 = value++;
+  context->dr6 = value++;
+  context->dr7 = value++;
+}
+
+void InitializeCPUContextX86_64(CPUContextX86_64* context, uint32_t seed) {
+  if (seed == 0) {
+    memset(context, 0, sizeof(*context));
+    return;
+  }
+
+  uint32_t value = seed;
+
+  context->rax = value++;
+  context->rbx = value++;
+  context->rcx = value++;
+  context->rdx = value++;
+  context->rdi = value++;
+  context->rsi = value++;
+  context->rbp = value++;
+  context->rsp = value++;
+  context->r8 = value++;
+  context->r9 = value++;
+  context->r10 = value++;
+  context->r11 = value++;
+  context->r12 = value++;
+  context->r13 = value++;
+  context->r14 = value++;
+  context->r15 = value++;
+  context->rip = value++;
+  context->rflags = value++;
+  context->cs = value++;
+  context->fs = value++;
+  context->gs = value++;
+  FillBytes(&context->fxsave, sizeof(context->fxsave), &value);
+  context->dr0 = value++;
+  context->dr1 = value++;
+  context->dr2 = value++;
+  context->dr3 = value++;
+  context->dr4 = value++;
+  context->dr5 = value++;
+  context->dr6 = value++;
+  context->dr7 = value++;
+}
+
+}  // namespace test
+}  // namespace crashpad
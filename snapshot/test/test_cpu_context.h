@@ -0,0 +1,43 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_TEST_TEST_CPU_CONTEXT_H_
+#define CRASHPAD_SNAPSHOT_TEST_TEST_CPU_CONTEXT_H_
+
+#include <stdint.h>
+
+#include "snapshot/cpu_context.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief Initializes a context structure for testing.
+//!
+//! \param[out] context The structure to initialize.
+//! \param[in] seed The seed value. Initializing two context structures of the
+//!     same type with identical seed values should produce identical context
+//!     structures. Initialization with a different seed value should produce
+//!     a different context structure. If \a seed is `0`, \a context is zeroed
+//!     out entirely. If \a seed is nonzero, \a context will be populated
+//!     entirely with nonzero values.
+//!
+//! \{
+void InitializeCPUContextX86(CPUContextX86* context, uint32_t seed);
+void InitializeCPUContextX86_64(CPUContextX86_64* context, uint32_t seed);
+//! \}
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_TEST_TEST_CPU_CONTEXT_H_
@@ -0,0 +1,68 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_TEST_TEST_MEMORY_SNAPSHOT_H_
+#define CRASHPAD_SNAPSHOT_TEST_TEST_MEMORY_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "base/basictypes.h"
+#include "snapshot/memory_snapshot.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief A test MemorySnapshot that can carry arbitrary data for testing
+//!     purposes.
+//!
+//! The memory’s contents are a single byte value repeated, and are produced
+//! only when Read() is called, so that large snapshots do not consume memory
+//! until they are read.
+class TestMemorySnapshot final : public MemorySnapshot {
+ public:
+  TestMemorySnapshot();
+  ~TestMemorySnapshot();
+
+  void SetAddress(uint64_t address) { address_ = address; }
+  void SetSize(size_t size) { size_ = size; }
+
+  //! \brief Sets the value to fill the test memory region with.
+  //!
+  //! \param[in] value The value to be written to \a delegate when Read() is
+  //!     called. This value will be repeated Size() times.
+  void SetValue(char value) { value_ = value; }
+
+  //! \brief Returns the number of times that Read() has been called.
+  int read_count() const { return read_count_; }
+
+  // MemorySnapshot:
+
+  virtual uint64_t Address() const override;
+  virtual size_t Size() const override;
+  virtual bool Read(Delegate* delegate) const override;
+
+ private:
+  uint64_t address_;
+  size_t size_;
+  mutable int read_count_;
+  char value_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestMemorySnapshot);
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_TEST_TEST_MEMORY_SNAPSHOT_H_
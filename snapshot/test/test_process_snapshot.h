@@ -0,0 +1,114 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_TEST_TEST_PROCESS_SNAPSHOT_H_
+#define CRASHPAD_SNAPSHOT_TEST_TEST_PROCESS_SNAPSHOT_H_
+
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "snapshot/exception_snapshot.h"
+#include "snapshot/module_snapshot.h"
+#include "snapshot/process_snapshot.h"
+#include "snapshot/system_snapshot.h"
+#include "snapshot/thread_snapshot.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief A test ProcessSnapshot that can carry arbitrary data for testing
+//!     purposes.
+//!
+//! The SystemSnapshot, ThreadSnapshot, ModuleSnapshot, and ExceptionSnapshot
+//! objects provided to this object are not owned by it. The caller must ensure
+//! that they outlive it.
+class TestProcessSnapshot final : public ProcessSnapshot {
+ public:
+  TestProcessSnapshot();
+  ~TestProcessSnapshot();
+
+  void SetProcessID(pid_t process_id) { process_id_ = process_id; }
+  void SetParentProcessID(pid_t parent_process_id) {
+    parent_process_id_ = parent_process_id;
+  }
+  void SetSnapshotTime(const timeval& snapshot_time) {
+    snapshot_time_ = snapshot_time;
+  }
+  void SetProcessStartTime(const timeval& start_time) {
+    process_start_time_ = start_time;
+  }
+  void SetProcessCPUTimes(const timeval& user_time,
+                          const timeval& system_time) {
+    process_cpu_user_time_ = user_time;
+    process_cpu_system_time_ = system_time;
+  }
+
+  //! \brief Sets the system snapshot to be returned by System().
+  //!
+  //! \param[in] system The system snapshot that System() will return.
+  void SetSystem(const SystemSnapshot* system) { system_ = system; }
+
+  //! \brief Adds a thread snapshot to be returned by Threads().
+  //!
+  //! \param[in] thread The thread snapshot that will be included in Threads().
+  void AddThread(const ThreadSnapshot* thread) { threads_.push_back(thread); }
+
+  //! \brief Adds a module snapshot to be returned by Modules().
+  //!
+  //! \param[in] module The module snapshot that will be included in Modules().
+  void AddModule(const ModuleSnapshot* module) { modules_.push_back(module); }
+
+  //! \brief Sets the exception snapshot to be returned by Exception().
+  //!
+  //! \param[in] exception The exception snapshot that Exception() will return,
+  //!     or `NULL` if the snapshot is not a result of an exception.
+  void SetException(const ExceptionSnapshot* exception) {
+    exception_ = exception;
+  }
+
+  // ProcessSnapshot:
+
+  virtual pid_t ProcessID() const override;
+  virtual pid_t ParentProcessID() const override;
+  virtual void SnapshotTime(timeval* snapshot_time) const override;
+  virtual void ProcessStartTime(timeval* start_time) const override;
+  virtual void ProcessCPUTimes(timeval* user_time,
+                               timeval* system_time) const override;
+  virtual const SystemSnapshot* System() const override;
+  virtual std::vector<const ThreadSnapshot*> Threads() const override;
+  virtual std::vector<const ModuleSnapshot*> Modules() const override;
+  virtual const ExceptionSnapshot* Exception() const override;
+
+ private:
+  pid_t process_id_;
+  pid_t parent_process_id_;
+  timeval snapshot_time_;
+  timeval process_start_time_;
+  timeval process_cpu_user_time_;
+  timeval process_cpu_system_time_;
+  const SystemSnapshot* system_;  // weak
+  std::vector<const ThreadSnapshot*> threads_;  // weak
+  std::vector<const ModuleSnapshot*> modules_;  // weak
+  const ExceptionSnapshot* exception_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(TestProcessSnapshot);
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_TEST_TEST_PROCESS_SNAPSHOT_H_
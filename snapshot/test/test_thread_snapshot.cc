@@ -0,0 +1,60 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/test/test_thread_snapshot.h"
+
+namespace crashpad {
+namespace test {
+
+TestThreadSnapshot::TestThreadSnapshot()
+    : context_union_(),
+      context_(),
+      stack_(NULL),
+      thread_id_(0),
+      suspend_count_(0),
+      priority_(0),
+      thread_specific_data_address_(0) {
+  context_.architecture = kCPUArchitectureX86_64;
+  context_.x86_64 = &context_union_.x86_64;
+}
+
+TestThreadSnapshot::~TestThreadSnapshot() {
+}
+
+const CPUContext* TestThreadSnapshot::Context() const {
+  return &context_;
+}
+
+const MemorySnapshot* TestThreadSnapshot::Stack() const {
+  return stack_;
+}
+
+uint64_t TestThreadSnapshot::ThreadID() const {
+  return thread_id_;
+}
+
+int TestThreadSnapshot::SuspendCount() const {
+  return suspend_count_;
+}
+
+int TestThreadSnapshot::Priority() const {
+  return priority_;
+}
+
+uint64_t TestThreadSnapshot::ThreadSpecificDataAddress() const {
+  return thread_specific_data_address_;
+}
+
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,86 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_TEST_TEST_THREAD_SNAPSHOT_H_
+#define CRASHPAD_SNAPSHOT_TEST_TEST_THREAD_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include "base/basictypes.h"
+#include "snapshot/cpu_context.h"
+#include "snapshot/memory_snapshot.h"
+#include "snapshot/thread_snapshot.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief A test ThreadSnapshot that can carry arbitrary data for testing
+//!     purposes.
+class TestThreadSnapshot final : public ThreadSnapshot {
+ public:
+  TestThreadSnapshot();
+  ~TestThreadSnapshot();
+
+  //! \brief Obtains a pointer to the underlying mutable CPUContext structure.
+  //!
+  //! This method is intended to be used by callers to populate the CPUContext
+  //! structure. The structure’s architecture is initially
+  //! kCPUArchitectureX86_64, and its storage is large enough for any supported
+  //! architecture, so the architecture may be changed.
+  //!
+  //! \return The same pointer that Context() does, while treating the data as
+  //!     mutable.
+  CPUContext* MutableContext() { return &context_; }
+
+  //! \brief Sets the memory region that contains the thread’s stack.
+  //!
+  //! \param[in] stack The memory region, which the caller continues to own, or
+  //!     `NULL` for a thread without a stack.
+  void SetStack(const MemorySnapshot* stack) { stack_ = stack; }
+
+  void SetThreadID(uint64_t thread_id) { thread_id_ = thread_id; }
+  void SetSuspendCount(int suspend_count) { suspend_count_ = suspend_count; }
+  void SetPriority(int priority) { priority_ = priority; }
+  void SetThreadSpecificDataAddress(uint64_t thread_specific_data_address) {
+    thread_specific_data_address_ = thread_specific_data_address;
+  }
+
+  // ThreadSnapshot:
+
+  virtual const CPUContext* Context() const override;
+  virtual const MemorySnapshot* Stack() const override;
+  virtual uint64_t ThreadID() const override;
+  virtual int SuspendCount() const override;
+  virtual int Priority() const override;
+  virtual uint64_t ThreadSpecificDataAddress() const override;
+
+ private:
+  union {
+    CPUContextX86 x86;
+    CPUContextX86_64 x86_64;
+  } context_union_;
+  CPUContext context_;
+  const MemorySnapshot* stack_;  // weak
+  uint64_t thread_id_;
+  int suspend_count_;
+  int priority_;
+  uint64_t thread_specific_data_address_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestThreadSnapshot);
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_TEST_TEST_THREAD_SNAPSHOT_H_
@@ -0,0 +1,175 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/buffered_file_writer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+
+namespace crashpad {
+
+const size_t BufferedFileWriter::kDefaultBufferSize;
+
+BufferedFileWriter::BufferedFileWriter(FileWriterInterface* file_writer)
+    : BufferedFileWriter(file_writer, kDefaultBufferSize) {
+}
+
+BufferedFileWriter::BufferedFileWriter(FileWriterInterface* file_writer,
+                                       size_t buffer_size)
+    : file_writer_(file_writer),
+      buffer_(new uint8_t[buffer_size]),
+      buffer_size_(buffer_size),
+      buffer_used_(0),
+      buffer_queued_(0),
+      downstream_write_count_(0) {
+  DCHECK_GT(buffer_size_, 0u);
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+  // Any failure will have been logged. There’s no way to report it from here.
+  Flush();
+}
+
+bool BufferedFileWriter::Flush() {
+  std::vector<WritableIoVec> pass_through;
+  return FlushPassThrough(&pass_through);
+}
+
+bool BufferedFileWriter::Write(const void* data, size_t size) {
+  std::vector<WritableIoVec> pass_through;
+  return WriteInternal(data, size, &pass_through) &&
+         (pass_through.empty() || FlushPassThrough(&pass_through));
+}
+
+bool BufferedFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  // Large iovecs are collected so that they can all be passed on in a single
+  // call, interleaved with whatever small ones were buffered between them.
+  std::vector<WritableIoVec> pass_through;
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!WriteInternal(iov.iov_base, iov.iov_len, &pass_through)) {
+      return false;
+    }
+  }
+
+  if (!pass_through.empty() && !FlushPassThrough(&pass_through)) {
+    return false;
+  }
+
+#ifndef NDEBUG
+  // The interface says that |iovecs| is not sacred, so scramble it to make sure
+  // that nobody depends on it.
+  memset(&(*iovecs)[0], 0xa5, sizeof((*iovecs)[0]) * iovecs->size());
+#endif
+
+  return true;
+}
+
+off_t BufferedFileWriter::Seek(off_t offset, int whence) {
+  if (!Flush()) {
+    return -1;
+  }
+
+  return file_writer_->Seek(offset, whence);
+}
+
+bool BufferedFileWriter::WillWrite(size_t size) {
+  // The underlying file writer’s position trails this object’s by the amount
+  // of buffered data.
+  base::CheckedNumeric<size_t> downstream_size = buffer_used_;
+  downstream_size += size;
+  if (!downstream_size.IsValid()) {
+    LOG(ERROR) << "WillWrite(): file too large";
+    return false;
+  }
+
+  return file_writer_->WillWrite(downstream_size.ValueOrDie());
+}
+
+bool BufferedFileWriter::WriteInternal(
+    const void* data,
+    size_t size,
+    std::vector<WritableIoVec>* pass_through) {
+  if (size == 0) {
+    return true;
+  }
+
+  if (size >= buffer_size_ / 2) {
+    // Copying this much data wouldn’t save anything. Pass it through, preceded
+    // by any buffered data not yet queued. The buffered data is left in place,
+    // and only space beyond it is used until |pass_through| is written.
+    WritableIoVec iov;
+    if (buffer_used_ > buffer_queued_) {
+      iov.iov_base = buffer_.get() + buffer_queued_;
+      iov.iov_len = buffer_used_ - buffer_queued_;
+      pass_through->push_back(iov);
+      buffer_queued_ = buffer_used_;
+    }
+
+    iov.iov_base = data;
+    iov.iov_len = size;
+    pass_through->push_back(iov);
+    return true;
+  }
+
+  const uint8_t* data_c = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    const size_t copy_size = std::min(size, buffer_size_ - buffer_used_);
+    memcpy(buffer_.get() + buffer_used_, data_c, copy_size);
+    buffer_used_ += copy_size;
+    data_c += copy_size;
+    size -= copy_size;
+
+    if (buffer_used_ == buffer_size_ && !FlushPassThrough(pass_through)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool BufferedFileWriter::FlushPassThrough(
+    std::vector<WritableIoVec>* pass_through) {
+  if (buffer_used_ > buffer_queued_) {
+    WritableIoVec iov;
+    iov.iov_base = buffer_.get() + buffer_queued_;
+    iov.iov_len = buffer_used_ - buffer_queued_;
+    pass_through->push_back(iov);
+  }
+
+  buffer_used_ = 0;
+  buffer_queued_ = 0;
+
+  if (pass_through->empty()) {
+    return true;
+  }
+
+  ++downstream_write_count_;
+  bool rv = pass_through->size() == 1
+                ? file_writer_->Write((*pass_through)[0].iov_base,
+                                      (*pass_through)[0].iov_len)
+                : file_writer_->WriteIoVec(pass_through);
+  pass_through->clear();
+  return rv;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,114 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_BUFFERED_FILE_WRITER_H_
+#define CRASHPAD_UTIL_FILE_BUFFERED_FILE_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief A file writer that coalesces small writes before passing them on to
+//!     another FileWriterInterface.
+//!
+//! Writers such as MinidumpWritable produce many small writes: alignment
+//! padding, structure headers, and short records, each of which would
+//! otherwise cost a system call when written to a FileWriter. This class
+//! copies small writes into a buffer, and passes the buffer on only once it is
+//! full, so that a run of small writes reaches the underlying file writer in
+//! blocks of exactly the buffer size. Writes of at least half of the buffer
+//! size are not copied, but are passed on along with any buffered data in a
+//! single WriteIoVec() call.
+//!
+//! Seek() flushes buffered data before seeking the underlying file writer.
+//! Buffered data is also flushed by Flush() and on destruction.
+class BufferedFileWriter final : public FileWriterInterface {
+ public:
+  //! \brief The default size of the buffer.
+  static const size_t kDefaultBufferSize = 64 * 1024;
+
+  //! \param[in] file_writer The file writer to write to. This object does not
+  //!     take ownership of \a file_writer, which must outlive it.
+  explicit BufferedFileWriter(FileWriterInterface* file_writer);
+
+  //! \param[in] file_writer The file writer to write to. This object does not
+  //!     take ownership of \a file_writer, which must outlive it.
+  //! \param[in] buffer_size The size of the buffer. This must not be `0`.
+  BufferedFileWriter(FileWriterInterface* file_writer, size_t buffer_size);
+
+  //! \brief Flushes buffered data, logging any failure.
+  ~BufferedFileWriter();
+
+  //! \brief Passes all buffered data on to the underlying file writer.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  bool Flush();
+
+  //! \brief Returns the number of write operations that have been passed on to
+  //!     the underlying file writer.
+  //!
+  //! When the underlying file writer is a FileWriter, this is the number of
+  //! `write()` and `writev()` system calls made on this object’s behalf,
+  //! disregarding short writes.
+  uint64_t downstream_write_count() const { return downstream_write_count_; }
+
+  // FileWriterInterface:
+  virtual bool Write(const void* data, size_t size) override;
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+  virtual off_t Seek(off_t offset, int whence) override;
+  virtual bool WillWrite(size_t size) override;
+
+ private:
+  //! \brief Writes \a size bytes of \a data, either by copying them into the
+  //!     buffer or, if they are large enough, by adding them to
+  //!     \a pass_through along with any buffered data.
+  //!
+  //! Data added to \a pass_through is not written until \a pass_through is
+  //! passed to FlushPassThrough(). Until then, the buffered data that
+  //! \a pass_through refers to is not disturbed.
+  bool WriteInternal(const void* data,
+                     size_t size,
+                     std::vector<WritableIoVec>* pass_through);
+
+  //! \brief Writes \a pass_through, if it is not empty, along with the
+  //!     remaining buffered data, leaving the buffer empty.
+  bool FlushPassThrough(std::vector<WritableIoVec>* pass_through);
+
+  FileWriterInterface* file_writer_;  // weak
+  scoped_ptr<uint8_t[]> buffer_;
+  size_t buffer_size_;
+
+  //! \brief The number of bytes of #buffer_ that are in use.
+  size_t buffer_used_;
+
+  //! \brief The number of bytes at the beginning of #buffer_ that have already
+  //!     been added to a pass-through list by WriteInternal().
+  size_t buffer_queued_;
+
+  uint64_t downstream_write_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferedFileWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_BUFFERED_FILE_WRITER_H_
@@ -0,0 +1,189 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/buffered_file_writer.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file_writer.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// A StringFileWriter that records the size most recently announced by
+// WillWrite().
+class WillWriteRecordingFileWriter final : public StringFileWriter {
+ public:
+  WillWriteRecordingFileWriter() : StringFileWriter(), will_write_size_(0) {}
+  ~WillWriteRecordingFileWriter() {}
+
+  size_t will_write_size() const { return will_write_size_; }
+
+  // StringFileWriter:
+  virtual bool WillWrite(size_t size) override {
+    will_write_size_ = size;
+    return StringFileWriter::WillWrite(size);
+  }
+
+ private:
+  size_t will_write_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(WillWriteRecordingFileWriter);
+};
+
+TEST(BufferedFileWriter, SmallWrites) {
+  StringFileWriter string_file_writer;
+  BufferedFileWriter writer(&string_file_writer, 16);
+
+  std::string expected;
+  for (size_t index = 0; index < 40; ++index) {
+    const char c = 'a' + (index % 26);
+    EXPECT_TRUE(writer.Write(&c, 1));
+    expected.push_back(c);
+  }
+
+  // Only full buffers have been passed on.
+  EXPECT_EQ(expected.substr(0, 32), string_file_writer.string());
+  EXPECT_EQ(2u, writer.downstream_write_count());
+
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(expected, string_file_writer.string());
+  EXPECT_EQ(3u, writer.downstream_write_count());
+
+  // Flushing again with nothing buffered does nothing.
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(3u, writer.downstream_write_count());
+
+  // Writes that straddle the end of the buffer are split to fill it.
+  EXPECT_TRUE(writer.Write("0123456", 7));
+  EXPECT_TRUE(writer.Write("789abcd", 7));
+  EXPECT_TRUE(writer.Write("efghijk", 7));
+  EXPECT_EQ(expected + "0123456789abcdef", string_file_writer.string());
+  EXPECT_EQ(4u, writer.downstream_write_count());
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(expected + "0123456789abcdefghijk", string_file_writer.string());
+  EXPECT_EQ(5u, writer.downstream_write_count());
+}
+
+TEST(BufferedFileWriter, LargeWrites) {
+  StringFileWriter string_file_writer;
+  BufferedFileWriter writer(&string_file_writer, 16);
+
+  // A large write is passed on right away, together with buffered data.
+  EXPECT_TRUE(writer.Write("abc", 3));
+  EXPECT_TRUE(string_file_writer.string().empty());
+  EXPECT_TRUE(writer.Write("0123456789", 10));
+  EXPECT_EQ("abc0123456789", string_file_writer.string());
+  EXPECT_EQ(1u, writer.downstream_write_count());
+
+  // With nothing buffered, it’s passed on alone.
+  EXPECT_TRUE(writer.Write("ABCDEFGH", 8));
+  EXPECT_EQ("abc0123456789ABCDEFGH", string_file_writer.string());
+  EXPECT_EQ(2u, writer.downstream_write_count());
+
+  // Zero-length writes are ignored.
+  EXPECT_TRUE(writer.Write("", 0));
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(2u, writer.downstream_write_count());
+}
+
+TEST(BufferedFileWriter, WriteIoVec) {
+  StringFileWriter string_file_writer;
+  BufferedFileWriter writer(&string_file_writer, 16);
+
+  std::vector<WritableIoVec> iovecs;
+  EXPECT_FALSE(writer.WriteIoVec(&iovecs));
+
+  // Small and large iovecs are interleaved, and all are passed on in a single
+  // operation, in order.
+  const char* const kData[] = {
+      "ab", "0123456789", "cd", "e", "ABCDEFGHIJKLMNOPQRSTUVWXYZ", "f"};
+  std::string expected;
+  for (const char* data : kData) {
+    WritableIoVec iov;
+    iov.iov_base = data;
+    iov.iov_len = strlen(data);
+    iovecs.push_back(iov);
+    expected.append(data);
+  }
+  EXPECT_TRUE(writer.WriteIoVec(&iovecs));
+  EXPECT_EQ(expected, string_file_writer.string());
+  EXPECT_EQ(1u, writer.downstream_write_count());
+
+  // Small iovecs alone are buffered.
+  iovecs.clear();
+  WritableIoVec iov;
+  iov.iov_base = "gh";
+  iov.iov_len = 2;
+  iovecs.push_back(iov);
+  iovecs.push_back(iov);
+  EXPECT_TRUE(writer.WriteIoVec(&iovecs));
+  EXPECT_EQ(expected, string_file_writer.string());
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(expected + "ghgh", string_file_writer.string());
+  EXPECT_EQ(2u, writer.downstream_write_count());
+}
+
+TEST(BufferedFileWriter, Seek) {
+  StringFileWriter string_file_writer;
+  BufferedFileWriter writer(&string_file_writer, 16);
+
+  EXPECT_TRUE(writer.Write("abcd", 4));
+  EXPECT_TRUE(string_file_writer.string().empty());
+
+  // Seeking flushes buffered data first, so that positions are correct.
+  EXPECT_EQ(4, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ("abcd", string_file_writer.string());
+
+  EXPECT_EQ(1, writer.Seek(1, SEEK_SET));
+  EXPECT_TRUE(writer.Write("xy", 2));
+  EXPECT_EQ("abcd", string_file_writer.string());
+  EXPECT_EQ(3, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ("axyd", string_file_writer.string());
+
+  EXPECT_EQ(6, writer.Seek(2, SEEK_END));
+  EXPECT_TRUE(writer.Write("z", 1));
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(std::string("axyd\0\0z", 7), string_file_writer.string());
+}
+
+TEST(BufferedFileWriter, WillWrite) {
+  WillWriteRecordingFileWriter string_file_writer;
+  BufferedFileWriter writer(&string_file_writer, 16);
+
+  // The underlying file writer must be told about buffered data too, because
+  // it hasn’t seen it yet.
+  EXPECT_TRUE(writer.Write("abc", 3));
+  EXPECT_TRUE(writer.WillWrite(10));
+  EXPECT_EQ(13u, string_file_writer.will_write_size());
+}
+
+TEST(BufferedFileWriter, Destructor) {
+  StringFileWriter string_file_writer;
+  {
+    BufferedFileWriter writer(&string_file_writer);
+    EXPECT_TRUE(writer.Write("abc", 3));
+    EXPECT_TRUE(string_file_writer.string().empty());
+  }
+  EXPECT_EQ("abc", string_file_writer.string());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
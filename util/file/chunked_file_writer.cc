@@ -0,0 +1,295 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/chunked_file_writer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+const size_t ChunkedFileWriter::kMinimumBlockSize;
+const size_t ChunkedFileWriter::kMaximumBlockSize;
+
+ChunkedFileWriter::ChunkedFileWriter()
+    : blocks_(), last_block_index_(0), capacity_(0), size_(0), offset_(0) {
+}
+
+ChunkedFileWriter::~ChunkedFileWriter() {
+  for (const Block& block : blocks_) {
+    if (!block.external) {
+      delete[] block.data;
+    }
+  }
+}
+
+void ChunkedFileWriter::SetExternalBuffer(void* buffer, size_t size) {
+  DCHECK(blocks_.empty());
+  DCHECK_EQ(size_, 0u);
+
+  if (size == 0) {
+    return;
+  }
+
+  Block block;
+  block.data = reinterpret_cast<uint8_t*>(buffer);
+  block.offset = 0;
+  block.size = size;
+  block.external = true;
+  blocks_.push_back(block);
+  capacity_ = size;
+}
+
+void ChunkedFileWriter::Reserve(size_t capacity) {
+  if (capacity > capacity_) {
+    AddBlock(capacity - capacity_);
+  }
+}
+
+void ChunkedFileWriter::GetIoVecs(std::vector<WritableIoVec>* iovecs) const {
+  for (const Block& block : blocks_) {
+    if (block.offset >= size_) {
+      break;
+    }
+
+    WritableIoVec iov;
+    iov.iov_base = block.data;
+    iov.iov_len = std::min(block.size, size_ - block.offset);
+    iovecs->push_back(iov);
+  }
+}
+
+bool ChunkedFileWriter::WriteTo(FileWriterInterface* file_writer) const {
+  if (size_ == 0) {
+    return true;
+  }
+
+  std::vector<WritableIoVec> iovecs;
+  GetIoVecs(&iovecs);
+  return file_writer->WriteIoVec(&iovecs);
+}
+
+std::string ChunkedFileWriter::ToString() const {
+  std::string contents;
+  contents.reserve(size_);
+
+  std::vector<WritableIoVec> iovecs;
+  GetIoVecs(&iovecs);
+  for (const WritableIoVec& iov : iovecs) {
+    contents.append(reinterpret_cast<const char*>(iov.iov_base), iov.iov_len);
+  }
+
+  return contents;
+}
+
+void ChunkedFileWriter::Reset() {
+  size_ = 0;
+  offset_ = 0;
+  last_block_index_ = 0;
+}
+
+bool ChunkedFileWriter::Write(const void* data, size_t size) {
+  DCHECK(offset_.IsValid());
+
+  base::CheckedNumeric<ssize_t> new_offset = offset_;
+  new_offset += size;
+  if (!new_offset.IsValid()) {
+    LOG(ERROR) << "Write(): file too large";
+    return false;
+  }
+
+  const size_t offset = offset_.ValueOrDie();
+  const size_t end = offset + size;
+
+  if (end > capacity_) {
+    // Grow in proportion to the current capacity so that the number of blocks
+    // stays small for large files, without ever moving existing data.
+    AddBlock(std::max(end - capacity_,
+                      std::min(std::max(capacity_, kMinimumBlockSize),
+                               kMaximumBlockSize)));
+  }
+
+  if (offset > size_) {
+    // Storage past the end of the file may hold stale data from before a
+    // Reset(), so holes left by seeking past the end must be cleared.
+    CopyIn(size_, NULL, offset - size_);
+  }
+
+  CopyIn(offset, data, size);
+  size_ = std::max(size_, end);
+  offset_ = end;
+
+  return true;
+}
+
+bool ChunkedFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  DCHECK(offset_.IsValid());
+
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  // Avoid writing anything at all if it would cause an overflow.
+  base::CheckedNumeric<ssize_t> new_offset = offset_;
+  for (const WritableIoVec& iov : *iovecs) {
+    new_offset += iov.iov_len;
+    if (!new_offset.IsValid()) {
+      LOG(ERROR) << "WriteIoVec(): file too large";
+      return false;
+    }
+  }
+
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!Write(iov.iov_base, iov.iov_len)) {
+      return false;
+    }
+  }
+
+#ifndef NDEBUG
+  // The interface says that |iovecs| is not sacred, so scramble it to make sure
+  // that nobody depends on it.
+  memset(&(*iovecs)[0], 0xa5, sizeof((*iovecs)[0]) * iovecs->size());
+#endif
+
+  return true;
+}
+
+off_t ChunkedFileWriter::Seek(off_t offset, int whence) {
+  DCHECK(offset_.IsValid());
+
+  size_t base_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+
+    case SEEK_CUR:
+      base_offset = offset_.ValueOrDie();
+      break;
+
+    case SEEK_END:
+      base_offset = size_;
+      break;
+
+    default:
+      LOG(ERROR) << "Seek(): invalid whence " << whence;
+      return -1;
+  }
+
+  off_t base_offset_offt;
+  if (!AssignIfInRange(&base_offset_offt, base_offset)) {
+    LOG(ERROR) << "Seek(): base_offset " << base_offset << " invalid for off_t";
+    return -1;
+  }
+  base::CheckedNumeric<off_t> new_offset(base_offset_offt);
+  new_offset += offset;
+  if (!new_offset.IsValid()) {
+    LOG(ERROR) << "Seek(): new_offset invalid";
+    return -1;
+  }
+  off_t new_offset_offt = new_offset.ValueOrDie();
+  size_t new_offset_sizet;
+  if (!AssignIfInRange(&new_offset_sizet, new_offset_offt)) {
+    LOG(ERROR) << "Seek(): new_offset " << new_offset_offt
+               << " invalid for size_t";
+    return -1;
+  }
+
+  offset_ = new_offset_sizet;
+
+  return offset_.ValueOrDie();
+}
+
+bool ChunkedFileWriter::WillWrite(size_t size) {
+  DCHECK(offset_.IsValid());
+
+  base::CheckedNumeric<size_t> end = offset_;
+  end += size;
+  if (!end.IsValid()) {
+    LOG(ERROR) << "WillWrite(): file too large";
+    return false;
+  }
+
+  Reserve(end.ValueOrDie());
+  return true;
+}
+
+void ChunkedFileWriter::AddBlock(size_t size) {
+  Block block;
+  block.data = new uint8_t[size];
+  block.offset = capacity_;
+  block.size = size;
+  block.external = false;
+  blocks_.push_back(block);
+  capacity_ += size;
+}
+
+size_t ChunkedFileWriter::BlockIndexForOffset(size_t offset) {
+  DCHECK_LT(offset, capacity_);
+
+  const Block& last_block = blocks_[last_block_index_];
+  if (offset >= last_block.offset &&
+      offset - last_block.offset < last_block.size) {
+    return last_block_index_;
+  }
+
+  // Find the first block that begins beyond |offset|. The block before it
+  // holds |offset|.
+  auto it = std::upper_bound(
+      blocks_.begin(),
+      blocks_.end(),
+      offset,
+      [](size_t offset, const Block& block) { return offset < block.offset; });
+  DCHECK(it != blocks_.begin());
+  last_block_index_ = (it - blocks_.begin()) - 1;
+  return last_block_index_;
+}
+
+void ChunkedFileWriter::CopyIn(size_t offset, const void* data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  DCHECK_LE(offset + size, capacity_);
+
+  const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+  size_t index = BlockIndexForOffset(offset);
+  while (size > 0) {
+    const Block& block = blocks_[index];
+    const size_t block_offset = offset - block.offset;
+    const size_t copy_size = std::min(size, block.size - block_offset);
+    if (source) {
+      memcpy(block.data + block_offset, source, copy_size);
+      source += copy_size;
+    } else {
+      memset(block.data + block_offset, 0, copy_size);
+    }
+
+    offset += copy_size;
+    size -= copy_size;
+    if (size > 0) {
+      ++index;
+    }
+  }
+
+  last_block_index_ = index;
+}
+
+}  // namespace crashpad
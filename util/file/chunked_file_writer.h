@@ -0,0 +1,172 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_CHUNKED_FILE_WRITER_H_
+#define CRASHPAD_UTIL_FILE_CHUNKED_FILE_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/numerics/safe_math.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief A file writer backed by a virtual file held in memory as a sequence
+//!     of discontiguous blocks.
+//!
+//! StringFileWriter keeps its virtual file in a single `std::string`, which
+//! must be reallocated and copied as the file grows. This class never moves
+//! data once it has been written. It grows by appending new blocks, and its
+//! contents can be obtained as a list of WritableIoVec structures suitable for
+//! passing directly to another FileWriterInterface without first being
+//! flattened into a single buffer. This makes it suitable for holding large
+//! files, such as minidumps that are produced in memory for upload.
+//!
+//! The first block may optionally be provided by the caller, for example, as a
+//! region obtained from `mmap()`. See SetExternalBuffer().
+class ChunkedFileWriter : public FileWriterInterface {
+ public:
+  //! \brief The smallest block that will be allocated to satisfy a write.
+  static const size_t kMinimumBlockSize = 64 * 1024;
+
+  //! \brief The largest block that will be allocated to satisfy a write,
+  //!     unless the write itself requires a larger one.
+  //!
+  //! Block sizes grow with the size of the virtual file up to this limit, so
+  //! that the number of blocks, and thus the number of iovecs returned by
+  //! GetIoVecs(), grows only slowly.
+  static const size_t kMaximumBlockSize = 16 * 1024 * 1024;
+
+  ChunkedFileWriter();
+  ~ChunkedFileWriter();
+
+  //! \brief Uses caller-provided storage as the virtual file’s first block.
+  //!
+  //! This method may only be called before anything has been written to the
+  //! virtual file and before Reserve() has been called. Writes that do not fit
+  //! within \a buffer will be placed in blocks allocated by this object.
+  //!
+  //! \param[in] buffer The storage to use. This object does not take ownership
+  //!     of \a buffer, which must remain valid for the lifetime of this object.
+  //! \param[in] size The size of \a buffer.
+  void SetExternalBuffer(void* buffer, size_t size);
+
+  //! \brief Ensures that storage is available for a virtual file of at least
+  //!     \a capacity bytes.
+  //!
+  //! Once this method returns, writes that do not extend the virtual file
+  //! beyond \a capacity bytes will not allocate memory. Callers that know the
+  //! final size of the file in advance should call this method before writing
+  //! to it, so that the file is stored in as few blocks as possible.
+  void Reserve(size_t capacity);
+
+  //! \brief Returns the size of the virtual file.
+  size_t size() const { return size_; }
+
+  //! \brief Returns the number of bytes that the virtual file can grow to
+  //!     without allocating memory.
+  size_t capacity() const { return capacity_; }
+
+  //! \brief Appends WritableIoVec structures that describe the virtual file’s
+  //!     contents, in order, to \a iovecs.
+  //!
+  //! The iovecs point into this object’s storage. They remain valid until
+  //! this object is next modified or destroyed.
+  void GetIoVecs(std::vector<WritableIoVec>* iovecs) const;
+
+  //! \brief Writes the virtual file’s contents to \a file_writer at its
+  //!     current position, without copying them into an intermediate buffer.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool WriteTo(FileWriterInterface* file_writer) const;
+
+  //! \brief Returns a string containing a copy of the virtual file’s contents.
+  //!
+  //! This flattens the virtual file, and is mainly intended for tests.
+  std::string ToString() const;
+
+  //! \brief Resets the virtual file’s contents to be empty, and resets its file
+  //!     position to `0`.
+  //!
+  //! Storage that has already been allocated is retained for reuse.
+  void Reset();
+
+  // FileWriterInterface:
+  virtual bool Write(const void* data, size_t size) override;
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+  virtual off_t Seek(off_t offset, int whence) override;
+  virtual bool WillWrite(size_t size) override;
+
+ private:
+  //! \brief A contiguous region of storage for the virtual file.
+  struct Block {
+    //! \brief The storage. This is owned by this object unless #external is
+    //!     `true`.
+    uint8_t* data;
+
+    //! \brief The offset within the virtual file that `data[0]` corresponds
+    //!     to.
+    size_t offset;
+
+    //! \brief The size of #data.
+    size_t size;
+
+    //! \brief Whether #data was provided by SetExternalBuffer().
+    bool external;
+  };
+
+  //! \brief Appends a block of \a size bytes to #blocks_.
+  void AddBlock(size_t size);
+
+  //! \brief Returns the index into #blocks_ of the block that holds \a offset,
+  //!     which must be less than #capacity_.
+  size_t BlockIndexForOffset(size_t offset);
+
+  //! \brief Copies \a size bytes of \a data into storage beginning at
+  //!     \a offset, which must already be backed by blocks. If \a data is
+  //!     `NULL`, zeroes are stored instead.
+  void CopyIn(size_t offset, const void* data, size_t size);
+
+  //! \brief The storage for the virtual file, ordered by Block::offset with no
+  //!     gaps between blocks.
+  std::vector<Block> blocks_;
+
+  //! \brief The index into #blocks_ of the block most recently written to.
+  //!
+  //! Most writes are sequential, so this is checked before searching.
+  size_t last_block_index_;
+
+  //! \brief The total size of all of the blocks in #blocks_.
+  size_t capacity_;
+
+  //! \brief The size of the virtual file.
+  //!
+  //! Storage beyond this point has unspecified contents, and is cleared when a
+  //! write following a seek past the end of the file leaves a hole.
+  size_t size_;
+
+  //! \brief The file offset of the virtual file.
+  base::CheckedNumeric<size_t> offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChunkedFileWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_CHUNKED_FILE_WRITER_H_
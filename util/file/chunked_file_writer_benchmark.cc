@@ -0,0 +1,112 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "util/file/chunked_file_writer.h"
+#include "util/file/string_file_writer.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const size_t kTotalSize = 4 * 1024 * 1024;
+
+// Grows a new ChunkedFileWriter to 4MB with writes of range(0) bytes each.
+// Compare with BM_StringFileWriterGrowth.
+void BM_ChunkedFileWriterGrowth(BenchmarkState* state) {
+  const size_t write_size = state->range(0);
+  const std::string data(write_size, 'g');
+
+  while (state->KeepRunning()) {
+    ChunkedFileWriter file_writer;
+    for (size_t written = 0; written < kTotalSize; written += write_size) {
+      if (!file_writer.Write(data.data(), data.size())) {
+        state->SkipWithError("Write failed");
+        return;
+      }
+    }
+    DoNotOptimize(file_writer);
+  }
+
+  state->SetBytesProcessed(state->iterations() * kTotalSize);
+}
+CRASHPAD_BENCHMARK(BM_ChunkedFileWriterGrowth)->Range(16, 64 * 1024);
+
+// As BM_ChunkedFileWriterGrowth, but with the full size reserved up front.
+void BM_ChunkedFileWriterReserved(BenchmarkState* state) {
+  const size_t write_size = state->range(0);
+  const std::string data(write_size, 'r');
+
+  while (state->KeepRunning()) {
+    ChunkedFileWriter file_writer;
+    file_writer.Reserve(kTotalSize);
+    for (size_t written = 0; written < kTotalSize; written += write_size) {
+      if (!file_writer.Write(data.data(), data.size())) {
+        state->SkipWithError("Write failed");
+        return;
+      }
+    }
+    DoNotOptimize(file_writer);
+  }
+
+  state->SetBytesProcessed(state->iterations() * kTotalSize);
+}
+CRASHPAD_BENCHMARK(BM_ChunkedFileWriterReserved)->Arg(16)->Arg(4096);
+
+// Produces a 4MB file in memory and hands it to another writer, as an upload
+// would. StringFileWriter (range(0) == 0) must hand over its flattened string.
+// ChunkedFileWriter (range(0) == 1) hands over its blocks as iovecs.
+void BM_InMemoryFileHandoff(BenchmarkState* state) {
+  const bool chunked = state->range(0) != 0;
+  const size_t kWriteSize = 4096;
+  const std::string data(kWriteSize, 'h');
+
+  StringFileWriter destination;
+  destination.Reserve(kTotalSize);
+  while (state->KeepRunning()) {
+    destination.Reset();
+    if (chunked) {
+      ChunkedFileWriter file_writer;
+      for (size_t written = 0; written < kTotalSize; written += kWriteSize) {
+        file_writer.Write(data.data(), data.size());
+      }
+      if (!file_writer.WriteTo(&destination)) {
+        state->SkipWithError("WriteTo failed");
+        return;
+      }
+    } else {
+      StringFileWriter file_writer;
+      for (size_t written = 0; written < kTotalSize; written += kWriteSize) {
+        file_writer.Write(data.data(), data.size());
+      }
+      const std::string& contents = file_writer.string();
+      if (!destination.Write(contents.data(), contents.size())) {
+        state->SkipWithError("Write failed");
+        return;
+      }
+    }
+    DoNotOptimize(destination.string());
+  }
+
+  state->SetLabel(chunked ? "chunked" : "string");
+  state->SetBytesProcessed(state->iterations() * kTotalSize);
+}
+CRASHPAD_BENCHMARK(BM_InMemoryFileHandoff)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
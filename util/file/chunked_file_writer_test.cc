@@ -0,0 +1,273 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/chunked_file_writer.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file_writer.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Returns a string of |size| bytes that doesn’t repeat with a period that is a
+// factor of any block size, so that misplaced data is detected.
+std::string PatternString(size_t size) {
+  std::string pattern(size, '\0');
+  for (size_t index = 0; index < size; ++index) {
+    pattern[index] = 'a' + (index % 23);
+  }
+  return pattern;
+}
+
+TEST(ChunkedFileWriter, EmptyFile) {
+  ChunkedFileWriter writer;
+  EXPECT_EQ(0u, writer.size());
+  EXPECT_TRUE(writer.ToString().empty());
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+  EXPECT_TRUE(writer.Write("", 0));
+  EXPECT_TRUE(writer.ToString().empty());
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+
+  std::vector<WritableIoVec> iovecs;
+  writer.GetIoVecs(&iovecs);
+  EXPECT_TRUE(iovecs.empty());
+
+  StringFileWriter string_file_writer;
+  EXPECT_TRUE(writer.WriteTo(&string_file_writer));
+  EXPECT_TRUE(string_file_writer.string().empty());
+}
+
+TEST(ChunkedFileWriter, Seek) {
+  ChunkedFileWriter writer;
+
+  EXPECT_TRUE(writer.Write("abcd", 4));
+  EXPECT_EQ("abcd", writer.ToString());
+  EXPECT_EQ(4, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_EQ(0, writer.Seek(0, SEEK_SET));
+  EXPECT_TRUE(writer.Write("ef", 2));
+  EXPECT_EQ(4u, writer.size());
+  EXPECT_EQ("efcd", writer.ToString());
+  EXPECT_EQ(2, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_EQ(1, writer.Seek(-1, SEEK_CUR));
+  EXPECT_TRUE(writer.Write("g", 1));
+  EXPECT_EQ("egcd", writer.ToString());
+
+  EXPECT_EQ(3, writer.Seek(-1, SEEK_END));
+  EXPECT_TRUE(writer.Write("hi", 2));
+  EXPECT_EQ(5u, writer.size());
+  EXPECT_EQ("egchi", writer.ToString());
+  EXPECT_EQ(5, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_EQ(8, writer.Seek(3, SEEK_END));
+  EXPECT_EQ(5u, writer.size());
+  EXPECT_TRUE(writer.Write("j", 1));
+  EXPECT_EQ(9u, writer.size());
+  EXPECT_EQ(std::string("egchi\0\0\0j", 9), writer.ToString());
+  EXPECT_EQ(9, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_LT(writer.Seek(-1, SEEK_SET), 0);
+  EXPECT_EQ(9, writer.Seek(0, SEEK_CUR));
+
+  static_assert(SEEK_SET != 3 && SEEK_CUR != 3 && SEEK_END != 3,
+                "3 must be invalid for whence");
+  EXPECT_LT(writer.Seek(0, 3), 0);
+  EXPECT_EQ(9, writer.Seek(0, SEEK_CUR));
+}
+
+TEST(ChunkedFileWriter, Reset) {
+  ChunkedFileWriter writer;
+
+  EXPECT_TRUE(writer.Write("abcdef", 6));
+  EXPECT_EQ("abcdef", writer.ToString());
+  const size_t capacity = writer.capacity();
+  EXPECT_GE(capacity, 6u);
+
+  writer.Reset();
+  EXPECT_EQ(0u, writer.size());
+  EXPECT_TRUE(writer.ToString().empty());
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ(capacity, writer.capacity());
+
+  // A sparse write after a reset must not expose the old contents.
+  EXPECT_EQ(3, writer.Seek(3, SEEK_SET));
+  EXPECT_TRUE(writer.Write("g", 1));
+  EXPECT_EQ(std::string("\0\0\0g", 4), writer.ToString());
+  EXPECT_EQ(capacity, writer.capacity());
+}
+
+TEST(ChunkedFileWriter, WriteInvalid) {
+  ChunkedFileWriter writer;
+
+  EXPECT_FALSE(writer.Write(
+      "", static_cast<size_t>(std::numeric_limits<ssize_t>::max()) + 1));
+  EXPECT_TRUE(writer.ToString().empty());
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+
+  std::vector<WritableIoVec> iovecs;
+  EXPECT_FALSE(writer.WriteIoVec(&iovecs));
+
+  WritableIoVec iov;
+  iov.iov_base = "a";
+  iov.iov_len = 1;
+  iovecs.push_back(iov);
+  iov.iov_len = std::numeric_limits<ssize_t>::max();
+  iovecs.push_back(iov);
+  EXPECT_FALSE(writer.WriteIoVec(&iovecs));
+  EXPECT_TRUE(writer.ToString().empty());
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+}
+
+TEST(ChunkedFileWriter, SpanBlocks) {
+  ChunkedFileWriter writer;
+
+  // Write enough, in pieces that straddle block boundaries, to require several
+  // blocks.
+  const size_t kSize = ChunkedFileWriter::kMinimumBlockSize * 5 + 7;
+  const std::string pattern = PatternString(kSize);
+  const size_t kPieceSize = 1000;
+  std::vector<WritableIoVec> iovecs;
+  for (size_t offset = 0; offset < kSize; offset += kPieceSize) {
+    WritableIoVec iov;
+    iov.iov_base = &pattern[offset];
+    iov.iov_len = std::min(kPieceSize, kSize - offset);
+    iovecs.push_back(iov);
+  }
+  EXPECT_TRUE(writer.WriteIoVec(&iovecs));
+  EXPECT_EQ(kSize, writer.size());
+  EXPECT_EQ(static_cast<off_t>(kSize), writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ(pattern, writer.ToString());
+
+  iovecs.clear();
+  writer.GetIoVecs(&iovecs);
+  EXPECT_GT(iovecs.size(), 1u);
+  size_t iovecs_size = 0;
+  for (const WritableIoVec& iov : iovecs) {
+    iovecs_size += iov.iov_len;
+  }
+  EXPECT_EQ(kSize, iovecs_size);
+
+  // Overwrite a region crossing every block boundary.
+  const std::string overwrite(kSize - 2, 'Z');
+  EXPECT_EQ(1, writer.Seek(1, SEEK_SET));
+  EXPECT_TRUE(writer.Write(overwrite.data(), overwrite.size()));
+  EXPECT_EQ(kSize, writer.size());
+  EXPECT_EQ(pattern.substr(0, 1) + overwrite + pattern.substr(kSize - 1),
+            writer.ToString());
+
+  // Overwrite single bytes out of order, requiring block lookups.
+  std::string expected = writer.ToString();
+  const size_t kOffsets[] = {kSize - 1, 0, kSize / 2, 1, kSize / 3};
+  for (size_t offset : kOffsets) {
+    EXPECT_EQ(static_cast<off_t>(offset),
+              writer.Seek(offset, SEEK_SET));
+    EXPECT_TRUE(writer.Write("!", 1));
+    expected[offset] = '!';
+  }
+  EXPECT_EQ(expected, writer.ToString());
+
+  StringFileWriter string_file_writer;
+  EXPECT_TRUE(writer.WriteTo(&string_file_writer));
+  EXPECT_EQ(expected, string_file_writer.string());
+}
+
+TEST(ChunkedFileWriter, SeekSparseAcrossBlocks) {
+  ChunkedFileWriter writer;
+
+  const off_t kOffset = ChunkedFileWriter::kMinimumBlockSize * 3;
+  EXPECT_EQ(kOffset, writer.Seek(kOffset, SEEK_SET));
+  EXPECT_EQ(0u, writer.size());
+  EXPECT_TRUE(writer.Write("a", 1));
+  EXPECT_EQ(static_cast<size_t>(kOffset + 1), writer.size());
+
+  std::string expected(kOffset, '\0');
+  expected.push_back('a');
+  EXPECT_EQ(expected, writer.ToString());
+}
+
+TEST(ChunkedFileWriter, Reserve) {
+  ChunkedFileWriter writer;
+
+  const size_t kSize = ChunkedFileWriter::kMinimumBlockSize * 4 + 3;
+  writer.Reserve(kSize);
+  EXPECT_EQ(kSize, writer.capacity());
+  EXPECT_EQ(0u, writer.size());
+
+  // Reserving less than what’s available does nothing.
+  writer.Reserve(1);
+  EXPECT_EQ(kSize, writer.capacity());
+
+  const std::string pattern = PatternString(kSize);
+  for (size_t offset = 0; offset < kSize; offset += 100) {
+    EXPECT_TRUE(writer.Write(&pattern[offset],
+                             std::min(static_cast<size_t>(100),
+                                      kSize - offset)));
+  }
+  EXPECT_EQ(kSize, writer.capacity());
+  EXPECT_EQ(pattern, writer.ToString());
+
+  // Everything fit in the single reserved block.
+  std::vector<WritableIoVec> iovecs;
+  writer.GetIoVecs(&iovecs);
+  ASSERT_EQ(1u, iovecs.size());
+  EXPECT_EQ(kSize, iovecs[0].iov_len);
+
+  // Writing past the reservation grows the file.
+  EXPECT_TRUE(writer.Write("b", 1));
+  EXPECT_EQ(kSize + 1, writer.size());
+  EXPECT_GT(writer.capacity(), kSize);
+  EXPECT_EQ(pattern + "b", writer.ToString());
+}
+
+TEST(ChunkedFileWriter, ExternalBuffer) {
+  char buffer[8];
+  memset(buffer, 'x', sizeof(buffer));
+
+  ChunkedFileWriter writer;
+  writer.SetExternalBuffer(buffer, sizeof(buffer));
+  EXPECT_EQ(sizeof(buffer), writer.capacity());
+
+  EXPECT_TRUE(writer.Write("abcdef", 6));
+  EXPECT_EQ(0, memcmp(buffer, "abcdef", 6));
+  EXPECT_EQ(sizeof(buffer), writer.capacity());
+
+  std::vector<WritableIoVec> iovecs;
+  writer.GetIoVecs(&iovecs);
+  ASSERT_EQ(1u, iovecs.size());
+  EXPECT_EQ(buffer, iovecs[0].iov_base);
+  EXPECT_EQ(6u, iovecs[0].iov_len);
+
+  // Writes that don’t fit spill into allocated storage.
+  EXPECT_TRUE(writer.Write("ghijkl", 6));
+  EXPECT_EQ(0, memcmp(buffer, "abcdefgh", 8));
+  EXPECT_GT(writer.capacity(), sizeof(buffer));
+  EXPECT_EQ("abcdefghijkl", writer.ToString());
+
+  iovecs.clear();
+  writer.GetIoVecs(&iovecs);
+  ASSERT_EQ(2u, iovecs.size());
+  EXPECT_EQ(buffer, iovecs[0].iov_base);
+  EXPECT_EQ(sizeof(buffer), iovecs[0].iov_len);
+  EXPECT_EQ(4u, iovecs[1].iov_len);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,8 +14,11 @@
 
 #include "util/file/fd_io.h"
 
+#include <limits.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/posix/eintr_wrapper.h"
@@ -74,6 +77,27 @@ ssize_t WriteFD(int fd, const void* buffer, size_t size) {
   return ReadOrWrite<WriteTraits>(fd, buffer, size);
 }
 
+bool LoggingPWriteFD(int fd, const void* buffer, size_t size, off_t offset) {
+  const char* buffer_c = static_cast<const char*>(buffer);
+  while (size > 0) {
+    size_t write_size = std::min(size, static_cast<size_t>(SSIZE_MAX));
+    ssize_t written = HANDLE_EINTR(pwrite(fd, buffer_c, write_size, offset));
+    if (written < 0) {
+      PLOG(ERROR) << "pwrite";
+      return false;
+    } else if (written == 0) {
+      LOG(ERROR) << "pwrite: returned 0";
+      return false;
+    }
+
+    buffer_c += written;
+    size -= written;
+    offset += written;
+  }
+
+  return true;
+}
+
 void CheckedReadFD(int fd, void* buffer, size_t size) {
   ssize_t expect = base::checked_cast<ssize_t>(size);
   ssize_t rv = ReadFD(fd, buffer, size);
@@ -48,6 +48,20 @@ ssize_t ReadFD(int fd, void* buffer, size_t size);
 //! \sa CheckedWriteFD
 ssize_t WriteFD(int fd, const void* buffer, size_t size);
 
+//! \brief Wraps `pwrite()`, retrying when interrupted or following a short
+//!     write.
+//!
+//! This function writes \a size bytes from \a buffer to \a fd beginning at
+//! \a offset. No single `pwrite()` call is asked to write more than
+//! `SSIZE_MAX` bytes. The file offset of \a fd is not changed.
+//!
+//! \return `true` if all \a size bytes were written. `false` on failure, with
+//!     an error message logged. On failure, a portion of \a buffer may have
+//!     been written to \a fd.
+//!
+//! \sa WriteFD
+bool LoggingPWriteFD(int fd, const void* buffer, size_t size, off_t offset);
+
 //! \brief Wraps ReadFD(), ensuring that exactly \a size bytes are read.
 //!
 //! If \a size is out of the range of possible `read()` return values, if the
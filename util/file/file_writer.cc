@@ -148,4 +148,10 @@ off_t FileWriter::Seek(off_t offset, int whence) {
   return rv;
 }
 
+bool FileWriter::WriteAt(off_t offset, const void* data, size_t size) {
+  DCHECK(fd_.is_valid());
+
+  return LoggingPWriteFD(fd_.get(), data, size, offset);
+}
+
 }  // namespace crashpad
@@ -72,13 +72,62 @@ class FileWriterInterface {
   //!     message logged.
   virtual off_t Seek(off_t offset, int whence) = 0;
 
+  //! \brief Informs the file writer that \a size bytes are about to be written
+  //!     beginning at the current file position.
+  //!
+  //! Callers that know how much they will write, such as
+  //! MinidumpFileWriter::WriteEverything(), call this before writing so that
+  //! implementations can allocate storage for everything at once. This is
+  //! only a hint: it does not change the file’s size or position, and callers
+  //! are not required to call it. The default implementation does nothing.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  virtual bool WillWrite(size_t size) { return true; }
+
  protected:
   ~FileWriterInterface() {}
 };
 
+//! \brief An interface to write to files and other file-like objects at
+//!     explicit offsets, with POSIX semantics.
+//!
+//! Writes made through this interface neither depend on nor change any file
+//! position. Implementations must allow callers on multiple threads to write
+//! to non-overlapping regions concurrently.
+class PositionalFileWriterInterface {
+ public:
+  //! \brief Wraps `pwrite()` or provides an alternate implementation with
+  //!     identical semantics. This method will write the entire buffer,
+  //!     continuing after a short write or after being interrupted.
+  //!
+  //! \param[in] offset The file offset at which to begin writing \a data.
+  //! \param[in] data The data to write.
+  //! \param[in] size The size of \a data.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  virtual bool WriteAt(off_t offset, const void* data, size_t size) = 0;
+
+  //! \brief Informs the file writer that \a size bytes are about to be written
+  //!     beginning at \a offset.
+  //!
+  //! This is the positional equivalent of FileWriterInterface::WillWrite(). It
+  //! must not be called concurrently with WriteAt(). The default
+  //! implementation does nothing.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  virtual bool WillWriteAt(off_t offset, size_t size) { return true; }
+
+ protected:
+  ~PositionalFileWriterInterface() {}
+};
+
 //! \brief A file writer implementation that wraps traditional POSIX file
 //!     operations on files accessed through the filesystem.
-class FileWriter : public FileWriterInterface {
+class FileWriter : public FileWriterInterface,
+                   public PositionalFileWriterInterface {
  public:
   FileWriter();
   ~FileWriter();
@@ -119,6 +168,14 @@ class FileWriter : public FileWriterInterface {
   //!     a Close().
   virtual off_t Seek(off_t offset, int whence) override;
 
+  // PositionalFileWriterInterface:
+
+  //! \copydoc PositionalFileWriterInterface::WriteAt()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool WriteAt(off_t offset, const void* data, size_t size) override;
+
  private:
   base::ScopedFD fd_;
 
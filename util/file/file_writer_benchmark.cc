@@ -0,0 +1,77 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "util/file/file_writer.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Writes 1,024 iovecs of range(0) bytes each with a single WriteIoVec() call
+// to a temporary file, rewinding between iterations so that the file stays
+// small and resident in the page cache.
+void BM_FileWriterWriteIoVec(BenchmarkState* state) {
+  const size_t iov_size = state->range(0);
+  const size_t kIoVecCount = 1024;
+  const std::string data(iov_size, 'v');
+
+  char path[] = "/tmp/crashpad_benchmark.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    state->SkipWithError("mkstemp failed");
+    return;
+  }
+  close(fd);
+
+  FileWriter file_writer;
+  if (!file_writer.Open(base::FilePath(path), O_WRONLY | O_TRUNC, 0600)) {
+    unlink(path);
+    state->SkipWithError("open failed");
+    return;
+  }
+
+  std::vector<WritableIoVec> iovecs;
+  while (state->KeepRunning()) {
+    iovecs.clear();
+    WritableIoVec iov;
+    iov.iov_base = data.data();
+    iov.iov_len = iov_size;
+    iovecs.resize(kIoVecCount, iov);
+    if (file_writer.Seek(0, SEEK_SET) != 0 ||
+        !file_writer.WriteIoVec(&iovecs)) {
+      state->SkipWithError("write failed");
+      break;
+    }
+  }
+
+  file_writer.Close();
+  unlink(path);
+
+  state->SetBytesProcessed(state->iterations() * kIoVecCount * iov_size);
+  state->SetItemsProcessed(state->iterations() * kIoVecCount);
+}
+CRASHPAD_BENCHMARK(BM_FileWriterWriteIoVec)->Range(8, 4096);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
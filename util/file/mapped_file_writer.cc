@@ -0,0 +1,417 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/mapped_file_writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+#include "base/posix/eintr_wrapper.h"
+#include "build/build_config.h"
+#include "util/file/fd_io.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+namespace {
+
+// The smallest mapping established when growing to accommodate a write that
+// was not announced by WillWrite() or WillWriteAt().
+const size_t kMinimumGrowthSize = 1024 * 1024;
+
+// Extends the file open on |fd| to |size| bytes, allocating disk blocks for all
+// of it. Blocks that are already allocated are left alone. Sets errno and
+// returns false on failure.
+bool ReserveStorage(int fd, off_t size) {
+#if defined(OS_MACOSX)
+  fstore_t fstore = {};
+  fstore.fst_flags = F_ALLOCATEALL;
+  fstore.fst_posmode = F_PEOFPOSMODE;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return false;
+  }
+  if (size > st.st_size) {
+    fstore.fst_length = size - st.st_size;
+    if (fcntl(fd, F_PREALLOCATE, &fstore) != 0) {
+      return false;
+    }
+  }
+  return HANDLE_EINTR(ftruncate(fd, size)) == 0;
+#else
+  // posix_fallocate() returns an error number rather than setting errno, so
+  // HANDLE_EINTR() can’t be used.
+  int rv;
+  do {
+    rv = posix_fallocate(fd, 0, size);
+  } while (rv == EINTR);
+  if (rv != 0) {
+    errno = rv;
+    return false;
+  }
+  return true;
+#endif
+}
+
+}  // namespace
+
+MappedFileWriter::MappedFileWriter() : MappedFileWriter(kMapOptionsNone) {
+}
+
+MappedFileWriter::MappedFileWriter(uint32_t map_options)
+    : fd_(),
+      mapping_(NULL),
+      mapping_size_(0),
+      file_size_(0),
+      size_(0),
+      offset_(0),
+      map_options_(map_options) {
+}
+
+MappedFileWriter::~MappedFileWriter() {
+  if (fd_.is_valid()) {
+    Close();
+  }
+}
+
+bool MappedFileWriter::Open(const base::FilePath& path,
+                            int oflag,
+                            mode_t mode) {
+  CHECK(!fd_.is_valid());
+
+  if ((oflag & O_ACCMODE) != O_RDWR) {
+    LOG(ERROR) << "Open(): O_RDWR required";
+    return false;
+  }
+
+  fd_.reset(HANDLE_EINTR(open(path.value().c_str(), oflag, mode)));
+  if (!fd_.is_valid()) {
+    PLOG(ERROR) << "open " << path.value();
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd_.get(), &st) != 0) {
+    PLOG(ERROR) << "fstat " << path.value();
+    fd_.reset();
+    return false;
+  }
+
+  if (!AssignIfInRange(&size_, st.st_size)) {
+    LOG(ERROR) << "Open(): size " << st.st_size << " out of range";
+    fd_.reset();
+    return false;
+  }
+
+  file_size_ = size_;
+  offset_ = (oflag & O_APPEND) ? size_ : 0;
+
+  return true;
+}
+
+bool MappedFileWriter::Close() {
+  CHECK(fd_.is_valid());
+
+  Unmap();
+
+  // Remove any storage that was reserved for a mapping but never written. This
+  // is tracked separately from the mapping, because the file may have been
+  // extended for a mapping that could not then be established.
+  bool rv = true;
+  if (file_size_ > size_ && HANDLE_EINTR(ftruncate(fd_.get(), size_)) != 0) {
+    PLOG(ERROR) << "ftruncate";
+    rv = false;
+  }
+
+  fd_.reset();
+  file_size_ = 0;
+  size_ = 0;
+  offset_ = 0;
+
+  return rv;
+}
+
+bool MappedFileWriter::Write(const void* data, size_t size) {
+  DCHECK(fd_.is_valid());
+
+  base::CheckedNumeric<ssize_t> end = offset_;
+  end += size;
+  if (!end.IsValid()) {
+    LOG(ERROR) << "Write(): file too large";
+    return false;
+  }
+
+  if (size == 0) {
+    return true;
+  }
+
+  const size_t end_sizet = end.ValueOrDie();
+  if (!EnsureMapped(end_sizet, false)) {
+    return false;
+  }
+
+  memcpy(mapping_ + offset_, data, size);
+  offset_ = end_sizet;
+  UpdateSize(end_sizet);
+
+  return true;
+}
+
+bool MappedFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  DCHECK(fd_.is_valid());
+
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  // Map everything that the iovecs will need at once, and avoid writing
+  // anything at all if it would cause an overflow.
+  base::CheckedNumeric<ssize_t> end = offset_;
+  for (const WritableIoVec& iov : *iovecs) {
+    end += iov.iov_len;
+    if (!end.IsValid()) {
+      LOG(ERROR) << "WriteIoVec(): file too large";
+      return false;
+    }
+  }
+
+  if (!EnsureMapped(end.ValueOrDie(), false)) {
+    return false;
+  }
+
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!Write(iov.iov_base, iov.iov_len)) {
+      return false;
+    }
+  }
+
+#ifndef NDEBUG
+  // The interface says that |iovecs| is not sacred, so scramble it to make sure
+  // that nobody depends on it.
+  memset(&(*iovecs)[0], 0xa5, sizeof((*iovecs)[0]) * iovecs->size());
+#endif
+
+  return true;
+}
+
+off_t MappedFileWriter::Seek(off_t offset, int whence) {
+  DCHECK(fd_.is_valid());
+
+  size_t base_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+
+    case SEEK_CUR:
+      base_offset = offset_;
+      break;
+
+    case SEEK_END:
+      base_offset = size_;
+      break;
+
+    default:
+      LOG(ERROR) << "Seek(): invalid whence " << whence;
+      return -1;
+  }
+
+  off_t base_offset_offt;
+  if (!AssignIfInRange(&base_offset_offt, base_offset)) {
+    LOG(ERROR) << "Seek(): base_offset " << base_offset << " invalid for off_t";
+    return -1;
+  }
+  base::CheckedNumeric<off_t> new_offset(base_offset_offt);
+  new_offset += offset;
+  if (!new_offset.IsValid()) {
+    LOG(ERROR) << "Seek(): new_offset invalid";
+    return -1;
+  }
+  off_t new_offset_offt = new_offset.ValueOrDie();
+  if (!AssignIfInRange(&offset_, new_offset_offt)) {
+    LOG(ERROR) << "Seek(): new_offset " << new_offset_offt
+               << " invalid for size_t";
+    return -1;
+  }
+
+  return new_offset_offt;
+}
+
+bool MappedFileWriter::WillWrite(size_t size) {
+  DCHECK(fd_.is_valid());
+
+  base::CheckedNumeric<ssize_t> end = offset_;
+  end += size;
+  if (!end.IsValid()) {
+    LOG(ERROR) << "WillWrite(): file too large";
+    return false;
+  }
+
+  return EnsureMapped(end.ValueOrDie(), true);
+}
+
+bool MappedFileWriter::WriteAt(off_t offset, const void* data, size_t size) {
+  DCHECK(fd_.is_valid());
+
+  size_t offset_sizet;
+  if (!AssignIfInRange(&offset_sizet, offset)) {
+    LOG(ERROR) << "WriteAt(): offset " << offset << " invalid";
+    return false;
+  }
+  base::CheckedNumeric<ssize_t> end = offset_sizet;
+  end += size;
+  if (!end.IsValid()) {
+    LOG(ERROR) << "WriteAt(): file too large";
+    return false;
+  }
+
+  if (size == 0) {
+    return true;
+  }
+
+  const size_t end_sizet = end.ValueOrDie();
+  if (end_sizet <= mapping_size_) {
+    memcpy(mapping_ + offset_sizet, data, size);
+  } else if (!LoggingPWriteFD(fd_.get(), data, size, offset)) {
+    return false;
+  }
+
+  UpdateSize(end_sizet);
+
+  return true;
+}
+
+bool MappedFileWriter::WillWriteAt(off_t offset, size_t size) {
+  DCHECK(fd_.is_valid());
+
+  size_t offset_sizet;
+  if (!AssignIfInRange(&offset_sizet, offset)) {
+    LOG(ERROR) << "WillWriteAt(): offset " << offset << " invalid";
+    return false;
+  }
+  base::CheckedNumeric<ssize_t> end = offset_sizet;
+  end += size;
+  if (!end.IsValid()) {
+    LOG(ERROR) << "WillWriteAt(): file too large";
+    return false;
+  }
+
+  return EnsureMapped(end.ValueOrDie(), true);
+}
+
+bool MappedFileWriter::EnsureMapped(size_t size, bool exact) {
+  if (size <= mapping_size_) {
+    return true;
+  }
+
+  // Never shrink the file below what has already been written, including any
+  // content that it had when it was opened.
+  size_t new_size = std::max(size, size_);
+  if (!exact) {
+    // Grow geometrically so that a file written in many small pieces is only
+    // remapped a logarithmic number of times. Remapping doesn’t copy any data,
+    // but each ftruncate() and mmap() is a system call, and each new mapping
+    // must be faulted in again.
+    new_size = std::max(new_size,
+                        std::max(mapping_size_ * 2, kMinimumGrowthSize));
+  }
+
+  const size_t page_size = getpagesize();
+  base::CheckedNumeric<size_t> rounded_size = new_size;
+  rounded_size += page_size - 1;
+  off_t new_size_offt;
+  if (!rounded_size.IsValid() ||
+      !AssignIfInRange(&new_size_offt,
+                       rounded_size.ValueOrDie() / page_size * page_size)) {
+    LOG(ERROR) << "EnsureMapped(): size " << new_size << " out of range";
+    return false;
+  }
+  new_size = new_size_offt;
+
+  Unmap();
+
+  // Allocate disk blocks for the entire mapping before establishing it. Simply
+  // extending the file with ftruncate() would leave it sparse, and running out
+  // of space would then raise SIGBUS on the first store to an unbacked page,
+  // instead of being reported here.
+  const bool reserved = ReserveStorage(fd_.get(), new_size_offt);
+
+  // Even on failure, the file may have been partially extended, so Close()
+  // must consider trimming it.
+  file_size_ = std::max(file_size_, new_size);
+  if (!reserved) {
+    PLOG(ERROR) << "ReserveStorage";
+    return false;
+  }
+
+  int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+  if (map_options_ & kMapOptionsPopulate) {
+    flags |= MAP_POPULATE;
+  }
+#endif
+
+  void* mapping =
+      mmap(NULL, new_size, PROT_READ | PROT_WRITE, flags, fd_.get(), 0);
+  if (mapping == MAP_FAILED) {
+    PLOG(ERROR) << "mmap";
+    return false;
+  }
+
+  mapping_ = static_cast<uint8_t*>(mapping);
+  mapping_size_ = new_size;
+
+  // Advice is only a hint, so failure to take it isn’t fatal.
+  if ((map_options_ & kMapOptionsSequential) &&
+      madvise(mapping_, mapping_size_, MADV_SEQUENTIAL) != 0) {
+    PLOG(WARNING) << "madvise";
+  }
+  if ((map_options_ & kMapOptionsWillNeed) &&
+      madvise(mapping_, mapping_size_, MADV_WILLNEED) != 0) {
+    PLOG(WARNING) << "madvise";
+  }
+
+  return true;
+}
+
+void MappedFileWriter::Unmap() {
+  if (mapping_) {
+    if (munmap(mapping_, mapping_size_) != 0) {
+      PLOG(ERROR) << "munmap";
+    }
+    mapping_ = NULL;
+    mapping_size_ = 0;
+  }
+}
+
+void MappedFileWriter::UpdateSize(size_t end) {
+  // WriteAt() may be called on several threads at once.
+  size_t size = __atomic_load_n(&size_, __ATOMIC_RELAXED);
+  while (end > size &&
+         !__atomic_compare_exchange_n(
+             &size_, &size, end, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+}  // namespace crashpad
@@ -0,0 +1,182 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_MAPPED_FILE_WRITER_H_
+#define CRASHPAD_UTIL_FILE_MAPPED_FILE_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief A file writer implementation that writes to files accessed through
+//!     the filesystem by way of a shared memory mapping.
+//!
+//! Instead of making a system call for each write, as FileWriter does, this
+//! class extends the file and allocates storage for it, maps it with `mmap()`,
+//! and copies data directly into the mapping. Because storage is allocated
+//! before the file is mapped, running out of disk space causes a write to fail
+//! rather than raising `SIGBUS`. Callers that know how large the file will
+//! be, such as MinidumpFileWriter::WriteEverything(), announce it through
+//! WillWrite() or WillWriteAt(), so that the file is extended and mapped only
+//! once. Otherwise, the mapping grows geometrically as data is written.
+//!
+//! Storage that was reserved but never written is trimmed from the file by
+//! Close().
+class MappedFileWriter : public FileWriterInterface,
+                         public PositionalFileWriterInterface {
+ public:
+  //! \brief Options affecting how the file is mapped, which may be combined.
+  enum MapOptions : uint32_t {
+    //! \brief Map the file with no special options.
+    kMapOptionsNone = 0,
+
+    //! \brief Fault the entire mapping in when it is established, with
+    //!     `MAP_POPULATE`. This option has no effect on systems without
+    //!     `MAP_POPULATE`.
+    kMapOptionsPopulate = 1 << 0,
+
+    //! \brief Advise the system that the mapping will be accessed sequentially,
+    //!     with `MADV_SEQUENTIAL`.
+    kMapOptionsSequential = 1 << 1,
+
+    //! \brief Advise the system that the entire mapping will be accessed soon,
+    //!     with `MADV_WILLNEED`.
+    kMapOptionsWillNeed = 1 << 2,
+  };
+
+  MappedFileWriter();
+
+  //! \param[in] map_options A combination of MapOptions values.
+  explicit MappedFileWriter(uint32_t map_options);
+
+  ~MappedFileWriter();
+
+  //! \brief Wraps `open()`.
+  //!
+  //! \a oflag must include `O_RDWR`, because shared writable mappings require
+  //! the file to be open for reading as well as writing.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  //!
+  //! \note After a successful call, this method cannot be called again until
+  //!     after Close().
+  bool Open(const base::FilePath& path, int oflag, mode_t mode);
+
+  //! \brief Unmaps the file, trims it to the size that was written, and closes
+  //!     it.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged. The file is closed in either case.
+  //!
+  //! \note It is only valid to call this method on an object that has had a
+  //!     successful Open() that has not yet been matched by a subsequent call
+  //!     to this method.
+  bool Close();
+
+  // FileWriterInterface:
+
+  //! \copydoc FileWriterInterface::Write()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool Write(const void* data, size_t size) override;
+
+  //! \copydoc FileWriterInterface::WriteIoVec()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+
+  //! \copydoc FileWriterInterface::Seek()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual off_t Seek(off_t offset, int whence) override;
+
+  //! \copydoc FileWriterInterface::WillWrite()
+  //!
+  //! This extends and maps the file so that at least \a size bytes can be
+  //! written at the current file position without further system calls.
+  virtual bool WillWrite(size_t size) override;
+
+  // PositionalFileWriterInterface:
+
+  //! \copydoc PositionalFileWriterInterface::WriteAt()
+  //!
+  //! Writes that fall entirely within the mapping are copied into it. Others
+  //! are written with `pwrite()`, because the mapping cannot safely be
+  //! replaced while other threads may be writing to it.
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool WriteAt(off_t offset, const void* data, size_t size) override;
+
+  //! \copydoc PositionalFileWriterInterface::WillWriteAt()
+  virtual bool WillWriteAt(off_t offset, size_t size) override;
+
+ private:
+  //! \brief Ensures that the file is extended and mapped through at least
+  //!     \a size bytes.
+  //!
+  //! \param[in] size The number of bytes that must be mapped.
+  //! \param[in] exact If `true`, the mapping will be no larger than necessary.
+  //!     Otherwise, it may grow beyond \a size to amortize the cost of
+  //!     remapping over future writes.
+  bool EnsureMapped(size_t size, bool exact);
+
+  //! \brief Unmaps the current mapping, if any.
+  void Unmap();
+
+  //! \brief Raises #size_ to \a end if it is smaller, atomically.
+  void UpdateSize(size_t end);
+
+  base::ScopedFD fd_;
+
+  //! \brief The base of the mapping, or `NULL` if nothing is mapped.
+  uint8_t* mapping_;
+
+  //! \brief The size of #mapping_.
+  size_t mapping_size_;
+
+  //! \brief The largest size that the file has been extended to for a
+  //!     mapping, which may be larger than #mapping_size_ if the mapping could
+  //!     not be established. Close() trims the file to #size_ if this is
+  //!     larger.
+  size_t file_size_;
+
+  //! \brief The size of the file as written, which may be smaller than
+  //!     #file_size_.
+  size_t size_;
+
+  //! \brief The current file position.
+  size_t offset_;
+
+  //! \brief A combination of MapOptions values.
+  uint32_t map_options_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFileWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_MAPPED_FILE_WRITER_H_
@@ -0,0 +1,247 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/mapped_file_writer.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#include "gtest/gtest.h"
+#include "util/file/fd_io.h"
+#include "util/test/errors.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Creates a temporary file that is removed when the object is destroyed.
+class ScopedTempFile {
+ public:
+  ScopedTempFile() : path_() {
+    char path[] = "/tmp/mapped_file_writer_test.XXXXXX";
+    base::ScopedFD fd(mkstemp(path));
+    EXPECT_TRUE(fd.is_valid()) << ErrnoMessage("mkstemp");
+    path_ = base::FilePath(path);
+  }
+
+  ~ScopedTempFile() {
+    EXPECT_EQ(0, unlink(path_.value().c_str())) << ErrnoMessage("unlink");
+  }
+
+  const base::FilePath& path() const { return path_; }
+
+  // Returns the file’s contents.
+  std::string Contents() const {
+    base::ScopedFD fd(HANDLE_EINTR(open(path_.value().c_str(), O_RDONLY)));
+    EXPECT_TRUE(fd.is_valid()) << ErrnoMessage("open");
+    struct stat st;
+    EXPECT_EQ(0, fstat(fd.get(), &st)) << ErrnoMessage("fstat");
+    std::string contents(st.st_size, '\0');
+    if (!contents.empty()) {
+      CheckedReadFD(fd.get(), &contents[0], contents.size());
+    }
+    return contents;
+  }
+
+ private:
+  base::FilePath path_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTempFile);
+};
+
+// Returns a string of |size| bytes with a pattern that doesn’t repeat on page
+// boundaries.
+std::string PatternString(size_t size) {
+  std::string pattern(size, '\0');
+  for (size_t index = 0; index < size; ++index) {
+    pattern[index] = 'a' + (index % 23);
+  }
+  return pattern;
+}
+
+TEST(MappedFileWriter, OpenRequiresReadWrite) {
+  ScopedTempFile temp_file;
+
+  MappedFileWriter writer;
+  EXPECT_FALSE(writer.Open(temp_file.path(), O_WRONLY, 0600));
+  ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+  EXPECT_TRUE(writer.Close());
+  EXPECT_TRUE(temp_file.Contents().empty());
+}
+
+TEST(MappedFileWriter, WriteAndSeek) {
+  ScopedTempFile temp_file;
+
+  MappedFileWriter writer;
+  ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_TRUE(writer.Write("abcd", 4));
+  EXPECT_EQ(4, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_EQ(1, writer.Seek(1, SEEK_SET));
+  EXPECT_TRUE(writer.Write("ef", 2));
+  EXPECT_EQ(3, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_EQ(4, writer.Seek(0, SEEK_END));
+  EXPECT_EQ(7, writer.Seek(3, SEEK_CUR));
+  EXPECT_TRUE(writer.Write("g", 1));
+  EXPECT_EQ(8, writer.Seek(0, SEEK_END));
+
+  EXPECT_EQ(6, writer.Seek(-2, SEEK_END));
+  std::vector<WritableIoVec> iovecs;
+  WritableIoVec iov;
+  iov.iov_base = "hi";
+  iov.iov_len = 2;
+  iovecs.push_back(iov);
+  iov.iov_base = "jkl";
+  iov.iov_len = 3;
+  iovecs.push_back(iov);
+  EXPECT_TRUE(writer.WriteIoVec(&iovecs));
+  EXPECT_EQ(11, writer.Seek(0, SEEK_CUR));
+
+  EXPECT_LT(writer.Seek(-1, SEEK_SET), 0);
+  EXPECT_EQ(11, writer.Seek(0, SEEK_CUR));
+
+  // The mapping is larger than what was written, but the file is trimmed when
+  // it’s closed.
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(std::string("aefd\0\0hijkl", 11), temp_file.Contents());
+}
+
+TEST(MappedFileWriter, Growth) {
+  ScopedTempFile temp_file;
+
+  // Write enough in small pieces that the mapping must be replaced several
+  // times.
+  const size_t kSize = 5 * 1024 * 1024 + 3;
+  const std::string pattern = PatternString(kSize);
+
+  MappedFileWriter writer;
+  ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+  const size_t kPieceSize = 4000;
+  for (size_t offset = 0; offset < kSize; offset += kPieceSize) {
+    ASSERT_TRUE(writer.Write(&pattern[offset],
+                             std::min(kPieceSize, kSize - offset)));
+  }
+  EXPECT_EQ(static_cast<off_t>(kSize), writer.Seek(0, SEEK_CUR));
+  EXPECT_TRUE(writer.Close());
+
+  EXPECT_EQ(pattern, temp_file.Contents());
+}
+
+TEST(MappedFileWriter, WillWrite) {
+  ScopedTempFile temp_file;
+
+  const size_t kSize = 3 * 4096 + 5;
+  const std::string pattern = PatternString(kSize);
+
+  MappedFileWriter writer(MappedFileWriter::kMapOptionsPopulate |
+                          MappedFileWriter::kMapOptionsSequential |
+                          MappedFileWriter::kMapOptionsWillNeed);
+  ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+  EXPECT_EQ(2, writer.Seek(2, SEEK_SET));
+  ASSERT_TRUE(writer.WillWrite(kSize));
+
+  // Announcing a write changes neither the position nor the size.
+  EXPECT_EQ(2, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ(0, writer.Seek(0, SEEK_END));
+
+  EXPECT_EQ(2, writer.Seek(2, SEEK_SET));
+  EXPECT_TRUE(writer.Write(pattern.data(), pattern.size()));
+  EXPECT_TRUE(writer.Close());
+
+  EXPECT_EQ(std::string(2, '\0') + pattern, temp_file.Contents());
+}
+
+TEST(MappedFileWriter, WriteAt) {
+  ScopedTempFile temp_file;
+
+  const size_t kMappedSize = 8192;
+  const std::string pattern = PatternString(kMappedSize + 100);
+
+  MappedFileWriter writer;
+  ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+  ASSERT_TRUE(writer.WillWriteAt(0, kMappedSize));
+
+  // These land in the mapping.
+  EXPECT_TRUE(writer.WriteAt(100, &pattern[100], kMappedSize - 100));
+  EXPECT_TRUE(writer.WriteAt(0, &pattern[0], 100));
+
+  // This extends beyond the mapping, and is written with pwrite().
+  EXPECT_TRUE(writer.WriteAt(kMappedSize, &pattern[kMappedSize], 100));
+
+  // Positional writes don’t affect the file position.
+  EXPECT_EQ(0, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ(static_cast<off_t>(pattern.size()), writer.Seek(0, SEEK_END));
+
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(pattern, temp_file.Contents());
+}
+
+TEST(MappedFileWriter, ReservesStorage) {
+  ScopedTempFile temp_file;
+
+  // Storage for the whole mapping is allocated up front, so that the file
+  // isn’t sparse and running out of space can’t raise SIGBUS during a write.
+  const size_t kSize = 1024 * 1024;
+  MappedFileWriter writer;
+  ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+  ASSERT_TRUE(writer.WillWrite(kSize));
+
+  struct stat st;
+  ASSERT_EQ(0, stat(temp_file.path().value().c_str(), &st))
+      << ErrnoMessage("stat");
+  EXPECT_GE(static_cast<size_t>(st.st_size), kSize);
+  EXPECT_GE(static_cast<size_t>(st.st_blocks) * 512, kSize);
+
+  // Nothing was written, so Close() trims all of it away.
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ("", temp_file.Contents());
+}
+
+TEST(MappedFileWriter, PreservesExistingContent) {
+  ScopedTempFile temp_file;
+
+  {
+    MappedFileWriter writer;
+    ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR | O_TRUNC, 0600));
+    EXPECT_TRUE(writer.Write("abcdef", 6));
+    EXPECT_TRUE(writer.Close());
+  }
+
+  {
+    // Destruction closes the file.
+    MappedFileWriter writer;
+    ASSERT_TRUE(writer.Open(temp_file.path(), O_RDWR, 0600));
+    EXPECT_EQ(6, writer.Seek(0, SEEK_END));
+    EXPECT_EQ(2, writer.Seek(2, SEEK_SET));
+    EXPECT_TRUE(writer.Write("g", 1));
+  }
+
+  EXPECT_EQ("abgdef", temp_file.Contents());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,98 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/offset_file_writer.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+
+namespace crashpad {
+
+OffsetFileWriter::OffsetFileWriter(PositionalFileWriterInterface* file_writer,
+                                   off_t offset)
+    : file_writer_(file_writer), offset_(offset) {
+  DCHECK_GE(offset_, 0);
+}
+
+OffsetFileWriter::~OffsetFileWriter() {
+}
+
+bool OffsetFileWriter::Write(const void* data, size_t size) {
+  base::CheckedNumeric<off_t> new_offset = offset_;
+  new_offset += size;
+  if (!new_offset.IsValid()) {
+    LOG(ERROR) << "Write(): file too large";
+    return false;
+  }
+
+  if (!file_writer_->WriteAt(offset_, data, size)) {
+    return false;
+  }
+
+  offset_ = new_offset.ValueOrDie();
+  return true;
+}
+
+bool OffsetFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!Write(iov.iov_base, iov.iov_len)) {
+      return false;
+    }
+  }
+
+#ifndef NDEBUG
+  // The interface says that |iovecs| is not sacred, so scramble it to make sure
+  // that nobody depends on it.
+  memset(&(*iovecs)[0], 0xa5, sizeof((*iovecs)[0]) * iovecs->size());
+#endif
+
+  return true;
+}
+
+off_t OffsetFileWriter::Seek(off_t offset, int whence) {
+  off_t base_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+
+    case SEEK_CUR:
+      base_offset = offset_;
+      break;
+
+    default:
+      LOG(ERROR) << "Seek(): unsupported whence " << whence;
+      return -1;
+  }
+
+  base::CheckedNumeric<off_t> new_offset(base_offset);
+  new_offset += offset;
+  if (!new_offset.IsValid() || new_offset.ValueOrDie() < 0) {
+    LOG(ERROR) << "Seek(): new_offset invalid";
+    return -1;
+  }
+
+  offset_ = new_offset.ValueOrDie();
+  return offset_;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,61 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_OFFSET_FILE_WRITER_H_
+#define CRASHPAD_UTIL_FILE_OFFSET_FILE_WRITER_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief A file writer that writes sequentially through a
+//!     PositionalFileWriterInterface, starting at a fixed offset.
+//!
+//! Each object maintains its own file position, which is independent of any
+//! file position maintained by the underlying file. This allows several
+//! objects, each positioned at a different offset, to write to disjoint
+//! regions of the same file concurrently on different threads, while exposing
+//! the sequential FileWriterInterface that most writers expect.
+//!
+//! `SEEK_END` is not supported, because the underlying file’s size is not
+//! known to this object.
+class OffsetFileWriter final : public FileWriterInterface {
+ public:
+  //! \param[in] file_writer The file writer to write to. This object does not
+  //!     take ownership of \a file_writer, which must outlive it.
+  //! \param[in] offset The offset within \a file_writer that this object’s
+  //!     file position is initially set to.
+  OffsetFileWriter(PositionalFileWriterInterface* file_writer, off_t offset);
+  ~OffsetFileWriter();
+
+  // FileWriterInterface:
+  virtual bool Write(const void* data, size_t size) override;
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+  virtual off_t Seek(off_t offset, int whence) override;
+
+ private:
+  PositionalFileWriterInterface* file_writer_;  // weak
+  off_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(OffsetFileWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_OFFSET_FILE_WRITER_H_
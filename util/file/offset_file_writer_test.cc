@@ -0,0 +1,110 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/offset_file_writer.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// A PositionalFileWriterInterface backed by a string, recording each call.
+class TestPositionalFileWriter final : public PositionalFileWriterInterface {
+ public:
+  TestPositionalFileWriter() : string_(), write_count_(0) {}
+  ~TestPositionalFileWriter() {}
+
+  const std::string& string() const { return string_; }
+  size_t write_count() const { return write_count_; }
+
+  // PositionalFileWriterInterface:
+  virtual bool WriteAt(off_t offset, const void* data, size_t size) override {
+    EXPECT_GE(offset, 0);
+    size_t end = offset + size;
+    if (string_.size() < end) {
+      string_.resize(end);
+    }
+    string_.replace(offset, size, static_cast<const char*>(data), size);
+    ++write_count_;
+    return true;
+  }
+
+ private:
+  std::string string_;
+  size_t write_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestPositionalFileWriter);
+};
+
+TEST(OffsetFileWriter, Write) {
+  TestPositionalFileWriter positional_writer;
+
+  OffsetFileWriter writer_1(&positional_writer, 3);
+  EXPECT_EQ(3, writer_1.Seek(0, SEEK_CUR));
+  EXPECT_TRUE(writer_1.Write("def", 3));
+  EXPECT_EQ(6, writer_1.Seek(0, SEEK_CUR));
+
+  // A second writer’s position is independent of the first’s.
+  OffsetFileWriter writer_0(&positional_writer, 0);
+  EXPECT_EQ(0, writer_0.Seek(0, SEEK_CUR));
+  EXPECT_TRUE(writer_0.Write("abc", 3));
+  EXPECT_EQ(3, writer_0.Seek(0, SEEK_CUR));
+  EXPECT_EQ(6, writer_1.Seek(0, SEEK_CUR));
+
+  EXPECT_TRUE(writer_1.Write("ghi", 3));
+  EXPECT_EQ(9, writer_1.Seek(0, SEEK_CUR));
+
+  EXPECT_EQ("abcdefghi", positional_writer.string());
+  EXPECT_EQ(3u, positional_writer.write_count());
+}
+
+TEST(OffsetFileWriter, WriteIoVec) {
+  TestPositionalFileWriter positional_writer;
+  OffsetFileWriter writer(&positional_writer, 2);
+
+  std::vector<WritableIoVec> iovecs;
+  EXPECT_FALSE(writer.WriteIoVec(&iovecs));
+
+  WritableIoVec iov;
+  iov.iov_base = "abc";
+  iov.iov_len = 3;
+  iovecs.push_back(iov);
+  iov.iov_base = "de";
+  iov.iov_len = 2;
+  iovecs.push_back(iov);
+  EXPECT_TRUE(writer.WriteIoVec(&iovecs));
+  EXPECT_EQ(7, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ(std::string("\0\0abcde", 7), positional_writer.string());
+}
+
+TEST(OffsetFileWriter, Seek) {
+  TestPositionalFileWriter positional_writer;
+  OffsetFileWriter writer(&positional_writer, 4);
+
+  EXPECT_EQ(6, writer.Seek(2, SEEK_CUR));
+  EXPECT_EQ(1, writer.Seek(1, SEEK_SET));
+  EXPECT_TRUE(writer.Write("z", 1));
+  EXPECT_EQ(std::string("\0z", 2), positional_writer.string());
+
+  EXPECT_EQ(-1, writer.Seek(-3, SEEK_CUR));
+  EXPECT_EQ(-1, writer.Seek(0, SEEK_END));
+  EXPECT_EQ(2, writer.Seek(0, SEEK_CUR));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
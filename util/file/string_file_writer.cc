@@ -33,6 +33,10 @@ void StringFileWriter::Reset() {
   offset_ = 0;
 }
 
+void StringFileWriter::Reserve(size_t capacity) {
+  string_.reserve(capacity);
+}
+
 bool StringFileWriter::Write(const void* data, size_t size) {
   DCHECK(offset_.IsValid());
 
@@ -134,4 +138,18 @@ off_t StringFileWriter::Seek(off_t offset, int whence) {
   return offset_.ValueOrDie();
 }
 
+bool StringFileWriter::WillWrite(size_t size) {
+  DCHECK(offset_.IsValid());
+
+  base::CheckedNumeric<size_t> end = offset_;
+  end += size;
+  if (!end.IsValid()) {
+    LOG(ERROR) << "WillWrite(): file too large";
+    return false;
+  }
+
+  string_.reserve(end.ValueOrDie());
+  return true;
+}
+
 }  // namespace crashpad
@@ -44,10 +44,18 @@ class StringFileWriter : public FileWriterInterface {
   //!     position to `0`.
   void Reset();
 
+  //! \brief Ensures that the virtual file can grow to \a capacity bytes
+  //!     without reallocating its storage.
+  //!
+  //! For large files whose contents will be handed to another writer, prefer
+  //! ChunkedFileWriter, which never needs to move its contents.
+  void Reserve(size_t capacity);
+
   // FileWriterInterface:
   virtual bool Write(const void* data, size_t size) override;
   virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
   virtual off_t Seek(off_t offset, int whence) override;
+  virtual bool WillWrite(size_t size) override;
 
  private:
   //! \brief The virtual file’s contents.
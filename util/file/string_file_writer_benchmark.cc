@@ -0,0 +1,79 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "util/file/string_file_writer.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const size_t kTotalSize = 4 * 1024 * 1024;
+
+// Grows a new StringFileWriter to 4MB with writes of range(0) bytes each.
+void BM_StringFileWriterGrowth(BenchmarkState* state) {
+  const size_t write_size = state->range(0);
+  const std::string data(write_size, 'g');
+
+  while (state->KeepRunning()) {
+    StringFileWriter file_writer;
+    for (size_t written = 0; written < kTotalSize; written += write_size) {
+      if (!file_writer.Write(data.data(), data.size())) {
+        state->SkipWithError("Write failed");
+        return;
+      }
+    }
+    DoNotOptimize(file_writer.string());
+  }
+
+  state->SetBytesProcessed(state->iterations() * kTotalSize);
+}
+CRASHPAD_BENCHMARK(BM_StringFileWriterGrowth)->Range(16, 64 * 1024);
+
+// Writes 4MB to a StringFileWriter through WriteIoVec() calls of 1,024 iovecs
+// of range(0) bytes each. The writer is reset between iterations, so this
+// mostly measures the per-iovec cost.
+void BM_StringFileWriterWriteIoVec(BenchmarkState* state) {
+  const size_t iov_size = state->range(0);
+  const size_t kIoVecCount = 1024;
+  const std::string data(iov_size, 'v');
+
+  StringFileWriter file_writer;
+  std::vector<WritableIoVec> iovecs;
+  while (state->KeepRunning()) {
+    file_writer.Reset();
+    for (size_t written = 0; written < kTotalSize;
+         written += iov_size * kIoVecCount) {
+      iovecs.clear();
+      WritableIoVec iov;
+      iov.iov_base = data.data();
+      iov.iov_len = iov_size;
+      iovecs.resize(kIoVecCount, iov);
+      if (!file_writer.WriteIoVec(&iovecs)) {
+        state->SkipWithError("WriteIoVec failed");
+        return;
+      }
+    }
+  }
+
+  state->SetBytesProcessed(state->iterations() * kTotalSize);
+}
+CRASHPAD_BENCHMARK(BM_StringFileWriterWriteIoVec)->Range(8, 4096);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,434 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/zlib_file_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "base/logging.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+namespace {
+
+const char kFramedMagic[4] = {'C', 'P', 'Z', 'F'};
+const uint32_t kFramedVersion = 1;
+
+struct __attribute__((packed)) FramedFileHeader {
+  char magic[4];
+  uint32_t version;
+};
+
+struct __attribute__((packed)) FrameHeader {
+  uint64_t offset;
+  uint32_t uncompressed_size;
+  uint32_t compressed_size;
+};
+
+// The size of the buffer used to collect output from the gzip stream before it
+// is written.
+const size_t kGzipOutputSize = 64 * 1024;
+
+// Combines the gzip wrapper flag with the default window size, as described in
+// the documentation for deflateInit2().
+const int kGzipWindowBits = 16 + MAX_WBITS;
+
+}  // namespace
+
+// static
+const size_t ZlibFileWriter::kFrameSize;
+
+ZlibFileWriter::ZlibFileWriter()
+    : stream_(),
+      output_(),
+      frame_(),
+      file_writer_(NULL),
+      frame_offset_(0),
+      position_(0),
+      end_(0),
+      data_end_(0),
+      format_(kFormatGzip),
+      open_(false) {
+}
+
+ZlibFileWriter::~ZlibFileWriter() {
+  DCHECK(!open_);
+}
+
+bool ZlibFileWriter::Open(FileWriterInterface* file_writer, Format format) {
+  CHECK(!open_);
+
+  file_writer_ = file_writer;
+  format_ = format;
+  frame_offset_ = 0;
+  position_ = 0;
+  end_ = 0;
+  data_end_ = 0;
+
+  switch (format_) {
+    case kFormatGzip: {
+      memset(&stream_, 0, sizeof(stream_));
+      int zr = deflateInit2(&stream_,
+                            Z_DEFAULT_COMPRESSION,
+                            Z_DEFLATED,
+                            kGzipWindowBits,
+                            8,
+                            Z_DEFAULT_STRATEGY);
+      if (zr != Z_OK) {
+        LOG(ERROR) << "deflateInit2: " << zr;
+        return false;
+      }
+
+      output_.resize(kGzipOutputSize);
+      stream_.next_out = &output_[0];
+      stream_.avail_out = output_.size();
+      break;
+    }
+
+    case kFormatFramed: {
+      FramedFileHeader header;
+      memcpy(header.magic, kFramedMagic, sizeof(header.magic));
+      header.version = kFramedVersion;
+      if (!file_writer_->Write(&header, sizeof(header))) {
+        return false;
+      }
+
+      frame_.reserve(kFrameSize);
+      break;
+    }
+
+    default:
+      NOTREACHED();
+      return false;
+  }
+
+  open_ = true;
+  return true;
+}
+
+bool ZlibFileWriter::Close() {
+  CHECK(open_);
+  open_ = false;
+
+  bool rv;
+  if (format_ == kFormatGzip) {
+    rv = Deflate(NULL, 0, true);
+    deflateEnd(&stream_);
+  } else {
+    rv = FlushFrame();
+
+    // If the file was extended by seeking beyond the end of its data, record
+    // where it ends with an empty frame.
+    if (rv && end_ > data_end_) {
+      FrameHeader header;
+      header.offset = end_;
+      header.uncompressed_size = 0;
+      header.compressed_size = 0;
+      rv = file_writer_->Write(&header, sizeof(header));
+    }
+  }
+
+  // Release the buffers, which may be large.
+  std::vector<uint8_t>().swap(output_);
+  std::string().swap(frame_);
+  file_writer_ = NULL;
+
+  return rv;
+}
+
+bool ZlibFileWriter::Write(const void* data, size_t size) {
+  DCHECK(open_);
+
+  off_t new_position;
+  if (!AssignIfInRange(&new_position,
+                       position_ + static_cast<uint64_t>(size))) {
+    LOG(ERROR) << "size " << size << " out of range";
+    return false;
+  }
+
+  if (format_ == kFormatGzip) {
+    if (!Deflate(data, size, false)) {
+      return false;
+    }
+
+    position_ = new_position;
+    end_ = position_;
+    data_end_ = position_;
+    return true;
+  }
+
+  const char* data_c = static_cast<const char*>(data);
+  while (size > 0) {
+    // Start a new frame when the data being written isn’t contiguous with the
+    // current frame’s data, or doesn’t fit in the current frame. Writes that
+    // land within the current frame’s data overwrite it in place.
+    if (position_ < frame_offset_ ||
+        position_ > frame_offset_ + static_cast<off_t>(frame_.size()) ||
+        position_ == frame_offset_ + static_cast<off_t>(kFrameSize)) {
+      if (!FlushFrame()) {
+        return false;
+      }
+      frame_offset_ = position_;
+    }
+
+    size_t frame_position = position_ - frame_offset_;
+    size_t chunk_size = std::min(size, kFrameSize - frame_position);
+    if (frame_position + chunk_size > frame_.size()) {
+      frame_.resize(frame_position + chunk_size);
+    }
+    memcpy(&frame_[frame_position], data_c, chunk_size);
+
+    data_c += chunk_size;
+    size -= chunk_size;
+    position_ += chunk_size;
+  }
+
+  end_ = std::max(end_, position_);
+  data_end_ = std::max(data_end_, position_);
+  return true;
+}
+
+bool ZlibFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  DCHECK(open_);
+
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!Write(iov.iov_base, iov.iov_len)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+off_t ZlibFileWriter::Seek(off_t offset, int whence) {
+  DCHECK(open_);
+
+  if (format_ == kFormatGzip) {
+    LOG(ERROR) << "seek: not supported in gzip format";
+    return -1;
+  }
+
+  off_t base_offset;
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+    case SEEK_CUR:
+      base_offset = position_;
+      break;
+    case SEEK_END:
+      base_offset = end_;
+      break;
+    default:
+      LOG(ERROR) << "seek: invalid whence " << whence;
+      return -1;
+  }
+
+  if ((offset > 0 &&
+       base_offset > std::numeric_limits<off_t>::max() - offset) ||
+      base_offset + offset < 0) {
+    LOG(ERROR) << "seek: offset " << offset << " out of range";
+    return -1;
+  }
+
+  position_ = base_offset + offset;
+  end_ = std::max(end_, position_);
+  return position_;
+}
+
+bool ZlibFileWriter::WillWrite(size_t size) {
+  DCHECK(open_);
+
+  uint64_t compressed_size_bound;
+  if (format_ == kFormatGzip) {
+    compressed_size_bound = deflateBound(&stream_, size);
+  } else {
+    // Data written at a position that isn’t at a frame boundary can occupy one
+    // more frame than its size alone would require.
+    const uint64_t frame_count = (size + kFrameSize - 1) / kFrameSize + 1;
+    compressed_size_bound =
+        frame_count * (sizeof(FrameHeader) + compressBound(kFrameSize));
+  }
+
+  // This is only a hint, so there’s nothing to pass on if the bound doesn’t
+  // fit.
+  size_t local_compressed_size_bound;
+  if (!AssignIfInRange(&local_compressed_size_bound, compressed_size_bound)) {
+    return true;
+  }
+
+  return file_writer_->WillWrite(local_compressed_size_bound);
+}
+
+bool ZlibFileWriter::Deflate(const void* data, size_t size, bool finish) {
+  DCHECK_EQ(format_, kFormatGzip);
+
+  // avail_in is a uInt, which may be narrower than size_t. Feed the data in
+  // pieces that fit.
+  const uint8_t* data_u8 = static_cast<const uint8_t*>(data);
+  do {
+    uInt chunk_size = std::min(size,
+                               static_cast<size_t>(
+                                   std::numeric_limits<uInt>::max()));
+    stream_.next_in = const_cast<Bytef*>(data_u8);
+    stream_.avail_in = chunk_size;
+    data_u8 += chunk_size;
+    size -= chunk_size;
+
+    int flush = finish && size == 0 ? Z_FINISH : Z_NO_FLUSH;
+    int zr;
+    do {
+      zr = deflate(&stream_, flush);
+      if (zr != Z_OK && zr != Z_STREAM_END && zr != Z_BUF_ERROR) {
+        LOG(ERROR) << "deflate: " << zr;
+        return false;
+      }
+
+      if (stream_.avail_out == 0 || (zr == Z_STREAM_END)) {
+        size_t output_size = output_.size() - stream_.avail_out;
+        if (output_size > 0 && !file_writer_->Write(&output_[0], output_size)) {
+          return false;
+        }
+        stream_.next_out = &output_[0];
+        stream_.avail_out = output_.size();
+      }
+    } while (stream_.avail_in > 0 || (flush == Z_FINISH && zr != Z_STREAM_END));
+  } while (size > 0);
+
+  return true;
+}
+
+bool ZlibFileWriter::FlushFrame() {
+  DCHECK_EQ(format_, kFormatFramed);
+
+  if (frame_.empty()) {
+    return true;
+  }
+
+  // Reuse output_ for the compressed data. Its size is bounded by the frame
+  // size.
+  uLongf compressed_size = compressBound(frame_.size());
+  output_.resize(compressed_size);
+  int zr = compress(&output_[0],
+                    &compressed_size,
+                    reinterpret_cast<const Bytef*>(frame_.data()),
+                    frame_.size());
+  if (zr != Z_OK) {
+    LOG(ERROR) << "compress: " << zr;
+    return false;
+  }
+
+  FrameHeader header;
+  header.offset = frame_offset_;
+  header.uncompressed_size = frame_.size();
+  header.compressed_size = compressed_size;
+
+  WritableIoVec iov;
+  iov.iov_base = &header;
+  iov.iov_len = sizeof(header);
+  std::vector<WritableIoVec> iovecs(1, iov);
+  iov.iov_base = &output_[0];
+  iov.iov_len = compressed_size;
+  iovecs.push_back(iov);
+  if (!file_writer_->WriteIoVec(&iovecs)) {
+    return false;
+  }
+
+  frame_.clear();
+  return true;
+}
+
+bool DecodeZlibFramedData(const std::string& framed, std::string* decoded) {
+  FramedFileHeader file_header;
+  if (framed.size() < sizeof(file_header)) {
+    LOG(ERROR) << "framed data too short";
+    return false;
+  }
+
+  memcpy(&file_header, framed.data(), sizeof(file_header));
+  if (memcmp(file_header.magic, kFramedMagic, sizeof(kFramedMagic)) != 0) {
+    LOG(ERROR) << "framed data magic mismatch";
+    return false;
+  }
+  if (file_header.version != kFramedVersion) {
+    LOG(ERROR) << "framed data version " << file_header.version;
+    return false;
+  }
+
+  std::string local_decoded;
+  size_t framed_offset = sizeof(file_header);
+  while (framed_offset < framed.size()) {
+    FrameHeader header;
+    if (framed.size() - framed_offset < sizeof(header)) {
+      LOG(ERROR) << "truncated frame header";
+      return false;
+    }
+    memcpy(&header, &framed[framed_offset], sizeof(header));
+    framed_offset += sizeof(header);
+
+    if (framed.size() - framed_offset < header.compressed_size) {
+      LOG(ERROR) << "truncated frame";
+      return false;
+    }
+
+    size_t frame_offset;
+    if (!AssignIfInRange(&frame_offset, header.offset) ||
+        frame_offset > std::numeric_limits<size_t>::max() -
+                           header.uncompressed_size) {
+      LOG(ERROR) << "frame offset " << header.offset << " out of range";
+      return false;
+    }
+
+    size_t frame_end = frame_offset + header.uncompressed_size;
+    if (frame_end > local_decoded.size()) {
+      local_decoded.resize(frame_end);
+    }
+
+    // A frame with no data only marks the end of the file.
+    if (header.uncompressed_size == 0) {
+      if (header.compressed_size != 0) {
+        LOG(ERROR) << "empty frame with compressed data";
+        return false;
+      }
+      continue;
+    }
+
+    uLongf uncompressed_size = header.uncompressed_size;
+    int zr = uncompress(
+        reinterpret_cast<Bytef*>(&local_decoded[frame_offset]),
+        &uncompressed_size,
+        reinterpret_cast<const Bytef*>(&framed[framed_offset]),
+        header.compressed_size);
+    if (zr != Z_OK) {
+      LOG(ERROR) << "uncompress: " << zr;
+      return false;
+    }
+    if (uncompressed_size != header.uncompressed_size) {
+      LOG(ERROR) << "frame size mismatch";
+      return false;
+    }
+
+    framed_offset += header.compressed_size;
+  }
+
+  decoded->swap(local_decoded);
+  return true;
+}
+
+}  // namespace crashpad
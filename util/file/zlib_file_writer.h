@@ -0,0 +1,174 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_ZLIB_FILE_WRITER_H_
+#define CRASHPAD_UTIL_FILE_ZLIB_FILE_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <zlib.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief A file writer that compresses everything written to it with zlib
+//!     before passing it on to another FileWriterInterface.
+//!
+//! Compression is performed incrementally, so the amount of memory used is
+//! bounded regardless of how much data is written.
+//!
+//! Two output formats are available. kFormatGzip produces a standard gzip
+//! stream, but does not support Seek() at all, so it can only be used with
+//! callers that write sequentially. MinidumpFileWriter::WriteEverything()
+//! seeks, so to produce a gzip-compressed minidump file, write it to a
+//! seekable file writer such as StringFileWriter first, and then write that
+//! content to this object. kFormatFramed produces a sequence of
+//! independently-compressed frames, each of which records the file offset of
+//! the data it contains. This format supports seeking, including seeking
+//! backwards to overwrite data already written, as MinidumpFileWriter does to
+//! finalize a minidump file’s header. It can be decoded by
+//! DecodeZlibFramedData().
+class ZlibFileWriter final : public FileWriterInterface {
+ public:
+  //! \brief The format of the compressed output.
+  enum Format {
+    //! \brief A gzip stream, as described by RFC 1952.
+    //!
+    //! In this format, Seek() always fails.
+    kFormatGzip = 0,
+
+    //! \brief A sequence of independently-compressed frames.
+    //!
+    //! The output begins with the four-byte magic value `CPZF` followed by a
+    //! 32-bit version number. Each frame that follows consists of a 64-bit
+    //! file offset, a 32-bit uncompressed size, and a 32-bit compressed size,
+    //! followed by that many bytes of zlib-compressed data. Where frames
+    //! overlap, data from later frames supersedes data from earlier ones. A
+    //! frame with no data marks the end of the file at its offset, when the
+    //! file was extended by seeking beyond its end. All integers are in host
+    //! byte order.
+    kFormatFramed,
+  };
+
+  //! \brief The maximum amount of uncompressed data held in a single frame in
+  //!     the kFormatFramed format.
+  static const size_t kFrameSize = 256 * 1024;
+
+  ZlibFileWriter();
+  ~ZlibFileWriter();
+
+  //! \brief Begins writing compressed output to \a file_writer.
+  //!
+  //! \param[in] file_writer The file writer to receive compressed output. This
+  //!     object does not take ownership of \a file_writer, which must remain
+  //!     valid until Close() is called.
+  //! \param[in] format The format of the compressed output.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  //!
+  //! \note After a successful call, this method cannot be called again until
+  //!     after Close().
+  bool Open(FileWriterInterface* file_writer, Format format);
+
+  //! \brief Flushes all buffered data to the file writer passed to Open(), and
+  //!     finishes the compressed output.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  //!
+  //! \note It is only valid to call this method on an object that has had a
+  //!     successful Open() that has not yet been matched by a subsequent call
+  //!     to this method.
+  bool Close();
+
+  // FileWriterInterface:
+
+  //! \copydoc FileWriterInterface::Write()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool Write(const void* data, size_t size) override;
+
+  //! \copydoc FileWriterInterface::WriteIoVec()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+
+  //! \copydoc FileWriterInterface::Seek()
+  //!
+  //! This is only supported in the kFormatFramed format, and fails in the
+  //! kFormatGzip format. File positions refer to the uncompressed data. Unlike
+  //! `lseek()`, seeking beyond the end of the data extends it, so the skipped
+  //! region will be decoded as zeroes even if nothing is written after it.
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual off_t Seek(off_t offset, int whence) override;
+
+  //! \copydoc FileWriterInterface::WillWrite()
+  //!
+  //! This passes an upper bound on the size of the compressed output on to
+  //! the file writer passed to Open().
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  virtual bool WillWrite(size_t size) override;
+
+ private:
+  // Compresses |size| bytes at |data| into the gzip stream, writing completed
+  // output to file_writer_. If |finish| is true, the gzip stream is finished.
+  bool Deflate(const void* data, size_t size, bool finish);
+
+  // Compresses the data in frame_ and writes it to file_writer_ as a frame.
+  bool FlushFrame();
+
+  z_stream stream_;
+  std::vector<uint8_t> output_;
+  std::string frame_;
+  FileWriterInterface* file_writer_;  // weak
+  off_t frame_offset_;
+  off_t position_;
+
+  // The end of the file, including any extension made by seeking beyond it,
+  // and the end of the data actually written, which may be less than end_.
+  off_t end_;
+  off_t data_end_;
+
+  Format format_;
+  bool open_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZlibFileWriter);
+};
+
+//! \brief Decodes data written by ZlibFileWriter in the
+//!     ZlibFileWriter::kFormatFramed format.
+//!
+//! \param[in] framed The compressed data.
+//! \param[out] decoded The uncompressed data. Any portion of the uncompressed
+//!     data that was skipped over by seeking and never written will be filled
+//!     with zeroes.
+//!
+//! \return `true` on success. `false` on failure, with an error message logged.
+bool DecodeZlibFramedData(const std::string& framed, std::string* decoded);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_ZLIB_FILE_WRITER_H_
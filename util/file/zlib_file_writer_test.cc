@@ -0,0 +1,261 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/zlib_file_writer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "gtest/gtest.h"
+#include "util/file/string_file_writer.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Returns data that compresses well, but not trivially.
+std::string TestData(size_t size) {
+  std::string data(size, '\0');
+  for (size_t index = 0; index < size; ++index) {
+    data[index] = 'a' + (index / 7) % 26;
+  }
+  return data;
+}
+
+std::string Gunzip(const std::string& compressed) {
+  z_stream stream = {};
+  EXPECT_EQ(Z_OK, inflateInit2(&stream, 16 + MAX_WBITS));
+
+  std::string uncompressed;
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  stream.avail_in = compressed.size();
+  int zr;
+  do {
+    char buffer[4096];
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = sizeof(buffer);
+    zr = inflate(&stream, Z_NO_FLUSH);
+    EXPECT_TRUE(zr == Z_OK || zr == Z_STREAM_END) << zr;
+    uncompressed.append(buffer, sizeof(buffer) - stream.avail_out);
+  } while (zr == Z_OK);
+
+  EXPECT_EQ(Z_STREAM_END, zr);
+  EXPECT_EQ(0u, stream.avail_in);
+  inflateEnd(&stream);
+  return uncompressed;
+}
+
+TEST(ZlibFileWriter, GzipEmpty) {
+  StringFileWriter string_file_writer;
+  ZlibFileWriter writer;
+  ASSERT_TRUE(writer.Open(&string_file_writer, ZlibFileWriter::kFormatGzip));
+  EXPECT_TRUE(writer.Write("", 0));
+  ASSERT_TRUE(writer.Close());
+
+  EXPECT_FALSE(string_file_writer.string().empty());
+  EXPECT_EQ("", Gunzip(string_file_writer.string()));
+}
+
+TEST(ZlibFileWriter, Gzip) {
+  const std::string data = TestData(3 * ZlibFileWriter::kFrameSize + 5);
+
+  StringFileWriter string_file_writer;
+  ZlibFileWriter writer;
+  ASSERT_TRUE(writer.Open(&string_file_writer, ZlibFileWriter::kFormatGzip));
+
+  ASSERT_TRUE(writer.Write(&data[0], 10));
+
+  std::vector<WritableIoVec> iovecs;
+  WritableIoVec iov;
+  iov.iov_base = &data[10];
+  iov.iov_len = 100;
+  iovecs.push_back(iov);
+  iov.iov_base = &data[110];
+  iov.iov_len = data.size() - 110;
+  iovecs.push_back(iov);
+  ASSERT_TRUE(writer.WriteIoVec(&iovecs));
+
+  // Seeking isn’t supported at all, not even to obtain the file position.
+  const off_t size = data.size();
+  EXPECT_EQ(-1, writer.Seek(0, SEEK_CUR));
+  EXPECT_EQ(-1, writer.Seek(size, SEEK_SET));
+  EXPECT_EQ(-1, writer.Seek(0, SEEK_END));
+  EXPECT_EQ(-1, writer.Seek(0, SEEK_SET));
+
+  ASSERT_TRUE(writer.Close());
+
+  EXPECT_LT(string_file_writer.string().size(), data.size() / 10);
+  EXPECT_EQ(data, Gunzip(string_file_writer.string()));
+}
+
+TEST(ZlibFileWriter, FramedEmpty) {
+  StringFileWriter string_file_writer;
+  ZlibFileWriter writer;
+  ASSERT_TRUE(writer.Open(&string_file_writer, ZlibFileWriter::kFormatFramed));
+  ASSERT_TRUE(writer.Close());
+
+  std::string decoded("not empty");
+  ASSERT_TRUE(DecodeZlibFramedData(string_file_writer.string(), &decoded));
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(ZlibFileWriter, Framed) {
+  const std::string data = TestData(3 * ZlibFileWriter::kFrameSize + 5);
+
+  StringFileWriter string_file_writer;
+  ZlibFileWriter writer;
+  ASSERT_TRUE(writer.Open(&string_file_writer, ZlibFileWriter::kFormatFramed));
+  ASSERT_TRUE(writer.Write(&data[0], data.size()));
+  ASSERT_TRUE(writer.Close());
+
+  EXPECT_LT(string_file_writer.string().size(), data.size() / 10);
+
+  std::string decoded;
+  ASSERT_TRUE(DecodeZlibFramedData(string_file_writer.string(), &decoded));
+  EXPECT_EQ(data, decoded);
+}
+
+TEST(ZlibFileWriter, FramedSeek) {
+  std::string expected = TestData(2 * ZlibFileWriter::kFrameSize);
+
+  StringFileWriter string_file_writer;
+  ZlibFileWriter writer;
+  ASSERT_TRUE(writer.Open(&string_file_writer, ZlibFileWriter::kFormatFramed));
+  ASSERT_TRUE(writer.Write(&expected[0], expected.size()));
+
+  // Overwrite data in a frame that’s already been written, as
+  // MinidumpFileWriter does to finalize its header.
+  EXPECT_EQ(4, writer.Seek(4, SEEK_SET));
+  ASSERT_TRUE(writer.Write("HEADER", 6));
+  memcpy(&expected[4], "HEADER", 6);
+  EXPECT_EQ(10, writer.Seek(0, SEEK_CUR));
+
+  // Overwrite data in the frame currently being built, and extend it.
+  const off_t kOverwriteOffset = expected.size() - 3;
+  EXPECT_EQ(kOverwriteOffset, writer.Seek(kOverwriteOffset, SEEK_SET));
+  ASSERT_TRUE(writer.Write("tail", 4));
+  expected.replace(kOverwriteOffset, 3, "tail");
+
+  // Skip past the end and write more. The skipped region reads as zeroes.
+  const off_t end = expected.size();
+  EXPECT_EQ(end, writer.Seek(0, SEEK_END));
+  EXPECT_EQ(end + 8, writer.Seek(8, SEEK_CUR));
+  ASSERT_TRUE(writer.Write("after gap", 9));
+  expected.append(8, '\0');
+  expected.append("after gap");
+
+  EXPECT_EQ(-1, writer.Seek(-1, SEEK_SET));
+  EXPECT_EQ(static_cast<off_t>(expected.size()), writer.Seek(0, SEEK_CUR));
+
+  // Seeking beyond the end extends the file, even without a write following.
+  EXPECT_EQ(static_cast<off_t>(expected.size() + 5), writer.Seek(5, SEEK_END));
+  EXPECT_EQ(static_cast<off_t>(expected.size() + 5), writer.Seek(0, SEEK_END));
+  expected.append(5, '\0');
+
+  ASSERT_TRUE(writer.Close());
+
+  std::string decoded;
+  ASSERT_TRUE(DecodeZlibFramedData(string_file_writer.string(), &decoded));
+  EXPECT_EQ(expected, decoded);
+}
+
+// Records the sizes passed to WillWrite().
+class WillWriteRecordingFileWriter final : public StringFileWriter {
+ public:
+  WillWriteRecordingFileWriter() : StringFileWriter(), will_write_size_(0) {}
+  ~WillWriteRecordingFileWriter() {}
+
+  size_t will_write_size() const { return will_write_size_; }
+
+  // StringFileWriter:
+  virtual bool WillWrite(size_t size) override {
+    will_write_size_ = size;
+    return StringFileWriter::WillWrite(size);
+  }
+
+ private:
+  size_t will_write_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(WillWriteRecordingFileWriter);
+};
+
+TEST(ZlibFileWriter, WillWrite) {
+  // Data that doesn’t compress, so that the compressed output is as large as
+  // it can be.
+  std::string data(2 * ZlibFileWriter::kFrameSize + 5, '\0');
+  uint32_t state = 1;
+  for (char& c : data) {
+    state = state * 1103515245 + 12345;
+    c = static_cast<char>(state >> 24);
+  }
+
+  const ZlibFileWriter::Format kFormats[] = {ZlibFileWriter::kFormatGzip,
+                                             ZlibFileWriter::kFormatFramed};
+  for (ZlibFileWriter::Format format : kFormats) {
+    SCOPED_TRACE(format);
+
+    WillWriteRecordingFileWriter string_file_writer;
+    ZlibFileWriter writer;
+    ASSERT_TRUE(writer.Open(&string_file_writer, format));
+    const size_t header_size = string_file_writer.string().size();
+
+    // The bound passed on must cover everything written after it, starting
+    // partway into a frame.
+    ASSERT_TRUE(writer.Write(&data[0], 1));
+    ASSERT_TRUE(writer.WillWrite(data.size() - 1));
+    ASSERT_TRUE(writer.Write(&data[1], data.size() - 1));
+    ASSERT_TRUE(writer.Close());
+
+    EXPECT_GT(string_file_writer.will_write_size(), 0u);
+    EXPECT_LE(string_file_writer.string().size() - header_size,
+              string_file_writer.will_write_size());
+  }
+}
+
+TEST(ZlibFileWriter, DecodeCorrupt) {
+  const std::string data = TestData(1000);
+
+  StringFileWriter string_file_writer;
+  ZlibFileWriter writer;
+  ASSERT_TRUE(writer.Open(&string_file_writer, ZlibFileWriter::kFormatFramed));
+  ASSERT_TRUE(writer.Write(&data[0], data.size()));
+  ASSERT_TRUE(writer.Close());
+
+  const std::string& framed = string_file_writer.string();
+  std::string decoded;
+  ASSERT_TRUE(DecodeZlibFramedData(framed, &decoded));
+
+  EXPECT_FALSE(DecodeZlibFramedData(std::string(), &decoded));
+  EXPECT_FALSE(DecodeZlibFramedData(framed.substr(0, framed.size() - 1),
+                                    &decoded));
+  EXPECT_FALSE(DecodeZlibFramedData(framed.substr(0, 10), &decoded));
+
+  std::string bad_magic = framed;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(DecodeZlibFramedData(bad_magic, &decoded));
+
+  std::string bad_data = framed;
+  bad_data[bad_data.size() - 4] ^= 0xff;
+  EXPECT_FALSE(DecodeZlibFramedData(bad_data, &decoded));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,190 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/process_memory.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/strings/stringprintf.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+ProcessMemory::ProcessMemory()
+    : mem_fd_(), pid_(-1), use_proc_mem_(false), initialized_() {
+}
+
+ProcessMemory::~ProcessMemory() {
+}
+
+bool ProcessMemory::Initialize(pid_t pid) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  pid_ = pid;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool ProcessMemory::Read(uint64_t address, size_t size, void* buffer) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  char* buffer_c = reinterpret_cast<char*>(buffer);
+  while (size > 0) {
+    ssize_t bytes_read = ReadUpTo(address, size, buffer_c);
+    if (bytes_read < 0) {
+      PLOG(WARNING) << base::StringPrintf(
+          "read pid %d at 0x%llx size 0x%zx",
+          pid_,
+          static_cast<unsigned long long>(address),
+          size);
+      return false;
+    }
+    if (bytes_read == 0) {
+      LOG(WARNING) << base::StringPrintf(
+          "read pid %d at 0x%llx size 0x%zx: unexpected EOF",
+          pid_,
+          static_cast<unsigned long long>(address),
+          size);
+      return false;
+    }
+
+    // A short read happens when the region crosses into an unmapped or
+    // unreadable page. Try again from that page so that the failure, if any,
+    // is reported for it.
+    DCHECK_LE(static_cast<size_t>(bytes_read), size);
+    size -= bytes_read;
+    address += bytes_read;
+    buffer_c += bytes_read;
+  }
+
+  return true;
+}
+
+bool ProcessMemory::ReadBatch(const ReadRequest* requests, size_t count) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  // process_vm_readv() accepts at most IOV_MAX iovecs on each side.
+  const size_t kMaxIovecs = IOV_MAX;
+
+  std::vector<iovec> local_iovs;
+  std::vector<iovec> remote_iovs;
+  while (count > 0 && !use_proc_mem_) {
+    const size_t batch_count = std::min(count, kMaxIovecs);
+    local_iovs.resize(batch_count);
+    remote_iovs.resize(batch_count);
+    size_t batch_size = 0;
+    size_t iov_count = 0;
+    bool addresses_valid = true;
+    for (size_t index = 0; index < batch_count; ++index) {
+      const ReadRequest& request = requests[index];
+      if (request.size == 0) {
+        continue;
+      }
+
+      uintptr_t remote_address;
+      if (!AssignIfInRange(&remote_address, request.address)) {
+        addresses_valid = false;
+        break;
+      }
+
+      local_iovs[iov_count].iov_base = request.buffer;
+      local_iovs[iov_count].iov_len = request.size;
+      remote_iovs[iov_count].iov_base =
+          reinterpret_cast<void*>(remote_address);
+      remote_iovs[iov_count].iov_len = request.size;
+      batch_size += request.size;
+      ++iov_count;
+    }
+
+    ssize_t bytes_read = 0;
+    if (addresses_valid && iov_count > 0) {
+      bytes_read = process_vm_readv(
+          pid_, &local_iovs[0], iov_count, &remote_iovs[0], iov_count, 0);
+      if (bytes_read < 0 && errno == ENOSYS) {
+        use_proc_mem_ = true;
+        break;
+      }
+    }
+
+    // A short or failed read means that at least one region, possibly only
+    // partially, could not be read. Fall back to reading each region
+    // individually, which will identify and report the failure.
+    if (!addresses_valid || bytes_read != static_cast<ssize_t>(batch_size)) {
+      if (!RemoteMemory::ReadBatch(requests, batch_count)) {
+        return false;
+      }
+    }
+
+    requests += batch_count;
+    count -= batch_count;
+  }
+
+  return RemoteMemory::ReadBatch(requests, count);
+}
+
+ssize_t ProcessMemory::ReadUpTo(uint64_t address, size_t size, void* buffer) {
+  if (!use_proc_mem_) {
+    uintptr_t remote_address;
+    if (!AssignIfInRange(&remote_address, address)) {
+      errno = EFAULT;
+      return -1;
+    }
+
+    iovec local_iov;
+    local_iov.iov_base = buffer;
+    local_iov.iov_len = size;
+    iovec remote_iov;
+    remote_iov.iov_base = reinterpret_cast<void*>(remote_address);
+    remote_iov.iov_len = size;
+    ssize_t bytes_read =
+        process_vm_readv(pid_, &local_iov, 1, &remote_iov, 1, 0);
+    if (bytes_read >= 0 || errno != ENOSYS) {
+      return bytes_read;
+    }
+
+    // process_vm_readv() was introduced in Linux 3.2. On older kernels, fall
+    // back to /proc/pid/mem from now on. Only ENOSYS is treated this way. A
+    // seccomp policy that disallows the call usually fails it with EPERM,
+    // which is reported like any other error.
+    use_proc_mem_ = true;
+  }
+
+  if (!mem_fd_.is_valid()) {
+    std::string path = base::StringPrintf("/proc/%d/mem", pid_);
+    mem_fd_.reset(HANDLE_EINTR(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (!mem_fd_.is_valid()) {
+      return -1;
+    }
+  }
+
+  off64_t offset;
+  if (!AssignIfInRange(&offset, address)) {
+    errno = EFAULT;
+    return -1;
+  }
+
+  return HANDLE_EINTR(pread64(mem_fd_.get(), buffer, size, offset));
+}
+
+}  // namespace crashpad
@@ -0,0 +1,73 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PROCESS_MEMORY_H_
+#define CRASHPAD_UTIL_LINUX_PROCESS_MEMORY_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "base/basictypes.h"
+#include "base/files/scoped_file.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/misc/remote_memory.h"
+
+namespace crashpad {
+
+//! \brief Accesses the memory of another process on Linux.
+//!
+//! Memory is read with `process_vm_readv()`, which copies directly from the
+//! target process into a buffer in the current process without requiring the
+//! target to be stopped. On systems where `process_vm_readv()` is unavailable,
+//! `/proc/pid/mem` is used instead. Either way, the current process must be
+//! permitted to `ptrace()` the target process.
+class ProcessMemory final : public RemoteMemory {
+ public:
+  ProcessMemory();
+  virtual ~ProcessMemory();
+
+  //! \brief Initializes this object to read the memory of a process.
+  //!
+  //! \param[in] pid The process ID of the target process.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(pid_t pid);
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override;
+
+  //! \copydoc RemoteMemory::ReadBatch
+  //!
+  //! This implementation reads all of the regions in \a requests with a single
+  //! call to `process_vm_readv()` where possible.
+  virtual bool ReadBatch(const ReadRequest* requests, size_t count) override;
+
+ private:
+  // Reads up to |size| bytes at |address| into |buffer|, returning the number
+  // of bytes read as read() would. Falls back to /proc/pid/mem when
+  // process_vm_readv() is not available.
+  ssize_t ReadUpTo(uint64_t address, size_t size, void* buffer);
+
+  base::ScopedFD mem_fd_;  // /proc/pid/mem, opened only if needed
+  pid_t pid_;
+  bool use_proc_mem_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PROCESS_MEMORY_H_
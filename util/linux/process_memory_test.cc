@@ -0,0 +1,290 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/process_memory.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "util/file/fd_io.h"
+#include "util/test/errors.h"
+#include "util/test/multiprocess.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Maps anonymous memory and unmaps it on destruction.
+class ScopedMmap {
+ public:
+  explicit ScopedMmap(size_t size)
+      : address_(mmap(NULL,
+                      size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1,
+                      0)),
+        size_(size) {
+  }
+
+  ~ScopedMmap() {
+    if (is_valid()) {
+      munmap(address_, size_);
+    }
+  }
+
+  bool is_valid() const { return address_ != MAP_FAILED; }
+  char* addr() const { return reinterpret_cast<char*>(address_); }
+  uint64_t addr_as_uint64() const {
+    return reinterpret_cast<uintptr_t>(address_);
+  }
+
+ private:
+  void* address_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedMmap);
+};
+
+TEST(ProcessMemory, ReadSelf) {
+  const size_t kPageSize = getpagesize();
+  const size_t kSize = 4 * kPageSize;
+  ScopedMmap mapping(kSize);
+  ASSERT_TRUE(mapping.is_valid()) << ErrnoMessage("mmap");
+
+  char* region = mapping.addr();
+  for (size_t index = 0; index < kSize; ++index) {
+    region[index] = (index % 256) ^ ((index >> 8) % 256);
+  }
+
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+
+  // Ensure that the entire region can be read.
+  std::string result(kSize, '\0');
+  ASSERT_TRUE(memory.Read(mapping.addr_as_uint64(), kSize, &result[0]));
+  EXPECT_EQ(0, memcmp(region, &result[0], kSize));
+
+  // Ensure that a read of length 0 succeeds and doesn’t touch the result.
+  result.assign(kSize, '\0');
+  std::string zeroes = result;
+  ASSERT_TRUE(memory.Read(mapping.addr_as_uint64(), 0, &result[0]));
+  EXPECT_EQ(zeroes, result);
+
+  // Ensure that a read of length 1 succeeds.
+  ASSERT_TRUE(memory.Read(mapping.addr_as_uint64(), 1, &result[0]));
+  EXPECT_EQ(region[0], result[0]);
+
+  // Ensure that a read that spans pages succeeds.
+  ASSERT_TRUE(memory.Read(
+      mapping.addr_as_uint64() + kPageSize - 8, 16, &result[0]));
+  EXPECT_EQ(0, memcmp(region + kPageSize - 8, &result[0], 16));
+
+  // Ensure that a read ending at the end of the region succeeds.
+  ASSERT_TRUE(memory.Read(
+      mapping.addr_as_uint64() + kSize - 1, 1, &result[0]));
+  EXPECT_EQ(region[kSize - 1], result[0]);
+}
+
+TEST(ProcessMemory, ReadSelfUnmapped) {
+  const size_t kPageSize = getpagesize();
+  const size_t kSize = 2 * kPageSize;
+  ScopedMmap mapping(kSize);
+  ASSERT_TRUE(mapping.is_valid()) << ErrnoMessage("mmap");
+
+  char* region = mapping.addr();
+  for (size_t index = 0; index < kSize; ++index) {
+    // Don’t include any NUL bytes, because ReadCString stops when it encounters
+    // a NUL.
+    region[index] = (index % 255) + 1;
+  }
+
+  ASSERT_EQ(0, mprotect(region + kPageSize, kPageSize, PROT_NONE))
+      << ErrnoMessage("mprotect");
+
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+
+  const uint64_t address = mapping.addr_as_uint64();
+  std::string result(kSize, '\0');
+
+  EXPECT_FALSE(memory.Read(address, kSize, &result[0]));
+  EXPECT_FALSE(memory.Read(address + 1, kSize - 1, &result[0]));
+  EXPECT_FALSE(memory.Read(address + kPageSize, 1, &result[0]));
+  EXPECT_FALSE(memory.Read(address + kPageSize - 1, 2, &result[0]));
+  EXPECT_TRUE(memory.Read(address, kPageSize, &result[0]));
+  EXPECT_TRUE(memory.Read(address + kPageSize - 1, 1, &result[0]));
+
+  // Repeat with ReadCString(). The string runs off the end of the readable
+  // page without being NUL-terminated.
+  std::string string;
+  EXPECT_FALSE(memory.ReadCString(address, &string));
+  EXPECT_FALSE(memory.ReadCString(address + kPageSize - 1, &string));
+
+  // Terminate the string at the end of the readable page and try again.
+  region[kPageSize - 1] = '\0';
+  ASSERT_TRUE(memory.ReadCString(address, &string));
+  EXPECT_EQ(kPageSize - 1, string.size());
+  EXPECT_EQ(std::string(region, kPageSize - 1), string);
+}
+
+TEST(ProcessMemory, ReadBatchSelf) {
+  const size_t kPageSize = getpagesize();
+  const size_t kSize = 3 * kPageSize;
+  ScopedMmap mapping(kSize);
+  ASSERT_TRUE(mapping.is_valid()) << ErrnoMessage("mmap");
+
+  char* region = mapping.addr();
+  for (size_t index = 0; index < kSize; ++index) {
+    region[index] = (index % 255) + 1;
+  }
+
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+
+  const uint64_t address = mapping.addr_as_uint64();
+  char buffers[3][16];
+  RemoteMemory::ReadRequest requests[4];
+  requests[0].address = address + 1;
+  requests[1].address = address + kPageSize - 8;
+  requests[2].address = address + kSize - sizeof(buffers[2]);
+  for (size_t index = 0; index < arraysize(buffers); ++index) {
+    requests[index].size = sizeof(buffers[index]);
+    requests[index].buffer = buffers[index];
+  }
+
+  // A zero-length request is permitted and doesn’t touch its buffer.
+  requests[3].address = 0;
+  requests[3].size = 0;
+  requests[3].buffer = NULL;
+
+  ASSERT_TRUE(memory.ReadBatch(requests, arraysize(requests)));
+  for (size_t index = 0; index < arraysize(buffers); ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(0,
+              memcmp(region + (requests[index].address - address),
+                     buffers[index],
+                     sizeof(buffers[index])));
+  }
+
+  // Make the middle page unreadable. A batch that touches it fails, and one
+  // that avoids it succeeds.
+  ASSERT_EQ(0, mprotect(region + kPageSize, kPageSize, PROT_NONE))
+      << ErrnoMessage("mprotect");
+  EXPECT_FALSE(memory.ReadBatch(requests, arraysize(requests)));
+
+  requests[1].address = address + kPageSize - sizeof(buffers[1]);
+  ASSERT_TRUE(memory.ReadBatch(requests, arraysize(requests)));
+  EXPECT_EQ(0,
+            memcmp(region + kPageSize - sizeof(buffers[1]),
+                   buffers[1],
+                   sizeof(buffers[1])));
+}
+
+TEST(ProcessMemory, ReadCStringSelf) {
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+
+  std::string result;
+
+  const char kConstCharEmpty[] = "";
+  ASSERT_TRUE(memory.ReadCString(reinterpret_cast<uintptr_t>(kConstCharEmpty),
+                                 &result));
+  EXPECT_TRUE(result.empty());
+
+  const char kConstCharShort[] = "A short const char[]";
+  ASSERT_TRUE(memory.ReadCString(reinterpret_cast<uintptr_t>(kConstCharShort),
+                                 &result));
+  EXPECT_EQ(kConstCharShort, result);
+
+  // A string that spans several pages.
+  std::string long_string(3 * getpagesize() + 10, 'x');
+  for (size_t index = 0; index < long_string.size(); ++index) {
+    long_string[index] = 'A' + index % 26;
+  }
+  ASSERT_TRUE(memory.ReadCString(
+      reinterpret_cast<uintptr_t>(long_string.c_str()), &result));
+  EXPECT_EQ(long_string, result);
+}
+
+TEST(ProcessMemory, ReadCStringSizeLimited) {
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+
+  const char kConstCharShort[] = "A short const char[]";
+  const uint64_t address = reinterpret_cast<uintptr_t>(kConstCharShort);
+  std::string result;
+
+  ASSERT_TRUE(memory.ReadCStringSizeLimited(
+      address, arraysize(kConstCharShort), &result));
+  EXPECT_EQ(kConstCharShort, result);
+
+  ASSERT_TRUE(memory.ReadCStringSizeLimited(
+      address, arraysize(kConstCharShort) + 1, &result));
+  EXPECT_EQ(kConstCharShort, result);
+
+  // The NUL terminator doesn’t fit within the limit.
+  EXPECT_FALSE(memory.ReadCStringSizeLimited(
+      address, arraysize(kConstCharShort) - 1, &result));
+}
+
+const char kTestMemory[] = "Read me from another process";
+
+class ProcessMemoryChild final : public Multiprocess {
+ public:
+  ProcessMemoryChild() : Multiprocess() {}
+
+  ~ProcessMemoryChild() {}
+
+ private:
+  virtual void MultiprocessParent() override {
+    ProcessMemory memory;
+    ASSERT_TRUE(memory.Initialize(ChildPID()));
+
+    uint64_t address;
+    CheckedReadFD(ReadPipeFD(), &address, sizeof(address));
+
+    char buffer[arraysize(kTestMemory)];
+    ASSERT_TRUE(memory.Read(address, sizeof(buffer), buffer));
+    EXPECT_STREQ(kTestMemory, buffer);
+
+    std::string read_string;
+    ASSERT_TRUE(memory.ReadCString(address, &read_string));
+    EXPECT_EQ(kTestMemory, read_string);
+  }
+
+  virtual void MultiprocessChild() override {
+    uint64_t address = reinterpret_cast<uintptr_t>(kTestMemory);
+    CheckedWriteFD(WritePipeFD(), &address, sizeof(address));
+
+    // Wait for the parent to signal that it’s OK to exit by closing its end of
+    // the pipe.
+    CheckedReadFDAtEOF(ReadPipeFD());
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessMemoryChild);
+};
+
+TEST(ProcessMemory, ReadChild) {
+  ProcessMemoryChild process_memory_child;
+  process_memory_child.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
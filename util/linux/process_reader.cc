@@ -0,0 +1,535 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/process_reader.h"
+
+#include <dirent.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/files/scoped_file.h"
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/strings/stringprintf.h"
+#include "build/build_config.h"
+#include "util/file/fd_io.h"
+
+namespace {
+
+// Reads the entire contents of a file, typically one in /proc, whose size may
+// not be known ahead of time.
+bool ReadProcFile(const std::string& path, std::string* contents) {
+  base::ScopedFD fd(HANDLE_EINTR(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+  if (!fd.is_valid()) {
+    PLOG(WARNING) << "open " << path;
+    return false;
+  }
+
+  std::string local_contents;
+  char buffer[4096];
+  ssize_t bytes_read;
+  while ((bytes_read = crashpad::ReadFD(fd.get(), buffer, sizeof(buffer))) >
+         0) {
+    local_contents.append(buffer, bytes_read);
+  }
+  if (bytes_read < 0) {
+    PLOG(WARNING) << "read " << path;
+    return false;
+  }
+
+  contents->swap(local_contents);
+  return true;
+}
+
+// Splits the contents of a /proc/pid/stat or /proc/pid/task/tid/stat file into
+// fields. The second field, the command name, is enclosed in parentheses and
+// may itself contain spaces and parentheses, so it’s skipped by searching for
+// the last ‘)’. The first element of |fields| will be the third field
+// described in proc(5), “state”.
+bool SplitStatFields(const std::string& stat,
+                     std::vector<std::string>* fields) {
+  size_t comm_end = stat.rfind(')');
+  if (comm_end == std::string::npos) {
+    LOG(WARNING) << "unexpected stat format";
+    return false;
+  }
+
+  fields->clear();
+  size_t position = comm_end + 1;
+  while (true) {
+    position = stat.find_first_not_of(" \n", position);
+    if (position == std::string::npos) {
+      break;
+    }
+    size_t field_end = stat.find_first_of(" \n", position);
+    fields->push_back(stat.substr(position, field_end - position));
+    position = field_end;
+  }
+
+  return true;
+}
+
+// Indices into the vector produced by SplitStatFields() for the fields of
+// interest. These are the field numbers from proc(5), less 3.
+const size_t kStatPPID = 4 - 3;
+const size_t kStatUTime = 14 - 3;
+const size_t kStatSTime = 15 - 3;
+const size_t kStatPriority = 18 - 3;
+const size_t kStatStartTime = 22 - 3;
+
+bool ReadStatFields(const std::string& path,
+                    size_t minimum_fields,
+                    std::vector<std::string>* fields) {
+  std::string stat;
+  if (!ReadProcFile(path, &stat) || !SplitStatFields(stat, fields)) {
+    return false;
+  }
+
+  if (fields->size() < minimum_fields) {
+    LOG(WARNING) << "unexpected " << path << " format";
+    return false;
+  }
+
+  return true;
+}
+
+void ClockTicksToTimeval(unsigned long long ticks, timeval* tv) {
+  long ticks_per_second = sysconf(_SC_CLK_TCK);
+  tv->tv_sec = ticks / ticks_per_second;
+  tv->tv_usec = (ticks % ticks_per_second) * (1000000 / ticks_per_second);
+}
+
+// Returns the boot time, as a time_t, from the btime line in /proc/stat.
+bool GetBootTime(time_t* boot_time) {
+  std::string stat;
+  if (!ReadProcFile("/proc/stat", &stat)) {
+    return false;
+  }
+
+  const char kBootTimePrefix[] = "\nbtime ";
+  size_t position = stat.find(kBootTimePrefix);
+  if (position == std::string::npos) {
+    LOG(WARNING) << "btime not found in /proc/stat";
+    return false;
+  }
+
+  *boot_time = strtoll(&stat[position + strlen(kBootTimePrefix)], NULL, 10);
+  return true;
+}
+
+// Determines whether the executable at |path| is a 64-bit ELF image.
+bool IsELF64(const std::string& path, bool* is_64_bit) {
+  base::ScopedFD fd(HANDLE_EINTR(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+  if (!fd.is_valid()) {
+    PLOG(WARNING) << "open " << path;
+    return false;
+  }
+
+  unsigned char ident[EI_NIDENT];
+  ssize_t bytes_read = crashpad::ReadFD(fd.get(), ident, sizeof(ident));
+  if (bytes_read != static_cast<ssize_t>(sizeof(ident))) {
+    PLOG_IF(WARNING, bytes_read < 0) << "read " << path;
+    LOG_IF(WARNING, bytes_read >= 0) << "short read " << path;
+    return false;
+  }
+
+  if (memcmp(ident, ELFMAG, SELFMAG) != 0) {
+    LOG(WARNING) << path << " is not an ELF image";
+    return false;
+  }
+
+  switch (ident[EI_CLASS]) {
+    case ELFCLASS32:
+      *is_64_bit = false;
+      return true;
+    case ELFCLASS64:
+      *is_64_bit = true;
+      return true;
+    default:
+      LOG(WARNING) << "unexpected ELF class " << ident[EI_CLASS];
+      return false;
+  }
+}
+
+}  // namespace
+
+namespace crashpad {
+
+ProcessReader::Thread::Thread()
+    : id(0),
+      stack_pointer(0),
+      stack_region_address(0),
+      stack_region_size(0),
+      priority(0) {
+}
+
+ProcessReader::Mapping::Mapping()
+    : name(),
+      range_start(0),
+      range_end(0),
+      offset(0),
+      inode(0),
+      device(0),
+      readable(false),
+      writable(false),
+      executable(false),
+      shareable(false) {
+}
+
+ProcessReader::Mapping::~Mapping() {
+}
+
+ProcessReader::Module::Module() : name(), base_address(0), size(0) {
+}
+
+ProcessReader::Module::~Module() {
+}
+
+ProcessReader::ProcessReader()
+    : threads_(),
+      mappings_(),
+      modules_(),
+      process_memory_(),
+      start_time_(),
+      pid_(-1),
+      ppid_(-1),
+      initialized_(),
+      is_64_bit_(false),
+      initialized_threads_(false),
+      initialized_mappings_(false),
+      initialized_modules_(false) {
+}
+
+ProcessReader::~ProcessReader() {
+}
+
+bool ProcessReader::Initialize(pid_t pid) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  std::vector<std::string> stat_fields;
+  if (!ReadStatFields(base::StringPrintf("/proc/%d/stat", pid),
+                      kStatStartTime + 1,
+                      &stat_fields)) {
+    return false;
+  }
+
+  ppid_ = atoi(stat_fields[kStatPPID].c_str());
+
+  time_t boot_time;
+  if (!GetBootTime(&boot_time)) {
+    return false;
+  }
+  ClockTicksToTimeval(strtoull(stat_fields[kStatStartTime].c_str(), NULL, 10),
+                      &start_time_);
+  start_time_.tv_sec += boot_time;
+
+  if (!IsELF64(base::StringPrintf("/proc/%d/exe", pid), &is_64_bit_)) {
+    return false;
+  }
+
+  if (!process_memory_.Initialize(pid)) {
+    return false;
+  }
+
+  pid_ = pid;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+void ProcessReader::StartTime(timeval* start_time) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  *start_time = start_time_;
+}
+
+bool ProcessReader::CPUTimes(timeval* user_time, timeval* system_time) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  timerclear(user_time);
+  timerclear(system_time);
+
+  // The process-wide stat file accounts for all threads, including those that
+  // have already exited.
+  std::vector<std::string> stat_fields;
+  if (!ReadStatFields(base::StringPrintf("/proc/%d/stat", pid_),
+                      kStatSTime + 1,
+                      &stat_fields)) {
+    return false;
+  }
+
+  ClockTicksToTimeval(strtoull(stat_fields[kStatUTime].c_str(), NULL, 10),
+                      user_time);
+  ClockTicksToTimeval(strtoull(stat_fields[kStatSTime].c_str(), NULL, 10),
+                      system_time);
+
+  return true;
+}
+
+const std::vector<ProcessReader::Thread>& ProcessReader::Threads() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (!initialized_threads_) {
+    InitializeThreads();
+  }
+
+  return threads_;
+}
+
+const std::vector<ProcessReader::Mapping>& ProcessReader::Mappings() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (!initialized_mappings_) {
+    InitializeMappings();
+  }
+
+  return mappings_;
+}
+
+const std::vector<ProcessReader::Module>& ProcessReader::Modules() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (!initialized_modules_) {
+    InitializeModules();
+  }
+
+  return modules_;
+}
+
+void ProcessReader::InitializeThreads() {
+  DCHECK(!initialized_threads_);
+  DCHECK(threads_.empty());
+
+  initialized_threads_ = true;
+
+  std::string task_path = base::StringPrintf("/proc/%d/task", pid_);
+  DIR* task_dir = opendir(task_path.c_str());
+  if (!task_dir) {
+    PLOG(WARNING) << "opendir " << task_path;
+    return;
+  }
+
+  std::vector<pid_t> tids;
+  dirent* entry;
+  while ((entry = readdir(task_dir))) {
+    char* end;
+    long tid = strtol(entry->d_name, &end, 10);
+    if (end != entry->d_name && *end == '\0' && tid > 0) {
+      tids.push_back(tid);
+    }
+  }
+  closedir(task_dir);
+
+  // The main thread’s ID is the same as the process ID. Put it first, and keep
+  // the rest in creation order, which is also ascending thread ID order unless
+  // thread IDs have wrapped.
+  std::sort(tids.begin(), tids.end());
+  auto main_thread = std::find(tids.begin(), tids.end(), pid_);
+  if (main_thread != tids.end()) {
+    std::rotate(tids.begin(), main_thread, main_thread + 1);
+  }
+
+  for (pid_t tid : tids) {
+    Thread thread;
+    thread.id = tid;
+
+    // Threads may exit while being enumerated. Skip any that do.
+    std::vector<std::string> stat_fields;
+    if (!ReadStatFields(
+            base::StringPrintf("/proc/%d/task/%d/stat", pid_, tid),
+            kStatPriority + 1,
+            &stat_fields)) {
+      continue;
+    }
+    thread.priority = atoi(stat_fields[kStatPriority].c_str());
+
+    // The syscall file contains “running” for a running thread. Otherwise, it
+    // contains the system call number and arguments (or only “-1” when the
+    // thread is blocked but not in a system call), followed by the stack
+    // pointer and program counter.
+    std::string syscall;
+    if (ReadProcFile(
+            base::StringPrintf("/proc/%d/task/%d/syscall", pid_, tid),
+            &syscall) &&
+        syscall.compare(0, 7, "running") != 0) {
+      std::vector<std::string> syscall_fields;
+      if (SplitStatFields(")" + syscall, &syscall_fields) &&
+          syscall_fields.size() >= 3) {
+        thread.stack_pointer = strtoull(
+            syscall_fields[syscall_fields.size() - 2].c_str(), NULL, 16);
+      }
+    }
+
+    if (thread.stack_pointer) {
+      thread.stack_region_address =
+          CalculateStackRegion(thread.stack_pointer, &thread.stack_region_size);
+    }
+
+    threads_.push_back(thread);
+  }
+}
+
+void ProcessReader::InitializeMappings() {
+  DCHECK(!initialized_mappings_);
+  DCHECK(mappings_.empty());
+
+  initialized_mappings_ = true;
+
+  std::string maps;
+  if (!ReadProcFile(base::StringPrintf("/proc/%d/maps", pid_), &maps)) {
+    return;
+  }
+
+  size_t line_start = 0;
+  while (line_start < maps.size()) {
+    size_t line_end = maps.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = maps.size();
+    }
+    std::string line = maps.substr(line_start, line_end - line_start);
+    line_start = line_end + 1;
+
+    Mapping mapping;
+    char permissions[5];
+    unsigned int device_major;
+    unsigned int device_minor;
+    int name_start = 0;
+    if (sscanf(line.c_str(),
+               "%" SCNx64 "-%" SCNx64 " %4s %" SCNx64 " %x:%x %" SCNu64 " %n",
+               &mapping.range_start,
+               &mapping.range_end,
+               permissions,
+               &mapping.offset,
+               &device_major,
+               &device_minor,
+               &mapping.inode,
+               &name_start) != 7 ||
+        strlen(permissions) != 4 ||
+        mapping.range_end < mapping.range_start) {
+      LOG(WARNING) << "unexpected maps line: " << line;
+      continue;
+    }
+
+    mapping.device = makedev(device_major, device_minor);
+    mapping.readable = permissions[0] == 'r';
+    mapping.writable = permissions[1] == 'w';
+    mapping.executable = permissions[2] == 'x';
+    mapping.shareable = permissions[3] == 's';
+    if (name_start > 0) {
+      mapping.name = line.substr(name_start);
+    }
+
+    mappings_.push_back(mapping);
+  }
+}
+
+void ProcessReader::InitializeModules() {
+  DCHECK(!initialized_modules_);
+  DCHECK(modules_.empty());
+
+  initialized_modules_ = true;
+
+  std::string exe_path = base::StringPrintf("/proc/%d/exe", pid_);
+  char exe_name[PATH_MAX];
+  ssize_t exe_name_length =
+      readlink(exe_path.c_str(), exe_name, sizeof(exe_name));
+  if (exe_name_length < 0) {
+    PLOG(WARNING) << "readlink " << exe_path;
+    exe_name_length = 0;
+  }
+  std::string main_executable(exe_name, exe_name_length);
+
+  // A module occupies a run of consecutive mappings of the same file, one for
+  // each of its segments, beginning with the mapping at file offset 0.
+  // Anonymous mappings (such as .bss) that follow a module’s mappings are not
+  // considered part of it.
+  const std::vector<Mapping>& mappings = Mappings();
+  for (size_t index = 0; index < mappings.size(); ++index) {
+    const Mapping& mapping = mappings[index];
+    if (mapping.inode == 0 || mapping.offset != 0 || mapping.name.empty() ||
+        mapping.name[0] != '/') {
+      continue;
+    }
+
+    Module module;
+    module.name = mapping.name;
+    module.base_address = mapping.range_start;
+    uint64_t module_end = mapping.range_end;
+    while (index + 1 < mappings.size() &&
+           mappings[index + 1].inode == mapping.inode &&
+           mappings[index + 1].device == mapping.device &&
+           mappings[index + 1].offset != 0) {
+      ++index;
+      module_end = mappings[index].range_end;
+    }
+    module.size = module_end - module.base_address;
+
+    modules_.push_back(module);
+  }
+
+  // Move the main executable to the front, keeping the rest in address order.
+  auto main_module = std::find_if(modules_.begin(),
+                                  modules_.end(),
+                                  [&main_executable](const Module& module) {
+                                    return module.name == main_executable;
+                                  });
+  if (main_module != modules_.end()) {
+    std::rotate(modules_.begin(), main_module, main_module + 1);
+  }
+}
+
+uint64_t ProcessReader::CalculateStackRegion(uint64_t stack_pointer,
+                                             uint64_t* stack_region_size) {
+  const std::vector<Mapping>& mappings = Mappings();
+
+  auto mapping = std::upper_bound(
+      mappings.begin(),
+      mappings.end(),
+      stack_pointer,
+      [](uint64_t address, const Mapping& mapping) {
+        return address < mapping.range_end;
+      });
+  if (mapping == mappings.end() || stack_pointer < mapping->range_start ||
+      !mapping->readable) {
+    *stack_region_size = 0;
+    return 0;
+  }
+
+  uint64_t start_address = stack_pointer;
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  // The x86_64 ABI specifies a 128-byte red zone below the stack pointer that
+  // leaf functions may use without adjusting the stack pointer. Capture it,
+  // provided that it’s part of the same mapping.
+  if (Is64Bit()) {
+    const uint64_t kRedZoneSize = 128;
+    start_address =
+        std::max(mapping->range_start,
+                 start_address > kRedZoneSize ? start_address - kRedZoneSize
+                                              : 0);
+  }
+#endif
+
+  *stack_region_size = mapping->range_end - start_address;
+  return start_address;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,224 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PROCESS_READER_H_
+#define CRASHPAD_UTIL_LINUX_PROCESS_READER_H_
+
+#include <stdint.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "util/linux/process_memory.h"
+#include "util/misc/initialization_state_dcheck.h"
+
+namespace crashpad {
+
+//! \brief Accesses information about another process, identified by a process
+//!     ID, on Linux.
+//!
+//! Information is obtained from the `/proc` filesystem, and memory is read by
+//! a ProcessMemory object. As with the Mac OS X implementation, information
+//! about threads, memory mappings, and modules is only collected when it is
+//! first requested.
+//!
+//! The current process must be permitted to `ptrace()` the target process.
+//! Thread register state is not available without attaching to the target
+//! with `ptrace()`, which this class does not do.
+class ProcessReader {
+ public:
+  //! \brief Contains information about a thread that belongs to a process.
+  struct Thread {
+    Thread();
+    ~Thread() {}
+
+    //! \brief The thread’s ID, as used by the kernel (its `tid`).
+    uint64_t id;
+
+    //! \brief The thread’s stack pointer, if it could be determined from
+    //!     `/proc/pid/task/tid/syscall`, or `0` if not.
+    //!
+    //! The stack pointer is only available for threads that are blocked, which
+    //! is normally the case for every thread of a process that is being
+    //! dumped.
+    uint64_t stack_pointer;
+
+    //! \brief The base address of the memory region used as the thread’s
+    //!     stack, or `0` if it could not be determined.
+    uint64_t stack_region_address;
+
+    //! \brief The size of the memory region used as the thread’s stack.
+    uint64_t stack_region_size;
+
+    //! \brief The thread’s scheduling priority, as reported in
+    //!     `/proc/pid/task/tid/stat`.
+    int priority;
+  };
+
+  //! \brief Describes a single mapping listed in `/proc/pid/maps`.
+  struct Mapping {
+    Mapping();
+    ~Mapping();
+
+    //! \brief The pathname of the mapped file, or a pseudo-path such as
+    //!     `[stack]`. Empty for anonymous mappings.
+    std::string name;
+
+    //! \brief The address of the first byte of the mapping.
+    uint64_t range_start;
+
+    //! \brief The address of the first byte beyond the end of the mapping.
+    uint64_t range_end;
+
+    //! \brief The offset of the mapping into the mapped file.
+    uint64_t offset;
+
+    //! \brief The inode of the mapped file, or `0` if none.
+    uint64_t inode;
+
+    //! \brief The device containing the mapped file.
+    dev_t device;
+
+    //! \brief Whether the mapping is readable.
+    bool readable;
+
+    //! \brief Whether the mapping is writable.
+    bool writable;
+
+    //! \brief Whether the mapping is executable.
+    bool executable;
+
+    //! \brief Whether the mapping is shared, as opposed to private
+    //!     (copy-on-write).
+    bool shareable;
+  };
+
+  //! \brief Contains information about a module loaded into a process.
+  struct Module {
+    Module();
+    ~Module();
+
+    //! \brief The pathname used to load the module from disk.
+    std::string name;
+
+    //! \brief The address at which the first page of the module is mapped.
+    uint64_t base_address;
+
+    //! \brief The size of the address range spanned by the module’s mappings.
+    uint64_t size;
+  };
+
+  ProcessReader();
+  ~ProcessReader();
+
+  //! \brief Initializes this object. This method must be called before any
+  //!     other.
+  //!
+  //! \param[in] pid The process ID of the target process.
+  //!
+  //! \return `true` on success, indicating that this object will respond
+  //!     validly to further method calls. `false` on failure. On failure, no
+  //!     further method calls should be made.
+  bool Initialize(pid_t pid);
+
+  //! \return `true` if the target process is a 64-bit process.
+  bool Is64Bit() const { return is_64_bit_; }
+
+  //! \return The target process’ process ID.
+  pid_t ProcessID() const { return pid_; }
+
+  //! \return The target process’ parent process ID.
+  pid_t ParentProcessID() const { return ppid_; }
+
+  //! \param[out] start_time The time that the process started.
+  void StartTime(timeval* start_time) const;
+
+  //! \param[out] user_time The amount of time the process has executed code in
+  //!     user mode.
+  //! \param[out] system_time The amount of time the process has executed code
+  //!     in system mode.
+  //!
+  //! \return `true` on success, `false` on failure, with a warning logged. On
+  //!     failure, \a user_time and \a system_time will be set to represent no
+  //!     time spent executing code in user or system mode.
+  bool CPUTimes(timeval* user_time, timeval* system_time) const;
+
+  //! \return Accesses the memory of the target process.
+  ProcessMemory* Memory() { return &process_memory_; }
+
+  //! \return The threads that are in the process. The first element (at index
+  //!     `0`) corresponds to the main thread.
+  const std::vector<Thread>& Threads();
+
+  //! \return The memory mappings of the process, in ascending address order.
+  const std::vector<Mapping>& Mappings();
+
+  //! \return The modules loaded in the process. The first element (at index
+  //!     `0`) corresponds to the main executable. The remaining elements are in
+  //!     ascending address order.
+  const std::vector<Module>& Modules();
+
+ private:
+  //! Performs lazy initialization of the \a threads_ vector on behalf of
+  //! Threads().
+  void InitializeThreads();
+
+  //! Performs lazy initialization of the \a mappings_ vector on behalf of
+  //! Mappings().
+  void InitializeMappings();
+
+  //! Performs lazy initialization of the \a modules_ vector on behalf of
+  //! Modules().
+  void InitializeModules();
+
+  //! \brief Calculates the base address and size of the region used as a
+  //!     thread’s stack.
+  //!
+  //! The region begins at \a stack_pointer, extended downwards to include the
+  //! red zone where the ABI specifies one, and ends at the end of the mapping
+  //! that contains \a stack_pointer.
+  //!
+  //! \param[in] stack_pointer The stack pointer, referring to the top (lowest
+  //!     address) of a thread’s stack.
+  //! \param[out] stack_region_size The size of the memory region used as the
+  //!     thread’s stack.
+  //!
+  //! \return The base address (lowest address) of the memory region used as the
+  //!     thread’s stack, or `0` if \a stack_pointer is not within a readable
+  //!     mapping.
+  uint64_t CalculateStackRegion(uint64_t stack_pointer,
+                                uint64_t* stack_region_size);
+
+  std::vector<Thread> threads_;
+  std::vector<Mapping> mappings_;
+  std::vector<Module> modules_;
+  ProcessMemory process_memory_;
+  timeval start_time_;
+  pid_t pid_;
+  pid_t ppid_;
+  InitializationStateDcheck initialized_;
+  bool is_64_bit_;
+  bool initialized_threads_;
+  bool initialized_mappings_;
+  bool initialized_modules_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessReader);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PROCESS_READER_H_
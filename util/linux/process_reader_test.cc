@@ -0,0 +1,317 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/process_reader.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "build/build_config.h"
+#include "gtest/gtest.h"
+#include "util/file/fd_io.h"
+#include "util/test/errors.h"
+#include "util/test/multiprocess.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+pid_t GetTID() {
+  return syscall(SYS_gettid);
+}
+
+std::string ReadExecutableLink(pid_t pid) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/exe", pid);
+  char target[PATH_MAX];
+  ssize_t length = readlink(path, target, sizeof(target));
+  PCHECK(length >= 0) << "readlink";
+  return std::string(target, length);
+}
+
+TEST(ProcessReader, SelfBasic) {
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(getpid()));
+
+#if !defined(ARCH_CPU_64_BITS)
+  EXPECT_FALSE(process_reader.Is64Bit());
+#else
+  EXPECT_TRUE(process_reader.Is64Bit());
+#endif
+
+  EXPECT_EQ(getpid(), process_reader.ProcessID());
+  EXPECT_EQ(getppid(), process_reader.ParentProcessID());
+
+  timeval start_time;
+  process_reader.StartTime(&start_time);
+  timeval now;
+  ASSERT_EQ(0, gettimeofday(&now, NULL)) << ErrnoMessage("gettimeofday");
+  EXPECT_LE(start_time.tv_sec, now.tv_sec);
+
+  timeval user_time;
+  timeval system_time;
+  ASSERT_TRUE(process_reader.CPUTimes(&user_time, &system_time));
+
+  const char kTestMemory[] = "Some test memory";
+  char buffer[arraysize(kTestMemory)];
+  ASSERT_TRUE(process_reader.Memory()->Read(
+      reinterpret_cast<uintptr_t>(kTestMemory), sizeof(kTestMemory), &buffer));
+  EXPECT_STREQ(kTestMemory, buffer);
+}
+
+const char kTestMemory[] = "Read me from another process";
+
+class ProcessReaderChild final : public Multiprocess {
+ public:
+  ProcessReaderChild() : Multiprocess() {}
+
+  ~ProcessReaderChild() {}
+
+ private:
+  virtual void MultiprocessParent() override {
+    ProcessReader process_reader;
+    ASSERT_TRUE(process_reader.Initialize(ChildPID()));
+
+#if !defined(ARCH_CPU_64_BITS)
+    EXPECT_FALSE(process_reader.Is64Bit());
+#else
+    EXPECT_TRUE(process_reader.Is64Bit());
+#endif
+
+    EXPECT_EQ(getpid(), process_reader.ParentProcessID());
+    EXPECT_EQ(ChildPID(), process_reader.ProcessID());
+
+    uint64_t address;
+    CheckedReadFD(ReadPipeFD(), &address, sizeof(address));
+
+    std::string read_string;
+    ASSERT_TRUE(process_reader.Memory()->ReadCString(address, &read_string));
+    EXPECT_EQ(kTestMemory, read_string);
+
+    // The child is a fork() of this process, so it has the same main
+    // executable, and its main thread has the same ID as the process.
+    const std::vector<ProcessReader::Module>& modules =
+        process_reader.Modules();
+    ASSERT_GE(modules.size(), 1u);
+    EXPECT_EQ(ReadExecutableLink(getpid()), modules[0].name);
+
+    const std::vector<ProcessReader::Thread>& threads =
+        process_reader.Threads();
+    ASSERT_GE(threads.size(), 1u);
+    EXPECT_EQ(ChildPID(), threads[0].id);
+  }
+
+  virtual void MultiprocessChild() override {
+    uint64_t address = reinterpret_cast<uintptr_t>(kTestMemory);
+    CheckedWriteFD(WritePipeFD(), &address, sizeof(address));
+
+    // Wait for the parent to signal that it’s OK to exit by closing its end of
+    // the pipe.
+    CheckedReadFDAtEOF(ReadPipeFD());
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessReaderChild);
+};
+
+TEST(ProcessReader, ChildBasic) {
+  ProcessReaderChild process_reader_child;
+  process_reader_child.Run();
+}
+
+TEST(ProcessReader, SelfOneThread) {
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(getpid()));
+
+  const std::vector<ProcessReader::Thread>& threads = process_reader.Threads();
+
+  // If other tests ran in this process previously, threads may have been
+  // created and may still be running. This check must look for at least one
+  // thread, not exactly one thread.
+  ASSERT_GE(threads.size(), 1u);
+
+  EXPECT_EQ(GetTID(), threads[0].id);
+}
+
+// Starts threads that report their thread IDs and then block until the pool is
+// destroyed.
+class TestThreadPool {
+ public:
+  TestThreadPool() : threads_(), report_pipe_(), release_pipe_() {
+    PCHECK(pipe(report_pipe_) == 0) << "pipe";
+    PCHECK(pipe(release_pipe_) == 0) << "pipe";
+  }
+
+  ~TestThreadPool() {
+    // Closing the write end of the release pipe allows every thread to see
+    // end-of-file and exit.
+    PCHECK(close(release_pipe_[1]) == 0) << "close";
+    for (pthread_t thread : threads_) {
+      CHECK_EQ(pthread_join(thread, NULL), 0);
+    }
+    PCHECK(close(release_pipe_[0]) == 0) << "close";
+    PCHECK(close(report_pipe_[0]) == 0) << "close";
+    PCHECK(close(report_pipe_[1]) == 0) << "close";
+  }
+
+  // Starts |thread_count| threads and returns their thread IDs once all of them
+  // are running.
+  std::vector<pid_t> StartThreads(size_t thread_count) {
+    for (size_t index = 0; index < thread_count; ++index) {
+      pthread_t thread;
+      CHECK_EQ(pthread_create(&thread, NULL, ThreadMain, this), 0);
+      threads_.push_back(thread);
+    }
+
+    std::vector<pid_t> thread_ids(thread_count);
+    for (pid_t& thread_id : thread_ids) {
+      CheckedReadFD(report_pipe_[0], &thread_id, sizeof(thread_id));
+    }
+    return thread_ids;
+  }
+
+ private:
+  static void* ThreadMain(void* argument) {
+    TestThreadPool* self = static_cast<TestThreadPool*>(argument);
+
+    pid_t thread_id = GetTID();
+    CheckedWriteFD(self->report_pipe_[1], &thread_id, sizeof(thread_id));
+
+    // Every thread shares the release pipe, so more than one may be woken for
+    // a single byte. Wait for end-of-file rather than data.
+    char c;
+    while (ReadFD(self->release_pipe_[0], &c, 1) > 0) {
+    }
+
+    return NULL;
+  }
+
+  std::vector<pthread_t> threads_;
+  int report_pipe_[2];
+  int release_pipe_[2];
+
+  DISALLOW_COPY_AND_ASSIGN(TestThreadPool);
+};
+
+TEST(ProcessReader, SelfSeveralThreads) {
+  TestThreadPool thread_pool;
+  const size_t kChildThreads = 16;
+  std::vector<pid_t> thread_ids = thread_pool.StartThreads(kChildThreads);
+
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(getpid()));
+
+  const std::vector<ProcessReader::Thread>& threads = process_reader.Threads();
+  ASSERT_GE(threads.size(), kChildThreads + 1);
+  EXPECT_EQ(GetTID(), threads[0].id);
+
+  for (pid_t thread_id : thread_ids) {
+    SCOPED_TRACE(thread_id);
+    auto thread = std::find_if(threads.begin(),
+                               threads.end(),
+                               [thread_id](const ProcessReader::Thread& t) {
+                                 return t.id == thread_id;
+                               });
+    ASSERT_NE(threads.end(), thread);
+
+    // Each blocked thread is in a read() system call, so its stack pointer is
+    // known and lies within its stack region.
+    if (thread->stack_pointer) {
+      EXPECT_LE(thread->stack_region_address, thread->stack_pointer);
+      EXPECT_GT(thread->stack_region_address + thread->stack_region_size,
+                thread->stack_pointer);
+    }
+  }
+}
+
+TEST(ProcessReader, SelfMappings) {
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(getpid()));
+
+  const std::vector<ProcessReader::Mapping>& mappings =
+      process_reader.Mappings();
+  ASSERT_FALSE(mappings.empty());
+
+  for (size_t index = 1; index < mappings.size(); ++index) {
+    EXPECT_LE(mappings[index - 1].range_end, mappings[index].range_start);
+  }
+
+  // A heap address should be within a readable, writable mapping.
+  std::vector<char> heap_memory(64);
+  const uint64_t heap_address = reinterpret_cast<uintptr_t>(&heap_memory[0]);
+  auto mapping = std::find_if(
+      mappings.begin(),
+      mappings.end(),
+      [heap_address](const ProcessReader::Mapping& mapping) {
+        return heap_address >= mapping.range_start &&
+               heap_address < mapping.range_end;
+      });
+  ASSERT_NE(mappings.end(), mapping);
+  EXPECT_TRUE(mapping->readable);
+  EXPECT_TRUE(mapping->writable);
+  EXPECT_FALSE(mapping->shareable);
+
+  // Code in the main executable should be within an executable mapping of the
+  // main executable.
+  const uint64_t code_address =
+      reinterpret_cast<uintptr_t>(&ReadExecutableLink);
+  mapping = std::find_if(
+      mappings.begin(),
+      mappings.end(),
+      [code_address](const ProcessReader::Mapping& mapping) {
+        return code_address >= mapping.range_start &&
+               code_address < mapping.range_end;
+      });
+  ASSERT_NE(mappings.end(), mapping);
+  EXPECT_TRUE(mapping->readable);
+  EXPECT_TRUE(mapping->executable);
+  EXPECT_EQ(ReadExecutableLink(getpid()), mapping->name);
+}
+
+TEST(ProcessReader, SelfModules) {
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(getpid()));
+
+  const std::vector<ProcessReader::Module>& modules = process_reader.Modules();
+  ASSERT_GE(modules.size(), 1u);
+
+  EXPECT_EQ(ReadExecutableLink(getpid()), modules[0].name);
+
+  // The main executable contains this code.
+  const uint64_t code_address =
+      reinterpret_cast<uintptr_t>(&ReadExecutableLink);
+  EXPECT_LE(modules[0].base_address, code_address);
+  EXPECT_GT(modules[0].base_address + modules[0].size, code_address);
+
+  // The C library should also be present.
+  const uint64_t libc_address = reinterpret_cast<uintptr_t>(&getpid);
+  auto module = std::find_if(
+      modules.begin(),
+      modules.end(),
+      [libc_address](const ProcessReader::Module& module) {
+        return libc_address >= module.base_address &&
+               libc_address < module.base_address + module.size;
+      });
+  EXPECT_NE(modules.end(), module);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -16,7 +16,7 @@
 
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
-#include "util/mac/process_reader.h"
+#include "util/mac/process_types/memory_source.h"
 
 namespace crashpad {
 
@@ -25,16 +25,17 @@ CheckedMachAddressRange::CheckedMachAddressRange()
 }
 
 CheckedMachAddressRange::CheckedMachAddressRange(
-    const ProcessReader* process_reader,
+    const process_types::MemorySource* memory_source,
     mach_vm_address_t base,
     mach_vm_size_t size) {
-  SetRange(process_reader, base, size);
+  SetRange(memory_source, base, size);
 }
 
-void CheckedMachAddressRange::SetRange(const ProcessReader* process_reader,
-                                       mach_vm_address_t base,
-                                       mach_vm_size_t size) {
-  is_64_bit_ = process_reader->Is64Bit();
+void CheckedMachAddressRange::SetRange(
+    const process_types::MemorySource* memory_source,
+    mach_vm_address_t base,
+    mach_vm_size_t size) {
+  is_64_bit_ = memory_source->Is64Bit();
   if (is_64_bit_) {
     range_64_.SetRange(base, size);
     range_ok_ = true;
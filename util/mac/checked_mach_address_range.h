@@ -21,14 +21,16 @@
 
 namespace crashpad {
 
-class ProcessReader;
+namespace process_types {
+class MemorySource;
+}  // namespace process_types
 
 //! \brief Ensures that a range, composed of a base and a size, does not
 //!     overflow the pointer type of the process it describes a range in.
 //!
 //! This class checks bases of type `mach_vm_address_t` and sizes of type
 //! `mach_vm_address_t` against a process whose pointer type can be determined
-//! from its ProcessReader.
+//! from its process_types::MemorySource, such as its ProcessReader.
 //!
 //! Aside from varying the overall range on the basis of a process’ pointer type
 //! width, this class functions very similarly to CheckedRange.
@@ -43,17 +45,17 @@ class CheckedMachAddressRange {
   //! \brief Initializes a range.
   //!
   //! See SetRange().
-  CheckedMachAddressRange(const ProcessReader* process_reader,
+  CheckedMachAddressRange(const process_types::MemorySource* memory_source,
                           mach_vm_address_t base,
                           mach_vm_size_t size);
 
   //! \brief Sets a range’s fields.
   //!
-  //! \param[in] process_reader The ProcessReader that can read the process that
-  //!                           \a base is a pointer to.
+  //! \param[in] memory_source The memory source for the process that \a base
+  //!     is a pointer to.
   //! \param[in] base The range’s base address.
   //! \param[in] size The range’s size.
-  void SetRange(const ProcessReader* process_reader,
+  void SetRange(const process_types::MemorySource* memory_source,
                 mach_vm_address_t base,
                 mach_vm_size_t size);
 
@@ -14,6 +14,7 @@
 
 #include "util/mac/mach_o_image_reader.h"
 
+#include <inttypes.h>
 #include <mach-o/loader.h>
 #include <mach-o/nlist.h>
 #include <string.h>
@@ -26,20 +27,89 @@
 #include "util/mac/checked_mach_address_range.h"
 #include "util/mac/mach_o_image_segment_reader.h"
 #include "util/mac/mach_o_image_symbol_table_reader.h"
-#include "util/mac/process_reader.h"
+#include "util/misc/log_context.h"
+#include "util/misc/remote_memory.h"
+#include "util/stdlib/flat_address_map.h"
+#include "util/stdlib/strnlen.h"
 
 namespace {
 
 const uint32_t kInvalidSegmentIndex = std::numeric_limits<uint32_t>::max();
+const uint32_t kNoSymbolIndex = std::numeric_limits<uint32_t>::max();
+
+// The largest mach_header::sizeofcmds that will be accepted. Real images’ load
+// commands occupy no more than a few tens of kilobytes, so anything larger than
+// this is corrupt, and is rejected before any memory is read or allocated for
+// it.
+const uint32_t kMaxSizeOfCmds = 16 * 1024 * 1024;
 
 }  // namespace
 
 namespace crashpad {
 
+namespace {
+
+// Describes a load command in logged messages. A single object is updated as
+// each load command is visited, and is only formatted if a message is logged.
+class LoadCommandLogContext final : public LogContext {
+ public:
+  LoadCommandLogContext(uint32_t count, const LogContext* parent)
+      : LogContext(parent),
+        index_(0),
+        count_(count),
+        command_(0),
+        have_command_(false) {}
+
+  ~LoadCommandLogContext() {}
+
+  // Identifies the load command at |index|, whose type is not yet known.
+  void SetIndex(uint32_t index) {
+    index_ = index;
+    have_command_ = false;
+  }
+
+  // Records the type of the current load command, once it has been read.
+  void SetCommand(uint32_t command) {
+    command_ = command;
+    have_command_ = true;
+  }
+
+ protected:
+  virtual void AppendOwnTo(std::string* string) const override {
+    if (have_command_) {
+      base::StringAppendF(
+          string, ", load command 0x%x %u/%u", command_, index_, count_);
+    } else {
+      base::StringAppendF(string, ", load command %u/%u", index_, count_);
+    }
+  }
+
+ private:
+  uint32_t index_;
+  uint32_t count_;
+  uint32_t command_;
+  bool have_command_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadCommandLogContext);
+};
+
+}  // namespace
+
+struct MachOImageReader::AddressIndexEntry {
+  // The index of the symbol in the symbol table’s external defined symbols, as
+  // accepted by MachOImageSymbolTableReader::SymbolInformationMap::KeyAt(), or
+  // kNoSymbolIndex if this entry marks the beginning of a section.
+  uint32_t symbol_index;
+
+  // The 1-based index of the section that contains the symbol, or that begins
+  // at this entry, as accepted by GetSectionAtIndex().
+  uint32_t section_index;
+};
+
 MachOImageReader::MachOImageReader()
     : segments_(),
       segment_map_(),
-      module_info_(),
+      module_info_(std::string()),
       dylinker_name_(),
       uuid_(),
       address_(0),
@@ -50,33 +120,35 @@ MachOImageReader::MachOImageReader()
       dysymtab_command_(),
       symbol_table_(),
       id_dylib_command_(),
-      process_reader_(NULL),
+      memory_source_(NULL),
       file_type_(0),
       initialized_(),
-      symbol_table_initialized_() {
+      symbol_table_initialized_(),
+      address_index_(),
+      address_index_initialized_() {
 }
 
 MachOImageReader::~MachOImageReader() {
 }
 
-bool MachOImageReader::Initialize(ProcessReader* process_reader,
+bool MachOImageReader::Initialize(process_types::MemorySource* memory_source,
                                   mach_vm_address_t address,
                                   const std::string& name) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
-  process_reader_ = process_reader;
+  memory_source_ = memory_source;
   address_ = address;
 
-  module_info_ =
-      base::StringPrintf(", module %s, address 0x%llx", name.c_str(), address);
+  module_info_.set_string(base::StringPrintf(
+      ", module %s, address 0x%" PRIx64, name.c_str(), address));
 
   process_types::mach_header mach_header;
-  if (!mach_header.Read(process_reader, address)) {
+  if (!mach_header.Read(memory_source, address)) {
     LOG(WARNING) << "could not read mach_header" << module_info_;
     return false;
   }
 
-  const bool is_64_bit = process_reader->Is64Bit();
+  const bool is_64_bit = memory_source->Is64Bit();
   const uint32_t kExpectedMagic = is_64_bit ? MH_MAGIC_64 : MH_MAGIC;
   if (mach_header.magic != kExpectedMagic) {
     LOG(WARNING) << base::StringPrintf("unexpected mach_header::magic 0x%08x",
@@ -93,7 +165,9 @@ bool MachOImageReader::Initialize(ProcessReader* process_reader,
 
   const struct {
     // Which method to call when encountering a load command matching |command|.
-    bool (MachOImageReader::*function)(mach_vm_address_t, const std::string&);
+    bool (MachOImageReader::*function)(const void*,
+                                       size_t,
+                                       const LogContext&);
 
     // The minimum size that may be allotted to store the load command.
     size_t size;
@@ -106,49 +180,49 @@ bool MachOImageReader::Initialize(ProcessReader* process_reader,
   } kLoadCommandReaders[] = {
     {
       &MachOImageReader::ReadSegmentCommand,
-      process_types::segment_command::ExpectedSize(process_reader),
+      process_types::segment_command::ExpectedSize(memory_source),
       kExpectedSegmentCommand,
       false,
     },
     {
       &MachOImageReader::ReadSymTabCommand,
-      process_types::symtab_command::ExpectedSize(process_reader),
+      process_types::symtab_command::ExpectedSize(memory_source),
       LC_SYMTAB,
       true,
     },
     {
       &MachOImageReader::ReadDySymTabCommand,
-      process_types::symtab_command::ExpectedSize(process_reader),
+      process_types::symtab_command::ExpectedSize(memory_source),
       LC_DYSYMTAB,
       true,
     },
     {
       &MachOImageReader::ReadIdDylibCommand,
-      process_types::dylib_command::ExpectedSize(process_reader),
+      process_types::dylib_command::ExpectedSize(memory_source),
       LC_ID_DYLIB,
       true,
     },
     {
       &MachOImageReader::ReadDylinkerCommand,
-      process_types::dylinker_command::ExpectedSize(process_reader),
+      process_types::dylinker_command::ExpectedSize(memory_source),
       LC_LOAD_DYLINKER,
       true,
     },
     {
       &MachOImageReader::ReadDylinkerCommand,
-      process_types::dylinker_command::ExpectedSize(process_reader),
+      process_types::dylinker_command::ExpectedSize(memory_source),
       LC_ID_DYLINKER,
       true,
     },
     {
       &MachOImageReader::ReadUUIDCommand,
-      process_types::uuid_command::ExpectedSize(process_reader),
+      process_types::uuid_command::ExpectedSize(memory_source),
       LC_UUID,
       true,
     },
     {
       &MachOImageReader::ReadSourceVersionCommand,
-      process_types::source_version_command::ExpectedSize(process_reader),
+      process_types::source_version_command::ExpectedSize(memory_source),
       LC_SOURCE_VERSION,
       true,
     },
@@ -157,7 +231,7 @@ bool MachOImageReader::Initialize(ProcessReader* process_reader,
     // present, and vice-versa.
     {
       &MachOImageReader::ReadUnexpectedCommand,
-      process_types::load_command::ExpectedSize(process_reader),
+      process_types::load_command::ExpectedSize(memory_source),
       kUnexpectedSegmentCommand,
       false,
     },
@@ -169,50 +243,67 @@ bool MachOImageReader::Initialize(ProcessReader* process_reader,
   std::vector<uint32_t> singleton_indices(arraysize(kLoadCommandReaders),
                                           kInvalidSegmentIndex);
 
-  size_t offset = mach_header.Size();
-  const mach_vm_address_t kLoadCommandAddressLimit =
-      address + offset + mach_header.sizeofcmds;
+  if (mach_header.sizeofcmds > kMaxSizeOfCmds) {
+    LOG(WARNING) << base::StringPrintf(
+                        "mach_header::sizeofcmds 0x%x exceeds 0x%x",
+                        mach_header.sizeofcmds,
+                        kMaxSizeOfCmds) << module_info_;
+    return false;
+  }
 
+  // Read all of the load commands from the remote process at once, mapping them
+  // where the memory source allows it. Each load command is then parsed from
+  // this local view, so that reading a module costs a fixed number of remote
+  // reads regardless of how many load commands it has.
+  const mach_vm_address_t load_commands_address = address + mach_header.Size();
+  scoped_ptr<RemoteMemory::MappedMemory> load_commands =
+      memory_source->Memory()->ReadMapped(load_commands_address,
+                                          mach_header.sizeofcmds);
+  if (!load_commands) {
+    LOG(WARNING) << "could not read load commands" << module_info_;
+    return false;
+  }
+  const char* load_commands_data =
+      reinterpret_cast<const char*>(load_commands->data());
+
+  size_t offset = 0;
+  LoadCommandLogContext load_command_info(mach_header.ncmds, &module_info_);
   for (uint32_t load_command_index = 0;
        load_command_index < mach_header.ncmds;
        ++load_command_index) {
-    mach_vm_address_t load_command_address = address + offset;
-    std::string load_command_info = base::StringPrintf(", load command %u/%u%s",
-                                                       load_command_index,
-                                                       mach_header.ncmds,
-                                                       module_info_.c_str());
+    mach_vm_address_t load_command_address = load_commands_address + offset;
+    load_command_info.SetIndex(load_command_index);
 
     process_types::load_command load_command;
 
     // Make sure that the basic load command structure doesn’t overflow the
     // space allotted for load commands.
-    if (load_command_address + load_command.ExpectedSize(process_reader) >
-            kLoadCommandAddressLimit) {
+    if (offset + load_command.ExpectedSize(memory_source) >
+            mach_header.sizeofcmds) {
       LOG(WARNING) << base::StringPrintf(
-                          "load_command at 0x%llx exceeds sizeofcmds 0x%x",
+                          "load_command at 0x%" PRIx64
+                          " exceeds sizeofcmds 0x%x",
                           load_command_address,
                           mach_header.sizeofcmds) << load_command_info;
       return false;
     }
 
-    if (!load_command.Read(process_reader, load_command_address)) {
+    if (!load_command.ReadFromBuffer(memory_source,
+                                     load_commands_data + offset,
+                                     mach_header.sizeofcmds - offset)) {
       LOG(WARNING) << "could not read load_command" << load_command_info;
       return false;
     }
 
-    load_command_info = base::StringPrintf(", load command 0x%x %u/%u%s",
-                                           load_command.cmd,
-                                           load_command_index,
-                                           mach_header.ncmds,
-                                           module_info_.c_str());
+    load_command_info.SetCommand(load_command.cmd);
 
     // Now that the load command’s stated size is known, make sure that it
     // doesn’t overflow the space allotted for load commands.
-    if (load_command_address + load_command.cmdsize >
-            kLoadCommandAddressLimit) {
+    if (load_command.cmdsize > mach_header.sizeofcmds - offset) {
       LOG(WARNING)
           << base::StringPrintf(
-                 "load_command at 0x%llx cmdsize 0x%x exceeds sizeofcmds 0x%x",
+                 "load_command at 0x%" PRIx64
+                 " cmdsize 0x%x exceeds sizeofcmds 0x%x",
                  load_command_address,
                  load_command.cmdsize,
                  mach_header.sizeofcmds) << load_command_info;
@@ -246,7 +337,9 @@ bool MachOImageReader::Initialize(ProcessReader* process_reader,
       }
 
       if (!((this)->*(kLoadCommandReaders[reader_index].function))(
-              load_command_address, load_command_info)) {
+              load_commands_data + offset,
+              load_command.cmdsize,
+              load_command_info)) {
         return false;
       }
 
@@ -267,11 +360,11 @@ bool MachOImageReader::Initialize(ProcessReader* process_reader,
     mach_vm_address_t slid_segment_address = segment->Address();
     mach_vm_size_t slid_segment_size = segment->Size();
     CheckedMachAddressRange slid_segment_range(
-        process_reader_, slid_segment_address, slid_segment_size);
+        memory_source_, slid_segment_address, slid_segment_size);
     if (!slid_segment_range.IsValid()) {
       LOG(WARNING) << base::StringPrintf(
-                          "invalid slid segment range 0x%llx + 0x%llx, "
-                          "segment ",
+                          "invalid slid segment range 0x%" PRIx64
+                          " + 0x%" PRIx64 ", segment ",
                           slid_segment_address,
                           slid_segment_size) << segment->Name() << module_info_;
       return false;
@@ -415,7 +508,7 @@ bool MachOImageReader::LookUpExternalDefinedSymbol(
   // to slide. In non-PIE executables, __mh_execute_header is an absolute
   // symbol.
   CheckedMachAddressRange section_range(
-      process_reader_, section_address, section->size);
+      memory_source_, section_address, section->size);
   if (!section_range.ContainsValue(slid_value) &&
       !(symbol_info->section == 1 && segment->Name() == SEG_TEXT &&
         slid_value == Address())) {
@@ -423,8 +516,9 @@ bool MachOImageReader::LookUpExternalDefinedSymbol(
         MachOImageSegmentReader::SegmentAndSectionNameString(section->segname,
                                                              section->sectname);
     LOG(WARNING) << base::StringPrintf(
-                        "symbol %s (0x%llx) outside of section %s (0x%llx + "
-                        "0x%llx)",
+                        "symbol %s (0x%" PRIx64
+                        ") outside of section %s (0x%" PRIx64 " + 0x%" PRIx64
+                        ")",
                         name.c_str(),
                         slid_value,
                         section_name_full.c_str(),
@@ -437,6 +531,50 @@ bool MachOImageReader::LookUpExternalDefinedSymbol(
   return true;
 }
 
+bool MachOImageReader::LookUpSymbolForAddress(mach_vm_address_t address,
+                                              std::string* name,
+                                              mach_vm_size_t* offset) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (address_index_initialized_.is_uninitialized()) {
+    InitializeAddressIndex();
+  }
+
+  if (!address_index_initialized_.is_valid()) {
+    return false;
+  }
+
+  uint64_t entry_address;
+  const AddressIndexEntry* entry =
+      address_index_->FindAtOrBelow(address, &entry_address);
+  if (!entry) {
+    return false;
+  }
+
+  // The entry found is in the section that contains |address| unless |address|
+  // lies beyond the end of that section, in a gap between sections.
+  mach_vm_address_t section_address;
+  const process_types::section* section =
+      GetSectionAtIndex(entry->section_index, NULL, &section_address);
+  if (!section || address - section_address >= section->size) {
+    return false;
+  }
+
+  if (entry->symbol_index == kNoSymbolIndex) {
+    *name = MachOImageSegmentReader::SegmentAndSectionNameString(
+        section->segname, section->sectname);
+  } else {
+    size_t name_length;
+    const char* symbol_name =
+        symbol_table_->external_defined_symbols().KeyAt(entry->symbol_index,
+                                                        &name_length);
+    name->assign(symbol_name, name_length);
+  }
+
+  *offset = address - entry_address;
+  return true;
+}
+
 uint32_t MachOImageReader::DylibVersion() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   DCHECK_EQ(FileType(), static_cast<uint32_t>(MH_DYLIB));
@@ -455,11 +593,13 @@ void MachOImageReader::UUID(crashpad::UUID* uuid) const {
 }
 
 template <typename T>
-bool MachOImageReader::ReadLoadCommand(mach_vm_address_t load_command_address,
-                                       const std::string& load_command_info,
+bool MachOImageReader::ReadLoadCommand(const void* load_command_data,
+                                       size_t load_command_size,
+                                       const LogContext& load_command_info,
                                        uint32_t expected_load_command_id,
                                        T* load_command) {
-  if (!load_command->Read(process_reader_, load_command_address)) {
+  if (!load_command->ReadFromBuffer(
+          memory_source_, load_command_data, load_command_size)) {
     LOG(WARNING) << "could not read load command" << load_command_info;
     return false;
   }
@@ -470,15 +610,20 @@ bool MachOImageReader::ReadLoadCommand(mach_vm_address_t load_command_address,
 }
 
 bool MachOImageReader::ReadSegmentCommand(
-    mach_vm_address_t load_command_address,
-    const std::string& load_command_info) {
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   MachOImageSegmentReader* segment = new MachOImageSegmentReader();
   size_t segment_index = segments_.size();
   segments_.push_back(segment);  // Takes ownership.
 
-  if (!segment->Initialize(
-          process_reader_, load_command_address, load_command_info)) {
+  if (!segment->Initialize(memory_source_,
+                           load_command_data,
+                           load_command_size,
+                           load_command_info)) {
+    // segments_ only deletes the segments that it holds when it’s destroyed.
     segments_.pop_back();
+    delete segment;
     return false;
   }
 
@@ -513,7 +658,7 @@ bool MachOImageReader::ReadSegmentCommand(
     mach_vm_size_t fileoff = segment->fileoff();
     if (fileoff != 0) {
       LOG(WARNING) << base::StringPrintf(
-                          SEG_TEXT " segment has unexpected fileoff 0x%llx",
+                          SEG_TEXT " segment has unexpected fileoff 0x%" PRIx64,
                           fileoff) << load_command_info;
       return false;
     }
@@ -530,28 +675,33 @@ bool MachOImageReader::ReadSegmentCommand(
   return true;
 }
 
-bool MachOImageReader::ReadSymTabCommand(mach_vm_address_t load_command_address,
-                                         const std::string& load_command_info) {
+bool MachOImageReader::ReadSymTabCommand(const void* load_command_data,
+                                         size_t load_command_size,
+                                         const LogContext& load_command_info) {
   symtab_command_.reset(new process_types::symtab_command());
-  return ReadLoadCommand(load_command_address,
+  return ReadLoadCommand(load_command_data,
+                         load_command_size,
                          load_command_info,
                          LC_SYMTAB,
                          symtab_command_.get());
 }
 
 bool MachOImageReader::ReadDySymTabCommand(
-    mach_vm_address_t load_command_address,
-    const std::string& load_command_info) {
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   dysymtab_command_.reset(new process_types::dysymtab_command());
-  return ReadLoadCommand(load_command_address,
+  return ReadLoadCommand(load_command_data,
+                         load_command_size,
                          load_command_info,
                          LC_DYSYMTAB,
                          dysymtab_command_.get());
 }
 
 bool MachOImageReader::ReadIdDylibCommand(
-    mach_vm_address_t load_command_address,
-    const std::string& load_command_info) {
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   if (file_type_ != MH_DYLIB) {
     LOG(WARNING) << base::StringPrintf(
                         "LC_ID_DYLIB inappropriate in non-dylib file type 0x%x",
@@ -561,15 +711,17 @@ bool MachOImageReader::ReadIdDylibCommand(
 
   DCHECK(!id_dylib_command_);
   id_dylib_command_.reset(new process_types::dylib_command());
-  return ReadLoadCommand(load_command_address,
+  return ReadLoadCommand(load_command_data,
+                         load_command_size,
                          load_command_info,
                          LC_ID_DYLIB,
                          id_dylib_command_.get());
 }
 
 bool MachOImageReader::ReadDylinkerCommand(
-    mach_vm_address_t load_command_address,
-    const std::string& load_command_info) {
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   if (file_type_ != MH_EXECUTE && file_type_ != MH_DYLINKER) {
     LOG(WARNING) << base::StringPrintf(
                         "LC_LOAD_DYLINKER/LC_ID_DYLINKER inappropriate in file "
@@ -581,29 +733,42 @@ bool MachOImageReader::ReadDylinkerCommand(
   const uint32_t kExpectedCommand =
       file_type_ == MH_DYLINKER ? LC_ID_DYLINKER : LC_LOAD_DYLINKER;
   process_types::dylinker_command dylinker_command;
-  if (!ReadLoadCommand(load_command_address,
+  if (!ReadLoadCommand(load_command_data,
+                       load_command_size,
                        load_command_info,
                        kExpectedCommand,
                        &dylinker_command)) {
     return false;
   }
 
-  if (!process_reader_->Memory()->ReadCStringSizeLimited(
-          load_command_address + dylinker_command.name,
-          dylinker_command.cmdsize - dylinker_command.name,
-          &dylinker_name_)) {
+  // The name is stored within the load command, following the fixed-size
+  // portion of the structure, and must be NUL-terminated within it.
+  if (dylinker_command.name >= load_command_size) {
     LOG(WARNING) << "could not read dylinker_command name" << load_command_info;
     return false;
   }
+  const char* name =
+      static_cast<const char*>(load_command_data) + dylinker_command.name;
+  const size_t name_size = load_command_size - dylinker_command.name;
+  const size_t name_length = strnlen(name, name_size);
+  if (name_length == name_size) {
+    LOG(WARNING) << "unterminated dylinker_command name" << load_command_info;
+    return false;
+  }
+  dylinker_name_.assign(name, name_length);
 
   return true;
 }
 
-bool MachOImageReader::ReadUUIDCommand(mach_vm_address_t load_command_address,
-                                       const std::string& load_command_info) {
+bool MachOImageReader::ReadUUIDCommand(const void* load_command_data,
+                                       size_t load_command_size,
+                                       const LogContext& load_command_info) {
   process_types::uuid_command uuid_command;
-  if (!ReadLoadCommand(
-          load_command_address, load_command_info, LC_UUID, &uuid_command)) {
+  if (!ReadLoadCommand(load_command_data,
+                       load_command_size,
+                       load_command_info,
+                       LC_UUID,
+                       &uuid_command)) {
     return false;
   }
 
@@ -612,10 +777,12 @@ bool MachOImageReader::ReadUUIDCommand(mach_vm_address_t load_command_address,
 }
 
 bool MachOImageReader::ReadSourceVersionCommand(
-    mach_vm_address_t load_command_address,
-    const std::string& load_command_info) {
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   process_types::source_version_command source_version_command;
-  if (!ReadLoadCommand(load_command_address,
+  if (!ReadLoadCommand(load_command_data,
+                       load_command_size,
                        load_command_info,
                        LC_SOURCE_VERSION,
                        &source_version_command)) {
@@ -627,8 +794,9 @@ bool MachOImageReader::ReadSourceVersionCommand(
 }
 
 bool MachOImageReader::ReadUnexpectedCommand(
-    mach_vm_address_t load_command_address,
-    const std::string& load_command_info) {
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   LOG(WARNING) << "unexpected load command" << load_command_info;
   return false;
 }
@@ -656,7 +824,7 @@ void MachOImageReader::InitializeSymbolTable() const {
   }
 
   symbol_table_.reset(new MachOImageSymbolTableReader());
-  if (!symbol_table_->Initialize(process_reader_,
+  if (!symbol_table_->Initialize(memory_source_,
                                  symtab_command_.get(),
                                  dysymtab_command_.get(),
                                  linkedit_segment,
@@ -668,4 +836,85 @@ void MachOImageReader::InitializeSymbolTable() const {
   symbol_table_initialized_.set_valid();
 }
 
+void MachOImageReader::InitializeAddressIndex() const {
+  DCHECK(address_index_initialized_.is_uninitialized());
+  address_index_initialized_.set_invalid();
+
+  if (symbol_table_initialized_.is_uninitialized()) {
+    InitializeSymbolTable();
+  }
+
+  if (!symbol_table_initialized_.is_valid()) {
+    return;
+  }
+
+  // In modules without a symbol table, only sections are indexed.
+  const MachOImageSymbolTableReader::SymbolInformationMap* symbols =
+      symbol_table_ ? &symbol_table_->external_defined_symbols() : NULL;
+
+  scoped_ptr<FlatAddressMap<AddressIndexEntry>> address_index(
+      new FlatAddressMap<AddressIndexEntry>());
+  if (symbols) {
+    address_index->Reserve(symbols->size());
+  }
+
+  // Sections are inserted before symbols so that a symbol at the beginning of
+  // a section is found in preference to the section itself. Empty sections are
+  // skipped so that they don’t hide sections that begin at the same address.
+  AddressIndexEntry entry;
+  entry.symbol_index = kNoSymbolIndex;
+  entry.section_index = 0;
+  for (const MachOImageSegmentReader* segment : segments_) {
+    for (size_t local_index = 0; local_index < segment->nsects();
+         ++local_index) {
+      ++entry.section_index;
+      mach_vm_address_t section_address;
+      const process_types::section* section =
+          segment->GetSectionAtIndex(local_index, &section_address);
+      if (section->size != 0) {
+        address_index->Insert(section_address, entry);
+      }
+    }
+  }
+
+  for (size_t symbol_index = 0; symbols && symbol_index < symbols->size();
+       ++symbol_index) {
+    const MachOImageSymbolTableReader::SymbolInformation& symbol_info =
+        symbols->ValueAt(symbol_index);
+    if (symbol_info.section == NO_SECT) {
+      // Absolute (N_ABS) symbols don’t refer to anything in the image’s
+      // sections.
+      continue;
+    }
+
+    // Symbols that can’t be found in their sections are skipped, as
+    // LookUpExternalDefinedSymbol() would refuse to return them. This includes
+    // __mh_execute_header, which can’t be the nearest symbol to any address in
+    // a section anyway.
+    mach_vm_address_t section_address;
+    const MachOImageSegmentReader* segment;
+    const process_types::section* section =
+        GetSectionAtIndex(symbol_info.section, &segment, &section_address);
+    if (!section) {
+      continue;
+    }
+
+    mach_vm_address_t slid_value =
+        symbol_info.value + (segment->SegmentSlides() ? slide_ : 0);
+    if (slid_value - section_address >= section->size) {
+      continue;
+    }
+
+    DCHECK_LT(symbol_index, kNoSymbolIndex);
+    entry.symbol_index = static_cast<uint32_t>(symbol_index);
+    entry.section_index = symbol_info.section;
+    address_index->Insert(slid_value, entry);
+  }
+
+  address_index->Sort();
+  address_index_.reset(address_index.release());
+
+  address_index_initialized_.set_valid();
+}
+
 }  // namespace crashpad
@@ -24,15 +24,17 @@
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
 #include "util/misc/initialization_state_dcheck.h"
+#include "util/misc/log_context.h"
 #include "util/misc/uuid.h"
 #include "util/stdlib/pointer_container.h"
 #include "util/mac/process_types.h"
 
 namespace crashpad {
 
+template <typename T>
+class FlatAddressMap;
 class MachOImageSegmentReader;
 class MachOImageSymbolTableReader;
-class ProcessReader;
 
 //! \brief A reader for Mach-O images mapped into another process.
 //!
@@ -49,7 +51,11 @@ class MachOImageReader {
   //! This method must only be called once on an object. This method must be
   //! called successfully before any other method in this class may be called.
   //!
-  //! \param[in] process_reader The reader for the remote process.
+  //! \param[in] memory_source The memory source for the remote process. This is
+  //!     normally its ProcessReader, but an image may also be read from a file
+  //!     or buffer by using a process_types::RemoteMemorySource. The image’s
+  //!     segments must be laid out in \a memory_source as they would be when
+  //!     mapped into a process. \a memory_source must outlive this object.
   //! \param[in] address The address, in the remote process’ address space,
   //!     where the `mach_header` or `mach_header_64` at the beginning of the
   //!     image to be read is located. This address can be determined by reading
@@ -60,7 +66,7 @@ class MachOImageReader {
   //!
   //! \return `true` if the image was read successfully, including all load
   //!     commands. `false` otherwise, with an appropriate message logged.
-  bool Initialize(ProcessReader* process_reader,
+  bool Initialize(process_types::MemorySource* memory_source,
                   mach_vm_address_t address,
                   const std::string& name);
 
@@ -224,6 +230,34 @@ class MachOImageReader {
   bool LookUpExternalDefinedSymbol(const std::string& name,
                                    mach_vm_address_t* value) const;
 
+  //! \brief Finds the symbol nearest to an address in the image.
+  //!
+  //! This is the reverse of LookUpExternalDefinedSymbol(), and considers the
+  //! same symbols, except for absolute (`N_ABS`) symbols. Like `dladdr()`, it
+  //! finds the symbol at or nearest below \a address. An address within a
+  //! function that is not an external defined symbol will be attributed to the
+  //! nearest such symbol that precedes it in the same section. If no such
+  //! symbol precedes \a address in its section, the section itself is found.
+  //!
+  //! The first call builds an index of the image’s sections and symbols, which
+  //! is retained for use by subsequent calls. Looking up many addresses in the
+  //! same image, such as the return addresses on every thread’s stack, only
+  //! examines the symbol table once.
+  //!
+  //! \param[in] address An address in the remote process’ address space.
+  //! \param[out] name The name of the symbol found, or if no symbol was found,
+  //!     the name of the section containing \a address, such as
+  //!     `"__TEXT,__text"`.
+  //! \param[out] offset The offset of \a address from the beginning of the
+  //!     symbol or section named by \a name.
+  //!
+  //! \return `true` if \a address is within one of the image’s sections.
+  //!     `false` otherwise, including error conditions (for which a warning
+  //!     message will be logged).
+  bool LookUpSymbolForAddress(mach_vm_address_t address,
+                              std::string* name,
+                              mach_vm_size_t* offset) const;
+
   //! \brief Returns a Mach-O dylib image’s current version.
   //!
   //! This information comes from the `dylib_current_version` field of a dylib’s
@@ -265,31 +299,41 @@ class MachOImageReader {
  private:
   // A generic helper routine for the other Read*Command() methods.
   template <typename T>
-  bool ReadLoadCommand(mach_vm_address_t load_command_address,
-                       const std::string& load_command_info,
+  bool ReadLoadCommand(const void* load_command_data,
+                       size_t load_command_size,
+                       const LogContext& load_command_info,
                        uint32_t expected_load_command_id,
                        T* load_command);
 
   // The Read*Command() methods are subroutines called by Initialize(). They are
-  // responsible for reading a single load command. They may update the member
-  // fields of their MachOImageReader object. If they can’t make sense of a load
-  // command, they return false.
-  bool ReadSegmentCommand(mach_vm_address_t load_command_address,
-                          const std::string& load_command_info);
-  bool ReadSymTabCommand(mach_vm_address_t load_command_address,
-                         const std::string& load_command_info);
-  bool ReadDySymTabCommand(mach_vm_address_t load_command_address,
-                           const std::string& load_command_info);
-  bool ReadIdDylibCommand(mach_vm_address_t load_command_address,
-                          const std::string& load_command_info);
-  bool ReadDylinkerCommand(mach_vm_address_t load_command_address,
-                           const std::string& load_command_info);
-  bool ReadUUIDCommand(mach_vm_address_t load_command_address,
-                       const std::string& load_command_info);
-  bool ReadSourceVersionCommand(mach_vm_address_t load_command_address,
-                                const std::string& load_command_info);
-  bool ReadUnexpectedCommand(mach_vm_address_t load_command_address,
-                             const std::string& load_command_info);
+  // responsible for reading a single load command from load_command_data, a
+  // local copy of the load command of load_command_size bytes, which is its
+  // cmdsize. They may update the member fields of their MachOImageReader
+  // object. If they can’t make sense of a load command, they return false.
+  bool ReadSegmentCommand(const void* load_command_data,
+                          size_t load_command_size,
+                          const LogContext& load_command_info);
+  bool ReadSymTabCommand(const void* load_command_data,
+                         size_t load_command_size,
+                         const LogContext& load_command_info);
+  bool ReadDySymTabCommand(const void* load_command_data,
+                           size_t load_command_size,
+                           const LogContext& load_command_info);
+  bool ReadIdDylibCommand(const void* load_command_data,
+                          size_t load_command_size,
+                          const LogContext& load_command_info);
+  bool ReadDylinkerCommand(const void* load_command_data,
+                           size_t load_command_size,
+                           const LogContext& load_command_info);
+  bool ReadUUIDCommand(const void* load_command_data,
+                       size_t load_command_size,
+                       const LogContext& load_command_info);
+  bool ReadSourceVersionCommand(const void* load_command_data,
+                                size_t load_command_size,
+                                const LogContext& load_command_info);
+  bool ReadUnexpectedCommand(const void* load_command_data,
+                             size_t load_command_size,
+                             const LogContext& load_command_info);
 
   // Performs deferred initialization of the symbol table. Because a module’s
   // symbol table is often not needed, this is not handled in Initialize(), but
@@ -304,9 +348,23 @@ class MachOImageReader {
   // will be set to the valid state, but symbol_table_ will be NULL.
   void InitializeSymbolTable() const;
 
+  // An entry in address_index_, marking the beginning of a section or of a
+  // symbol.
+  struct AddressIndexEntry;
+
+  // Performs deferred initialization of the address index used by
+  // LookUpSymbolForAddress(), initializing the symbol table first if
+  // necessary. Like InitializeSymbolTable(), this is done lazily.
+  //
+  // address_index_initialized_ will be transitioned to the appropriate state.
+  // If initialization completes successfully, this will be the valid state,
+  // and address_index_ will be set. Otherwise, it will be left in the invalid
+  // state.
+  void InitializeAddressIndex() const;
+
   PointerVector<MachOImageSegmentReader> segments_;
   std::map<std::string, size_t> segment_map_;
-  std::string module_info_;
+  StringLogContext module_info_;
   std::string dylinker_name_;
   crashpad::UUID uuid_;
   mach_vm_address_t address_;
@@ -323,7 +381,7 @@ class MachOImageReader {
   mutable scoped_ptr<MachOImageSymbolTableReader> symbol_table_;
 
   scoped_ptr<process_types::dylib_command> id_dylib_command_;
-  ProcessReader* process_reader_;  // weak
+  process_types::MemorySource* memory_source_;  // weak
   uint32_t file_type_;
   InitializationStateDcheck initialized_;
 
@@ -334,6 +392,12 @@ class MachOImageReader {
   // set in modules that have no symbol table.
   mutable InitializationState symbol_table_initialized_;
 
+  // address_index_ refers to names in symbol_table_, and is only set when
+  // address_index_initialized_ is valid. These are mutable for the same reason
+  // as symbol_table_.
+  mutable scoped_ptr<FlatAddressMap<AddressIndexEntry>> address_index_;
+  mutable InitializationState address_index_initialized_;
+
   DISALLOW_COPY_AND_ASSIGN(MachOImageReader);
 };
 
@@ -0,0 +1,175 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/stringprintf.h"
+#include "util/mac/mach_o_image_reader.h"
+#include "util/mac/process_types/memory_source.h"
+#include "util/misc/buffer_remote_memory.h"
+#include "util/test/benchmark.h"
+#include "util/test/mac/mach_o_image_builder.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kVMAddress = 0x100000000;
+const uint64_t kSlide = 0x5000;
+const uint64_t kSymbolSpacing = 0x10;
+
+// A 64-bit image with range(0) symbols, built once for each benchmark run and
+// read from a BufferRemoteMemory at a slid address.
+class SyntheticImage {
+ public:
+  explicit SyntheticImage(size_t symbol_count)
+      : image_(),
+        names_(),
+        memory_(),
+        memory_source_(&memory_, true) {
+    MachOImageBuilder builder(true);
+    names_.reserve(symbol_count);
+    for (size_t index = 0; index < symbol_count; ++index) {
+      names_.push_back(base::StringPrintf(
+          "__ZN8crashpad4test12_GLOBAL__N_16Symbol%zuEv", index));
+      builder.AddSymbol(names_.back(), index * kSymbolSpacing);
+    }
+    builder.Build(kVMAddress, &image_);
+    memory_.Initialize(image_.data(), image_.size(), Address());
+  }
+
+  ~SyntheticImage() {}
+
+  mach_vm_address_t Address() const { return kVMAddress + kSlide; }
+
+  mach_vm_address_t SymbolAddress(size_t index) const {
+    return Address() + MachOImageBuilder::kTextSectionOffset +
+           index * kSymbolSpacing;
+  }
+
+  const std::vector<std::string>& names() const { return names_; }
+  process_types::MemorySource* memory_source() { return &memory_source_; }
+
+ private:
+  std::string image_;
+  std::vector<std::string> names_;
+  BufferRemoteMemory memory_;
+  process_types::RemoteMemorySource memory_source_;
+
+  DISALLOW_COPY_AND_ASSIGN(SyntheticImage);
+};
+
+// Reads an image with range(0) symbols and performs one symbol lookup and one
+// address lookup, the way a module is visited once while producing a crash
+// report. This measures the load commands, symbol table, and address index.
+void BM_MachOImageReaderLoad(BenchmarkState* state) {
+  const size_t symbol_count = state->range(0);
+  SyntheticImage image(symbol_count);
+  const std::string& name = image.names()[symbol_count / 2];
+
+  while (state->KeepRunning()) {
+    MachOImageReader image_reader;
+    if (!image_reader.Initialize(
+            image.memory_source(), image.Address(), "synthetic")) {
+      state->SkipWithError("Initialize failed");
+      return;
+    }
+
+    mach_vm_address_t value;
+    std::string symbol_name;
+    mach_vm_size_t offset;
+    if (!image_reader.LookUpExternalDefinedSymbol(name, &value) ||
+        !image_reader.LookUpSymbolForAddress(value + 1, &symbol_name,
+                                             &offset)) {
+      state->SkipWithError("lookup failed");
+      return;
+    }
+    DoNotOptimize(symbol_name);
+  }
+
+  state->SetItemsProcessed(state->iterations() * symbol_count);
+}
+CRASHPAD_BENCHMARK(BM_MachOImageReaderLoad)->Arg(1024)->Arg(65536);
+
+// Looks up each of range(0) symbols by name in an image whose symbol table has
+// already been read.
+void BM_MachOImageReaderLookUpExternalDefinedSymbol(BenchmarkState* state) {
+  const size_t symbol_count = state->range(0);
+  SyntheticImage image(symbol_count);
+
+  MachOImageReader image_reader;
+  mach_vm_address_t value;
+  if (!image_reader.Initialize(
+          image.memory_source(), image.Address(), "synthetic") ||
+      !image_reader.LookUpExternalDefinedSymbol(image.names()[0], &value)) {
+    state->SkipWithError("Initialize failed");
+    return;
+  }
+
+  while (state->KeepRunning()) {
+    for (const std::string& name : image.names()) {
+      if (!image_reader.LookUpExternalDefinedSymbol(name, &value)) {
+        state->SkipWithError("LookUpExternalDefinedSymbol failed");
+        return;
+      }
+    }
+    DoNotOptimize(value);
+  }
+
+  state->SetItemsProcessed(state->iterations() * symbol_count);
+}
+CRASHPAD_BENCHMARK(BM_MachOImageReaderLookUpExternalDefinedSymbol)
+    ->Arg(1024)
+    ->Arg(65536);
+
+// Looks up an address inside each of range(0) symbols in an image whose
+// address index has already been built, as symbolizing a stack would.
+void BM_MachOImageReaderLookUpSymbolForAddress(BenchmarkState* state) {
+  const size_t symbol_count = state->range(0);
+  SyntheticImage image(symbol_count);
+
+  MachOImageReader image_reader;
+  std::string name;
+  mach_vm_size_t offset;
+  if (!image_reader.Initialize(
+          image.memory_source(), image.Address(), "synthetic") ||
+      !image_reader.LookUpSymbolForAddress(
+          image.SymbolAddress(0), &name, &offset)) {
+    state->SkipWithError("Initialize failed");
+    return;
+  }
+
+  while (state->KeepRunning()) {
+    for (size_t index = 0; index < symbol_count; ++index) {
+      if (!image_reader.LookUpSymbolForAddress(
+              image.SymbolAddress(index) + kSymbolSpacing / 2, &name,
+              &offset)) {
+        state->SkipWithError("LookUpSymbolForAddress failed");
+        return;
+      }
+    }
+    DoNotOptimize(name);
+  }
+
+  state->SetItemsProcessed(state->iterations() * symbol_count);
+}
+CRASHPAD_BENCHMARK(BM_MachOImageReaderLookUpSymbolForAddress)
+    ->Arg(1024)
+    ->Arg(65536);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
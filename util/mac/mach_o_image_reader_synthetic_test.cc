@@ -0,0 +1,562 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/mac/mach_o_image_reader.h"
+
+#include <mach-o/loader.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "base/strings/stringprintf.h"
+#include "gtest/gtest.h"
+#include "util/file/fd_io.h"
+#include "util/mac/mach_o_image_segment_reader.h"
+#include "util/mac/process_types.h"
+#include "util/mac/process_types/memory_source.h"
+#include "util/misc/buffer_remote_memory.h"
+#include "util/misc/file_remote_memory.h"
+#include "util/misc/remote_memory.h"
+#include "util/misc/uuid.h"
+#include "util/test/errors.h"
+#include "util/test/mac/mach_o_image_builder.h"
+
+// These tests read synthetic images built by MachOImageBuilder from a
+// BufferRemoteMemory or FileRemoteMemory, so unlike the tests in
+// mach_o_image_reader_test.cc, they don’t need a running Mach task and can run
+// on any platform.
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kVMAddress = 0x10000000;
+const uint64_t kSlide = 0x3000;
+
+// Creates a temporary file with the given contents. The file is removed when
+// the object is destroyed.
+class ScopedTempFile {
+ public:
+  explicit ScopedTempFile(const std::string& contents) : path_() {
+    char path[] = "/tmp/mach_o_image_reader_synthetic_test.XXXXXX";
+    base::ScopedFD fd(mkstemp(path));
+    EXPECT_TRUE(fd.is_valid()) << ErrnoMessage("mkstemp");
+    path_ = base::FilePath(path);
+    CheckedWriteFD(fd.get(), contents.data(), contents.size());
+  }
+
+  ~ScopedTempFile() {
+    EXPECT_EQ(0, unlink(path_.value().c_str())) << ErrnoMessage("unlink");
+  }
+
+  const base::FilePath& path() const { return path_; }
+
+ private:
+  base::FilePath path_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTempFile);
+};
+
+// Counts the reads made through it to another RemoteMemory.
+class CountingRemoteMemory final : public RemoteMemory {
+ public:
+  explicit CountingRemoteMemory(RemoteMemory* memory)
+      : RemoteMemory(), memory_(memory), read_count_(0) {}
+  virtual ~CountingRemoteMemory() {}
+
+  size_t read_count() const { return read_count_; }
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override {
+    ++read_count_;
+    return memory_->Read(address, size, buffer);
+  }
+
+ private:
+  RemoteMemory* memory_;  // weak
+  size_t read_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingRemoteMemory);
+};
+
+void AddTestSymbols(MachOImageBuilder* builder) {
+  builder->AddSymbol("_crashpad_first", 0);
+  builder->AddSymbol("_crashpad_second", 0x20);
+  builder->AddSymbol("_crashpad_third", 0x48);
+}
+
+// Verifies an image built by AddTestSymbols() and MachOImageBuilder::Build()
+// with kVMAddress, read at |address|.
+void ExpectTestImage(process_types::MemorySource* memory_source,
+                     const MachOImageBuilder& builder,
+                     mach_vm_address_t address) {
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(memory_source, address, "synthetic"));
+
+  EXPECT_EQ(static_cast<uint32_t>(MH_DYLIB), image_reader.FileType());
+  EXPECT_EQ(address, image_reader.Address());
+  EXPECT_EQ(address - kVMAddress, image_reader.Slide());
+  EXPECT_EQ(MachOImageBuilder::kDylibCurrentVersion,
+            image_reader.DylibVersion());
+
+  crashpad::UUID uuid;
+  image_reader.UUID(&uuid);
+  crashpad::UUID expected_uuid;
+  expected_uuid.InitializeFromBytes(builder.uuid());
+  EXPECT_EQ(expected_uuid.ToString(), uuid.ToString());
+
+  const MachOImageSegmentReader* text_segment =
+      image_reader.GetSegmentByName(SEG_TEXT);
+  ASSERT_TRUE(text_segment);
+  EXPECT_EQ(address, text_segment->Address());
+  EXPECT_EQ(image_reader.Size(), text_segment->Size());
+  ASSERT_TRUE(image_reader.GetSegmentByName(SEG_LINKEDIT));
+  EXPECT_FALSE(image_reader.GetSegmentByName(SEG_DATA));
+
+  const mach_vm_address_t text_address =
+      address + MachOImageBuilder::kTextSectionOffset;
+  mach_vm_address_t section_address;
+  const process_types::section* text_section =
+      image_reader.GetSectionByName(SEG_TEXT, SECT_TEXT, &section_address);
+  ASSERT_TRUE(text_section);
+  EXPECT_EQ(text_address, section_address);
+  EXPECT_EQ(text_section, image_reader.GetSectionAtIndex(1, NULL, NULL));
+
+  mach_vm_address_t value;
+  ASSERT_TRUE(image_reader.LookUpExternalDefinedSymbol("_crashpad_first",
+                                                       &value));
+  EXPECT_EQ(text_address, value);
+  ASSERT_TRUE(image_reader.LookUpExternalDefinedSymbol("_crashpad_third",
+                                                       &value));
+  EXPECT_EQ(text_address + 0x48, value);
+  EXPECT_FALSE(image_reader.LookUpExternalDefinedSymbol("_crashpad_fourth",
+                                                        &value));
+
+  std::string name;
+  mach_vm_size_t offset;
+  ASSERT_TRUE(
+      image_reader.LookUpSymbolForAddress(text_address + 0x28, &name, &offset));
+  EXPECT_EQ("_crashpad_second", name);
+  EXPECT_EQ(0x8u, offset);
+  ASSERT_TRUE(
+      image_reader.LookUpSymbolForAddress(text_address + 0x48, &name, &offset));
+  EXPECT_EQ("_crashpad_third", name);
+  EXPECT_EQ(0u, offset);
+  EXPECT_FALSE(
+      image_reader.LookUpSymbolForAddress(address, &name, &offset));
+  EXPECT_FALSE(image_reader.LookUpSymbolForAddress(
+      text_address + text_section->size, &name, &offset));
+}
+
+void TestBufferImage(bool is_64_bit) {
+  MachOImageBuilder builder(is_64_bit);
+  AddTestSymbols(&builder);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  for (mach_vm_address_t address : {kVMAddress, kVMAddress + kSlide}) {
+    SCOPED_TRACE(address);
+    BufferRemoteMemory memory;
+    memory.Initialize(image.data(), image.size(), address);
+    process_types::RemoteMemorySource memory_source(&memory, is_64_bit);
+    ExpectTestImage(&memory_source, builder, address);
+  }
+}
+
+TEST(MachOImageReaderSynthetic, Buffer32) {
+  TestBufferImage(false);
+}
+
+TEST(MachOImageReaderSynthetic, Buffer64) {
+  TestBufferImage(true);
+}
+
+void TestFileImage(bool is_64_bit) {
+  MachOImageBuilder builder(is_64_bit);
+  AddTestSymbols(&builder);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+  ScopedTempFile file(image);
+
+  FileRemoteMemory memory;
+  ASSERT_TRUE(memory.Initialize(file.path(), kVMAddress + kSlide));
+  process_types::RemoteMemorySource memory_source(&memory, is_64_bit);
+  ExpectTestImage(&memory_source, builder, kVMAddress + kSlide);
+}
+
+TEST(MachOImageReaderSynthetic, File32) {
+  TestFileImage(false);
+}
+
+TEST(MachOImageReaderSynthetic, File64) {
+  TestFileImage(true);
+}
+
+TEST(MachOImageReaderSynthetic, WrongBitness) {
+  MachOImageBuilder builder(true);
+  AddTestSymbols(&builder);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  BufferRemoteMemory memory;
+  memory.Initialize(image.data(), image.size(), kVMAddress);
+  process_types::RemoteMemorySource memory_source(&memory, false);
+  MachOImageReader image_reader;
+  EXPECT_FALSE(image_reader.Initialize(&memory_source, kVMAddress, "64"));
+}
+
+TEST(MachOImageReaderSynthetic, Truncated) {
+  MachOImageBuilder builder(true);
+  AddTestSymbols(&builder);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  // The header can be read, but the load commands cannot.
+  BufferRemoteMemory memory;
+  memory.Initialize(image.data(), 0x40, kVMAddress);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  EXPECT_FALSE(image_reader.Initialize(&memory_source, kVMAddress, "short"));
+}
+
+TEST(MachOImageReaderSynthetic, LoadCommandsReadOnce) {
+  MachOImageBuilder builder(true);
+  AddTestSymbols(&builder);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  BufferRemoteMemory buffer_memory;
+  buffer_memory.Initialize(image.data(), image.size(), kVMAddress);
+  CountingRemoteMemory memory(&buffer_memory);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(&memory_source, kVMAddress, "count"));
+
+  // One read for the mach_header_64, and one for all six load commands.
+  EXPECT_EQ(2u, memory.read_count());
+}
+
+TEST(MachOImageReaderSynthetic, ReadFromBuffer) {
+  MachOImageBuilder builder(false);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  process_types::RemoteMemorySource memory_source(NULL, false);
+  const size_t load_command_offset =
+      process_types::mach_header::ExpectedSize(&memory_source);
+  const size_t segment_command_size =
+      process_types::segment_command::ExpectedSize(&memory_source);
+  const char* segment_data = image.data() + load_command_offset;
+
+  process_types::segment_command segment_command;
+  ASSERT_TRUE(segment_command.ReadFromBuffer(
+      &memory_source, segment_data, segment_command_size));
+  EXPECT_EQ(static_cast<uint32_t>(LC_SEGMENT), segment_command.cmd);
+  EXPECT_EQ(segment_command_size, segment_command.Size());
+  EXPECT_EQ(kVMAddress, segment_command.vmaddr);
+  EXPECT_FALSE(segment_command.ReadFromBuffer(
+      &memory_source, segment_data, segment_command_size - 1));
+
+  const size_t section_size =
+      process_types::section::ExpectedSize(&memory_source);
+  process_types::section section;
+  ASSERT_TRUE(process_types::section::ReadArrayFromBuffer(
+      &memory_source,
+      segment_data + segment_command_size,
+      section_size,
+      1,
+      &section));
+  EXPECT_EQ(kVMAddress + MachOImageBuilder::kTextSectionOffset, section.addr);
+  EXPECT_EQ(section_size, section.Size());
+  EXPECT_FALSE(process_types::section::ReadArrayFromBuffer(
+      &memory_source,
+      segment_data + segment_command_size,
+      section_size,
+      2,
+      &section));
+}
+
+// Reads |image| after replacing the 32-bit field at |offset| with |value|.
+bool InitializeCorruptImage(const std::string& image,
+                            size_t offset,
+                            uint32_t value) {
+  std::string corrupt_image(image);
+  memcpy(&corrupt_image[offset], &value, sizeof(value));
+
+  BufferRemoteMemory memory;
+  memory.Initialize(corrupt_image.data(), corrupt_image.size(), kVMAddress);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  return image_reader.Initialize(&memory_source, kVMAddress, "corrupt");
+}
+
+TEST(MachOImageReaderSynthetic, CorruptLoadCommands) {
+  MachOImageBuilder builder(true);
+  AddTestSymbols(&builder);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  process_types::RemoteMemorySource memory_source(NULL, true);
+  const size_t load_command_offset =
+      process_types::mach_header::ExpectedSize(&memory_source);
+  const size_t section_offset =
+      load_command_offset +
+      process_types::segment_command::ExpectedSize(&memory_source);
+
+  // These failures are logged with the load command, and for the last one, the
+  // section, that they were found in.
+
+  // mach_header::ncmds claims one more load command than sizeofcmds holds.
+  EXPECT_FALSE(InitializeCorruptImage(image, 16, 7));
+
+  // The __TEXT segment’s load_command::cmdsize exceeds sizeofcmds.
+  EXPECT_FALSE(InitializeCorruptImage(image, load_command_offset + 4, 0x10000));
+
+  // The __TEXT segment’s cmdsize can’t hold its section.
+  EXPECT_FALSE(InitializeCorruptImage(
+      image,
+      load_command_offset + 4,
+      static_cast<uint32_t>(
+          process_types::segment_command::ExpectedSize(&memory_source))));
+
+  // The __text section’s segname isn’t __TEXT.
+  EXPECT_FALSE(InitializeCorruptImage(image, section_offset + 16, 0x58585858));
+
+  // Unmodified, the image is valid.
+  EXPECT_TRUE(InitializeCorruptImage(image, 16, 6));
+}
+
+TEST(MachOImageReaderSynthetic, OversizedLoadCommands) {
+  MachOImageBuilder builder(true);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  // mach_header::sizeofcmds claims nearly 4 GB of load commands.
+  const uint32_t kSizeOfCmds = 0xfffffff0;
+  memcpy(&image[20], &kSizeOfCmds, sizeof(kSizeOfCmds));
+
+  BufferRemoteMemory buffer_memory;
+  buffer_memory.Initialize(image.data(), image.size(), kVMAddress);
+  CountingRemoteMemory memory(&buffer_memory);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  EXPECT_FALSE(image_reader.Initialize(&memory_source, kVMAddress, "large"));
+
+  // The size was rejected after reading the mach_header_64, without reading or
+  // allocating anything for the load commands.
+  EXPECT_EQ(1u, memory.read_count());
+}
+
+TEST(MachOImageReaderSynthetic, SymbolNames) {
+  MachOImageBuilder builder(true);
+
+  // Symbols are added out of order, and some names are prefixes of others.
+  builder.AddSymbol("_crashpad_b", 0x20);
+  builder.AddSymbol("_crashpad", 0x10);
+  builder.AddSymbol("_crashpad_a", 0x30);
+  builder.AddSymbol("_", 0x40);
+  builder.AddSymbol(std::string(300, 'x'), 0x50);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  BufferRemoteMemory buffer_memory;
+  buffer_memory.Initialize(image.data(), image.size(), kVMAddress);
+  CountingRemoteMemory memory(&buffer_memory);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(&memory_source, kVMAddress, "names"));
+
+  const mach_vm_address_t text_address =
+      kVMAddress + MachOImageBuilder::kTextSectionOffset;
+  mach_vm_address_t value;
+  ASSERT_TRUE(image_reader.LookUpExternalDefinedSymbol("_crashpad", &value));
+  EXPECT_EQ(text_address + 0x10, value);
+  ASSERT_TRUE(image_reader.LookUpExternalDefinedSymbol("_crashpad_a", &value));
+  EXPECT_EQ(text_address + 0x30, value);
+  ASSERT_TRUE(image_reader.LookUpExternalDefinedSymbol("_crashpad_b", &value));
+  EXPECT_EQ(text_address + 0x20, value);
+  ASSERT_TRUE(image_reader.LookUpExternalDefinedSymbol("_", &value));
+  EXPECT_EQ(text_address + 0x40, value);
+  ASSERT_TRUE(
+      image_reader.LookUpExternalDefinedSymbol(std::string(300, 'x'), &value));
+  EXPECT_EQ(text_address + 0x50, value);
+
+  EXPECT_FALSE(image_reader.LookUpExternalDefinedSymbol("", &value));
+  EXPECT_FALSE(image_reader.LookUpExternalDefinedSymbol("_crash", &value));
+  EXPECT_FALSE(image_reader.LookUpExternalDefinedSymbol("_crashpad_", &value));
+  EXPECT_FALSE(image_reader.LookUpExternalDefinedSymbol("_crashpad_c", &value));
+  EXPECT_FALSE(
+      image_reader.LookUpExternalDefinedSymbol(std::string(299, 'x'), &value));
+
+  // Beyond the two reads made by Initialize(), the symbol table was read with
+  // one read for the nlist_64 array and one for the string table.
+  EXPECT_EQ(4u, memory.read_count());
+}
+
+TEST(MachOImageReaderSynthetic, DuplicateSymbol) {
+  MachOImageBuilder builder(true);
+  AddTestSymbols(&builder);
+  builder.AddSymbol("_crashpad_second", 0x60);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  BufferRemoteMemory memory;
+  memory.Initialize(image.data(), image.size(), kVMAddress);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(&memory_source, kVMAddress, "dup"));
+
+  // A symbol table with a duplicate symbol is rejected as a whole.
+  mach_vm_address_t value;
+  EXPECT_FALSE(
+      image_reader.LookUpExternalDefinedSymbol("_crashpad_first", &value));
+  EXPECT_FALSE(
+      image_reader.LookUpExternalDefinedSymbol("_crashpad_second", &value));
+}
+
+TEST(MachOImageReaderSynthetic, AddressIndex) {
+  MachOImageBuilder builder(true);
+  builder.AddSymbol("_later", 0x80);
+  builder.AddSymbol("_late", 0x40);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  const mach_vm_address_t address = kVMAddress + kSlide;
+  BufferRemoteMemory memory;
+  memory.Initialize(image.data(), image.size(), address);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(&memory_source, address, "index"));
+
+  mach_vm_address_t section_address;
+  const process_types::section* text_section =
+      image_reader.GetSectionByName(SEG_TEXT, SECT_TEXT, &section_address);
+  ASSERT_TRUE(text_section);
+  const mach_vm_address_t section_end = section_address + text_section->size;
+
+  // Addresses before the first symbol are attributed to the section.
+  std::string name;
+  mach_vm_size_t offset;
+  ASSERT_TRUE(
+      image_reader.LookUpSymbolForAddress(section_address, &name, &offset));
+  EXPECT_EQ("__TEXT,__text", name);
+  EXPECT_EQ(0u, offset);
+  ASSERT_TRUE(image_reader.LookUpSymbolForAddress(
+      section_address + 0x3f, &name, &offset));
+  EXPECT_EQ("__TEXT,__text", name);
+  EXPECT_EQ(0x3fu, offset);
+
+  ASSERT_TRUE(image_reader.LookUpSymbolForAddress(
+      section_address + 0x40, &name, &offset));
+  EXPECT_EQ("_late", name);
+  EXPECT_EQ(0u, offset);
+  ASSERT_TRUE(image_reader.LookUpSymbolForAddress(
+      section_address + 0x7f, &name, &offset));
+  EXPECT_EQ("_late", name);
+  EXPECT_EQ(0x3fu, offset);
+  ASSERT_TRUE(
+      image_reader.LookUpSymbolForAddress(section_end - 1, &name, &offset));
+  EXPECT_EQ("_later", name);
+  EXPECT_EQ(section_end - 1 - (section_address + 0x80), offset);
+
+  // Addresses outside of every section aren’t attributed to anything, even if
+  // they’re in the image.
+  EXPECT_FALSE(
+      image_reader.LookUpSymbolForAddress(section_end, &name, &offset));
+  EXPECT_FALSE(
+      image_reader.LookUpSymbolForAddress(address + 0x10, &name, &offset));
+  EXPECT_FALSE(
+      image_reader.LookUpSymbolForAddress(address - 1, &name, &offset));
+  EXPECT_FALSE(image_reader.LookUpSymbolForAddress(
+      address + image.size() - 1, &name, &offset));
+
+  // The unslid address is not in the image.
+  EXPECT_FALSE(image_reader.LookUpSymbolForAddress(
+      kVMAddress + MachOImageBuilder::kTextSectionOffset + 0x40,
+      &name,
+      &offset));
+}
+
+TEST(MachOImageReaderSynthetic, AddressIndexSymbolAtSectionStart) {
+  MachOImageBuilder builder(false);
+  builder.AddSymbol("_start", 0);
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  BufferRemoteMemory memory;
+  memory.Initialize(image.data(), image.size(), kVMAddress);
+  process_types::RemoteMemorySource memory_source(&memory, false);
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(&memory_source, kVMAddress, "start"));
+
+  // A symbol at the beginning of a section is found in preference to the
+  // section itself.
+  const mach_vm_address_t text_address =
+      kVMAddress + MachOImageBuilder::kTextSectionOffset;
+  std::string name;
+  mach_vm_size_t offset;
+  ASSERT_TRUE(
+      image_reader.LookUpSymbolForAddress(text_address, &name, &offset));
+  EXPECT_EQ("_start", name);
+  EXPECT_EQ(0u, offset);
+  ASSERT_TRUE(
+      image_reader.LookUpSymbolForAddress(text_address + 8, &name, &offset));
+  EXPECT_EQ("_start", name);
+  EXPECT_EQ(8u, offset);
+}
+
+TEST(MachOImageReaderSynthetic, ManySymbols) {
+  MachOImageBuilder builder(true);
+  const size_t kSymbolCount = 1000;
+  for (size_t index = 0; index < kSymbolCount; ++index) {
+    builder.AddSymbol(base::StringPrintf("_symbol_%zu", index), index * 0x10);
+  }
+  std::string image;
+  builder.Build(kVMAddress, &image);
+
+  BufferRemoteMemory memory;
+  memory.Initialize(image.data(), image.size(), kVMAddress);
+  process_types::RemoteMemorySource memory_source(&memory, true);
+  MachOImageReader image_reader;
+  ASSERT_TRUE(image_reader.Initialize(&memory_source, kVMAddress, "many"));
+
+  const mach_vm_address_t text_address =
+      kVMAddress + MachOImageBuilder::kTextSectionOffset;
+  for (size_t index = 0; index < kSymbolCount; ++index) {
+    SCOPED_TRACE(index);
+    const std::string expected_name =
+        base::StringPrintf("_symbol_%zu", index);
+
+    mach_vm_address_t value;
+    ASSERT_TRUE(
+        image_reader.LookUpExternalDefinedSymbol(expected_name, &value));
+    EXPECT_EQ(text_address + index * 0x10, value);
+
+    std::string name;
+    mach_vm_size_t offset;
+    ASSERT_TRUE(
+        image_reader.LookUpSymbolForAddress(value + 0xf, &name, &offset));
+    EXPECT_EQ(expected_name, name);
+    EXPECT_EQ(0xfu, offset);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
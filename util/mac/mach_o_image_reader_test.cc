@@ -23,6 +23,7 @@
 #include <mach-o/loader.h>
 #include <mach-o/nlist.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "base/strings/stringprintf.h"
 #include "build/build_config.h"
@@ -428,6 +429,20 @@ void ExpectSymbol(const Nlist* entry,
     }
 
     EXPECT_EQ(expect_address, actual_address);
+
+    if (entry_type == N_SECT && strcmp(name, _MH_EXECUTE_SYM) != 0) {
+      // Looking up the symbol’s address should find it, or another symbol at
+      // the same address.
+      std::string found_name;
+      mach_vm_size_t found_offset;
+      ASSERT_TRUE(actual_image->LookUpSymbolForAddress(
+          actual_address, &found_name, &found_offset));
+      EXPECT_EQ(0u, found_offset);
+      mach_vm_address_t found_address;
+      ASSERT_TRUE(actual_image->LookUpExternalDefinedSymbol(found_name,
+                                                            &found_address));
+      EXPECT_EQ(actual_address, found_address);
+    }
   }
 
   // You’d think that it might be a good idea to verify that if the conditions
@@ -499,6 +514,12 @@ void ExpectSymbolTable(const MachHeader* expect_image,
       actual_image->LookUpExternalDefinedSymbol("NoSuchSymbolName", &ignore));
   EXPECT_FALSE(
       actual_image->LookUpExternalDefinedSymbol("_NoSuchSymbolName", &ignore));
+
+  // No image has a section at address 0.
+  std::string ignore_name;
+  mach_vm_size_t ignore_offset;
+  EXPECT_FALSE(
+      actual_image->LookUpSymbolForAddress(0, &ignore_name, &ignore_offset));
 }
 
 TEST(MachOImageReader, Self_MainExecutable) {
@@ -14,12 +14,13 @@
 
 #include "util/mac/mach_o_image_segment_reader.h"
 
+#include <inttypes.h>
 #include <mach-o/loader.h>
 
 #include "base/logging.h"
 #include "base/strings/stringprintf.h"
 #include "util/mac/checked_mach_address_range.h"
-#include "util/mac/process_reader.h"
+#include "util/misc/log_context.h"
 #include "util/stdlib/strnlen.h"
 
 namespace crashpad {
@@ -30,6 +31,40 @@ std::string SizeLimitedCString(const char* c_string, size_t max_length) {
   return std::string(c_string, strnlen(c_string, max_length));
 }
 
+// Describes a section in logged messages. A single object is updated as each
+// section is visited, and the section’s name is only formatted if a message is
+// logged.
+class SectionLogContext final : public LogContext {
+ public:
+  SectionLogContext(size_t count, const LogContext* parent)
+      : LogContext(parent), section_(NULL), index_(0), count_(count) {}
+
+  ~SectionLogContext() {}
+
+  // Identifies |section|, located at |index| in its segment.
+  void SetSection(const process_types::section* section, size_t index) {
+    section_ = section;
+    index_ = index;
+  }
+
+ protected:
+  virtual void AppendOwnTo(std::string* string) const override {
+    base::StringAppendF(string,
+                        ", section %s %zu/%zu",
+                        MachOImageSegmentReader::SegmentAndSectionNameString(
+                            section_->segname, section_->sectname).c_str(),
+                        index_,
+                        count_);
+  }
+
+ private:
+  const process_types::section* section_;  // weak
+  size_t index_;
+  size_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(SectionLogContext);
+};
+
 }  // namespace
 
 MachOImageSegmentReader::MachOImageSegmentReader()
@@ -44,22 +79,25 @@ MachOImageSegmentReader::MachOImageSegmentReader()
 MachOImageSegmentReader::~MachOImageSegmentReader() {
 }
 
-bool MachOImageSegmentReader::Initialize(ProcessReader* process_reader,
-                                         mach_vm_address_t load_command_address,
-                                         const std::string& load_command_info) {
+bool MachOImageSegmentReader::Initialize(
+    process_types::MemorySource* memory_source,
+    const void* load_command_data,
+    size_t load_command_size,
+    const LogContext& load_command_info) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
-  if (!segment_command_.Read(process_reader, load_command_address)) {
+  if (!segment_command_.ReadFromBuffer(
+          memory_source, load_command_data, load_command_size)) {
     LOG(WARNING) << "could not read segment_command" << load_command_info;
     return false;
   }
 
   const uint32_t kExpectedSegmentCommand =
-      process_reader->Is64Bit() ? LC_SEGMENT_64 : LC_SEGMENT;
+      memory_source->Is64Bit() ? LC_SEGMENT_64 : LC_SEGMENT;
   DCHECK_EQ(segment_command_.cmd, kExpectedSegmentCommand);
   DCHECK_GE(segment_command_.cmdsize, segment_command_.Size());
   const size_t kSectionStructSize =
-      process_types::section::ExpectedSize(process_reader);
+      process_types::section::ExpectedSize(memory_source);
   const size_t kRequiredSize =
       segment_command_.Size() + segment_command_.nsects * kSectionStructSize;
   if (segment_command_.cmdsize < kRequiredSize) {
@@ -74,44 +112,40 @@ bool MachOImageSegmentReader::Initialize(ProcessReader* process_reader,
   }
 
   std::string segment_name = NameInternal();
-  std::string segment_info = base::StringPrintf(
-      ", segment %s%s", segment_name.c_str(), load_command_info.c_str());
+  StringLogContext segment_info(", segment " + segment_name,
+                                &load_command_info);
 
   // This checks the unslid segment range. The slid range (as loaded into
   // memory) will be checked later by MachOImageReader.
   CheckedMachAddressRange segment_range(
-      process_reader, segment_command_.vmaddr, segment_command_.vmsize);
+      memory_source, segment_command_.vmaddr, segment_command_.vmsize);
   if (!segment_range.IsValid()) {
-    LOG(WARNING) << base::StringPrintf("invalid segment range 0x%llx + 0x%llx",
-                                       segment_command_.vmaddr,
-                                       segment_command_.vmsize) << segment_info;
+    LOG(WARNING) << base::StringPrintf(
+                        "invalid segment range 0x%" PRIx64 " + 0x%" PRIx64,
+                        segment_command_.vmaddr,
+                        segment_command_.vmsize) << segment_info;
     return false;
   }
 
   sections_.resize(segment_command_.nsects);
-  if (!process_types::section::ReadArrayInto(
-          process_reader,
-          load_command_address + segment_command_.Size(),
+  if (!process_types::section::ReadArrayFromBuffer(
+          memory_source,
+          static_cast<const char*>(load_command_data) + segment_command_.Size(),
+          load_command_size - segment_command_.Size(),
           segment_command_.nsects,
-          &sections_[0])) {
+          sections_.data())) {
     LOG(WARNING) << "could not read sections" << segment_info;
     return false;
   }
 
+  SectionLogContext section_info(sections_.size(), &load_command_info);
   for (size_t section_index = 0;
        section_index < sections_.size();
        ++section_index) {
     const process_types::section& section = sections_[section_index];
     std::string section_segment_name = SegmentNameString(section.segname);
     std::string section_name = SectionNameString(section.sectname);
-    std::string section_full_name =
-        SegmentAndSectionNameString(section.segname, section.sectname);
-
-    std::string section_info = base::StringPrintf(", section %s %zu/%zu%s",
-                                                  section_full_name.c_str(),
-                                                  section_index,
-                                                  sections_.size(),
-                                                  load_command_info.c_str());
+    section_info.SetSection(&section, section_index);
 
     if (section_segment_name != segment_name) {
       LOG(WARNING) << "section.segname incorrect in segment " << segment_name
@@ -120,10 +154,10 @@ bool MachOImageSegmentReader::Initialize(ProcessReader* process_reader,
     }
 
     CheckedMachAddressRange section_range(
-        process_reader, section.addr, section.size);
+        memory_source, section.addr, section.size);
     if (!section_range.IsValid()) {
       LOG(WARNING) << base::StringPrintf(
-                          "invalid section range 0x%llx + 0x%llx",
+                          "invalid section range 0x%" PRIx64 " + 0x%" PRIx64,
                           section.addr,
                           section.size) << section_info;
       return false;
@@ -131,8 +165,8 @@ bool MachOImageSegmentReader::Initialize(ProcessReader* process_reader,
 
     if (!segment_range.ContainsRange(section_range)) {
       LOG(WARNING) << base::StringPrintf(
-                          "section at 0x%llx + 0x%llx outside of segment at "
-                          "0x%llx + 0x%llx",
+                          "section at 0x%" PRIx64 " + 0x%" PRIx64
+                          " outside of segment at 0x%" PRIx64 " + 0x%" PRIx64,
                           section.addr,
                           section.size,
                           segment_command_.vmaddr,
@@ -151,8 +185,9 @@ bool MachOImageSegmentReader::Initialize(ProcessReader* process_reader,
         section.offset - segment_command_.fileoff !=
             section.addr - segment_command_.vmaddr) {
       LOG(WARNING) << base::StringPrintf(
-                          "section type 0x%x at 0x%llx has unexpected offset "
-                          "0x%x in segment at 0x%llx with offset 0x%llx",
+                          "section type 0x%x at 0x%" PRIx64
+                          " has unexpected offset 0x%x in segment at 0x%" PRIx64
+                          " with offset 0x%" PRIx64,
                           section_type,
                           section.addr,
                           section.offset,
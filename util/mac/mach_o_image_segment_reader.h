@@ -26,6 +26,7 @@
 #include "base/basictypes.h"
 #include "util/mac/process_types.h"
 #include "util/misc/initialization_state_dcheck.h"
+#include "util/misc/log_context.h"
 
 namespace crashpad {
 
@@ -42,24 +43,30 @@ class MachOImageSegmentReader {
   MachOImageSegmentReader();
   ~MachOImageSegmentReader();
 
-  //! \brief Reads the segment load command from another process.
+  //! \brief Reads a segment load command copied from another process.
   //!
   //! This method must only be called once on an object. This method must be
   //! called successfully before any other method in this class may be called.
   //!
-  //! \param[in] process_reader The reader for the remote process.
-  //! \param[in] load_command_address The address, in the remote process’
-  //!     address space, where the `LC_SEGMENT` or `LC_SEGMENT_64` load command
-  //!     to be read is located. This address is determined by a Mach-O image
-  //!     reader, such as MachOImageReader, as it walks Mach-O load commands.
-  //! \param[in] load_command_info A string to be used in logged messages. This
-  //!     string is for diagnostic purposes only, and may be empty.
+  //! \param[in] memory_source The memory source that the load command was
+  //!     copied from. This is used to determine the layout of the load command.
+  //!     No memory is read from it.
+  //! \param[in] load_command_data The `LC_SEGMENT` or `LC_SEGMENT_64` load
+  //!     command, including the section structures that follow it, as copied
+  //!     from the remote process by a Mach-O image reader such as
+  //!     MachOImageReader.
+  //! \param[in] load_command_size The size of \a load_command_data, which is
+  //!     the load command’s `cmdsize`.
+  //! \param[in] load_command_info Context to be used in logged messages. This
+  //!     is for diagnostic purposes only, and is only formatted if a message is
+  //!     logged.
   //!
   //! \return `true` if the load command was read successfully. `false`
   //!     otherwise, with an appropriate message logged.
-  bool Initialize(ProcessReader* process_reader,
-                  mach_vm_address_t load_command_address,
-                  const std::string& load_command_info);
+  bool Initialize(process_types::MemorySource* memory_source,
+                  const void* load_command_data,
+                  size_t load_command_size,
+                  const LogContext& load_command_info);
 
   //! \brief Sets the image’s slide value.
   //!
@@ -14,18 +14,46 @@
 
 #include "util/mac/mach_o_image_symbol_table_reader.h"
 
+#include <inttypes.h>
 #include <mach-o/loader.h>
 #include <mach-o/nlist.h>
 
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/stringprintf.h"
 #include "util/mac/checked_mach_address_range.h"
-#include "util/mach/task_memory.h"
+#include "util/misc/log_context.h"
+#include "util/stdlib/strnlen.h"
 
 namespace crashpad {
 
 namespace internal {
 
+namespace {
+
+// Describes a symbol in logged messages. A single object is updated as each
+// symbol is visited, and is only formatted if a message is logged.
+class SymbolLogContext final : public LogContext {
+ public:
+  explicit SymbolLogContext(const LogContext* parent)
+      : LogContext(parent), index_(0) {}
+
+  ~SymbolLogContext() {}
+
+  void set_index(size_t index) { index_ = index; }
+
+ protected:
+  virtual void AppendOwnTo(std::string* string) const override {
+    base::StringAppendF(string, ", symbol index %zu", index_);
+  }
+
+ private:
+  size_t index_;
+
+  DISALLOW_COPY_AND_ASSIGN(SymbolLogContext);
+};
+
+}  // namespace
+
 //! \brief The internal implementation for MachOImageSymbolTableReader.
 //!
 //! Initialization is broken into more than one function that needs to share
@@ -36,15 +64,15 @@ namespace internal {
 class MachOImageSymbolTableReaderInitializer {
  public:
   MachOImageSymbolTableReaderInitializer(
-      ProcessReader* process_reader,
+      process_types::MemorySource* memory_source,
       const MachOImageSegmentReader* linkedit_segment,
-      const std::string& module_info)
+      const LogContext* module_info)
       : module_info_(module_info),
         linkedit_range_(),
-        process_reader_(process_reader),
+        memory_source_(memory_source),
         linkedit_segment_(linkedit_segment) {
     linkedit_range_.SetRange(
-        process_reader_, linkedit_segment->Address(), linkedit_segment->Size());
+        memory_source_, linkedit_segment->Address(), linkedit_segment->Size());
     DCHECK(linkedit_range_.IsValid());
   }
 
@@ -55,12 +83,13 @@ class MachOImageSymbolTableReaderInitializer {
   //! \sa MachOImageSymbolTableReader::Initialize()
   bool Initialize(const process_types::symtab_command* symtab_command,
                   const process_types::dysymtab_command* dysymtab_command,
+                  scoped_ptr<RemoteMemory::MappedMemory>* string_table,
                   MachOImageSymbolTableReader::SymbolInformationMap*
                       external_defined_symbols) {
     mach_vm_address_t symtab_address =
         AddressForLinkEditComponent(symtab_command->symoff);
     uint32_t symbol_count = symtab_command->nsyms;
-    size_t nlist_size = process_types::nlist::ExpectedSize(process_reader_);
+    size_t nlist_size = process_types::nlist::ExpectedSize(memory_source_);
     mach_vm_size_t symtab_size = symbol_count * nlist_size;
     if (!IsInLinkEditSegment(symtab_address, symtab_size, "symtab")) {
       return false;
@@ -78,7 +107,7 @@ class MachOImageSymbolTableReaderInitializer {
                             "dysymtab extdefsym %u + %u > symtab nsyms %u",
                             dysymtab_command->iextdefsym,
                             dysymtab_command->nextdefsym,
-                            symtab_command->nsyms) << module_info_;
+                            symtab_command->nsyms) << *module_info_;
         return false;
       }
 
@@ -99,47 +128,56 @@ class MachOImageSymbolTableReaderInitializer {
     scoped_ptr<process_types::nlist[]> symbols(
         new process_types::nlist[symtab_command->nsyms]);
     if (!process_types::nlist::ReadArrayInto(
-            process_reader_, symtab_address, symbol_count, &symbols[0])) {
-      LOG(WARNING) << "could not read symbol table" << module_info_;
+            memory_source_, symtab_address, symbol_count, &symbols[0])) {
+      LOG(WARNING) << "could not read symbol table" << *module_info_;
       return false;
     }
 
-    scoped_ptr<TaskMemory::MappedMemory> string_table;
+    if (dysymtab_command) {
+      external_defined_symbols->Reserve(symbol_count);
+    }
+
+    const char* strtab = NULL;
+    SymbolLogContext symbol_info(module_info_);
     for (size_t symbol_index = 0; symbol_index < symbol_count; ++symbol_index) {
       const process_types::nlist& symbol = symbols[symbol_index];
-      std::string symbol_info = base::StringPrintf(", symbol index %zu%s",
-                                                   skip_count + symbol_index,
-                                                   module_info_.c_str());
+      symbol_info.set_index(skip_count + symbol_index);
       uint8_t symbol_type = symbol.n_type & N_TYPE;
       if ((symbol.n_type & N_STAB) == 0 && (symbol.n_type & N_PEXT) == 0 &&
           (symbol_type == N_ABS || symbol_type == N_SECT) &&
           (symbol.n_type & N_EXT)) {
         if (symbol.n_strx >= strtab_size) {
           LOG(WARNING) << base::StringPrintf(
-                              "string at 0x%x out of bounds (0x%llx)",
+                              "string at 0x%x out of bounds (0x%" PRIx64 ")",
                               symbol.n_strx,
                               strtab_size) << symbol_info;
           return false;
         }
 
-        if (!string_table) {
-          string_table = process_reader_->Memory()->ReadMapped(
-              strtab_address, strtab_size);
-          if (!string_table) {
-            LOG(WARNING) << "could not read string table" << module_info_;
+        if (!strtab) {
+          // The string table is mapped rather than copied where the memory
+          // source allows it, so only the pages holding the names of external
+          // defined symbols are ever touched.
+          *string_table =
+              memory_source_->Memory()->ReadMapped(strtab_address, strtab_size);
+          if (!*string_table) {
+            LOG(WARNING) << "could not read string table" << *module_info_;
             return false;
           }
+          strtab = reinterpret_cast<const char*>((*string_table)->data());
         }
 
-        std::string name;
-        if (!string_table->ReadCString(symbol.n_strx, &name)) {
+        // The name is not copied. The map refers to it in the string table.
+        const char* name = strtab + symbol.n_strx;
+        size_t name_length = strnlen(name, strtab_size - symbol.n_strx);
+        if (name_length == strtab_size - symbol.n_strx) {
           LOG(WARNING) << "could not read string" << symbol_info;
           return false;
         }
 
         if (symbol_type == N_ABS && symbol.n_sect != NO_SECT) {
           LOG(WARNING) << base::StringPrintf("N_ABS symbol %s in section %u",
-                                             name.c_str(),
+                                             name,
                                              symbol.n_sect) << symbol_info;
           return false;
         }
@@ -147,25 +185,29 @@ class MachOImageSymbolTableReaderInitializer {
         if (symbol_type == N_SECT && symbol.n_sect == NO_SECT) {
           LOG(WARNING) << base::StringPrintf(
                               "N_SECT symbol %s in section NO_SECT",
-                              name.c_str()) << symbol_info;
-          return false;
-        }
-
-        if (external_defined_symbols->count(name)) {
-          LOG(WARNING) << "duplicate symbol " << name << symbol_info;
+                              name) << symbol_info;
           return false;
         }
 
         MachOImageSymbolTableReader::SymbolInformation symbol_info;
         symbol_info.value = symbol.n_value;
         symbol_info.section = symbol.n_sect;
-        (*external_defined_symbols)[name] = symbol_info;
+        symbol_info.index = skip_count + symbol_index;
+        external_defined_symbols->Insert(name, name_length, symbol_info);
       } else if (dysymtab_command) {
         LOG(WARNING) << "non-external symbol in extdefsym" << symbol_info;
         return false;
       }
     }
 
+    std::string duplicate_name;
+    MachOImageSymbolTableReader::SymbolInformation duplicate_info;
+    if (!external_defined_symbols->Sort(&duplicate_name, &duplicate_info)) {
+      symbol_info.set_index(duplicate_info.index);
+      LOG(WARNING) << "duplicate symbol " << duplicate_name << symbol_info;
+      return false;
+    }
+
     return true;
   }
 
@@ -198,33 +240,35 @@ class MachOImageSymbolTableReaderInitializer {
   bool IsInLinkEditSegment(mach_vm_address_t address,
                            mach_vm_size_t size,
                            const char* tag) const {
-    CheckedMachAddressRange subrange(process_reader_, address, size);
+    CheckedMachAddressRange subrange(memory_source_, address, size);
     if (!subrange.IsValid()) {
-      LOG(WARNING) << base::StringPrintf("invalid %s range (0x%llx + 0x%llx)",
-                                         tag,
-                                         address,
-                                         size) << module_info_;
+      LOG(WARNING) << base::StringPrintf(
+                          "invalid %s range (0x%" PRIx64 " + 0x%" PRIx64 ")",
+                          tag,
+                          address,
+                          size) << *module_info_;
       return false;
     }
 
     if (!linkedit_range_.ContainsRange(subrange)) {
       LOG(WARNING) << base::StringPrintf(
-                          "%s at 0x%llx + 0x%llx outside of " SEG_LINKEDIT
-                          " segment at 0x%llx + 0x%llx",
+                          "%s at 0x%" PRIx64 " + 0x%" PRIx64
+                          " outside of " SEG_LINKEDIT " segment at 0x%" PRIx64
+                          " + 0x%" PRIx64,
                           tag,
                           address,
                           size,
                           linkedit_range_.Base(),
-                          linkedit_range_.Size()) << module_info_;
+                          linkedit_range_.Size()) << *module_info_;
       return false;
     }
 
     return true;
   }
 
-  std::string module_info_;
+  const LogContext* module_info_;  // weak
   CheckedMachAddressRange linkedit_range_;
-  ProcessReader* process_reader_;  // weak
+  process_types::MemorySource* memory_source_;  // weak
   const MachOImageSegmentReader* linkedit_segment_;  // weak
 
   DISALLOW_COPY_AND_ASSIGN(MachOImageSymbolTableReaderInitializer);
@@ -233,25 +277,27 @@ class MachOImageSymbolTableReaderInitializer {
 }  // namespace internal
 
 MachOImageSymbolTableReader::MachOImageSymbolTableReader()
-    : external_defined_symbols_(), initialized_() {
+    : string_table_(), external_defined_symbols_(), initialized_() {
 }
 
 MachOImageSymbolTableReader::~MachOImageSymbolTableReader() {
 }
 
 bool MachOImageSymbolTableReader::Initialize(
-    ProcessReader* process_reader,
+    process_types::MemorySource* memory_source,
     const process_types::symtab_command* symtab_command,
     const process_types::dysymtab_command* dysymtab_command,
     const MachOImageSegmentReader* linkedit_segment,
-    const std::string& module_info) {
+    const LogContext& module_info) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
-  internal::MachOImageSymbolTableReaderInitializer initializer(process_reader,
+  internal::MachOImageSymbolTableReaderInitializer initializer(memory_source,
                                                                linkedit_segment,
-                                                               module_info);
-  if (!initializer.Initialize(
-          symtab_command, dysymtab_command, &external_defined_symbols_)) {
+                                                               &module_info);
+  if (!initializer.Initialize(symtab_command,
+                              dysymtab_command,
+                              &string_table_,
+                              &external_defined_symbols_)) {
     return false;
   }
 
@@ -264,11 +310,13 @@ MachOImageSymbolTableReader::LookUpExternalDefinedSymbol(
     const std::string& name) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
 
-  const auto& iterator = external_defined_symbols_.find(name);
-  if (iterator == external_defined_symbols_.end()) {
-    return NULL;
-  }
-  return &iterator->second;
+  return external_defined_symbols_.Find(name);
+}
+
+const MachOImageSymbolTableReader::SymbolInformationMap&
+MachOImageSymbolTableReader::external_defined_symbols() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return external_defined_symbols_;
 }
 
 }  // namespace crashpad
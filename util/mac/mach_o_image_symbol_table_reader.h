@@ -16,17 +16,19 @@
 #define CRASHPAD_UTIL_MAC_MACH_O_IMAGE_SYMBOL_TABLE_READER_H_
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 
-#include <map>
 #include <string>
 
 #include <mach/mach.h>
 #include <stdint.h>
 
 #include "util/mac/mach_o_image_segment_reader.h"
-#include "util/mac/process_reader.h"
 #include "util/mac/process_types.h"
 #include "util/misc/initialization_state_dcheck.h"
+#include "util/misc/log_context.h"
+#include "util/misc/remote_memory.h"
+#include "util/stdlib/flat_string_map.h"
 
 namespace crashpad {
 
@@ -52,21 +54,22 @@ class MachOImageSymbolTableReader {
     //! segment slid when loaded. For absolute symbols (`N_ABS`), this will be
     //! `NO_SECT` (`0`), and \a value must not be adjusted for segment slide.
     uint8_t section;
+
+    //! \brief The index of the symbol in the module’s symbol table.
+    //!
+    //! This is retained only to identify the symbol in diagnostic messages. It
+    //! occupies what would otherwise be padding.
+    uint32_t index;
   };
 
-  // TODO(mark): Use unordered_map or a similar hash-based map? For now,
-  // std::map is fine because this map only stores external defined symbols,
-  // and there aren’t expected to be very many of those that performance would
-  // become a problem. std::map is also guaranteed to be part of the standard
-  // library, which isn’t the case for std::unordered_map, which requires the
-  // C++11 library. In reality, std::unordered_map does not appear to provide
-  // a performance advantage. It appears that the memory copies currently done
-  // by TaskMemory::Read() have substantially more impact on symbol table
-  // operations.
+  // The keys of this map refer directly to the string table, which is mapped
+  // and retained in string_table_ for as long as this object exists, so
+  // building the map doesn’t copy any symbol names, and looking up a symbol
+  // doesn’t allocate.
   //
   // This is public so that the type is available to
   // MachOImageSymbolTableReaderInitializer.
-  typedef std::map<std::string, SymbolInformation> SymbolInformationMap;
+  typedef FlatStringMap<SymbolInformation> SymbolInformationMap;
 
   MachOImageSymbolTableReader();
   ~MachOImageSymbolTableReader();
@@ -76,7 +79,7 @@ class MachOImageSymbolTableReader {
   //! This method must only be called once on an object. This method must be
   //! called successfully before any other method in this class may be called.
   //!
-  //! \param[in] process_reader The reader for the remote process.
+  //! \param[in] memory_source The memory source for the remote process.
   //! \param[in] symtab_command The `LC_SYMTAB` load command that identifies
   //!     the symbol table.
   //! \param[in] dysymtab_command The `LC_DYSYMTAB` load command that identifies
@@ -90,16 +93,17 @@ class MachOImageSymbolTableReader {
   //!     contain the data referenced by \a symtab_command and \a
   //!     dysymtab_command. This may be any segment in the module, but by
   //!     convention, the name `__LINKEDIT` is used for this purpose.
-  //! \param[in] module_info A string to be used in logged messages. This string
-  //!     is for diagnostic purposes only, and may be empty.
+  //! \param[in] module_info Context to be used in logged messages. This is for
+  //!     diagnostic purposes only, and is only formatted if a message is
+  //!     logged.
   //!
   //! \return `true` if the symbol table was read successfully. `false`
   //!     otherwise, with an appropriate message logged.
-  bool Initialize(ProcessReader* process_reader,
+  bool Initialize(process_types::MemorySource* memory_source,
                   const process_types::symtab_command* symtab_command,
                   const process_types::dysymtab_command* dysymtab_command,
                   const MachOImageSegmentReader* linkedit_segment,
-                  const std::string& module_info);
+                  const LogContext& module_info);
 
   //! \brief Looks up a symbol in the image’s symbol table.
   //!
@@ -123,7 +127,16 @@ class MachOImageSymbolTableReader {
   const SymbolInformation* LookUpExternalDefinedSymbol(
       const std::string& name) const;
 
+  //! \brief Returns the image’s external defined symbols.
+  //!
+  //! This allows every symbol that can be found by
+  //! LookUpExternalDefinedSymbol() to be visited. The symbols’ names refer to
+  //! the image’s string table, which remains valid for the lifetime of this
+  //! MachOImageSymbolTableReader object.
+  const SymbolInformationMap& external_defined_symbols() const;
+
  private:
+  scoped_ptr<RemoteMemory::MappedMemory> string_table_;
   SymbolInformationMap external_defined_symbols_;
   InitializationStateDcheck initialized_;
 
@@ -27,6 +27,7 @@
 #include "base/strings/stringprintf.h"
 #include "util/mac/mach_o_image_reader.h"
 #include "util/mac/process_types.h"
+#include "util/misc/cached_remote_memory.h"
 #include "util/misc/scoped_forbid_return.h"
 
 namespace {
@@ -90,7 +91,8 @@ ProcessReader::Module::~Module() {
 }
 
 ProcessReader::ProcessReader()
-    : kern_proc_info_(),
+    : MemorySource(),
+      kern_proc_info_(),
       threads_(),
       modules_(),
       module_readers_(),
@@ -419,6 +421,11 @@ void ProcessReader::InitializeModules() {
     return;
   }
 
+  // dyld tends to keep the pathnames of loaded images close together, so
+  // reading them through a small cache avoids a separate mach_vm_read() for
+  // each one.
+  CachedRemoteMemory module_name_memory(task_memory_.get(), 16);
+
   size_t main_executable_count = 0;
   bool found_dyld = false;
   modules_.reserve(image_info_vector.size());
@@ -426,7 +433,8 @@ void ProcessReader::InitializeModules() {
     Module module;
     module.timestamp = image_info.imageFileModDate;
 
-    if (!task_memory_->ReadCString(image_info.imageFilePath, &module.name)) {
+    if (!module_name_memory.ReadCString(image_info.imageFilePath,
+                                        &module.name)) {
       LOG(WARNING) << "could not read dyld_image_info::imageFilePath";
       // Proceed anyway with an empty module name.
     }
@@ -27,6 +27,7 @@
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
 #include "build/build_config.h"
+#include "util/mac/process_types/memory_source.h"
 #include "util/mach/task_memory.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/stdlib/pointer_container.h"
@@ -37,7 +38,10 @@ class MachOImageReader;
 
 //! \brief Accesses information about another process, identified by a Mach
 //!     task.
-class ProcessReader {
+//!
+//! This is the process_types::MemorySource used to read process_types
+//! structures and Mach-O images from a running task.
+class ProcessReader final : public process_types::MemorySource {
  public:
   //! \brief Contains information about a thread that belongs to a task
   //!     (process).
@@ -109,7 +113,7 @@ class ProcessReader {
   bool Initialize(task_t task);
 
   //! \return `true` if the target task is a 64-bit process.
-  bool Is64Bit() const { return is_64_bit_; }
+  virtual bool Is64Bit() const override { return is_64_bit_; }
 
   //! \return The target task’s process ID.
   pid_t ProcessID() const { return kern_proc_info_.kp_proc.p_pid; }
@@ -131,7 +135,7 @@ class ProcessReader {
   bool CPUTimes(timeval* user_time, timeval* system_time) const;
 
   //! \return Accesses the memory of the target task.
-  TaskMemory* Memory() { return task_memory_.get(); }
+  virtual TaskMemory* Memory() override { return task_memory_.get(); }
 
   //! \return The threads that are in the task (process). The first element (at
   //!     index `0`) corresponds to the main thread.
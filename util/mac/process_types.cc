@@ -15,11 +15,9 @@
 #include "util/mac/process_types.h"
 
 #include <string.h>
-#include <uuid/uuid.h>
 
 #include "base/memory/scoped_ptr.h"
 #include "util/mac/process_types/internal.h"
-#include "util/mach/task_memory.h"
 
 namespace crashpad {
 namespace {
@@ -66,9 +64,10 @@ inline void Assign<UInt64Array16, UInt32Array16>(UInt64Array16* destination,
   }
 }
 
+typedef uint8_t UInt8Array16[16];
 template <>
-inline void Assign<uuid_t, uuid_t>(uuid_t* destination, const uuid_t& source) {
-  // uuid_t is a typedef for unsigned char[16].
+inline void Assign<UInt8Array16, UInt8Array16>(UInt8Array16* destination,
+                                               const UInt8Array16& source) {
   memcpy(destination, &source, sizeof(source));
 }
 
@@ -86,32 +85,32 @@ inline void Assign<uuid_t, uuid_t>(uuid_t* destination, const uuid_t& source) {
   namespace crashpad {                                                     \
   namespace process_types {                                                \
                                                                            \
-  size_t struct_name::ExpectedSize(ProcessReader* process_reader) {        \
-    if (!process_reader->Is64Bit()) {                                      \
+  size_t struct_name::ExpectedSize(MemorySource* memory_source) {          \
+    if (!memory_source->Is64Bit()) {                                       \
       return internal::struct_name<internal::Traits32>::Size();            \
     } else {                                                               \
       return internal::struct_name<internal::Traits64>::Size();            \
     }                                                                      \
   }                                                                        \
                                                                            \
-  bool struct_name::ReadInto(ProcessReader* process_reader,                \
+  bool struct_name::ReadInto(MemorySource* memory_source,                  \
                              mach_vm_address_t address,                    \
                              struct_name* generic) {                       \
-    if (!process_reader->Is64Bit()) {                                      \
+    if (!memory_source->Is64Bit()) {                                       \
       return ReadIntoInternal<internal::struct_name<internal::Traits32> >( \
-          process_reader, address, generic);                               \
+          memory_source, address, generic);                                \
     } else {                                                               \
       return ReadIntoInternal<internal::struct_name<internal::Traits64> >( \
-          process_reader, address, generic);                               \
+          memory_source, address, generic);                                \
     }                                                                      \
   }                                                                        \
                                                                            \
   template <typename T>                                                    \
-  bool struct_name::ReadIntoInternal(ProcessReader* process_reader,        \
+  bool struct_name::ReadIntoInternal(MemorySource* memory_source,          \
                                      mach_vm_address_t address,            \
                                      struct_name* generic) {               \
     T specific;                                                            \
-    if (!specific.Read(process_reader, address)) {                         \
+    if (!specific.Read(memory_source, address)) {                          \
       return false;                                                        \
     }                                                                      \
     specific.GenericizeInto(generic, &generic->size_);                     \
@@ -148,22 +147,55 @@ inline void Assign<uuid_t, uuid_t>(uuid_t* destination, const uuid_t& source) {
 // some types may wish to provide custom readers. This can be done by guarding
 // such types’ proctype definitions against this macro and providing custom
 // implementations in util/mac/process_types/custom.cc.
+//
+// The generic crashpad::process_types::struct_name ReadFromBufferInto() is also
+// implemented here, because it genericizes a struct of the full specific size,
+// which is what the default reader reads. A type with a custom reader may be
+// smaller in the remote process, so it gets no ReadFromBufferInto().
 #define PROCESS_TYPE_STRUCT_IMPLEMENT_INTERNAL_READ_INTO 1
 
-#define PROCESS_TYPE_STRUCT_BEGIN(struct_name)                        \
-  namespace crashpad {                                                \
-  namespace process_types {                                           \
-  namespace internal {                                                \
-                                                                      \
-  template <typename Traits>                                          \
-  bool struct_name<Traits>::ReadInto(ProcessReader* process_reader,   \
-                                     mach_vm_address_t address,       \
-                                     struct_name<Traits>* specific) { \
-    return process_reader->Memory()->Read(                            \
-        address, sizeof(*specific), specific);                        \
-  }                                                                   \
-  }  /* namespace internal */                                         \
-  }  /* namespace process_types */                                    \
+#define PROCESS_TYPE_STRUCT_BEGIN(struct_name)                           \
+  namespace crashpad {                                                   \
+  namespace process_types {                                              \
+  namespace internal {                                                   \
+                                                                         \
+  template <typename Traits>                                             \
+  bool struct_name<Traits>::ReadInto(MemorySource* memory_source,        \
+                                     mach_vm_address_t address,          \
+                                     struct_name<Traits>* specific) {    \
+    return memory_source->Memory()->Read(                                \
+        address, sizeof(*specific), specific);                           \
+  }                                                                      \
+  }  /* namespace internal */                                            \
+                                                                         \
+  bool struct_name::ReadFromBufferInto(MemorySource* memory_source,      \
+                                       const void* buffer,               \
+                                       size_t size,                      \
+                                       struct_name* generic) {           \
+    if (!memory_source->Is64Bit()) {                                     \
+      return ReadFromBufferIntoInternal<                                 \
+          internal::struct_name<internal::Traits32> >(                   \
+          buffer, size, generic);                                        \
+    } else {                                                             \
+      return ReadFromBufferIntoInternal<                                 \
+          internal::struct_name<internal::Traits64> >(                   \
+          buffer, size, generic);                                        \
+    }                                                                    \
+  }                                                                      \
+                                                                         \
+  template <typename T>                                                  \
+  bool struct_name::ReadFromBufferIntoInternal(const void* buffer,       \
+                                               size_t size,              \
+                                               struct_name* generic) {   \
+    T specific;                                                          \
+    if (size < sizeof(specific)) {                                       \
+      return false;                                                      \
+    }                                                                    \
+    memcpy(&specific, buffer, sizeof(specific));                         \
+    specific.GenericizeInto(generic, &generic->size_);                   \
+    return true;                                                         \
+  }                                                                      \
+  }  /* namespace process_types */                                       \
   }  /* namespace crashpad */
 
 #define PROCESS_TYPE_STRUCT_MEMBER(member_type, member_name, ...)
@@ -190,44 +222,77 @@ inline void Assign<uuid_t, uuid_t>(uuid_t* destination, const uuid_t& source) {
   namespace internal {                                                        \
                                                                               \
   template <typename Traits>                                                  \
-  bool struct_name<Traits>::ReadArrayInto(ProcessReader* process_reader,      \
+  bool struct_name<Traits>::ReadArrayInto(MemorySource* memory_source,        \
                                           mach_vm_address_t address,          \
                                           size_t count,                       \
                                           struct_name<Traits>* specific) {    \
-    return process_reader->Memory()->Read(                                    \
+    return memory_source->Memory()->Read(                                     \
         address, sizeof(struct_name<Traits> [count]), specific);              \
   }                                                                           \
   }  /* namespace internal */                                                 \
                                                                               \
-  bool struct_name::ReadArrayInto(ProcessReader* process_reader,              \
+  bool struct_name::ReadArrayInto(MemorySource* memory_source,                \
                                   mach_vm_address_t address,                  \
                                   size_t count,                               \
                                   struct_name* generic) {                     \
-    if (!process_reader->Is64Bit()) {                                         \
+    if (!memory_source->Is64Bit()) {                                          \
       return ReadArrayIntoInternal<                                           \
           internal::struct_name<internal::Traits32> >(                        \
-          process_reader, address, count, generic);                           \
+          memory_source, address, count, generic);                            \
     } else {                                                                  \
       return ReadArrayIntoInternal<                                           \
           internal::struct_name<internal::Traits64> >(                        \
-          process_reader, address, count, generic);                           \
+          memory_source, address, count, generic);                            \
     }                                                                         \
     return true;                                                              \
   }                                                                           \
                                                                               \
   template <typename T>                                                       \
-  bool struct_name::ReadArrayIntoInternal(ProcessReader* process_reader,      \
+  bool struct_name::ReadArrayIntoInternal(MemorySource* memory_source,        \
                                           mach_vm_address_t address,          \
                                           size_t count,                       \
                                           struct_name* generic) {             \
     scoped_ptr<T[]> specific(new T[count]);                                   \
-    if (!T::ReadArrayInto(process_reader, address, count, &specific[0])) {    \
+    if (!T::ReadArrayInto(memory_source, address, count, &specific[0])) {     \
       return false;                                                           \
     }                                                                         \
     for (size_t index = 0; index < count; ++index) {                          \
       specific[index].GenericizeInto(&generic[index], &generic[index].size_); \
     }                                                                         \
     return true;                                                              \
+  }                                                                           \
+                                                                              \
+  bool struct_name::ReadArrayFromBuffer(MemorySource* memory_source,          \
+                                        const void* buffer,                   \
+                                        size_t size,                          \
+                                        size_t count,                         \
+                                        struct_name* generic) {               \
+    if (!memory_source->Is64Bit()) {                                          \
+      return ReadArrayFromBufferInternal<                                     \
+          internal::struct_name<internal::Traits32> >(                        \
+          buffer, size, count, generic);                                      \
+    } else {                                                                  \
+      return ReadArrayFromBufferInternal<                                     \
+          internal::struct_name<internal::Traits64> >(                        \
+          buffer, size, count, generic);                                      \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  template <typename T>                                                       \
+  bool struct_name::ReadArrayFromBufferInternal(const void* buffer,           \
+                                                size_t size,                  \
+                                                size_t count,                 \
+                                                struct_name* generic) {       \
+    if (count > size / sizeof(T)) {                                           \
+      return false;                                                           \
+    }                                                                         \
+    const char* buffer_c = static_cast<const char*>(buffer);                  \
+    for (size_t index = 0; index < count; ++index) {                          \
+      T specific;                                                             \
+      memcpy(&specific, buffer_c + index * sizeof(T), sizeof(T));             \
+      specific.GenericizeInto(&generic[index], &generic[index].size_);        \
+    }                                                                         \
+    return true;                                                              \
   }                                                                           \
   }  /* namespace process_types */                                            \
   }  /* namespace crashpad */
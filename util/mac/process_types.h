@@ -16,12 +16,10 @@
 #define CRASHPAD_UTIL_MAC_PROCESS_TYPES_H_
 
 #include <mach/mach.h>
-#include <mach-o/dyld_images.h>
-#include <mach-o/loader.h>
 #include <stdint.h>
 #include <sys/types.h>
 
-#include "util/mac/process_reader.h"
+#include "util/mac/process_types/memory_source.h"
 
 namespace crashpad {
 namespace process_types {
@@ -63,29 +61,47 @@ DECLARE_PROCESS_TYPE_TRAITS_CLASS(Generic, 64)
     typedef internal::TraitsGeneric::UIntPtr UIntPtr;                          \
     typedef internal::TraitsGeneric::Reserved64Only Reserved64Only;            \
                                                                                \
-    /* Initializes an object with data read from |process_reader| at           \
+    /* Initializes an object with data read from |memory_source| at            \
      * |address|, properly genericized. */                                     \
-    bool Read(ProcessReader* process_reader, mach_vm_address_t address) {      \
-      return ReadInto(process_reader, address, this);                          \
+    bool Read(MemorySource* memory_source, mach_vm_address_t address) {        \
+      return ReadInto(memory_source, address, this);                           \
     }                                                                          \
                                                                                \
-    /* Reads |count| objects from |process_reader| beginning at |address|, and \
+    /* Reads |count| objects from |memory_source| beginning at |address|, and  \
      * genericizes the objects. The caller must provide storage for |count|    \
      * objects in |generic|. */                                                \
-    static bool ReadArrayInto(ProcessReader* process_reader,                   \
+    static bool ReadArrayInto(MemorySource* memory_source,                     \
                               mach_vm_address_t address,                       \
                               size_t count,                                    \
                               struct_name* generic);                           \
                                                                                \
+    /* Initializes an object with data from |buffer|, a copy of |size| bytes   \
+     * of the memory in |memory_source| that was already made in the current  \
+     * process, properly genericized. No memory is read from the source.       \
+     * Returns false if |size| is too small. This is not implemented for types \
+     * with custom readers, whose size in the process may vary. */             \
+    bool ReadFromBuffer(MemorySource* memory_source,                           \
+                        const void* buffer,                                    \
+                        size_t size) {                                         \
+      return ReadFromBufferInto(memory_source, buffer, size, this);            \
+    }                                                                          \
+                                                                               \
+    /* The ReadFromBuffer() form of ReadArrayInto(). */                        \
+    static bool ReadArrayFromBuffer(MemorySource* memory_source,               \
+                                    const void* buffer,                        \
+                                    size_t size,                               \
+                                    size_t count,                              \
+                                    struct_name* generic);                     \
+                                                                               \
     /* Returns the size of the object that was read. This is the size of the   \
      * storage in the process that the data is read from, and is not the same  \
      * as the size of the generic struct. */                                   \
     size_t Size() const { return size_; }                                      \
                                                                                \
     /* Similar to Size(), but computes the expected size of a structure based  \
-     * on the process’ bitness. This can be used prior to reading any data     \
-     * from a process. */                                                      \
-    static size_t ExpectedSize(ProcessReader* process_reader);
+     * on the bitness of |memory_source|. This can be used prior to reading    \
+     * any data from it. */                                                    \
+    static size_t ExpectedSize(MemorySource* memory_source);
 
 #define PROCESS_TYPE_STRUCT_MEMBER(member_type, member_name, ...)              \
     member_type member_name __VA_ARGS__;
@@ -93,19 +109,36 @@ DECLARE_PROCESS_TYPE_TRAITS_CLASS(Generic, 64)
 #define PROCESS_TYPE_STRUCT_END(struct_name)                                   \
    private:                                                                    \
     /* The static form of Read(). Populates the struct at |generic|. */        \
-    static bool ReadInto(ProcessReader* process_reader,                        \
+    static bool ReadInto(MemorySource* memory_source,                          \
                          mach_vm_address_t address,                            \
                          struct_name* generic);                                \
                                                                                \
     template <typename T>                                                      \
-    static bool ReadIntoInternal(ProcessReader* process_reader,                \
+    static bool ReadIntoInternal(MemorySource* memory_source,                  \
                                  mach_vm_address_t address,                    \
                                  struct_name* generic);                        \
     template <typename T>                                                      \
-    static bool ReadArrayIntoInternal(ProcessReader* process_reader,           \
+    static bool ReadArrayIntoInternal(MemorySource* memory_source,             \
                                       mach_vm_address_t address,               \
                                       size_t count,                            \
                                       struct_name* generic);                   \
+                                                                               \
+    /* The static form of ReadFromBuffer(). Populates the struct at            \
+     * |generic|. */                                                           \
+    static bool ReadFromBufferInto(MemorySource* memory_source,                \
+                                   const void* buffer,                         \
+                                   size_t size,                                \
+                                   struct_name* generic);                      \
+                                                                               \
+    template <typename T>                                                      \
+    static bool ReadFromBufferIntoInternal(const void* buffer,                 \
+                                           size_t size,                        \
+                                           struct_name* generic);              \
+    template <typename T>                                                      \
+    static bool ReadArrayFromBufferInternal(const void* buffer,                \
+                                            size_t size,                       \
+                                            size_t count,                      \
+                                            struct_name* generic);             \
     size_t size_;                                                              \
   };                                                                           \
   }  /* namespace process_types */                                             \
@@ -145,10 +178,10 @@ DECLARE_PROCESS_TYPE_TRAITS_CLASS(Generic, 64)
                                                                                \
     /* Read(), ReadArrayInto(), and Size() are as in the generic user-visible  \
      * struct above. */                                                        \
-    bool Read(ProcessReader* process_reader, mach_vm_address_t address) {      \
-      return ReadInto(process_reader, address, this);                          \
+    bool Read(MemorySource* memory_source, mach_vm_address_t address) {        \
+      return ReadInto(memory_source, address, this);                           \
     }                                                                          \
-    static bool ReadArrayInto(ProcessReader* process_reader,                   \
+    static bool ReadArrayInto(MemorySource* memory_source,                     \
                               mach_vm_address_t address,                       \
                               size_t count,                                    \
                               struct_name<Traits>* specific);                  \
@@ -165,7 +198,7 @@ DECLARE_PROCESS_TYPE_TRAITS_CLASS(Generic, 64)
 #define PROCESS_TYPE_STRUCT_END(struct_name)                                   \
    private:                                                                    \
     /* ReadInto() is as in the generic user-visible struct above. */           \
-    static bool ReadInto(ProcessReader* process_reader,                        \
+    static bool ReadInto(MemorySource* memory_source,                          \
                          mach_vm_address_t address,                            \
                          struct_name<Traits>* specific);                       \
   };                                                                           \
@@ -14,10 +14,11 @@
 
 #include "util/mac/process_types.h"
 
+#include <stddef.h>
 #include <string.h>
 
 #include "util/mac/process_types/internal.h"
-#include "util/mach/task_memory.h"
+#include "util/misc/remote_memory.h"
 
 namespace crashpad {
 namespace process_types {
@@ -25,12 +26,11 @@ namespace internal {
 
 template <typename Traits>
 bool dyld_all_image_infos<Traits>::ReadInto(
-    ProcessReader* process_reader,
+    MemorySource* memory_source,
     mach_vm_address_t address,
     dyld_all_image_infos<Traits>* specific) {
-  TaskMemory* task_memory = process_reader->Memory();
-  if (!task_memory->Read(
-          address, sizeof(specific->version), &specific->version)) {
+  RemoteMemory* memory = memory_source->Memory();
+  if (!memory->Read(address, sizeof(specific->version), &specific->version)) {
     return false;
   }
 
@@ -65,7 +65,7 @@ bool dyld_all_image_infos<Traits>::ReadInto(
     size = offsetof(dyld_all_image_infos<Traits>, infoArrayCount);
   }
 
-  if (!task_memory->Read(address, size, specific)) {
+  if (!memory->Read(address, size, specific)) {
     return false;
   }
 
@@ -82,7 +82,7 @@ bool dyld_all_image_infos<Traits>::ReadInto(
 
 #define PROCESS_TYPE_FLAVOR_TRAITS(lp_bits)                      \
   template bool dyld_all_image_infos<Traits##lp_bits>::ReadInto( \
-      ProcessReader*,                                            \
+      MemorySource*,                                             \
       mach_vm_address_t,                                         \
       dyld_all_image_infos<Traits##lp_bits>*);
 
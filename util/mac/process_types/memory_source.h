@@ -0,0 +1,77 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MAC_PROCESS_TYPES_MEMORY_SOURCE_H_
+#define CRASHPAD_UTIL_MAC_PROCESS_TYPES_MEMORY_SOURCE_H_
+
+#include "base/basictypes.h"
+#include "util/misc/remote_memory.h"
+
+namespace crashpad {
+namespace process_types {
+
+//! \brief An interface to the memory that process_types structures and Mach-O
+//!     images are read from.
+//!
+//! The layout of a process_types structure depends on whether it comes from a
+//! 32-bit or 64-bit environment, so a memory source pairs a RemoteMemory
+//! object with that bitness. ProcessReader is the memory source for a running
+//! Mach task. RemoteMemorySource can be used with any other RemoteMemory, such
+//! as a FileRemoteMemory holding a Mach-O file, or a BufferRemoteMemory.
+class MemorySource {
+ public:
+  virtual ~MemorySource() {}
+
+  //! \return `true` if structures in this memory source use the 64-bit layout,
+  //!     `false` if they use the 32-bit layout.
+  virtual bool Is64Bit() const = 0;
+
+  //! \return An accessor for the memory. The caller does not take ownership.
+  virtual RemoteMemory* Memory() = 0;
+
+ protected:
+  MemorySource() {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MemorySource);
+};
+
+//! \brief A MemorySource for an arbitrary RemoteMemory object.
+class RemoteMemorySource final : public MemorySource {
+ public:
+  //! \param[in] memory The memory to read. This object does not take ownership
+  //!     of \a memory, which must outlive it.
+  //! \param[in] is_64_bit Whether structures in \a memory use the 64-bit
+  //!     layout.
+  RemoteMemorySource(RemoteMemory* memory, bool is_64_bit)
+      : MemorySource(), memory_(memory), is_64_bit_(is_64_bit) {}
+
+  ~RemoteMemorySource() {}
+
+  // MemorySource:
+
+  virtual bool Is64Bit() const override { return is_64_bit_; }
+  virtual RemoteMemory* Memory() override { return memory_; }
+
+ private:
+  RemoteMemory* memory_;  // weak
+  bool is_64_bit_;
+
+  DISALLOW_COPY_AND_ASSIGN(RemoteMemorySource);
+};
+
+}  // namespace process_types
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MAC_PROCESS_TYPES_MEMORY_SOURCE_H_
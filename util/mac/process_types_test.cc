@@ -16,13 +16,17 @@
 
 #include <AvailabilityMacros.h>
 #include <mach/mach.h>
+#include <mach-o/dyld.h>
+#include <mach-o/dyld_images.h>
 #include <string.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "base/strings/stringprintf.h"
 #include "gtest/gtest.h"
 #include "util/mac/mac_util.h"
+#include "util/mac/process_reader.h"
 #include "util/test/mac/dyld.h"
 
 namespace crashpad {
@@ -258,6 +262,70 @@ TEST(ProcessTypes, DyldImagesSelf) {
 #endif
 }
 
+TEST(ProcessTypes, ReadFromBuffer) {
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(mach_task_self()));
+
+  // In the current process, a buffer holding a structure and the address of
+  // the structure refer to the same memory, so reading from either should
+  // produce the same result.
+  const mach_header* self_header = _dyld_get_image_header(0);
+  ASSERT_TRUE(self_header);
+  process_types::mach_header read_header;
+  ASSERT_TRUE(read_header.Read(
+      &process_reader, reinterpret_cast<mach_vm_address_t>(self_header)));
+
+  process_types::mach_header buffer_header;
+  ASSERT_TRUE(buffer_header.ReadFromBuffer(
+      &process_reader, self_header, read_header.Size()));
+  EXPECT_EQ(read_header.Size(), buffer_header.Size());
+  EXPECT_EQ(read_header.magic, buffer_header.magic);
+  EXPECT_EQ(read_header.filetype, buffer_header.filetype);
+  EXPECT_EQ(read_header.ncmds, buffer_header.ncmds);
+  EXPECT_EQ(read_header.sizeofcmds, buffer_header.sizeofcmds);
+
+  EXPECT_FALSE(buffer_header.ReadFromBuffer(
+      &process_reader, self_header, read_header.Size() - 1));
+
+  const struct dyld_all_image_infos* self_image_infos =
+      _dyld_get_all_image_infos();
+  const size_t count =
+      std::min(self_image_infos->infoArrayCount, static_cast<uint32_t>(16));
+  ASSERT_GT(count, 0u);
+  const size_t size = count * sizeof(self_image_infos->infoArray[0]);
+
+  std::vector<process_types::dyld_image_info> read_infos(count);
+  ASSERT_TRUE(process_types::dyld_image_info::ReadArrayInto(
+      &process_reader,
+      reinterpret_cast<mach_vm_address_t>(self_image_infos->infoArray),
+      count,
+      &read_infos[0]));
+
+  std::vector<process_types::dyld_image_info> buffer_infos(count);
+  ASSERT_TRUE(process_types::dyld_image_info::ReadArrayFromBuffer(
+      &process_reader,
+      self_image_infos->infoArray,
+      size,
+      count,
+      &buffer_infos[0]));
+
+  for (size_t index = 0; index < count; ++index) {
+    EXPECT_EQ(read_infos[index].imageLoadAddress,
+              buffer_infos[index].imageLoadAddress) << "index " << index;
+    EXPECT_EQ(read_infos[index].imageFilePath,
+              buffer_infos[index].imageFilePath) << "index " << index;
+    EXPECT_EQ(read_infos[index].imageFileModDate,
+              buffer_infos[index].imageFileModDate) << "index " << index;
+  }
+
+  EXPECT_FALSE(process_types::dyld_image_info::ReadArrayFromBuffer(
+      &process_reader,
+      self_image_infos->infoArray,
+      size - 1,
+      count,
+      &buffer_infos[0]));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -21,50 +21,50 @@
 
 #include "base/logging.h"
 #include "base/mac/mach_logging.h"
+#include "base/mac/scoped_mach_vm.h"
 #include "base/strings/stringprintf.h"
 #include "util/stdlib/strnlen.h"
 
 namespace crashpad {
 
-TaskMemory::MappedMemory::~MappedMemory() {
-}
-
-bool TaskMemory::MappedMemory::ReadCString(
-    size_t offset, std::string* string) const {
-  if (offset >= user_size_) {
-    LOG(WARNING) << "offset out of range";
-    return false;
+namespace {
+
+// A memory region mapped from another Mach task. The mapping is maintained
+// until this object is destroyed.
+class TaskMappedMemory final : public RemoteMemory::MappedMemory {
+ public:
+  // |vm_address| and |vm_size| give the page-aligned mapping. The data
+  // requested by the user begins |user_offset| bytes into it, accounting for
+  // the fact that a mapping must be page-aligned but the user data may not be,
+  // and is |user_size| bytes long, within the mapped region.
+  TaskMappedMemory(vm_address_t vm_address,
+                   size_t vm_size,
+                   size_t user_offset,
+                   size_t user_size)
+      : RemoteMemory::MappedMemory(
+            reinterpret_cast<const void*>(vm_address + user_offset),
+            user_size),
+        vm_(vm_address, vm_size) {
+    vm_address_t vm_end = vm_address + vm_size;
+    vm_address_t user_address = reinterpret_cast<vm_address_t>(data());
+    vm_address_t user_end = user_address + user_size;
+    DCHECK_GE(user_address, vm_address);
+    DCHECK_LE(user_address, vm_end);
+    DCHECK_GE(user_end, vm_address);
+    DCHECK_LE(user_end, vm_end);
   }
 
-  const char* string_base = reinterpret_cast<const char*>(data_) + offset;
-  size_t max_length = user_size_ - offset;
-  size_t string_length = strnlen(string_base, max_length);
-  if (string_length == max_length) {
-    LOG(WARNING) << "unterminated string";
-    return false;
-  }
+  virtual ~TaskMappedMemory() {}
 
-  string->assign(string_base, string_length);
-  return true;
-}
+ private:
+  base::mac::ScopedMachVM vm_;
 
-TaskMemory::MappedMemory::MappedMemory(vm_address_t vm_address,
-                                       size_t vm_size,
-                                       size_t user_offset,
-                                       size_t user_size)
-    : vm_(vm_address, vm_size),
-      data_(reinterpret_cast<const void*>(vm_address + user_offset)),
-      user_size_(user_size) {
-  vm_address_t vm_end = vm_address + vm_size;
-  vm_address_t user_address = reinterpret_cast<vm_address_t>(data_);
-  vm_address_t user_end = user_address + user_size;
-  DCHECK_GE(user_address, vm_address);
-  DCHECK_LE(user_address, vm_end);
-  DCHECK_GE(user_end, vm_address);
-  DCHECK_LE(user_end, vm_end);
-}
+  DISALLOW_COPY_AND_ASSIGN(TaskMappedMemory);
+};
+
+}  // namespace
 
-TaskMemory::TaskMemory(task_t task) : task_(task) {
+TaskMemory::TaskMemory(task_t task) : RemoteMemory(), task_(task) {
 }
 
 bool TaskMemory::Read(mach_vm_address_t address, size_t size, void* buffer) {
@@ -77,10 +77,10 @@ bool TaskMemory::Read(mach_vm_address_t address, size_t size, void* buffer) {
   return true;
 }
 
-scoped_ptr<TaskMemory::MappedMemory> TaskMemory::ReadMapped(
+scoped_ptr<RemoteMemory::MappedMemory> TaskMemory::ReadMapped(
     mach_vm_address_t address, size_t size) {
   if (size == 0) {
-    return scoped_ptr<MappedMemory>(new MappedMemory(0, 0, 0, 0));
+    return scoped_ptr<MappedMemory>(new TaskMappedMemory(0, 0, 0, 0));
   }
 
   mach_vm_address_t region_address = mach_vm_trunc_page(address);
@@ -98,8 +98,8 @@ scoped_ptr<TaskMemory::MappedMemory> TaskMemory::ReadMapped(
   }
 
   DCHECK_EQ(region_count, region_size);
-  return scoped_ptr<MappedMemory>(
-      new MappedMemory(region, region_size, address - region_address, size));
+  return scoped_ptr<MappedMemory>(new TaskMappedMemory(
+      region, region_size, address - region_address, size));
 }
 
 bool TaskMemory::ReadCString(mach_vm_address_t address, std::string* string) {
@@ -0,0 +1,91 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/arena.h"
+
+#include <algorithm>
+
+namespace {
+
+// Blocks obtained from the system are at least this large, and successive
+// blocks double in size, so that the number of system allocations grows only
+// logarithmically with the amount of memory used.
+const size_t kMinimumBlockSize = 16 * 1024;
+
+}  // namespace
+
+namespace crashpad {
+
+Arena::Arena()
+    : block_(NULL),
+      next_(0),
+      end_(0),
+      destructors_(NULL),
+      bytes_used_(0),
+      block_count_(0) {
+}
+
+Arena::~Arena() {
+  for (Destructor* destructor = destructors_; destructor;
+       destructor = destructor->next) {
+    destructor->destroy(destructor->object);
+  }
+
+  while (block_) {
+    Block* previous = block_->previous;
+    delete[] reinterpret_cast<uint8_t*>(block_);
+    block_ = previous;
+  }
+}
+
+void Arena::Reserve(size_t size) {
+  if (end_ - next_ < size) {
+    AddBlock(size, 1);
+  }
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  DCHECK_NE(alignment, 0u);
+  DCHECK_EQ(alignment & (alignment - 1), 0u);
+
+  uintptr_t aligned = (next_ + alignment - 1) & ~(alignment - 1);
+  if (!block_ || aligned < next_ || aligned > end_ || end_ - aligned < size) {
+    AddBlock(size, alignment);
+    aligned = (next_ + alignment - 1) & ~(alignment - 1);
+  }
+
+  bytes_used_ += aligned - next_ + size;
+  next_ = aligned + size;
+  return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::AddBlock(size_t size, size_t alignment) {
+  size_t previous_size = block_ ? block_->size : 0;
+  CHECK_LE(size, static_cast<size_t>(-1) / 2 - sizeof(Block) - alignment);
+  size_t block_size = std::max(
+      std::max(kMinimumBlockSize, previous_size * 2),
+      sizeof(Block) + alignment - 1 + size);
+
+  Block* block = reinterpret_cast<Block*>(new uint8_t[block_size]);
+  block->previous = block_;
+  block->size = block_size;
+  block_ = block;
+  ++block_count_;
+
+  // Any space remaining in the previous block is abandoned.
+  next_ = reinterpret_cast<uintptr_t>(block) + sizeof(Block);
+  end_ = reinterpret_cast<uintptr_t>(block) + block_size;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,210 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_ARENA_H_
+#define CRASHPAD_UTIL_MISC_ARENA_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <new>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+namespace crashpad {
+
+//! \brief A bump allocator that releases everything allocated from it at once.
+//!
+//! Memory is carved sequentially out of large blocks obtained from the system,
+//! so that building a structure of many small objects requires only a handful
+//! of system allocations. Individual allocations are never freed. All memory,
+//! and all objects created by New(), are released when the Arena is destroyed.
+//!
+//! Reserve() can be used to obtain all of the memory that a structure is
+//! expected to need in advance, for example, before entering a context where
+//! calling `malloc()` is undesirable.
+//!
+//! This class is not thread-safe.
+class Arena {
+ public:
+  Arena();
+  ~Arena();
+
+  //! \brief Ensures that at least \a size bytes can be allocated without
+  //!     obtaining any more memory from the system.
+  //!
+  //! Because of alignment and per-object bookkeeping, the number of bytes
+  //! that can actually be allocated may be slightly smaller than \a size.
+  void Reserve(size_t size);
+
+  //! \brief Allocates \a size bytes aligned to \a alignment.
+  //!
+  //! \param[in] size The number of bytes to allocate.
+  //! \param[in] alignment The required alignment, which must be a power of 2.
+  //!
+  //! \return The allocated memory, which remains valid until the Arena is
+  //!     destroyed. Its content is not initialized.
+  void* Allocate(size_t size, size_t alignment);
+
+  //! \brief Allocates uninitialized storage for \a count objects of type \a T.
+  //!
+  //! \a T must not require construction or destruction.
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    CHECK_LE(count, static_cast<size_t>(-1) / sizeof(T));
+    return static_cast<T*>(Allocate(sizeof(T) * count, __alignof__(T)));
+  }
+
+  //! \brief Creates a default-constructed object of type \a T.
+  //!
+  //! \return The new object, which is owned by the Arena. Its destructor will
+  //!     be run when the Arena is destroyed, in the reverse order of creation.
+  template <typename T>
+  T* New() {
+    Destructor* destructor = static_cast<Destructor*>(
+        Allocate(sizeof(Destructor), __alignof__(Destructor)));
+    T* object = new (Allocate(sizeof(T), __alignof__(T))) T();
+    destructor->next = destructors_;
+    destructor->destroy = &DestroyObject<T>;
+    destructor->object = object;
+    destructors_ = destructor;
+    return object;
+  }
+
+  //! \brief The number of bytes handed out by Allocate(), including alignment
+  //!     padding.
+  size_t bytes_used() const { return bytes_used_; }
+
+  //! \brief The number of blocks of memory obtained from the system.
+  size_t block_count() const { return block_count_; }
+
+ private:
+  struct Block {
+    Block* previous;
+    size_t size;
+  };
+
+  struct Destructor {
+    Destructor* next;
+    void (*destroy)(void*);
+    void* object;
+  };
+
+  template <typename T>
+  static void DestroyObject(void* object) {
+    static_cast<T*>(object)->~T();
+  }
+
+  // Obtains a new block able to hold at least |size| bytes at any alignment up
+  // to |alignment|, and makes it current.
+  void AddBlock(size_t size, size_t alignment);
+
+  Block* block_;
+  uintptr_t next_;
+  uintptr_t end_;
+  Destructor* destructors_;
+  size_t bytes_used_;
+  size_t block_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+//! \brief A growable array of trivially-copyable elements that can be
+//!     allocated from an Arena.
+//!
+//! By default, storage is obtained from the heap, as with `std::vector<>`.
+//! Once set_arena() has been called, storage is obtained from the Arena
+//! instead, and storage that is outgrown is abandoned to the Arena rather than
+//! being freed.
+//!
+//! \a T must not require construction or destruction, and must be safe to copy
+//! with `memcpy()`.
+template <typename T>
+class ArenaVector {
+ public:
+  ArenaVector() : data_(NULL), size_(0), capacity_(0), arena_(NULL) {}
+
+  ~ArenaVector() {
+    if (!arena_) {
+      delete[] data_;
+    }
+  }
+
+  //! \brief Causes storage to be allocated from \a arena.
+  //!
+  //! \note This may only be called before any storage has been allocated.
+  void set_arena(Arena* arena) {
+    DCHECK(!data_);
+    arena_ = arena;
+  }
+
+  //! \brief Ensures that \a capacity elements can be stored without
+  //!     allocating.
+  void reserve(size_t capacity) {
+    if (capacity <= capacity_) {
+      return;
+    }
+
+    T* data = arena_ ? arena_->AllocateArray<T>(capacity) : new T[capacity];
+    if (size_) {
+      memcpy(data, data_, size_ * sizeof(T));
+    }
+    if (!arena_) {
+      delete[] data_;
+    }
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  void push_back(const T& value) {
+    if (size_ == capacity_) {
+      reserve(capacity_ ? capacity_ * 2 : 1);
+    }
+    data_[size_++] = value;
+  }
+
+  void clear() { size_ = 0; }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  T& operator[](size_t index) {
+    DCHECK_LT(index, size_);
+    return data_[index];
+  }
+
+  const T& operator[](size_t index) const {
+    DCHECK_LT(index, size_);
+    return data_[index];
+  }
+
+  T* begin() { return data_; }
+  T* end() { return data_ + size_; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+
+ private:
+  T* data_;  // owned unless arena_ is set
+  size_t size_;
+  size_t capacity_;
+  Arena* arena_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(ArenaVector);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_ARENA_H_
@@ -0,0 +1,171 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/arena.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(Arena, Allocate) {
+  Arena arena;
+  EXPECT_EQ(0u, arena.block_count());
+  EXPECT_EQ(0u, arena.bytes_used());
+
+  const size_t kAlignments[] = {1, 2, 4, 8, 16, 64, 4096};
+  std::vector<uint8_t*> allocations;
+  for (size_t alignment : kAlignments) {
+    SCOPED_TRACE(alignment);
+    uint8_t* allocation =
+        static_cast<uint8_t*>(arena.Allocate(alignment * 3, alignment));
+    ASSERT_TRUE(allocation);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(allocation) % alignment);
+    memset(allocation, static_cast<int>(alignment), alignment * 3);
+    allocations.push_back(allocation);
+  }
+
+  // Allocations must not overlap.
+  for (size_t index = 0; index < allocations.size(); ++index) {
+    uint8_t expected = static_cast<uint8_t>(kAlignments[index]);
+    for (size_t offset = 0; offset < kAlignments[index] * 3; ++offset) {
+      ASSERT_EQ(expected, allocations[index][offset]);
+    }
+  }
+
+  EXPECT_GE(arena.bytes_used(), 7u * 3);
+}
+
+TEST(Arena, BlockCount) {
+  Arena arena;
+
+  // Many small allocations need few blocks.
+  for (size_t index = 0; index < 100000; ++index) {
+    arena.Allocate(sizeof(void*), sizeof(void*));
+  }
+  EXPECT_LE(arena.block_count(), 8u);
+
+  // A large allocation is satisfied by a single block of its own.
+  size_t block_count = arena.block_count();
+  uint8_t* large = static_cast<uint8_t*>(arena.Allocate(4 * 1024 * 1024, 16));
+  ASSERT_TRUE(large);
+  memset(large, 0, 4 * 1024 * 1024);
+  EXPECT_EQ(block_count + 1, arena.block_count());
+}
+
+TEST(Arena, Reserve) {
+  Arena arena;
+  arena.Reserve(1024 * 1024);
+  EXPECT_EQ(1u, arena.block_count());
+
+  for (size_t index = 0; index < 1000; ++index) {
+    arena.Allocate(1000, 1);
+  }
+  EXPECT_EQ(1u, arena.block_count());
+
+  // Reserving what is already available does nothing.
+  arena.Reserve(1);
+  EXPECT_EQ(1u, arena.block_count());
+}
+
+class Tracked {
+ public:
+  Tracked() : destroyed_(NULL), index_(0) {}
+  ~Tracked() {
+    if (destroyed_) {
+      destroyed_->push_back(index_);
+    }
+  }
+
+  void Track(std::vector<int>* destroyed, int index) {
+    destroyed_ = destroyed;
+    index_ = index;
+  }
+
+ private:
+  std::vector<int>* destroyed_;  // weak
+  int index_;
+
+  DISALLOW_COPY_AND_ASSIGN(Tracked);
+};
+
+TEST(Arena, New) {
+  std::vector<int> destroyed;
+  {
+    Arena arena;
+    for (int index = 0; index < 3; ++index) {
+      Tracked* tracked = arena.New<Tracked>();
+      EXPECT_EQ(0u,
+                reinterpret_cast<uintptr_t>(tracked) % __alignof__(Tracked));
+      tracked->Track(&destroyed, index);
+    }
+    EXPECT_TRUE(destroyed.empty());
+  }
+
+  // Objects are destroyed in the reverse order of their creation.
+  ASSERT_EQ(3u, destroyed.size());
+  EXPECT_EQ(2, destroyed[0]);
+  EXPECT_EQ(1, destroyed[1]);
+  EXPECT_EQ(0, destroyed[2]);
+}
+
+TEST(ArenaVector, Heap) {
+  ArenaVector<int> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.begin(), vector.end());
+
+  for (int index = 0; index < 100; ++index) {
+    vector.push_back(index);
+  }
+  ASSERT_EQ(100u, vector.size());
+  EXPECT_GE(vector.capacity(), 100u);
+
+  int expected = 0;
+  for (int value : vector) {
+    EXPECT_EQ(expected++, value);
+  }
+
+  vector.clear();
+  EXPECT_TRUE(vector.empty());
+  EXPECT_GE(vector.capacity(), 100u);
+}
+
+TEST(ArenaVector, Arena) {
+  Arena arena;
+  arena.Reserve(64 * 1024);
+
+  ArenaVector<int> vector;
+  vector.set_arena(&arena);
+  vector.reserve(10);
+  EXPECT_EQ(10u, vector.capacity());
+  EXPECT_GE(arena.bytes_used(), 10 * sizeof(int));
+
+  for (int index = 0; index < 1000; ++index) {
+    vector.push_back(index);
+  }
+  ASSERT_EQ(1000u, vector.size());
+  for (int index = 0; index < 1000; ++index) {
+    EXPECT_EQ(index, vector[index]);
+  }
+  EXPECT_EQ(1u, arena.block_count());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,142 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/buffer_remote_memory.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "util/stdlib/strnlen.h"
+
+namespace crashpad {
+
+BufferRemoteMemory::BufferRemoteMemory()
+    : data_(NULL), size_(0), base_address_(0), initialized_() {
+}
+
+BufferRemoteMemory::~BufferRemoteMemory() {
+}
+
+void BufferRemoteMemory::Initialize(const void* data,
+                                    size_t size,
+                                    uint64_t base_address) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  DCHECK(data || size == 0);
+
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = size;
+  base_address_ = base_address;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+}
+
+const void* BufferRemoteMemory::PointerTo(uint64_t address,
+                                          size_t size) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK_GT(size, 0u);
+
+  if (!Contains(address, size)) {
+    return NULL;
+  }
+  return data_ + (address - base_address_);
+}
+
+bool BufferRemoteMemory::Read(uint64_t address, size_t size, void* buffer) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (!Contains(address, size)) {
+    return false;
+  }
+
+  if (size > 0) {
+    memcpy(buffer, data_ + (address - base_address_), size);
+  }
+  return true;
+}
+
+scoped_ptr<RemoteMemory::MappedMemory> BufferRemoteMemory::ReadMapped(
+    uint64_t address,
+    size_t size) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (!Contains(address, size)) {
+    return scoped_ptr<MappedMemory>();
+  }
+
+  return scoped_ptr<MappedMemory>(
+      new MappedMemory(data_ + (address - base_address_), size));
+}
+
+bool BufferRemoteMemory::ReadCString(uint64_t address, std::string* string) {
+  return ReadCStringInternal(address, false, 0, string);
+}
+
+bool BufferRemoteMemory::ReadCStringSizeLimited(uint64_t address,
+                                                uint64_t size,
+                                                std::string* string) {
+  return ReadCStringInternal(address, true, size, string);
+}
+
+bool BufferRemoteMemory::ReadCStringInternal(uint64_t address,
+                                             bool has_size,
+                                             uint64_t size,
+                                             std::string* string) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (has_size && size == 0) {
+    string->clear();
+    return true;
+  }
+
+  if (!Contains(address, 1)) {
+    return false;
+  }
+
+  // Search no further than the end of the buffer, or than |size| if given.
+  const size_t offset = address - base_address_;
+  const size_t limit =
+      has_size ? static_cast<size_t>(std::min<uint64_t>(size, size_ - offset))
+               : size_ - offset;
+  const char* start = reinterpret_cast<const char*>(data_ + offset);
+  const size_t length = strnlen(start, limit);
+  if (length == limit) {
+    LOG(WARNING) << base::StringPrintf(
+        "unterminated string at 0x%llx",
+        static_cast<unsigned long long>(address));
+    return false;
+  }
+
+  string->assign(start, length);
+  return true;
+}
+
+bool BufferRemoteMemory::Contains(uint64_t address, size_t size) const {
+  if (address < base_address_ || address - base_address_ > size_ ||
+      size > size_ - (address - base_address_)) {
+    LOG(WARNING) << base::StringPrintf(
+        "read at 0x%llx size 0x%zx outside of buffer at 0x%llx size 0x%zx",
+        static_cast<unsigned long long>(address),
+        size,
+        static_cast<unsigned long long>(base_address_),
+        size_);
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,106 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_BUFFER_REMOTE_MEMORY_H_
+#define CRASHPAD_UTIL_MISC_BUFFER_REMOTE_MEMORY_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/misc/remote_memory.h"
+
+namespace crashpad {
+
+//! \brief A RemoteMemory that reads from a buffer in the current process.
+//!
+//! The buffer stands in for the address space of another process: the first
+//! byte of the buffer appears at a chosen base address, and reads outside of
+//! the buffer fail. This allows code written against RemoteMemory, such as
+//! parsers for structures found in other processes, to operate on data loaded
+//! from a file or constructed by a test.
+//!
+//! \sa FileRemoteMemory
+class BufferRemoteMemory final : public RemoteMemory {
+ public:
+  BufferRemoteMemory();
+  virtual ~BufferRemoteMemory();
+
+  //! \brief Initializes this object to read from a buffer.
+  //!
+  //! \param[in] data The buffer to read from. This object does not take
+  //!     ownership of the buffer, which must remain valid for the lifetime of
+  //!     this object. This may be `NULL` if \a size is `0`.
+  //! \param[in] size The size of \a data, in bytes.
+  //! \param[in] base_address The address at which \a data appears.
+  void Initialize(const void* data, size_t size, uint64_t base_address);
+
+  //! \brief Returns a pointer to memory in the buffer, without copying it.
+  //!
+  //! \param[in] address The address of the memory region.
+  //! \param[in] size The size of the memory region, in bytes. This must not be
+  //!     `0`.
+  //!
+  //! \return A pointer to the memory at \a address, valid for as long as the
+  //!     buffer is. `NULL` if the region is not entirely contained within the
+  //!     buffer, with a warning logged.
+  const void* PointerTo(uint64_t address, size_t size) const;
+
+  //! \brief Returns the address at which the buffer appears.
+  uint64_t base_address() const { return base_address_; }
+
+  //! \brief Returns the size of the buffer, in bytes.
+  size_t size() const { return size_; }
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override;
+
+  //! \copydoc RemoteMemory::ReadMapped()
+  //!
+  //! The returned object refers to the memory in place, without copying it.
+  virtual scoped_ptr<MappedMemory> ReadMapped(uint64_t address,
+                                              size_t size) override;
+
+  virtual bool ReadCString(uint64_t address, std::string* string) override;
+  virtual bool ReadCStringSizeLimited(uint64_t address,
+                                      uint64_t size,
+                                      std::string* string) override;
+
+ private:
+  // The common internal implementation shared by the ReadCString*() methods.
+  // Searches for the terminator within the buffer, without copying.
+  bool ReadCStringInternal(uint64_t address,
+                           bool has_size,
+                           uint64_t size,
+                           std::string* string);
+
+  // Returns true if the region at |address| of |size| bytes lies entirely
+  // within the buffer. Otherwise, logs a warning and returns false.
+  bool Contains(uint64_t address, size_t size) const;
+
+  const uint8_t* data_;  // weak
+  size_t size_;
+  uint64_t base_address_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferRemoteMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_BUFFER_REMOTE_MEMORY_H_
@@ -0,0 +1,106 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/stringprintf.h"
+#include "util/misc/buffer_remote_memory.h"
+#include "util/misc/remote_memory.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kBaseAddress = 0x100000000;
+
+// Forwards only Read() to another RemoteMemory, so that the default
+// RemoteMemory implementations of the other methods are used.
+class ReadOnlyRemoteMemory final : public RemoteMemory {
+ public:
+  explicit ReadOnlyRemoteMemory(RemoteMemory* memory)
+      : RemoteMemory(), memory_(memory) {}
+  virtual ~ReadOnlyRemoteMemory() {}
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override {
+    return memory_->Read(address, size, buffer);
+  }
+
+ private:
+  RemoteMemory* memory_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(ReadOnlyRemoteMemory);
+};
+
+// Reads every string in a string table of range(0) symbol names, the way a
+// symbol table reader does. If range(1) is 0, the strings are read with the
+// default page-at-a-time RemoteMemory implementation. Otherwise, they are read
+// in place by BufferRemoteMemory.
+void BM_BufferRemoteMemoryStringTable(BenchmarkState* state) {
+  const size_t string_count = state->range(0);
+  const bool direct = state->range(1) != 0;
+
+  std::string string_table;
+  for (size_t index = 0; index < string_count; ++index) {
+    base::StringAppendF(
+        &string_table, "__ZN8crashpad4test12_GLOBAL__N_1%zu", index);
+    string_table.push_back('\0');
+  }
+
+  const size_t string_table_size = string_table.size();
+
+  // The default implementation reads whole pages, so the buffer must extend to
+  // a page boundary for it to succeed.
+  const size_t page_size = getpagesize();
+  string_table.resize((string_table_size + page_size - 1) / page_size *
+                      page_size);
+
+  BufferRemoteMemory buffer_memory;
+  buffer_memory.Initialize(
+      string_table.data(), string_table.size(), kBaseAddress);
+  ReadOnlyRemoteMemory read_only_memory(&buffer_memory);
+  RemoteMemory* memory =
+      direct ? static_cast<RemoteMemory*>(&buffer_memory) : &read_only_memory;
+
+  std::string string;
+  while (state->KeepRunning()) {
+    size_t offset = 0;
+    while (offset < string_table_size) {
+      if (!memory->ReadCString(kBaseAddress + offset, &string)) {
+        state->SkipWithError("ReadCString failed");
+        return;
+      }
+      offset += string.size() + 1;
+    }
+    DoNotOptimize(string);
+  }
+
+  state->SetLabel(direct ? "direct" : "paged");
+  state->SetItemsProcessed(state->iterations() * string_count);
+  state->SetBytesProcessed(state->iterations() * string_table_size);
+}
+CRASHPAD_BENCHMARK(BM_BufferRemoteMemoryStringTable)
+    ->Args(1024, 0)
+    ->Args(1024, 1)
+    ->Args(65536, 0)
+    ->Args(65536, 1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,170 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/buffer_remote_memory.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kBaseAddress = 0x7fff5fc00000;
+
+TEST(BufferRemoteMemory, Read) {
+  const char kData[] = "The quick brown fox\0jumps over the lazy dog";
+  BufferRemoteMemory memory;
+  memory.Initialize(kData, sizeof(kData), kBaseAddress);
+  EXPECT_EQ(kBaseAddress, memory.base_address());
+  EXPECT_EQ(sizeof(kData), memory.size());
+
+  char buffer[sizeof(kData)];
+  ASSERT_TRUE(memory.Read(kBaseAddress, sizeof(kData), buffer));
+  EXPECT_EQ(0, memcmp(kData, buffer, sizeof(kData)));
+
+  ASSERT_TRUE(memory.Read(kBaseAddress + 4, 5, buffer));
+  EXPECT_EQ("quick", std::string(buffer, 5));
+
+  EXPECT_TRUE(memory.Read(kBaseAddress + sizeof(kData), 0, buffer));
+
+  std::string string;
+  ASSERT_TRUE(memory.ReadCString(kBaseAddress + 4, &string));
+  EXPECT_EQ("quick brown fox", string);
+  ASSERT_TRUE(memory.ReadCString(kBaseAddress + 20, &string));
+  EXPECT_EQ("jumps over the lazy dog", string);
+
+  const void* pointer = memory.PointerTo(kBaseAddress + 10, 5);
+  ASSERT_TRUE(pointer);
+  EXPECT_EQ(kData + 10, pointer);
+}
+
+TEST(BufferRemoteMemory, OutOfRange) {
+  const char kData[] = "data";
+  BufferRemoteMemory memory;
+  memory.Initialize(kData, sizeof(kData), kBaseAddress);
+
+  char buffer[16];
+  EXPECT_FALSE(memory.Read(kBaseAddress - 1, 1, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress - 1, 2, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress, sizeof(kData) + 1, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress + sizeof(kData), 1, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress + sizeof(kData) + 1, 0, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress + 1, static_cast<size_t>(-1), buffer));
+  EXPECT_FALSE(memory.Read(static_cast<uint64_t>(-1), 2, buffer));
+  EXPECT_FALSE(memory.PointerTo(kBaseAddress + 2, sizeof(kData)));
+
+  // The string is not NUL-terminated within the limit.
+  std::string string;
+  EXPECT_FALSE(memory.ReadCStringSizeLimited(kBaseAddress, 4, &string));
+  ASSERT_TRUE(memory.ReadCStringSizeLimited(kBaseAddress, 5, &string));
+  EXPECT_EQ("data", string);
+
+  // The string is not NUL-terminated before the end of the buffer.
+  BufferRemoteMemory unterminated_memory;
+  unterminated_memory.Initialize(kData, strlen(kData), kBaseAddress);
+  EXPECT_FALSE(unterminated_memory.ReadCString(kBaseAddress, &string));
+  EXPECT_FALSE(
+      unterminated_memory.ReadCStringSizeLimited(kBaseAddress, 16, &string));
+}
+
+// Forwards only Read() to another RemoteMemory, so that the default
+// RemoteMemory implementations of the other methods are used.
+class ReadOnlyRemoteMemory final : public RemoteMemory {
+ public:
+  explicit ReadOnlyRemoteMemory(RemoteMemory* memory)
+      : RemoteMemory(), memory_(memory) {}
+  virtual ~ReadOnlyRemoteMemory() {}
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override {
+    return memory_->Read(address, size, buffer);
+  }
+
+ private:
+  RemoteMemory* memory_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(ReadOnlyRemoteMemory);
+};
+
+TEST(BufferRemoteMemory, ReadMapped) {
+  const char kData[] = "The quick brown fox\0jumps over the lazy dog";
+  BufferRemoteMemory memory;
+  memory.Initialize(kData, sizeof(kData), kBaseAddress);
+
+  // The buffer is mapped in place.
+  scoped_ptr<RemoteMemory::MappedMemory> mapped =
+      memory.ReadMapped(kBaseAddress + 4, 40);
+  ASSERT_TRUE(mapped);
+  EXPECT_EQ(kData + 4, mapped->data());
+  EXPECT_EQ(40u, mapped->size());
+
+  std::string string;
+  ASSERT_TRUE(mapped->ReadCString(0, &string));
+  EXPECT_EQ("quick brown fox", string);
+  ASSERT_TRUE(mapped->ReadCString(16, &string));
+  EXPECT_EQ("jumps over the lazy dog", string);
+  EXPECT_FALSE(mapped->ReadCString(40, &string));
+
+  // The string isn’t terminated within the mapped region.
+  mapped = memory.ReadMapped(kBaseAddress + 4, 10);
+  ASSERT_TRUE(mapped);
+  EXPECT_FALSE(mapped->ReadCString(0, &string));
+
+  EXPECT_FALSE(memory.ReadMapped(kBaseAddress + 4, sizeof(kData)));
+
+  // The default implementation copies.
+  ReadOnlyRemoteMemory read_only_memory(&memory);
+  mapped = read_only_memory.ReadMapped(kBaseAddress + 4, 40);
+  ASSERT_TRUE(mapped);
+  EXPECT_NE(kData + 4, mapped->data());
+  EXPECT_EQ(0, memcmp(kData + 4, mapped->data(), 40));
+  ASSERT_TRUE(mapped->ReadCString(16, &string));
+  EXPECT_EQ("jumps over the lazy dog", string);
+
+  EXPECT_FALSE(read_only_memory.ReadMapped(kBaseAddress + 4, sizeof(kData)));
+}
+
+TEST(BufferRemoteMemory, ReadCStringSizeLimitedLarge) {
+  // Limits beyond the range of a 32-bit size_t aren’t truncated.
+  const char kData[] = "data";
+  BufferRemoteMemory memory;
+  memory.Initialize(kData, sizeof(kData), kBaseAddress);
+
+  std::string string;
+  ASSERT_TRUE(memory.ReadCStringSizeLimited(
+      kBaseAddress, UINT64_C(0x100000002), &string));
+  EXPECT_EQ("data", string);
+}
+
+TEST(BufferRemoteMemory, Empty) {
+  BufferRemoteMemory memory;
+  memory.Initialize(NULL, 0, kBaseAddress);
+  EXPECT_EQ(0u, memory.size());
+
+  char buffer[1];
+  EXPECT_TRUE(memory.Read(kBaseAddress, 0, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress, 1, buffer));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,305 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/cached_remote_memory.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+namespace {
+
+uint64_t PageAddress(uint64_t address) {
+  return address & ~static_cast<uint64_t>(CachedRemoteMemory::kPageSize - 1);
+}
+
+}  // namespace
+
+// static
+const size_t CachedRemoteMemory::kPageSize;
+
+CachedRemoteMemory::Statistics::Statistics()
+    : hits(0), misses(0), bytes_fetched(0), underlying_reads(0) {
+}
+
+CachedRemoteMemory::CachedRemoteMemory(RemoteMemory* memory,
+                                       size_t cache_pages)
+    : RemoteMemory(),
+      pages_(cache_pages),
+      clock_hand_(0),
+      index_(),
+      batch_(0),
+      page_addresses_(),
+      fetched_pages_(),
+      page_requests_(),
+      statistics_(),
+      memory_(memory) {
+  size_t index_size = 1;
+  while (index_size < 2 * cache_pages) {
+    index_size *= 2;
+  }
+  index_.resize(index_size);
+
+  // ReadBatch() stops collecting page addresses once there are more than fit
+  // in the cache.
+  page_addresses_.reserve(cache_pages + 1);
+  fetched_pages_.reserve(cache_pages);
+  page_requests_.reserve(cache_pages);
+
+  Flush();
+}
+
+CachedRemoteMemory::~CachedRemoteMemory() {
+}
+
+void CachedRemoteMemory::Flush() {
+  for (Page& page : pages_) {
+    page.address = 0;
+    page.batch = 0;
+    page.valid = false;
+    page.referenced = false;
+  }
+  std::fill(index_.begin(), index_.end(), 0);
+  clock_hand_ = 0;
+}
+
+bool CachedRemoteMemory::Read(uint64_t address, size_t size, void* buffer) {
+  ReadRequest request;
+  request.address = address;
+  request.size = size;
+  request.buffer = buffer;
+  return ReadBatch(&request, 1);
+}
+
+bool CachedRemoteMemory::ReadBatch(const ReadRequest* requests, size_t count) {
+  const size_t cache_pages = pages_.size();
+
+  // Determine the set of pages that the requests span. Requests often share
+  // pages, so duplicates are only removed once there appear to be too many.
+  page_addresses_.clear();
+  bool too_many_pages = false;
+  for (size_t index = 0; index < count && !too_many_pages; ++index) {
+    const ReadRequest& request = requests[index];
+    if (request.size == 0) {
+      continue;
+    }
+
+    const uint64_t last_address = request.address + request.size - 1;
+    if (last_address < request.address) {
+      LOG(WARNING) << "address overflow";
+      return false;
+    }
+
+    for (uint64_t page_address = PageAddress(request.address);
+         page_address <= PageAddress(last_address);
+         page_address += kPageSize) {
+      page_addresses_.push_back(page_address);
+      if (page_addresses_.size() > cache_pages) {
+        std::sort(page_addresses_.begin(), page_addresses_.end());
+        page_addresses_.erase(
+            std::unique(page_addresses_.begin(), page_addresses_.end()),
+            page_addresses_.end());
+        if (page_addresses_.size() > cache_pages) {
+          too_many_pages = true;
+          break;
+        }
+      }
+      if (page_address == PageAddress(last_address)) {
+        // Avoid wrapping around when the last page is at the top of the
+        // address space.
+        break;
+      }
+    }
+  }
+
+  if (too_many_pages) {
+    return ReadUncached(requests, count);
+  }
+
+  std::sort(page_addresses_.begin(), page_addresses_.end());
+  page_addresses_.erase(
+      std::unique(page_addresses_.begin(), page_addresses_.end()),
+      page_addresses_.end());
+
+  // Mark the cached pages that these requests need, so that they aren’t
+  // replaced by the missing ones, and keep only the missing pages’ addresses.
+  ++batch_;
+  size_t missing_count = 0;
+  for (uint64_t page_address : page_addresses_) {
+    size_t page_index = FindPage(page_address);
+    if (page_index == cache_pages) {
+      page_addresses_[missing_count++] = page_address;
+    } else {
+      Page& page = pages_[page_index];
+      page.batch = batch_;
+      page.referenced = true;
+      ++statistics_.hits;
+    }
+  }
+  page_addresses_.resize(missing_count);
+
+  if (!page_addresses_.empty()) {
+    fetched_pages_.clear();
+    page_requests_.clear();
+    for (uint64_t page_address : page_addresses_) {
+      size_t page_index = ReplacePage();
+      Page& page = pages_[page_index];
+      page.address = page_address;
+      page.batch = batch_;
+      fetched_pages_.push_back(page_index);
+
+      ReadRequest page_request;
+      page_request.address = page_address;
+      page_request.size = kPageSize;
+      page_request.buffer = page.data;
+      page_requests_.push_back(page_request);
+    }
+
+    statistics_.misses += page_addresses_.size();
+    statistics_.bytes_fetched += page_addresses_.size() * kPageSize;
+    ++statistics_.underlying_reads;
+    if (!memory_->ReadBatch(&page_requests_[0], page_requests_.size())) {
+      // The pages extend beyond the requested regions, possibly into memory
+      // that can’t be read, such as past the end of a buffer. Read exactly
+      // what was requested instead. The replaced pages are left invalid.
+      return ReadUncached(requests, count);
+    }
+
+    for (size_t page_index : fetched_pages_) {
+      pages_[page_index].valid = true;
+      IndexInsert(page_index);
+    }
+  }
+
+  for (size_t index = 0; index < count; ++index) {
+    CopyFromCache(
+        requests[index].address, requests[index].size, requests[index].buffer);
+  }
+
+  return true;
+}
+
+bool CachedRemoteMemory::ReadUncached(const ReadRequest* requests,
+                                      size_t count) {
+  for (size_t index = 0; index < count; ++index) {
+    statistics_.bytes_fetched += requests[index].size;
+  }
+  ++statistics_.underlying_reads;
+  return memory_->ReadBatch(requests, count);
+}
+
+void CachedRemoteMemory::CopyFromCache(uint64_t address,
+                                       size_t size,
+                                       void* buffer) {
+  uint8_t* buffer_c = reinterpret_cast<uint8_t*>(buffer);
+  while (size > 0) {
+    const uint64_t page_address = PageAddress(address);
+    size_t page_index = FindPage(page_address);
+    DCHECK_LT(page_index, pages_.size());
+
+    const size_t page_offset = address - page_address;
+    const size_t copy_size = std::min(size, kPageSize - page_offset);
+    memcpy(buffer_c, pages_[page_index].data + page_offset, copy_size);
+
+    size -= copy_size;
+    address += copy_size;
+    buffer_c += copy_size;
+  }
+}
+
+size_t CachedRemoteMemory::FindPage(uint64_t page_address) const {
+  const size_t mask = index_.size() - 1;
+  for (size_t slot = IndexHome(page_address);; slot = (slot + 1) & mask) {
+    uint32_t entry = index_[slot];
+    if (!entry) {
+      return pages_.size();
+    }
+    if (pages_[entry - 1].address == page_address) {
+      return entry - 1;
+    }
+  }
+}
+
+size_t CachedRemoteMemory::ReplacePage() {
+  // There is always a page that the ReadBatch() call in progress doesn’t need,
+  // because it never needs more pages than the cache holds. Each page passed
+  // over has its referenced bit cleared, so this takes at most two turns.
+  while (true) {
+    size_t page_index = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % pages_.size();
+
+    Page& page = pages_[page_index];
+    if (page.batch == batch_) {
+      continue;
+    }
+    if (page.valid && page.referenced) {
+      page.referenced = false;
+      continue;
+    }
+
+    if (page.valid) {
+      IndexErase(page.address);
+      page.valid = false;
+    }
+    page.referenced = false;
+    return page_index;
+  }
+}
+
+size_t CachedRemoteMemory::IndexHome(uint64_t page_address) const {
+  // Fibonacci hashing spreads consecutive page numbers across the table. The
+  // high bits of the product are the well-mixed ones.
+  const uint64_t hash =
+      (page_address / kPageSize) * UINT64_C(0x9e3779b97f4a7c15);
+  return static_cast<size_t>(hash >> 32) & (index_.size() - 1);
+}
+
+void CachedRemoteMemory::IndexInsert(size_t page_index) {
+  const size_t mask = index_.size() - 1;
+  size_t slot = IndexHome(pages_[page_index].address);
+  while (index_[slot]) {
+    slot = (slot + 1) & mask;
+  }
+  index_[slot] = page_index + 1;
+}
+
+void CachedRemoteMemory::IndexErase(uint64_t page_address) {
+  const size_t mask = index_.size() - 1;
+  size_t slot = IndexHome(page_address);
+  while (pages_[index_[slot] - 1].address != page_address) {
+    slot = (slot + 1) & mask;
+  }
+
+  // Shift later entries of the same probe sequence back into the hole, so that
+  // lookups don’t stop early at an empty entry.
+  index_[slot] = 0;
+  for (size_t next = (slot + 1) & mask; index_[next];
+       next = (next + 1) & mask) {
+    size_t home = IndexHome(pages_[index_[next] - 1].address);
+    bool movable = slot <= next ? (home <= slot || home > next)
+                                : (home <= slot && home > next);
+    if (movable) {
+      index_[slot] = index_[next];
+      index_[next] = 0;
+      slot = next;
+    }
+  }
+}
+
+}  // namespace crashpad
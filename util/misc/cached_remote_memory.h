@@ -0,0 +1,167 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_CACHED_REMOTE_MEMORY_H_
+#define CRASHPAD_UTIL_MISC_CACHED_REMOTE_MEMORY_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "util/misc/remote_memory.h"
+
+namespace crashpad {
+
+//! \brief A RemoteMemory implementation that caches the memory read through
+//!     another RemoteMemory object.
+//!
+//! Memory is fetched and cached in fixed-size pages of kPageSize bytes. When a
+//! read requires pages that are not present in the cache, all of the missing
+//! pages are fetched with a single RemoteMemory::ReadBatch() call on the
+//! underlying object, which allows adjacent and nearby reads to be serviced by
+//! a single system call. If the missing pages can’t all be fetched, as near
+//! the end of a BufferRemoteMemory, the requested regions themselves are read
+//! instead, without being cached.
+//!
+//! Pages are held in a ring of slots that is allocated when the object is
+//! constructed, so that reading does not allocate memory. When the cache is
+//! full, a page is chosen for replacement by the clock algorithm, which
+//! approximates evicting the least-recently used page.
+//!
+//! This is most beneficial to code that makes many small reads from the same
+//! region, such as a reader walking an image’s load commands, symbol table,
+//! and string table.
+//!
+//! Cached memory is not invalidated when the target process modifies it.
+//! Callers that need to observe changes should call Flush().
+class CachedRemoteMemory final : public RemoteMemory {
+ public:
+  //! \brief Counters describing the effectiveness of the cache.
+  struct Statistics {
+    Statistics();
+
+    //! \brief The number of page lookups that were satisfied by the cache.
+    uint64_t hits;
+
+    //! \brief The number of page lookups that required fetching the page.
+    uint64_t misses;
+
+    //! \brief The number of bytes read from the underlying RemoteMemory
+    //!     object.
+    uint64_t bytes_fetched;
+
+    //! \brief The number of calls made to the underlying RemoteMemory object.
+    //!
+    //! For implementations that service each RemoteMemory::ReadBatch() with a
+    //! single system call, this approximates the number of system calls made.
+    uint64_t underlying_reads;
+  };
+
+  //! \brief The size of a cached page, and the granularity at which memory is
+  //!     fetched.
+  //!
+  //! This is no larger than the page size of any supported system, so that
+  //! fetching an entire page to satisfy a read never touches memory outside of
+  //! the mapping that contains the requested region.
+  static const size_t kPageSize = 4096;
+
+  //! \param[in] memory The object to read memory through. This object does
+  //!     not take ownership of \a memory, which must outlive this object.
+  //! \param[in] cache_pages The maximum number of pages to retain in the
+  //!     cache. Storage for all of them is allocated immediately. Reads that
+  //!     span more pages than this are passed directly to \a memory without
+  //!     being cached.
+  CachedRemoteMemory(RemoteMemory* memory, size_t cache_pages);
+  virtual ~CachedRemoteMemory();
+
+  //! \brief Discards all cached pages.
+  void Flush();
+
+  //! \brief Returns counters describing the reads made so far.
+  const Statistics& statistics() const { return statistics_; }
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override;
+  virtual bool ReadBatch(const ReadRequest* requests, size_t count) override;
+
+ private:
+  struct Page {
+    // The address of the page in the target process. Meaningful only if valid
+    // is true.
+    uint64_t address;
+
+    // The value of batch_ when the page was last needed by a ReadBatch() call.
+    // A page needed by the call in progress is never replaced.
+    uint64_t batch;
+
+    // Whether data holds the contents of the page at address.
+    bool valid;
+
+    // Whether the page has been used since the clock hand last passed it.
+    bool referenced;
+
+    uint8_t data[kPageSize];
+  };
+
+  // Passes |requests| through to |memory_| without caching, updating
+  // statistics_ accordingly.
+  bool ReadUncached(const ReadRequest* requests, size_t count);
+
+  // Copies |size| bytes at |address| out of the cache into |buffer|. All of the
+  // pages spanned by the region must be present in the cache.
+  void CopyFromCache(uint64_t address, size_t size, void* buffer);
+
+  // Returns the index into pages_ of the valid page at |page_address|, or
+  // pages_.size() if that page is not cached.
+  size_t FindPage(uint64_t page_address) const;
+
+  // Chooses a page that isn’t needed by the ReadBatch() call in progress to be
+  // replaced, removes it from the index, and returns its index into pages_.
+  size_t ReplacePage();
+
+  // Maintain index_, which maps page addresses to indices into pages_.
+  size_t IndexHome(uint64_t page_address) const;
+  void IndexInsert(size_t page_index);
+  void IndexErase(uint64_t page_address);
+
+  // The ring of cached pages, and the clock hand that selects the next one to
+  // consider replacing.
+  std::vector<Page> pages_;
+  size_t clock_hand_;
+
+  // An open-addressed hash table with linear probing. Each entry is one more
+  // than an index into pages_, or 0 if it’s empty. Its size is a power of two
+  // at least twice the number of pages, so that it always has empty entries.
+  std::vector<uint32_t> index_;
+
+  // Counts ReadBatch() calls, to mark the pages needed by the one in progress.
+  uint64_t batch_;
+
+  // Scratch space for ReadBatch(), retained to avoid allocating on every call.
+  std::vector<uint64_t> page_addresses_;
+  std::vector<size_t> fetched_pages_;
+  std::vector<ReadRequest> page_requests_;
+
+  Statistics statistics_;
+  RemoteMemory* memory_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(CachedRemoteMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_CACHED_REMOTE_MEMORY_H_
@@ -0,0 +1,152 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "util/misc/cached_remote_memory.h"
+#include "util/misc/remote_memory.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kImageAddress = 0x100000000;
+const size_t kImageSize = 128 * 1024;
+const size_t kSymbolTableOffset = 16 * 1024;
+const size_t kSymbolCount = 2048;
+const size_t kSymbolSize = 16;
+const size_t kStringTableOffset =
+    kSymbolTableOffset + kSymbolCount * kSymbolSize;
+const size_t kStringSize = 24;
+
+// A RemoteMemory backed by a buffer in the current process. Each Read() or
+// ReadBatch() is counted as a single system call, as it would be for an
+// implementation built on process_vm_readv().
+class BufferRemoteMemory final : public RemoteMemory {
+ public:
+  BufferRemoteMemory() : image_(kImageSize, '\0'), calls_(0) {
+    // Fill the string table with NUL-terminated strings.
+    for (size_t offset = kStringTableOffset;
+         offset + kStringSize <= kImageSize;
+         offset += kStringSize) {
+      memset(&image_[offset], 's', kStringSize - 1);
+    }
+  }
+
+  virtual ~BufferRemoteMemory() {}
+
+  uint64_t calls() const { return calls_; }
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override {
+    ++calls_;
+    return Copy(address, size, buffer);
+  }
+
+  virtual bool ReadBatch(const ReadRequest* requests,
+                         size_t count) override {
+    ++calls_;
+    for (size_t index = 0; index < count; ++index) {
+      if (!Copy(requests[index].address,
+                requests[index].size,
+                requests[index].buffer)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  bool Copy(uint64_t address, size_t size, void* buffer) {
+    if (address < kImageAddress || address - kImageAddress > kImageSize ||
+        size > kImageSize - (address - kImageAddress)) {
+      return false;
+    }
+    memcpy(buffer, &image_[address - kImageAddress], size);
+    return true;
+  }
+
+  std::string image_;
+  uint64_t calls_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferRemoteMemory);
+};
+
+// Reads an image the way a Mach-O image reader does: a header, a series of
+// small load commands, every entry of a symbol table, and the strings that
+// the symbols name. The reads are made through a CachedRemoteMemory with a
+// cold cache if range(0) is nonzero, and directly otherwise.
+void BM_RemoteMemoryImageWalk(BenchmarkState* state) {
+  const bool cached = state->range(0) != 0;
+
+  BufferRemoteMemory buffer_memory;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  char data[64];
+  std::string string;
+  while (state->KeepRunning()) {
+    scoped_ptr<CachedRemoteMemory> cached_memory;
+    RemoteMemory* memory = &buffer_memory;
+    if (cached) {
+      cached_memory.reset(new CachedRemoteMemory(&buffer_memory, 64));
+      memory = cached_memory.get();
+    }
+
+    bool rv = memory->Read(kImageAddress, 32, data);
+    for (size_t offset = 32; rv && offset < kSymbolTableOffset; offset += 56) {
+      rv = memory->Read(kImageAddress + offset, 8, data) &&
+           memory->Read(kImageAddress + offset, 56, data);
+    }
+    for (size_t index = 0; rv && index < kSymbolCount; ++index) {
+      rv = memory->Read(
+          kImageAddress + kSymbolTableOffset + index * kSymbolSize,
+          kSymbolSize,
+          data);
+      if (rv && index % 4 == 0) {
+        rv = memory->ReadCString(
+            kImageAddress + kStringTableOffset + (index / 4) * kStringSize,
+            &string);
+      }
+    }
+    if (!rv) {
+      state->SkipWithError("Read failed");
+      return;
+    }
+
+    if (cached_memory) {
+      hits = cached_memory->statistics().hits;
+      misses = cached_memory->statistics().misses;
+    }
+  }
+
+  state->SetCounter("underlying_calls_per_iteration",
+                    static_cast<double>(buffer_memory.calls()) /
+                        state->iterations());
+  if (cached) {
+    state->SetCounter("cache_hits", hits);
+    state->SetCounter("cache_misses", misses);
+  }
+}
+CRASHPAD_BENCHMARK(BM_RemoteMemoryImageWalk)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
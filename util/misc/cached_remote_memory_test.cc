@@ -0,0 +1,257 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/cached_remote_memory.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// A RemoteMemory implementation backed by a string at a fictitious base
+// address, which counts the calls made to it. Any page in the range
+// [unreadable_start, unreadable_end) is treated as unreadable.
+class TestRemoteMemory final : public RemoteMemory {
+ public:
+  TestRemoteMemory(uint64_t base_address, size_t size)
+      : RemoteMemory(),
+        contents_(size, '\0'),
+        base_address_(base_address),
+        unreadable_start_(0),
+        unreadable_end_(0),
+        read_batch_calls_(0),
+        regions_read_(0) {
+    for (size_t index = 0; index < size; ++index) {
+      contents_[index] = static_cast<char>((index % 251) + 1);
+    }
+  }
+
+  virtual ~TestRemoteMemory() {}
+
+  void SetUnreadable(uint64_t start, uint64_t end) {
+    unreadable_start_ = start;
+    unreadable_end_ = end;
+  }
+
+  const char* Contents(uint64_t address) const {
+    return &contents_[address - base_address_];
+  }
+
+  int read_batch_calls() const { return read_batch_calls_; }
+  int regions_read() const { return regions_read_; }
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override {
+    ++regions_read_;
+    if (address < base_address_ ||
+        address + size > base_address_ + contents_.size() ||
+        (address < unreadable_end_ && address + size > unreadable_start_)) {
+      return false;
+    }
+
+    memcpy(buffer, Contents(address), size);
+    return true;
+  }
+
+  virtual bool ReadBatch(const ReadRequest* requests,
+                         size_t count) override {
+    ++read_batch_calls_;
+    return RemoteMemory::ReadBatch(requests, count);
+  }
+
+ private:
+  std::string contents_;
+  uint64_t base_address_;
+  uint64_t unreadable_start_;
+  uint64_t unreadable_end_;
+  int read_batch_calls_;
+  int regions_read_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestRemoteMemory);
+};
+
+const uint64_t kBaseAddress = 0x10000;
+const size_t kPageSize = CachedRemoteMemory::kPageSize;
+
+TEST(CachedRemoteMemory, ReadHitsAndMisses) {
+  TestRemoteMemory memory(kBaseAddress, 8 * kPageSize);
+  CachedRemoteMemory cache(&memory, 4);
+
+  char buffer[64];
+  ASSERT_TRUE(cache.Read(kBaseAddress + 16, sizeof(buffer), buffer));
+  EXPECT_EQ(0, memcmp(memory.Contents(kBaseAddress + 16), buffer,
+                      sizeof(buffer)));
+  EXPECT_EQ(0u, cache.statistics().hits);
+  EXPECT_EQ(1u, cache.statistics().misses);
+  EXPECT_EQ(kPageSize, cache.statistics().bytes_fetched);
+  EXPECT_EQ(1u, cache.statistics().underlying_reads);
+  EXPECT_EQ(1, memory.read_batch_calls());
+
+  // Another read from the same page is satisfied by the cache.
+  ASSERT_TRUE(cache.Read(kBaseAddress + 100, sizeof(buffer), buffer));
+  EXPECT_EQ(0, memcmp(memory.Contents(kBaseAddress + 100), buffer,
+                      sizeof(buffer)));
+  EXPECT_EQ(1u, cache.statistics().hits);
+  EXPECT_EQ(1u, cache.statistics().misses);
+  EXPECT_EQ(1, memory.read_batch_calls());
+
+  // A read spanning into the next page fetches only that page.
+  ASSERT_TRUE(cache.Read(kBaseAddress + kPageSize - 8, 16, buffer));
+  EXPECT_EQ(0, memcmp(memory.Contents(kBaseAddress + kPageSize - 8), buffer,
+                      16));
+  EXPECT_EQ(2u, cache.statistics().hits);
+  EXPECT_EQ(2u, cache.statistics().misses);
+  EXPECT_EQ(2 * kPageSize, cache.statistics().bytes_fetched);
+  EXPECT_EQ(2, memory.read_batch_calls());
+
+  // Reads of length 0 don’t touch anything.
+  ASSERT_TRUE(cache.Read(kBaseAddress, 0, buffer));
+  EXPECT_EQ(2, memory.read_batch_calls());
+
+  // After flushing, the page must be fetched again.
+  cache.Flush();
+  ASSERT_TRUE(cache.Read(kBaseAddress + 100, sizeof(buffer), buffer));
+  EXPECT_EQ(3u, cache.statistics().misses);
+  EXPECT_EQ(3, memory.read_batch_calls());
+}
+
+TEST(CachedRemoteMemory, ReadBatchCoalesces) {
+  TestRemoteMemory memory(kBaseAddress, 8 * kPageSize);
+  CachedRemoteMemory cache(&memory, 8);
+
+  // Three requests spanning four pages, two of which are shared.
+  char buffers[3][32];
+  RemoteMemory::ReadRequest requests[3];
+  requests[0].address = kBaseAddress + 10;
+  requests[1].address = kBaseAddress + kPageSize + 20;
+  requests[2].address = kBaseAddress + 4 * kPageSize - 16;
+  for (size_t index = 0; index < arraysize(requests); ++index) {
+    requests[index].size = sizeof(buffers[index]);
+    requests[index].buffer = buffers[index];
+  }
+
+  ASSERT_TRUE(cache.ReadBatch(requests, arraysize(requests)));
+  for (size_t index = 0; index < arraysize(requests); ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(0, memcmp(memory.Contents(requests[index].address),
+                        buffers[index],
+                        sizeof(buffers[index])));
+  }
+
+  // All four pages were fetched with a single call to the underlying object.
+  EXPECT_EQ(1, memory.read_batch_calls());
+  EXPECT_EQ(4, memory.regions_read());
+  EXPECT_EQ(4u, cache.statistics().misses);
+  EXPECT_EQ(1u, cache.statistics().underlying_reads);
+
+  ASSERT_TRUE(cache.ReadBatch(requests, arraysize(requests)));
+  EXPECT_EQ(1, memory.read_batch_calls());
+  EXPECT_EQ(4u, cache.statistics().hits);
+}
+
+TEST(CachedRemoteMemory, Eviction) {
+  TestRemoteMemory memory(kBaseAddress, 8 * kPageSize);
+  CachedRemoteMemory cache(&memory, 2);
+
+  char c;
+  ASSERT_TRUE(cache.Read(kBaseAddress, 1, &c));
+  ASSERT_TRUE(cache.Read(kBaseAddress + kPageSize, 1, &c));
+  EXPECT_EQ(2, memory.read_batch_calls());
+
+  // Touch the first page so that the second is least-recently used.
+  ASSERT_TRUE(cache.Read(kBaseAddress, 1, &c));
+  EXPECT_EQ(2, memory.read_batch_calls());
+
+  // Reading a third page evicts the second.
+  ASSERT_TRUE(cache.Read(kBaseAddress + 2 * kPageSize, 1, &c));
+  EXPECT_EQ(3, memory.read_batch_calls());
+  ASSERT_TRUE(cache.Read(kBaseAddress, 1, &c));
+  EXPECT_EQ(3, memory.read_batch_calls());
+  ASSERT_TRUE(cache.Read(kBaseAddress + kPageSize, 1, &c));
+  EXPECT_EQ(4, memory.read_batch_calls());
+  EXPECT_EQ(*memory.Contents(kBaseAddress + kPageSize), c);
+}
+
+TEST(CachedRemoteMemory, LargeReadBypassesCache) {
+  TestRemoteMemory memory(kBaseAddress, 8 * kPageSize);
+  CachedRemoteMemory cache(&memory, 2);
+
+  std::vector<char> buffer(3 * kPageSize);
+  ASSERT_TRUE(cache.Read(kBaseAddress + 1, buffer.size(), &buffer[0]));
+  EXPECT_EQ(0, memcmp(memory.Contents(kBaseAddress + 1), &buffer[0],
+                      buffer.size()));
+  EXPECT_EQ(buffer.size(), cache.statistics().bytes_fetched);
+  EXPECT_EQ(0u, cache.statistics().misses);
+
+  // Nothing was cached.
+  char c;
+  ASSERT_TRUE(cache.Read(kBaseAddress + 1, 1, &c));
+  EXPECT_EQ(1u, cache.statistics().misses);
+}
+
+TEST(CachedRemoteMemory, Unreadable) {
+  TestRemoteMemory memory(kBaseAddress, 8 * kPageSize);
+  memory.SetUnreadable(kBaseAddress + kPageSize, kBaseAddress + 2 * kPageSize);
+  CachedRemoteMemory cache(&memory, 4);
+
+  char buffer[16];
+  EXPECT_FALSE(cache.Read(kBaseAddress + kPageSize, 1, buffer));
+  EXPECT_FALSE(cache.Read(kBaseAddress + kPageSize - 8, sizeof(buffer),
+                          buffer));
+  EXPECT_TRUE(cache.Read(kBaseAddress + kPageSize - 8, 8, buffer));
+  EXPECT_TRUE(cache.Read(kBaseAddress + 2 * kPageSize, sizeof(buffer),
+                         buffer));
+
+  // A string that runs into the unreadable page can’t be read.
+  std::string string;
+  EXPECT_FALSE(cache.ReadCString(kBaseAddress, &string));
+}
+
+TEST(CachedRemoteMemory, EndOfMemory) {
+  // The last page extends beyond the end of the underlying memory, so it can’t
+  // be fetched whole.
+  const size_t kSize = 2 * kPageSize + 100;
+  TestRemoteMemory memory(kBaseAddress, kSize);
+  CachedRemoteMemory cache(&memory, 4);
+
+  char buffer[16];
+  const uint64_t address = kBaseAddress + kSize - sizeof(buffer);
+  ASSERT_TRUE(cache.Read(address, sizeof(buffer), buffer));
+  EXPECT_EQ(0, memcmp(memory.Contents(address), buffer, sizeof(buffer)));
+
+  // The page fetch failed, so the requested region was read by itself.
+  EXPECT_EQ(2, memory.read_batch_calls());
+  EXPECT_EQ(2u, cache.statistics().underlying_reads);
+  EXPECT_EQ(kPageSize + sizeof(buffer), cache.statistics().bytes_fetched);
+
+  // Reading past the end still fails.
+  EXPECT_FALSE(cache.Read(address, sizeof(buffer) + 1, buffer));
+
+  // Other pages are still cached.
+  ASSERT_TRUE(cache.Read(kBaseAddress + kPageSize, sizeof(buffer), buffer));
+  ASSERT_TRUE(cache.Read(kBaseAddress + kPageSize + 32, sizeof(buffer),
+                         buffer));
+  EXPECT_EQ(1u, cache.statistics().hits);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,96 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/file_remote_memory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "base/files/scoped_file.h"
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+FileRemoteMemory::FileRemoteMemory()
+    : memory_(), mapping_(NULL), mapping_size_(0) {
+}
+
+FileRemoteMemory::~FileRemoteMemory() {
+  if (mapping_ && munmap(mapping_, mapping_size_) != 0) {
+    PLOG(ERROR) << "munmap";
+  }
+}
+
+bool FileRemoteMemory::Initialize(const base::FilePath& path,
+                                  uint64_t base_address) {
+  DCHECK(!mapping_);
+
+  base::ScopedFD fd(HANDLE_EINTR(open(path.value().c_str(), O_RDONLY)));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << "open " << path.value();
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    PLOG(ERROR) << "fstat " << path.value();
+    return false;
+  }
+
+  size_t size;
+  if (!AssignIfInRange(&size, st.st_size)) {
+    LOG(ERROR) << "file " << path.value() << " too large to map";
+    return false;
+  }
+
+  // mmap() rejects zero-length mappings, but an empty file is still a valid
+  // (if uninteresting) source.
+  if (size > 0) {
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (mapping == MAP_FAILED) {
+      PLOG(ERROR) << "mmap " << path.value();
+      return false;
+    }
+    mapping_ = mapping;
+    mapping_size_ = size;
+  }
+
+  memory_.Initialize(mapping_, mapping_size_, base_address);
+  return true;
+}
+
+bool FileRemoteMemory::Read(uint64_t address, size_t size, void* buffer) {
+  return memory_.Read(address, size, buffer);
+}
+
+scoped_ptr<RemoteMemory::MappedMemory> FileRemoteMemory::ReadMapped(
+    uint64_t address,
+    size_t size) {
+  return memory_.ReadMapped(address, size);
+}
+
+bool FileRemoteMemory::ReadCString(uint64_t address, std::string* string) {
+  return memory_.ReadCString(address, string);
+}
+
+bool FileRemoteMemory::ReadCStringSizeLimited(uint64_t address,
+                                              uint64_t size,
+                                              std::string* string) {
+  return memory_.ReadCStringSizeLimited(address, size, string);
+}
+
+}  // namespace crashpad
@@ -0,0 +1,86 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_FILE_REMOTE_MEMORY_H_
+#define CRASHPAD_UTIL_MISC_FILE_REMOTE_MEMORY_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "util/misc/buffer_remote_memory.h"
+#include "util/misc/remote_memory.h"
+
+namespace crashpad {
+
+//! \brief A RemoteMemory that reads from a file mapped into the current
+//!     process.
+//!
+//! The file’s contents stand in for the address space of another process, as
+//! with BufferRemoteMemory. This allows structures such as a Mach-O image to be
+//! read from disk with the same code that reads them from a running process,
+//! for offline analysis and for testing on systems other than the one that the
+//! code normally targets.
+class FileRemoteMemory final : public RemoteMemory {
+ public:
+  FileRemoteMemory();
+  virtual ~FileRemoteMemory();
+
+  //! \brief Initializes this object to read from a file.
+  //!
+  //! \param[in] path The path of the file to read. The file is mapped
+  //!     read-only. It should not be modified while this object exists.
+  //! \param[in] base_address The address at which the first byte of the file
+  //!     appears.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(const base::FilePath& path, uint64_t base_address);
+
+  //! \copydoc BufferRemoteMemory::PointerTo
+  const void* PointerTo(uint64_t address, size_t size) const {
+    return memory_.PointerTo(address, size);
+  }
+
+  //! \brief Returns the size of the file, in bytes.
+  size_t size() const { return memory_.size(); }
+
+  // RemoteMemory:
+
+  virtual bool Read(uint64_t address, size_t size, void* buffer) override;
+
+  //! \copydoc RemoteMemory::ReadMapped()
+  //!
+  //! The returned object refers to the memory in place, without copying it.
+  virtual scoped_ptr<MappedMemory> ReadMapped(uint64_t address,
+                                              size_t size) override;
+
+  virtual bool ReadCString(uint64_t address, std::string* string) override;
+  virtual bool ReadCStringSizeLimited(uint64_t address,
+                                      uint64_t size,
+                                      std::string* string) override;
+
+ private:
+  BufferRemoteMemory memory_;
+  void* mapping_;  // owned, unmapped on destruction
+  size_t mapping_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileRemoteMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_FILE_REMOTE_MEMORY_H_
@@ -0,0 +1,108 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/file_remote_memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "gtest/gtest.h"
+#include "util/file/fd_io.h"
+#include "util/test/errors.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kBaseAddress = 0x100000000;
+
+// Creates a temporary file with the given contents. The file is removed when
+// the object is destroyed.
+class ScopedTempFile {
+ public:
+  explicit ScopedTempFile(const std::string& contents) : path_() {
+    char path[] = "/tmp/file_remote_memory_test.XXXXXX";
+    base::ScopedFD fd(mkstemp(path));
+    EXPECT_TRUE(fd.is_valid()) << ErrnoMessage("mkstemp");
+    path_ = base::FilePath(path);
+    if (!contents.empty()) {
+      CheckedWriteFD(fd.get(), contents.data(), contents.size());
+    }
+  }
+
+  ~ScopedTempFile() {
+    EXPECT_EQ(0, unlink(path_.value().c_str())) << ErrnoMessage("unlink");
+  }
+
+  const base::FilePath& path() const { return path_; }
+
+ private:
+  base::FilePath path_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTempFile);
+};
+
+TEST(FileRemoteMemory, Read) {
+  std::string contents(3 * getpagesize(), 'x');
+  strcpy(&contents[contents.size() - 8], "string");
+  ScopedTempFile file(contents);
+
+  FileRemoteMemory memory;
+  ASSERT_TRUE(memory.Initialize(file.path(), kBaseAddress));
+  EXPECT_EQ(contents.size(), memory.size());
+
+  std::string buffer(contents.size(), '\0');
+  ASSERT_TRUE(memory.Read(kBaseAddress, buffer.size(), &buffer[0]));
+  EXPECT_EQ(contents, buffer);
+
+  std::string string;
+  ASSERT_TRUE(
+      memory.ReadCString(kBaseAddress + contents.size() - 8, &string));
+  EXPECT_EQ("string", string);
+
+  const char* pointer = static_cast<const char*>(
+      memory.PointerTo(kBaseAddress + contents.size() - 8, 6));
+  ASSERT_TRUE(pointer);
+  EXPECT_EQ("string", std::string(pointer, 6));
+
+  EXPECT_FALSE(memory.Read(kBaseAddress + contents.size(), 1, &buffer[0]));
+  EXPECT_FALSE(memory.Read(kBaseAddress - 1, 1, &buffer[0]));
+}
+
+TEST(FileRemoteMemory, Empty) {
+  ScopedTempFile file((std::string()));
+
+  FileRemoteMemory memory;
+  ASSERT_TRUE(memory.Initialize(file.path(), kBaseAddress));
+  EXPECT_EQ(0u, memory.size());
+
+  char buffer[1];
+  EXPECT_TRUE(memory.Read(kBaseAddress, 0, buffer));
+  EXPECT_FALSE(memory.Read(kBaseAddress, 1, buffer));
+}
+
+TEST(FileRemoteMemory, Nonexistent) {
+  FileRemoteMemory memory;
+  EXPECT_FALSE(memory.Initialize(
+      base::FilePath("/nonexistent/file_remote_memory_test"), kBaseAddress));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,53 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/log_context.h"
+
+namespace crashpad {
+
+LogContext::LogContext(const LogContext* parent) : parent_(parent) {
+}
+
+LogContext::~LogContext() {
+}
+
+void LogContext::AppendTo(std::string* string) const {
+  for (const LogContext* context = this; context; context = context->parent_) {
+    context->AppendOwnTo(string);
+  }
+}
+
+std::string LogContext::ToString() const {
+  std::string string;
+  AppendTo(&string);
+  return string;
+}
+
+std::ostream& operator<<(std::ostream& stream, const LogContext& context) {
+  return stream << context.ToString();
+}
+
+StringLogContext::StringLogContext(const std::string& string,
+                                   const LogContext* parent)
+    : LogContext(parent), string_(string) {
+}
+
+StringLogContext::~StringLogContext() {
+}
+
+void StringLogContext::AppendOwnTo(std::string* string) const {
+  string->append(string_);
+}
+
+}  // namespace crashpad
@@ -0,0 +1,94 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_LOG_CONTEXT_H_
+#define CRASHPAD_UTIL_MISC_LOG_CONTEXT_H_
+
+#include <ostream>
+#include <string>
+
+#include "base/basictypes.h"
+
+namespace crashpad {
+
+//! \brief Describes the object being worked on, for use in logged messages.
+//!
+//! Readers that walk large structures often attach context such as
+//! `", symbol index 12, module /usr/lib/libSystem.B.dylib"` to the warnings
+//! they log. Formatting that text for every element visited is expensive, and
+//! wasted unless something actually goes wrong. A LogContext defers the
+//! formatting until the context is streamed into a log message.
+//!
+//! Contexts form a chain: each one may refer to a parent describing an
+//! enclosing object, and the parent’s description follows its own. A context
+//! does not own its parent, which must outlive it. Subclasses typically carry
+//! a few scalar fields, such as a loop index, that are cheap to update on every
+//! iteration.
+class LogContext {
+ public:
+  virtual ~LogContext();
+
+  //! \brief Appends the description of this context, followed by those of its
+  //!     parents, to \a string.
+  void AppendTo(std::string* string) const;
+
+  //! \brief Returns the description of this context and its parents.
+  std::string ToString() const;
+
+ protected:
+  //! \param[in] parent The enclosing context, or `NULL` if there is none.
+  explicit LogContext(const LogContext* parent);
+
+  //! \brief Appends the description of this context alone to \a string.
+  //!
+  //! By convention, each description begins with `", "`, so that a chain of
+  //! them can be appended directly to a log message.
+  virtual void AppendOwnTo(std::string* string) const = 0;
+
+ private:
+  const LogContext* parent_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(LogContext);
+};
+
+//! \brief Writes the description of \a context and its parents to \a stream.
+std::ostream& operator<<(std::ostream& stream, const LogContext& context);
+
+//! \brief A LogContext whose description is a fixed string.
+//!
+//! This is suitable for context that is computed once and then shared by many
+//! other contexts, such as the name of a module.
+class StringLogContext final : public LogContext {
+ public:
+  //! \param[in] string The description, which should begin with `", "`.
+  //! \param[in] parent The enclosing context, or `NULL` if there is none.
+  explicit StringLogContext(const std::string& string,
+                            const LogContext* parent = NULL);
+  ~StringLogContext();
+
+  //! \brief Replaces the description.
+  void set_string(const std::string& string) { string_ = string; }
+
+ protected:
+  virtual void AppendOwnTo(std::string* string) const override;
+
+ private:
+  std::string string_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringLogContext);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_LOG_CONTEXT_H_
@@ -0,0 +1,116 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "util/misc/log_context.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Resembles a 64-bit `nlist` symbol table entry.
+struct Symbol {
+  uint32_t n_strx;
+  uint8_t n_type;
+  uint8_t n_sect;
+  uint16_t n_desc;
+  uint64_t n_value;
+};
+
+class SymbolIndexLogContext final : public LogContext {
+ public:
+  explicit SymbolIndexLogContext(const LogContext* parent)
+      : LogContext(parent), index_(0) {}
+
+  ~SymbolIndexLogContext() {}
+
+  void set_index(size_t index) { index_ = index; }
+
+ protected:
+  virtual void AppendOwnTo(std::string* string) const override {
+    base::StringAppendF(string, ", symbol index %zu", index_);
+  }
+
+ private:
+  size_t index_;
+
+  DISALLOW_COPY_AND_ASSIGN(SymbolIndexLogContext);
+};
+
+// Walks a symbol table of range(0) entries the way
+// MachOImageSymbolTableReader does, validating each entry. If range(1) is 0,
+// each entry’s diagnostic context string is formatted eagerly. Otherwise, a
+// LogContext is updated instead. No entry fails validation, so the context is
+// never actually used.
+void BM_LogContextSymbolTable(BenchmarkState* state) {
+  const size_t symbol_count = state->range(0);
+  const bool lazy = state->range(1) != 0;
+
+  std::vector<Symbol> symbols(symbol_count);
+  for (size_t index = 0; index < symbol_count; ++index) {
+    symbols[index].n_strx = static_cast<uint32_t>(index * 16);
+    symbols[index].n_type = 0x0f;  // N_SECT | N_EXT
+    symbols[index].n_sect = 1;
+    symbols[index].n_value = 0x1000 + index * 0x10;
+  }
+
+  const std::string module_info_string =
+      ", module /System/Library/Frameworks/AppKit.framework/Versions/C/AppKit"
+      ", address 0x7fff8c4d5000";
+  StringLogContext module_info(module_info_string);
+
+  while (state->KeepRunning()) {
+    size_t valid = 0;
+    if (lazy) {
+      SymbolIndexLogContext symbol_info(&module_info);
+      for (size_t index = 0; index < symbol_count; ++index) {
+        symbol_info.set_index(index);
+        DoNotOptimize(symbol_info);
+        if (symbols[index].n_sect != 0) {
+          ++valid;
+        }
+      }
+    } else {
+      for (size_t index = 0; index < symbol_count; ++index) {
+        std::string symbol_info =
+            base::StringPrintf(", symbol index %zu%s",
+                               index,
+                               module_info_string.c_str());
+        DoNotOptimize(symbol_info);
+        if (symbols[index].n_sect != 0) {
+          ++valid;
+        }
+      }
+    }
+    DoNotOptimize(valid);
+  }
+
+  state->SetLabel(lazy ? "lazy" : "eager");
+  state->SetItemsProcessed(state->iterations() * symbol_count);
+}
+CRASHPAD_BENCHMARK(BM_LogContextSymbolTable)
+    ->Args(4096, 0)
+    ->Args(4096, 1)
+    ->Args(262144, 0)
+    ->Args(262144, 1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
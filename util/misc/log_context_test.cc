@@ -0,0 +1,94 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/log_context.h"
+
+#include <sstream>
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// A LogContext that counts how many times it has been formatted.
+class CountingLogContext final : public LogContext {
+ public:
+  explicit CountingLogContext(const LogContext* parent)
+      : LogContext(parent), index_(0), format_count_(0) {}
+
+  ~CountingLogContext() {}
+
+  void set_index(size_t index) { index_ = index; }
+  size_t format_count() const { return format_count_; }
+
+ protected:
+  virtual void AppendOwnTo(std::string* string) const override {
+    ++format_count_;
+    base::StringAppendF(string, ", index %zu", index_);
+  }
+
+ private:
+  size_t index_;
+  mutable size_t format_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingLogContext);
+};
+
+TEST(LogContext, String) {
+  StringLogContext context(", module libfoo");
+  EXPECT_EQ(", module libfoo", context.ToString());
+
+  context.set_string(", module libbar");
+  EXPECT_EQ(", module libbar", context.ToString());
+
+  StringLogContext empty((std::string()));
+  EXPECT_EQ("", empty.ToString());
+}
+
+TEST(LogContext, Chain) {
+  StringLogContext module(", module libfoo");
+  StringLogContext segment(", segment __TEXT", &module);
+  CountingLogContext section(&segment);
+  section.set_index(3);
+
+  EXPECT_EQ(", index 3, segment __TEXT, module libfoo", section.ToString());
+  EXPECT_EQ(", segment __TEXT, module libfoo", segment.ToString());
+
+  std::string string("message");
+  section.AppendTo(&string);
+  EXPECT_EQ("message, index 3, segment __TEXT, module libfoo", string);
+
+  std::ostringstream stream;
+  stream << "message" << section;
+  EXPECT_EQ("message, index 3, segment __TEXT, module libfoo", stream.str());
+}
+
+TEST(LogContext, FormatsOnlyWhenUsed) {
+  StringLogContext module(", module libfoo");
+  CountingLogContext context(&module);
+  for (size_t index = 0; index < 1000; ++index) {
+    context.set_index(index);
+  }
+  EXPECT_EQ(0u, context.format_count());
+
+  EXPECT_EQ(", index 999, module libfoo", context.ToString());
+  EXPECT_EQ(1u, context.format_count());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
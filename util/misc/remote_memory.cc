@@ -0,0 +1,145 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/remote_memory.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "util/stdlib/strnlen.h"
+
+namespace crashpad {
+
+namespace {
+
+// The MappedMemory returned by the default implementation of ReadMapped(),
+// which owns a copy of the requested region.
+class CopiedMappedMemory final : public RemoteMemory::MappedMemory {
+ public:
+  // Takes ownership of |data|, which must have been allocated by new[].
+  CopiedMappedMemory(char* data, size_t size)
+      : RemoteMemory::MappedMemory(data, size), data_(data) {}
+
+  virtual ~CopiedMappedMemory() {}
+
+ private:
+  scoped_ptr<char[]> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(CopiedMappedMemory);
+};
+
+}  // namespace
+
+bool RemoteMemory::MappedMemory::ReadCString(size_t offset,
+                                             std::string* string) const {
+  if (offset >= size_) {
+    LOG(WARNING) << "offset out of range";
+    return false;
+  }
+
+  const char* string_base = reinterpret_cast<const char*>(data_) + offset;
+  size_t max_length = size_ - offset;
+  size_t string_length = strnlen(string_base, max_length);
+  if (string_length == max_length) {
+    LOG(WARNING) << "unterminated string";
+    return false;
+  }
+
+  string->assign(string_base, string_length);
+  return true;
+}
+
+bool RemoteMemory::ReadBatch(const ReadRequest* requests, size_t count) {
+  for (size_t index = 0; index < count; ++index) {
+    if (!Read(requests[index].address,
+              requests[index].size,
+              requests[index].buffer)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+scoped_ptr<RemoteMemory::MappedMemory> RemoteMemory::ReadMapped(
+    uint64_t address,
+    size_t size) {
+  scoped_ptr<char[]> data(new char[size]);
+  if (!Read(address, size, data.get())) {
+    return scoped_ptr<MappedMemory>();
+  }
+
+  return scoped_ptr<MappedMemory>(new CopiedMappedMemory(data.release(), size));
+}
+
+bool RemoteMemory::ReadCString(uint64_t address, std::string* string) {
+  return ReadCStringInternal(address, false, 0, string);
+}
+
+bool RemoteMemory::ReadCStringSizeLimited(uint64_t address,
+                                          uint64_t size,
+                                          std::string* string) {
+  return ReadCStringInternal(address, true, size, string);
+}
+
+bool RemoteMemory::ReadCStringInternal(uint64_t address,
+                                       bool has_size,
+                                       uint64_t size,
+                                       std::string* string) {
+  const uint64_t page_size = getpagesize();
+
+  if (has_size) {
+    if (size == 0) {
+      string->clear();
+      return true;
+    }
+  } else {
+    size = page_size;
+  }
+
+  // Read no more than a page at a time, and never across a page boundary, so
+  // that a string ending just before an unmapped page can still be read.
+  std::string local_string;
+  std::string page(page_size, '\0');
+  uint64_t read_address = address;
+  do {
+    const size_t read_length =
+        std::min(size, page_size - (read_address % page_size));
+    if (!Read(read_address, read_length, &page[0])) {
+      return false;
+    }
+
+    size_t read_data_length = strnlen(&page[0], read_length);
+    local_string.append(&page[0], read_data_length);
+    if (read_data_length < read_length) {
+      string->swap(local_string);
+      return true;
+    }
+
+    if (has_size) {
+      size -= read_length;
+    }
+    read_address += read_length;
+  } while ((!has_size || size > 0) && read_address > address);
+
+  LOG(WARNING) << base::StringPrintf("unterminated string at 0x%llx",
+                                     static_cast<unsigned long long>(address));
+  return false;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,193 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_REMOTE_MEMORY_H_
+#define CRASHPAD_UTIL_MISC_REMOTE_MEMORY_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+
+namespace crashpad {
+
+//! \brief An interface to read the memory of another process.
+//!
+//! Implementations provide access to a specific process on a specific
+//! platform. Code that only needs to read memory, and not perform other
+//! operations on the target process, can be written against this interface and
+//! used with any implementation, including CachedRemoteMemory, which places a
+//! cache in front of another implementation.
+class RemoteMemory {
+ public:
+  //! \brief A single region of memory to be read by ReadBatch().
+  struct ReadRequest {
+    //! \brief The address, in the target process’ address space, of the memory
+    //!     region to copy.
+    uint64_t address;
+
+    //! \brief The size, in bytes, of the memory region to copy.
+    size_t size;
+
+    //! \brief The buffer into which the contents of the other process’ memory
+    //!     will be copied. This must be at least #size bytes long.
+    void* buffer;
+  };
+
+  //! \brief A region of the target process’ memory made available in the
+  //!     current process by ReadMapped().
+  //!
+  //! This base class refers to memory that it does not own. Subclasses may own
+  //! the memory, and release it when destroyed.
+  class MappedMemory {
+   public:
+    //! \param[in] data The data in the current process.
+    //! \param[in] size The size of \a data, in bytes.
+    MappedMemory(const void* data, size_t size) : data_(data), size_(size) {}
+
+    virtual ~MappedMemory() {}
+
+    //! \brief Returns a pointer to the data requested from ReadMapped().
+    const void* data() const { return data_; }
+
+    //! \brief Returns the size of the data requested from ReadMapped().
+    size_t size() const { return size_; }
+
+    //! \brief Reads a `NUL`-terminated C string from the mapped region.
+    //!
+    //! \param[in] offset The offset into data() of the string to be read.
+    //! \param[out] string The string, whose contents begin at data() +
+    //!     \a offset and continue up to a `NUL` terminator.
+    //!
+    //! \return `true` on success, with \a string set appropriately. If \a
+    //!     offset is greater than or equal to size(), or if no `NUL`
+    //!     terminator was found in data() after \a offset, returns `false`
+    //!     with an appropriate warning logged.
+    bool ReadCString(size_t offset, std::string* string) const;
+
+   private:
+    const void* data_;  // weak
+    size_t size_;
+
+    DISALLOW_COPY_AND_ASSIGN(MappedMemory);
+  };
+
+  virtual ~RemoteMemory() {}
+
+  //! \brief Copies memory from the target process into a caller-provided
+  //!     buffer in the current process.
+  //!
+  //! \param[in] address The address, in the target process’ address space, of
+  //!     the memory region to copy.
+  //! \param[in] size The size, in bytes, of the memory region to copy. \a
+  //!     buffer must be at least this size.
+  //! \param[out] buffer The buffer into which the contents of the other
+  //!     process’ memory will be copied.
+  //!
+  //! \return `true` on success, with \a buffer filled appropriately. `false` on
+  //!     failure, with a warning logged. Failures can occur, for example, when
+  //!     encountering unmapped or unreadable pages.
+  virtual bool Read(uint64_t address, size_t size, void* buffer) = 0;
+
+  //! \brief Copies several regions of memory from the target process into
+  //!     caller-provided buffers in the current process.
+  //!
+  //! The default implementation calls Read() for each request. Implementations
+  //! that are able to read several regions with a single operation, such as a
+  //! single vectored system call, should override this method.
+  //!
+  //! \param[in] requests The regions to read. Each request’s buffer is filled
+  //!     as though by Read().
+  //! \param[in] count The number of elements in \a requests.
+  //!
+  //! \return `true` if every region was read successfully. `false` on failure,
+  //!     with a warning logged. On failure, the contents of all buffers in \a
+  //!     requests are unspecified.
+  virtual bool ReadBatch(const ReadRequest* requests, size_t count);
+
+  //! \brief Makes memory from the target process available in the current
+  //!     process, avoiding a copy where possible.
+  //!
+  //! This is an alternative to Read() for large regions that will only be
+  //! accessed sparsely. The default implementation copies the region with
+  //! Read() into storage owned by the returned object. Implementations that
+  //! can map memory from the target process, so that its pages are only
+  //! faulted in as they are accessed, or that already have it in the current
+  //! process, should override this method.
+  //!
+  //! \param[in] address The address, in the target process’ address space, of
+  //!     the memory region to map.
+  //! \param[in] size The size, in bytes, of the memory region to map.
+  //!
+  //! \return On success, a MappedMemory object that provides access to the
+  //!     data requested. On failure, `NULL`, with a warning logged.
+  virtual scoped_ptr<MappedMemory> ReadMapped(uint64_t address, size_t size);
+
+  //! \brief Reads a `NUL`-terminated C string from the target process into a
+  //!     string in the current process.
+  //!
+  //! The length of the string need not be known ahead of time. This method will
+  //! read contiguous memory until a `NUL` terminator is found.
+  //!
+  //! The default implementation reads memory a page at a time with Read().
+  //! Implementations with direct access to the memory, which can search for
+  //! the terminator in place, may override this method.
+  //!
+  //! \param[in] address The address, in the target process’ address space, of
+  //!     the string to copy.
+  //! \param[out] string The string read from the other process.
+  //!
+  //! \return `true` on success, with \a string set appropriately. `false` on
+  //!     failure, with a warning logged. Failures can occur, for example, when
+  //!     encountering unmapped or unreadable pages.
+  virtual bool ReadCString(uint64_t address, std::string* string);
+
+  //! \brief Reads a `NUL`-terminated C string from the target process into a
+  //!     string in the current process.
+  //!
+  //! \param[in] address The address, in the target process’ address space, of
+  //!     the string to copy.
+  //! \param[in] size The maximum number of bytes to read. The string is
+  //!     required to be `NUL`-terminated within this many bytes.
+  //! \param[out] string The string read from the other process.
+  //!
+  //! \return `true` on success, with \a string set appropriately. `false` on
+  //!     failure, with a warning logged. Failures can occur, for example, when
+  //!     a `NUL` terminator is not found within \a size bytes, or when
+  //!     encountering unmapped or unreadable pages.
+  //!
+  //! \sa ReadCString()
+  virtual bool ReadCStringSizeLimited(uint64_t address,
+                                      uint64_t size,
+                                      std::string* string);
+
+ protected:
+  RemoteMemory() {}
+
+ private:
+  // The common internal implementation shared by the ReadCString*() methods.
+  bool ReadCStringInternal(uint64_t address,
+                           bool has_size,
+                           uint64_t size,
+                           std::string* string);
+
+  DISALLOW_COPY_AND_ASSIGN(RemoteMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_REMOTE_MEMORY_H_
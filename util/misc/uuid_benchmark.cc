@@ -0,0 +1,40 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <string>
+
+#include "util/misc/uuid.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+void BM_UUIDToString(BenchmarkState* state) {
+  const uint8_t kBytes[16] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                              0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+  UUID uuid(kBytes);
+  while (state->KeepRunning()) {
+    std::string string = uuid.ToString();
+    DoNotOptimize(string);
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+CRASHPAD_BENCHMARK(BM_UUIDToString);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
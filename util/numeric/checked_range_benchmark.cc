@@ -0,0 +1,92 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "util/numeric/checked_range.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const size_t kRangeCount = 1024;
+
+// Builds ranges spread across the address space, as a reader validating
+// untrusted RVAs and location descriptors would see. If |valid_only| is false,
+// some of the ranges overflow.
+std::vector<std::pair<uint32_t, uint32_t> > MakeRanges(bool valid_only) {
+  std::vector<std::pair<uint32_t, uint32_t> > ranges;
+  uint32_t seed = 1;
+  for (size_t index = 0; index < kRangeCount; ++index) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t base = seed;
+    seed = seed * 1103515245 + 12345;
+    uint32_t size = seed >> (index % 32);
+    if (valid_only && size > UINT32_MAX - base) {
+      size = UINT32_MAX - base;
+    }
+    ranges.push_back(std::make_pair(base, size));
+  }
+  return ranges;
+}
+
+void BM_CheckedRangeIsValid(BenchmarkState* state) {
+  std::vector<std::pair<uint32_t, uint32_t> > ranges = MakeRanges(false);
+  CheckedRange<uint32_t> range(0, 0);
+  while (state->KeepRunning()) {
+    for (const std::pair<uint32_t, uint32_t>& base_and_size : ranges) {
+      range.SetRange(base_and_size.first, base_and_size.second);
+      DoNotOptimize(range.IsValid());
+    }
+  }
+  state->SetItemsProcessed(state->iterations() * kRangeCount);
+}
+CRASHPAD_BENCHMARK(BM_CheckedRangeIsValid);
+
+void BM_CheckedRangeContainsValue(BenchmarkState* state) {
+  std::vector<std::pair<uint32_t, uint32_t> > ranges = MakeRanges(true);
+  CheckedRange<uint32_t> range(0, 0);
+  while (state->KeepRunning()) {
+    for (const std::pair<uint32_t, uint32_t>& base_and_size : ranges) {
+      range.SetRange(base_and_size.first, base_and_size.second);
+      DoNotOptimize(range.ContainsValue(0x80000000));
+    }
+  }
+  state->SetItemsProcessed(state->iterations() * kRangeCount);
+}
+CRASHPAD_BENCHMARK(BM_CheckedRangeContainsValue);
+
+// Checks each range against a file-sized range, the way a minidump reader
+// checks each location descriptor against the mapped file.
+void BM_CheckedRangeContainsRange(BenchmarkState* state) {
+  std::vector<std::pair<uint32_t, uint32_t> > ranges = MakeRanges(true);
+  const CheckedRange<uint32_t> file_range(0, 0x40000000);
+  CheckedRange<uint32_t> range(0, 0);
+  while (state->KeepRunning()) {
+    for (const std::pair<uint32_t, uint32_t>& base_and_size : ranges) {
+      range.SetRange(base_and_size.first, base_and_size.second);
+      DoNotOptimize(file_range.ContainsRange(range));
+    }
+  }
+  state->SetItemsProcessed(state->iterations() * kRangeCount);
+}
+CRASHPAD_BENCHMARK(BM_CheckedRangeContainsRange);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
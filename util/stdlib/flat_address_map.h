@@ -0,0 +1,177 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_STDLIB_FLAT_ADDRESS_MAP_H_
+#define CRASHPAD_UTIL_STDLIB_FLAT_ADDRESS_MAP_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+namespace crashpad {
+
+//! \brief A read-only map from addresses to values, searched for the nearest
+//!     address at or below a given address.
+//!
+//! This is intended for large maps that are built once and then searched many
+//! times, such as an index used to find the symbol containing each of many
+//! instruction pointers. Each entry marks the start of a range that extends to
+//! the next entry’s address.
+//!
+//! Entries are added with Insert(). Once all of them have been added, Sort()
+//! must be called before the map can be searched. Sort() arranges the entries
+//! in Eytzinger (breadth-first binary tree) order, in which the entries visited
+//! by the first several steps of every search are stored next to each other.
+//! This uses the cache more effectively than a binary search of a sorted array,
+//! and allows each step of the search to be performed without branching.
+template <typename T>
+class FlatAddressMap {
+ public:
+  FlatAddressMap() : entries_(), addresses_(), values_(), sorted_(true) {}
+  ~FlatAddressMap() {}
+
+  //! \brief Reserves storage for \a count entries.
+  void Reserve(size_t count) { entries_.reserve(count); }
+
+  //! \brief Adds an entry to the map.
+  //!
+  //! If more than one entry is inserted at the same address, FindAtOrBelow()
+  //! will find the one that was inserted last.
+  //!
+  //! Entries may not be added to a map once Sort() has been called on it.
+  void Insert(uint64_t address, const T& value) {
+    DCHECK(addresses_.empty());
+    Entry entry;
+    entry.address = address;
+    entry.value = value;
+    entries_.push_back(entry);
+    sorted_ = false;
+  }
+
+  //! \brief Arranges the map’s entries, making it ready to be searched.
+  void Sort() {
+    DCHECK(addresses_.empty());
+    std::stable_sort(entries_.begin(), entries_.end(), EntryLess());
+
+    // Element 0 of the Eytzinger layout is unused, so that the children of the
+    // element at index k are at 2k and 2k + 1.
+    addresses_.resize(entries_.size() + 1);
+    values_.resize(entries_.size() + 1);
+    size_t sorted_index = Layout(0, 1);
+    DCHECK_EQ(sorted_index, entries_.size());
+
+    std::vector<Entry>().swap(entries_);
+    sorted_ = true;
+  }
+
+  //! \brief Finds the entry with the highest address that is less than or
+  //!     equal to \a address.
+  //!
+  //! Sort() must have been called since the last call to Insert().
+  //!
+  //! \param[in] address The address to search for.
+  //! \param[out] entry_address The address of the entry found. This parameter
+  //!     may be `NULL`.
+  //!
+  //! \return A pointer to the value of the entry found, which remains valid
+  //!     until the map is destroyed, or `NULL` if every entry’s address is
+  //!     greater than \a address.
+  const T* FindAtOrBelow(uint64_t address, uint64_t* entry_address) const {
+    DCHECK(sorted_);
+
+    // Descend the tree, moving to the right child of each entry at or below
+    // |address| and to the left child of each entry above it. Afterwards, the
+    // bits of |index| below its leading 1 record each step taken, with 1
+    // indicating a step to the right.
+    const size_t count = addresses_.empty() ? 0 : addresses_.size() - 1;
+    size_t index = 1;
+    while (index <= count) {
+      index = 2 * index + (addresses_[index] <= address);
+    }
+
+    // The entry sought is the last one that was stepped to the right of, so
+    // discard the steps taken to the left after it and the step to its right.
+    while ((index & 1) == 0) {
+      index >>= 1;
+    }
+    index >>= 1;
+
+    if (index == 0) {
+      return NULL;
+    }
+    if (entry_address) {
+      *entry_address = addresses_[index];
+    }
+    return &values_[index];
+  }
+
+  //! \brief Returns the number of entries in the map.
+  size_t size() const {
+    return addresses_.empty() ? entries_.size() : addresses_.size() - 1;
+  }
+
+  //! \brief Returns the number of bytes of memory allocated by the map for its
+  //!     entries.
+  size_t allocated_size() const {
+    return entries_.capacity() * sizeof(Entry) +
+           addresses_.capacity() * sizeof(uint64_t) +
+           values_.capacity() * sizeof(T);
+  }
+
+ private:
+  struct Entry {
+    uint64_t address;
+    T value;
+  };
+
+  struct EntryLess {
+    bool operator()(const Entry& lhs, const Entry& rhs) const {
+      return lhs.address < rhs.address;
+    }
+  };
+
+  // Places the sorted entries_, beginning at |sorted_index|, into the subtree
+  // of the Eytzinger layout rooted at |layout_index| by visiting it in order.
+  // Returns the index into entries_ of the first entry not placed.
+  size_t Layout(size_t sorted_index, size_t layout_index) {
+    if (layout_index < addresses_.size()) {
+      sorted_index = Layout(sorted_index, 2 * layout_index);
+      addresses_[layout_index] = entries_[sorted_index].address;
+      values_[layout_index] = entries_[sorted_index].value;
+      sorted_index = Layout(sorted_index + 1, 2 * layout_index + 1);
+    }
+    return sorted_index;
+  }
+
+  // Entries as inserted. This is emptied by Sort().
+  std::vector<Entry> entries_;
+
+  // The sorted entries’ addresses and values in Eytzinger order. These are
+  // populated by Sort(). Addresses are kept apart from values so that as many
+  // as possible share each cache line visited by FindAtOrBelow().
+  std::vector<uint64_t> addresses_;
+  std::vector<T> values_;
+
+  bool sorted_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlatAddressMap);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_STDLIB_FLAT_ADDRESS_MAP_H_
@@ -0,0 +1,125 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "util/stdlib/flat_address_map.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// The number of addresses looked up in each iteration.
+const size_t kLookupCount = 1 << 20;
+
+// Returns |count| symbol addresses, resembling those of a large module: sorted,
+// 16-byte aligned, and separated by gaps of varying size.
+std::vector<uint64_t> SymbolAddresses(size_t count) {
+  std::vector<uint64_t> addresses;
+  addresses.reserve(count);
+  uint64_t address = 0x100000000;
+  uint32_t random = 1;
+  for (size_t index = 0; index < count; ++index) {
+    addresses.push_back(address);
+    random = random * 1103515245 + 12345;
+    address += 16 + ((random >> 16) & 0x3f0);
+  }
+  return addresses;
+}
+
+// Returns kLookupCount addresses spread throughout the range covered by
+// |symbol_addresses|, in no particular order, as instruction pointers from many
+// threads’ stacks would be.
+std::vector<uint64_t> LookupAddresses(
+    const std::vector<uint64_t>& symbol_addresses) {
+  const uint64_t base = symbol_addresses.front();
+  const uint64_t span = symbol_addresses.back() - base + 0x100;
+  std::vector<uint64_t> addresses;
+  addresses.reserve(kLookupCount);
+  uint64_t random = 1;
+  for (size_t index = 0; index < kLookupCount; ++index) {
+    random = random * 6364136223846793005ull + 1442695040888963407ull;
+    addresses.push_back(base + (random >> 11) % span);
+  }
+  return addresses;
+}
+
+// Looks up kLookupCount addresses in an index of range(0) symbols with
+// std::upper_bound() on a sorted array if range(1) is 0, or with FlatAddressMap
+// otherwise.
+void BM_FlatAddressMapFind(BenchmarkState* state) {
+  const bool flat = state->range(1) != 0;
+  const std::vector<uint64_t> symbol_addresses =
+      SymbolAddresses(state->range(0));
+  const std::vector<uint64_t> lookup_addresses =
+      LookupAddresses(symbol_addresses);
+
+  FlatAddressMap<uint32_t> map;
+  map.Reserve(symbol_addresses.size());
+  for (size_t index = 0; index < symbol_addresses.size(); ++index) {
+    map.Insert(symbol_addresses[index], static_cast<uint32_t>(index));
+  }
+  map.Sort();
+
+  uint64_t sum = 0;
+  while (state->KeepRunning()) {
+    for (uint64_t address : lookup_addresses) {
+      if (flat) {
+        sum += *map.FindAtOrBelow(address, NULL);
+      } else {
+        sum += std::upper_bound(symbol_addresses.begin(),
+                                symbol_addresses.end(),
+                                address) - symbol_addresses.begin() - 1;
+      }
+    }
+  }
+  DoNotOptimize(sum);
+
+  state->SetLabel(flat ? "flat" : "sorted array");
+  state->SetItemsProcessed(state->iterations() * lookup_addresses.size());
+}
+CRASHPAD_BENCHMARK(BM_FlatAddressMapFind)
+    ->Args(4096, 0)
+    ->Args(4096, 1)
+    ->Args(65536, 0)
+    ->Args(65536, 1)
+    ->Args(1048576, 0)
+    ->Args(1048576, 1);
+
+// Builds an index of range(0) symbols.
+void BM_FlatAddressMapSort(BenchmarkState* state) {
+  const std::vector<uint64_t> symbol_addresses =
+      SymbolAddresses(state->range(0));
+
+  while (state->KeepRunning()) {
+    FlatAddressMap<uint32_t> map;
+    map.Reserve(symbol_addresses.size());
+    for (size_t index = 0; index < symbol_addresses.size(); ++index) {
+      map.Insert(symbol_addresses[index], static_cast<uint32_t>(index));
+    }
+    map.Sort();
+    DoNotOptimize(map.size());
+  }
+
+  state->SetItemsProcessed(state->iterations() * symbol_addresses.size());
+}
+CRASHPAD_BENCHMARK(BM_FlatAddressMapSort)->Arg(4096)->Arg(65536);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
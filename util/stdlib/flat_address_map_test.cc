@@ -0,0 +1,128 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/stdlib/flat_address_map.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(FlatAddressMap, Empty) {
+  FlatAddressMap<int> map;
+  EXPECT_EQ(0u, map.size());
+  EXPECT_FALSE(map.FindAtOrBelow(0, NULL));
+  EXPECT_FALSE(map.FindAtOrBelow(UINT64_MAX, NULL));
+
+  map.Sort();
+  EXPECT_EQ(0u, map.size());
+  EXPECT_FALSE(map.FindAtOrBelow(0, NULL));
+  EXPECT_FALSE(map.FindAtOrBelow(UINT64_MAX, NULL));
+}
+
+TEST(FlatAddressMap, FindAtOrBelow) {
+  // Entries are inserted out of order.
+  FlatAddressMap<int> map;
+  map.Reserve(5);
+  map.Insert(0x3000, 3);
+  map.Insert(0x1000, 1);
+  map.Insert(0x5000, 5);
+  map.Insert(0x2000, 2);
+  map.Insert(0x4000, 4);
+  EXPECT_EQ(5u, map.size());
+  map.Sort();
+  EXPECT_EQ(5u, map.size());
+  EXPECT_GE(map.allocated_size(), 5u * (sizeof(uint64_t) + sizeof(int)));
+
+  EXPECT_FALSE(map.FindAtOrBelow(0, NULL));
+  EXPECT_FALSE(map.FindAtOrBelow(0xfff, NULL));
+
+  const struct {
+    uint64_t address;
+    uint64_t entry_address;
+    int value;
+  } kFound[] = {
+    {0x1000, 0x1000, 1},
+    {0x1001, 0x1000, 1},
+    {0x1fff, 0x1000, 1},
+    {0x2000, 0x2000, 2},
+    {0x3800, 0x3000, 3},
+    {0x4fff, 0x4000, 4},
+    {0x5000, 0x5000, 5},
+    {UINT64_MAX, 0x5000, 5},
+  };
+  for (size_t index = 0; index < arraysize(kFound); ++index) {
+    SCOPED_TRACE(index);
+    uint64_t entry_address;
+    const int* value = map.FindAtOrBelow(kFound[index].address, &entry_address);
+    ASSERT_TRUE(value);
+    EXPECT_EQ(kFound[index].value, *value);
+    EXPECT_EQ(kFound[index].entry_address, entry_address);
+  }
+}
+
+TEST(FlatAddressMap, SameAddress) {
+  FlatAddressMap<int> map;
+  map.Insert(0x2000, 3);
+  map.Insert(0x1000, 1);
+  map.Insert(0x1000, 2);
+  map.Sort();
+
+  const int* value = map.FindAtOrBelow(0x1800, NULL);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(2, *value);
+}
+
+TEST(FlatAddressMap, MatchesSortedArray) {
+  // Compare against std::upper_bound() for every size up to one that fills
+  // several levels of the tree, so that full and partial bottom levels are both
+  // exercised.
+  for (size_t count = 0; count <= 70; ++count) {
+    SCOPED_TRACE(count);
+    std::vector<uint64_t> addresses;
+    FlatAddressMap<size_t> map;
+    for (size_t index = 0; index < count; ++index) {
+      uint64_t address = 16 + index * 16;
+      addresses.push_back(address);
+      map.Insert(address, index);
+    }
+    map.Sort();
+
+    for (uint64_t address = 0; address <= 16 + count * 16; address += 8) {
+      std::vector<uint64_t>::const_iterator iterator =
+          std::upper_bound(addresses.begin(), addresses.end(), address);
+      uint64_t entry_address;
+      const size_t* value = map.FindAtOrBelow(address, &entry_address);
+      if (iterator == addresses.begin()) {
+        EXPECT_FALSE(value);
+      } else {
+        size_t expected_index = iterator - addresses.begin() - 1;
+        ASSERT_TRUE(value);
+        EXPECT_EQ(expected_index, *value);
+        EXPECT_EQ(addresses[expected_index], entry_address);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
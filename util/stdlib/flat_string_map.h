@@ -0,0 +1,223 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_STDLIB_FLAT_STRING_MAP_H_
+#define CRASHPAD_UTIL_STDLIB_FLAT_STRING_MAP_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+namespace crashpad {
+
+//! \brief A read-only map from strings to values, stored as a sorted array.
+//!
+//! This is intended for large maps that are built once and then only searched,
+//! such as a module’s symbol table. The map does not copy its keys. Instead,
+//! each key refers to storage owned by the caller, such as a string table, that
+//! must outlive the map. Each entry occupies a single element of a vector, and
+//! Find() does not allocate memory.
+//!
+//! Entries are ordered by a hash of their keys, which is stored alongside each
+//! entry. Searching and sorting compare these hashes, and only compare keys
+//! themselves when their hashes are equal, so that most comparisons need not
+//! touch the caller’s key storage. As a result, the map is not ordered by key.
+//!
+//! Entries are added with Insert(). Once all of them have been added, Sort()
+//! must be called before the map can be searched.
+template <typename T>
+class FlatStringMap {
+ public:
+  FlatStringMap() : entries_(), sorted_(true) {}
+  ~FlatStringMap() {}
+
+  //! \brief Reserves storage for \a count entries.
+  void Reserve(size_t count) { entries_.reserve(count); }
+
+  //! \brief Adds an entry to the map.
+  //!
+  //! \param[in] key The key. This is not copied, and must remain valid for the
+  //!     lifetime of this object. It need not be `NUL`-terminated.
+  //! \param[in] key_length The length of \a key, in bytes.
+  //! \param[in] value The value to associate with \a key.
+  void Insert(const char* key, size_t key_length, const T& value) {
+    DCHECK_LE(key_length, static_cast<size_t>(UINT32_MAX));
+    Entry entry;
+    entry.key = key;
+    entry.key_length = static_cast<uint32_t>(key_length);
+    entry.hash = Hash(key, key_length);
+    entry.value = value;
+    entries_.push_back(entry);
+    sorted_ = false;
+  }
+
+  //! \brief Sorts the map’s entries, making it ready to be searched.
+  //!
+  //! \param[out] duplicate_key If not `NULL` and the map contains more than one
+  //!     entry with the same key, set to that key.
+  //! \param[out] duplicate_value If not `NULL` and the map contains more than
+  //!     one entry with the same key, set to the value of one of those entries.
+  //!
+  //! \return `true` if every key is unique. `false` if any key appears more
+  //!     than once. The map may be searched either way, but Find() may return
+  //!     any of the values associated with a duplicated key.
+  bool Sort(std::string* duplicate_key, T* duplicate_value) {
+    std::sort(entries_.begin(), entries_.end(), EntryLess());
+    sorted_ = true;
+
+    // Entries with equal keys have equal hashes, so they’re adjacent.
+    for (size_t index = 1; index < entries_.size(); ++index) {
+      const Entry& entry = entries_[index];
+      if (Compare(entries_[index - 1],
+                  entry.hash,
+                  entry.key,
+                  entry.key_length) == 0) {
+        if (duplicate_key) {
+          duplicate_key->assign(entry.key, entry.key_length);
+        }
+        if (duplicate_value) {
+          *duplicate_value = entry.value;
+        }
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  //! \brief Looks up a key in the map.
+  //!
+  //! Sort() must have been called since the last call to Insert().
+  //!
+  //! \return A pointer to the value associated with \a key, which remains valid
+  //!     until the map is modified or destroyed, or `NULL` if \a key is not
+  //!     present.
+  const T* Find(const char* key, size_t key_length) const {
+    DCHECK(sorted_);
+    const uint32_t hash = Hash(key, key_length);
+    typename std::vector<Entry>::const_iterator iterator = std::lower_bound(
+        entries_.begin(), entries_.end(), hash, EntryHashLess());
+    for (; iterator != entries_.end() && iterator->hash == hash; ++iterator) {
+      if (Compare(*iterator, hash, key, key_length) == 0) {
+        return &iterator->value;
+      }
+    }
+    return NULL;
+  }
+
+  //! \copydoc Find()
+  const T* Find(const std::string& key) const {
+    return Find(key.data(), key.size());
+  }
+
+  //! \brief Returns the number of entries in the map.
+  size_t size() const { return entries_.size(); }
+
+  //! \brief Returns the key of the entry at \a index.
+  //!
+  //! Together with ValueAt(), this allows every entry in the map to be visited.
+  //! Entries are not visited in any particular order, but an entry’s index
+  //! doesn’t change unless the map is modified.
+  //!
+  //! \param[in] index The index of the entry, which must be less than size().
+  //! \param[out] key_length The length of the returned key, in bytes.
+  //!
+  //! \return The key, as passed to Insert().
+  const char* KeyAt(size_t index, size_t* key_length) const {
+    DCHECK_LT(index, entries_.size());
+    const Entry& entry = entries_[index];
+    *key_length = entry.key_length;
+    return entry.key;
+  }
+
+  //! \brief Returns the value of the entry at \a index.
+  //!
+  //! \sa KeyAt()
+  const T& ValueAt(size_t index) const {
+    DCHECK_LT(index, entries_.size());
+    return entries_[index].value;
+  }
+
+  //! \brief Returns the number of bytes of memory allocated by the map for its
+  //!     entries, not including the storage for the keys themselves.
+  size_t allocated_size() const { return entries_.capacity() * sizeof(Entry); }
+
+ private:
+  struct Entry {
+    const char* key;  // weak
+    uint32_t key_length;
+    uint32_t hash;
+    T value;
+  };
+
+  // Computes the 32-bit FNV-1a hash of |key|.
+  static uint32_t Hash(const char* key, size_t key_length) {
+    uint32_t hash = 2166136261u;
+    for (size_t index = 0; index < key_length; ++index) {
+      hash ^= static_cast<uint8_t>(key[index]);
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
+  // Orders |entry| relative to a key with hash |hash|, returning a value less
+  // than, equal to, or greater than 0 as memcmp() would. Entries are ordered by
+  // hash, then by key as memcmp() would order them, with a shorter key ordered
+  // before a longer key that it is a prefix of.
+  static int Compare(const Entry& entry,
+                     uint32_t hash,
+                     const char* key,
+                     size_t key_length) {
+    if (entry.hash != hash) {
+      return entry.hash < hash ? -1 : 1;
+    }
+    int result = memcmp(
+        entry.key, key, std::min(static_cast<size_t>(entry.key_length),
+                                 key_length));
+    if (result != 0) {
+      return result;
+    }
+    if (entry.key_length != key_length) {
+      return entry.key_length < key_length ? -1 : 1;
+    }
+    return 0;
+  }
+
+  struct EntryLess {
+    bool operator()(const Entry& lhs, const Entry& rhs) const {
+      return Compare(lhs, rhs.hash, rhs.key, rhs.key_length) < 0;
+    }
+  };
+
+  struct EntryHashLess {
+    bool operator()(const Entry& entry, uint32_t hash) const {
+      return entry.hash < hash;
+    }
+  };
+
+  std::vector<Entry> entries_;
+  bool sorted_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlatStringMap);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_STDLIB_FLAT_STRING_MAP_H_
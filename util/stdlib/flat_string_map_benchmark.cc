@@ -0,0 +1,177 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "util/stdlib/flat_string_map.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Resembles MachOImageSymbolTableReader::SymbolInformation.
+struct SymbolInformation {
+  uint64_t value;
+  uint8_t section;
+  uint32_t index;
+};
+
+// A string table of range(0) external symbol names, resembling that of a
+// large system library. Names are in the order that a linker might emit them,
+// which is not sorted.
+class StringTable {
+ public:
+  explicit StringTable(size_t count) : table_(), offsets_(), names_() {
+    const char* const kPrefixes[] = {
+        "_pthread_", "_os_unfair_", "_dispatch_", "_xpc_", "__platform_",
+        "_malloc_zone_", "_CFString", "__ZNSt3__112basic_string",
+    };
+    offsets_.reserve(count);
+    names_.reserve(count);
+    for (size_t index = 0; index < count; ++index) {
+      std::string name = base::StringPrintf(
+          "%s%zx_%s",
+          kPrefixes[(index * 7) % arraysize(kPrefixes)],
+          (index * 2654435761u) & 0xffffff,
+          index % 3 == 0 ? "np" : "internal");
+      offsets_.push_back(table_.size());
+      names_.push_back(name);
+      table_.append(name);
+      table_.push_back('\0');
+    }
+  }
+
+  size_t size() const { return names_.size(); }
+  const char* name(size_t index) const { return &table_[offsets_[index]]; }
+  const std::string& name_string(size_t index) const { return names_[index]; }
+
+ private:
+  std::string table_;
+  std::vector<size_t> offsets_;
+  std::vector<std::string> names_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringTable);
+};
+
+// The approximate heap footprint of a std::map<std::string, T>: one tree node
+// of four pointer-sized words plus the pair per entry, plus the heap storage of
+// any name too long for the library’s short-string optimization.
+template <typename T>
+size_t StdMapAllocatedSize(const std::map<std::string, T>& map) {
+  size_t size = 0;
+  for (const auto& entry : map) {
+    size += 4 * sizeof(void*) + sizeof(entry);
+    if (entry.first.capacity() > sizeof(std::string) - 1) {
+      size += entry.first.capacity() + 1;
+    }
+  }
+  return size;
+}
+
+// Builds a map of range(0) symbols with std::map if range(1) is 0, or with
+// FlatStringMap otherwise.
+void BM_FlatStringMapBuild(BenchmarkState* state) {
+  const bool flat = state->range(1) != 0;
+  StringTable string_table(state->range(0));
+
+  size_t allocated_size = 0;
+  while (state->KeepRunning()) {
+    if (flat) {
+      FlatStringMap<SymbolInformation> map;
+      map.Reserve(string_table.size());
+      for (size_t index = 0; index < string_table.size(); ++index) {
+        SymbolInformation symbol = {
+            index * 16, 1, static_cast<uint32_t>(index)};
+        const char* name = string_table.name(index);
+        map.Insert(name, strlen(name), symbol);
+      }
+      if (!map.Sort(NULL, NULL)) {
+        state->SkipWithError("duplicate symbol");
+        return;
+      }
+      allocated_size = map.allocated_size();
+    } else {
+      std::map<std::string, SymbolInformation> map;
+      for (size_t index = 0; index < string_table.size(); ++index) {
+        SymbolInformation symbol = {
+            index * 16, 1, static_cast<uint32_t>(index)};
+        std::string name(string_table.name(index));
+        if (map.count(name)) {
+          state->SkipWithError("duplicate symbol");
+          return;
+        }
+        map[name] = symbol;
+      }
+      allocated_size = StdMapAllocatedSize(map);
+    }
+  }
+
+  state->SetLabel(flat ? "flat" : "std::map");
+  state->SetItemsProcessed(state->iterations() * string_table.size());
+  state->SetCounter("allocated_bytes", static_cast<double>(allocated_size));
+}
+CRASHPAD_BENCHMARK(BM_FlatStringMapBuild)
+    ->Args(4096, 0)
+    ->Args(4096, 1)
+    ->Args(65536, 0)
+    ->Args(65536, 1);
+
+// Looks up every symbol in a map of range(0) symbols with std::map if range(1)
+// is 0, or with FlatStringMap otherwise.
+void BM_FlatStringMapFind(BenchmarkState* state) {
+  const bool flat = state->range(1) != 0;
+  StringTable string_table(state->range(0));
+
+  FlatStringMap<SymbolInformation> flat_map;
+  std::map<std::string, SymbolInformation> std_map;
+  for (size_t index = 0; index < string_table.size(); ++index) {
+    SymbolInformation symbol = {index * 16, 1, static_cast<uint32_t>(index)};
+    const char* name = string_table.name(index);
+    flat_map.Insert(name, strlen(name), symbol);
+    std_map[name] = symbol;
+  }
+  flat_map.Sort(NULL, NULL);
+
+  uint64_t sum = 0;
+  while (state->KeepRunning()) {
+    for (size_t index = 0; index < string_table.size(); ++index) {
+      const std::string& name = string_table.name_string(index);
+      if (flat) {
+        sum += flat_map.Find(name)->value;
+      } else {
+        sum += std_map.find(name)->second.value;
+      }
+    }
+  }
+  DoNotOptimize(sum);
+
+  state->SetLabel(flat ? "flat" : "std::map");
+  state->SetItemsProcessed(state->iterations() * string_table.size());
+}
+CRASHPAD_BENCHMARK(BM_FlatStringMapFind)
+    ->Args(4096, 0)
+    ->Args(4096, 1)
+    ->Args(65536, 0)
+    ->Args(65536, 1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,123 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/stdlib/flat_string_map.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(FlatStringMap, Empty) {
+  FlatStringMap<int> map;
+  EXPECT_EQ(0u, map.size());
+  EXPECT_TRUE(map.Sort(NULL, NULL));
+  EXPECT_FALSE(map.Find("key"));
+  EXPECT_FALSE(map.Find(std::string()));
+}
+
+TEST(FlatStringMap, Find) {
+  // The keys are stored in a single buffer, as in a string table, and are
+  // inserted out of order.
+  const char kStringTable[] = "\0_main\0_malloc\0_free\0_mallocx\0_";
+  FlatStringMap<int> map;
+  map.Reserve(5);
+  map.Insert(&kStringTable[1], 5, 1);  // _main
+  map.Insert(&kStringTable[7], 7, 2);  // _malloc
+  map.Insert(&kStringTable[15], 5, 3);  // _free
+  map.Insert(&kStringTable[21], 8, 4);  // _mallocx
+  map.Insert(&kStringTable[30], 1, 5);  // _
+  map.Insert(&kStringTable[0], 0, 6);  // (empty)
+  EXPECT_EQ(6u, map.size());
+  EXPECT_GE(map.allocated_size(), 6u * sizeof(int));
+
+  std::string duplicate_key;
+  EXPECT_TRUE(map.Sort(&duplicate_key, NULL));
+  EXPECT_TRUE(duplicate_key.empty());
+
+  const struct {
+    const char* key;
+    int value;
+  } kFound[] = {
+    {"_main", 1},
+    {"_malloc", 2},
+    {"_free", 3},
+    {"_mallocx", 4},
+    {"_", 5},
+    {"", 6},
+  };
+  for (size_t index = 0; index < arraysize(kFound); ++index) {
+    SCOPED_TRACE(kFound[index].key);
+    const int* value = map.Find(kFound[index].key);
+    ASSERT_TRUE(value);
+    EXPECT_EQ(kFound[index].value, *value);
+  }
+
+  const char* const kNotFound[] = {
+    "main",
+    "_mai",
+    "_maim",
+    "_mallo",
+    "_mallocxx",
+    "__",
+    "_zzz",
+    "\x7f",
+  };
+  for (size_t index = 0; index < arraysize(kNotFound); ++index) {
+    SCOPED_TRACE(kNotFound[index]);
+    EXPECT_FALSE(map.Find(kNotFound[index]));
+  }
+
+  // Every entry can be visited by index.
+  for (size_t index = 0; index < map.size(); ++index) {
+    size_t key_length;
+    const char* key = map.KeyAt(index, &key_length);
+    EXPECT_EQ(map.Find(key, key_length), &map.ValueAt(index));
+  }
+
+  // Keys are compared by length, not by NUL termination.
+  EXPECT_TRUE(map.Find("_mallocx", 7));
+  EXPECT_EQ(2, *map.Find("_mallocx", 7));
+}
+
+TEST(FlatStringMap, Duplicate) {
+  const char kStringTable[] = "_a\0_b\0_a";
+  FlatStringMap<int> map;
+  map.Insert(&kStringTable[0], 2, 1);
+  map.Insert(&kStringTable[3], 2, 2);
+  map.Insert(&kStringTable[6], 2, 3);
+
+  std::string duplicate_key;
+  int duplicate_value;
+  EXPECT_FALSE(map.Sort(&duplicate_key, &duplicate_value));
+  EXPECT_EQ("_a", duplicate_key);
+  EXPECT_TRUE(duplicate_value == 1 || duplicate_value == 3)
+      << duplicate_value;
+
+  EXPECT_FALSE(map.Sort(NULL, NULL));
+
+  const int* value = map.Find("_b");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(2, *value);
+  value = map.Find("_a");
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(*value == 1 || *value == 3);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
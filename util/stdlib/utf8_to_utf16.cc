@@ -0,0 +1,220 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/stdlib/utf8_to_utf16.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "build/build_config.h"
+
+// The vector path widens bytes by interleaving them with zero bytes, which
+// produces char16 values in native byte order only on little-endian systems.
+#if defined(__SSE2__) && defined(ARCH_CPU_LITTLE_ENDIAN)
+#include <emmintrin.h>
+#endif
+
+namespace crashpad {
+
+namespace {
+
+const char16 kReplacementCharacter = 0xfffd;
+
+// The number of bytes that WidenASCII() converts at once.
+#if defined(__SSE2__) && defined(ARCH_CPU_LITTLE_ENDIAN)
+const size_t kBlockSize = 16;
+#else
+const size_t kBlockSize = 8;
+#endif
+
+// Widens the run of ASCII at the beginning of |utf8| into |utf16|, returning
+// the number of bytes converted. This works in blocks, so it may stop short of
+// the end of the run by up to a block’s length. The caller is responsible for
+// any remaining bytes.
+size_t WidenASCII(const uint8_t* utf8, size_t length, char16* utf16) {
+  size_t index = 0;
+
+#if defined(__SSE2__) && defined(ARCH_CPU_LITTLE_ENDIAN)
+  const __m128i zero = _mm_setzero_si128();
+  for (; length - index >= 16; index += 16) {
+    __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8 + index));
+    if (_mm_movemask_epi8(bytes) != 0) {
+      return index;
+    }
+
+    // Interleaving with zero widens each byte to a little-endian code unit.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16 + index),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16 + index + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+#else
+  for (; length - index >= 8; index += 8) {
+    uint64_t word;
+    memcpy(&word, utf8 + index, sizeof(word));
+    if (word & 0x8080808080808080ull) {
+      return index;
+    }
+
+    for (size_t byte_index = 0; byte_index < 8; ++byte_index) {
+      utf16[index + byte_index] = utf8[index + byte_index];
+    }
+  }
+#endif
+
+  return index;
+}
+
+bool IsTrailByte(uint8_t byte) {
+  return (byte & 0xc0) == 0x80;
+}
+
+// Decodes the sequence beginning at |utf8|, which has |length| bytes available
+// and begins with a byte that is not ASCII. Sets |sequence_length| to the
+// number of bytes consumed, which is always at least 1.
+//
+// Returns true and sets |code_point| if the sequence is well-formed. Otherwise,
+// returns false, and the bytes consumed form a single ill-formed sequence to be
+// replaced by one U+FFFD. Ill-formed sequences are delimited as ICU’s
+// utf8_nextCharSafeBody() does with strict = -1, as used by CBU8_NEXT() and
+// base::UTF8ToUTF16(): a lead byte consumes the trail bytes that immediately
+// follow it, up to as many as it calls for, whether or not they complete a
+// valid code point.
+bool DecodeSequence(const uint8_t* utf8,
+                    size_t length,
+                    size_t* sequence_length,
+                    uint32_t* code_point) {
+  const uint8_t lead = utf8[0];
+
+  // The number of trail bytes that the lead byte calls for. 0xf8 through 0xfd
+  // lead the obsolete five- and six-byte forms, which are never well-formed
+  // but still consume their trail bytes.
+  size_t trail_count;
+  if (lead < 0xc0 || lead >= 0xfe) {
+    // A stray trail byte, or a byte that never appears in UTF-8.
+    *sequence_length = 1;
+    return false;
+  } else if (lead < 0xe0) {
+    trail_count = 1;
+  } else if (lead < 0xf0) {
+    trail_count = 2;
+  } else if (lead < 0xf8) {
+    trail_count = 3;
+  } else if (lead < 0xfc) {
+    trail_count = 4;
+  } else {
+    trail_count = 5;
+  }
+
+  if (length - 1 < trail_count) {
+    // Truncated by the end of the input.
+    size_t index = 1;
+    while (index < length && IsTrailByte(utf8[index])) {
+      ++index;
+    }
+    *sequence_length = index;
+    return false;
+  }
+
+  bool well_formed = trail_count <= 3;
+  uint32_t value = lead & ((1 << (6 - trail_count)) - 1);
+  if (well_formed) {
+    for (size_t index = 1; index <= trail_count; ++index) {
+      well_formed &= IsTrailByte(utf8[index]);
+      value = (value << 6) | (utf8[index] & 0x3f);
+    }
+
+    const uint32_t kMinimum[] = {0, 0x80, 0x800, 0x10000};
+    well_formed &= value >= kMinimum[trail_count] && value <= 0x10ffff &&
+                   (value < 0xd800 || value > 0xdfff);
+  }
+
+  if (!well_formed) {
+    size_t index = 1;
+    while (index <= trail_count && IsTrailByte(utf8[index])) {
+      ++index;
+    }
+    *sequence_length = index;
+    return false;
+  }
+
+  *sequence_length = trail_count + 1;
+  *code_point = value;
+  return true;
+}
+
+}  // namespace
+
+bool UTF8ToUTF16(const char* utf8,
+                 size_t utf8_length,
+                 char16* utf16,
+                 size_t* utf16_length) {
+  const uint8_t* utf8_u = reinterpret_cast<const uint8_t*>(utf8);
+  bool well_formed = true;
+  size_t in = 0;
+  size_t out = 0;
+
+  while (in < utf8_length) {
+    if (utf8_u[in] < 0x80) {
+      // Every ASCII byte produces exactly one code unit, so the input and
+      // output advance together. Short runs, as found between the characters
+      // of non-Latin text, aren’t worth widening in blocks.
+      if (utf8_length - in >= kBlockSize && utf8_u[in + 1] < 0x80) {
+        const size_t widened =
+            WidenASCII(utf8_u + in, utf8_length - in, utf16 + out);
+        in += widened;
+        out += widened;
+      }
+      while (in < utf8_length && utf8_u[in] < 0x80) {
+        utf16[out++] = utf8_u[in++];
+      }
+      continue;
+    }
+
+    size_t sequence_length;
+    uint32_t code_point;
+    const bool sequence_well_formed = DecodeSequence(
+        utf8_u + in, utf8_length - in, &sequence_length, &code_point);
+    in += sequence_length;
+    if (!sequence_well_formed) {
+      utf16[out++] = kReplacementCharacter;
+      well_formed = false;
+      continue;
+    }
+
+    if (code_point >= 0x10000) {
+      // Four bytes of UTF-8 become a surrogate pair.
+      code_point -= 0x10000;
+      utf16[out++] = 0xd800 + (code_point >> 10);
+      utf16[out++] = 0xdc00 + (code_point & 0x3ff);
+    } else {
+      utf16[out++] = code_point;
+    }
+  }
+
+  *utf16_length = out;
+  return well_formed;
+}
+
+bool UTF8ToUTF16(const char* utf8, size_t utf8_length, string16* utf16) {
+  utf16->resize(utf8_length);
+  size_t utf16_length;
+  bool rv = UTF8ToUTF16(
+      utf8, utf8_length, utf8_length ? &(*utf16)[0] : NULL, &utf16_length);
+  utf16->resize(utf16_length);
+  return rv;
+}
+
+}  // namespace crashpad
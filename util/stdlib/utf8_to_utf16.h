@@ -0,0 +1,69 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_STDLIB_UTF8_TO_UTF16_H_
+#define CRASHPAD_UTIL_STDLIB_UTF8_TO_UTF16_H_
+
+#include <sys/types.h>
+
+#include "base/strings/string16.h"
+
+namespace crashpad {
+
+//! \brief Converts a UTF-8 string to UTF-16, validating it.
+//!
+//! Runs of ASCII, which make up nearly all of the module paths and other
+//! strings found in minidump files, are widened using vector instructions
+//! where available (SSE2 on little-endian x86), or eight bytes at a time
+//! otherwise. Other characters are decoded individually.
+//!
+//! Overlong encodings, encoded surrogates, code points beyond U+10FFFF, and
+//! truncated or otherwise malformed sequences are not well-formed UTF-8. Each
+//! such sequence is replaced by a single U+FFFD, delimiting sequences as
+//! base::UTF8ToUTF16() does: a lead byte and the trail bytes immediately
+//! following it, up to as many as it calls for, form one sequence. Other
+//! stray bytes are replaced individually.
+//!
+//! \param[in] utf8 The UTF-8 data to convert. This need not be
+//!     `NUL`-terminated, and may contain `NUL` characters.
+//! \param[in] utf8_length The length of \a utf8, in bytes.
+//! \param[out] utf16 A buffer of at least \a utf8_length char16 units to
+//!     receive the converted string. No `NUL` terminator is written. UTF-16
+//!     never requires more code units than UTF-8 requires bytes, so this is
+//!     always sufficient.
+//! \param[out] utf16_length The number of char16 units written to \a utf16.
+//!
+//! \return `true` if \a utf8 was well-formed, `false` if any U+FFFD
+//!     replacement characters were introduced.
+bool UTF8ToUTF16(const char* utf8,
+                 size_t utf8_length,
+                 char16* utf16,
+                 size_t* utf16_length);
+
+//! \brief Converts a UTF-8 string to UTF-16, validating it.
+//!
+//! This is the same as the other overload, but it places the result in a
+//! string16.
+//!
+//! \param[in] utf8 The UTF-8 data to convert.
+//! \param[in] utf8_length The length of \a utf8, in bytes.
+//! \param[out] utf16 The converted string.
+//!
+//! \return `true` if \a utf8 was well-formed, `false` if any U+FFFD
+//!     replacement characters were introduced.
+bool UTF8ToUTF16(const char* utf8, size_t utf8_length, string16* utf16);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_STDLIB_UTF8_TO_UTF16_H_
@@ -0,0 +1,82 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "base/strings/string16.h"
+#include "base/strings/utf_string_conversions.h"
+#include "util/stdlib/utf8_to_utf16.h"
+#include "util/test/benchmark.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Builds a string of at least |size| bytes by repeating |unit|.
+std::string RepeatToSize(const std::string& unit, size_t size) {
+  std::string string;
+  while (string.size() < size) {
+    string.append(unit);
+  }
+  return string;
+}
+
+// Converts |utf8| with base::UTF8ToUTF16() if range(1) is 0, or with
+// crashpad::UTF8ToUTF16() otherwise.
+void Convert(BenchmarkState* state, const std::string& utf8) {
+  const bool crashpad = state->range(1) != 0;
+  string16 utf16;
+  while (state->KeepRunning()) {
+    if (crashpad) {
+      UTF8ToUTF16(utf8.data(), utf8.size(), &utf16);
+    } else {
+      base::UTF8ToUTF16(utf8.data(), utf8.size(), &utf16);
+    }
+    DoNotOptimize(utf16);
+  }
+
+  state->SetLabel(crashpad ? "crashpad" : "base");
+  state->SetBytesProcessed(state->iterations() * utf8.size());
+}
+
+// Converts range(0) bytes of ASCII text.
+void BM_UTF8ToUTF16ASCII(BenchmarkState* state) {
+  Convert(state,
+          RepeatToSize("/usr/lib/system/libsystem_kernel.dylib",
+                       state->range(0)));
+}
+CRASHPAD_BENCHMARK(BM_UTF8ToUTF16ASCII)
+    ->Args(16, 0)
+    ->Args(16, 1)
+    ->Args(256, 0)
+    ->Args(256, 1)
+    ->Args(4096, 0)
+    ->Args(4096, 1);
+
+// Converts range(0) bytes of text mixing one-, two-, three-, and four-byte
+// UTF-8 sequences.
+void BM_UTF8ToUTF16Mixed(BenchmarkState* state) {
+  Convert(state,
+          RepeatToSize("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80",
+                       state->range(0)));
+}
+CRASHPAD_BENCHMARK(BM_UTF8ToUTF16Mixed)
+    ->Args(256, 0)
+    ->Args(256, 1)
+    ->Args(4096, 0)
+    ->Args(4096, 1);
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,194 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/stdlib/utf8_to_utf16.h"
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/utf_string_conversions.h"
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Converts |utf8| with both overloads, checking that they agree.
+string16 Convert(const std::string& utf8, bool* well_formed) {
+  string16 utf16;
+  *well_formed = UTF8ToUTF16(utf8.data(), utf8.size(), &utf16);
+
+  string16 buffer(utf8.size(), 0xa5a5);
+  size_t length;
+  EXPECT_EQ(*well_formed,
+            UTF8ToUTF16(utf8.data(),
+                        utf8.size(),
+                        buffer.empty() ? NULL : &buffer[0],
+                        &length));
+  EXPECT_EQ(utf16, buffer.substr(0, length));
+
+  return utf16;
+}
+
+TEST(UTF8ToUTF16, Empty) {
+  bool well_formed;
+  EXPECT_TRUE(Convert(std::string(), &well_formed).empty());
+  EXPECT_TRUE(well_formed);
+}
+
+TEST(UTF8ToUTF16, ASCII) {
+  // Try every length up to several times the widest block, so that runs end at
+  // every position within a block.
+  std::string utf8;
+  string16 expected;
+  for (size_t length = 0; length < 200; ++length) {
+    SCOPED_TRACE(length);
+
+    bool well_formed;
+    EXPECT_EQ(expected, Convert(utf8, &well_formed));
+    EXPECT_TRUE(well_formed);
+
+    const char c = 0x20 + (length % 0x5f);
+    utf8.push_back(c);
+    expected.push_back(c);
+  }
+
+  // NUL and DEL are ASCII too.
+  bool well_formed;
+  const char kControl[] = "\x00\x01\x7f\x00";
+  string16 utf16 =
+      Convert(std::string(kControl, sizeof(kControl) - 1), &well_formed);
+  EXPECT_TRUE(well_formed);
+  ASSERT_EQ(4u, utf16.size());
+  EXPECT_EQ(0x0000, utf16[0]);
+  EXPECT_EQ(0x0001, utf16[1]);
+  EXPECT_EQ(0x007f, utf16[2]);
+  EXPECT_EQ(0x0000, utf16[3]);
+}
+
+TEST(UTF8ToUTF16, Multibyte) {
+  const struct {
+    const char* utf8;
+    char16 utf16[3];
+  } kTestData[] = {
+      {"\xc2\x80", {0x0080}},
+      {"\xc3\xa9", {0x00e9}},
+      {"\xdf\xbf", {0x07ff}},
+      {"\xe0\xa0\x80", {0x0800}},
+      {"\xe2\x82\xac", {0x20ac}},
+      {"\xed\x9f\xbf", {0xd7ff}},
+      {"\xee\x80\x80", {0xe000}},
+      {"\xef\xbf\xbf", {0xffff}},
+      {"\xf0\x90\x80\x80", {0xd800, 0xdc00}},
+      {"\xf0\x9f\x98\x80", {0xd83d, 0xde00}},
+      {"\xf4\x8f\xbf\xbf", {0xdbff, 0xdfff}},
+  };
+
+  for (size_t index = 0; index < arraysize(kTestData); ++index) {
+    SCOPED_TRACE(index);
+
+    bool well_formed;
+    EXPECT_EQ(string16(kTestData[index].utf16),
+              Convert(kTestData[index].utf8, &well_formed));
+    EXPECT_TRUE(well_formed);
+  }
+}
+
+TEST(UTF8ToUTF16, MixedAgreesWithBase) {
+  // Place a non-ASCII character at every position in strings long enough to
+  // exercise block conversion, and compare against the general-purpose
+  // converter.
+  const char* const kCharacters[] = {
+      "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+  for (const char* character : kCharacters) {
+    for (size_t position = 0; position < 70; ++position) {
+      SCOPED_TRACE(position);
+
+      std::string utf8(position, 'p');
+      utf8.append(character);
+      utf8.append(std::string(70 - position, 's'));
+      utf8.append(character);
+
+      bool well_formed;
+      EXPECT_EQ(base::UTF8ToUTF16(utf8), Convert(utf8, &well_formed));
+      EXPECT_TRUE(well_formed);
+    }
+  }
+}
+
+TEST(UTF8ToUTF16, Invalid) {
+  const char16 kFFFD = 0xfffd;
+  const struct {
+    const char* utf8;
+    char16 utf16[5];
+  } kTestData[] = {
+      // Unexpected continuation bytes.
+      {"\x80", {kFFFD}},
+      {"a\xbf" "b", {'a', kFFFD, 'b'}},
+
+      // Bytes that never appear in UTF-8.
+      {"\xff", {kFFFD}},
+      {"\xf8\x88\x80\x80\x80", {kFFFD}},
+      {"\xfe\x80", {kFFFD, kFFFD}},
+
+      // Truncated sequences.
+      {"\xc3", {kFFFD}},
+      {"\xe2\x82", {kFFFD}},
+      {"\xe2\x82z", {kFFFD, 'z'}},
+      {"\xf0\x9f\x98", {kFFFD}},
+      {"\xf0\x9f\x98z", {kFFFD, 'z'}},
+      {"\xc3\xa9\xe2", {0xe9, kFFFD}},
+
+      // Overlong encodings.
+      {"\xc0\x80", {kFFFD}},
+      {"\xc1\xbf", {kFFFD}},
+      {"\xe0\x9f\xbf", {kFFFD}},
+      {"\xf0\x8f\xbf\xbf", {kFFFD}},
+
+      // Encoded surrogates.
+      {"\xed\xa0\x80", {kFFFD}},
+      {"\xed\xbf\xbf", {kFFFD}},
+
+      // Beyond U+10FFFF.
+      {"\xf4\x90\x80\x80", {kFFFD}},
+      {"\xf5\x80\x80\x80", {kFFFD}},
+
+      // A lead byte consumes only trail bytes, and no more than it calls for.
+      {"\xc3\x80\x80", {0xc0, kFFFD}},
+      {"\xe2\xc3\xa9", {kFFFD, 0xe9}},
+      {"\xc0\x80\x80", {kFFFD, kFFFD}},
+  };
+
+  for (size_t index = 0; index < arraysize(kTestData); ++index) {
+    SCOPED_TRACE(index);
+
+    bool well_formed;
+    EXPECT_EQ(string16(kTestData[index].utf16),
+              Convert(kTestData[index].utf8, &well_formed));
+    EXPECT_FALSE(well_formed);
+  }
+
+  // An invalid byte following a long run of ASCII stops block conversion.
+  std::string utf8(100, 'q');
+  utf8[77] = '\x80';
+  string16 expected(100, 'q');
+  expected[77] = kFFFD;
+  bool well_formed;
+  EXPECT_EQ(expected, Convert(utf8, &well_formed));
+  EXPECT_FALSE(well_formed);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,524 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/test/benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "build/build_config.h"
+#include "util/misc/clock.h"
+
+namespace {
+
+uint64_t g_allocation_count;
+
+}  // namespace
+
+// These replace the global allocation functions so that benchmarks can report
+// the number of allocations made per iteration. The remaining forms of
+// operator new and operator delete are implemented in terms of these by the
+// C++ library.
+
+void* operator new(size_t size) {
+  __atomic_fetch_add(&g_allocation_count, 1, __ATOMIC_RELAXED);
+  void* pointer = malloc(size ? size : 1);
+  if (!pointer) {
+    abort();
+  }
+  return pointer;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  free(pointer);
+}
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kNanosecondsPerSecond = 1000000000;
+const int64_t kMaxIterations = 1000000000;
+
+uint64_t TimevalToNanoseconds(const timeval& tv) {
+  return tv.tv_sec * kNanosecondsPerSecond + tv.tv_usec * 1000;
+}
+
+// Returns the CPU time consumed by all threads in the process.
+uint64_t ProcessCPUTimeNanoseconds() {
+  rusage usage;
+  int rv = getrusage(RUSAGE_SELF, &usage);
+  DPCHECK(rv == 0) << "getrusage";
+  return TimevalToNanoseconds(usage.ru_utime) +
+         TimevalToNanoseconds(usage.ru_stime);
+}
+
+std::vector<Benchmark*>* Benchmarks() {
+  static std::vector<Benchmark*>* benchmarks = new std::vector<Benchmark*>();
+  return benchmarks;
+}
+
+struct Options {
+  Options() : filter(), out_path(), min_time(0.5), list(false) {}
+
+  std::string filter;
+  std::string out_path;
+  double min_time;
+  bool list;
+};
+
+// If |argument| begins with |option|, sets |value| to the remainder of
+// |argument| and returns true.
+bool MatchOption(const char* argument, const char* option, std::string* value) {
+  size_t option_length = strlen(option);
+  if (strncmp(argument, option, option_length) != 0) {
+    return false;
+  }
+  value->assign(argument + option_length);
+  return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options* options) {
+  for (int index = 1; index < argc; ++index) {
+    const char* argument = argv[index];
+    std::string value;
+    if (MatchOption(argument, "--benchmark_filter=", &value)) {
+      options->filter = value;
+    } else if (MatchOption(argument, "--benchmark_min_time=", &value)) {
+      char* end;
+      options->min_time = strtod(value.c_str(), &end);
+      if (value.empty() || *end != '\0' || options->min_time < 0) {
+        fprintf(stderr, "%s: invalid minimum time %s\n", argv[0], argument);
+        return false;
+      }
+    } else if (MatchOption(argument, "--benchmark_out=", &value)) {
+      options->out_path = value;
+    } else if (strcmp(argument, "--benchmark_list") == 0) {
+      options->list = true;
+    } else {
+      fprintf(stderr, "%s: unrecognized option %s\n", argv[0], argument);
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string BenchmarkRunName(const Benchmark* benchmark,
+                             const std::vector<int64_t>& args) {
+  std::string name = benchmark->name();
+  for (int64_t arg : args) {
+    name.append(base::StringPrintf("/%lld", static_cast<long long>(arg)));
+  }
+  return name;
+}
+
+// Runs |benchmark| with |args|, increasing the iteration count until a run
+// takes at least |min_time_ns|, and returns the state of the final run.
+scoped_ptr<BenchmarkState> RunBenchmark(const Benchmark* benchmark,
+                                        const std::vector<int64_t>& args,
+                                        uint64_t min_time_ns) {
+  int64_t iterations = 1;
+  while (true) {
+    scoped_ptr<BenchmarkState> state(new BenchmarkState(args, iterations));
+    benchmark->function()(state.get());
+    if (!state->error().empty()) {
+      return state.Pass();
+    }
+    CHECK(state->finished()) << benchmark->name()
+                             << " returned while KeepRunning() was true";
+
+    if (state->real_time_ns() >= min_time_ns ||
+        iterations >= kMaxIterations) {
+      return state.Pass();
+    }
+
+    // Aim slightly past the minimum time, so that the next run is likely to be
+    // the last. Runs that were far too short are only grown by a bounded
+    // factor, because their timing is too coarse to extrapolate from.
+    double multiplier = 10;
+    if (state->real_time_ns() > min_time_ns / 10) {
+      multiplier = 1.4 * min_time_ns / state->real_time_ns();
+    }
+    int64_t next_iterations = static_cast<int64_t>(iterations * multiplier);
+    iterations = std::min(std::max(next_iterations, iterations + 1),
+                          kMaxIterations);
+  }
+}
+
+// Writes |string| as a JSON string literal.
+void WriteJSONString(FILE* file, const std::string& string) {
+  fputc('"', file);
+  for (char c : string) {
+    if (c == '"' || c == '\\') {
+      fprintf(file, "\\%c", c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      fprintf(file, "\\u%04x", c);
+    } else {
+      fputc(c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+void WriteJSONContext(FILE* file, const char* executable) {
+  char date[64];
+  time_t now = time(NULL);
+  tm now_tm;
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime_r(&now, &now_tm));
+
+  fprintf(file, "  \"context\": {\n");
+  fprintf(file, "    \"date\": ");
+  WriteJSONString(file, date);
+  fprintf(file, ",\n    \"executable\": ");
+  WriteJSONString(file, executable);
+  fprintf(file, ",\n    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#if defined(NDEBUG)
+  fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+  fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+  fprintf(file, "  },\n");
+}
+
+void WriteJSONResult(FILE* file,
+                     const std::string& name,
+                     const BenchmarkState& state,
+                     bool last) {
+  fprintf(file, "    {\n      \"name\": ");
+  WriteJSONString(file, name);
+  if (!state.error().empty()) {
+    fprintf(file, ",\n      \"error_occurred\": true");
+    fprintf(file, ",\n      \"error_message\": ");
+    WriteJSONString(file, state.error());
+  } else {
+    double iterations = state.iterations();
+    double real_seconds =
+        static_cast<double>(state.real_time_ns()) / kNanosecondsPerSecond;
+    fprintf(file,
+            ",\n      \"iterations\": %lld",
+            static_cast<long long>(state.iterations()));
+    fprintf(file,
+            ",\n      \"real_time\": %.4f",
+            state.real_time_ns() / iterations);
+    fprintf(file,
+            ",\n      \"cpu_time\": %.4f",
+            state.cpu_time_ns() / iterations);
+    fprintf(file, ",\n      \"time_unit\": \"ns\"");
+    fprintf(file,
+            ",\n      \"allocations_per_iteration\": %.4f",
+            state.allocations() / iterations);
+    if (state.bytes_processed() && real_seconds > 0) {
+      fprintf(file,
+              ",\n      \"bytes_per_second\": %.0f",
+              state.bytes_processed() / real_seconds);
+    }
+    if (state.items_processed() && real_seconds > 0) {
+      fprintf(file,
+              ",\n      \"items_per_second\": %.0f",
+              state.items_processed() / real_seconds);
+    }
+    for (const auto& counter : state.counters()) {
+      fprintf(file, ",\n      ");
+      WriteJSONString(file, counter.first);
+      fprintf(file, ": %.6g", counter.second);
+    }
+    if (!state.label().empty()) {
+      fprintf(file, ",\n      \"label\": ");
+      WriteJSONString(file, state.label());
+    }
+  }
+  fprintf(file, "\n    }%s\n", last ? "" : ",");
+}
+
+void WriteConsoleResult(const std::string& name, const BenchmarkState& state) {
+  if (!state.error().empty()) {
+    fprintf(stderr, "%-56s ERROR: %s\n", name.c_str(), state.error().c_str());
+    return;
+  }
+
+  double iterations = state.iterations();
+  fprintf(stderr,
+          "%-56s %14.1f ns %14.1f ns %12lld %10.1f",
+          name.c_str(),
+          state.real_time_ns() / iterations,
+          state.cpu_time_ns() / iterations,
+          static_cast<long long>(state.iterations()),
+          state.allocations() / iterations);
+
+  double real_seconds =
+      static_cast<double>(state.real_time_ns()) / kNanosecondsPerSecond;
+  if (state.bytes_processed() && real_seconds > 0) {
+    fprintf(stderr, " %.1fMB/s", state.bytes_processed() / real_seconds / 1E6);
+  }
+  if (state.items_processed() && real_seconds > 0) {
+    fprintf(stderr, " %.0f items/s", state.items_processed() / real_seconds);
+  }
+  for (const auto& counter : state.counters()) {
+    fprintf(stderr, " %s=%.6g", counter.first.c_str(), counter.second);
+  }
+  if (!state.label().empty()) {
+    fprintf(stderr, " %s", state.label().c_str());
+  }
+  fprintf(stderr, "\n");
+}
+
+}  // namespace
+
+BenchmarkState::BenchmarkState(const std::vector<int64_t>& args,
+                               int64_t max_iterations)
+    : args_(args),
+      counters_(),
+      label_(),
+      error_(),
+      max_iterations_(max_iterations),
+      iterations_(0),
+      bytes_processed_(0),
+      items_processed_(0),
+      real_time_ns_(0),
+      cpu_time_ns_(0),
+      allocations_(0),
+      real_start_ns_(0),
+      cpu_start_ns_(0),
+      allocations_start_(0),
+      timing_(false),
+      started_(false),
+      finished_(false) {
+}
+
+BenchmarkState::~BenchmarkState() {
+}
+
+bool BenchmarkState::KeepRunning() {
+  DCHECK(!finished_);
+  DCHECK(error_.empty());
+
+  if (!started_) {
+    started_ = true;
+    StartTimers();
+  }
+
+  if (iterations_ < max_iterations_) {
+    ++iterations_;
+    return true;
+  }
+
+  if (timing_) {
+    StopTimers();
+  }
+  finished_ = true;
+  return false;
+}
+
+void BenchmarkState::PauseTiming() {
+  DCHECK(timing_);
+  StopTimers();
+}
+
+void BenchmarkState::ResumeTiming() {
+  DCHECK(!timing_);
+  StartTimers();
+}
+
+int64_t BenchmarkState::range(size_t index) const {
+  CHECK_LT(index, args_.size());
+  return args_[index];
+}
+
+void BenchmarkState::SkipWithError(const std::string& error) {
+  DCHECK(!error.empty());
+  error_ = error;
+  if (timing_) {
+    StopTimers();
+  }
+}
+
+void BenchmarkState::StartTimers() {
+  timing_ = true;
+  allocations_start_ = AllocationCount();
+  cpu_start_ns_ = ProcessCPUTimeNanoseconds();
+  real_start_ns_ = ClockMonotonicNanoseconds();
+}
+
+void BenchmarkState::StopTimers() {
+  real_time_ns_ += ClockMonotonicNanoseconds() - real_start_ns_;
+  cpu_time_ns_ += ProcessCPUTimeNanoseconds() - cpu_start_ns_;
+  allocations_ += AllocationCount() - allocations_start_;
+  timing_ = false;
+}
+
+Benchmark::Benchmark(const std::string& name, BenchmarkFunction function)
+    : name_(name),
+      argument_sets_(),
+      function_(function),
+      range_multiplier_(8) {
+}
+
+Benchmark::~Benchmark() {
+}
+
+Benchmark* Benchmark::Arg(int64_t arg) {
+  argument_sets_.push_back(std::vector<int64_t>(1, arg));
+  return this;
+}
+
+Benchmark* Benchmark::Args(int64_t arg_0, int64_t arg_1) {
+  std::vector<int64_t> args;
+  args.push_back(arg_0);
+  args.push_back(arg_1);
+  argument_sets_.push_back(args);
+  return this;
+}
+
+Benchmark* Benchmark::Range(int64_t start, int64_t limit) {
+  DCHECK_GT(start, 0);
+  DCHECK_LE(start, limit);
+
+  int64_t arg = start;
+  while (arg < limit) {
+    Arg(arg);
+    arg *= range_multiplier_;
+  }
+  return Arg(limit);
+}
+
+Benchmark* Benchmark::RangeMultiplier(int multiplier) {
+  DCHECK_GT(multiplier, 1);
+  range_multiplier_ = multiplier;
+  return this;
+}
+
+std::vector<std::vector<int64_t> > Benchmark::ArgumentSets() const {
+  if (argument_sets_.empty()) {
+    return std::vector<std::vector<int64_t> >(1);
+  }
+  return argument_sets_;
+}
+
+Benchmark* RegisterBenchmark(const std::string& name,
+                             BenchmarkFunction function) {
+  Benchmark* benchmark = new Benchmark(name, function);
+  Benchmarks()->push_back(benchmark);
+  return benchmark;
+}
+
+int RunBenchmarks(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::pair<const Benchmark*, std::vector<int64_t> > > runs;
+  for (const Benchmark* benchmark : *Benchmarks()) {
+    for (const std::vector<int64_t>& args : benchmark->ArgumentSets()) {
+      if (BenchmarkRunName(benchmark, args).find(options.filter) !=
+          std::string::npos) {
+        runs.push_back(std::make_pair(benchmark, args));
+      }
+    }
+  }
+
+  if (options.list) {
+    for (const auto& run : runs) {
+      printf("%s\n", BenchmarkRunName(run.first, run.second).c_str());
+    }
+    return EXIT_SUCCESS;
+  }
+
+  FILE* file = stdout;
+  if (!options.out_path.empty()) {
+    file = fopen(options.out_path.c_str(), "w");
+    if (!file) {
+      PLOG(ERROR) << "fopen " << options.out_path;
+      return EXIT_FAILURE;
+    }
+  }
+
+  fprintf(file, "{\n");
+  WriteJSONContext(file, argv[0]);
+  fprintf(file, "  \"benchmarks\": [\n");
+
+  fprintf(stderr,
+          "%-56s %17s %17s %12s %10s\n",
+          "Benchmark",
+          "Time",
+          "CPU",
+          "Iterations",
+          "Allocs");
+
+  const uint64_t min_time_ns =
+      static_cast<uint64_t>(options.min_time * kNanosecondsPerSecond);
+  bool success = true;
+  for (size_t index = 0; index < runs.size(); ++index) {
+    const Benchmark* benchmark = runs[index].first;
+    const std::vector<int64_t>& args = runs[index].second;
+    std::string name = BenchmarkRunName(benchmark, args);
+
+    scoped_ptr<BenchmarkState> state =
+        RunBenchmark(benchmark, args, min_time_ns);
+    if (!state->error().empty()) {
+      success = false;
+    }
+    WriteConsoleResult(name, *state);
+    WriteJSONResult(file, name, *state, index == runs.size() - 1);
+    fflush(file);
+  }
+
+  fprintf(file, "  ]\n}\n");
+
+  if (file != stdout && fclose(file) != 0) {
+    PLOG(ERROR) << "fclose " << options.out_path;
+    return EXIT_FAILURE;
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+uint64_t AllocationCount() {
+  return __atomic_load_n(&g_allocation_count, __ATOMIC_RELAXED);
+}
+
+size_t PeakResidentSetBytes() {
+  rusage usage;
+  int rv = getrusage(RUSAGE_SELF, &usage);
+  DPCHECK(rv == 0) << "getrusage";
+
+#if defined(OS_MACOSX)
+  // Mac OS X reports ru_maxrss in bytes.
+  return usage.ru_maxrss;
+#else
+  // Other systems report ru_maxrss in kilobytes.
+  return usage.ru_maxrss * 1024;
+#endif
+}
+
+}  // namespace test
+}  // namespace crashpad
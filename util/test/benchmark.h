@@ -0,0 +1,233 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_TEST_BENCHMARK_H_
+#define CRASHPAD_UTIL_TEST_BENCHMARK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief The state of a single run of a benchmark function.
+//!
+//! A benchmark function is called with a BenchmarkState, and performs the
+//! operation being measured once for each time that KeepRunning() returns
+//! `true`:
+//!
+//! \code
+//!   void BM_Something(BenchmarkState* state) {
+//!     SetUpSomething(state->range(0));
+//!     while (state->KeepRunning()) {
+//!       DoSomething();
+//!     }
+//!     state->SetItemsProcessed(state->iterations());
+//!   }
+//!   CRASHPAD_BENCHMARK(BM_Something)->Range(8, 4096);
+//! \endcode
+//!
+//! Timing begins with the first call to KeepRunning() and ends when it returns
+//! `false`, so work done before and after the loop is not measured.
+class BenchmarkState {
+ public:
+  //! \param[in] args The arguments for this run, available through range().
+  //! \param[in] max_iterations The number of times that KeepRunning() will
+  //!     return `true`.
+  BenchmarkState(const std::vector<int64_t>& args, int64_t max_iterations);
+  ~BenchmarkState();
+
+  //! \brief Returns `true` if the benchmark function should perform another
+  //!     iteration, and `false` once it has performed enough.
+  bool KeepRunning();
+
+  //! \brief Stops the timers, so that work done until ResumeTiming() is called
+  //!     is not measured.
+  void PauseTiming();
+
+  //! \brief Restarts the timers after PauseTiming().
+  void ResumeTiming();
+
+  //! \brief Returns the argument at \a index, as supplied by Benchmark::Arg(),
+  //!     Benchmark::Args(), or Benchmark::Range().
+  int64_t range(size_t index) const;
+
+  //! \brief Returns the number of iterations performed so far.
+  int64_t iterations() const { return iterations_; }
+
+  //! \brief Records the total number of bytes processed by all iterations,
+  //!     which will be reported as a rate.
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+
+  //! \brief Records the total number of items processed by all iterations,
+  //!     which will be reported as a rate.
+  void SetItemsProcessed(int64_t items) { items_processed_ = items; }
+
+  //! \brief Records an additional value to be reported as-is.
+  void SetCounter(const std::string& name, double value) {
+    counters_[name] = value;
+  }
+
+  //! \brief Records a string to be reported alongside the results.
+  void SetLabel(const std::string& label) { label_ = label; }
+
+  //! \brief Marks the run as failed. The benchmark should return without
+  //!     calling KeepRunning() again.
+  void SkipWithError(const std::string& error);
+
+  // The remaining accessors are used to report the results of a completed run.
+
+  bool finished() const { return finished_; }
+  const std::string& error() const { return error_; }
+  uint64_t real_time_ns() const { return real_time_ns_; }
+  uint64_t cpu_time_ns() const { return cpu_time_ns_; }
+  uint64_t allocations() const { return allocations_; }
+  int64_t bytes_processed() const { return bytes_processed_; }
+  int64_t items_processed() const { return items_processed_; }
+  const std::map<std::string, double>& counters() const { return counters_; }
+  const std::string& label() const { return label_; }
+
+ private:
+  void StartTimers();
+  void StopTimers();
+
+  std::vector<int64_t> args_;
+  std::map<std::string, double> counters_;
+  std::string label_;
+  std::string error_;
+  int64_t max_iterations_;
+  int64_t iterations_;
+  int64_t bytes_processed_;
+  int64_t items_processed_;
+  uint64_t real_time_ns_;
+  uint64_t cpu_time_ns_;
+  uint64_t allocations_;
+  uint64_t real_start_ns_;
+  uint64_t cpu_start_ns_;
+  uint64_t allocations_start_;
+  bool timing_;
+  bool started_;
+  bool finished_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkState);
+};
+
+//! \brief A function that performs a benchmark.
+typedef void (*BenchmarkFunction)(BenchmarkState* state);
+
+//! \brief A registered benchmark function and the arguments to run it with.
+//!
+//! Objects of this class are created by RegisterBenchmark(), usually through
+//! CRASHPAD_BENCHMARK(). Each method that adds arguments returns `this`, so
+//! that calls may be chained.
+class Benchmark {
+ public:
+  Benchmark(const std::string& name, BenchmarkFunction function);
+  ~Benchmark();
+
+  //! \brief Runs the benchmark with a single argument of \a arg.
+  Benchmark* Arg(int64_t arg);
+
+  //! \brief Runs the benchmark with two arguments, \a arg_0 and \a arg_1.
+  Benchmark* Args(int64_t arg_0, int64_t arg_1);
+
+  //! \brief Runs the benchmark with a single argument for each value from
+  //!     \a start to \a limit, inclusive, growing geometrically by the range
+  //!     multiplier.
+  Benchmark* Range(int64_t start, int64_t limit);
+
+  //! \brief Sets the factor between successive values produced by Range().
+  //!     The default is `8`.
+  Benchmark* RangeMultiplier(int multiplier);
+
+  const std::string& name() const { return name_; }
+  BenchmarkFunction function() const { return function_; }
+
+  //! \brief Returns the sets of arguments that the benchmark is to be run
+  //!     with. If no arguments were added, this contains a single empty set.
+  std::vector<std::vector<int64_t> > ArgumentSets() const;
+
+ private:
+  std::string name_;
+  std::vector<std::vector<int64_t> > argument_sets_;
+  BenchmarkFunction function_;
+  int range_multiplier_;
+
+  DISALLOW_COPY_AND_ASSIGN(Benchmark);
+};
+
+//! \brief Registers a benchmark function to be run by RunBenchmarks().
+//!
+//! \return The new Benchmark object, which lives for the remainder of the
+//!     process.
+Benchmark* RegisterBenchmark(const std::string& name,
+                             BenchmarkFunction function);
+
+//! \brief Runs all registered benchmarks selected by command-line options,
+//!     and writes their results as JSON.
+//!
+//! Recognized options are:
+//!  - `--benchmark_filter=SUBSTRING`: run only benchmarks whose names,
+//!    including arguments, contain `SUBSTRING`.
+//!  - `--benchmark_min_time=SECONDS`: run each benchmark for at least this
+//!    long. The default is `0.5`.
+//!  - `--benchmark_out=PATH`: write JSON results to `PATH` instead of the
+//!    standard output.
+//!  - `--benchmark_list`: list benchmark names without running them.
+//!
+//! A human-readable summary is written to the standard error stream.
+//!
+//! \return An exit status for `main()`.
+int RunBenchmarks(int argc, char* argv[]);
+
+//! \brief Returns the number of times that global `operator new` has been
+//!     called in the current process.
+//!
+//! This is only counted in executables that link the benchmark library, which
+//! replaces the global allocation functions.
+uint64_t AllocationCount();
+
+//! \brief Returns the peak resident set size of the current process, in
+//!     bytes.
+size_t PeakResidentSetBytes();
+
+//! \brief Prevents the compiler from optimizing away the computation of \a
+//!     value.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace test
+}  // namespace crashpad
+
+#define CRASHPAD_BENCHMARK_CONCAT_INNER(a, b) a##b
+#define CRASHPAD_BENCHMARK_CONCAT(a, b) CRASHPAD_BENCHMARK_CONCAT_INNER(a, b)
+
+//! \brief Registers \a function as a benchmark, named after \a function.
+//!
+//! The result is a `Benchmark*`, so that arguments may be added by chaining
+//! method calls after the macro.
+#define CRASHPAD_BENCHMARK(function)                                 \
+  static ::crashpad::test::Benchmark* CRASHPAD_BENCHMARK_CONCAT(     \
+      benchmark_registration_, __LINE__) __attribute__((unused)) =   \
+      ::crashpad::test::RegisterBenchmark(#function, function)
+
+#endif  // CRASHPAD_UTIL_TEST_BENCHMARK_H_
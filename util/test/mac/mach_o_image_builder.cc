@@ -0,0 +1,262 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/test/mac/mach_o_image_builder.h"
+
+#include <mach/mach.h>
+#include <mach-o/loader.h>
+#include <mach-o/nlist.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const uint64_t kPageSize = 0x1000;
+const char kDylibName[] = "/usr/lib/libcrashpad_mach_o_image_builder.dylib";
+
+uint64_t RoundUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Appends fields to an image in the layout that the 32-bit or 64-bit
+// process_types structures expect.
+class Appender {
+ public:
+  Appender(bool is_64_bit, std::string* image)
+      : image_(image), is_64_bit_(is_64_bit) {}
+
+  ~Appender() {}
+
+  void UInt8(uint8_t value) { Bytes(&value, sizeof(value)); }
+  void UInt16(uint16_t value) { Bytes(&value, sizeof(value)); }
+  void UInt32(uint32_t value) { Bytes(&value, sizeof(value)); }
+
+  // Appends a field that is 32 bits wide in 32-bit images and 64 bits wide in
+  // 64-bit images, such as segment_command::vmaddr.
+  void ULong(uint64_t value) {
+    if (is_64_bit_) {
+      Bytes(&value, sizeof(value));
+    } else {
+      DCHECK_EQ(value, static_cast<uint32_t>(value));
+      UInt32(static_cast<uint32_t>(value));
+    }
+  }
+
+  // Appends a 16-byte segment or section name, which is NUL-padded but not
+  // necessarily NUL-terminated.
+  void Name16(const char* name) {
+    char field[16] = {};
+    strncpy(field, name, sizeof(field));
+    Bytes(field, sizeof(field));
+  }
+
+  void Bytes(const void* data, size_t size) {
+    image_->append(static_cast<const char*>(data), size);
+  }
+
+  void PadTo(size_t size) {
+    DCHECK_LE(image_->size(), size);
+    image_->resize(size);
+  }
+
+ private:
+  std::string* image_;  // weak
+  bool is_64_bit_;
+
+  DISALLOW_COPY_AND_ASSIGN(Appender);
+};
+
+}  // namespace
+
+const uint64_t MachOImageBuilder::kTextSectionOffset;
+const uint32_t MachOImageBuilder::kDylibCurrentVersion;
+
+MachOImageBuilder::MachOImageBuilder(bool is_64_bit)
+    : symbols_(), is_64_bit_(is_64_bit) {
+  for (size_t index = 0; index < arraysize(uuid_); ++index) {
+    uuid_[index] = static_cast<uint8_t>(0xa0 + index);
+  }
+}
+
+MachOImageBuilder::~MachOImageBuilder() {
+}
+
+void MachOImageBuilder::AddSymbol(const std::string& name, uint64_t offset) {
+  Symbol symbol;
+  symbol.name = name;
+  symbol.offset = offset;
+  symbols_.push_back(symbol);
+}
+
+void MachOImageBuilder::Build(uint64_t vmaddr, std::string* image) const {
+  const size_t kMachHeaderSize = is_64_bit_ ? 32 : 28;
+  const size_t kSegmentCommandSize = is_64_bit_ ? 72 : 56;
+  const size_t kSectionSize = is_64_bit_ ? 80 : 68;
+  const size_t kSymtabCommandSize = 24;
+  const size_t kDysymtabCommandSize = 80;
+  const size_t kUUIDCommandSize = 24;
+  const size_t kDylibCommandSize = 24;
+  const size_t kNlistSize = is_64_bit_ ? 16 : 12;
+  const size_t kLoadCommandAlignment = is_64_bit_ ? 8 : 4;
+
+  const uint32_t dylib_command_size = static_cast<uint32_t>(
+      RoundUp(kDylibCommandSize + sizeof(kDylibName), kLoadCommandAlignment));
+  const uint32_t sizeofcmds = static_cast<uint32_t>(
+      kSegmentCommandSize + kSectionSize + kSegmentCommandSize +
+      kSymtabCommandSize + kDysymtabCommandSize + kUUIDCommandSize +
+      dylib_command_size);
+  CHECK_LE(kMachHeaderSize + sizeofcmds, kTextSectionOffset);
+
+  uint64_t text_section_size = 0x10;
+  for (const Symbol& symbol : symbols_) {
+    text_section_size = std::max(text_section_size, symbol.offset + 1);
+  }
+  text_section_size = RoundUp(text_section_size, 0x10);
+  const uint64_t text_segment_size =
+      RoundUp(kTextSectionOffset + text_section_size, kPageSize);
+
+  // The string table begins with a NUL byte so that no symbol has string table
+  // offset 0, which conventionally means an empty name.
+  std::string string_table(1, '\0');
+  std::vector<uint32_t> string_offsets;
+  string_offsets.reserve(symbols_.size());
+  for (const Symbol& symbol : symbols_) {
+    string_offsets.push_back(static_cast<uint32_t>(string_table.size()));
+    string_table.append(symbol.name);
+    string_table.push_back('\0');
+  }
+  string_table.resize(RoundUp(string_table.size(), kLoadCommandAlignment));
+
+  const uint32_t nsyms = static_cast<uint32_t>(symbols_.size());
+  const uint64_t linkedit_offset = text_segment_size;
+  const uint64_t symoff = linkedit_offset;
+  const uint64_t stroff = symoff + nsyms * kNlistSize;
+  const uint64_t linkedit_file_size =
+      stroff + string_table.size() - linkedit_offset;
+  const uint64_t linkedit_segment_size =
+      RoundUp(linkedit_file_size, kPageSize);
+
+  image->clear();
+  image->reserve(linkedit_offset + linkedit_segment_size);
+  Appender append(is_64_bit_, image);
+
+  // mach_header or mach_header_64.
+  append.UInt32(is_64_bit_ ? MH_MAGIC_64 : MH_MAGIC);
+  append.UInt32(0);  // cputype
+  append.UInt32(0);  // cpusubtype
+  append.UInt32(MH_DYLIB);
+  append.UInt32(6);  // ncmds
+  append.UInt32(sizeofcmds);
+  append.UInt32(0);  // flags
+  if (is_64_bit_) {
+    append.UInt32(0);  // reserved
+  }
+
+  // The __TEXT segment, with its __text section.
+  append.UInt32(is_64_bit_ ? LC_SEGMENT_64 : LC_SEGMENT);
+  append.UInt32(static_cast<uint32_t>(kSegmentCommandSize + kSectionSize));
+  append.Name16(SEG_TEXT);
+  append.ULong(vmaddr);
+  append.ULong(text_segment_size);
+  append.ULong(0);  // fileoff
+  append.ULong(text_segment_size);  // filesize
+  append.UInt32(VM_PROT_READ | VM_PROT_EXECUTE);  // maxprot
+  append.UInt32(VM_PROT_READ | VM_PROT_EXECUTE);  // initprot
+  append.UInt32(1);  // nsects
+  append.UInt32(0);  // flags
+
+  append.Name16(SECT_TEXT);
+  append.Name16(SEG_TEXT);
+  append.ULong(vmaddr + kTextSectionOffset);
+  append.ULong(text_section_size);
+  append.UInt32(static_cast<uint32_t>(kTextSectionOffset));
+  append.UInt32(4);  // align
+  append.UInt32(0);  // reloff
+  append.UInt32(0);  // nreloc
+  append.UInt32(S_REGULAR);  // flags
+  append.UInt32(0);  // reserved1
+  append.UInt32(0);  // reserved2
+  if (is_64_bit_) {
+    append.UInt32(0);  // reserved3
+  }
+
+  // The __LINKEDIT segment, holding the symbol and string tables.
+  append.UInt32(is_64_bit_ ? LC_SEGMENT_64 : LC_SEGMENT);
+  append.UInt32(static_cast<uint32_t>(kSegmentCommandSize));
+  append.Name16(SEG_LINKEDIT);
+  append.ULong(vmaddr + linkedit_offset);
+  append.ULong(linkedit_segment_size);
+  append.ULong(linkedit_offset);  // fileoff
+  append.ULong(linkedit_file_size);  // filesize
+  append.UInt32(VM_PROT_READ);  // maxprot
+  append.UInt32(VM_PROT_READ);  // initprot
+  append.UInt32(0);  // nsects
+  append.UInt32(0);  // flags
+
+  append.UInt32(LC_SYMTAB);
+  append.UInt32(kSymtabCommandSize);
+  append.UInt32(static_cast<uint32_t>(symoff));
+  append.UInt32(nsyms);
+  append.UInt32(static_cast<uint32_t>(stroff));
+  append.UInt32(static_cast<uint32_t>(string_table.size()));
+
+  // Every symbol is an external defined symbol.
+  append.UInt32(LC_DYSYMTAB);
+  append.UInt32(kDysymtabCommandSize);
+  append.UInt32(0);  // ilocalsym
+  append.UInt32(0);  // nlocalsym
+  append.UInt32(0);  // iextdefsym
+  append.UInt32(nsyms);  // nextdefsym
+  append.UInt32(nsyms);  // iundefsym
+  for (size_t field = 0; field < 13; ++field) {
+    append.UInt32(0);  // nundefsym through nlocrel
+  }
+
+  append.UInt32(LC_UUID);
+  append.UInt32(kUUIDCommandSize);
+  append.Bytes(uuid_, sizeof(uuid_));
+
+  append.UInt32(LC_ID_DYLIB);
+  append.UInt32(dylib_command_size);
+  append.UInt32(kDylibCommandSize);  // dylib_name
+  append.UInt32(0);  // dylib_timestamp
+  append.UInt32(kDylibCurrentVersion);
+  append.UInt32(0x00010000);  // dylib_compatibility_version
+  append.Bytes(kDylibName, sizeof(kDylibName));
+  append.PadTo(kMachHeaderSize + sizeofcmds);
+
+  // The contents of the __text section are not interesting, but are filled
+  // with int3 so that they look like code in a hex dump.
+  append.PadTo(kTextSectionOffset);
+  image->append(text_section_size, '\xcc');
+  append.PadTo(linkedit_offset);
+
+  for (size_t index = 0; index < symbols_.size(); ++index) {
+    append.UInt32(string_offsets[index]);  // n_strx
+    append.UInt8(N_SECT | N_EXT);  // n_type
+    append.UInt8(1);  // n_sect
+    append.UInt16(0);  // n_desc
+    append.ULong(vmaddr + kTextSectionOffset + symbols_[index].offset);
+  }
+  append.Bytes(string_table.data(), string_table.size());
+  append.PadTo(linkedit_offset + linkedit_segment_size);
+}
+
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,91 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_TEST_MAC_MACH_O_IMAGE_BUILDER_H_
+#define CRASHPAD_UTIL_TEST_MAC_MACH_O_IMAGE_BUILDER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief Builds a small Mach-O dylib in memory, for tests and benchmarks that
+//!     read images with MachOImageReader on any platform.
+//!
+//! The image has a `__TEXT` segment containing the Mach-O header, load
+//! commands, and a `__text` section, followed by a `__LINKEDIT` segment
+//! containing the symbol table and string table. It has `LC_SYMTAB`, `LC_DYSYMTAB`, `LC_UUID`,
+//! and `LC_ID_DYLIB` load commands. Every symbol added with AddSymbol() is an
+//! external symbol defined in the `__text` section.
+//!
+//! Each segment’s file offset is equal to its offset from the image’s base
+//! address, so the built image is laid out both as a Mach-O file and as the
+//! image would be when mapped into a process. It can be read from a
+//! BufferRemoteMemory or, after writing it to a file, from a FileRemoteMemory.
+class MachOImageBuilder {
+ public:
+  //! \brief The offset of the `__text` section from the image’s base address.
+  static const uint64_t kTextSectionOffset = 0x1000;
+
+  //! \brief The current version recorded in the image’s `LC_ID_DYLIB` load
+  //!     command, 1.2.3.
+  static const uint32_t kDylibCurrentVersion = 0x00010203;
+
+  //! \param[in] is_64_bit Whether to build a 64-bit (`MH_MAGIC_64`) image or a
+  //!     32-bit (`MH_MAGIC`) one.
+  explicit MachOImageBuilder(bool is_64_bit);
+  ~MachOImageBuilder();
+
+  //! \brief Adds an external symbol defined in the `__text` section.
+  //!
+  //! \param[in] name The symbol’s name, such as `"_main"`. A valid image has
+  //!     no two symbols with the same name, but this is not enforced, so that
+  //!     tests can build invalid symbol tables.
+  //! \param[in] offset The symbol’s offset from the beginning of the `__text`
+  //!     section.
+  void AddSymbol(const std::string& name, uint64_t offset);
+
+  //! \brief Lays out the image.
+  //!
+  //! \param[in] vmaddr The image’s preferred load address, recorded in its
+  //!     segment commands and symbol values. If the image is read at another
+  //!     address, it will appear to have slid.
+  //! \param[out] image The image.
+  void Build(uint64_t vmaddr, std::string* image) const;
+
+  //! \brief The image’s `LC_UUID` contents.
+  const uint8_t* uuid() const { return uuid_; }
+
+ private:
+  struct Symbol {
+    std::string name;
+    uint64_t offset;
+  };
+
+  std::vector<Symbol> symbols_;
+  uint8_t uuid_[16];
+  bool is_64_bit_;
+
+  DISALLOW_COPY_AND_ASSIGN(MachOImageBuilder);
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_TEST_MAC_MACH_O_IMAGE_BUILDER_H_
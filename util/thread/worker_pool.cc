@@ -0,0 +1,109 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/thread/worker_pool.h"
+
+#include <errno.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+WorkerPool::WorkerPool(size_t thread_count)
+    : mutex_(),
+      delegate_(NULL),
+      thread_count_(std::max(thread_count, static_cast<size_t>(1))),
+      next_index_(0),
+      work_count_(0),
+      failed_(false) {
+  int rv = pthread_mutex_init(&mutex_, NULL);
+  CHECK_EQ(rv, 0) << "pthread_mutex_init";
+}
+
+WorkerPool::~WorkerPool() {
+  DCHECK(!delegate_);
+
+  int rv = pthread_mutex_destroy(&mutex_);
+  DCHECK_EQ(rv, 0) << "pthread_mutex_destroy";
+}
+
+bool WorkerPool::Run(Delegate* delegate, size_t work_count) {
+  DCHECK(!delegate_);
+
+  delegate_ = delegate;
+  next_index_ = 0;
+  work_count_ = work_count;
+  failed_ = false;
+
+  // The calling thread is one of the workers, so start one fewer thread than
+  // will actually perform work.
+  size_t start_thread_count =
+      std::min(thread_count_, std::max(work_count, static_cast<size_t>(1))) -
+      1;
+  std::vector<pthread_t> threads;
+  threads.reserve(start_thread_count);
+  for (size_t index = 0; index < start_thread_count; ++index) {
+    pthread_t thread;
+    errno = pthread_create(&thread, NULL, ThreadMain, this);
+    if (errno != 0) {
+      // The remaining work will be picked up by the threads already running.
+      PLOG(WARNING) << "pthread_create";
+      break;
+    }
+    threads.push_back(thread);
+  }
+
+  WorkLoop();
+
+  for (pthread_t thread : threads) {
+    int rv = pthread_join(thread, NULL);
+    CHECK_EQ(rv, 0) << "pthread_join";
+  }
+
+  delegate_ = NULL;
+  return !failed_;
+}
+
+// static
+void* WorkerPool::ThreadMain(void* argument) {
+  WorkerPool* self = static_cast<WorkerPool*>(argument);
+  self->WorkLoop();
+  return NULL;
+}
+
+void WorkerPool::WorkLoop() {
+  while (true) {
+    size_t index;
+
+    pthread_mutex_lock(&mutex_);
+    if (failed_ || next_index_ >= work_count_) {
+      pthread_mutex_unlock(&mutex_);
+      return;
+    }
+    index = next_index_++;
+    pthread_mutex_unlock(&mutex_);
+
+    if (!delegate_->DoWork(index)) {
+      pthread_mutex_lock(&mutex_);
+      failed_ = true;
+      pthread_mutex_unlock(&mutex_);
+      return;
+    }
+  }
+}
+
+}  // namespace crashpad
@@ -0,0 +1,96 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_THREAD_WORKER_POOL_H_
+#define CRASHPAD_UTIL_THREAD_WORKER_POOL_H_
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "base/basictypes.h"
+
+namespace crashpad {
+
+//! \brief Runs a fixed number of independent work items on a small pool of
+//!     threads.
+//!
+//! Work items are identified by index, and are handed out to threads in
+//! increasing index order as threads become available. Callers that order work
+//! items from largest to smallest will generally see the best balance among
+//! threads.
+class WorkerPool {
+ public:
+  //! \brief An interface to perform the work that a WorkerPool distributes.
+  class Delegate {
+   public:
+    //! \brief Performs a single work item.
+    //!
+    //! This method is called on an arbitrary thread, possibly concurrently with
+    //! other calls for other values of \a index. It is called exactly once for
+    //! each work item, unless an earlier work item has failed.
+    //!
+    //! \param[in] index The index of the work item to perform.
+    //!
+    //! \return `true` on success. `false` on failure, with an appropriate
+    //!     message logged.
+    virtual bool DoWork(size_t index) = 0;
+
+   protected:
+    ~Delegate() {}
+  };
+
+  //! \param[in] thread_count The maximum number of threads that will perform
+  //!     work items concurrently, including the thread that calls Run(). If
+  //!     this is `0` or `1`, all work is performed on the calling thread.
+  explicit WorkerPool(size_t thread_count);
+  ~WorkerPool();
+
+  //! \brief Performs work items `0` through \a work_count `- 1`, returning
+  //!     once they have all completed.
+  //!
+  //! The calling thread participates in performing work. Additional threads
+  //! are started as needed, but never more than one fewer than the number of
+  //! work items, and are joined before this method returns. If a thread cannot
+  //! be started, the work it would have performed is picked up by the threads
+  //! that are running.
+  //!
+  //! \param[in] delegate The object that performs the work.
+  //! \param[in] work_count The number of work items to perform.
+  //!
+  //! \return `true` if every work item succeeded. `false` if any failed. After
+  //!     a failure, work items that have not yet started are not performed.
+  bool Run(Delegate* delegate, size_t work_count);
+
+ private:
+  //! \brief The start routine for threads started by Run().
+  static void* ThreadMain(void* argument);
+
+  //! \brief Performs work items until none remain, or until one fails.
+  void WorkLoop();
+
+  pthread_mutex_t mutex_;
+  Delegate* delegate_;  // weak
+  size_t thread_count_;
+
+  // These fields are protected by mutex_ while Run() is in progress.
+  size_t next_index_;
+  size_t work_count_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerPool);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_THREAD_WORKER_POOL_H_
@@ -0,0 +1,121 @@
+// Copyright 2014 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/thread/worker_pool.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Records which work items were performed and on which threads, and fails the
+// work item at |fail_index|.
+class TestDelegate final : public WorkerPool::Delegate {
+ public:
+  TestDelegate(size_t work_count, size_t fail_index)
+      : done_(work_count, 0), threads_(), fail_index_(fail_index) {
+    int rv = pthread_mutex_init(&mutex_, NULL);
+    EXPECT_EQ(0, rv);
+  }
+
+  ~TestDelegate() {
+    int rv = pthread_mutex_destroy(&mutex_);
+    EXPECT_EQ(0, rv);
+  }
+
+  const std::vector<int>& done() const { return done_; }
+  size_t thread_count() const { return threads_.size(); }
+
+  // WorkerPool::Delegate:
+  virtual bool DoWork(size_t index) override {
+    pthread_mutex_lock(&mutex_);
+    ++done_[index];
+    threads_.insert(pthread_self());
+    pthread_mutex_unlock(&mutex_);
+
+    // Give other threads a chance to pick up work items.
+    usleep(1000);
+
+    return index != fail_index_;
+  }
+
+ private:
+  pthread_mutex_t mutex_;
+  std::vector<int> done_;
+  std::set<pthread_t> threads_;
+  size_t fail_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestDelegate);
+};
+
+const size_t kNoFailure = static_cast<size_t>(-1);
+
+TEST(WorkerPool, NoWork) {
+  WorkerPool worker_pool(4);
+  TestDelegate delegate(0, kNoFailure);
+  EXPECT_TRUE(worker_pool.Run(&delegate, 0));
+  EXPECT_EQ(0u, delegate.thread_count());
+}
+
+TEST(WorkerPool, OneThread) {
+  const size_t kWorkCount = 8;
+  WorkerPool worker_pool(1);
+  TestDelegate delegate(kWorkCount, kNoFailure);
+  EXPECT_TRUE(worker_pool.Run(&delegate, kWorkCount));
+  EXPECT_EQ(std::vector<int>(kWorkCount, 1), delegate.done());
+  EXPECT_EQ(1u, delegate.thread_count());
+}
+
+TEST(WorkerPool, SeveralThreads) {
+  const size_t kWorkCount = 64;
+  WorkerPool worker_pool(4);
+
+  // Run more than once to make sure that the pool can be reused.
+  for (int iteration = 0; iteration < 2; ++iteration) {
+    SCOPED_TRACE(iteration);
+    TestDelegate delegate(kWorkCount, kNoFailure);
+    EXPECT_TRUE(worker_pool.Run(&delegate, kWorkCount));
+    EXPECT_EQ(std::vector<int>(kWorkCount, 1), delegate.done());
+    EXPECT_GE(delegate.thread_count(), 1u);
+    EXPECT_LE(delegate.thread_count(), 4u);
+  }
+}
+
+TEST(WorkerPool, Failure) {
+  const size_t kWorkCount = 64;
+  WorkerPool worker_pool(4);
+  TestDelegate delegate(kWorkCount, 2);
+  EXPECT_FALSE(worker_pool.Run(&delegate, kWorkCount));
+
+  // The failed work item was performed, and nothing was performed twice. Not
+  // everything after it will have been.
+  EXPECT_EQ(1, delegate.done()[2]);
+  size_t done_count = 0;
+  for (int done : delegate.done()) {
+    EXPECT_LE(done, 1);
+    done_count += done;
+  }
+  EXPECT_LT(done_count, kWorkCount);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -26,12 +26,26 @@
         '<(INTERMEDIATE_DIR)',
       ],
       'sources': [
+        'file/buffered_file_writer.cc',
+        'file/buffered_file_writer.h',
+        'file/chunked_file_writer.cc',
+        'file/chunked_file_writer.h',
         'file/fd_io.cc',
         'file/fd_io.h',
         'file/file_writer.cc',
         'file/file_writer.h',
+        'file/mapped_file_writer.cc',
+        'file/mapped_file_writer.h',
+        'file/offset_file_writer.cc',
+        'file/offset_file_writer.h',
         'file/string_file_writer.cc',
         'file/string_file_writer.h',
+        'file/zlib_file_writer.cc',
+        'file/zlib_file_writer.h',
+        'linux/process_memory.cc',
+        'linux/process_memory.h',
+        'linux/process_reader.cc',
+        'linux/process_reader.h',
         'mac/checked_mach_address_range.cc',
         'mac/checked_mach_address_range.h',
         'mac/launchd.h',
@@ -57,6 +71,7 @@
         'mac/process_types/flavors.h',
         'mac/process_types/internal.h',
         'mac/process_types/loader.proctype',
+        'mac/process_types/memory_source.h',
         'mac/process_types/nlist.proctype',
         'mac/process_types/traits.h',
         'mach/exc_client_variants.cc',
@@ -75,12 +90,24 @@
         'mach/symbolic_constants_mach.h',
         'mach/task_memory.cc',
         'mach/task_memory.h',
+        'misc/arena.cc',
+        'misc/arena.h',
+        'misc/buffer_remote_memory.cc',
+        'misc/buffer_remote_memory.h',
+        'misc/cached_remote_memory.cc',
+        'misc/cached_remote_memory.h',
         'misc/clock.cc',
         'misc/clock.h',
         'misc/clock_mac.cc',
+        'misc/file_remote_memory.cc',
+        'misc/file_remote_memory.h',
         'misc/initialization_state.h',
         'misc/initialization_state_dcheck.cc',
         'misc/initialization_state_dcheck.h',
+        'misc/log_context.cc',
+        'misc/log_context.h',
+        'misc/remote_memory.cc',
+        'misc/remote_memory.h',
         'misc/scoped_forbid_return.cc',
         'misc/scoped_forbid_return.h',
         'misc/symbolic_constants_common.h',
@@ -95,6 +122,8 @@
         'posix/symbolic_constants_posix.cc',
         'posix/symbolic_constants_posix.h',
         'stdlib/cxx.h',
+        'stdlib/flat_address_map.h',
+        'stdlib/flat_string_map.h',
         'stdlib/objc.h',
         'stdlib/pointer_container.h',
         'stdlib/string_number_conversion.cc',
@@ -103,8 +132,12 @@
         'stdlib/strlcpy.h',
         'stdlib/strnlen.cc',
         'stdlib/strnlen.h',
+        'stdlib/utf8_to_utf16.cc',
+        'stdlib/utf8_to_utf16.h',
         'synchronization/semaphore.cc',
         'synchronization/semaphore.h',
+        'thread/worker_pool.cc',
+        'thread/worker_pool.h',
       ],
       'conditions': [
         ['OS=="mac"', {
@@ -149,8 +182,28 @@
               '$(SDKROOT)/System/Library/Frameworks/CoreFoundation.framework',
               '$(SDKROOT)/System/Library/Frameworks/Foundation.framework',
               '$(SDKROOT)/System/Library/Frameworks/IOKit.framework',
+              '$(SDKROOT)/usr/lib/libz.dylib',
             ],
           },
+        }, {  # else: OS!="mac"
+          'link_settings': {
+            'libraries': [
+              '-lz',
+            ],
+          },
+        }],
+      ],
+      'target_conditions': [
+        ['OS!="mac"', {
+          # The Mach-O image readers and process_types read through
+          # process_types::MemorySource rather than a Mach task, so they can
+          # read images from files and buffers on any platform.
+          'sources/': [
+            ['include', '^mac/checked_mach_address_range\\.cc$'],
+            ['include', '^mac/mach_o_image_[a-z_]*reader\\.cc$'],
+            ['include', '^mac/process_types\\.cc$'],
+            ['include', '^mac/process_types/custom\\.cc$'],
+          ],
         }],
       ],
     },
@@ -174,6 +227,8 @@
         'test/mac/dyld.h',
         'test/mac/mach_errors.cc',
         'test/mac/mach_errors.h',
+        'test/mac/mach_o_image_builder.cc',
+        'test/mac/mach_o_image_builder.h',
         'test/mac/mach_multiprocess.cc',
         'test/mac/mach_multiprocess.h',
         'test/multiprocess.cc',
@@ -192,6 +247,13 @@
           },
         }],
       ],
+      'target_conditions': [
+        ['OS!="mac"', {
+          'sources/': [
+            ['include', '^test/mac/mach_o_image_builder\\.cc$'],
+          ],
+        }],
+      ],
     },
     {
       'target_name': 'util_test',
@@ -210,10 +272,18 @@
         '..',
       ],
       'sources': [
+        'file/buffered_file_writer_test.cc',
+        'file/chunked_file_writer_test.cc',
+        'file/mapped_file_writer_test.cc',
+        'file/offset_file_writer_test.cc',
         'file/string_file_writer_test.cc',
+        'file/zlib_file_writer_test.cc',
+        'linux/process_memory_test.cc',
+        'linux/process_reader_test.cc',
         'mac/checked_mach_address_range_test.cc',
         'mac/launchd_test.mm',
         'mac/mac_util_test.mm',
+        'mac/mach_o_image_reader_synthetic_test.cc',
         'mac/mach_o_image_reader_test.cc',
         'mac/mach_o_image_segment_reader_test.cc',
         'mac/process_reader_test.cc',
@@ -227,9 +297,14 @@
         'mach/mach_message_server_test.cc',
         'mach/symbolic_constants_mach_test.cc',
         'mach/task_memory_test.cc',
+        'misc/arena_test.cc',
+        'misc/buffer_remote_memory_test.cc',
+        'misc/cached_remote_memory_test.cc',
         'misc/clock_test.cc',
+        'misc/file_remote_memory_test.cc',
         'misc/initialization_state_dcheck_test.cc',
         'misc/initialization_state_test.cc',
+        'misc/log_context_test.cc',
         'misc/scoped_forbid_return_test.cc',
         'misc/uuid_test.cc',
         'numeric/checked_range_test.cc',
@@ -237,14 +312,18 @@
         'numeric/int128_test.cc',
         'posix/process_util_test.cc',
         'posix/symbolic_constants_posix_test.cc',
+        'stdlib/flat_address_map_test.cc',
+        'stdlib/flat_string_map_test.cc',
         'stdlib/string_number_conversion_test.cc',
         'stdlib/strlcpy_test.cc',
         'stdlib/strnlen_test.cc',
+        'stdlib/utf8_to_utf16_test.cc',
         'synchronization/semaphore_test.cc',
         'test/executable_path_test.cc',
         'test/mac/mach_multiprocess_test.cc',
         'test/multiprocess_exec_test.cc',
         'test/multiprocess_test.cc',
+        'thread/worker_pool_test.cc',
       ],
       'conditions': [
         ['OS=="mac"', {
@@ -255,6 +334,13 @@
           },
         }],
       ],
+      'target_conditions': [
+        ['OS!="mac"', {
+          'sources/': [
+            ['include', '^mac/mach_o_image_reader_synthetic_test\\.cc$'],
+          ],
+        }],
+      ],
     },
     {
       'target_name': 'util_test_multiprocess_exec_test_child',